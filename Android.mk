@@ -26,8 +26,10 @@ SPVTOOLS_SRC_FILES := \
 		source/text_handler.cpp \
 		source/util/bit_stream.cpp \
 		source/util/bit_vector.cpp \
+		source/util/dominators.cpp \
 		source/util/parse_number.cpp \
 		source/util/string_utils.cpp \
+		source/util/text_reader.cpp \
 		source/util/timer.cpp \
 		source/val/basic_block.cpp \
 		source/val/construct.cpp \
@@ -67,6 +69,8 @@ SPVTOOLS_OPT_SRC_FILES := \
 		source/opt/cfg.cpp \
 		source/opt/cfg_cleanup_pass.cpp \
 		source/opt/ccp_pass.cpp \
+		source/opt/change_tracker.cpp \
+		source/opt/code_sinking_pass.cpp \
 		source/opt/common_uniform_elim_pass.cpp \
 		source/opt/compact_ids_pass.cpp \
 		source/opt/composite.cpp \
@@ -77,12 +81,14 @@ SPVTOOLS_OPT_SRC_FILES := \
 		source/opt/dead_insert_elim_pass.cpp \
 		source/opt/dead_variable_elimination.cpp \
 		source/opt/decoration_manager.cpp \
+		source/opt/dedup_functions_pass.cpp \
 		source/opt/def_use_manager.cpp \
 		source/opt/dominator_analysis.cpp \
 		source/opt/dominator_tree.cpp \
 		source/opt/eliminate_dead_constant_pass.cpp \
 		source/opt/eliminate_dead_functions_pass.cpp \
 		source/opt/feature_manager.cpp \
+		source/opt/fixpoint_pass.cpp \
 		source/opt/flatten_decoration_pass.cpp \
 		source/opt/fold.cpp \
 		source/opt/folding_rules.cpp \
@@ -91,6 +97,7 @@ SPVTOOLS_OPT_SRC_FILES := \
 		source/opt/function.cpp \
 		source/opt/if_conversion.cpp \
 		source/opt/inline_pass.cpp \
+		source/opt/inline_budgeted_pass.cpp \
 		source/opt/inline_exhaustive_pass.cpp \
 		source/opt/inline_opaque_pass.cpp \
 		source/opt/insert_extract_elim.cpp \
@@ -98,7 +105,9 @@ SPVTOOLS_OPT_SRC_FILES := \
 		source/opt/instruction_list.cpp \
 		source/opt/ir_context.cpp \
 		source/opt/ir_loader.cpp \
+		source/opt/lazy_function_loader.cpp \
 		source/opt/licm_pass.cpp \
+		source/opt/load_store_elim_pass.cpp \
 		source/opt/local_access_chain_convert_pass.cpp \
 		source/opt/local_redundancy_elimination.cpp \
 		source/opt/local_single_block_elim_pass.cpp \
@@ -107,13 +116,17 @@ SPVTOOLS_OPT_SRC_FILES := \
 		source/opt/loop_dependence.cpp \
 		source/opt/loop_dependence_helpers.cpp \
 		source/opt/loop_descriptor.cpp \
+		source/opt/loop_fission.cpp \
+		source/opt/loop_fusion.cpp \
 		source/opt/loop_peeling.cpp \
 		source/opt/loop_unroller.cpp \
 		source/opt/loop_unswitch_pass.cpp \
 		source/opt/loop_utils.cpp \
 		source/opt/mem_pass.cpp \
+		source/opt/memory_ssa.cpp \
 		source/opt/merge_return_pass.cpp \
 		source/opt/module.cpp \
+		source/opt/module_cost.cpp \
 		source/opt/optimizer.cpp \
 		source/opt/pass.cpp \
 		source/opt/pass_manager.cpp \
@@ -134,6 +147,7 @@ SPVTOOLS_OPT_SRC_FILES := \
 		source/opt/strip_reflect_info_pass.cpp \
 		source/opt/type_manager.cpp \
 		source/opt/types.cpp \
+		source/opt/uniform_load_elim_pass.cpp \
 		source/opt/unify_const_pass.cpp \
 		source/opt/value_number_table.cpp \
 		source/opt/vector_dce.cpp \
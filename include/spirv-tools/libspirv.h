@@ -360,6 +360,10 @@ typedef struct spv_context_t spv_context_t;
 
 typedef struct spv_validator_options_t spv_validator_options_t;
 
+// Opaque struct containing the state used to parse SPIR-V modules one
+// instruction at a time.
+typedef struct spv_binary_iterator_t spv_binary_iterator_t;
+
 // Type Definitions
 
 typedef spv_const_binary_t* spv_const_binary;
@@ -371,6 +375,7 @@ typedef const spv_context_t* spv_const_context;
 typedef spv_context_t* spv_context;
 typedef spv_validator_options_t* spv_validator_options;
 typedef const spv_validator_options_t* spv_const_validator_options;
+typedef spv_binary_iterator_t* spv_binary_iterator;
 
 // Platform API
 
@@ -472,6 +477,12 @@ SPIRV_TOOLS_EXPORT void spvValidatorOptionsSetRelaxStoreStruct(
 SPIRV_TOOLS_EXPORT void spvValidatorOptionsSetRelaxLogicalPointer(
     spv_validator_options options, bool val);
 
+// Records the number of threads the validator may use for the checks which
+// are done independently on each function.  The result and the diagnostics of
+// the validation do not depend on it.  Zero means one, which is the default.
+SPIRV_TOOLS_EXPORT void spvValidatorOptionsSetNumThreads(
+    spv_validator_options options, uint32_t num_threads);
+
 // Encodes the given SPIR-V assembly text to its binary representation. The
 // length parameter specifies the number of bytes for text. Encoded binary will
 // be stored into *binary. Any error will be written into *diagnostic if
@@ -579,6 +590,83 @@ SPIRV_TOOLS_EXPORT spv_result_t spvBinaryParse(
     const size_t num_words, spv_parsed_header_fn_t parse_header,
     spv_parsed_instruction_fn_t parse_instruction, spv_diagnostic* diagnostic);
 
+// The pull-style binary parser interface.  It parses the same binaries as
+// spvBinaryParse, but returns the instructions one at a time at the request of
+// the caller, which can stop at any point.  An iterator can be reused to parse
+// any number of modules, keeping the storage it has allocated.
+
+// A parsed SPIR-V header.  The integer members are the 32-bit words from the
+// header, as specified in SPIR-V 1.0 Section 2.3 Table 1.
+typedef struct spv_parsed_header_t {
+  spv_endianness_t endian;
+  uint32_t magic;
+  uint32_t version;
+  uint32_t generator;
+  uint32_t id_bound;
+  uint32_t reserved;
+} spv_parsed_header_t;
+
+// Creates a binary iterator for the given context, which must outlive the
+// iterator.  The iterator emits diagnostics to the message consumer the context
+// has at creation.  Returns a null pointer if the context is null.
+SPIRV_TOOLS_EXPORT spv_binary_iterator
+spvBinaryIteratorCreate(const spv_const_context context);
+
+// Creates a binary iterator for the given context, positioned at the same
+// instruction of the same module as |iterator|, and with the same types and
+// extended instruction imports recorded.  The context must outlive the new
+// iterator, and must have the same target environment as the one of
+// |iterator|.  This lets several threads parse parts of one module, each with
+// its own iterator.  Returns a null pointer if the context or |iterator| is
+// null.
+SPIRV_TOOLS_EXPORT spv_binary_iterator spvBinaryIteratorCreateCopy(
+    const spv_const_context context, const spv_binary_iterator_t* iterator);
+
+// Destroys the given binary iterator.
+SPIRV_TOOLS_EXPORT void spvBinaryIteratorDestroy(spv_binary_iterator iterator);
+
+// Starts parsing a SPIR-V binary, specified as counted sequence of 32-bit
+// words, which must outlive its parse.  Any module previously started with the
+// iterator is abandoned.  Parses the header into |header|.  Returns
+// SPV_SUCCESS on success.  Otherwise returns a status code other than
+// SPV_SUCCESS, and the iterator has no instructions left.  If diagnostic is
+// non-null, it is used instead of the context message consumer to emit the
+// diagnostics of the whole parse of the module, and must outlive it.
+SPIRV_TOOLS_EXPORT spv_result_t spvBinaryIteratorBegin(
+    spv_binary_iterator iterator, const uint32_t* words, const size_t num_words,
+    spv_parsed_header_t* header, spv_diagnostic* diagnostic);
+
+// Parses the next instruction of the module being parsed by the iterator.
+// Returns SPV_SUCCESS and points |parsed_instruction| to the instruction on
+// success.  The parsed instruction is transient: it may be overwritten or
+// released by the next call on the iterator, except for its words array, which
+// refers to the module words when the module has the host endianness.
+// Returns SPV_END_OF_STREAM when there are no instructions left.  For an
+// invalid parse, returns another status code, emits a diagnostic, and the
+// iterator has no instructions left.
+SPIRV_TOOLS_EXPORT spv_result_t
+spvBinaryIteratorNext(spv_binary_iterator iterator,
+                      const spv_parsed_instruction_t** parsed_instruction);
+
+// Advances the iterator past the next OpFunctionEnd instruction, without
+// parsing the operands of the instructions in between.  The types and
+// extended instruction imports defined by skipped instructions are not
+// recorded, so it should only be used to skip function bodies.  Returns
+// SPV_SUCCESS on success.  Otherwise returns a status code other than
+// SPV_SUCCESS, emits a diagnostic, and the iterator has no instructions left.
+SPIRV_TOOLS_EXPORT spv_result_t
+spvBinaryIteratorSkipFunction(spv_binary_iterator iterator);
+
+// Moves the iterator to the instruction starting at word |word_index| of the
+// module being parsed, which must be the first word of an instruction already
+// returned or skipped by the iterator.  The types and extended instruction
+// imports recorded so far are kept, so the instructions are parsed as they
+// were the first time.  Returns SPV_SUCCESS on success, or
+// SPV_ERROR_INVALID_LOOKUP if |word_index| is not within the instructions of
+// the module.
+SPIRV_TOOLS_EXPORT spv_result_t
+spvBinaryIteratorSeek(spv_binary_iterator iterator, const size_t word_index);
+
 #ifdef __cplusplus
 }
 #endif
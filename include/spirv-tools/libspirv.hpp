@@ -16,8 +16,10 @@
 #define SPIRV_TOOLS_LIBSPIRV_HPP_
 
 #include <functional>
+#include <iosfwd>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "spirv-tools/libspirv.h"
@@ -91,10 +93,97 @@ class ValidatorOptions {
     spvValidatorOptionsSetRelaxLogicalPointer(options_, val);
   }
 
+  // Records the number of threads the validator may use for the checks which
+  // are done independently on each function.  The result and the diagnostics
+  // of the validation do not depend on it.
+  void SetNumThreads(uint32_t num_threads) {
+    spvValidatorOptionsSetNumThreads(options_, num_threads);
+  }
+
+  // Records the stream to which the validator reports the resource usage of
+  // each of its stages (e.g., CPU time, RSS), and the time spent by each of
+  // the checks done on every instruction.  Nothing is reported if |out| is
+  // nullptr, which is the default.
+  void SetTimeReport(std::ostream* out);
+
  private:
   spv_validator_options options_;
 };
 
+// A C++ wrapper around a binary iterator, which parses SPIR-V modules one
+// instruction at a time.  A typical loop is:
+//
+//   BinaryIterator it(context);
+//   if (it.Begin(words, num_words) != SPV_SUCCESS) ...
+//   while (const spv_parsed_instruction_t* inst = it.Next()) ...
+//   if (it.status() != SPV_END_OF_STREAM) ...
+class BinaryIterator {
+ public:
+  // Constructs an iterator for |context|, which must outlive it.
+  explicit BinaryIterator(const Context& context)
+      : iterator_(spvBinaryIteratorCreate(context.CContext())) {}
+  ~BinaryIterator() { spvBinaryIteratorDestroy(iterator_); }
+
+  BinaryIterator(BinaryIterator&& other)
+      : iterator_(other.iterator_),
+        header_(other.header_),
+        status_(other.status_) {
+    other.iterator_ = nullptr;
+  }
+  BinaryIterator& operator=(BinaryIterator&& other) {
+    std::swap(iterator_, other.iterator_);
+    std::swap(header_, other.header_);
+    std::swap(status_, other.status_);
+    return *this;
+  }
+  BinaryIterator(const BinaryIterator&) = delete;
+  BinaryIterator& operator=(const BinaryIterator&) = delete;
+
+  // Starts parsing the module of |num_words| words at |words|, which must
+  // outlive its parse.  Returns the status of parsing the header.  Diagnostics
+  // go to the message consumer of the context.
+  spv_result_t Begin(const uint32_t* words, size_t num_words) {
+    status_ = spvBinaryIteratorBegin(iterator_, words, num_words, &header_,
+                                     nullptr);
+    return status_;
+  }
+
+  // Returns the header of the current module.  Only valid after a successful
+  // call to Begin.
+  const spv_parsed_header_t& header() const { return header_; }
+
+  // Returns the next instruction of the current module, which is valid until
+  // the next call on the iterator.  Returns a null pointer at the end of the
+  // module or on error, in which case status() tells which.
+  const spv_parsed_instruction_t* Next() {
+    const spv_parsed_instruction_t* inst = nullptr;
+    status_ = spvBinaryIteratorNext(iterator_, &inst);
+    return status_ == SPV_SUCCESS ? inst : nullptr;
+  }
+
+  // Skips to the instruction following the next OpFunctionEnd.  Returns true
+  // on success.
+  bool SkipFunction() {
+    status_ = spvBinaryIteratorSkipFunction(iterator_);
+    return status_ == SPV_SUCCESS;
+  }
+
+  // Moves to the instruction starting at |word_index|, which must have been
+  // returned or skipped already.  Returns true on success.
+  bool Seek(size_t word_index) {
+    status_ = spvBinaryIteratorSeek(iterator_, word_index);
+    return status_ == SPV_SUCCESS;
+  }
+
+  // Returns the status of the last operation.
+  spv_result_t status() const { return status_; }
+
+ private:
+  spv_binary_iterator iterator_;
+  spv_parsed_header_t header_ = {};
+  spv_result_t status_ = SPV_END_OF_STREAM;
+};
+
 // C++ interface for SPIRV-Tools functionalities. It wraps the context
 // (including target environment and the corresponding SPIR-V grammar) and
 // provides methods for assembling, disassembling, and validating.
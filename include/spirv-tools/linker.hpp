@@ -29,7 +29,8 @@ class LinkerOptions {
   LinkerOptions()
       : create_library_(false),
         verify_ids_(false),
-        allow_partial_linkage_(false) {}
+        allow_partial_linkage_(false),
+        dedup_functions_(false) {}
 
   // Returns whether a library or an executable should be produced by the
   // linking phase.
@@ -63,10 +64,22 @@ class LinkerOptions {
     allow_partial_linkage_ = allow_partial_linkage;
   }
 
+  // Returns whether functions which are identical up to their ids should be
+  // replaced with a single copy. The number of removed functions and bytes is
+  // reported as an info message.
+  bool GetDedupFunctions() const { return dedup_functions_; }
+
+  // Sets whether functions which are identical up to their ids should be
+  // replaced with a single copy.
+  void SetDedupFunctions(bool dedup_functions) {
+    dedup_functions_ = dedup_functions;
+  }
+
  private:
   bool create_library_;
   bool verify_ids_;
   bool allow_partial_linkage_;
+  bool dedup_functions_;
 };
 
 // Links one or more SPIR-V modules into a new SPIR-V module. That is, combine
@@ -15,6 +15,7 @@
 #ifndef SPIRV_TOOLS_OPTIMIZER_HPP_
 #define SPIRV_TOOLS_OPTIMIZER_HPP_
 
+#include <functional>
 #include <memory>
 #include <ostream>
 #include <string>
@@ -52,6 +53,26 @@ class Optimizer {
     std::unique_ptr<Impl> impl_;  // Unique pointer to internal data.
   };
 
+  // A candidate pass pipeline for RunAutotuned().
+  struct Recipe {
+    std::string name;  // Identifies the recipe in the report.
+    // Registers the passes of the recipe to the given optimizer.
+    std::function<void(Optimizer*)> register_passes;
+  };
+
+  // How the result of one recipe compared in RunAutotuned().
+  struct RecipeReport {
+    std::string name;    // The name of the recipe.
+    bool succeeded;      // False if one of the passes of the recipe failed.
+    double cost;         // The cost of the result, if it succeeded.
+    size_t binary_size;  // The size of the result in words, if it succeeded.
+  };
+
+  // Returns the cost of the module |binary|, of |binary_size| words, for
+  // RunAutotuned().  Lower is better.
+  using CostFunction =
+      std::function<double(const uint32_t* binary, size_t binary_size)>;
+
   // Constructs an instance with the given target |env|, which is used to decode
   // the binaries to be optimized later.
   //
@@ -83,6 +104,14 @@ class Optimizer {
   // from time to time.
   Optimizer& RegisterPerformancePasses();
 
+  // Registers passes that attempt to improve performance of generated code,
+  // like RegisterPerformancePasses(), and enables change tracking.  Groups of
+  // cleanup passes are repeated until they stop changing the module, instead
+  // of a fixed number of times.
+  // This sequence of passes is subject to constant review and will change
+  // from time to time.
+  Optimizer& RegisterChangeDrivenPerformancePasses();
+
   // Registers passes that attempt to improve the size of generated code.
   // This sequence of passes is subject to constant review and will change
   // from time to time.
@@ -109,6 +138,54 @@ class Optimizer {
   bool Run(const uint32_t* original_binary, size_t original_binary_size,
            std::vector<uint32_t>* optimized_binary) const;
 
+  // Optimizes one specialization of |original_binary| for each element of
+  // |variants|, and writes them to |optimized_binaries| in the same order.
+  //
+  // The passes registered to this optimizer run once, on the module with the
+  // default values of its specialization constants.  Then, for each variant,
+  // a copy of the result gets the specialization constant values of the
+  // variant, as with CreateSetSpecConstantDefaultValuePass(), and is optimized
+  // with the passes that |register_variant_passes| registers to a new
+  // optimizer.  The copies share the function bodies of the common result
+  // until a pass accesses them.
+  //
+  // Returns true if all the variants were optimized successfully.  Returns
+  // false as soon as processing a variant fails.
+  bool RunVariants(
+      const uint32_t* original_binary, size_t original_binary_size,
+      const std::vector<std::unordered_map<uint32_t, std::string>>& variants,
+      const std::function<void(Optimizer*)>& register_variant_passes,
+      std::vector<std::vector<uint32_t>>* optimized_binaries) const;
+
+  // Optimizes |original_binary| with each recipe of |recipes|, and writes the
+  // result with the lowest cost to |optimized_binary|.  Ties go to the recipe
+  // that comes first.
+  //
+  // The passes registered to this optimizer run first, once.  Each recipe then
+  // registers its passes to a new optimizer, which runs on its own copy of the
+  // result.  The recipes run in parallel on up to the number of threads set
+  // with SetNumThreads().  The message consumer of this optimizer receives the
+  // messages of all the recipes, one at a time.
+  //
+  // The cost of a result is computed by |cost_function|, which may be called
+  // concurrently.  If it is empty, the built-in cost model is used instead: it
+  // adds up the instruction count, the instruction count weighted by loop
+  // depth, and the maximum register pressure of any basic block.
+  //
+  // If |winning_recipe| is not null, the name of the recipe whose result was
+  // chosen is written to it.  If |report| is not null, one entry per recipe is
+  // written to it, in the order of |recipes|.
+  //
+  // Returns false if the passes of this optimizer fail, or if no recipe
+  // succeeds.  In that case |optimized_binary| is not modified.
+  bool RunAutotuned(const uint32_t* original_binary,
+                    size_t original_binary_size,
+                    const std::vector<Recipe>& recipes,
+                    const CostFunction& cost_function,
+                    std::vector<uint32_t>* optimized_binary,
+                    std::string* winning_recipe,
+                    std::vector<RecipeReport>* report) const;
+
   // Returns a vector of strings with all the pass names added to this
   // optimizer's pass manager. These strings are valid until the associated
   // pass manager is destroyed.
@@ -124,6 +201,16 @@ class Optimizer {
   // |out| output stream.
   Optimizer& SetTimeReport(std::ostream* out);
 
+  // Sets whether passes record which functions they change.  When enabled,
+  // a pass that supports it skips the functions it has already processed
+  // without effect, if they have not changed since.  Disabled by default.
+  Optimizer& SetChangeTracking(bool track_changes);
+
+  // Sets the number of threads used to build the module from the binary and
+  // to write it back, which is 1 by default.  The result does not depend on
+  // the number of threads.
+  Optimizer& SetNumThreads(uint32_t num_threads);
+
  private:
   struct Impl;                  // Opaque struct for holding internal data.
   std::unique_ptr<Impl> impl_;  // Unique pointer to internal data.
@@ -276,6 +363,17 @@ Optimizer::PassToken CreateInlineExhaustivePass();
 // point are not changed.
 Optimizer::PassToken CreateInlineOpaquePass();
 
+// Creates a size-budgeted inline pass.
+// A budgeted inline pass walks the call trees of the entry points bottom-up,
+// so every callee has already been processed, and its dead instructions
+// removed, when it is cloned into its callers. Calls are inlined while the
+// total number of instructions added to the module stays within |budget|; the
+// rest are kept as function calls. Calls to a callee with opaque parameters or
+// return type are always inlined, and their size is charged to the budget as
+// well. The functions of the call trees that are no longer called are removed.
+// Functions that are not in the call tree of an entry point are not changed.
+Optimizer::PassToken CreateInlineBudgetedPass(size_t budget);
+
 // Creates a single-block local variable load/store elimination pass.
 // For every entry point function, do single block memory optimization of
 // function variables referenced only with non-access-chain loads and stores.
@@ -411,6 +509,25 @@ Optimizer::PassToken CreateDeadInsertElimPass();
 // This pass currently only optimizes loads with a single index.
 Optimizer::PassToken CreateCommonUniformElimPass();
 
+// Creates a pass to remove redundant loads of uniform and read-only buffer
+// memory.
+// A load of a uniform block, a push constant block, a uniform constant, or a
+// buffer that is never written is replaced by an identical load that
+// dominates it.  Loads are identical if they load from the same variable
+// through access chains with the same indices, constant or not.  When neither
+// of two identical loads dominates the other, they are replaced by one load at
+// the end of their nearest common dominator, before its merge instruction, as
+// long as that block is in the same loop as both loads and the load cannot
+// read outside of the variable: all its indices are constants and none of
+// them indexes a runtime array.  Loads are never moved out of a loop, access
+// chain loads are never turned into loads of whole blocks, and loads of
+// images and samplers are only replaced by loads in the same block.
+//
+// Unlike the pass created by CreateCommonUniformElimPass(), this pass is
+// part of the performance and size recipes.  It requires a module with the
+// Shader capability and logical addressing.
+Optimizer::PassToken CreateUniformLoadElimPass();
+
 // Create aggressive dead code elimination pass
 // This pass eliminates unused code from the module. In addition,
 // it detects and eliminates code which may have spurious uses but which do
@@ -445,6 +562,14 @@ Optimizer::PassToken CreateCompactIdsPass();
 // * duplicate decorations.
 Optimizer::PassToken CreateRemoveDuplicatesPass();
 
+// Creates a dedup functions pass.
+// This pass finds functions whose bodies are identical up to the ids they
+// define, and replaces all the uses of each of them with a single copy. This
+// typically happens after linking modules which include the same helpers.
+// Entry points and functions with linkage attributes are never removed, and
+// calls are never redirected to an entry point.
+Optimizer::PassToken CreateDedupFunctionsPass();
+
 // Creates a CFG cleanup pass.
 // This pass removes cruft from the control flow graph of functions that are
 // reachable from entry points and exported functions. It currently includes the
@@ -483,6 +608,31 @@ Optimizer::PassToken CreateLocalRedundancyEliminationPass();
 // the loops preheader.
 Optimizer::PassToken CreateLoopInvariantCodeMotionPass();
 
+// Creates a loop fission pass.
+// This pass splits innermost loops whose estimated register pressure exceeds
+// |register_threshold| into two loops over the same range, each executing part
+// of the stores of the original loop. The split point is the legal one, as
+// proven by the loop dependence analysis, which minimizes the register
+// pressure of the resulting loops.
+Optimizer::PassToken CreateLoopFissionPass(size_t register_threshold);
+
+// Creates a loop fusion pass.
+// This pass fuses adjacent innermost loops iterating over the same range when
+// the loop dependence analysis proves it legal, and as long as the fused loop
+// is estimated to use at most |max_registers_per_loop| registers.
+Optimizer::PassToken CreateLoopFusionPass(size_t max_registers_per_loop);
+
+// Creates a code sinking pass.
+// This pass lowers the register pressure of the functions whose estimated
+// register pressure is above |register_threshold|. Instructions without side
+// effects are moved down to the nearest block dominating all their uses, as
+// long as that does not move them into a loop. If the pressure is still above
+// the threshold, access chains, vector shuffles and composite extractions are
+// then recomputed in the blocks using them, when their operands are live there
+// anyway. The pressure of each function before and after is reported as an
+// info message.
+Optimizer::PassToken CreateCodeSinkingPass(size_t register_threshold);
+
 // Creates a loop peeling pass.
 // This pass will look for conditions inside a loop that are true or false only
 // for the N first or last iteration. For loop with such condition, those N
@@ -549,6 +699,15 @@ Optimizer::PassToken CreateSimplificationPass();
 // won't be unrolled. See CanPerformUnroll LoopUtils.h for more information.
 Optimizer::PassToken CreateLoopUnrollPass(bool fully_unroll, int factor = 0);
 
+// Creates a loop unroller pass driven by a cost model.
+// This pass unrolls the loops meeting the LoopUtils::CanPerformUnroll criteria
+// whatever their loop control, unless it is "DontUnroll". Small loops with a
+// known number of iterations are fully unrolled, larger ones are partially
+// unrolled by a factor dividing their number of iterations, as long as the
+// estimated register pressure stays low. The unrolled loops may add at most
+// |size_budget| instructions to the module.
+Optimizer::PassToken CreateHeuristicLoopUnrollPass(size_t size_budget);
+
 // Create the SSA rewrite pass.
 // This pass converts load/store operations on function local variables into
 // operations on SSA IDs.  This allows SSA optimizers to act on these variables.
@@ -567,6 +726,28 @@ Optimizer::PassToken CreateCopyPropagateArraysPass();
 // a pass of ADCE will be able to remove.
 Optimizer::PassToken CreateVectorDCEPass();
 
+// Creates a redundant load and dead store elimination pass.
+// This pass uses the memory SSA form of each function to replace a load by the
+// value stored to the same memory, or by an earlier load of the same memory
+// that dominates it, when nothing may write that memory in between.  It also
+// removes stores to variables local to a function that are never read, and
+// stores that are overwritten in the same block before anything may read
+// them.  Loads from the function, private and workgroup storage classes and
+// from read-only memory are processed.  Memory is told apart by variable and
+// by the constant indices of access chains, so variables accessed through
+// access chains with dynamic indices are processed too.
+Optimizer::PassToken CreateLoadStoreElimPass();
+
+// Create a fixpoint pass.
+// This pass runs the passes made by |pass_creators| in order, and repeats the
+// whole group until an iteration leaves the module unchanged, or until it ran
+// |max_iterations| times.  Each iteration uses new pass instances.  With
+// change tracking enabled (see Optimizer::SetChangeTracking), the iterations
+// after the first only process the functions changed by the previous one.
+Optimizer::PassToken CreateFixpointPass(
+    std::vector<std::function<Optimizer::PassToken()>> pass_creators,
+    uint32_t max_iterations);
+
 }  // namespace spvtools
 
 #endif  // SPIRV_TOOLS_OPTIMIZER_HPP_
@@ -17,6 +17,9 @@
 #include <algorithm>
 #include <cassert>
 #include <cstring>
+#include <mutex>
+#include <utility>
+#include <vector>
 
 #include "ext_inst.h"
 #include "opcode.h"
@@ -168,6 +171,24 @@ const size_t kNumOpSpecConstantOpcodes =
 
 namespace libspirv {
 
+struct AssemblyGrammar::CapabilityTables {
+  // The distinct sets of capabilities.  The first one is the empty set.
+  std::vector<CapabilitySet> sets;
+  // The index in |sets| of the capabilities enabling each opcode, indexed by
+  // opcode.
+  std::vector<uint32_t> opcode_sets;
+  // For each operand type, the pairs of an operand value and the index in
+  // |sets| of the capabilities it requires, sorted by value.  The values which
+  // need no capability are left out.
+  std::vector<std::vector<std::pair<uint32_t, uint32_t>>> operand_sets;
+};
+
+AssemblyGrammar::AssemblyGrammar(const spv_const_context context)
+    : target_env_(context->target_env),
+      operandTable_(context->operand_table),
+      opcodeTable_(context->opcode_table),
+      extInstTable_(context->ext_inst_table) {}
+
 bool AssemblyGrammar::isValid() const {
   return operandTable_ && opcodeTable_ && extInstTable_;
 }
@@ -189,6 +210,107 @@ CapabilitySet AssemblyGrammar::filterCapsAgainstTargetEnv(
   return cap_set;
 }
 
+const CapabilitySet& AssemblyGrammar::enablingCapabilitiesForOpcode(
+    SpvOp opcode) const {
+  const CapabilityTables& tables = getCapabilityTables();
+  const auto& opcode_sets = tables.opcode_sets;
+  const uint32_t index = static_cast<uint32_t>(opcode);
+  if (index >= opcode_sets.size()) return tables.sets[0];
+  return tables.sets[opcode_sets[index]];
+}
+
+const CapabilitySet& AssemblyGrammar::requiredCapabilitiesForOperand(
+    spv_operand_type_t type, uint32_t operand) const {
+  const CapabilityTables& tables = getCapabilityTables();
+  const auto& operand_sets = tables.operand_sets;
+  if (static_cast<size_t>(type) >= operand_sets.size()) return tables.sets[0];
+  const auto& values = operand_sets[type];
+  const auto it = std::lower_bound(
+      values.begin(), values.end(), operand,
+      [](const std::pair<uint32_t, uint32_t>& entry, uint32_t value) {
+        return entry.first < value;
+      });
+  if (it == values.end() || it->first != operand) return tables.sets[0];
+  return tables.sets[it->second];
+}
+
+const AssemblyGrammar::CapabilityTables&
+AssemblyGrammar::getCapabilityTables() const {
+  // The tables are never freed, so that they can be used until the very end
+  // of the process.
+  const size_t kNumTargetEnvs = SPV_ENV_VULKAN_1_1 + 1;
+  static std::once_flag once[kNumTargetEnvs];
+  static const CapabilityTables* tables[kNumTargetEnvs];
+
+  const size_t env = static_cast<size_t>(target_env_);
+  assert(env < kNumTargetEnvs && "Unknown target environment.");
+  std::call_once(once[env], [this, env]() {
+    // The grammar tables of a context only depend on its target environment.
+    spv_context context = spvContextCreate(target_env_);
+    tables[env] = AssemblyGrammar(context).buildCapabilityTables();
+    spvContextDestroy(context);
+  });
+  return *tables[env];
+}
+
+AssemblyGrammar::CapabilityTables* AssemblyGrammar::buildCapabilityTables()
+    const {
+  auto* tables = new CapabilityTables;
+  tables->sets.emplace_back();
+
+  // Returns the index in tables->sets of the available capabilities among
+  // those of a grammar entry.
+  auto intern = [this, tables](const SpvCapability* caps, uint32_t count) {
+    CapabilitySet set = filterCapsAgainstTargetEnv(caps, count);
+    auto& sets = tables->sets;
+    const auto it = std::find(sets.begin(), sets.end(), set);
+    if (it != sets.end()) return static_cast<uint32_t>(it - sets.begin());
+    sets.push_back(std::move(set));
+    return static_cast<uint32_t>(sets.size() - 1);
+  };
+
+  if (opcodeTable_) {
+    for (uint32_t i = 0; i < opcodeTable_->count; ++i) {
+      const SpvOp opcode = opcodeTable_->entries[i].opcode;
+      // Use the entry selected for the target environment, which may not be
+      // this one when several entries have the same opcode.
+      spv_opcode_desc desc = nullptr;
+      if (lookupOpcode(opcode, &desc) != SPV_SUCCESS) continue;
+      const uint32_t index =
+          intern(desc->capabilities, desc->numCapabilities);
+      if (index == 0) continue;
+      auto& opcode_sets = tables->opcode_sets;
+      if (opcode_sets.size() <= static_cast<size_t>(opcode)) {
+        opcode_sets.resize(opcode + 1, 0);
+      }
+      opcode_sets[opcode] = index;
+    }
+  }
+
+  if (operandTable_) {
+    tables->operand_sets.resize(SPV_OPERAND_TYPE_NUM_OPERAND_TYPES);
+    for (uint32_t i = 0; i < operandTable_->count; ++i) {
+      const auto& group = operandTable_->types[i];
+      auto& values = tables->operand_sets[group.type];
+      for (uint32_t j = 0; j < group.count; ++j) {
+        const uint32_t value = group.entries[j].value;
+        spv_operand_desc desc = nullptr;
+        if (lookupOperand(group.type, value, &desc) != SPV_SUCCESS) continue;
+        const uint32_t index =
+            intern(desc->capabilities, desc->numCapabilities);
+        if (index != 0) values.emplace_back(value, index);
+      }
+    }
+    // Entries with the same value resolve to the same set.
+    for (auto& values : tables->operand_sets) {
+      std::sort(values.begin(), values.end());
+      values.erase(std::unique(values.begin(), values.end()), values.end());
+    }
+  }
+
+  return tables;
+}
+
 spv_result_t AssemblyGrammar::lookupOpcode(const char* name,
                                            spv_opcode_desc* desc) const {
   return spvOpcodeTableNameLookup(target_env_, opcodeTable_, name, desc);
@@ -27,11 +27,7 @@ namespace libspirv {
 // Contains methods to query for valid instructions and operands.
 class AssemblyGrammar {
  public:
-  explicit AssemblyGrammar(const spv_const_context context)
-      : target_env_(context->target_env),
-        operandTable_(context->operand_table),
-        opcodeTable_(context->opcode_table),
-        extInstTable_(context->ext_inst_table) {}
+  explicit AssemblyGrammar(const spv_const_context context);
 
   // Returns true if the internal tables have been initialized with valid data.
   bool isValid() const;
@@ -44,6 +40,22 @@ class AssemblyGrammar {
   CapabilitySet filterCapsAgainstTargetEnv(const SpvCapability* cap_array,
                                            uint32_t count) const;
 
+  // Returns the capabilities enabling the given opcode which are available in
+  // the current target environment.  It is the empty set if the opcode does
+  // not exist, or needs no capability.  This is equivalent to filtering the
+  // capabilities of the opcode entry with filterCapsAgainstTargetEnv, except
+  // that the sets are computed once per target environment, so that it does
+  // not allocate.
+  const CapabilitySet& enablingCapabilitiesForOpcode(SpvOp opcode) const;
+
+  // Returns the capabilities required by the given operand which are
+  // available in the current target environment.  It is the empty set if the
+  // operand does not exist, or needs no capability.  Like
+  // enablingCapabilitiesForOpcode, the sets are computed once per target
+  // environment.
+  const CapabilitySet& requiredCapabilitiesForOperand(spv_operand_type_t type,
+                                                      uint32_t operand) const;
+
   // Fills in the desc parameter with the information about the opcode
   // of the given name. Returns SPV_SUCCESS if the opcode was found, and
   // SPV_ERROR_INVALID_LOOKUP if the opcode does not exist.
@@ -127,6 +139,17 @@ class AssemblyGrammar {
                                spv_operand_pattern_t* pattern) const;
 
  private:
+  // The capabilities of the opcodes and operands in a target environment.
+  struct CapabilityTables;
+
+  // Returns the capability tables of the target environment, which are shared
+  // by all the grammars of that environment, and computed when they are first
+  // requested.
+  const CapabilityTables& getCapabilityTables() const;
+
+  // Computes the capability tables of this grammar.
+  CapabilityTables* buildCapabilityTables() const;
+
   const spv_target_env target_env_;
   const spv_operand_table operandTable_;
   const spv_opcode_table opcodeTable_;
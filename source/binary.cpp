@@ -54,7 +54,7 @@ spv_result_t spvBinaryHeaderGet(const spv_const_binary binary,
 namespace {
 
 // A SPIR-V binary parser.  A parser instance communicates detailed parse
-// results via callbacks.
+// results via callbacks, or returns them one instruction at a time.
 class Parser {
  public:
   // The user_data value is provided to the callbacks as context.
@@ -73,17 +73,52 @@ class Parser {
   spv_result_t parse(const uint32_t* words, size_t num_words,
                      spv_diagnostic* diagnostic);
 
+  // Starts parsing the specified binary SPIR-V module one instruction at a
+  // time, reusing the storage of the previous module parse state.  Parses the
+  // header into |header| and returns SPV_SUCCESS on success.  Otherwise returns
+  // an error code and issues a diagnostic.
+  spv_result_t beginModule(const uint32_t* words, size_t num_words,
+                           spv_parsed_header_t* header);
+
+  // Parses the next instruction of the module started by beginModule.  On
+  // success, returns SPV_SUCCESS and points |inst| to the parsed instruction,
+  // which is valid until the next call.  Returns SPV_END_OF_STREAM when there
+  // are no more instructions.  Otherwise returns an error code and issues a
+  // diagnostic, and the module has no more instructions.
+  spv_result_t nextInstruction(const spv_parsed_instruction_t** inst);
+
+  // Advances past the next OpFunctionEnd, only decoding the opcode and word
+  // count of the instructions in between.  Returns SPV_SUCCESS on success.
+  // Otherwise returns an error code and issues a diagnostic, and the module
+  // has no more instructions.
+  spv_result_t skipFunction();
+
+  // Moves to the instruction starting at |word_index| in the module started by
+  // beginModule, keeping the type information recorded so far.  Returns
+  // SPV_SUCCESS on success, or SPV_ERROR_INVALID_LOOKUP if |word_index| is not
+  // within the instructions of the module.
+  spv_result_t seek(size_t word_index);
+
+  // Makes the module parse state a copy of the one of |other|.
+  void copyState(const Parser& other) { _ = other._; }
+
  private:
   // All remaining methods work on the current module parse state.
 
   // Like the parse method, but works on the current module parse state.
   spv_result_t parseModule();
 
+  // Checks the magic number, sets the endianness, and parses the header of
+  // the current module into |header|.  Returns SPV_SUCCESS on success.
+  // Otherwise returns an error code and issues a diagnostic.
+  spv_result_t parseHeader(spv_parsed_header_t* header);
+
   // Parses an instruction at the current position of the binary.  Assumes
   // the header has been parsed, the endian has been set, and the word index is
   // still in range.  Advances the parsing position past the instruction, and
   // updates other parsing state for the current module.
-  // On success, returns SPV_SUCCESS and issues the parsed-instruction callback.
+  // On success, returns SPV_SUCCESS and stores the parsed instruction in the
+  // inst member of the module parse state.
   // On failure, returns an error code and issues a diagnostic.
   spv_result_t parseInstruction();
 
@@ -177,6 +212,7 @@ class Parser {
           num_words(num_words_arg),
           diagnostic(diagnostic_arg),
           word_index(0),
+          parsed_end(0),
           endian(),
           requires_endian_conversion(false) {
       // Temporary storage for parser state within a single instruction.
@@ -186,10 +222,29 @@ class Parser {
       expected_operands.reserve(25);
     }
     State() : State(0, 0, nullptr) {}
+
+    // Resets the state to parse a new module, keeping the storage of the
+    // tables.
+    void reset(const uint32_t* words_arg, size_t num_words_arg) {
+      words = words_arg;
+      num_words = num_words_arg;
+      word_index = 0;
+      parsed_end = 0;
+      endian = spv_endianness_t();
+      requires_endian_conversion = false;
+      id_to_type_id.clear();
+      type_id_to_number_type_info.clear();
+      import_id_to_ext_inst_type.clear();
+    }
+
     const uint32_t* words;       // Words in the binary SPIR-V module.
     size_t num_words;            // Number of words in the module.
     spv_diagnostic* diagnostic;  // Where diagnostics go.
     size_t word_index;           // The current position in words.
+    // The end of the furthest instruction parsed by nextInstruction().  The
+    // instructions before it are parsed again after a seek, and their result
+    // ids are already recorded.
+    size_t parsed_end;
     spv_endianness_t endian;     // The endianness of the binary.
     // Is the SPIR-V binary in a different endiannes from the host native
     // endianness?
@@ -209,6 +264,10 @@ class Parser {
     std::vector<spv_parsed_operand_t> operands;
     std::vector<uint32_t> endian_converted_words;
     spv_operand_pattern_t expected_operands;
+
+    // The last parsed instruction.  Its pointers refer to the storage above
+    // or to the words of the module.
+    spv_parsed_instruction_t inst;
   } _;
 };
 
@@ -224,7 +283,86 @@ spv_result_t Parser::parse(const uint32_t* words, size_t num_words,
   return result;
 }
 
+spv_result_t Parser::beginModule(const uint32_t* words, size_t num_words,
+                                 spv_parsed_header_t* header) {
+  _.reset(words, num_words);
+  if (auto error = parseHeader(header)) {
+    _.reset(nullptr, 0);
+    return error;
+  }
+  _.word_index = SPV_INDEX_INSTRUCTION;
+  return SPV_SUCCESS;
+}
+
+spv_result_t Parser::nextInstruction(const spv_parsed_instruction_t** inst) {
+  if (_.word_index >= _.num_words) return SPV_END_OF_STREAM;
+  if (auto error = parseInstruction()) {
+    _.word_index = _.num_words;
+    return error;
+  }
+  _.parsed_end = std::max(_.parsed_end, _.word_index);
+  *inst = &_.inst;
+  return SPV_SUCCESS;
+}
+
+spv_result_t Parser::skipFunction() {
+  while (_.word_index < _.num_words) {
+    const size_t inst_offset = _.word_index;
+    uint16_t inst_word_count = 0;
+    uint16_t opcode = 0;
+    spvOpcodeSplit(peek(), &inst_word_count, &opcode);
+    if (inst_word_count < 1 ||
+        inst_word_count > _.num_words - inst_offset) {
+      const spv_result_t error =
+          diagnostic() << "Invalid instruction word count " << inst_word_count
+                       << " starting at word " << inst_offset;
+      _.word_index = _.num_words;
+      return error;
+    }
+    _.word_index += inst_word_count;
+    if (opcode == SpvOpFunctionEnd) return SPV_SUCCESS;
+  }
+  return diagnostic() << "End of input reached while skipping a function: "
+                         "missing OpFunctionEnd.";
+}
+
+spv_result_t Parser::seek(size_t word_index) {
+  if (word_index < SPV_INDEX_INSTRUCTION || word_index >= _.num_words)
+    return SPV_ERROR_INVALID_LOOKUP;
+  _.word_index = word_index;
+  return SPV_SUCCESS;
+}
+
 spv_result_t Parser::parseModule() {
+  spv_parsed_header_t header;
+  if (auto error = parseHeader(&header)) return error;
+  if (parsed_header_fn_) {
+    if (auto error = parsed_header_fn_(user_data_, header.endian, header.magic,
+                                       header.version, header.generator,
+                                       header.id_bound, header.reserved)) {
+      return error;
+    }
+  }
+
+  // Process the instructions.
+  _.word_index = SPV_INDEX_INSTRUCTION;
+  while (_.word_index < _.num_words) {
+    if (auto error = parseInstruction()) return error;
+    // Issue the callback.  The callee should know that all the storage in
+    // inst is transient, and will disappear immediately afterward.
+    if (parsed_instruction_fn_) {
+      if (auto error = parsed_instruction_fn_(user_data_, &_.inst))
+        return error;
+    }
+  }
+
+  // Running off the end should already have been reported earlier.
+  assert(_.word_index == _.num_words);
+
+  return SPV_SUCCESS;
+}
+
+spv_result_t Parser::parseHeader(spv_parsed_header_t* parsed_header) {
   if (!_.words) return diagnostic() << "Missing module.";
 
   if (_.num_words < SPV_INDEX_INSTRUCTION)
@@ -247,21 +385,12 @@ spv_result_t Parser::parseModule() {
     return diagnostic(SPV_ERROR_INTERNAL)
            << "Internal error: unhandled header parse failure";
   }
-  if (parsed_header_fn_) {
-    if (auto error = parsed_header_fn_(user_data_, _.endian, header.magic,
-                                       header.version, header.generator,
-                                       header.bound, header.schema)) {
-      return error;
-    }
-  }
-
-  // Process the instructions.
-  _.word_index = SPV_INDEX_INSTRUCTION;
-  while (_.word_index < _.num_words)
-    if (auto error = parseInstruction()) return error;
-
-  // Running off the end should already have been reported earlier.
-  assert(_.word_index == _.num_words);
+  parsed_header->endian = _.endian;
+  parsed_header->magic = header.magic;
+  parsed_header->version = header.version;
+  parsed_header->generator = header.generator;
+  parsed_header->id_bound = header.bound;
+  parsed_header->reserved = header.schema;
 
   return SPV_SUCCESS;
 }
@@ -269,7 +398,8 @@ spv_result_t Parser::parseModule() {
 spv_result_t Parser::parseInstruction() {
   // The zero values for all members except for opcode are the
   // correct initial values.
-  spv_parsed_instruction_t inst = {};
+  spv_parsed_instruction_t& inst = _.inst;
+  inst = {};
 
   const uint32_t first_word = peek();
 
@@ -377,12 +507,6 @@ spv_result_t Parser::parseInstruction() {
   inst.operands = _.operands.data();
   inst.num_operands = uint16_t(_.operands.size());
 
-  // Issue the callback.  The callee should know that all the storage in inst
-  // is transient, and will disappear immediately afterward.
-  if (parsed_instruction_fn_) {
-    if (auto error = parsed_instruction_fn_(user_data_, &inst)) return error;
-  }
-
   return SPV_SUCCESS;
 }
 
@@ -431,7 +555,8 @@ spv_result_t Parser::parseOperand(size_t inst_offset,
       inst->result_id = word;
       // Save the result ID to type ID mapping.
       // In the grammar, type ID always appears before result ID.
-      if (_.id_to_type_id.find(inst->result_id) != _.id_to_type_id.end())
+      if (inst_offset >= _.parsed_end &&
+          _.id_to_type_id.find(inst->result_id) != _.id_to_type_id.end())
         return diagnostic(SPV_ERROR_INVALID_ID)
                << "Id " << inst->result_id << " is defined more than once";
       // Record it.
@@ -772,6 +897,70 @@ spv_result_t spvBinaryParse(const spv_const_context context, void* user_data,
   return parser.parse(code, num_words, diagnostic);
 }
 
+struct spv_binary_iterator_t {
+  explicit spv_binary_iterator_t(const spv_const_context context_arg)
+      : context(*context_arg),
+        consumer(context_arg->consumer),
+        parser(&context, nullptr, nullptr, nullptr) {}
+
+  // A copy of the context, whose message consumer is replaced when the caller
+  // asks for a diagnostic.  The parser refers to it.
+  spv_context_t context;
+  // The message consumer of the original context.
+  const spvtools::MessageConsumer consumer;
+  Parser parser;
+};
+
+spv_binary_iterator spvBinaryIteratorCreate(const spv_const_context context) {
+  if (!context) return nullptr;
+  return new spv_binary_iterator_t(context);
+}
+
+spv_binary_iterator spvBinaryIteratorCreateCopy(
+    const spv_const_context context, const spv_binary_iterator_t* iterator) {
+  if (!context || !iterator) return nullptr;
+  spv_binary_iterator copy = new spv_binary_iterator_t(context);
+  copy->parser.copyState(iterator->parser);
+  return copy;
+}
+
+void spvBinaryIteratorDestroy(spv_binary_iterator iterator) {
+  delete iterator;
+}
+
+spv_result_t spvBinaryIteratorBegin(spv_binary_iterator iterator,
+                                    const uint32_t* words,
+                                    const size_t num_words,
+                                    spv_parsed_header_t* header,
+                                    spv_diagnostic* diagnostic) {
+  if (!iterator || !header) return SPV_ERROR_INVALID_POINTER;
+  if (diagnostic) {
+    *diagnostic = nullptr;
+    libspirv::UseDiagnosticAsMessageConsumer(&iterator->context, diagnostic);
+  } else {
+    iterator->context.consumer = iterator->consumer;
+  }
+  return iterator->parser.beginModule(words, num_words, header);
+}
+
+spv_result_t spvBinaryIteratorNext(
+    spv_binary_iterator iterator,
+    const spv_parsed_instruction_t** parsed_instruction) {
+  if (!iterator || !parsed_instruction) return SPV_ERROR_INVALID_POINTER;
+  return iterator->parser.nextInstruction(parsed_instruction);
+}
+
+spv_result_t spvBinaryIteratorSkipFunction(spv_binary_iterator iterator) {
+  if (!iterator) return SPV_ERROR_INVALID_POINTER;
+  return iterator->parser.skipFunction();
+}
+
+spv_result_t spvBinaryIteratorSeek(spv_binary_iterator iterator,
+                                   const size_t word_index) {
+  if (!iterator) return SPV_ERROR_INVALID_POINTER;
+  return iterator->parser.seek(word_index);
+}
+
 // TODO(dneto): This probably belongs in text.cpp since that's the only place
 // that a spv_binary_t value is created.
 void spvBinaryDestroy(spv_binary binary) {
@@ -25,6 +25,8 @@
 #include <utility>
 #include <vector>
 
+#include "util/dominators.h"
+
 using std::find;
 using std::function;
 using std::get;
@@ -48,17 +50,6 @@ class CFA {
     bb_iter iter;   ///< Iterator to the current child node being processed
   };
 
-  /// Returns true if a block with @p id is found in the @p work_list vector
-  ///
-  /// @param[in] work_list  Set of blocks visited in the the depth first
-  /// traversal
-  ///                       of the CFG
-  /// @param[in] id         The ID of the block being checked
-  ///
-  /// @return true if the edge work_list.back().block->id() => id is a back-edge
-  static bool FindInWorkList(const std::vector<block_info>& work_list,
-                             uint32_t id);
-
  public:
   /// @brief Depth first traversal starting from the \p entry BasicBlock
   ///
@@ -88,15 +79,13 @@ class CFA {
 
   /// @brief Calculates dominator edges for a set of blocks
   ///
-  /// Computes dominators using the algorithm of Cooper, Harvey, and Kennedy
-  /// "A Simple, Fast Dominance Algorithm", 2001.
+  /// Computes dominators with the Semi-NCA algorithm of spvutils::Dominators.
   ///
   /// The algorithm assumes there is a unique root node (a node without
   /// predecessors), and it is therefore at the end of the postorder vector.
   ///
   /// This function calculates the dominator edges for a set of blocks in the
   /// CFG.
-  /// Uses the dominator algorithm by Cooper et al.
   ///
   /// @param[in] postorder        A vector of blocks in post order traversal
   /// order
@@ -107,10 +96,8 @@ class CFA {
   ///
   /// @return the dominator tree of the graph, as a vector of pairs of nodes.
   /// The first node in the pair is a node in the graph. The second node in the
-  /// pair is its immediate dominator in the sense of Cooper et.al., where a
-  /// block
-  /// without predecessors (such as the root node) is its own immediate
-  /// dominator.
+  /// pair is its immediate dominator, where the root node is its own immediate
+  /// dominator.  The pairs are in the order of |postorder|.
   static vector<pair<BB*, BB*>> CalculateDominators(
       const vector<cbb_ptr>& postorder, get_blocks_func predecessor_func);
 
@@ -132,14 +119,6 @@ class CFA {
       get_blocks_func succ_func, get_blocks_func pred_func);
 };
 
-template <class BB>
-bool CFA<BB>::FindInWorkList(const vector<block_info>& work_list, uint32_t id) {
-  for (const auto b : work_list) {
-    if (b.block->id() == id) return true;
-  }
-  return false;
-}
-
 template <class BB>
 void CFA<BB>::DepthFirstTraversal(const BB* entry,
                                   get_blocks_func successor_func,
@@ -147,6 +126,9 @@ void CFA<BB>::DepthFirstTraversal(const BB* entry,
                                   function<void(cbb_ptr)> postorder,
                                   function<void(cbb_ptr, cbb_ptr)> backedge) {
   unordered_set<uint32_t> processed;
+  // The ids of the blocks in the work list, so that back-edges are found
+  // without scanning it.
+  unordered_set<uint32_t> in_work_list;
 
   /// NOTE: work_list is the sequence of nodes from the root node to the node
   /// being processed in the traversal
@@ -156,16 +138,18 @@ void CFA<BB>::DepthFirstTraversal(const BB* entry,
   work_list.push_back({entry, begin(*successor_func(entry))});
   preorder(entry);
   processed.insert(entry->id());
+  in_work_list.insert(entry->id());
 
   while (!work_list.empty()) {
     block_info& top = work_list.back();
     if (top.iter == end(*successor_func(top.block))) {
       postorder(top.block);
+      in_work_list.erase(top.block->id());
       work_list.pop_back();
     } else {
       BB* child = *top.iter;
       top.iter++;
-      if (FindInWorkList(work_list, child->id())) {
+      if (in_work_list.count(child->id())) {
         backedge(top.block, child);
       }
       if (processed.count(child->id()) == 0) {
@@ -173,6 +157,7 @@ void CFA<BB>::DepthFirstTraversal(const BB* entry,
         work_list.emplace_back(
             block_info{child, begin(*successor_func(child))});
         processed.insert(child->id());
+        in_work_list.insert(child->id());
       }
     }
   }
@@ -181,68 +166,36 @@ void CFA<BB>::DepthFirstTraversal(const BB* entry,
 template <class BB>
 vector<pair<BB*, BB*>> CFA<BB>::CalculateDominators(
     const vector<cbb_ptr>& postorder, get_blocks_func predecessor_func) {
-  struct block_detail {
-    size_t dominator;  ///< The index of blocks's dominator in post order array
-    size_t postorder_index;  ///< The index of the block in the post order array
-  };
-  const size_t undefined_dom = postorder.size();
+  if (postorder.empty()) return {};
 
-  unordered_map<cbb_ptr, block_detail> idoms;
+  // Number the blocks densely by their position in the post order.
+  unordered_map<cbb_ptr, uint32_t> index;
   for (size_t i = 0; i < postorder.size(); i++) {
-    idoms[postorder[i]] = {undefined_dom, i};
+    index[postorder[i]] = static_cast<uint32_t>(i);
   }
-  idoms[postorder.back()].dominator = idoms[postorder.back()].postorder_index;
-
-  bool changed = true;
-  while (changed) {
-    changed = false;
-    for (auto b = postorder.rbegin() + 1; b != postorder.rend(); ++b) {
-      const vector<BB*>& predecessors = *predecessor_func(*b);
-      // Find the first processed/reachable predecessor that is reachable
-      // in the forward traversal.
-      auto res = find_if(begin(predecessors), end(predecessors),
-                         [&idoms, undefined_dom](BB* pred) {
-                           return idoms.count(pred) &&
-                                  idoms[pred].dominator != undefined_dom;
-                         });
-      if (res == end(predecessors)) continue;
-      const BB* idom = *res;
-      size_t idom_idx = idoms[idom].postorder_index;
-
-      // all other predecessors
-      for (const auto* p : predecessors) {
-        if (idom == p) continue;
-        // Only consider nodes reachable in the forward traversal.
-        // Otherwise the intersection doesn't make sense and will never
-        // terminate.
-        if (!idoms.count(p)) continue;
-        if (idoms[p].dominator != undefined_dom) {
-          size_t finger1 = idoms[p].postorder_index;
-          size_t finger2 = idom_idx;
-          while (finger1 != finger2) {
-            while (finger1 < finger2) {
-              finger1 = idoms[postorder[finger1]].dominator;
-            }
-            while (finger2 < finger1) {
-              finger2 = idoms[postorder[finger2]].dominator;
-            }
-          }
-          idom_idx = finger1;
-        }
-      }
-      if (idoms[*b].dominator != idom_idx) {
-        idoms[*b].dominator = idom_idx;
-        changed = true;
-      }
+  vector<pair<uint32_t, uint32_t>> edges;
+  for (size_t i = 0; i < postorder.size(); i++) {
+    for (const BB* pred : *predecessor_func(postorder[i])) {
+      // Only consider nodes reachable in the forward traversal.
+      auto where = index.find(pred);
+      if (where != index.end())
+        edges.emplace_back(where->second, static_cast<uint32_t>(i));
     }
   }
+  const uint32_t root = static_cast<uint32_t>(postorder.size() - 1);
+  const spvutils::Dominators dominators(
+      static_cast<uint32_t>(postorder.size()), edges, root);
 
   vector<pair<bb_ptr, bb_ptr>> out;
-  for (auto idom : idoms) {
+  out.reserve(postorder.size());
+  for (uint32_t i = 0; i <= root; i++) {
+    const uint32_t idom = dominators.immediate_dominator(i);
     // NOTE: performing a const cast for convenient usage with
     // UpdateImmediateDominators
-    out.push_back({const_cast<BB*>(get<0>(idom)),
-                   const_cast<BB*>(postorder[get<1>(idom).dominator])});
+    out.push_back(
+        {const_cast<BB*>(postorder[i]),
+         const_cast<BB*>(
+             postorder[idom == spvutils::Dominators::kNone ? i : idom])});
   }
   return out;
 }
@@ -21,6 +21,8 @@
 #ifndef SPIRV_TOOLS_MARKV_HPP_
 #define SPIRV_TOOLS_MARKV_HPP_
 
+#include <cstdint>
+#include <functional>
 #include <string>
 #include <vector>
 
@@ -31,6 +33,13 @@ namespace spvtools {
 
 struct MarkvCodecOptions {
   bool validate_spirv_binary = false;
+
+  // If true, the SPIR-V binary is assumed to be valid (for example because it
+  // was validated before). The codec then only keeps the type and function
+  // definitions it needs to choose models, instead of a copy of every
+  // instruction, and |validate_spirv_binary| is ignored. The encoded MARK-V
+  // binary is the same in both modes.
+  bool trusted_input = false;
 };
 
 // Debug callback. Called once per instruction.
@@ -69,6 +78,74 @@ spv_result_t MarkvToSpirv(
     MessageConsumer message_consumer, MarkvLogConsumer log_consumer,
     MarkvDebugConsumer debug_consumer, std::vector<uint32_t>* spirv);
 
+// Same as above, but reads the MARK-V binary from the |markv_size| bytes at
+// |markv|, which do not need to be held in a std::vector (for example a part
+// of a memory-mapped file).
+spv_result_t MarkvToSpirv(
+    spv_const_context context, const uint8_t* markv, size_t markv_size,
+    const MarkvCodecOptions& options, const MarkvModel& markv_model,
+    MessageConsumer message_consumer, MarkvLogConsumer log_consumer,
+    MarkvDebugConsumer debug_consumer, std::vector<uint32_t>* spirv);
+
+// A MARK-V container packs several MARK-V binaries together, preceded by an
+// index which allows to decode any of them without reading the others.
+
+// Description of a MARK-V binary stored in a container.
+struct MarkvContainerEntry {
+  // Location of the MARK-V binary, in bytes from the start of the container.
+  uint64_t offset;
+  uint32_t size;
+  // Id of the model used to encode the binary: model type in the high 16 bits
+  // and model version in the low 16 bits, as in the MARK-V header.
+  uint32_t model;
+  // Checksum of the MARK-V binary, verified before decoding.
+  uint32_t checksum;
+  // Number of words of the decoded SPIR-V binary.
+  uint32_t spirv_num_words;
+};
+
+// Caller-provided storage for a decoded SPIR-V binary.
+struct MarkvSpirvBuffer {
+  // Destination of the SPIR-V words and its capacity in words.
+  uint32_t* words = nullptr;
+  size_t capacity = 0;
+  // Set by the decoder: number of words written and result of the decoding.
+  size_t num_words = 0;
+  spv_result_t result = SPV_SUCCESS;
+};
+
+// Returns the MARK-V model with the given id (see MarkvContainerEntry::model),
+// or nullptr if it is not available. Called from several threads at once.
+using MarkvModelProvider = std::function<const MarkvModel*(uint32_t model)>;
+
+// Encodes each of |spirv_modules| to MARK-V with |markv_model| and packs the
+// results into a container.
+spv_result_t SpirvToMarkvContainer(
+    spv_const_context context,
+    const std::vector<std::vector<uint32_t>>& spirv_modules,
+    const MarkvCodecOptions& options, const MarkvModel& markv_model,
+    MessageConsumer message_consumer, std::vector<uint8_t>* container);
+
+// Reads the index of the container made of the |container_size| bytes at
+// |container|. Only the index is read.
+spv_result_t ReadMarkvContainerIndex(const uint8_t* container,
+                                     size_t container_size,
+                                     MessageConsumer message_consumer,
+                                     std::vector<MarkvContainerEntry>* entries);
+
+// Decodes the entries |entry_indices| of the container made of the
+// |container_size| bytes at |container|. The i-th selected entry is decoded
+// into (*buffers)[i], whose capacity must be at least the spirv_num_words of
+// the entry. Up to |num_threads| entries are decoded concurrently.
+// |message_consumer| calls are serialized. Returns SPV_SUCCESS if all the
+// entries were decoded, otherwise the result of each entry is in its buffer.
+spv_result_t MarkvContainerToSpirv(
+    spv_const_context context, const uint8_t* container, size_t container_size,
+    const std::vector<uint32_t>& entry_indices,
+    const MarkvCodecOptions& options, const MarkvModelProvider& model_provider,
+    MessageConsumer message_consumer, uint32_t num_threads,
+    std::vector<MarkvSpirvBuffer>* buffers);
+
 }  // namespace spvtools
 
 #endif  // SPIRV_TOOLS_MARKV_HPP_
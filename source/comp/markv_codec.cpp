@@ -52,6 +52,8 @@
 #include "spirv-tools/libspirv.h"
 #include "spirv_endian.h"
 #include "spirv_validator_options.h"
+#include "util/arena.h"
+#include "util/array_view.h"
 #include "util/bit_stream.h"
 #include "util/huffman_codec.h"
 #include "util/move_to_front.h"
@@ -379,13 +381,16 @@ class MarkvCodecBase {
   };
 
   // |model| is owned by the caller, must be not null and valid during the
-  // lifetime of the codec.
+  // lifetime of the codec. If |trusted_input| is true, the codec only keeps
+  // the definitions of types and functions instead of a copy of every
+  // instruction.
   explicit MarkvCodecBase(spv_const_context context,
                           spv_validator_options validator_options,
-                          const MarkvModel* model)
+                          const MarkvModel* model, bool trusted_input)
       : validator_options_(validator_options),
         grammar_(context),
         model_(model),
+        trusted_input_(trusted_input),
         short_id_descriptors_(ShortHashU32Array),
         mtf_huffman_codecs_(GetMtfHuffmanCodecs()),
         context_(context),
@@ -401,25 +406,37 @@ class MarkvCodecBase {
     return ValidateInstructionAndUpdateValidationState(vstate_.get(), &inst);
   }
 
-  // Returns instruction which created |id| or nullptr if such instruction was
-  // not registered.
-  const Instruction* FindDef(uint32_t id) const {
+  // Returns the words of the instruction which created |id| or no words if such
+  // instruction was not registered. Only type and function definitions are
+  // guaranteed to be registered.
+  spvutils::ArrayView<uint32_t> FindDefWords(uint32_t id) const {
+    if (trusted_input_) {
+      const auto it = id_to_type_or_function_words_.find(id);
+      if (it == id_to_type_or_function_words_.end()) return {};
+      return spvutils::ArrayView<uint32_t>(it->second.data(),
+                                           it->second.size());
+    }
+
     const auto it = id_to_def_instruction_.find(id);
-    if (it == id_to_def_instruction_.end()) return nullptr;
-    return it->second;
+    if (it == id_to_def_instruction_.end()) return {};
+    return it->second->words();
   }
 
   // Returns type id of vector type component.
   uint32_t GetVectorComponentType(uint32_t vector_type_id) const {
-    const Instruction* type_inst = FindDef(vector_type_id);
-    assert(type_inst);
-    assert(type_inst->opcode() == SpvOpTypeVector);
+    const auto type_words = FindDefWords(vector_type_id);
+    assert(!type_words.empty());
+    assert(GetOpcode(type_words) == SpvOpTypeVector);
 
-    const uint32_t component_type =
-        type_inst->word(type_inst->operands()[1].offset);
+    const uint32_t component_type = type_words[2];
     return component_type;
   }
 
+  // Returns the opcode of the instruction made of |words|.
+  static SpvOp GetOpcode(spvutils::ArrayView<uint32_t> words) {
+    return SpvOp(words[0] & SpvOpCodeMask);
+  }
+
   // Returns mtf handle for ids of given type.
   uint64_t GetMtfIdOfType(uint32_t type_id) const {
     return kMtfIdOfTypeBegin + type_id;
@@ -484,15 +501,11 @@ class MarkvCodecBase {
   virtual const uint32_t* GetInstWords() const { return inst_.words; }
 
   // Returns the opcode of the previous instruction.
-  SpvOp GetPrevOpcode() const {
-    if (instructions_.empty()) return SpvOpNop;
-
-    return instructions_.back()->opcode();
-  }
+  SpvOp GetPrevOpcode() const { return prev_opcode_; }
 
   // Returns diagnostic stream, position index is set to instruction number.
   DiagnosticStream Diag(spv_result_t error_code) const {
-    return DiagnosticStream({0, 0, instructions_.size()}, context_->consumer,
+    return DiagnosticStream({0, 0, num_instructions_}, context_->consumer,
                             error_code);
   }
 
@@ -535,6 +548,10 @@ class MarkvCodecBase {
   // MARK-V model, not owned.
   const MarkvModel* model_ = nullptr;
 
+  // If true, the input is not validated and only the instructions needed to
+  // choose models are kept.
+  bool trusted_input_ = false;
+
   // Current instruction, current operand and current operand index.
   spv_parsed_instruction_t inst_;
   spv_parsed_operand_t operand_;
@@ -561,8 +578,23 @@ class MarkvCodecBase {
   // List of ids local to the current function.
   std::vector<uint32_t> ids_local_to_cur_function_;
 
-  // List of instructions in the order they are given in the module.
+  // List of instructions in the order they are given in the module. Not
+  // filled with trusted input.
   std::vector<std::unique_ptr<const Instruction>> instructions_;
+  // Storage for the words and operands of |instructions_|.
+  spvutils::Arena<uint32_t> word_arena_;
+  spvutils::Arena<spv_parsed_operand_t> operand_arena_;
+
+  // Maps type and function ids to the words of their definition. Only filled
+  // with trusted input.
+  std::unordered_map<uint32_t, std::vector<uint32_t>>
+      id_to_type_or_function_words_;
+
+  // Number of instructions processed so far.
+  size_t num_instructions_ = 0;
+
+  // Opcode of the last processed instruction.
+  SpvOp prev_opcode_ = SpvOpNop;
 
   // Container/computer for long (32-bit) id descriptors.
   IdDescriptorCollection long_id_descriptors_;
@@ -613,7 +645,8 @@ class MarkvEncoder : public MarkvCodecBase {
   // lifetime of MarkvEncoder.
   MarkvEncoder(spv_const_context context, const MarkvCodecOptions& options,
                const MarkvModel* model)
-      : MarkvCodecBase(context, GetValidatorOptions(options), model),
+      : MarkvCodecBase(context, GetValidatorOptions(options), model,
+                       options.trusted_input),
         options_(options) {
     (void)options_;
   }
@@ -681,8 +714,9 @@ class MarkvEncoder : public MarkvCodecBase {
   // Creates and returns validator options. Returned value owned by the caller.
   static spv_validator_options GetValidatorOptions(
       const MarkvCodecOptions& options) {
-    return options.validate_spirv_binary ? spvValidatorOptionsCreate()
-                                         : nullptr;
+    return options.validate_spirv_binary && !options.trusted_input
+               ? spvValidatorOptionsCreate()
+               : nullptr;
   }
 
   // Writes a single word to bit stream. operand_.type determines if the word is
@@ -738,11 +772,15 @@ class MarkvDecoder : public MarkvCodecBase {
  public:
   // |model| is owned by the caller, must be not null and valid during the
   // lifetime of MarkvEncoder.
-  MarkvDecoder(spv_const_context context, const std::vector<uint8_t>& markv,
-               const MarkvCodecOptions& options, const MarkvModel* model)
-      : MarkvCodecBase(context, GetValidatorOptions(options), model),
+  // |markv| is not owned and must be valid during the lifetime of
+  // MarkvDecoder.
+  MarkvDecoder(spv_const_context context, const uint8_t* markv,
+               size_t markv_size, const MarkvCodecOptions& options,
+               const MarkvModel* model)
+      : MarkvCodecBase(context, GetValidatorOptions(options), model,
+                       options.trusted_input),
         options_(options),
-        reader_(markv) {
+        reader_(BitReaderWord64::InPlace(), markv, markv_size) {
     (void)options_;
     SetIdBound(1);
     parsed_operands_.reserve(25);
@@ -770,8 +808,9 @@ class MarkvDecoder : public MarkvCodecBase {
   // Creates and returns validator options. Returned value owned by the caller.
   static spv_validator_options GetValidatorOptions(
       const MarkvCodecOptions& options) {
-    return options.validate_spirv_binary ? spvValidatorOptionsCreate()
-                                         : nullptr;
+    return options.validate_spirv_binary && !options.trusted_input
+               ? spvValidatorOptionsCreate()
+               : nullptr;
   }
 
   // Reads a single bit from reader_. The read bit is stored in |bit|.
@@ -877,12 +916,30 @@ class MarkvDecoder : public MarkvCodecBase {
 };
 
 void MarkvCodecBase::ProcessCurInstruction() {
-  instructions_.emplace_back(new Instruction(&inst_));
-
   const SpvOp opcode = SpvOp(inst_.opcode);
+  ++num_instructions_;
+  prev_opcode_ = opcode;
+
+  if (!trusted_input_) {
+    // The instruction refers to copies of the words and operands, since the
+    // decoded instruction is transient.
+    spv_parsed_instruction_t stored_inst = inst_;
+    stored_inst.words = word_arena_.Copy(inst_.words, inst_.num_words);
+    stored_inst.operands =
+        operand_arena_.Copy(inst_.operands, inst_.num_operands);
+    instructions_.emplace_back(new Instruction(&stored_inst));
+    if (inst_.result_id) {
+      id_to_def_instruction_.emplace(inst_.result_id,
+                                     instructions_.back().get());
+    }
+  } else if (inst_.result_id &&
+             (spvOpcodeGeneratesType(opcode) || opcode == SpvOpFunction)) {
+    id_to_type_or_function_words_.emplace(
+        inst_.result_id,
+        std::vector<uint32_t>(inst_.words, inst_.words + inst_.num_words));
+  }
 
   if (inst_.result_id) {
-    id_to_def_instruction_.emplace(inst_.result_id, instructions_.back().get());
 
     // Collect ids local to the current function.
     if (cur_function_id_) {
@@ -901,11 +958,11 @@ void MarkvCodecBase::ProcessCurInstruction() {
 
       // Store function parameter types in a queue, so that we know which types
       // to expect in the following OpFunctionParameter instructions.
-      const Instruction* def_inst = FindDef(inst_.words[4]);
-      assert(def_inst);
-      assert(def_inst->opcode() == SpvOpTypeFunction);
-      for (uint32_t i = 3; i < def_inst->words().size(); ++i) {
-        remaining_function_parameter_types_.push_back(def_inst->word(i));
+      const auto def_words = FindDefWords(inst_.words[4]);
+      assert(!def_words.empty());
+      assert(GetOpcode(def_words) == SpvOpTypeFunction);
+      for (uint32_t i = 3; i < def_words.size(); ++i) {
+        remaining_function_parameter_types_.push_back(def_words[i]);
       }
     }
   }
@@ -1000,8 +1057,9 @@ void MarkvCodecBase::ProcessCurInstruction() {
     }
 
     if (inst_.type_id) {
-      const Instruction* type_inst = FindDef(inst_.type_id);
-      assert(type_inst);
+      const auto type_words = FindDefWords(inst_.type_id);
+      assert(!type_words.empty());
+      const SpvOp type_opcode = GetOpcode(type_words);
 
       multi_mtf_.Insert(kMtfObject, inst_.result_id);
 
@@ -1020,7 +1078,7 @@ void MarkvCodecBase::ProcessCurInstruction() {
       if (multi_mtf_.HasValue(kMtfTypeComposite, inst_.type_id))
         multi_mtf_.Insert(kMtfComposite, inst_.result_id);
 
-      switch (type_inst->opcode()) {
+      switch (type_opcode) {
         case SpvOpTypeInt:
         case SpvOpTypeBool:
         case SpvOpTypePointer:
@@ -1028,25 +1086,22 @@ void MarkvCodecBase::ProcessCurInstruction() {
         case SpvOpTypeImage:
         case SpvOpTypeSampledImage:
         case SpvOpTypeSampler:
-          multi_mtf_.Insert(
-              GetMtfIdWithTypeGeneratedByOpcode(type_inst->opcode()),
-              inst_.result_id);
+          multi_mtf_.Insert(GetMtfIdWithTypeGeneratedByOpcode(type_opcode),
+                            inst_.result_id);
           break;
         default:
           break;
       }
 
-      if (type_inst->opcode() == SpvOpTypeVector) {
-        const uint32_t component_type = type_inst->word(2);
+      if (type_opcode == SpvOpTypeVector) {
+        const uint32_t component_type = type_words[2];
         multi_mtf_.Insert(GetMtfVectorOfComponentType(component_type),
                           inst_.result_id);
       }
 
-      if (type_inst->opcode() == SpvOpTypePointer) {
-        assert(type_inst->operands().size() > 2);
-        assert(type_inst->words().size() > type_inst->operands()[2].offset);
-        const uint32_t data_type =
-            type_inst->word(type_inst->operands()[2].offset);
+      if (type_opcode == SpvOpTypePointer) {
+        assert(type_words.size() > 3);
+        const uint32_t data_type = type_words[3];
         multi_mtf_.Insert(GetMtfPointerToType(data_type), inst_.result_id);
 
         if (multi_mtf_.HasValue(kMtfTypeComposite, data_type))
@@ -1243,11 +1298,10 @@ uint64_t MarkvCodecBase::GetRuleBasedMtf() {
       if (operand_index_ == 1) {
         const uint32_t pointer_id = GetInstWords()[1];
         const uint32_t pointer_type = id_to_type_id_.at(pointer_id);
-        const Instruction* pointer_inst = FindDef(pointer_type);
-        assert(pointer_inst);
-        assert(pointer_inst->opcode() == SpvOpTypePointer);
-        const uint32_t data_type =
-            pointer_inst->word(pointer_inst->operands()[2].offset);
+        const auto pointer_words = FindDefWords(pointer_type);
+        assert(!pointer_words.empty());
+        assert(GetOpcode(pointer_words) == SpvOpTypePointer);
+        const uint32_t data_type = pointer_words[3];
         return GetMtfIdOfType(data_type);
       }
       break;
@@ -1290,10 +1344,10 @@ uint64_t MarkvCodecBase::GetRuleBasedMtf() {
     case SpvOpConstantComposite: {
       if (operand_index_ == 0) return kMtfTypeComposite;
       if (operand_index_ >= 2) {
-        const Instruction* composite_type_inst = FindDef(inst_.type_id);
-        assert(composite_type_inst);
-        if (composite_type_inst->opcode() == SpvOpTypeVector) {
-          return GetMtfIdOfType(composite_type_inst->word(2));
+        const auto composite_type_words = FindDefWords(inst_.type_id);
+        assert(!composite_type_words.empty());
+        if (GetOpcode(composite_type_words) == SpvOpTypeVector) {
+          return GetMtfIdOfType(composite_type_words[2]);
         }
       }
       break;
@@ -1424,17 +1478,17 @@ uint64_t MarkvCodecBase::GetRuleBasedMtf() {
 
       if (operand_index_ >= 3) {
         const uint32_t function_id = GetInstWords()[3];
-        const Instruction* function_inst = FindDef(function_id);
-        if (!function_inst) return kMtfObject;
+        const auto function_words = FindDefWords(function_id);
+        if (function_words.empty()) return kMtfObject;
 
-        assert(function_inst->opcode() == SpvOpFunction);
+        assert(GetOpcode(function_words) == SpvOpFunction);
 
-        const uint32_t function_type_id = function_inst->word(4);
-        const Instruction* function_type_inst = FindDef(function_type_id);
-        assert(function_type_inst);
-        assert(function_type_inst->opcode() == SpvOpTypeFunction);
+        const uint32_t function_type_id = function_words[4];
+        const auto function_type_words = FindDefWords(function_type_id);
+        assert(!function_type_words.empty());
+        assert(GetOpcode(function_type_words) == SpvOpTypeFunction);
 
-        const uint32_t argument_type = function_type_inst->word(operand_index_);
+        const uint32_t argument_type = function_type_words[operand_index_];
         return GetMtfIdOfType(argument_type);
       }
       break;
@@ -2898,11 +2952,22 @@ spv_result_t MarkvToSpirv(
     const MarkvCodecOptions& options, const MarkvModel& markv_model,
     MessageConsumer message_consumer, MarkvLogConsumer log_consumer,
     MarkvDebugConsumer debug_consumer, std::vector<uint32_t>* spirv) {
+  return MarkvToSpirv(context, markv.data(), markv.size(), options,
+                      markv_model, message_consumer, log_consumer,
+                      debug_consumer, spirv);
+}
+
+spv_result_t MarkvToSpirv(
+    spv_const_context context, const uint8_t* markv, size_t markv_size,
+    const MarkvCodecOptions& options, const MarkvModel& markv_model,
+    MessageConsumer message_consumer, MarkvLogConsumer log_consumer,
+    MarkvDebugConsumer debug_consumer, std::vector<uint32_t>* spirv) {
   spv_position_t position = {};
   spv_context_t hijack_context = *context;
   libspirv::SetContextMessageConsumer(&hijack_context, message_consumer);
 
-  MarkvDecoder decoder(&hijack_context, markv, options, &markv_model);
+  MarkvDecoder decoder(&hijack_context, markv, markv_size, options,
+                       &markv_model);
 
   if (log_consumer || debug_consumer)
     decoder.CreateLogger(log_consumer, debug_consumer);
@@ -0,0 +1,265 @@
+// Copyright (c) 2018 Google LLC.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Contains the MARK-V container, which packs several MARK-V binaries.
+//
+// Layout (all fields are 32-bit words in host byte order, as the MARK-V
+// header):
+//   - magic number, container version, number of entries
+//   - for each entry: offset (low and high words), size in bytes, model id,
+//     checksum, number of words of the decoded SPIR-V
+//   - MARK-V binaries, in the order of the entries.
+//
+// The index is at the start of the container so that any entry can be located
+// and decoded without reading the others.
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <mutex>
+#include <vector>
+
+#include "diagnostic.h"
+#include "markv.h"
+#include "util/parallel.h"
+
+using libspirv::DiagnosticStream;
+
+namespace spvtools {
+
+namespace {
+
+const uint32_t kContainerMagicNumber = 0x07230304;
+const uint32_t kContainerVersion = 1;
+const size_t kContainerHeaderNumWords = 3;
+const size_t kContainerEntryNumWords = 6;
+// Index of the model id word in the MARK-V header.
+const size_t kMarkvHeaderModelWord = 2;
+
+// Returns FNV-1a hash of |size| bytes at |data|.
+uint32_t ComputeChecksum(const uint8_t* data, size_t size) {
+  uint32_t hash = 2166136261u;
+  for (size_t i = 0; i < size; ++i) {
+    hash ^= data[i];
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+uint32_t ReadWord(const uint8_t* data, size_t word_index) {
+  uint32_t word = 0;
+  std::memcpy(&word, data + word_index * sizeof(uint32_t), sizeof(word));
+  return word;
+}
+
+void AppendWord(uint32_t word, std::vector<uint8_t>* bytes) {
+  const uint8_t* begin = reinterpret_cast<const uint8_t*>(&word);
+  bytes->insert(bytes->end(), begin, begin + sizeof(word));
+}
+
+}  // namespace
+
+spv_result_t SpirvToMarkvContainer(
+    spv_const_context context,
+    const std::vector<std::vector<uint32_t>>& spirv_modules,
+    const MarkvCodecOptions& options, const MarkvModel& markv_model,
+    MessageConsumer message_consumer, std::vector<uint8_t>* container) {
+  spv_position_t position = {};
+  std::vector<std::vector<uint8_t>> markv_modules(spirv_modules.size());
+  for (size_t i = 0; i < spirv_modules.size(); ++i) {
+    const spv_result_t result = SpirvToMarkv(
+        context, spirv_modules[i], options, markv_model, message_consumer,
+        MarkvLogConsumer(), MarkvDebugConsumer(), &markv_modules[i]);
+    if (result != SPV_SUCCESS) return result;
+
+    if (markv_modules[i].size() > UINT32_MAX ||
+        spirv_modules[i].size() > UINT32_MAX) {
+      return DiagnosticStream(position, message_consumer,
+                              SPV_ERROR_INVALID_BINARY)
+             << "Module " << i << " is too large for a MARK-V container.";
+    }
+  }
+
+  container->clear();
+  AppendWord(kContainerMagicNumber, container);
+  AppendWord(kContainerVersion, container);
+  AppendWord(static_cast<uint32_t>(markv_modules.size()), container);
+
+  uint64_t offset = sizeof(uint32_t) * (kContainerHeaderNumWords +
+                                        kContainerEntryNumWords *
+                                            markv_modules.size());
+  for (size_t i = 0; i < markv_modules.size(); ++i) {
+    const std::vector<uint8_t>& markv = markv_modules[i];
+    AppendWord(static_cast<uint32_t>(offset), container);
+    AppendWord(static_cast<uint32_t>(offset >> 32), container);
+    AppendWord(static_cast<uint32_t>(markv.size()), container);
+    AppendWord(ReadWord(markv.data(), kMarkvHeaderModelWord), container);
+    AppendWord(ComputeChecksum(markv.data(), markv.size()), container);
+    AppendWord(static_cast<uint32_t>(spirv_modules[i].size()), container);
+    offset += markv.size();
+  }
+
+  container->reserve(static_cast<size_t>(offset));
+  for (const std::vector<uint8_t>& markv : markv_modules)
+    container->insert(container->end(), markv.begin(), markv.end());
+
+  return SPV_SUCCESS;
+}
+
+spv_result_t ReadMarkvContainerIndex(
+    const uint8_t* container, size_t container_size,
+    MessageConsumer message_consumer,
+    std::vector<MarkvContainerEntry>* entries) {
+  spv_position_t position = {};
+  const size_t header_size = sizeof(uint32_t) * kContainerHeaderNumWords;
+  if (container_size < header_size ||
+      ReadWord(container, 0) != kContainerMagicNumber) {
+    return DiagnosticStream(position, message_consumer,
+                            SPV_ERROR_INVALID_BINARY)
+           << "MARK-V container has incorrect magic number";
+  }
+
+  if (ReadWord(container, 1) != kContainerVersion) {
+    return DiagnosticStream(position, message_consumer,
+                            SPV_ERROR_INVALID_BINARY)
+           << "MARK-V container has unsupported version "
+           << ReadWord(container, 1);
+  }
+
+  const uint32_t num_entries = ReadWord(container, 2);
+  const size_t entry_size = sizeof(uint32_t) * kContainerEntryNumWords;
+  if ((container_size - header_size) / entry_size < num_entries) {
+    return DiagnosticStream(position, message_consumer,
+                            SPV_ERROR_INVALID_BINARY)
+           << "MARK-V container index is truncated";
+  }
+
+  entries->clear();
+  entries->reserve(num_entries);
+  for (uint32_t i = 0; i < num_entries; ++i) {
+    const size_t word =
+        kContainerHeaderNumWords + kContainerEntryNumWords * size_t(i);
+    MarkvContainerEntry entry;
+    entry.offset = uint64_t(ReadWord(container, word)) |
+                   (uint64_t(ReadWord(container, word + 1)) << 32);
+    entry.size = ReadWord(container, word + 2);
+    entry.model = ReadWord(container, word + 3);
+    entry.checksum = ReadWord(container, word + 4);
+    entry.spirv_num_words = ReadWord(container, word + 5);
+
+    if (entry.offset > container_size ||
+        container_size - entry.offset < entry.size) {
+      return DiagnosticStream(position, message_consumer,
+                              SPV_ERROR_INVALID_BINARY)
+             << "MARK-V container entry " << i << " is out of bounds";
+    }
+    entries->push_back(entry);
+  }
+
+  return SPV_SUCCESS;
+}
+
+spv_result_t MarkvContainerToSpirv(
+    spv_const_context context, const uint8_t* container, size_t container_size,
+    const std::vector<uint32_t>& entry_indices,
+    const MarkvCodecOptions& options, const MarkvModelProvider& model_provider,
+    MessageConsumer message_consumer, uint32_t num_threads,
+    std::vector<MarkvSpirvBuffer>* buffers) {
+  assert(buffers->size() == entry_indices.size());
+
+  // Decoders running on different threads report through the same consumer.
+  std::mutex message_mutex;
+  MessageConsumer serialized_consumer;
+  if (message_consumer) {
+    serialized_consumer = [&message_mutex, &message_consumer](
+                              spv_message_level_t level, const char* source,
+                              const spv_position_t& position,
+                              const char* message) {
+      std::lock_guard<std::mutex> lock(message_mutex);
+      message_consumer(level, source, position, message);
+    };
+  }
+
+  std::vector<MarkvContainerEntry> entries;
+  const spv_result_t index_result = ReadMarkvContainerIndex(
+      container, container_size, serialized_consumer, &entries);
+  if (index_result != SPV_SUCCESS) return index_result;
+
+  auto decode_entry = [&](size_t i, uint32_t) {
+    MarkvSpirvBuffer& buffer = (*buffers)[i];
+    buffer.num_words = 0;
+    spv_position_t position = {};
+    if (entry_indices[i] >= entries.size()) {
+      buffer.result = DiagnosticStream(position, serialized_consumer,
+                                       SPV_ERROR_INVALID_LOOKUP)
+                      << "MARK-V container has no entry " << entry_indices[i];
+      return;
+    }
+
+    const MarkvContainerEntry& entry = entries[entry_indices[i]];
+    const uint8_t* markv = container + entry.offset;
+    if (ComputeChecksum(markv, entry.size) != entry.checksum) {
+      buffer.result = DiagnosticStream(position, serialized_consumer,
+                                       SPV_ERROR_INVALID_BINARY)
+                      << "MARK-V container entry " << entry_indices[i]
+                      << " has incorrect checksum";
+      return;
+    }
+
+    if (buffer.capacity < entry.spirv_num_words) {
+      buffer.result = DiagnosticStream(position, serialized_consumer,
+                                       SPV_ERROR_OUT_OF_MEMORY)
+                      << "Buffer for MARK-V container entry "
+                      << entry_indices[i] << " is too small: "
+                      << entry.spirv_num_words << " words needed";
+      return;
+    }
+
+    const MarkvModel* model = model_provider(entry.model);
+    if (!model) {
+      buffer.result = DiagnosticStream(position, serialized_consumer,
+                                       SPV_ERROR_INVALID_LOOKUP)
+                      << "No MARK-V model " << (entry.model >> 16) << "."
+                      << (entry.model & 0xFFFF) << " for container entry "
+                      << entry_indices[i];
+      return;
+    }
+
+    std::vector<uint32_t> spirv;
+    buffer.result = MarkvToSpirv(context, markv, entry.size, options, *model,
+                                 serialized_consumer, MarkvLogConsumer(),
+                                 MarkvDebugConsumer(), &spirv);
+    if (buffer.result != SPV_SUCCESS) return;
+
+    if (spirv.size() > buffer.capacity) {
+      buffer.result = DiagnosticStream(position, serialized_consumer,
+                                       SPV_ERROR_INVALID_BINARY)
+                      << "MARK-V container entry " << entry_indices[i]
+                      << " decoded to more words than recorded in the index";
+      return;
+    }
+
+    std::copy(spirv.begin(), spirv.end(), buffer.words);
+    buffer.num_words = spirv.size();
+  };
+
+  spvutils::ParallelFor(entry_indices.size(), num_threads, decode_entry);
+
+  for (const MarkvSpirvBuffer& buffer : *buffers) {
+    if (buffer.result != SPV_SUCCESS) return buffer.result;
+  }
+  return SPV_SUCCESS;
+}
+
+}  // namespace spvtools
@@ -15,23 +15,31 @@
 #ifndef LIBSPIRV_ENUM_SET_H
 #define LIBSPIRV_ENUM_SET_H
 
+#include <algorithm>
 #include <cstdint>
 #include <functional>
 #include <memory>
 #include <set>
 #include <utility>
+#include <vector>
 
 #include "latest_version_spirv_header.h"
+#include "util/function_ref.h"
 
 namespace libspirv {
 
 // A set of values of a 32-bit enum type.
-// It is fast and compact for the common case, where enum values
-// are at most 63.  But it can represent enums with larger values,
-// as may appear in extensions.
+// Its values are kept as bits in a few buckets of 64 consecutive values,
+// stored inline, so that it never allocates for the enums of the grammar: they
+// have few clusters of values, such as the core values and the ranges of each
+// vendor, even though those reach into the thousands.  It can represent any
+// value, though: the values of further buckets go to an overflow set.
 template <typename EnumType>
 class EnumSet {
  private:
+  // The number of buckets stored inline.
+  static const uint32_t kMaxBuckets = 8;
+
   // The ForEach method will call the functor on enum values in
   // enum value order (lowest to highest).  To make that easier, use
   // an ordered set for the overflow values.
@@ -53,15 +61,15 @@ class EnumSet {
   EnumSet(const EnumSet& other) { *this = other; }
   // Move constructor.  The moved-from set is emptied.
   EnumSet(EnumSet&& other) {
-    mask_ = other.mask_;
+    CopyBuckets(other);
     overflow_ = std::move(other.overflow_);
-    other.mask_ = 0;
+    other.num_buckets_ = 0;
     other.overflow_.reset(nullptr);
   }
   // Assignment operator.
   EnumSet& operator=(const EnumSet& other) {
     if (&other != this) {
-      mask_ = other.mask_;
+      CopyBuckets(other);
       overflow_.reset(other.overflow_ ? new OverflowSetType(*other.overflow_)
                                       : nullptr);
     }
@@ -77,18 +85,21 @@ class EnumSet {
 
   // Applies f to each enum in the set, in order from smallest enum
   // value to largest.
-  void ForEach(std::function<void(EnumType)> f) const {
-    for (uint32_t i = 0; i < 64; ++i) {
-      if (mask_ & AsMask(i)) f(static_cast<EnumType>(i));
-    }
-    if (overflow_) {
-      for (uint32_t c : *overflow_) f(static_cast<EnumType>(c));
+  void ForEach(spvutils::FunctionRef<void(EnumType)> f) const {
+    if (overflow_ && !overflow_->empty()) {
+      // The overflow values may lie between the buckets.
+      std::vector<uint32_t> words(overflow_->begin(), overflow_->end());
+      ForEachBucketWord([&words](uint32_t word) { words.push_back(word); });
+      std::sort(words.begin(), words.end());
+      for (uint32_t word : words) f(static_cast<EnumType>(word));
+      return;
     }
+    ForEachBucketWord([&f](uint32_t word) { f(static_cast<EnumType>(word)); });
   }
 
   // Returns true if the set is empty.
   bool IsEmpty() const {
-    if (mask_) return false;
+    if (num_buckets_) return false;
     if (overflow_ && !overflow_->empty()) return false;
     return true;
   }
@@ -98,56 +109,116 @@ class EnumSet {
   bool HasAnyOf(const EnumSet<EnumType>& in_set) const {
     if (in_set.IsEmpty()) return true;
 
-    if (mask_ & in_set.mask_) return true;
-
-    if (!overflow_ || !in_set.overflow_) return false;
+    // The buckets of both sets are in increasing order.
+    for (uint32_t i = 0, j = 0;
+         i < num_buckets_ && j < in_set.num_buckets_;) {
+      if (bases_[i] < in_set.bases_[j]) {
+        ++i;
+      } else if (bases_[i] > in_set.bases_[j]) {
+        ++j;
+      } else {
+        if (bits_[i] & in_set.bits_[j]) return true;
+        ++i;
+        ++j;
+      }
+    }
 
-    for (uint32_t item : *in_set.overflow_) {
-      if (overflow_->find(item) != overflow_->end()) return true;
+    if (in_set.overflow_) {
+      for (uint32_t item : *in_set.overflow_) {
+        if (ContainsWord(item)) return true;
+      }
+    }
+    if (overflow_) {
+      for (uint32_t item : *overflow_) {
+        if (in_set.ContainsWord(item)) return true;
+      }
     }
 
     return false;
   }
 
+  // Returns true if both sets have the same elements.
+  bool operator==(const EnumSet<EnumType>& other) const {
+    if ((overflow_ && !overflow_->empty()) ||
+        (other.overflow_ && !other.overflow_->empty())) {
+      return Words() == other.Words();
+    }
+    return num_buckets_ == other.num_buckets_ &&
+           std::equal(bases_, bases_ + num_buckets_, other.bases_) &&
+           std::equal(bits_, bits_ + num_buckets_, other.bits_);
+  }
+  bool operator!=(const EnumSet<EnumType>& other) const {
+    return !(*this == other);
+  }
+
  private:
   // Adds the given enum value (as a 32-bit word) to the set.  This has no
   // effect if the enum value is already in the set.
   void AddWord(uint32_t word) {
-    if (auto new_bits = AsMask(word)) {
-      mask_ |= new_bits;
-    } else {
-      Overflow().insert(word);
+    const uint32_t base = word & ~63u;
+    uint32_t i = 0;
+    while (i < num_buckets_ && bases_[i] < base) ++i;
+    if (i == num_buckets_ || bases_[i] != base) {
+      if (num_buckets_ == kMaxBuckets) {
+        Overflow().insert(word);
+        return;
+      }
+      for (uint32_t j = num_buckets_; j > i; --j) {
+        bases_[j] = bases_[j - 1];
+        bits_[j] = bits_[j - 1];
+      }
+      bases_[i] = base;
+      bits_[i] = 0;
+      ++num_buckets_;
     }
+    bits_[i] |= uint64_t(1) << (word - base);
   }
 
   // Returns true if the enum represented as a 32-bit word is in the set.
   bool ContainsWord(uint32_t word) const {
+    const uint32_t base = word & ~63u;
+    for (uint32_t i = 0; i < num_buckets_ && bases_[i] <= base; ++i) {
+      if (bases_[i] == base) return (bits_[i] >> (word - base)) & 1;
+    }
     // We shouldn't call Overflow() since this is a const method.
-    if (auto bits = AsMask(word)) {
-      return (mask_ & bits) != 0;
-    } else if (auto overflow = overflow_.get()) {
+    if (auto overflow = overflow_.get()) {
       return overflow->find(word) != overflow->end();
     }
-    // The word is large, but the set doesn't have large members, so
-    // it doesn't have an overflow set.
     return false;
   }
 
+  // Applies f to each value stored in the buckets, in increasing order.
+  template <typename Function>
+  void ForEachBucketWord(Function f) const {
+    for (uint32_t i = 0; i < num_buckets_; ++i) {
+      uint64_t bits = bits_[i];
+      for (uint32_t offset = 0; bits; ++offset, bits >>= 1) {
+        if (bits & 1) f(bases_[i] + offset);
+      }
+    }
+  }
+
+  // Returns the values of the set in increasing order.
+  std::vector<uint32_t> Words() const {
+    std::vector<uint32_t> words;
+    ForEach([&words](EnumType c) { words.push_back(ToWord(c)); });
+    return words;
+  }
+
+  // Copies the buckets of |other|.
+  void CopyBuckets(const EnumSet& other) {
+    num_buckets_ = other.num_buckets_;
+    std::copy(other.bases_, other.bases_ + num_buckets_, bases_);
+    std::copy(other.bits_, other.bits_ + num_buckets_, bits_);
+  }
+
   // Returns the enum value as a uint32_t.
-  uint32_t ToWord(EnumType value) const {
+  static uint32_t ToWord(EnumType value) {
     static_assert(sizeof(EnumType) <= sizeof(uint32_t),
                   "EnumType must statically castable to uint32_t");
     return static_cast<uint32_t>(value);
   }
 
-  // Determines whether the given enum value can be represented
-  // as a bit in a uint64_t mask. If so, then returns that mask bit.
-  // Otherwise, returns 0.
-  uint64_t AsMask(uint32_t word) const {
-    if (word > 63) return 0;
-    return uint64_t(1) << word;
-  }
-
   // Ensures that overflow_set_ references a set.  A new empty set is
   // allocated if one doesn't exist yet.  Returns overflow_set_.
   OverflowSetType& Overflow() {
@@ -157,14 +228,19 @@ class EnumSet {
     return *overflow_;
   }
 
-  // Enums with values up to 63 are stored as bits in this mask.
-  uint64_t mask_ = 0;
-  // Enums with values larger than 63 are stored in this set.
-  // This set should normally be empty or very small.
+  // The number of buckets in use.
+  uint32_t num_buckets_ = 0;
+  // The first value of each bucket in use, a multiple of 64, in increasing
+  // order.
+  uint32_t bases_[kMaxBuckets] = {};
+  // The values in each bucket in use, as bits from its first value.
+  uint64_t bits_[kMaxBuckets] = {};
+  // Enums from further buckets are stored in this set.  It is normally not
+  // allocated.
   std::unique_ptr<OverflowSetType> overflow_ = {};
 };
 
-// A set of SpvCapability, optimized for small capability values.
+// A set of SpvCapability.
 using CapabilitySet = EnumSet<SpvCapability>;
 
 }  // namespace libspirv
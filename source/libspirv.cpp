@@ -14,6 +14,7 @@
 
 #include "spirv-tools/libspirv.hpp"
 
+#include "spirv_validator_options.h"
 #include "table.h"
 
 namespace spvtools {
@@ -42,6 +43,10 @@ spv_context& Context::CContext() { return context_; }
 
 const spv_context& Context::CContext() const { return context_; }
 
+void ValidatorOptions::SetTimeReport(std::ostream* out) {
+  options_->time_report_stream = out;
+}
+
 // Structs for holding the data members for SpvTools.
 struct SpirvTools::Impl {
   explicit Impl(spv_target_env env) : context(spvContextCreate(env)) {
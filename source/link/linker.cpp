@@ -28,6 +28,7 @@
 #include "opt/build_module.h"
 #include "opt/compact_ids_pass.h"
 #include "opt/decoration_manager.h"
+#include "opt/dedup_functions_pass.h"
 #include "opt/ir_loader.h"
 #include "opt/make_unique.h"
 #include "opt/pass_manager.h"
@@ -253,12 +254,29 @@ spv_result_t Link(const Context& context, const uint32_t* const* binaries,
                                           &linked_context);
   if (res != SPV_SUCCESS) return res;
 
-  // Phase 9: Compact the IDs used in the module
+  // Phase 9: Replace identical functions coming from different modules with a
+  // single copy, if requested. Exported functions are kept when creating a
+  // library, as their linkage attributes are still there.
+  if (options.GetDedupFunctions()) {
+    opt::DedupFunctionsPass::DedupStats stats;
+    PassManager dedup_manager;
+    dedup_manager.SetMessageConsumer(consumer);
+    dedup_manager.AddPass<opt::DedupFunctionsPass>(&stats);
+    pass_res = dedup_manager.Run(&linked_context);
+    if (pass_res == opt::Pass::Status::Failure) return SPV_ERROR_INVALID_DATA;
+
+    libspirv::DiagnosticStream(position, consumer, SPV_SUCCESS)
+        << "Removed " << stats.removed_functions_
+        << " duplicate functions, saving " << stats.removed_bytes_
+        << " bytes.";
+  }
+
+  // Phase 10: Compact the IDs used in the module
   manager.AddPass<opt::CompactIdsPass>();
   pass_res = manager.Run(&linked_context);
   if (pass_res == opt::Pass::Status::Failure) return SPV_ERROR_INVALID_DATA;
 
-  // Phase 10: Output the module
+  // Phase 11: Output the module
   linked_context.module()->ToBinary(linked_binary, true);
 
   return SPV_SUCCESS;
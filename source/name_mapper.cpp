@@ -26,16 +26,15 @@
 
 #include "latest_version_spirv_header.h"
 #include "parsed_operand.h"
+#include "util/string_utils.h"
 
 namespace {
 
 // Converts a uint32_t to its string decimal representation.
 std::string to_string(uint32_t id) {
-  // Use stringstream, since some versions of Android compilers lack
+  // Use spvutils::ToString, since some versions of Android compilers lack
   // std::to_string.
-  std::stringstream os;
-  os << id;
-  return os.str();
+  return spvutils::ToString(id);
 }
 
 }  // anonymous namespace
@@ -465,6 +465,22 @@ bool AggressiveDCEPass::AggressiveDCE(ir::Function* func) {
   return modified;
 }
 
+void AggressiveDCEPass::MarkFunctionLive(ir::Function* func) {
+  func->ForEachInst([this](ir::Instruction* inst) { AddToWorklist(inst); });
+  // Perform closure over the operands and types only.  Everything in |func|
+  // is already live, so only module-scope instructions can be added.
+  while (!worklist_.empty()) {
+    ir::Instruction* liveInst = worklist_.front();
+    liveInst->ForEachInId([this](const uint32_t* iid) {
+      AddToWorklist(get_def_use_mgr()->GetDef(*iid));
+    });
+    if (liveInst->type_id() != 0) {
+      AddToWorklist(get_def_use_mgr()->GetDef(liveInst->type_id()));
+    }
+    worklist_.pop();
+  }
+}
+
 void AggressiveDCEPass::Initialize(ir::IRContext* c) {
   InitializeProcessing(c);
 
@@ -511,8 +527,15 @@ Pass::Status AggressiveDCEPass::ProcessImpl() {
 
   InitializeModuleScopeLiveInstructions();
 
-  // Process all entry point functions.
-  ProcessFunction pfn = [this](ir::Function* fp) { return AggressiveDCE(fp); };
+  // Process all entry point functions.  A settled function has no dead code,
+  // but the module-scope instructions it uses must still be marked live.
+  ProcessFunction pfn = [this](ir::Function* fp) {
+    if (IsFunctionSettled(fp)) {
+      MarkFunctionLive(fp);
+      return false;
+    }
+    return RecordFunctionResult(fp, AggressiveDCE(fp));
+  };
   modified |= ProcessEntryPointCallTree(pfn, get_module());
 
   // Process module-level instructions. Now that all live instructions have
@@ -525,7 +548,9 @@ Pass::Status AggressiveDCEPass::ProcessImpl() {
   }
 
   // Cleanup all CFG including all unreachable blocks.
-  ProcessFunction cleanup = [this](ir::Function* f) { return CFGCleanup(f); };
+  ProcessFunction cleanup = [this](ir::Function* f) {
+    return RecordFunctionResult(f, CFGCleanup(f));
+  };
   modified |= ProcessEntryPointCallTree(cleanup, get_module());
 
   return modified ? Status::SuccessWithChange : Status::SuccessWithoutChange;
@@ -547,6 +572,9 @@ bool AggressiveDCEPass::EliminateDeadFunctions() {
        funcIter != get_module()->end();) {
     if (live_function_set.count(&*funcIter) == 0) {
       modified = true;
+      if (context()->change_tracker()) {
+        context()->change_tracker()->ForgetFunction(&*funcIter);
+      }
       EliminateFunction(&*funcIter);
       funcIter = funcIter.Erase();
     } else {
@@ -44,6 +44,7 @@ class AggressiveDCEPass : public MemPass {
   AggressiveDCEPass();
   const char* name() const override { return "eliminate-dead-code-aggressive"; }
   Status Process(ir::IRContext* c) override;
+  bool RecordsFunctionChanges() const override { return true; }
 
   ir::IRContext::Analysis GetPreservedAnalyses() override {
     return ir::IRContext::kAnalysisDefUse;
@@ -78,6 +79,10 @@ class AggressiveDCEPass : public MemPass {
     }
   }
 
+  // Marks all instructions in |func| live, along with the module-scope
+  // instructions they use.  Used for functions that have no dead code.
+  void MarkFunctionLive(ir::Function* func);
+
   // Add all store instruction which use |ptrId|, directly or indirectly,
   // to the live instruction worklist.
   void AddStores(uint32_t ptrId);
@@ -99,7 +99,7 @@ void BasicBlock::KillAllInsts(bool killLabel) {
 }
 
 void BasicBlock::ForEachSuccessorLabel(
-    const std::function<void(const uint32_t)>& f) const {
+    spvutils::FunctionRef<void(const uint32_t)> f) const {
   const auto br = &insts_.back();
   switch (br->opcode()) {
     case SpvOpBranch: {
@@ -119,7 +119,7 @@ void BasicBlock::ForEachSuccessorLabel(
 }
 
 void BasicBlock::ForEachSuccessorLabel(
-    const std::function<void(uint32_t*)>& f) {
+    spvutils::FunctionRef<void(uint32_t*)> f) {
   auto br = &insts_.back();
   switch (br->opcode()) {
     case SpvOpBranch: {
@@ -150,7 +150,7 @@ bool BasicBlock::IsSuccessor(const ir::BasicBlock* block) const {
 }
 
 void BasicBlock::ForMergeAndContinueLabel(
-    const std::function<void(const uint32_t)>& f) {
+    spvutils::FunctionRef<void(const uint32_t)> f) {
   auto ii = insts_.end();
   --ii;
   if (ii == insts_.begin()) return;
@@ -28,6 +28,7 @@
 #include "instruction.h"
 #include "instruction_list.h"
 #include "iterator.h"
+#include "util/function_ref.h"
 
 namespace spvtools {
 namespace ir {
@@ -125,44 +126,44 @@ class BasicBlock {
 
   // Runs the given function |f| on each instruction in this basic block, and
   // optionally on the debug line instructions that might precede them.
-  inline void ForEachInst(const std::function<void(Instruction*)>& f,
+  inline void ForEachInst(spvutils::FunctionRef<void(Instruction*)> f,
                           bool run_on_debug_line_insts = false);
-  inline void ForEachInst(const std::function<void(const Instruction*)>& f,
+  inline void ForEachInst(spvutils::FunctionRef<void(const Instruction*)> f,
                           bool run_on_debug_line_insts = false) const;
 
   // Runs the given function |f| on each instruction in this basic block, and
   // optionally on the debug line instructions that might precede them. If |f|
   // returns false, iteration is terminated and this function returns false.
-  inline bool WhileEachInst(const std::function<bool(Instruction*)>& f,
+  inline bool WhileEachInst(spvutils::FunctionRef<bool(Instruction*)> f,
                             bool run_on_debug_line_insts = false);
-  inline bool WhileEachInst(const std::function<bool(const Instruction*)>& f,
+  inline bool WhileEachInst(spvutils::FunctionRef<bool(const Instruction*)> f,
                             bool run_on_debug_line_insts = false) const;
 
   // Runs the given function |f| on each Phi instruction in this basic block,
   // and optionally on the debug line instructions that might precede them.
-  inline void ForEachPhiInst(const std::function<void(Instruction*)>& f,
+  inline void ForEachPhiInst(spvutils::FunctionRef<void(Instruction*)> f,
                              bool run_on_debug_line_insts = false);
 
   // Runs the given function |f| on each Phi instruction in this basic block,
   // and optionally on the debug line instructions that might precede them. If
   // |f| returns false, iteration is terminated and this function return false.
-  inline bool WhileEachPhiInst(const std::function<bool(Instruction*)>& f,
+  inline bool WhileEachPhiInst(spvutils::FunctionRef<bool(Instruction*)> f,
                                bool run_on_debug_line_insts = false);
 
   // Runs the given function |f| on each label id of each successor block
   void ForEachSuccessorLabel(
-      const std::function<void(const uint32_t)>& f) const;
+      spvutils::FunctionRef<void(const uint32_t)> f) const;
 
   // Runs the given function |f| on each label id of each successor block.
   // Modifying the pointed value will change the branch taken by the basic
   // block. It is the caller responsibility to update or invalidate the CFG.
-  void ForEachSuccessorLabel(const std::function<void(uint32_t*)>& f);
+  void ForEachSuccessorLabel(spvutils::FunctionRef<void(uint32_t*)> f);
 
   // Returns true if |block| is a direct successor of |this|.
   bool IsSuccessor(const ir::BasicBlock* block) const;
 
   // Runs the given function |f| on the merge and continue label, if any
-  void ForMergeAndContinueLabel(const std::function<void(const uint32_t)>& f);
+  void ForMergeAndContinueLabel(spvutils::FunctionRef<void(const uint32_t)> f);
 
   // Returns true if this basic block has any Phi instructions.
   bool HasPhiInstructions() {
@@ -233,7 +234,7 @@ inline void BasicBlock::AddInstructions(BasicBlock* bp) {
 }
 
 inline bool BasicBlock::WhileEachInst(
-    const std::function<bool(Instruction*)>& f, bool run_on_debug_line_insts) {
+    spvutils::FunctionRef<bool(Instruction*)> f, bool run_on_debug_line_insts) {
   if (label_) {
     if (!label_->WhileEachInst(f, run_on_debug_line_insts)) return false;
   }
@@ -251,7 +252,7 @@ inline bool BasicBlock::WhileEachInst(
 }
 
 inline bool BasicBlock::WhileEachInst(
-    const std::function<bool(const Instruction*)>& f,
+    spvutils::FunctionRef<bool(const Instruction*)> f,
     bool run_on_debug_line_insts) const {
   if (label_) {
     if (!static_cast<const Instruction*>(label_.get())
@@ -266,7 +267,7 @@ inline bool BasicBlock::WhileEachInst(
   return true;
 }
 
-inline void BasicBlock::ForEachInst(const std::function<void(Instruction*)>& f,
+inline void BasicBlock::ForEachInst(spvutils::FunctionRef<void(Instruction*)> f,
                                     bool run_on_debug_line_insts) {
   WhileEachInst(
       [&f](Instruction* inst) {
@@ -277,7 +278,7 @@ inline void BasicBlock::ForEachInst(const std::function<void(Instruction*)>& f,
 }
 
 inline void BasicBlock::ForEachInst(
-    const std::function<void(const Instruction*)>& f,
+    spvutils::FunctionRef<void(const Instruction*)> f,
     bool run_on_debug_line_insts) const {
   WhileEachInst(
       [&f](const Instruction* inst) {
@@ -288,7 +289,7 @@ inline void BasicBlock::ForEachInst(
 }
 
 inline bool BasicBlock::WhileEachPhiInst(
-    const std::function<bool(Instruction*)>& f, bool run_on_debug_line_insts) {
+    spvutils::FunctionRef<bool(Instruction*)> f, bool run_on_debug_line_insts) {
   if (insts_.empty()) {
     return true;
   }
@@ -304,7 +305,7 @@ inline bool BasicBlock::WhileEachPhiInst(
 }
 
 inline void BasicBlock::ForEachPhiInst(
-    const std::function<void(Instruction*)>& f, bool run_on_debug_line_insts) {
+    spvutils::FunctionRef<void(Instruction*)> f, bool run_on_debug_line_insts) {
   WhileEachPhiInst(
       [&f](Instruction* inst) {
         f(inst);
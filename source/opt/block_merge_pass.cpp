@@ -141,7 +141,8 @@ void BlockMergePass::Initialize(ir::IRContext* c) { InitializeProcessing(c); }
 
 Pass::Status BlockMergePass::ProcessImpl() {
   // Process all entry point functions.
-  ProcessFunction pfn = [this](ir::Function* fp) { return MergeBlocks(fp); };
+  ProcessFunction pfn = SkipSettledFunctions(
+      [this](ir::Function* fp) { return MergeBlocks(fp); });
   bool modified = ProcessEntryPointCallTree(pfn, get_module());
   return modified ? Status::SuccessWithChange : Status::SuccessWithoutChange;
 }
@@ -39,6 +39,7 @@ class BlockMergePass : public Pass {
   BlockMergePass();
   const char* name() const override { return "merge-blocks"; }
   Status Process(ir::IRContext*) override;
+  bool RecordsFunctionChanges() const override { return true; }
 
  private:
   // Kill any OpName instruction referencing |inst|, then kill |inst|.
@@ -16,6 +16,7 @@
 
 #include "ir_context.h"
 #include "ir_loader.h"
+#include "lazy_function_loader.h"
 #include "make_unique.h"
 #include "table.h"
 
@@ -47,7 +48,16 @@ spv_result_t SetSpvInst(void* builder, const spv_parsed_instruction_t* inst) {
 std::unique_ptr<ir::IRContext> BuildModule(spv_target_env env,
                                            MessageConsumer consumer,
                                            const uint32_t* binary,
-                                           const size_t size) {
+                                           const size_t size,
+                                           bool lazy_function_bodies) {
+  if (lazy_function_bodies) {
+    auto irContext = MakeUnique<ir::IRContext>(env, consumer);
+    auto loader =
+        std::make_shared<ir::LazyFunctionLoader>(env, consumer, binary, size);
+    if (!loader->LoadModule(irContext->module())) return nullptr;
+    return irContext;
+  }
+
   auto context = spvContextCreate(env);
   libspirv::SetContextMessageConsumer(context, consumer);
 
@@ -63,6 +73,21 @@ std::unique_ptr<ir::IRContext> BuildModule(spv_target_env env,
   return status == SPV_SUCCESS ? std::move(irContext) : nullptr;
 }
 
+std::unique_ptr<ir::IRContext> BuildModuleInParallel(spv_target_env env,
+                                                     MessageConsumer consumer,
+                                                     const uint32_t* binary,
+                                                     const size_t size,
+                                                     uint32_t num_threads) {
+  if (num_threads <= 1) return BuildModule(env, consumer, binary, size);
+
+  auto irContext = MakeUnique<ir::IRContext>(env, consumer);
+  auto loader =
+      std::make_shared<ir::LazyFunctionLoader>(env, consumer, binary, size);
+  if (!loader->LoadModuleInParallel(irContext->module(), num_threads))
+    return nullptr;
+  return irContext;
+}
+
 std::unique_ptr<ir::IRContext> BuildModule(spv_target_env env,
                                            MessageConsumer consumer,
                                            const std::string& text,
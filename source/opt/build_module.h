@@ -28,9 +28,25 @@ namespace spvtools {
 // |binary|. |size| specifies number of words in |binary|. The |binary| will be
 // decoded according to the given target |env|. Returns nullptr if errors occur
 // and sends the errors to |consumer|.
+//
+// If |lazy_function_bodies| is true, the parameters, basic blocks and
+// OpFunctionEnd of each function are only loaded when they are first accessed,
+// and the bodies which are never accessed are written back verbatim by
+// ir::Module::ToBinary().  A copy of |binary| is kept until all the bodies are
+// loaded.
 std::unique_ptr<ir::IRContext> BuildModule(spv_target_env env,
                                            MessageConsumer consumer,
-                                           const uint32_t* binary, size_t size);
+                                           const uint32_t* binary, size_t size,
+                                           bool lazy_function_bodies = false);
+
+// Like the above, but builds the function bodies using up to |num_threads|
+// threads, once the module has been parsed.  The module is the same as the one
+// built with a single thread, including the unique ids of the instructions.
+std::unique_ptr<ir::IRContext> BuildModuleInParallel(spv_target_env env,
+                                                     MessageConsumer consumer,
+                                                     const uint32_t* binary,
+                                                     size_t size,
+                                                     uint32_t num_threads);
 
 // Builds an ir::Module and returns the owning ir::IRContext from the given
 // SPIR-V assembly |text|.  The |text| will be encoded according to the given
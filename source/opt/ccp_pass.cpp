@@ -318,9 +318,9 @@ Pass::Status CCPPass::Process(ir::IRContext* c) {
   Initialize(c);
 
   // Process all entry point functions.
-  ProcessFunction pfn = [this](ir::Function* fp) {
+  ProcessFunction pfn = SkipSettledFunctions([this](ir::Function* fp) {
     return PropagateConstants(fp);
-  };
+  });
   bool modified = ProcessReachableCallTree(pfn, context());
   return modified ? Pass::Status::SuccessWithChange
                   : Pass::Status::SuccessWithoutChange;
@@ -30,6 +30,7 @@ class CCPPass : public MemPass {
   CCPPass() = default;
   const char* name() const override { return "ccp"; }
   Status Process(ir::IRContext* c) override;
+  bool RecordsFunctionChanges() const override { return true; }
 
  private:
   // Initializes the pass.
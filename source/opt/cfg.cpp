@@ -91,7 +91,7 @@ void CFG::ComputeStructuredOrder(ir::Function* func, ir::BasicBlock* root,
 }
 
 void CFG::ForEachBlockInPostOrder(BasicBlock* bb,
-                                  const std::function<void(BasicBlock*)>& f) {
+                                  spvutils::FunctionRef<void(BasicBlock*)> f) {
   std::vector<BasicBlock*> po;
   std::unordered_set<BasicBlock*> seen;
   ComputePostOrderTraversal(bb, &po, &seen);
@@ -104,7 +104,7 @@ void CFG::ForEachBlockInPostOrder(BasicBlock* bb,
 }
 
 void CFG::ForEachBlockInReversePostOrder(
-    BasicBlock* bb, const std::function<void(BasicBlock*)>& f) {
+    BasicBlock* bb, spvutils::FunctionRef<void(BasicBlock*)> f) {
   std::vector<BasicBlock*> po;
   std::unordered_set<BasicBlock*> seen;
   ComputePostOrderTraversal(bb, &po, &seen);
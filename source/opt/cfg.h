@@ -16,6 +16,7 @@
 #define LIBSPIRV_OPT_CFG_H_
 
 #include "basic_block.h"
+#include "util/function_ref.h"
 
 #include <algorithm>
 #include <list>
@@ -75,13 +76,13 @@ class CFG {
   // Note that basic blocks that cannot be reached from |bb| node will not be
   // processed.
   void ForEachBlockInPostOrder(BasicBlock* bb,
-                               const std::function<void(BasicBlock*)>& f);
+                               spvutils::FunctionRef<void(BasicBlock*)> f);
 
   // Applies |f| to the basic block in reverse post order starting with |bb|.
   // Note that basic blocks that cannot be reached from |bb| node will not be
   // processed.
   void ForEachBlockInReversePostOrder(
-      BasicBlock* bb, const std::function<void(BasicBlock*)>& f);
+      BasicBlock* bb, spvutils::FunctionRef<void(BasicBlock*)> f);
 
   // Registers |blk| as a basic block in the cfg, this also updates the
   // predecessor lists of each successor of |blk|.
@@ -0,0 +1,62 @@
+// Copyright (c) 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "change_tracker.h"
+
+namespace spvtools {
+namespace opt {
+
+void ChangeTracker::BeginPass(const std::string& pass_name) {
+  pass_name_ = pass_name;
+  changed_in_pass_.clear();
+}
+
+bool ChangeTracker::IsSettled(const ir::Function* func) const {
+  auto pass_it = settled_.find(pass_name_);
+  if (pass_it == settled_.end()) return false;
+  auto func_it = pass_it->second.find(func);
+  if (func_it == pass_it->second.end()) return false;
+  return func_it->second == GetVersion(func);
+}
+
+void ChangeTracker::MarkChanged(const ir::Function* func) {
+  ++versions_[func];
+  changed_in_pass_.insert(func);
+}
+
+void ChangeTracker::MarkUnchanged(const ir::Function* func) {
+  if (changed_in_pass_.count(func)) return;
+  settled_[pass_name_][func] = GetVersion(func);
+}
+
+void ChangeTracker::MarkModuleChanged() {
+  versions_.clear();
+  settled_.clear();
+}
+
+void ChangeTracker::ForgetFunction(const ir::Function* func) {
+  versions_.erase(func);
+  changed_in_pass_.erase(func);
+  for (auto& pass_and_functions : settled_) {
+    pass_and_functions.second.erase(func);
+  }
+}
+
+uint32_t ChangeTracker::GetVersion(const ir::Function* func) const {
+  auto it = versions_.find(func);
+  return it == versions_.end() ? 0 : it->second;
+}
+
+}  // namespace opt
+}  // namespace spvtools
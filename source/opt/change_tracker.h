@@ -0,0 +1,85 @@
+// Copyright (c) 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef LIBSPIRV_OPT_CHANGE_TRACKER_H_
+#define LIBSPIRV_OPT_CHANGE_TRACKER_H_
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace spvtools {
+namespace ir {
+class Function;
+}  // namespace ir
+
+namespace opt {
+
+// Records which functions the passes run on a module have changed, so that a
+// pass can skip a function it has already processed without effect when
+// nothing it depends on has changed since.
+//
+// A function is "settled" for a pass if the pass left it unchanged, and
+// neither the function nor the rest of the module changed afterwards.  Every
+// change to a function bumps its version, which unsettles it for every pass.
+// A change that is not attributed to a function unsettles everything.
+class ChangeTracker {
+ public:
+  // Starts recording the results of the pass named |pass_name|.  Settled
+  // queries and records refer to that pass until the next call.
+  void BeginPass(const std::string& pass_name);
+
+  // Returns true if |func| is settled for the current pass.
+  bool IsSettled(const ir::Function* func) const;
+
+  // Records that the current pass changed |func|.
+  void MarkChanged(const ir::Function* func);
+
+  // Records that the current pass processed |func| without changing it.  Has
+  // no effect if the current pass already changed |func|.
+  void MarkUnchanged(const ir::Function* func);
+
+  // Records a change that is not attributed to any function.  All functions
+  // become unsettled for all passes.
+  void MarkModuleChanged();
+
+  // Forgets everything about |func|, which is about to be deleted.
+  void ForgetFunction(const ir::Function* func);
+
+ private:
+  // Returns the current version of |func|.
+  uint32_t GetVersion(const ir::Function* func) const;
+
+  // The name of the pass whose results are being recorded.
+  std::string pass_name_;
+
+  // The number of recorded changes to each function.  Missing functions have
+  // not changed.
+  std::unordered_map<const ir::Function*, uint32_t> versions_;
+
+  // For each pass, the functions settled for it and their version at the time
+  // the pass left them unchanged.
+  std::unordered_map<std::string,
+                     std::unordered_map<const ir::Function*, uint32_t>>
+      settled_;
+
+  // The functions the current pass changed.
+  std::unordered_set<const ir::Function*> changed_in_pass_;
+};
+
+}  // namespace opt
+}  // namespace spvtools
+
+#endif  // LIBSPIRV_OPT_CHANGE_TRACKER_H_
@@ -0,0 +1,285 @@
+// Copyright (c) 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "code_sinking_pass.h"
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <unordered_set>
+#include <utility>
+
+#include "log.h"
+#include "register_pressure.h"
+
+namespace spvtools {
+namespace opt {
+
+Pass::Status CodeSinkingPass::Process(ir::IRContext* c) {
+  InitializeProcessing(c);
+
+  // Keeping instructions out of loops relies on structured control flow.
+  if (!context()->get_feature_mgr()->HasCapability(SpvCapabilityShader)) {
+    return Status::SuccessWithoutChange;
+  }
+
+  // A function settled at one threshold may still be sunk at a lower one, so
+  // settled functions are not skipped.
+  bool modified = false;
+  for (auto& func : *get_module()) {
+    if (RecordFunctionResult(&func, ProcessFunction(&func))) modified = true;
+  }
+  return modified ? Status::SuccessWithChange : Status::SuccessWithoutChange;
+}
+
+bool CodeSinkingPass::ProcessFunction(ir::Function* func) {
+  if (func->begin() == func->end()) return false;
+
+  const size_t registers_before = GetRegisterPressure(func);
+  size_t sunk = 0;
+  size_t rematerialized = 0;
+  if (registers_before > register_threshold_) {
+    sunk = SinkInstructions(func);
+    if (sunk != 0) {
+      context()->InvalidateAnalyses(ir::IRContext::kAnalysisRegisterPressure);
+    }
+
+    // Rematerializing creates instructions, so it is only done if sinking
+    // was not enough.
+    if (GetRegisterPressure(func) > register_threshold_) {
+      rematerialized = RematerializeInstructions(func);
+      if (rematerialized != 0) {
+        context()->InvalidateAnalyses(
+            ir::IRContext::kAnalysisRegisterPressure);
+      }
+    }
+  }
+  const size_t registers_after = GetRegisterPressure(func);
+
+  Logf(consumer(), SPV_MSG_INFO, name(), {0, 0, 0},
+       "function %%%u: register pressure %zu before, %zu after, %zu "
+       "instructions sunk, %zu rematerialized",
+       func->result_id(), registers_before, registers_after, sunk,
+       rematerialized);
+  if (stats_) {
+    stats_->functions_.push_back({func->result_id(), registers_before,
+                                  registers_after, sunk, rematerialized});
+  }
+  return sunk + rematerialized != 0;
+}
+
+size_t CodeSinkingPass::GetRegisterPressure(ir::Function* func) {
+  const RegisterLiveness* liveness =
+      context()->GetLivenessAnalysis()->Get(func);
+  size_t pressure = 0;
+  for (ir::BasicBlock& bb : *func) {
+    // Unreachable blocks have no liveness information.
+    if (const RegisterLiveness::RegionRegisterLiveness* block_liveness =
+            liveness->Get(&bb)) {
+      pressure = std::max(pressure, block_liveness->used_registers_);
+    }
+  }
+  return pressure;
+}
+
+size_t CodeSinkingPass::SinkInstructions(ir::Function* func) {
+  // Blocks are laid out after their dominators.  Visiting the blocks in
+  // reverse order, and the instructions of each block backward, moves the
+  // users of an instruction before the instruction itself, so that chains of
+  // instructions feeding a single use are sunk together.
+  std::vector<ir::BasicBlock*> blocks;
+  for (ir::BasicBlock& bb : *func) blocks.push_back(&bb);
+
+  size_t sunk = 0;
+  for (auto bb_it = blocks.rbegin(); bb_it != blocks.rend(); ++bb_it) {
+    std::vector<ir::Instruction*> insts;
+    for (ir::Instruction& inst : **bb_it) insts.push_back(&inst);
+
+    for (auto inst_it = insts.rbegin(); inst_it != insts.rend(); ++inst_it) {
+      ir::Instruction* inst = *inst_it;
+      if (!CanMove(inst)) continue;
+      ir::BasicBlock* target = GetSinkTarget(func, inst);
+      if (!target) continue;
+
+      inst->InsertBefore(GetInsertionPoint(target, inst));
+      context()->set_instr_block(inst, target);
+      ++sunk;
+    }
+  }
+  return sunk;
+}
+
+ir::BasicBlock* CodeSinkingPass::GetSinkTarget(ir::Function* func,
+                                               ir::Instruction* inst) {
+  ir::BasicBlock* def_block = context()->get_instr_block(inst);
+  DominatorAnalysis* dominators = context()->GetDominatorAnalysis(func);
+
+  // The nearest block dominating all the uses.  A phi uses its operand at the
+  // end of the corresponding predecessor.  Uses in unreachable blocks are not
+  // dominated by |def_block|, and keep |inst| in place.
+  ir::BasicBlock* target = nullptr;
+  const bool dominated = get_def_use_mgr()->WhileEachUse(
+      inst, [this, def_block, dominators, &target](ir::Instruction* user,
+                                                   uint32_t index) {
+        ir::BasicBlock* use_block = context()->get_instr_block(user);
+        if (!use_block) return true;
+        if (user->opcode() == SpvOpPhi) {
+          use_block =
+              context()->cfg()->block(user->GetSingleWordOperand(index + 1));
+        }
+        if (!dominators->Dominates(def_block, use_block)) return false;
+        target =
+            target ? dominators->CommonDominator(target, use_block) : use_block;
+        return true;
+      });
+  if (!dominated) return nullptr;
+
+  // Executing |inst| once per iteration of a loop would cost more than the
+  // registers it saves, so the target is moved out of such loops.
+  ir::LoopDescriptor* loops = context()->GetLoopDescriptor(func);
+  while (target && target != def_block &&
+         !StaysOutOfLoops(func, def_block, target)) {
+    ir::BasicBlock* header = (*loops)[target]->GetHeaderBlock();
+    target = dominators->ImmediateDominator(header);
+  }
+  return target == def_block ? nullptr : target;
+}
+
+size_t CodeSinkingPass::RematerializeInstructions(ir::Function* func) {
+  const RegisterLiveness* liveness =
+      context()->GetLivenessAnalysis()->Get(func);
+
+  std::vector<ir::Instruction*> candidates;
+  for (ir::BasicBlock& bb : *func) {
+    for (ir::Instruction& inst : bb) {
+      switch (inst.opcode()) {
+        case SpvOpAccessChain:
+        case SpvOpInBoundsAccessChain:
+        case SpvOpVectorShuffle:
+        case SpvOpCompositeExtract:
+          candidates.push_back(&inst);
+          break;
+        default:
+          break;
+      }
+    }
+  }
+
+  size_t rematerialized = 0;
+  for (ir::Instruction* inst : candidates) {
+    ir::BasicBlock* def_block = context()->get_instr_block(inst);
+
+    // The uses of |inst| in other blocks, by block.  Phis are left alone, as
+    // a copy would have to be placed in a predecessor.
+    std::map<uint32_t, std::vector<std::pair<ir::Instruction*, uint32_t>>>
+        uses_by_block;
+    get_def_use_mgr()->ForEachUse(
+        inst, [this, def_block, &uses_by_block](ir::Instruction* user,
+                                                uint32_t index) {
+          ir::BasicBlock* use_block = context()->get_instr_block(user);
+          if (!use_block || use_block == def_block ||
+              user->opcode() == SpvOpPhi) {
+            return;
+          }
+          uses_by_block[use_block->id()].push_back({user, index});
+        });
+
+    bool copied = false;
+    for (auto& block_and_uses : uses_by_block) {
+      ir::BasicBlock* bb = context()->cfg()->block(block_and_uses.first);
+      if (!StaysOutOfLoops(func, def_block, bb)) continue;
+
+      // A copy is only worth it if it does not extend the live range of its
+      // operands.  Constants and global variables are not registers.
+      const RegisterLiveness::RegionRegisterLiveness* block_liveness =
+          liveness->Get(bb);
+      if (!block_liveness) continue;
+      const bool operands_live = inst->WhileEachInId(
+          [this, block_liveness](const uint32_t* id) {
+            ir::Instruction* operand = get_def_use_mgr()->GetDef(*id);
+            return !context()->get_instr_block(operand) ||
+                   block_liveness->live_in_.count(operand) != 0;
+          });
+      if (!operands_live) continue;
+
+      std::unique_ptr<ir::Instruction> copy(inst->Clone(context()));
+      const uint32_t copy_id = TakeNextId();
+      copy->SetResultId(copy_id);
+      ir::Instruction* new_inst =
+          GetInsertionPoint(bb, inst)->InsertBefore(std::move(copy));
+      get_def_use_mgr()->AnalyzeInstDefUse(new_inst);
+      context()->set_instr_block(new_inst, bb);
+      context()->get_decoration_mgr()->CloneDecorations(inst->result_id(),
+                                                        copy_id);
+      for (auto& use : block_and_uses.second) {
+        use.first->SetOperand(use.second, {copy_id});
+        get_def_use_mgr()->AnalyzeInstUse(use.first);
+      }
+      copied = true;
+      ++rematerialized;
+    }
+
+    // Names and decorations do not keep |inst| alive.
+    if (copied && get_def_use_mgr()->WhileEachUser(
+                      inst, [this](ir::Instruction* user) {
+                        return context()->get_instr_block(user) == nullptr;
+                      })) {
+      context()->KillInst(inst);
+    }
+  }
+  return rematerialized;
+}
+
+bool CodeSinkingPass::CanMove(ir::Instruction* inst) {
+  if (!inst->HasResultId()) return false;
+  switch (inst->opcode()) {
+    case SpvOpAccessChain:
+    case SpvOpInBoundsAccessChain:
+    case SpvOpCompositeConstruct:
+    case SpvOpCompositeExtract:
+    case SpvOpCompositeInsert:
+    case SpvOpCopyObject:
+    case SpvOpSelect:
+      return true;
+    default:
+      return inst->IsOpcodeCodeMotionSafe();
+  }
+}
+
+bool CodeSinkingPass::StaysOutOfLoops(ir::Function* func,
+                                      ir::BasicBlock* from,
+                                      ir::BasicBlock* to) {
+  // If the innermost loop of |to| contains |from|, so do its parents.
+  ir::Loop* loop = (*context()->GetLoopDescriptor(func))[to];
+  return !loop || loop->IsInsideLoop(from);
+}
+
+ir::Instruction* CodeSinkingPass::GetInsertionPoint(ir::BasicBlock* bb,
+                                                    ir::Instruction* inst) {
+  std::unordered_set<ir::Instruction*> users;
+  get_def_use_mgr()->ForEachUser(
+      inst, [&users](ir::Instruction* user) { users.insert(user); });
+
+  ir::Instruction* merge = bb->GetMergeInst();
+  for (ir::Instruction& i : *bb) {
+    if (i.opcode() == SpvOpPhi) continue;
+    // Nothing may separate the merge instruction from the branch.
+    if (&i == merge) return merge;
+    if (users.count(&i)) return &i;
+  }
+  return &*bb->tail();
+}
+
+}  // namespace opt
+}  // namespace spvtools
@@ -0,0 +1,112 @@
+// Copyright (c) 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef LIBSPIRV_OPT_CODE_SINKING_PASS_H_
+#define LIBSPIRV_OPT_CODE_SINKING_PASS_H_
+
+#include <vector>
+
+#include "ir_context.h"
+#include "pass.h"
+
+namespace spvtools {
+namespace opt {
+
+// See optimizer.hpp for documentation.
+class CodeSinkingPass : public Pass {
+ public:
+  // Holds the register pressure of each function before and after the pass.
+  struct CodeSinkingStats {
+    struct FunctionPressure {
+      // Result id of the function.
+      uint32_t function_;
+      // Estimated register pressure of the function before and after.
+      size_t registers_before_;
+      size_t registers_after_;
+      // Number of instructions moved to another block.
+      size_t sunk_;
+      // Number of copies of instructions created next to their uses.
+      size_t rematerialized_;
+    };
+    std::vector<FunctionPressure> functions_;
+  };
+
+  // Creates a pass which sinks and rematerializes instructions in the
+  // functions whose estimated register pressure is above
+  // |register_threshold|.
+  explicit CodeSinkingPass(size_t register_threshold,
+                           CodeSinkingStats* stats = nullptr)
+      : register_threshold_(register_threshold), stats_(stats) {}
+
+  const char* name() const override { return "code-sink"; }
+  Status Process(ir::IRContext* c) override;
+  bool RecordsFunctionChanges() const override { return true; }
+
+  ir::IRContext::Analysis GetPreservedAnalyses() override {
+    return ir::IRContext::kAnalysisDefUse | ir::IRContext::kAnalysisCFG |
+           ir::IRContext::kAnalysisInstrToBlockMapping |
+           ir::IRContext::kAnalysisLoopAnalysis |
+           ir::IRContext::kAnalysisDecorations |
+           ir::IRContext::kAnalysisCombinators |
+           ir::IRContext::kAnalysisDominatorAnalysis |
+           ir::IRContext::kAnalysisNameMap;
+  }
+
+ private:
+  // Sinks and rematerializes instructions of |func| if its register pressure
+  // is above the threshold, and reports its pressure.  Returns true if |func|
+  // is modified.
+  bool ProcessFunction(ir::Function* func);
+
+  // Returns the largest number of registers used in a block of |func|.
+  size_t GetRegisterPressure(ir::Function* func);
+
+  // Moves the instructions of |func| that have no side effect to the nearest
+  // block dominating all their uses, as long as it is not in a loop they are
+  // not already in.  Returns the number of instructions moved.
+  size_t SinkInstructions(ir::Function* func);
+
+  // Returns the block |inst| should be moved to, or null if it should stay
+  // where it is.
+  ir::BasicBlock* GetSinkTarget(ir::Function* func, ir::Instruction* inst);
+
+  // Replaces the uses in other blocks of the cheap instructions of |func|
+  // whose operands are live in those blocks anyway by copies placed in the
+  // blocks of the uses.  Returns the number of copies created.
+  size_t RematerializeInstructions(ir::Function* func);
+
+  // Returns true if |inst| may be executed in a block other than its own:
+  // it has no side effect and does not depend on the control flow reaching
+  // it, like derivatives and implicit level of detail sampling do.
+  bool CanMove(ir::Instruction* inst);
+
+  // Returns true if moving from |from| to |to|, which |from| dominates, does
+  // not enter a loop |from| is not in.
+  bool StaysOutOfLoops(ir::Function* func, ir::BasicBlock* from,
+                       ir::BasicBlock* to);
+
+  // Returns the first instruction of |bb| which uses |inst|, or the merge or
+  // branch instruction of |bb| if none does.  The users that are phis are not
+  // considered.
+  ir::Instruction* GetInsertionPoint(ir::BasicBlock* bb,
+                                     ir::Instruction* inst);
+
+  size_t register_threshold_;
+  CodeSinkingStats* stats_;
+};
+
+}  // namespace opt
+}  // namespace spvtools
+
+#endif  // LIBSPIRV_OPT_CODE_SINKING_PASS_H_
@@ -376,9 +376,9 @@ Pass::Status DeadBranchElimPass::ProcessImpl() {
   for (auto& ai : get_module()->annotations())
     if (ai.opcode() == SpvOpGroupDecorate) return Status::SuccessWithoutChange;
   // Process all entry point functions
-  ProcessFunction pfn = [this](ir::Function* fp) {
+  ProcessFunction pfn = SkipSettledFunctions([this](ir::Function* fp) {
     return EliminateDeadBranches(fp);
-  };
+  });
   bool modified = ProcessReachableCallTree(pfn, context());
   return modified ? Status::SuccessWithChange : Status::SuccessWithoutChange;
 }
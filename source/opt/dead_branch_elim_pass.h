@@ -40,6 +40,7 @@ class DeadBranchElimPass : public MemPass {
   DeadBranchElimPass();
   const char* name() const override { return "eliminate-dead-branches"; }
   Status Process(ir::IRContext* context) override;
+  bool RecordsFunctionChanges() const override { return true; }
 
   ir::IRContext::Analysis GetPreservedAnalyses() override {
     return ir::IRContext::kAnalysisDefUse;
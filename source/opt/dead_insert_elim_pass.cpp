@@ -261,9 +261,9 @@ void DeadInsertElimPass::Initialize(ir::IRContext* c) {
 
 Pass::Status DeadInsertElimPass::ProcessImpl() {
   // Process all entry point functions.
-  ProcessFunction pfn = [this](ir::Function* fp) {
+  ProcessFunction pfn = SkipSettledFunctions([this](ir::Function* fp) {
     return EliminateDeadInserts(fp);
-  };
+  });
   bool modified = ProcessEntryPointCallTree(pfn, get_module());
   return modified ? Status::SuccessWithChange : Status::SuccessWithoutChange;
 }
@@ -38,6 +38,7 @@ class DeadInsertElimPass : public MemPass {
   DeadInsertElimPass();
   const char* name() const override { return "eliminate-dead-inserts"; }
   Status Process(ir::IRContext*) override;
+  bool RecordsFunctionChanges() const override { return true; }
 
  private:
   // Return the number of subcomponents in the composite type |typeId|.
@@ -320,7 +320,7 @@ std::vector<T> DecorationManager::InternalGetDecorationsFor(
 
 bool DecorationManager::WhileEachDecoration(
     uint32_t id, uint32_t decoration,
-    std::function<bool(const ir::Instruction&)> f) {
+    spvutils::FunctionRef<bool(const ir::Instruction&)> f) {
   for (const ir::Instruction* inst : GetDecorationsFor(id, true)) {
     switch (inst->opcode()) {
       case SpvOpMemberDecorate:
@@ -344,7 +344,7 @@ bool DecorationManager::WhileEachDecoration(
 
 void DecorationManager::ForEachDecoration(
     uint32_t id, uint32_t decoration,
-    std::function<void(const ir::Instruction&)> f) {
+    spvutils::FunctionRef<void(const ir::Instruction&)> f) {
   WhileEachDecoration(id, decoration, [&f](const ir::Instruction& inst) {
     f(inst);
     return true;
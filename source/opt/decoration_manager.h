@@ -22,6 +22,7 @@
 
 #include "instruction.h"
 #include "module.h"
+#include "util/function_ref.h"
 
 namespace spvtools {
 namespace opt {
@@ -77,14 +78,15 @@ class DecorationManager {
   // |decoration|. Processed are all decorations which target |id| either
   // directly or indirectly by Decoration Groups.
   void ForEachDecoration(uint32_t id, uint32_t decoration,
-                         std::function<void(const ir::Instruction&)> f);
+                         spvutils::FunctionRef<void(const ir::Instruction&)> f);
 
   // |f| is run on each decoration instruction for |id| with decoration
   // |decoration|. Processes all decoration which target |id| either directly or
   // indirectly through decoration groups. If |f| returns false, iteration is
   // terminated and this function returns false.
-  bool WhileEachDecoration(uint32_t id, uint32_t decoration,
-                           std::function<bool(const ir::Instruction&)> f);
+  bool WhileEachDecoration(
+      uint32_t id, uint32_t decoration,
+      spvutils::FunctionRef<bool(const ir::Instruction&)> f);
 
   // Clone all decorations from one id |from|.
   // The cloned decorations are assigned to the given id |to| and are
@@ -0,0 +1,199 @@
+// Copyright (c) 2018 Google LLC.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "dedup_functions_pass.h"
+
+#include <vector>
+
+#include "decoration_manager.h"
+#include "opcode.h"
+#include "operand.h"
+
+namespace spvtools {
+namespace opt {
+
+namespace {
+
+const uint32_t kEntryPointFunctionIdInIdx = 1;
+
+// Tags of the operands in the canonical form of a function.
+enum CanonicalTag : uint32_t {
+  kLocalId = 1,
+  kGlobalId,
+  kLiteral,
+  kDecoration,
+};
+
+}  // namespace
+
+Pass::Status DedupFunctionsPass::Process(ir::IRContext* c) {
+  InitializeProcessing(c);
+
+  entry_point_funcs_.clear();
+  for (auto& e : get_module()->entry_points())
+    entry_point_funcs_.insert(
+        e.GetSingleWordInOperand(kEntryPointFunctionIdInIdx));
+  retained_funcs_ = entry_point_funcs_;
+  for (auto& a : get_module()->annotations()) {
+    if (a.opcode() == SpvOpDecorate &&
+        a.GetSingleWordInOperand(1) == SpvDecorationLinkageAttributes) {
+      retained_funcs_.insert(a.GetSingleWordInOperand(0));
+    }
+  }
+
+  CanonicalizeGlobalValues();
+
+  // Replacing a function can make its callers identical, so repeat until no
+  // more functions are removed.
+  bool modified = false;
+  bool removed = true;
+  while (removed) {
+    removed = false;
+    std::unordered_map<std::u32string, uint32_t> first_funcs;
+    for (auto func = get_module()->begin(); func != get_module()->end();) {
+      // Function declarations have nothing to share, and entry points cannot
+      // be called, so they are never used as a replacement.
+      if (func->begin() == func->end() ||
+          entry_point_funcs_.count(func->result_id())) {
+        ++func;
+        continue;
+      }
+
+      auto first = first_funcs.emplace(CanonicalForm(*func), func->result_id());
+      if (first.second || retained_funcs_.count(func->result_id())) {
+        ++func;
+        continue;
+      }
+
+      ReplaceFunction(&*func, first.first->second);
+      func = func.Erase();
+      removed = true;
+    }
+    modified |= removed;
+  }
+
+  return modified ? Status::SuccessWithChange : Status::SuccessWithoutChange;
+}
+
+uint32_t DedupFunctionsPass::CanonicalGlobalId(uint32_t id) const {
+  auto it = canonical_global_ids_.find(id);
+  return it == canonical_global_ids_.end() ? id : it->second;
+}
+
+void DedupFunctionsPass::CanonicalizeGlobalValues() {
+  canonical_global_ids_.clear();
+
+  // Linking does not merge constants, so each module brings its own copy.
+  std::unordered_map<std::u32string, uint32_t> first_values;
+  for (auto& inst : get_module()->types_values()) {
+    if (!spvOpcodeIsConstantOrUndef(inst.opcode()) ||
+        spvOpcodeIsSpecConstant(inst.opcode()) ||
+        !get_decoration_mgr()->GetDecorationsFor(inst.result_id(), true)
+             .empty()) {
+      continue;
+    }
+
+    std::u32string key;
+    key.push_back(inst.opcode());
+    key.push_back(inst.type_id());
+    for (uint32_t i = 0; i < inst.NumInOperands(); ++i) {
+      const ir::Operand& operand = inst.GetInOperand(i);
+      if (spvIsIdType(operand.type)) {
+        key.push_back(CanonicalGlobalId(operand.words[0]));
+      } else {
+        key.push_back(static_cast<uint32_t>(operand.words.size()));
+        key.append(operand.words.begin(), operand.words.end());
+      }
+    }
+
+    auto first = first_values.emplace(key, inst.result_id());
+    canonical_global_ids_[inst.result_id()] = first.first->second;
+  }
+}
+
+std::u32string DedupFunctionsPass::CanonicalForm(
+    const ir::Function& func) const {
+  // Number the ids defined in |func| in definition order.
+  std::unordered_map<uint32_t, uint32_t> local_ids;
+  std::vector<uint32_t> defined_ids;
+  func.ForEachInst([&local_ids, &defined_ids](const ir::Instruction* inst) {
+    if (inst->result_id() == 0) return;
+    local_ids.emplace(inst->result_id(),
+                      static_cast<uint32_t>(local_ids.size()));
+    defined_ids.push_back(inst->result_id());
+  });
+
+  std::u32string form;
+  const auto append_operand = [this, &local_ids,
+                               &form](const ir::Operand& operand) {
+    if (spvIsIdType(operand.type)) {
+      auto local = local_ids.find(operand.words[0]);
+      if (local != local_ids.end()) {
+        form.push_back(kLocalId);
+        form.push_back(local->second);
+      } else {
+        form.push_back(kGlobalId);
+        form.push_back(CanonicalGlobalId(operand.words[0]));
+      }
+    } else {
+      form.push_back(kLiteral);
+      form.push_back(static_cast<uint32_t>(operand.words.size()));
+      form.append(operand.words.begin(), operand.words.end());
+    }
+  };
+
+  func.ForEachInst([&form, &append_operand](const ir::Instruction* inst) {
+    form.push_back(inst->opcode());
+    form.push_back(inst->NumOperands());
+    for (const auto& operand : *inst) append_operand(operand);
+  });
+
+  // Decorations change the semantics of the ids they apply to. Linkage
+  // attributes only matter for retained functions, which are never removed.
+  for (uint32_t id : defined_ids) {
+    for (const ir::Instruction* decoration :
+         get_decoration_mgr()->GetDecorationsFor(id, false)) {
+      form.push_back(kDecoration);
+      form.push_back(local_ids.at(id));
+      form.push_back(decoration->opcode());
+      for (uint32_t i = 1; i < decoration->NumInOperands(); ++i)
+        append_operand(decoration->GetInOperand(i));
+    }
+  }
+
+  return form;
+}
+
+void DedupFunctionsPass::ReplaceFunction(ir::Function* func,
+                                         uint32_t replacement) {
+  const uint32_t func_id = func->result_id();
+  if (stats_) {
+    ++stats_->removed_functions_;
+    func->ForEachInst(
+        [this](const ir::Instruction* inst) {
+          stats_->removed_bytes_ +=
+              sizeof(uint32_t) * (inst->NumOperandWords() + 1);
+        },
+        true);
+  }
+
+  // The names and decorations of |func| must not end up on |replacement|.
+  context()->KillNamesAndDecorates(func_id);
+  context()->ReplaceAllUsesWith(func_id, replacement);
+  func->ForEachInst(
+      [this](ir::Instruction* inst) { context()->KillInst(inst); }, true);
+}
+
+}  // namespace opt
+}  // namespace spvtools
@@ -0,0 +1,82 @@
+// Copyright (c) 2018 Google LLC.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef LIBSPIRV_OPT_DEDUP_FUNCTIONS_PASS_H_
+#define LIBSPIRV_OPT_DEDUP_FUNCTIONS_PASS_H_
+
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "function.h"
+#include "ir_context.h"
+#include "module.h"
+#include "pass.h"
+
+namespace spvtools {
+namespace opt {
+
+// See optimizer.hpp for documentation.
+class DedupFunctionsPass : public Pass {
+ public:
+  // Holds some statistics about the removed functions.
+  struct DedupStats {
+    // Number of functions replaced by an identical function.
+    size_t removed_functions_ = 0;
+    // Size in bytes of the instructions of the removed functions.
+    size_t removed_bytes_ = 0;
+  };
+
+  // If |stats| is not null, it is filled with statistics about the pass.
+  explicit DedupFunctionsPass(DedupStats* stats = nullptr) : stats_(stats) {}
+
+  const char* name() const override { return "dedup-functions"; }
+  Status Process(ir::IRContext* c) override;
+
+ private:
+  // Returns the canonical form of the global value |id|: constants and undefs
+  // with the same type and value share the same canonical id, so that
+  // functions coming from different modules can be compared.
+  uint32_t CanonicalGlobalId(uint32_t id) const;
+
+  // Computes the canonical ids of all the constants and undefs of the module.
+  void CanonicalizeGlobalValues();
+
+  // Returns the canonical form of |func|: its instructions and the
+  // decorations of the ids it defines, where the ids defined in |func| are
+  // replaced by their definition order. Two functions are interchangeable if
+  // their canonical forms are equal.
+  std::u32string CanonicalForm(const ir::Function& func) const;
+
+  // Replaces all the uses of |func| with |replacement| and removes |func|
+  // from the module.
+  void ReplaceFunction(ir::Function* func, uint32_t replacement);
+
+  // Maps the ids of constants and undefs to their canonical id.
+  std::unordered_map<uint32_t, uint32_t> canonical_global_ids_;
+
+  // Ids of the entry point functions.
+  std::unordered_set<uint32_t> entry_point_funcs_;
+
+  // Ids of the functions which must stay in the module: entry points and
+  // functions with linkage attributes.
+  std::unordered_set<uint32_t> retained_funcs_;
+
+  DedupStats* stats_;
+};
+
+}  // namespace opt
+}  // namespace spvtools
+
+#endif  // LIBSPIRV_OPT_DEDUP_FUNCTIONS_PASS_H_
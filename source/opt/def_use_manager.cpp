@@ -115,7 +115,7 @@ bool DefUseManager::UsersNotEnd(const IdToUsersMap::const_iterator& iter,
 
 bool DefUseManager::WhileEachUser(
     const ir::Instruction* def,
-    const std::function<bool(ir::Instruction*)>& f) const {
+    spvutils::FunctionRef<bool(ir::Instruction*)> f) const {
   // Ensure that |def| has been registered.
   assert(def && (!def->HasResultId() || def == GetDef(def->result_id())) &&
          "Definition is not registered.");
@@ -129,13 +129,13 @@ bool DefUseManager::WhileEachUser(
 }
 
 bool DefUseManager::WhileEachUser(
-    uint32_t id, const std::function<bool(ir::Instruction*)>& f) const {
+    uint32_t id, spvutils::FunctionRef<bool(ir::Instruction*)> f) const {
   return WhileEachUser(GetDef(id), f);
 }
 
 void DefUseManager::ForEachUser(
     const ir::Instruction* def,
-    const std::function<void(ir::Instruction*)>& f) const {
+    spvutils::FunctionRef<void(ir::Instruction*)> f) const {
   WhileEachUser(def, [&f](ir::Instruction* user) {
     f(user);
     return true;
@@ -143,13 +143,13 @@ void DefUseManager::ForEachUser(
 }
 
 void DefUseManager::ForEachUser(
-    uint32_t id, const std::function<void(ir::Instruction*)>& f) const {
+    uint32_t id, spvutils::FunctionRef<void(ir::Instruction*)> f) const {
   ForEachUser(GetDef(id), f);
 }
 
 bool DefUseManager::WhileEachUse(
     const ir::Instruction* def,
-    const std::function<bool(ir::Instruction*, uint32_t)>& f) const {
+    spvutils::FunctionRef<bool(ir::Instruction*, uint32_t)> f) const {
   // Ensure that |def| has been registered.
   assert(def && (!def->HasResultId() || def == GetDef(def->result_id())) &&
          "Definition is not registered.");
@@ -172,13 +172,13 @@ bool DefUseManager::WhileEachUse(
 
 bool DefUseManager::WhileEachUse(
     uint32_t id,
-    const std::function<bool(ir::Instruction*, uint32_t)>& f) const {
+    spvutils::FunctionRef<bool(ir::Instruction*, uint32_t)> f) const {
   return WhileEachUse(GetDef(id), f);
 }
 
 void DefUseManager::ForEachUse(
     const ir::Instruction* def,
-    const std::function<void(ir::Instruction*, uint32_t)>& f) const {
+    spvutils::FunctionRef<void(ir::Instruction*, uint32_t)> f) const {
   WhileEachUse(def, [&f](ir::Instruction* user, uint32_t index) {
     f(user, index);
     return true;
@@ -187,7 +187,7 @@ void DefUseManager::ForEachUse(
 
 void DefUseManager::ForEachUse(
     uint32_t id,
-    const std::function<void(ir::Instruction*, uint32_t)>& f) const {
+    spvutils::FunctionRef<void(ir::Instruction*, uint32_t)> f) const {
   ForEachUse(GetDef(id), f);
 }
 
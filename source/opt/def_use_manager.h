@@ -23,6 +23,7 @@
 #include "instruction.h"
 #include "module.h"
 #include "spirv-tools/libspirv.hpp"
+#include "util/function_ref.h"
 
 namespace spvtools {
 namespace opt {
@@ -133,9 +134,9 @@ class DefUseManager {
   //
   // |def| (or |id|) must be registered as a definition.
   void ForEachUser(const ir::Instruction* def,
-                   const std::function<void(ir::Instruction*)>& f) const;
+                   spvutils::FunctionRef<void(ir::Instruction*)> f) const;
   void ForEachUser(uint32_t id,
-                   const std::function<void(ir::Instruction*)>& f) const;
+                   spvutils::FunctionRef<void(ir::Instruction*)> f) const;
 
   // Runs the given function |f| on each unique user instruction of |def| (or
   // |id|). If |f| returns false, iteration is terminated and this function
@@ -146,9 +147,9 @@ class DefUseManager {
   //
   // |def| (or |id|) must be registered as a definition.
   bool WhileEachUser(const ir::Instruction* def,
-                     const std::function<bool(ir::Instruction*)>& f) const;
+                     spvutils::FunctionRef<bool(ir::Instruction*)> f) const;
   bool WhileEachUser(uint32_t id,
-                     const std::function<bool(ir::Instruction*)>& f) const;
+                     spvutils::FunctionRef<bool(ir::Instruction*)> f) const;
 
   // Runs the given function |f| on each unique use of |def| (or
   // |id|).
@@ -158,11 +159,13 @@ class DefUseManager {
   //
   // |def| (or |id|) must be registered as a definition.
   void ForEachUse(const ir::Instruction* def,
-                  const std::function<void(ir::Instruction*,
-                                           uint32_t operand_index)>& f) const;
+                  spvutils::FunctionRef<void(ir::Instruction*,
+                                             uint32_t operand_index)>
+                      f) const;
   void ForEachUse(uint32_t id,
-                  const std::function<void(ir::Instruction*,
-                                           uint32_t operand_index)>& f) const;
+                  spvutils::FunctionRef<void(ir::Instruction*,
+                                             uint32_t operand_index)>
+                      f) const;
 
   // Runs the given function |f| on each unique use of |def| (or
   // |id|). If |f| returns false, iteration is terminated and this function
@@ -173,11 +176,13 @@ class DefUseManager {
   //
   // |def| (or |id|) must be registered as a definition.
   bool WhileEachUse(const ir::Instruction* def,
-                    const std::function<bool(ir::Instruction*,
-                                             uint32_t operand_index)>& f) const;
+                    spvutils::FunctionRef<bool(ir::Instruction*,
+                                               uint32_t operand_index)>
+                        f) const;
   bool WhileEachUse(uint32_t id,
-                    const std::function<bool(ir::Instruction*,
-                                             uint32_t operand_index)>& f) const;
+                    spvutils::FunctionRef<bool(ir::Instruction*,
+                                               uint32_t operand_index)>
+                        f) const;
 
   // Returns the number of users of |def| (or |id|).
   uint32_t NumUsers(const ir::Instruction* def) const;
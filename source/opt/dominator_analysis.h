@@ -20,6 +20,7 @@
 
 #include "dominator_tree.h"
 #include "module.h"
+#include "util/function_ref.h"
 
 namespace spvtools {
 namespace opt {
@@ -100,15 +101,15 @@ class DominatorAnalysisBase {
   // Force the dominator tree to be removed
   inline void ClearTree() { tree_.ClearTree(); }
 
-  // Applies the std::function |func| to dominator tree nodes in dominator
+  // Applies the function |func| to dominator tree nodes in dominator
   // order.
-  void Visit(std::function<bool(DominatorTreeNode*)> func) {
+  void Visit(spvutils::FunctionRef<bool(DominatorTreeNode*)> func) {
     tree_.Visit(func);
   }
 
-  // Applies the std::function |func| to dominator tree nodes in dominator
+  // Applies the function |func| to dominator tree nodes in dominator
   // order.
-  void Visit(std::function<bool(const DominatorTreeNode*)> func) const {
+  void Visit(spvutils::FunctionRef<bool(const DominatorTreeNode*)> func) const {
     tree_.Visit(func);
   }
 
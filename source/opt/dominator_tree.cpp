@@ -14,206 +14,30 @@
 
 #include <iostream>
 #include <memory>
-#include <set>
+#include <queue>
+#include <unordered_map>
+#include <unordered_set>
 
-#include "cfa.h"
 #include "dominator_tree.h"
 #include "ir_context.h"
+#include "util/dominators.h"
 
 using namespace spvtools;
 using namespace spvtools::opt;
 
 // Calculates the dominator or postdominator tree for a given function.
-// 1 - Compute the successors and predecessors for each BasicBlock. We add a
-// dummy node for the start node or for postdominators the exit. This node will
-// point to all entry or all exit nodes.
-// 2 - Using the CFA::DepthFirstTraversal get a depth first postordered list of
-// all BasicBlocks. Using the successors (or for postdominator, predecessors)
-// calculated in step 1 to traverse the tree.
-// 3 - Pass the list calculated in step 2 to the CFA::CalculateDominators using
-// the predecessors list (or for postdominator, successors). This will give us a
-// vector of BB pairs. Each BB and its immediate dominator.
-// 4 - Using the list from 3 use those edges to build a tree of
-// DominatorTreeNodes. Each node containing a link to the parent dominator and
-// children which are dominated.
-// 5 - Using the tree from 4, perform a depth first traversal to calculate the
-// preorder and postorder index of each node. We use these indexes to compare
-// nodes against each other for domination checks.
-
-namespace {
-
-// Wrapper around CFA::DepthFirstTraversal to provide an interface to perform
-// depth first search on generic BasicBlock types. Will call post and pre order
-// user defined functions during traversal
-//
-// BBType - BasicBlock type. Will either be ir::BasicBlock or DominatorTreeNode
-// SuccessorLambda - Lamdba matching the signature of 'const
-// std::vector<BBType>*(const BBType *A)'. Will return a vector of the nodes
-// succeding BasicBlock A.
-// PostLambda - Lamdba matching the signature of 'void (const BBType*)' will be
-// called on each node traversed AFTER their children.
-// PreLambda - Lamdba matching the signature of 'void (const BBType*)' will be
-// called on each node traversed BEFORE their children.
-template <typename BBType, typename SuccessorLambda, typename PreLambda,
-          typename PostLambda>
-static void DepthFirstSearch(const BBType* bb, SuccessorLambda successors,
-                             PreLambda pre, PostLambda post) {
-  // Ignore backedge operation.
-  auto nop_backedge = [](const BBType*, const BBType*) {};
-  CFA<BBType>::DepthFirstTraversal(bb, successors, pre, post, nop_backedge);
-}
-
-// Wrapper around CFA::DepthFirstTraversal to provide an interface to perform
-// depth first search on generic BasicBlock types. This overload is for only
-// performing user defined post order.
-//
-// BBType - BasicBlock type. Will either be ir::BasicBlock or DominatorTreeNode
-// SuccessorLambda - Lamdba matching the signature of 'const
-// std::vector<BBType>*(const BBType *A)'. Will return a vector of the nodes
-// succeding BasicBlock A.
-// PostLambda - Lamdba matching the signature of 'void (const BBType*)' will be
-// called on each node traversed after their children.
-template <typename BBType, typename SuccessorLambda, typename PostLambda>
-static void DepthFirstSearchPostOrder(const BBType* bb,
-                                      SuccessorLambda successors,
-                                      PostLambda post) {
-  // Ignore preorder operation.
-  auto nop_preorder = [](const BBType*) {};
-  DepthFirstSearch(bb, successors, nop_preorder, post);
-}
-
-// Small type trait to get the function class type.
-template <typename BBType>
-struct GetFunctionClass {
-  using FunctionType = ir::Function;
-};
-
-// Helper class to compute predecessors and successors for each Basic Block in a
-// function. Through GetPredFunctor and GetSuccessorFunctor it provides an
-// interface to get the successor and predecessor lists for each basic
-// block. This is required by the DepthFirstTraversal and ComputeDominator
-// functions which take as parameter an std::function returning the successors
-// and predecessors respectively.
-//
-// When computing the post-dominator tree, all edges are inverted. So successors
-// returned by this class will be predecessors in the original CFG.
-template <typename BBType>
-class BasicBlockSuccessorHelper {
-  // This should eventually become const ir::BasicBlock.
-  using BasicBlock = BBType;
-  using Function = typename GetFunctionClass<BBType>::FunctionType;
-
-  using BasicBlockListTy = std::vector<BasicBlock*>;
-  using BasicBlockMapTy = std::map<const BasicBlock*, BasicBlockListTy>;
-
- public:
-  // For compliance with the dominance tree computation, entry nodes are
-  // connected to a single dummy node.
-  BasicBlockSuccessorHelper(Function& func, const BasicBlock* dummy_start_node,
-                            bool post);
-
-  // CFA::CalculateDominators requires std::vector<BasicBlock*>.
-  using GetBlocksFunction =
-      std::function<const std::vector<BasicBlock*>*(const BasicBlock*)>;
-
-  // Returns the list of predecessor functions.
-  GetBlocksFunction GetPredFunctor() {
-    return [this](const BasicBlock* bb) {
-      BasicBlockListTy* v = &this->predecessors_[bb];
-      return v;
-    };
-  }
-
-  // Returns a vector of the list of successor nodes from a given node.
-  GetBlocksFunction GetSuccessorFunctor() {
-    return [this](const BasicBlock* bb) {
-      BasicBlockListTy* v = &this->successors_[bb];
-      return v;
-    };
-  }
-
- private:
-  bool invert_graph_;
-  BasicBlockMapTy successors_;
-  BasicBlockMapTy predecessors_;
-
-  // Build the successors and predecessors map for each basic blocks |f|.
-  // If |invert_graph_| is true, all edges are reversed (successors becomes
-  // predecessors and vice versa).
-  // For convenience, the start of the graph is |dummy_start_node|.
-  // The dominator tree construction requires a unique entry node, which cannot
-  // be guaranteed for the postdominator graph. The |dummy_start_node| BB is
-  // here to gather all entry nodes.
-  void CreateSuccessorMap(Function& f, const BasicBlock* dummy_start_node);
-};
-
-template <typename BBType>
-BasicBlockSuccessorHelper<BBType>::BasicBlockSuccessorHelper(
-    Function& func, const BasicBlock* dummy_start_node, bool invert)
-    : invert_graph_(invert) {
-  CreateSuccessorMap(func, dummy_start_node);
-}
-
-template <typename BBType>
-void BasicBlockSuccessorHelper<BBType>::CreateSuccessorMap(
-    Function& f, const BasicBlock* dummy_start_node) {
-  std::map<uint32_t, BasicBlock*> id_to_BB_map;
-  auto GetSuccessorBasicBlock = [&f, &id_to_BB_map](uint32_t successor_id) {
-    BasicBlock*& Succ = id_to_BB_map[successor_id];
-    if (!Succ) {
-      for (BasicBlock& BBIt : f) {
-        if (successor_id == BBIt.id()) {
-          Succ = &BBIt;
-          break;
-        }
-      }
-    }
-    return Succ;
-  };
-
-  if (invert_graph_) {
-    // For the post dominator tree, we see the inverted graph.
-    // successors_ in the inverted graph are the predecessors in the CFG.
-    // The tree construction requires 1 entry point, so we add a dummy node
-    // that is connected to all function exiting basic blocks.
-    // An exiting basic block is a block with an OpKill, OpUnreachable,
-    // OpReturn or OpReturnValue as terminator instruction.
-    for (BasicBlock& bb : f) {
-      if (bb.hasSuccessor()) {
-        BasicBlockListTy& pred_list = predecessors_[&bb];
-        const auto& const_bb = bb;
-        const_bb.ForEachSuccessorLabel(
-            [this, &pred_list, &bb,
-             &GetSuccessorBasicBlock](const uint32_t successor_id) {
-              BasicBlock* succ = GetSuccessorBasicBlock(successor_id);
-              // Inverted graph: our successors in the CFG
-              // are our predecessors in the inverted graph.
-              this->successors_[succ].push_back(&bb);
-              pred_list.push_back(succ);
-            });
-      } else {
-        successors_[dummy_start_node].push_back(&bb);
-        predecessors_[&bb].push_back(const_cast<BasicBlock*>(dummy_start_node));
-      }
-    }
-  } else {
-    successors_[dummy_start_node].push_back(f.entry().get());
-    predecessors_[f.entry().get()].push_back(
-        const_cast<BasicBlock*>(dummy_start_node));
-    for (BasicBlock& bb : f) {
-      BasicBlockListTy& succ_list = successors_[&bb];
-
-      const auto& const_bb = bb;
-      const_bb.ForEachSuccessorLabel([&](const uint32_t successor_id) {
-        BasicBlock* succ = GetSuccessorBasicBlock(successor_id);
-        succ_list.push_back(succ);
-        predecessors_[succ].push_back(&bb);
-      });
-    }
-  }
-}
-
-}  // namespace
+// 1 - Number the BasicBlocks densely, and collect the edges of the CFG. We add
+// a dummy node for the start node or for postdominators the exit. This node
+// will point to all entry or all exit nodes.
+// 2 - Pass the graph to spvutils::Dominators, which computes the immediate
+// dominator of each BasicBlock, following the edges backwards for
+// postdominators, and numbers the resulting tree.
+// 3 - Using the immediate dominators, build a tree of DominatorTreeNodes. Each
+// node containing a link to the parent dominator and children which are
+// dominated, in the order of the function.
+// 4 - Each node takes the preorder and postorder index of a depth first
+// traversal of the tree. We use these indexes to compare nodes against each
+// other for domination checks.
 
 namespace spvtools {
 namespace opt {
@@ -279,8 +103,7 @@ ir::BasicBlock* DominatorTree::ImmediateDominator(uint32_t a) const {
 DominatorTreeNode* DominatorTree::GetOrInsertNode(ir::BasicBlock* bb) {
   DominatorTreeNode* dtn = nullptr;
 
-  std::map<uint32_t, DominatorTreeNode>::iterator node_iter =
-      nodes_.find(bb->id());
+  DominatorTreeNodeMap::iterator node_iter = nodes_.find(bb->id());
   if (node_iter == nodes_.end()) {
     dtn = &nodes_.emplace(std::make_pair(bb->id(), DominatorTreeNode{bb}))
                .first->second;
@@ -290,41 +113,6 @@ DominatorTreeNode* DominatorTree::GetOrInsertNode(ir::BasicBlock* bb) {
   return dtn;
 }
 
-void DominatorTree::GetDominatorEdges(
-    const ir::Function* f, const ir::BasicBlock* dummy_start_node,
-    std::vector<std::pair<ir::BasicBlock*, ir::BasicBlock*>>* edges) {
-  // Each time the depth first traversal calls the postorder callback
-  // std::function we push that node into the postorder vector to create our
-  // postorder list.
-  std::vector<const ir::BasicBlock*> postorder;
-  auto postorder_function = [&](const ir::BasicBlock* b) {
-    postorder.push_back(b);
-  };
-
-  // CFA::CalculateDominators requires std::vector<ir::BasicBlock*>
-  // BB are derived from F, so we need to const cast it at some point
-  // no modification is made on F.
-  BasicBlockSuccessorHelper<ir::BasicBlock> helper{
-      *const_cast<ir::Function*>(f), dummy_start_node, postdominator_};
-
-  // The successor function tells DepthFirstTraversal how to move to successive
-  // nodes by providing an interface to get a list of successor nodes from any
-  // given node.
-  auto successor_functor = helper.GetSuccessorFunctor();
-
-  // The predecessor functor does the same as the successor functor
-  // but for all nodes preceding a given node.
-  auto predecessor_functor = helper.GetPredFunctor();
-
-  // If we're building a post dominator tree we traverse the tree in reverse
-  // using the predecessor function in place of the successor function and vice
-  // versa.
-  DepthFirstSearchPostOrder(dummy_start_node, successor_functor,
-                            postorder_function);
-  *edges =
-      CFA<ir::BasicBlock>::CalculateDominators(postorder, predecessor_functor);
-}
-
 void DominatorTree::InitializeTree(const ir::Function* f) {
   ClearTree();
 
@@ -334,45 +122,315 @@ void DominatorTree::InitializeTree(const ir::Function* f) {
   }
   const ir::CFG& cfg = *f->context()->cfg();
 
-  const ir::BasicBlock* dummy_start_node =
-      postdominator_ ? cfg.pseudo_exit_block() : cfg.pseudo_entry_block();
-
-  // Get the immediate dominator for each node.
-  std::vector<std::pair<ir::BasicBlock*, ir::BasicBlock*>> edges;
-  GetDominatorEdges(f, dummy_start_node, &edges);
+  // BB are derived from F, so we need to const cast it at some point
+  // no modification is made on F.
+  ir::BasicBlock* dummy_start_node = const_cast<ir::BasicBlock*>(
+      postdominator_ ? cfg.pseudo_exit_block() : cfg.pseudo_entry_block());
+
+  // Number the blocks densely: the dummy node first, then the blocks of |f| in
+  // order.
+  std::vector<ir::BasicBlock*> blocks = {dummy_start_node};
+  std::unordered_map<uint32_t, uint32_t> index;
+  for (ir::BasicBlock& bb : *const_cast<ir::Function*>(f)) {
+    index[bb.id()] = static_cast<uint32_t>(blocks.size());
+    blocks.push_back(&bb);
+  }
 
-  // Transform the vector<pair> into the tree structure which we can use to
-  // efficiently query dominance.
-  for (auto edge : edges) {
-    DominatorTreeNode* first = GetOrInsertNode(edge.first);
+  // The dummy node leads to the entry of the function or, for the post
+  // dominator tree, is reached from every exiting block: one with an OpKill,
+  // OpUnreachable, OpReturn or OpReturnValue as terminator instruction.  The
+  // post dominator tree follows the edges backwards.
+  std::vector<std::pair<uint32_t, uint32_t>> edges;
+  if (!postdominator_) edges.emplace_back(0, 1);
+  for (uint32_t i = 1; i < blocks.size(); ++i) {
+    const ir::BasicBlock* bb = blocks[i];
+    if (postdominator_ && !bb->hasSuccessor()) edges.emplace_back(i, 0);
+    bb->ForEachSuccessorLabel([&edges, &index, i](const uint32_t successor_id) {
+      edges.emplace_back(i, index[successor_id]);
+    });
+  }
+  const spvutils::Dominators dominators(static_cast<uint32_t>(blocks.size()),
+                                        edges, 0, postdominator_);
+
+  // Transform the immediate dominators into the tree structure which we can
+  // use to efficiently query dominance.
+  std::vector<DominatorTreeNode*> nodes(blocks.size(), nullptr);
+  nodes_.reserve(dominators.preorder().size());
+  for (uint32_t i = 0; i < blocks.size(); ++i) {
+    if (!dominators.reachable(i)) continue;
+    DominatorTreeNode* node = GetOrInsertNode(blocks[i]);
+    node->dfs_num_pre_ =
+        static_cast<int>(dominators.tree_preorder_number(i));
+    node->dfs_num_post_ =
+        static_cast<int>(dominators.tree_postorder_number(i));
+    nodes[i] = node;
+  }
+  roots_.push_back(nodes[0]);
+  for (uint32_t i = 1; i < blocks.size(); ++i) {
+    if (!nodes[i]) continue;
+    DominatorTreeNode* parent = nodes[dominators.immediate_dominator(i)];
+    nodes[i]->parent_ = parent;
+    parent->children_.push_back(nodes[i]);
+  }
+  UpdateDepths(roots_.front());
+}
 
-    if (edge.first == edge.second) {
-      if (std::find(roots_.begin(), roots_.end(), first) == roots_.end())
-        roots_.push_back(first);
-      continue;
+void DominatorTree::ResetDFNumbering() {
+  int index = 0;
+  // The nodes of the current path, each with the position of the next child to
+  // visit.
+  std::vector<std::pair<DominatorTreeNode*, size_t>> stack;
+  for (DominatorTreeNode* root : roots_) {
+    root->dfs_num_pre_ = ++index;
+    stack.emplace_back(root, 0);
+    while (!stack.empty()) {
+      DominatorTreeNode* node = stack.back().first;
+      size_t& next_child = stack.back().second;
+      if (next_child == node->children_.size()) {
+        node->dfs_num_post_ = ++index;
+        stack.pop_back();
+        continue;
+      }
+      DominatorTreeNode* child = node->children_[next_child++];
+      child->dfs_num_pre_ = ++index;
+      stack.emplace_back(child, 0);
     }
+  }
+}
+
+void DominatorTree::InsertEdge(ir::BasicBlock* from, ir::BasicBlock* to) {
+  if (postdominator_) {
+    // The edge is followed backwards: it only matters if |to| reaches an exit.
+    if (GetTreeNode(to)) InitializeTree(from->GetParent());
+    return;
+  }
 
-    DominatorTreeNode* second = GetOrInsertNode(edge.second);
+  // An edge leaving an unreachable block does not change anything.
+  DominatorTreeNode* from_node = GetTreeNode(from);
+  if (!from_node) return;
 
-    first->parent_ = second;
-    second->children_.push_back(first);
+  DominatorTreeNode* to_node = GetTreeNode(to);
+  if (to_node) {
+    InsertReachableEdge(from_node, to_node, {});
+  } else {
+    AddReachableRegion(from, to);
   }
   ResetDFNumbering();
 }
 
-void DominatorTree::ResetDFNumbering() {
-  int index = 0;
-  auto preFunc = [&index](const DominatorTreeNode* node) {
-    const_cast<DominatorTreeNode*>(node)->dfs_num_pre_ = ++index;
-  };
+void DominatorTree::DeleteEdge(ir::BasicBlock* from, ir::BasicBlock* to) {
+  DominatorTreeNode* from_node = GetTreeNode(from);
+  DominatorTreeNode* to_node = GetTreeNode(to);
+  // The edge is not part of the tree if its source, or for a post-dominator
+  // tree its target, is not reachable.
+  if (!(postdominator_ ? to_node : from_node)) return;
+
+  // |from| may still branch to |to| through another operand.
+  bool still_linked = false;
+  from->ForEachSuccessorLabel([to, &still_linked](const uint32_t id) {
+    if (id == to->id()) still_linked = true;
+  });
+  if (still_linked) return;
 
-  auto postFunc = [&index](const DominatorTreeNode* node) {
-    const_cast<DominatorTreeNode*>(node)->dfs_num_post_ = ++index;
-  };
+  // A path using a back edge reaches its target before its source, so it can
+  // skip the cycle: removing the edge does not change dominance.
+  if (postdominator_ ? Dominates(from_node, to_node)
+                     : Dominates(to_node, from_node)) {
+    return;
+  }
+  InitializeTree(from->GetParent());
+}
+
+void DominatorTree::SplitBlock(ir::BasicBlock* bb, ir::BasicBlock* new_bb) {
+  // If |bb| is not in the tree, neither is |new_bb|.
+  DominatorTreeNode* node = GetTreeNode(bb);
+  if (!node) return;
+
+  if (postdominator_) {
+    InsertNodeAbove(node, new_bb);
+  } else {
+    InsertNodeBelow(node, new_bb);
+  }
+  ResetDFNumbering();
+}
+
+void DominatorTree::InsertBlockBefore(ir::BasicBlock* bb,
+                                      ir::BasicBlock* new_bb) {
+  // If |bb| is not in the tree, neither is |new_bb|.
+  DominatorTreeNode* node = GetTreeNode(bb);
+  if (!node) return;
+
+  if (postdominator_) {
+    InsertNodeBelow(node, new_bb);
+  } else {
+    InsertNodeAbove(node, new_bb);
+  }
+  ResetDFNumbering();
+}
+
+DominatorTreeNode* DominatorTree::AddNode(ir::BasicBlock* bb,
+                                          ir::BasicBlock* idom) {
+  assert(GetTreeNode(idom) && "The immediate dominator is not in the tree.");
+  DominatorTreeNode* node = GetOrInsertNode(bb);
+  Reparent(node, GetTreeNode(idom));
+  return node;
+}
+
+void DominatorTree::SetImmediateDominator(ir::BasicBlock* bb,
+                                          ir::BasicBlock* idom) {
+  assert(GetTreeNode(bb) && GetTreeNode(idom) &&
+         "The blocks are not in the tree.");
+  Reparent(GetTreeNode(bb), GetTreeNode(idom));
+}
+
+void DominatorTree::Reparent(DominatorTreeNode* node,
+                             DominatorTreeNode* parent) {
+  if (DominatorTreeNode* old_parent = node->parent_) {
+    old_parent->children_.erase(std::find(old_parent->children_.begin(),
+                                          old_parent->children_.end(), node));
+  }
+  node->parent_ = parent;
+  parent->children_.push_back(node);
+  UpdateDepths(node);
+}
 
-  auto getSucc = [](const DominatorTreeNode* node) { return &node->children_; };
+void DominatorTree::UpdateDepths(DominatorTreeNode* node) {
+  node->depth_ = node->parent_ ? node->parent_->depth_ + 1 : 0;
+  std::vector<DominatorTreeNode*> stack = {node};
+  while (!stack.empty()) {
+    DominatorTreeNode* parent = stack.back();
+    stack.pop_back();
+    for (DominatorTreeNode* child : parent->children_) {
+      child->depth_ = parent->depth_ + 1;
+      stack.push_back(child);
+    }
+  }
+}
+
+void DominatorTree::InsertNodeAbove(DominatorTreeNode* node,
+                                    ir::BasicBlock* new_bb) {
+  assert(node->parent_ && "Cannot insert a node above a root.");
+  DominatorTreeNode* new_node = GetOrInsertNode(new_bb);
+  DominatorTreeNode* parent = node->parent_;
+  *std::find(parent->children_.begin(), parent->children_.end(), node) =
+      new_node;
+  new_node->parent_ = parent;
+  new_node->children_.push_back(node);
+  node->parent_ = new_node;
+  UpdateDepths(new_node);
+}
+
+void DominatorTree::InsertNodeBelow(DominatorTreeNode* node,
+                                    ir::BasicBlock* new_bb) {
+  DominatorTreeNode* new_node = GetOrInsertNode(new_bb);
+  new_node->children_.swap(node->children_);
+  for (DominatorTreeNode* child : new_node->children_) {
+    child->parent_ = new_node;
+  }
+  node->children_.push_back(new_node);
+  new_node->parent_ = node;
+  UpdateDepths(new_node);
+}
+
+void DominatorTree::AddReachableRegion(ir::BasicBlock* from,
+                                       ir::BasicBlock* to) {
+  const ir::CFG& cfg = *from->GetParent()->context()->cfg();
+
+  // Number the blocks reached from |to| which are not in the tree yet, |from|
+  // being 0, and collect the edges between them. The edges leaving the region
+  // are inserted once it is in the tree.
+  std::vector<ir::BasicBlock*> blocks = {from, to};
+  std::unordered_map<uint32_t, uint32_t> index = {{to->id(), 1}};
+  std::vector<std::pair<uint32_t, uint32_t>> edges = {{0, 1}};
+  std::set<std::pair<uint32_t, uint32_t>> exits;
+  for (uint32_t i = 1; i < blocks.size(); ++i) {
+    const uint32_t id = blocks[i]->id();
+    blocks[i]->ForEachSuccessorLabel([&, i, id](const uint32_t successor_id) {
+      if (GetTreeNode(successor_id)) {
+        exits.emplace(id, successor_id);
+        return;
+      }
+      auto inserted = index.emplace(successor_id,
+                                    static_cast<uint32_t>(blocks.size()));
+      if (inserted.second) blocks.push_back(cfg.block(successor_id));
+      edges.emplace_back(i, inserted.first->second);
+    });
+  }
+
+  // Only |from| leads to the region, so the dominators of its blocks can be
+  // computed on the region alone.
+  const spvutils::Dominators dominators(static_cast<uint32_t>(blocks.size()),
+                                        edges, 0, false);
+  std::vector<DominatorTreeNode*> nodes = {GetTreeNode(from)};
+  for (uint32_t i = 1; i < blocks.size(); ++i) {
+    nodes.push_back(GetOrInsertNode(blocks[i]));
+  }
+  // The blocks are numbered in breadth first order from |from|, so each
+  // immediate dominator is already in place and no subtree is moved twice.
+  for (uint32_t i = 1; i < blocks.size(); ++i) {
+    Reparent(nodes[i], nodes[dominators.immediate_dominator(i)]);
+  }
+
+  while (!exits.empty()) {
+    const std::pair<uint32_t, uint32_t> edge = *exits.begin();
+    exits.erase(exits.begin());
+    InsertReachableEdge(GetTreeNode(edge.first), GetTreeNode(edge.second),
+                        exits);
+  }
+}
+
+void DominatorTree::InsertReachableEdge(
+    DominatorTreeNode* from, DominatorTreeNode* to,
+    const std::set<std::pair<uint32_t, uint32_t>>& pending) {
+  // The nearest common dominator of |from| and |to| becomes the immediate
+  // dominator of every affected block.
+  DominatorTreeNode* nca = from;
+  DominatorTreeNode* other = to;
+  while (nca != other) {
+    if (nca->depth_ >= other->depth_) {
+      nca = nca->parent_;
+    } else {
+      other = other->parent_;
+    }
+  }
+  const uint32_t min_depth = nca->depth_ + 1;
+  // Nothing changes if |nca| already is |to| or its immediate dominator.
+  if (to->depth_ <= min_depth) return;
+
+  // A block is affected if it is deeper than |min_depth| and a path from |to|
+  // reaches it through blocks which are all at least as deep. The affected
+  // blocks are processed deepest first; the search goes on through the deeper
+  // blocks, which keep their dominator.
+  std::vector<DominatorTreeNode*> affected = {to};
+  std::unordered_set<const DominatorTreeNode*> visited = {to};
+  std::priority_queue<std::pair<uint32_t, DominatorTreeNode*>> queue;
+  queue.emplace(to->depth_, to);
+  std::vector<DominatorTreeNode*> stack;
+  while (!queue.empty()) {
+    const uint32_t depth = queue.top().first;
+    stack.push_back(queue.top().second);
+    queue.pop();
+    while (!stack.empty()) {
+      DominatorTreeNode* node = stack.back();
+      stack.pop_back();
+      node->bb_->ForEachSuccessorLabel([&](const uint32_t successor_id) {
+        if (pending.count(std::make_pair(node->id(), successor_id))) return;
+        DominatorTreeNode* successor = GetTreeNode(successor_id);
+        if (!successor || successor->depth_ <= min_depth ||
+            !visited.insert(successor).second) {
+          return;
+        }
+        if (successor->depth_ > depth) {
+          stack.push_back(successor);
+        } else {
+          affected.push_back(successor);
+          queue.emplace(successor->depth_, successor);
+        }
+      });
+    }
+  }
 
-  for (auto root : roots_) DepthFirstSearch(root, getSucc, preFunc, postFunc);
+  for (DominatorTreeNode* node : affected) Reparent(node, nca);
 }
 
 void DominatorTree::DumpTreeAsDot(std::ostream& out_stream) const {
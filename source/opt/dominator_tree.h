@@ -18,12 +18,15 @@
 #include <algorithm>
 #include <cstdint>
 #include <map>
+#include <set>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
 #include "cfg.h"
 #include "module.h"
 #include "tree_iterator.h"
+#include "util/function_ref.h"
 
 namespace spvtools {
 namespace opt {
@@ -35,6 +38,7 @@ struct DominatorTreeNode {
       : bb_(bb),
         parent_(nullptr),
         children_({}),
+        depth_(0),
         dfs_num_pre_(-1),
         dfs_num_post_(-1) {}
 
@@ -81,6 +85,9 @@ struct DominatorTreeNode {
   DominatorTreeNode* parent_;
   std::vector<DominatorTreeNode*> children_;
 
+  // Depth of the node in the tree, its root being at depth 0.
+  uint32_t depth_;
+
   // These indexes are used to compare two given nodes. A node is a child or
   // grandchild of another node if its preorder index is greater than the
   // first nodes preorder index AND if its postorder index is less than the
@@ -94,7 +101,7 @@ struct DominatorTreeNode {
 class DominatorTree {
  public:
   // Map OpLabel ids to dominator tree nodes
-  using DominatorTreeNodeMap = std::map<uint32_t, DominatorTreeNode>;
+  using DominatorTreeNodeMap = std::unordered_map<uint32_t, DominatorTreeNode>;
   using iterator = TreeDFIterator<DominatorTreeNode>;
   using const_iterator = TreeDFIterator<const DominatorTreeNode>;
   using post_iterator = PostOrderTreeDFIterator<DominatorTreeNode>;
@@ -209,29 +216,29 @@ class DominatorTree {
     roots_.clear();
   }
 
-  // Applies the std::function |func| to all nodes in the dominator tree.
+  // Applies the function |func| to all nodes in the dominator tree.
   // Tree nodes are visited in a depth first pre-order.
-  bool Visit(std::function<bool(DominatorTreeNode*)> func) {
+  bool Visit(spvutils::FunctionRef<bool(DominatorTreeNode*)> func) {
     for (auto n : *this) {
       if (!func(&n)) return false;
     }
     return true;
   }
 
-  // Applies the std::function |func| to all nodes in the dominator tree.
+  // Applies the function |func| to all nodes in the dominator tree.
   // Tree nodes are visited in a depth first pre-order.
-  bool Visit(std::function<bool(const DominatorTreeNode*)> func) const {
+  bool Visit(spvutils::FunctionRef<bool(const DominatorTreeNode*)> func) const {
     for (auto n : *this) {
       if (!func(&n)) return false;
     }
     return true;
   }
 
-  // Applies the std::function |func| to all nodes in the dominator tree from
+  // Applies the function |func| to all nodes in the dominator tree from
   // |node| downwards. The boolean return from |func| is used to determine
   // whether or not the children should also be traversed. Tree nodes are
   // visited in a depth first pre-order.
-  void VisitChildrenIf(std::function<bool(DominatorTreeNode*)> func,
+  void VisitChildrenIf(spvutils::FunctionRef<bool(DominatorTreeNode*)> func,
                        iterator node) {
     if (func(&*node)) {
       for (auto n : *node) {
@@ -277,18 +284,69 @@ class DominatorTree {
   // Recomputes the DF numbering of the tree.
   void ResetDFNumbering();
 
+  // The following methods update the tree after a change to the control flow
+  // graph of its function, instead of building it again. The branches of the
+  // function must already reflect the change, and nothing else may have
+  // changed since the tree was last valid. They leave the DF numbering valid.
+
+  // Updates the tree after an edge from |from| to |to| was added. For a
+  // dominator tree, the blocks whose immediate dominator changes are found
+  // with the depth based search of Georgiadis et al., "An Experimental Study of
+  // Dynamic Dominators", 2012, and the blocks that only become reachable
+  // through the new edge are added to the tree. A post-dominator tree is
+  // rebuilt.
+  void InsertEdge(ir::BasicBlock* from, ir::BasicBlock* to);
+
+  // Updates the tree after an edge from |from| to |to| was removed. Nothing
+  // changes if the edge was a back edge, as a path using it can always skip the
+  // cycle; otherwise the tree is rebuilt.
+  void DeleteEdge(ir::BasicBlock* from, ir::BasicBlock* to);
+
+  // Updates the tree after |bb| was split in two: |new_bb| now has all the
+  // successors of |bb|, and |bb| branches to |new_bb| only.
+  void SplitBlock(ir::BasicBlock* bb, ir::BasicBlock* new_bb);
+
+  // Updates the tree after |new_bb| was inserted in front of |bb|: all the
+  // predecessors of |bb| now branch to |new_bb|, which branches to |bb| only.
+  void InsertBlockBefore(ir::BasicBlock* bb, ir::BasicBlock* new_bb);
+
+  // Adds the new basic block |bb| to the tree, immediately dominated by |idom|.
+  // This is meant for transforms which know the structure they create, and
+  // does not update the DF numbering: call ResetDFNumbering once all the
+  // blocks are added.
+  DominatorTreeNode* AddNode(ir::BasicBlock* bb, ir::BasicBlock* idom);
+
+  // Makes |idom| the immediate dominator of |bb|, moving the subtree of |bb|
+  // along with it. As for AddNode, the DF numbering is not updated.
+  void SetImmediateDominator(ir::BasicBlock* bb, ir::BasicBlock* idom);
+
  private:
-  // Wrapper function which gets the list of pairs of each BasicBlocks to its
-  // immediately  dominating BasicBlock and stores the result in the the edges
-  // parameter.
-  //
-  // The |edges| vector will contain the dominator tree as pairs of nodes.
-  // The first node in the pair is a node in the graph. The second node in the
-  // pair is its immediate dominator.
-  // The root of the tree has themself as immediate dominator.
-  void GetDominatorEdges(
-      const ir::Function* f, const ir::BasicBlock* dummy_start_node,
-      std::vector<std::pair<ir::BasicBlock*, ir::BasicBlock*>>* edges);
+  // Makes |node| a child of |parent|, removing it from its current parent.
+  static void Reparent(DominatorTreeNode* node, DominatorTreeNode* parent);
+
+  // Sets the depth of the nodes of the subtree of |node| from the depth of its
+  // parent.
+  static void UpdateDepths(DominatorTreeNode* node);
+
+  // Adds the node of |new_bb| between |node| and its parent.
+  void InsertNodeAbove(DominatorTreeNode* node, ir::BasicBlock* new_bb);
+
+  // Adds the node of |new_bb| as the only child of |node|, taking over its
+  // children.
+  void InsertNodeBelow(DominatorTreeNode* node, ir::BasicBlock* new_bb);
+
+  // Adds the blocks which become reachable through the new edge from |from| to
+  // the unreachable block |to|, then inserts the edges going from them to the
+  // rest of the tree. The blocks are looked up in the CFG of the context, so
+  // new blocks must have been registered with it.
+  void AddReachableRegion(ir::BasicBlock* from, ir::BasicBlock* to);
+
+  // Moves the blocks whose immediate dominator changes with the new edge from
+  // |from| to |to| of a dominator tree, both being already in the tree. The
+  // edges of |pending| are ignored, as they are not part of the tree yet.
+  void InsertReachableEdge(
+      DominatorTreeNode* from, DominatorTreeNode* to,
+      const std::set<std::pair<uint32_t, uint32_t>>& pending);
 
   // The roots of the tree.
   std::vector<DominatorTreeNode*> roots_;
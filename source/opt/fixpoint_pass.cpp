@@ -0,0 +1,40 @@
+// Copyright (c) 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "fixpoint_pass.h"
+
+namespace spvtools {
+namespace opt {
+
+Pass::Status FixpointPass::Process(ir::IRContext* c) {
+  InitializeProcessing(c);
+
+  bool modified = false;
+  for (uint32_t i = 0; i < max_iterations_; ++i) {
+    bool changed_in_iteration = false;
+    for (const PassCreator& create_pass : pass_creators_) {
+      std::unique_ptr<Pass> pass = create_pass();
+      pass->SetMessageConsumer(consumer());
+      Status status = pass->Run(context());
+      if (status == Status::Failure) return status;
+      if (status == Status::SuccessWithChange) changed_in_iteration = true;
+    }
+    if (!changed_in_iteration) break;
+    modified = true;
+  }
+  return modified ? Status::SuccessWithChange : Status::SuccessWithoutChange;
+}
+
+}  // namespace opt
+}  // namespace spvtools
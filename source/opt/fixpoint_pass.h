@@ -0,0 +1,55 @@
+// Copyright (c) 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef LIBSPIRV_OPT_FIXPOINT_PASS_H_
+#define LIBSPIRV_OPT_FIXPOINT_PASS_H_
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "ir_context.h"
+#include "pass.h"
+
+namespace spvtools {
+namespace opt {
+
+// See optimizer.hpp for documentation.
+class FixpointPass : public Pass {
+ public:
+  using PassCreator = std::function<std::unique_ptr<Pass>()>;
+
+  FixpointPass(std::vector<PassCreator> pass_creators, uint32_t max_iterations)
+      : pass_creators_(std::move(pass_creators)),
+        max_iterations_(max_iterations) {}
+
+  const char* name() const override { return "fixpoint"; }
+  Status Process(ir::IRContext* c) override;
+
+  // The passes in the group record their own changes.
+  bool RecordsFunctionChanges() const override { return true; }
+
+ private:
+  // Creates a new instance of each pass in the group, in order.  A pass
+  // instance can only run once, so each iteration creates new ones.
+  std::vector<PassCreator> pass_creators_;
+
+  // The maximum number of times the group is run.
+  uint32_t max_iterations_;
+};
+
+}  // namespace opt
+}  // namespace spvtools
+
+#endif  // LIBSPIRV_OPT_FIXPOINT_PASS_H_
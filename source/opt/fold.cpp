@@ -248,9 +248,9 @@ uint32_t FoldScalars(SpvOp opcode,
 // folded, the resulting value is returned in |*result|.  Valid result types for
 // the instruction are any integer (signed or unsigned) with 32-bits or less, or
 // a boolean value.
-bool FoldBinaryIntegerOpToConstant(ir::Instruction* inst,
-                                   std::function<uint32_t(uint32_t)> id_map,
-                                   uint32_t* result) {
+bool FoldBinaryIntegerOpToConstant(
+    ir::Instruction* inst, spvutils::FunctionRef<uint32_t(uint32_t)> id_map,
+    uint32_t* result) {
   SpvOp opcode = inst->opcode();
   ir::IRContext* context = inst->context();
   analysis::ConstantManager* const_manger = context->get_constant_mgr();
@@ -435,9 +435,9 @@ bool FoldBinaryIntegerOpToConstant(ir::Instruction* inst,
 // Returns true if |inst| is a binary operation on two boolean values, and folds
 // to a constant boolean value when the ids have been replaced using |id_map|.
 // If |inst| can be folded, the result value is returned in |*result|.
-bool FoldBinaryBooleanOpToConstant(ir::Instruction* inst,
-                                   std::function<uint32_t(uint32_t)> id_map,
-                                   uint32_t* result) {
+bool FoldBinaryBooleanOpToConstant(
+    ir::Instruction* inst, spvutils::FunctionRef<uint32_t(uint32_t)> id_map,
+    uint32_t* result) {
   SpvOp opcode = inst->opcode();
   ir::IRContext* context = inst->context();
   analysis::ConstantManager* const_manger = context->get_constant_mgr();
@@ -489,7 +489,7 @@ bool FoldBinaryBooleanOpToConstant(ir::Instruction* inst,
 // not, |result| is unchanged.  It is assumed that not all operands are
 // constant.  Those cases are handled by |FoldScalar|.
 bool FoldIntegerOpToConstant(ir::Instruction* inst,
-                             std::function<uint32_t(uint32_t)> id_map,
+                             spvutils::FunctionRef<uint32_t(uint32_t)> id_map,
                              uint32_t* result) {
   assert(IsFoldableOpcode(inst->opcode()) &&
          "Unhandled instruction opcode in FoldScalars");
@@ -598,7 +598,7 @@ bool IsFoldableConstant(const analysis::Constant* cst) {
 }
 
 ir::Instruction* FoldInstructionToConstant(
-    ir::Instruction* inst, std::function<uint32_t(uint32_t)> id_map) {
+    ir::Instruction* inst, spvutils::FunctionRef<uint32_t(uint32_t)> id_map) {
   ir::IRContext* context = inst->context();
   analysis::ConstantManager* const_mgr = context->get_constant_mgr();
 
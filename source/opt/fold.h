@@ -21,6 +21,7 @@
 #include "const_folding_rules.h"
 #include "constants.h"
 #include "def_use_manager.h"
+#include "util/function_ref.h"
 
 namespace spvtools {
 namespace opt {
@@ -77,7 +78,7 @@ bool IsFoldableType(ir::Instruction* type_inst);
 // constant, but the instruction itself has not been updated yet.  This can map
 // those ids to the appropriate constants.
 ir::Instruction* FoldInstructionToConstant(
-    ir::Instruction* inst, std::function<uint32_t(uint32_t)> id_map);
+    ir::Instruction* inst, spvutils::FunctionRef<uint32_t(uint32_t)> id_map);
 
 // Returns true if |inst| can be folded into a simpler instruction.
 // If |inst| can be simplified, |inst| is overwritten with the simplified
@@ -14,15 +14,23 @@
 
 #include "function.h"
 
+#include <algorithm>
 #include <ostream>
 #include <sstream>
 
+#include "lazy_function_loader.h"
+
 namespace spvtools {
 namespace ir {
 
 Function* Function::Clone(IRContext* ctx) const {
   Function* clone =
       new Function(std::unique_ptr<Instruction>(DefInst().Clone(ctx)));
+  if (!IsBodyLoaded()) {
+    clone->SetLazyBody(body_loader_, body_begin_, body_end_);
+    return clone;
+  }
+
   clone->params_.reserve(params_.size());
   ForEachParam(
       [clone, ctx](const Instruction* inst) {
@@ -41,16 +49,18 @@ Function* Function::Clone(IRContext* ctx) const {
   return clone;
 }
 
-void Function::ForEachInst(const std::function<void(Instruction*)>& f,
+void Function::ForEachInst(spvutils::FunctionRef<void(Instruction*)> f,
                            bool run_on_debug_line_insts) {
+  LoadBody();
   if (def_inst_) def_inst_->ForEachInst(f, run_on_debug_line_insts);
   for (auto& param : params_) param->ForEachInst(f, run_on_debug_line_insts);
   for (auto& bb : blocks_) bb->ForEachInst(f, run_on_debug_line_insts);
   if (end_inst_) end_inst_->ForEachInst(f, run_on_debug_line_insts);
 }
 
-void Function::ForEachInst(const std::function<void(const Instruction*)>& f,
+void Function::ForEachInst(spvutils::FunctionRef<void(const Instruction*)> f,
                            bool run_on_debug_line_insts) const {
+  LoadBody();
   if (def_inst_)
     static_cast<const Instruction*>(def_inst_.get())
         ->ForEachInst(f, run_on_debug_line_insts);
@@ -68,8 +78,9 @@ void Function::ForEachInst(const std::function<void(const Instruction*)>& f,
         ->ForEachInst(f, run_on_debug_line_insts);
 }
 
-void Function::ForEachParam(const std::function<void(const Instruction*)>& f,
+void Function::ForEachParam(spvutils::FunctionRef<void(const Instruction*)> f,
                             bool run_on_debug_line_insts) const {
+  LoadBody();
   for (const auto& param : params_)
     static_cast<const Instruction*>(param.get())
         ->ForEachInst(f, run_on_debug_line_insts);
@@ -89,6 +100,73 @@ BasicBlock* Function::InsertBasicBlockAfter(
   return nullptr;
 }
 
+void Function::LazyBodyToBinary(std::vector<uint32_t>* binary,
+                                bool skip_nop) const {
+  assert(body_loader_ && "The body is already loaded");
+  const uint32_t* words = body_loader_->words();
+  if (!skip_nop) {
+    binary->insert(binary->end(), words + body_begin_, words + body_end_);
+    return;
+  }
+  for (size_t i = body_begin_; i < body_end_;) {
+    const uint32_t word_count = words[i] >> SpvWordCountShift;
+    if ((words[i] & SpvOpCodeMask) != SpvOpNop)
+      binary->insert(binary->end(), words + i, words + i + word_count);
+    i += word_count;
+  }
+}
+
+size_t Function::BinarySize(bool skip_nop) const {
+  size_t size = 0;
+  auto count_inst = [&size, skip_nop](const Instruction* inst) {
+    if (!(skip_nop && inst->IsNop())) size += 1 + inst->NumOperandWords();
+  };
+  if (IsBodyLoaded()) {
+    ForEachInst(count_inst, true);
+    return size;
+  }
+
+  DefInst().ForEachInst(count_inst, true);
+  const uint32_t* words = body_loader_->words();
+  if (!skip_nop) return size + body_end_ - body_begin_;
+  for (size_t i = body_begin_; i < body_end_;
+       i += words[i] >> SpvWordCountShift) {
+    if ((words[i] & SpvOpCodeMask) != SpvOpNop)
+      size += words[i] >> SpvWordCountShift;
+  }
+  return size;
+}
+
+uint32_t* Function::ToBinary(uint32_t* binary, bool skip_nop) const {
+  auto write_inst = [&binary, skip_nop](const Instruction* inst) {
+    if (!(skip_nop && inst->IsNop()))
+      binary = inst->ToBinaryWithoutAttachedDebugInsts(binary);
+  };
+  if (IsBodyLoaded()) {
+    ForEachInst(write_inst, true);
+    return binary;
+  }
+
+  DefInst().ForEachInst(write_inst, true);
+  const uint32_t* words = body_loader_->words();
+  for (size_t i = body_begin_; i < body_end_;) {
+    const uint32_t word_count = words[i] >> SpvWordCountShift;
+    if (!skip_nop || (words[i] & SpvOpCodeMask) != SpvOpNop)
+      binary = std::copy(words + i, words + i + word_count, binary);
+    i += word_count;
+  }
+  return binary;
+}
+
+void Function::LoadLazyBody() const {
+  // Loading adds to the body through the usual methods, so the loader is
+  // released first.
+  auto* self = const_cast<Function*>(this);
+  std::shared_ptr<LazyFunctionLoader> loader = std::move(self->body_loader_);
+  self->body_loader_ = nullptr;
+  loader->LoadBody(self, body_begin_, body_end_);
+}
+
 std::ostream& operator<<(std::ostream& str, const Function& func) {
   str << func.PrettyPrint();
   return str;
@@ -24,12 +24,14 @@
 #include "basic_block.h"
 #include "instruction.h"
 #include "iterator.h"
+#include "util/function_ref.h"
 
 namespace spvtools {
 namespace ir {
 
 class CFG;
 class IRContext;
+class LazyFunctionLoader;
 class Module;
 
 // A SPIR-V function.
@@ -48,6 +50,9 @@ class Function {
   //
   // The parent module will default to null and needs to be explicitly set by
   // the user.
+  //
+  // If the body of this function is not loaded, it is not loaded by this.  The
+  // clone loads its own copy from the same binary when it is first accessed.
   Function* Clone(IRContext*) const;
   // The OpFunction instruction that begins the definition of this function.
   Instruction& DefInst() { return *def_inst_; }
@@ -57,6 +62,30 @@ class Function {
   void SetParent(Module* module) { module_ = module; }
   // Gets the enclosing module for this function
   Module* GetParent() const { return module_; }
+
+  // Defers loading the parameters, basic blocks and OpFunctionEnd instruction
+  // of this function until one of them is first accessed.  They are the words
+  // [|begin|, |end|) of the binary held by |loader|.
+  inline void SetLazyBody(std::shared_ptr<LazyFunctionLoader> loader,
+                          size_t begin, size_t end);
+  // Returns true if the parameters, basic blocks and OpFunctionEnd instruction
+  // of this function are loaded.
+  bool IsBodyLoaded() const { return body_loader_ == nullptr; }
+  // Appends the binary of the parameters, basic blocks and OpFunctionEnd
+  // instruction of this function to |binary| without loading them.  The body
+  // must not be loaded.  If |skip_nop| is true, OpNop instructions are left
+  // out.
+  void LazyBodyToBinary(std::vector<uint32_t>* binary, bool skip_nop) const;
+
+  // Returns the number of words of the binary of this function, including the
+  // debug line instructions.  If |skip_nop| is true, OpNop instructions are
+  // left out.  A body which is not loaded is not loaded by this.
+  size_t BinarySize(bool skip_nop) const;
+  // Writes the binary of this function to |binary|, which must have room for
+  // BinarySize(|skip_nop|) words, and returns the end of the written words.
+  // A body which is not loaded is not loaded by this.
+  uint32_t* ToBinary(uint32_t* binary, bool skip_nop) const;
+
   // Appends a parameter to this function.
   inline void AddParameter(std::unique_ptr<Instruction> p);
   // Appends a basic block to this function.
@@ -70,8 +99,14 @@ class Function {
   inline void SetFunctionEnd(std::unique_ptr<Instruction> end_inst);
 
   // Returns the given function end instruction.
-  inline Instruction* EndInst() { return end_inst_.get(); }
-  inline const Instruction* EndInst() const { return end_inst_.get(); }
+  inline Instruction* EndInst() {
+    LoadBody();
+    return end_inst_.get();
+  }
+  inline const Instruction* EndInst() const {
+    LoadBody();
+    return end_inst_.get();
+  }
 
   // Returns function's id
   inline uint32_t result_id() const { return def_inst_->result_id(); }
@@ -80,16 +115,27 @@ class Function {
   inline uint32_t type_id() const { return def_inst_->type_id(); }
 
   // Returns the entry basic block for this function.
-  const std::unique_ptr<BasicBlock>& entry() const { return blocks_.front(); }
+  const std::unique_ptr<BasicBlock>& entry() const {
+    LoadBody();
+    return blocks_.front();
+  }
 
-  iterator begin() { return iterator(&blocks_, blocks_.begin()); }
-  iterator end() { return iterator(&blocks_, blocks_.end()); }
+  iterator begin() {
+    LoadBody();
+    return iterator(&blocks_, blocks_.begin());
+  }
+  iterator end() {
+    LoadBody();
+    return iterator(&blocks_, blocks_.end());
+  }
   const_iterator begin() const { return cbegin(); }
   const_iterator end() const { return cend(); }
   const_iterator cbegin() const {
+    LoadBody();
     return const_iterator(&blocks_, blocks_.cbegin());
   }
   const_iterator cend() const {
+    LoadBody();
     return const_iterator(&blocks_, blocks_.cend());
   }
 
@@ -102,14 +148,14 @@ class Function {
 
   // Runs the given function |f| on each instruction in this function, and
   // optionally on debug line instructions that might precede them.
-  void ForEachInst(const std::function<void(Instruction*)>& f,
+  void ForEachInst(spvutils::FunctionRef<void(Instruction*)> f,
                    bool run_on_debug_line_insts = false);
-  void ForEachInst(const std::function<void(const Instruction*)>& f,
+  void ForEachInst(spvutils::FunctionRef<void(const Instruction*)> f,
                    bool run_on_debug_line_insts = false) const;
 
   // Runs the given function |f| on each parameter instruction in this function,
   // and optionally on debug line instructions that might precede them.
-  void ForEachParam(const std::function<void(const Instruction*)>& f,
+  void ForEachParam(spvutils::FunctionRef<void(const Instruction*)> f,
                     bool run_on_debug_line_insts = false) const;
 
   // Returns the context of the current function.
@@ -125,6 +171,13 @@ class Function {
   std::string PrettyPrint(uint32_t options = 0u) const;
 
  private:
+  // Loads the body of this function if it is not loaded yet.
+  void LoadBody() const {
+    if (body_loader_) LoadLazyBody();
+  }
+  // Loads the body of this function from its loader.
+  void LoadLazyBody() const;
+
   // The enclosing module.
   Module* module_;
   // The OpFunction instruction that begins the definition of this function.
@@ -135,15 +188,32 @@ class Function {
   std::vector<std::unique_ptr<BasicBlock>> blocks_;
   // The OpFunctionEnd instruction.
   std::unique_ptr<Instruction> end_inst_;
+  // The loader of the body of this function, if it is not loaded yet, and the
+  // range of words of the body in the binary it holds.
+  std::shared_ptr<LazyFunctionLoader> body_loader_;
+  size_t body_begin_;
+  size_t body_end_;
 };
 
 // Pretty-prints |func| to |str|. Returns |str|.
 std::ostream& operator<<(std::ostream& str, const Function& func);
 
 inline Function::Function(std::unique_ptr<Instruction> def_inst)
-    : module_(nullptr), def_inst_(std::move(def_inst)), end_inst_() {}
+    : module_(nullptr),
+      def_inst_(std::move(def_inst)),
+      end_inst_(),
+      body_begin_(0),
+      body_end_(0) {}
+
+inline void Function::SetLazyBody(std::shared_ptr<LazyFunctionLoader> loader,
+                                  size_t begin, size_t end) {
+  body_loader_ = std::move(loader);
+  body_begin_ = begin;
+  body_end_ = end;
+}
 
 inline void Function::AddParameter(std::unique_ptr<Instruction> p) {
+  LoadBody();
   params_.emplace_back(std::move(p));
 }
 
@@ -158,11 +228,13 @@ inline void Function::AddBasicBlock(std::unique_ptr<BasicBlock> b,
 
 template <typename T>
 inline void Function::AddBasicBlocks(T src_begin, T src_end, iterator ip) {
+  LoadBody();
   blocks_.insert(ip.Get(), std::make_move_iterator(src_begin),
                  std::make_move_iterator(src_end));
 }
 
 inline void Function::SetFunctionEnd(std::unique_ptr<Instruction> end_inst) {
+  LoadBody();
   end_inst_ = std::move(end_inst);
 }
 
@@ -0,0 +1,289 @@
+// Copyright (c) 2018 Google LLC.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "inline_budgeted_pass.h"
+
+#include <algorithm>
+
+#include "log.h"
+
+namespace spvtools {
+namespace opt {
+
+namespace {
+
+const uint32_t kEntryPointFunctionIdInIdx = 1;
+const uint32_t kFunctionCallFunctionIdInIdx = 0;
+
+}  // anonymous namespace
+
+InlineBudgetedPass::InlineBudgetedPass(size_t budget, InlineStats* stats)
+    : remaining_budget_(budget), stats_(stats) {}
+
+void InlineBudgetedPass::AddCalleesFirst(ir::Function* func,
+                                         std::unordered_set<uint32_t>* visited,
+                                         std::vector<ir::Function*>* order) {
+  if (!visited->insert(func->result_id()).second) return;
+  for (auto& blk : *func) {
+    for (auto& inst : blk) {
+      if (inst.opcode() != SpvOpFunctionCall) continue;
+      auto callee = id2function_.find(
+          inst.GetSingleWordInOperand(kFunctionCallFunctionIdInIdx));
+      if (callee != id2function_.end())
+        AddCalleesFirst(callee->second, visited, order);
+    }
+  }
+  order->push_back(func);
+}
+
+bool InlineBudgetedPass::ShouldInline(const ir::Instruction* call_inst) {
+  const uint32_t callee_id =
+      call_inst->GetSingleWordInOperand(kFunctionCallFunctionIdInIdx);
+  const size_t callee_size = GetInlineTemplate(id2function_[callee_id]).size;
+
+  // Opaque arguments and results have to be inlined for the code to be legal
+  // in Vulkan, so they are inlined even past the budget.
+  if (HasOpaqueArgsOrReturn(call_inst)) {
+    remaining_budget_ -= std::min(callee_size, remaining_budget_);
+    return true;
+  }
+
+  if (callee_size > remaining_budget_) return false;
+  remaining_budget_ -= callee_size;
+  return true;
+}
+
+size_t InlineBudgetedPass::RemoveDeadInstructions(ir::Function* func) {
+  // The def-use manager is not kept up to date while inlining, so the uses
+  // are collected here. Removing an instruction may leave its operands
+  // unused, hence the iteration.
+  size_t removed = 0;
+  std::vector<ir::Instruction*> dead;
+  do {
+    dead.clear();
+    std::unordered_set<uint32_t> used_ids;
+    func->ForEachInst([&used_ids](const ir::Instruction* inst) {
+      inst->ForEachInId(
+          [&used_ids](const uint32_t* id) { used_ids.insert(*id); });
+    });
+    for (auto& blk : *func) {
+      for (auto& inst : blk) {
+        if (inst.result_id() == 0 || used_ids.count(inst.result_id())) {
+          continue;
+        }
+        switch (inst.opcode()) {
+          case SpvOpAccessChain:
+          case SpvOpInBoundsAccessChain:
+          case SpvOpCompositeConstruct:
+          case SpvOpCompositeExtract:
+          case SpvOpCompositeInsert:
+          case SpvOpCopyObject:
+          case SpvOpSelect:
+            dead.push_back(&inst);
+            break;
+          default:
+            if (inst.IsOpcodeCodeMotionSafe()) dead.push_back(&inst);
+            break;
+        }
+      }
+    }
+    for (ir::Instruction* inst : dead) context()->KillInst(inst);
+    removed += dead.size();
+  } while (!dead.empty());
+  if (removed != 0) InvalidateInlineTemplate(func->result_id());
+  return removed;
+}
+
+size_t InlineBudgetedPass::RemoveDeadFunctions(
+    const std::vector<ir::Function*>& order) {
+  std::unordered_set<uint32_t> live;
+  std::vector<ir::Function*> live_order;
+  for (uint32_t id : retained_funcs_) {
+    auto fn = id2function_.find(id);
+    if (fn != id2function_.end()) {
+      AddCalleesFirst(fn->second, &live, &live_order);
+    }
+  }
+  // The functions outside of |order| were not processed and are kept, so
+  // their callees must be kept as well.
+  std::unordered_set<uint32_t> processed;
+  for (ir::Function* fn : order) processed.insert(fn->result_id());
+  for (auto& fn : *get_module()) {
+    if (processed.count(fn.result_id()) == 0) {
+      AddCalleesFirst(&fn, &live, &live_order);
+    }
+  }
+
+  std::unordered_set<uint32_t> dead;
+  for (ir::Function* fn : order) {
+    if (live.count(fn->result_id()) == 0) dead.insert(fn->result_id());
+  }
+  if (dead.empty()) return 0;
+
+  for (auto fi = get_module()->begin(); fi != get_module()->end();) {
+    if (dead.count(fi->result_id()) == 0) {
+      ++fi;
+      continue;
+    }
+    id2function_.erase(fi->result_id());
+    fi->ForEachInst(
+        [this](ir::Instruction* inst) { context()->KillInst(inst); }, true);
+    fi = fi.Erase();
+  }
+  return dead.size();
+}
+
+bool InlineBudgetedPass::InlineBudgeted(ir::Function* func) {
+  // Decide up front which calls to inline, while the def-use manager is still
+  // valid.  GenInlineCode moves the other instructions of the calling block
+  // into the new blocks, so the pointers stay valid until the call is inlined.
+  std::unordered_set<const ir::Instruction*> to_inline;
+  for (auto& blk : *func) {
+    for (auto& inst : blk) {
+      if (!IsInlinableFunctionCall(&inst)) continue;
+      if (ShouldInline(&inst)) {
+        to_inline.insert(&inst);
+      } else if (stats_) {
+        ++stats_->kept_calls_;
+      }
+    }
+  }
+  if (to_inline.empty()) return false;
+
+  // Using block iterators here because of block erasures and insertions.
+  for (auto bi = func->begin(); bi != func->end(); ++bi) {
+    for (auto ii = bi->begin(); ii != bi->end();) {
+      if (to_inline.erase(&*ii) != 0) {
+        // Inline call.
+        std::vector<std::unique_ptr<ir::BasicBlock>> newBlocks;
+        std::vector<std::unique_ptr<ir::Instruction>> newVars;
+        GenInlineCode(&newBlocks, &newVars, ii, bi);
+        // If call block is replaced with more than one block, point
+        // succeeding phis at new last block.
+        if (newBlocks.size() > 1) UpdateSucceedingPhis(newBlocks);
+        // The call is deleted with the old calling block. Its name and
+        // decorations go with it.
+        context()->KillNamesAndDecorates(&*ii);
+        // Replace old calling block with new block(s).
+        bi = bi.Erase();
+        for (auto& bb : newBlocks) {
+          bb->SetParent(func);
+        }
+        bi = bi.InsertBefore(&newBlocks);
+        // Insert new function variables.
+        if (newVars.size() > 0)
+          func->begin()->begin().InsertBefore(std::move(newVars));
+        // Restart at beginning of calling block. Calls cloned from the
+        // callee are not in |to_inline| and are skipped.
+        ii = bi->begin();
+        if (stats_) ++stats_->inlined_calls_;
+      } else {
+        ++ii;
+      }
+    }
+  }
+
+  // The body of |func| changed, so any cached clone information is stale.
+  InvalidateInlineTemplate(func->result_id());
+  return true;
+}
+
+size_t InlineBudgetedPass::ModuleSize() const {
+  size_t size = 0;
+  const ir::Module* module = get_module();
+  module->ForEachInst([&size](const ir::Instruction*) { ++size; });
+  return size;
+}
+
+void InlineBudgetedPass::Initialize(ir::IRContext* c) {
+  InitializeInline(c);
+
+  called_funcs_.clear();
+  retained_funcs_.clear();
+
+  for (auto& fn : *get_module()) {
+    for (auto& blk : fn) {
+      for (auto& inst : blk) {
+        if (inst.opcode() == SpvOpFunctionCall) {
+          called_funcs_.insert(
+              inst.GetSingleWordInOperand(kFunctionCallFunctionIdInIdx));
+        }
+      }
+    }
+  }
+
+  for (auto& e : get_module()->entry_points()) {
+    retained_funcs_.insert(
+        e.GetSingleWordInOperand(kEntryPointFunctionIdInIdx));
+  }
+  for (auto& a : get_module()->annotations()) {
+    if (a.opcode() == SpvOpDecorate &&
+        a.GetSingleWordInOperand(1) == SpvDecorationLinkageAttributes) {
+      retained_funcs_.insert(a.GetSingleWordInOperand(0));
+    }
+  }
+}
+
+Pass::Status InlineBudgetedPass::ProcessImpl() {
+  const size_t size_before = ModuleSize();
+
+  // Process the entry point call trees bottom-up. Each callee is then fully
+  // processed once, and the result is what gets cloned into its callers,
+  // instead of re-expanding its calls at every call site.
+  std::unordered_set<uint32_t> visited;
+  std::vector<ir::Function*> order;
+  for (auto& e : get_module()->entry_points()) {
+    auto fn =
+        id2function_.find(e.GetSingleWordInOperand(kEntryPointFunctionIdInIdx));
+    if (fn != id2function_.end()) AddCalleesFirst(fn->second, &visited, &order);
+  }
+
+  // Each callee is cleaned up once it is processed, before it is cloned into
+  // its callers.
+  bool modified = false;
+  size_t removed_instructions = 0;
+  for (ir::Function* fn : order) {
+    modified |= InlineBudgeted(fn);
+    if (called_funcs_.count(fn->result_id())) {
+      removed_instructions += RemoveDeadInstructions(fn);
+    }
+  }
+  modified |= removed_instructions != 0;
+
+  // The callees whose calls were all inlined are removed, so that the size
+  // reported is that of the module the callers will actually get.
+  const size_t removed_functions = modified ? RemoveDeadFunctions(order) : 0;
+
+  const size_t size_after = modified ? ModuleSize() : size_before;
+  if (stats_) {
+    stats_->removed_instructions_ = removed_instructions;
+    stats_->removed_functions_ = removed_functions;
+    stats_->module_size_before_ = size_before;
+    stats_->module_size_after_ = size_after;
+  }
+  Logf(consumer(), SPV_MSG_INFO, name(), {0, 0, 0},
+       "module size changed from %zu to %zu instructions, %zu dead "
+       "instructions and %zu dead functions removed",
+       size_before, size_after, removed_instructions, removed_functions);
+
+  return modified ? Status::SuccessWithChange : Status::SuccessWithoutChange;
+}
+
+Pass::Status InlineBudgetedPass::Process(ir::IRContext* c) {
+  Initialize(c);
+  return ProcessImpl();
+}
+
+}  // namespace opt
+}  // namespace spvtools
@@ -0,0 +1,103 @@
+// Copyright (c) 2018 Google LLC.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef LIBSPIRV_OPT_INLINE_BUDGETED_PASS_H_
+#define LIBSPIRV_OPT_INLINE_BUDGETED_PASS_H_
+
+#include <unordered_set>
+#include <vector>
+
+#include "inline_pass.h"
+#include "module.h"
+
+namespace spvtools {
+namespace opt {
+
+// See optimizer.hpp for documentation.
+class InlineBudgetedPass : public InlinePass {
+ public:
+  // Holds some statistics about the inlining decisions.
+  struct InlineStats {
+    // Number of call sites that were inlined.
+    size_t inlined_calls_ = 0;
+    // Number of inlinable call sites that were kept as calls because they did
+    // not fit in the budget.
+    size_t kept_calls_ = 0;
+    // Number of dead instructions removed from callees before they are cloned.
+    size_t removed_instructions_ = 0;
+    // Number of functions removed because all their calls were inlined.
+    size_t removed_functions_ = 0;
+    // Number of instructions in the module before and after the pass.
+    size_t module_size_before_ = 0;
+    size_t module_size_after_ = 0;
+  };
+
+  // Creates a pass that may grow the module by at most |budget| instructions.
+  // If |stats| is not null, it is filled with statistics about the pass.
+  explicit InlineBudgetedPass(size_t budget, InlineStats* stats = nullptr);
+
+  Status Process(ir::IRContext* c) override;
+
+  const char* name() const override { return "inline-entry-points-budgeted"; }
+
+ private:
+  // Appends |func| and all the functions it calls to |order|, callees first.
+  // Functions already in |visited| are skipped.
+  void AddCalleesFirst(ir::Function* func,
+                       std::unordered_set<uint32_t>* visited,
+                       std::vector<ir::Function*>* order);
+
+  // Returns true if the call |call_inst| should be inlined. Charges the code
+  // growth of the call against the remaining budget when it returns true.
+  bool ShouldInline(const ir::Instruction* call_inst);
+
+  // Removes the instructions of |func| whose result is unused and which have
+  // no side effect, so that they are not cloned at each call site. Returns the
+  // number of instructions removed.
+  size_t RemoveDeadInstructions(ir::Function* func);
+
+  // Removes the functions of |order| that can no longer be reached from an
+  // entry point, an exported function or a function outside of |order|.
+  // Returns the number of functions removed.
+  size_t RemoveDeadFunctions(const std::vector<ir::Function*>& order);
+
+  // Inlines the calls in |func| selected by ShouldInline. Calls that are
+  // cloned into |func| from a callee body are not considered again: they were
+  // already decided when the callee was processed. Return true if |func| is
+  // modified.
+  bool InlineBudgeted(ir::Function* func);
+
+  // Returns the number of instructions in the module.
+  size_t ModuleSize() const;
+
+  void Initialize(ir::IRContext* c);
+  Pass::Status ProcessImpl();
+
+  // The number of instructions that inlining may still add to the module.
+  size_t remaining_budget_;
+
+  // Ids of the functions that are called.
+  std::unordered_set<uint32_t> called_funcs_;
+
+  // Ids of the functions that stay in the module whatever their callers do:
+  // entry points and exported functions.
+  std::unordered_set<uint32_t> retained_funcs_;
+
+  InlineStats* stats_;
+};
+
+}  // namespace opt
+}  // namespace spvtools
+
+#endif  // LIBSPIRV_OPT_INLINE_BUDGETED_PASS_H_
@@ -56,6 +56,8 @@ bool InlineExhaustivePass::InlineExhaustive(ir::Function* func) {
       }
     }
   }
+  // The body of |func| changed, so any cached clone information is stale.
+  if (modified) InvalidateInlineTemplate(func->result_id());
   return modified;
 }
 
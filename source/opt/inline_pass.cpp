@@ -25,6 +25,7 @@ static const int kSpvFunctionCallArgumentId = 3;
 static const int kSpvReturnValueId = 0;
 static const int kSpvLoopMergeMergeBlockId = 0;
 static const int kSpvLoopMergeContinueTargetIdInIdx = 1;
+static const int kSpvTypePointerTypeIdInIdx = 1;
 
 namespace spvtools {
 namespace opt {
@@ -238,12 +239,9 @@ void InlinePass::GenInlineCode(
   // Create return var if needed.
   uint32_t returnVarId = CreateReturnVar(calleeFn, new_vars);
 
-  // Create set of callee result ids. Used to detect forward references
-  std::unordered_set<uint32_t> callee_result_ids;
-  calleeFn->ForEachInst([&callee_result_ids](const ir::Instruction* cpi) {
-    const uint32_t rid = cpi->result_id();
-    if (rid != 0) callee_result_ids.insert(rid);
-  });
+  // Set of callee result ids. Used to detect forward references
+  const std::unordered_set<uint32_t>& callee_result_ids =
+      GetInlineTemplate(calleeFn).result_ids;
 
   // If the caller is in a single-block loop, and the callee has multiple
   // blocks, then the normal inlining logic will place the OpLoopMerge in
@@ -514,6 +512,66 @@ void InlinePass::GenInlineCode(
   }
 }
 
+bool InlinePass::IsOpaqueType(uint32_t typeId) {
+  const ir::Instruction* typeInst = get_def_use_mgr()->GetDef(typeId);
+  switch (typeInst->opcode()) {
+    case SpvOpTypeSampler:
+    case SpvOpTypeImage:
+    case SpvOpTypeSampledImage:
+      return true;
+    case SpvOpTypePointer:
+      return IsOpaqueType(
+          typeInst->GetSingleWordInOperand(kSpvTypePointerTypeIdInIdx));
+    default:
+      break;
+  }
+  // TODO(greg-lunarg): Handle arrays containing opaque type
+  if (typeInst->opcode() != SpvOpTypeStruct) return false;
+  // Return true if any member is opaque
+  return !typeInst->WhileEachInId([this](const uint32_t* tid) {
+    if (IsOpaqueType(*tid)) return false;
+    return true;
+  });
+}
+
+bool InlinePass::HasOpaqueArgsOrReturn(const ir::Instruction* callInst) {
+  // Check return type
+  if (IsOpaqueType(callInst->type_id())) return true;
+  // Check args
+  int icnt = 0;
+  return !callInst->WhileEachInId([&icnt, this](const uint32_t* iid) {
+    if (icnt > 0) {
+      const ir::Instruction* argInst = get_def_use_mgr()->GetDef(*iid);
+      if (IsOpaqueType(argInst->type_id())) return false;
+    }
+    ++icnt;
+    return true;
+  });
+}
+
+const InlinePass::InlineTemplate& InlinePass::GetInlineTemplate(
+    ir::Function* func) {
+  auto it = inline_templates_.find(func->result_id());
+  if (it != inline_templates_.end()) return it->second;
+
+  InlineTemplate& tmpl = inline_templates_[func->result_id()];
+  tmpl.size = 0;
+  func->ForEachInst([&tmpl](const ir::Instruction* cpi) {
+    const uint32_t rid = cpi->result_id();
+    if (rid != 0) tmpl.result_ids.insert(rid);
+    switch (cpi->opcode()) {
+      case SpvOpFunction:
+      case SpvOpFunctionParameter:
+      case SpvOpFunctionEnd:
+        break;
+      default:
+        ++tmpl.size;
+        break;
+    }
+  });
+  return tmpl;
+}
+
 bool InlinePass::IsInlinableFunctionCall(const ir::Instruction* inst) {
   if (inst->opcode() != SpvOp::SpvOpFunctionCall) return false;
   const uint32_t calleeFnId =
@@ -656,6 +714,7 @@ void InlinePass::InitializeInline(ir::IRContext* c) {
   id2block_.clear();
   block2structured_succs_.clear();
   inlinable_.clear();
+  inline_templates_.clear();
   no_return_in_loop_.clear();
   multi_return_funcs_.clear();
 
@@ -21,6 +21,7 @@
 #include <list>
 #include <memory>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include "decoration_manager.h"
@@ -155,6 +156,33 @@ class InlinePass : public Pass {
   void UpdateSucceedingPhis(
       std::vector<std::unique_ptr<ir::BasicBlock>>& new_blocks);
 
+  // Return true if |typeId| is or contains opaque type
+  bool IsOpaqueType(uint32_t typeId);
+
+  // Return true if function call |callInst| has opaque argument or return type
+  bool HasOpaqueArgsOrReturn(const ir::Instruction* callInst);
+
+  // Information about a callee that does not depend on the call site. It is
+  // computed the first time the callee is inlined and reused for every later
+  // call site until the callee itself is modified.
+  struct InlineTemplate {
+    // Result ids defined in the callee. Used to detect forward references
+    // while cloning.
+    std::unordered_set<uint32_t> result_ids;
+    // Number of instructions, excluding the OpFunction, OpFunctionParameter
+    // and OpFunctionEnd, that are cloned into the caller at each call site.
+    size_t size;
+  };
+
+  // Return the inline template of |func|, computing it if needed.
+  const InlineTemplate& GetInlineTemplate(ir::Function* func);
+
+  // Forget the cached inline template of function |func_id|. Must be called
+  // whenever the body of that function is modified.
+  void InvalidateInlineTemplate(uint32_t func_id) {
+    inline_templates_.erase(func_id);
+  }
+
   // Initialize state for optimization of |module|
   void InitializeInline(ir::IRContext* c);
 
@@ -183,6 +211,9 @@ class InlinePass : public Pass {
   // different way in the inliner. Can these be consolidated?
   std::unordered_map<const ir::BasicBlock*, std::vector<ir::BasicBlock*>>
       block2structured_succs_;
+
+  // Map from function's result id to its cached inline template.
+  std::unordered_map<uint32_t, InlineTemplate> inline_templates_;
 };
 
 }  // namespace opt
@@ -203,9 +203,9 @@ void InsertExtractElimPass::Initialize(ir::IRContext* c) {
 
 Pass::Status InsertExtractElimPass::ProcessImpl() {
   // Process all entry point functions.
-  ProcessFunction pfn = [this](ir::Function* fp) {
+  ProcessFunction pfn = SkipSettledFunctions([this](ir::Function* fp) {
     return EliminateInsertExtract(fp);
-  };
+  });
   bool modified = ProcessEntryPointCallTree(pfn, get_module());
   return modified ? Status::SuccessWithChange : Status::SuccessWithoutChange;
 }
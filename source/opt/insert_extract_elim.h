@@ -38,6 +38,7 @@ class InsertExtractElimPass : public MemPass {
   InsertExtractElimPass();
   const char* name() const override { return "eliminate-insert-extract"; }
   Status Process(ir::IRContext*) override;
+  bool RecordsFunctionChanges() const override { return true; }
 
  private:
   // Return id of component of |cinst| specified by |extIndices| starting with
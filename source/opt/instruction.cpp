@@ -14,6 +14,7 @@
 
 #include "instruction.h"
 
+#include <algorithm>
 #include <initializer_list>
 
 #include "disassemble.h"
@@ -50,11 +51,16 @@ Instruction::Instruction(IRContext* c, SpvOp op)
 
 Instruction::Instruction(IRContext* c, const spv_parsed_instruction_t& inst,
                          std::vector<Instruction>&& dbg_line)
+    : Instruction(c, inst, c->TakeNextUniqueId(), std::move(dbg_line)) {}
+
+Instruction::Instruction(IRContext* c, const spv_parsed_instruction_t& inst,
+                         uint32_t unique_id,
+                         std::vector<Instruction>&& dbg_line)
     : context_(c),
       opcode_(static_cast<SpvOp>(inst.opcode)),
       type_id_(inst.type_id),
       result_id_(inst.result_id),
-      unique_id_(c->TakeNextUniqueId()),
+      unique_id_(unique_id),
       dbg_line_insts_(std::move(dbg_line)) {
   assert((!IsDebugLineInst(opcode_) || dbg_line.empty()) &&
          "Op(No)Line attaching to Op(No)Line found");
@@ -139,6 +145,15 @@ void Instruction::ToBinaryWithoutAttachedDebugInsts(
     binary->insert(binary->end(), operand.words.begin(), operand.words.end());
 }
 
+uint32_t* Instruction::ToBinaryWithoutAttachedDebugInsts(
+    uint32_t* binary) const {
+  const uint32_t num_words = 1 + NumOperandWords();
+  *binary++ = (num_words << 16) | static_cast<uint16_t>(opcode_);
+  for (const auto& operand : operands_)
+    binary = std::copy(operand.words.begin(), operand.words.end(), binary);
+  return binary;
+}
+
 void Instruction::ReplaceOperands(const std::vector<Operand>& new_operands) {
   operands_.clear();
   operands_.insert(operands_.begin(), new_operands.begin(), new_operands.end());
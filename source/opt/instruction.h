@@ -22,6 +22,7 @@
 
 #include "opcode.h"
 #include "operand.h"
+#include "util/function_ref.h"
 #include "util/ilist_node.h"
 
 #include "latest_version_spirv_header.h"
@@ -119,6 +120,11 @@ class Instruction : public utils::IntrusiveNodeBase<Instruction> {
   // instruction, if any.
   Instruction(IRContext* c, const spv_parsed_instruction_t& inst,
               std::vector<Instruction>&& dbg_line = {});
+  // Like the previous constructor, but gives the instruction the unique id
+  // |unique_id|, which the caller has taken from the context |c|.  This one
+  // does not modify |c|, so that instructions can be created concurrently.
+  Instruction(IRContext* c, const spv_parsed_instruction_t& inst,
+              uint32_t unique_id, std::vector<Instruction>&& dbg_line = {});
 
   // Creates an instruction with the given opcode |op|, type id: |ty_id|,
   // result id: |res_id| and input operands: |in_operands|.
@@ -241,52 +247,56 @@ class Instruction : public utils::IntrusiveNodeBase<Instruction> {
   // Runs the given function |f| on this instruction and optionally on the
   // preceding debug line instructions.  The function will always be run
   // if this is itself a debug line instruction.
-  inline void ForEachInst(const std::function<void(Instruction*)>& f,
+  inline void ForEachInst(spvutils::FunctionRef<void(Instruction*)> f,
                           bool run_on_debug_line_insts = false);
-  inline void ForEachInst(const std::function<void(const Instruction*)>& f,
+  inline void ForEachInst(spvutils::FunctionRef<void(const Instruction*)> f,
                           bool run_on_debug_line_insts = false) const;
 
   // Runs the given function |f| on this instruction and optionally on the
   // preceding debug line instructions.  The function will always be run
   // if this is itself a debug line instruction. If |f| returns false,
   // iteration is terminated and this function returns false.
-  inline bool WhileEachInst(const std::function<bool(Instruction*)>& f,
+  inline bool WhileEachInst(spvutils::FunctionRef<bool(Instruction*)> f,
                             bool run_on_debug_line_insts = false);
-  inline bool WhileEachInst(const std::function<bool(const Instruction*)>& f,
+  inline bool WhileEachInst(spvutils::FunctionRef<bool(const Instruction*)> f,
                             bool run_on_debug_line_insts = false) const;
 
   // Runs the given function |f| on all operand ids.
   //
   // |f| should not transform an ID into 0, as 0 is an invalid ID.
-  inline void ForEachId(const std::function<void(uint32_t*)>& f);
-  inline void ForEachId(const std::function<void(const uint32_t*)>& f) const;
+  inline void ForEachId(spvutils::FunctionRef<void(uint32_t*)> f);
+  inline void ForEachId(spvutils::FunctionRef<void(const uint32_t*)> f) const;
 
   // Runs the given function |f| on all "in" operand ids.
-  inline void ForEachInId(const std::function<void(uint32_t*)>& f);
-  inline void ForEachInId(const std::function<void(const uint32_t*)>& f) const;
+  inline void ForEachInId(spvutils::FunctionRef<void(uint32_t*)> f);
+  inline void ForEachInId(spvutils::FunctionRef<void(const uint32_t*)> f) const;
 
   // Runs the given function |f| on all "in" operand ids. If |f| returns false,
   // iteration is terminated and this function returns false.
-  inline bool WhileEachInId(const std::function<bool(uint32_t*)>& f);
+  inline bool WhileEachInId(spvutils::FunctionRef<bool(uint32_t*)> f);
   inline bool WhileEachInId(
-      const std::function<bool(const uint32_t*)>& f) const;
+      spvutils::FunctionRef<bool(const uint32_t*)> f) const;
 
   // Runs the given function |f| on all "in" operands.
-  inline void ForEachInOperand(const std::function<void(uint32_t*)>& f);
+  inline void ForEachInOperand(spvutils::FunctionRef<void(uint32_t*)> f);
   inline void ForEachInOperand(
-      const std::function<void(const uint32_t*)>& f) const;
+      spvutils::FunctionRef<void(const uint32_t*)> f) const;
 
   // Runs the given function |f| on all "in" operands. If |f| returns false,
   // iteration is terminated and this function return false.
-  inline bool WhileEachInOperand(const std::function<bool(uint32_t*)>& f);
+  inline bool WhileEachInOperand(spvutils::FunctionRef<bool(uint32_t*)> f);
   inline bool WhileEachInOperand(
-      const std::function<bool(const uint32_t*)>& f) const;
+      spvutils::FunctionRef<bool(const uint32_t*)> f) const;
 
   // Returns true if any operands can be labels
   inline bool HasLabels() const;
 
   // Pushes the binary segments for this instruction into the back of *|binary|.
   void ToBinaryWithoutAttachedDebugInsts(std::vector<uint32_t>* binary) const;
+  // Writes the binary segments for this instruction to |binary|, which must
+  // have room for 1 + NumOperandWords() words, and returns the end of the
+  // written words.
+  uint32_t* ToBinaryWithoutAttachedDebugInsts(uint32_t* binary) const;
 
   // Replaces the operands to the instruction with |new_operands|. The caller
   // is responsible for building a complete and valid list of operands for
@@ -522,7 +532,7 @@ inline void Instruction::ToNop() {
 }
 
 inline bool Instruction::WhileEachInst(
-    const std::function<bool(Instruction*)>& f, bool run_on_debug_line_insts) {
+    spvutils::FunctionRef<bool(Instruction*)> f, bool run_on_debug_line_insts) {
   if (run_on_debug_line_insts) {
     for (auto& dbg_line : dbg_line_insts_) {
       if (!f(&dbg_line)) return false;
@@ -532,7 +542,7 @@ inline bool Instruction::WhileEachInst(
 }
 
 inline bool Instruction::WhileEachInst(
-    const std::function<bool(const Instruction*)>& f,
+    spvutils::FunctionRef<bool(const Instruction*)> f,
     bool run_on_debug_line_insts) const {
   if (run_on_debug_line_insts) {
     for (auto& dbg_line : dbg_line_insts_) {
@@ -542,8 +552,8 @@ inline bool Instruction::WhileEachInst(
   return f(this);
 }
 
-inline void Instruction::ForEachInst(const std::function<void(Instruction*)>& f,
-                                     bool run_on_debug_line_insts) {
+inline void Instruction::ForEachInst(
+    spvutils::FunctionRef<void(Instruction*)> f, bool run_on_debug_line_insts) {
   WhileEachInst(
       [&f](Instruction* inst) {
         f(inst);
@@ -553,7 +563,7 @@ inline void Instruction::ForEachInst(const std::function<void(Instruction*)>& f,
 }
 
 inline void Instruction::ForEachInst(
-    const std::function<void(const Instruction*)>& f,
+    spvutils::FunctionRef<void(const Instruction*)> f,
     bool run_on_debug_line_insts) const {
   WhileEachInst(
       [&f](const Instruction* inst) {
@@ -563,7 +573,7 @@ inline void Instruction::ForEachInst(
       run_on_debug_line_insts);
 }
 
-inline void Instruction::ForEachId(const std::function<void(uint32_t*)>& f) {
+inline void Instruction::ForEachId(spvutils::FunctionRef<void(uint32_t*)> f) {
   for (auto& opnd : operands_)
     if (spvIsIdType(opnd.type)) f(&opnd.words[0]);
   if (type_id_ != 0u) type_id_ = GetSingleWordOperand(0u);
@@ -572,13 +582,13 @@ inline void Instruction::ForEachId(const std::function<void(uint32_t*)>& f) {
 }
 
 inline void Instruction::ForEachId(
-    const std::function<void(const uint32_t*)>& f) const {
+    spvutils::FunctionRef<void(const uint32_t*)> f) const {
   for (const auto& opnd : operands_)
     if (spvIsIdType(opnd.type)) f(&opnd.words[0]);
 }
 
 inline bool Instruction::WhileEachInId(
-    const std::function<bool(uint32_t*)>& f) {
+    spvutils::FunctionRef<bool(uint32_t*)> f) {
   for (auto& opnd : operands_) {
     switch (opnd.type) {
       case SPV_OPERAND_TYPE_RESULT_ID:
@@ -595,7 +605,7 @@ inline bool Instruction::WhileEachInId(
 }
 
 inline bool Instruction::WhileEachInId(
-    const std::function<bool(const uint32_t*)>& f) const {
+    spvutils::FunctionRef<bool(const uint32_t*)> f) const {
   for (const auto& opnd : operands_) {
     switch (opnd.type) {
       case SPV_OPERAND_TYPE_RESULT_ID:
@@ -611,7 +621,7 @@ inline bool Instruction::WhileEachInId(
   return true;
 }
 
-inline void Instruction::ForEachInId(const std::function<void(uint32_t*)>& f) {
+inline void Instruction::ForEachInId(spvutils::FunctionRef<void(uint32_t*)> f) {
   WhileEachInId([&f](uint32_t* id) {
     f(id);
     return true;
@@ -619,7 +629,7 @@ inline void Instruction::ForEachInId(const std::function<void(uint32_t*)>& f) {
 }
 
 inline void Instruction::ForEachInId(
-    const std::function<void(const uint32_t*)>& f) const {
+    spvutils::FunctionRef<void(const uint32_t*)> f) const {
   WhileEachInId([&f](const uint32_t* id) {
     f(id);
     return true;
@@ -627,7 +637,7 @@ inline void Instruction::ForEachInId(
 }
 
 inline bool Instruction::WhileEachInOperand(
-    const std::function<bool(uint32_t*)>& f) {
+    spvutils::FunctionRef<bool(uint32_t*)> f) {
   for (auto& opnd : operands_) {
     switch (opnd.type) {
       case SPV_OPERAND_TYPE_RESULT_ID:
@@ -642,7 +652,7 @@ inline bool Instruction::WhileEachInOperand(
 }
 
 inline bool Instruction::WhileEachInOperand(
-    const std::function<bool(const uint32_t*)>& f) const {
+    spvutils::FunctionRef<bool(const uint32_t*)> f) const {
   for (const auto& opnd : operands_) {
     switch (opnd.type) {
       case SPV_OPERAND_TYPE_RESULT_ID:
@@ -657,7 +667,7 @@ inline bool Instruction::WhileEachInOperand(
 }
 
 inline void Instruction::ForEachInOperand(
-    const std::function<void(uint32_t*)>& f) {
+    spvutils::FunctionRef<void(uint32_t*)> f) {
   WhileEachInOperand([&f](uint32_t* op) {
     f(op);
     return true;
@@ -665,7 +675,7 @@ inline void Instruction::ForEachInOperand(
 }
 
 inline void Instruction::ForEachInOperand(
-    const std::function<void(const uint32_t*)>& f) const {
+    spvutils::FunctionRef<void(const uint32_t*)> f) const {
   WhileEachInOperand([&f](const uint32_t* op) {
     f(op);
     return true;
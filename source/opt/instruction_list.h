@@ -23,6 +23,7 @@
 
 #include "instruction.h"
 #include "operand.h"
+#include "util/function_ref.h"
 #include "util/ilist.h"
 
 #include "latest_version_spirv_header.h"
@@ -104,7 +105,7 @@ class InstructionList : public utils::IntrusiveList<Instruction> {
 
   // Runs the given function |f| on the instructions in the list and optionally
   // on the preceding debug line instructions.
-  inline void ForEachInst(const std::function<void(Instruction*)>& f,
+  inline void ForEachInst(spvutils::FunctionRef<void(Instruction*)> f,
                           bool run_on_debug_line_insts) {
     auto next = begin();
     for (auto i = next; i != end(); i = next) {
@@ -51,6 +51,9 @@ void IRContext::BuildInvalidAnalyses(IRContext::Analysis set) {
   if (set & kAnalysisRegisterPressure) {
     BuildRegPressureAnalysis();
   }
+  if (set & kAnalysisMemorySSA) {
+    BuildMemorySSAAnalysis();
+  }
 }
 
 void IRContext::InvalidateAnalysesExceptFor(
@@ -82,6 +85,9 @@ void IRContext::InvalidateAnalyses(IRContext::Analysis analyses_to_invalidate) {
   if (analyses_to_invalidate & kAnalysisNameMap) {
     id_to_name_.reset(nullptr);
   }
+  if (analyses_to_invalidate & kAnalysisMemorySSA) {
+    memory_ssa_.reset(nullptr);
+  }
 
   valid_analyses_ = Analysis(valid_analyses_ & ~analyses_to_invalidate);
 }
@@ -91,6 +97,7 @@ Instruction* IRContext::KillInst(ir::Instruction* inst) {
     return nullptr;
   }
 
+  ++modification_epoch_;
   KillNamesAndDecorates(inst);
 
   if (AreAnalysesValid(kAnalysisDefUse)) {
@@ -116,6 +123,10 @@ Instruction* IRContext::KillInst(ir::Instruction* inst) {
     constant_mgr_->RemoveId(inst->result_id());
   }
 
+  if (AreAnalysesValid(kAnalysisMemorySSA)) {
+    InvalidateAnalyses(kAnalysisMemorySSA);
+  }
+
   RemoveFromIdToName(inst);
 
   Instruction* next_instruction = nullptr;
@@ -236,6 +247,7 @@ void spvtools::ir::IRContext::ForgetUses(Instruction* inst) {
 }
 
 void IRContext::AnalyzeUses(Instruction* inst) {
+  ++modification_epoch_;
   if (AreAnalysesValid(kAnalysisDefUse)) {
     get_def_use_mgr()->AnalyzeInstUse(inst);
   }
@@ -641,5 +653,36 @@ bool ir::IRContext::CheckCFG() {
 
   return true;
 }
+
+std::unique_ptr<IRContext> IRContext::Fork() const {
+  std::unique_ptr<IRContext> fork(
+      new IRContext(syntax_context_->target_env, consumer_));
+  IRContext* c = fork.get();
+  auto clone = [c](const Instruction& inst) {
+    return std::unique_ptr<Instruction>(inst.Clone(c));
+  };
+
+  const Module& from = *module_;
+  Module* to = fork->module();
+  to->SetHeader(from.header());
+  for (auto& inst : from.capabilities()) to->AddCapability(clone(inst));
+  for (auto& inst : from.extensions()) to->AddExtension(clone(inst));
+  for (auto& inst : from.ext_inst_imports()) to->AddExtInstImport(clone(inst));
+  if (from.GetMemoryModel()) to->SetMemoryModel(clone(*from.GetMemoryModel()));
+  for (auto& inst : from.entry_points()) to->AddEntryPoint(clone(inst));
+  for (auto& inst : from.execution_modes()) to->AddExecutionMode(clone(inst));
+  for (auto& inst : from.debugs1()) to->AddDebug1Inst(clone(inst));
+  for (auto& inst : from.debugs2()) to->AddDebug2Inst(clone(inst));
+  for (auto& inst : from.debugs3()) to->AddDebug3Inst(clone(inst));
+  for (auto& inst : from.annotations()) to->AddAnnotationInst(clone(inst));
+  for (auto& inst : from.types_values()) to->AddType(clone(inst));
+  for (auto& func : from) {
+    std::unique_ptr<Function> func_clone(func.Clone(c));
+    func_clone->SetParent(to);
+    to->AddFunction(std::move(func_clone));
+  }
+  return fork;
+}
+
 }  // namespace ir
 }  // namespace spvtools
@@ -17,12 +17,14 @@
 
 #include "assembly_grammar.h"
 #include "cfg.h"
+#include "change_tracker.h"
 #include "constants.h"
 #include "decoration_manager.h"
 #include "def_use_manager.h"
 #include "dominator_analysis.h"
 #include "feature_manager.h"
 #include "loop_descriptor.h"
+#include "memory_ssa.h"
 #include "module.h"
 #include "register_pressure.h"
 #include "scalar_analysis.h"
@@ -62,7 +64,8 @@ class IRContext {
     kAnalysisNameMap = 1 << 7,
     kAnalysisScalarEvolution = 1 << 8,
     kAnalysisRegisterPressure = 1 << 9,
-    kAnalysisEnd = 1 << 10
+    kAnalysisMemorySSA = 1 << 10,
+    kAnalysisEnd = 1 << 11
   };
 
   friend inline Analysis operator|(Analysis lhs, Analysis rhs);
@@ -104,6 +107,13 @@ class IRContext {
 
   ~IRContext() { spvContextDestroy(syntax_context_); }
 
+  // Returns a new context holding a copy of the module, with the same ids.
+  // The bodies of the functions which are not loaded are shared until each
+  // context loads its own copy, which makes forking a module built with lazy
+  // function bodies cheap.  Analyses are not copied; they are rebuilt on
+  // demand in the new context.
+  std::unique_ptr<IRContext> Fork() const;
+
   Module* module() const { return module_.get(); }
 
   // Returns a vector of pointers to constant-creation instructions in this
@@ -217,6 +227,16 @@ class IRContext {
     return reg_pressure_.get();
   }
 
+  // Returns a pointer to the memory SSA analysis.  If it is invalid, it is
+  // rebuilt first.  The memory SSA forms are not updated when instructions
+  // change; killing an instruction invalidates them.
+  opt::MemorySSAAnalysis* GetMemorySSAAnalysis() {
+    if (!AreAnalysesValid(kAnalysisMemorySSA)) {
+      BuildMemorySSAAnalysis();
+    }
+    return memory_ssa_.get();
+  }
+
   // Returns the basic block for instruction |instr|. Re-builds the instruction
   // block map, if needed.
   ir::BasicBlock* get_instr_block(ir::Instruction* instr) {
@@ -271,6 +291,12 @@ class IRContext {
     return type_mgr_.get();
   }
 
+  // Returns a number which changes whenever an instruction is killed or its
+  // uses are analyzed again, which is how the passes report the instructions
+  // they modify.  Analyses memoizing results per instruction compare it to
+  // tell whether their results may be stale.
+  uint32_t modification_epoch() const { return modification_epoch_; }
+
   // Returns a pointer to the scalar evolution analysis. If it is invalid it
   // will be rebuilt first.
   opt::ScalarEvolutionAnalysis* GetScalarEvolutionAnalysis() {
@@ -298,6 +324,15 @@ class IRContext {
   // Returns the reference to the message consumer for this pass.
   const spvtools::MessageConsumer& consumer() const { return consumer_; }
 
+  // Starts recording which functions the passes change.  See
+  // opt::ChangeTracker.
+  void EnableChangeTracking() {
+    if (!change_tracker_) change_tracker_.reset(new opt::ChangeTracker());
+  }
+
+  // Returns the change tracker, or nullptr if change tracking is not enabled.
+  opt::ChangeTracker* change_tracker() const { return change_tracker_.get(); }
+
   // Rebuilds the analyses in |set| that are invalid.
   void BuildInvalidAnalyses(Analysis set);
 
@@ -372,6 +407,15 @@ class IRContext {
     return ++unique_id_;
   }
 
+  // Takes |count| consecutive unique ids for use by instructions, and returns
+  // the first one.
+  inline uint32_t TakeUniqueIds(uint32_t count) {
+    assert(count <= std::numeric_limits<uint32_t>::max() - unique_id_);
+    const uint32_t first = unique_id_ + 1;
+    unique_id_ += count;
+    return first;
+  }
+
   // Returns true if |inst| is a combinator in the current context.
   // |combinator_ops_| is built if it has not been already.
   inline bool IsCombinatorInstruction(ir::Instruction* inst) {
@@ -475,6 +519,12 @@ class IRContext {
     valid_analyses_ = valid_analyses_ | kAnalysisRegisterPressure;
   }
 
+  // Builds the memory SSA analysis from scratch, even if it was already valid.
+  void BuildMemorySSAAnalysis() {
+    memory_ssa_.reset(new opt::MemorySSAAnalysis(this));
+    valid_analyses_ = valid_analyses_ | kAnalysisMemorySSA;
+  }
+
   // Removes all computed dominator and post-dominator trees. This will force
   // the context to rebuild the trees on demand.
   void ResetDominatorAnalysis() {
@@ -581,6 +631,15 @@ class IRContext {
 
   // The liveness analysis |module_|.
   std::unique_ptr<opt::LivenessAnalysis> reg_pressure_;
+
+  // The memory SSA forms of the functions of |module_|.
+  std::unique_ptr<opt::MemorySSAAnalysis> memory_ssa_;
+
+  // Records the functions changed by passes, if change tracking is enabled.
+  std::unique_ptr<opt::ChangeTracker> change_tracker_;
+
+  // See modification_epoch().
+  uint32_t modification_epoch_ = 0;
 };
 
 inline ir::IRContext::Analysis operator|(ir::IRContext::Analysis lhs,
@@ -14,6 +14,7 @@
 
 #include "ir_loader.h"
 
+#include "ir_context.h"
 #include "log.h"
 #include "reflect.h"
 
@@ -24,63 +25,38 @@ IrLoader::IrLoader(const MessageConsumer& consumer, Module* m)
     : consumer_(consumer),
       module_(m),
       source_("<instruction>"),
-      inst_index_(0) {}
+      inst_index_(0),
+      function_(nullptr),
+      lazy_block_open_(false),
+      next_unique_id_(0) {}
 
 bool IrLoader::AddInstruction(const spv_parsed_instruction_t* inst) {
   ++inst_index_;
   const auto opcode = static_cast<SpvOp>(inst->opcode);
   if (IsDebugLineInst(opcode)) {
-    dbg_line_info_.push_back(Instruction(module()->context(), *inst));
+    dbg_line_info_.push_back(
+        Instruction(module()->context(), *inst, TakeUniqueId()));
     return true;
   }
+  if (!CheckPosition(opcode, function_ != nullptr, block_ != nullptr))
+    return false;
 
-  std::unique_ptr<Instruction> spv_inst(
-      new Instruction(module()->context(), *inst, std::move(dbg_line_info_)));
+  std::unique_ptr<Instruction> spv_inst(new Instruction(
+      module()->context(), *inst, TakeUniqueId(), std::move(dbg_line_info_)));
   dbg_line_info_.clear();
 
-  const char* src = source_.c_str();
-  spv_position_t loc = {inst_index_, 0, 0};
-
   // Handle function and basic block boundaries first, then normal
   // instructions.
   if (opcode == SpvOpFunction) {
-    if (function_ != nullptr) {
-      Error(consumer_, src, loc, "function inside function");
-      return false;
-    }
-    function_.reset(new Function(std::move(spv_inst)));
+    std::unique_ptr<Function> function(new Function(std::move(spv_inst)));
+    function_ = function.get();
+    module_->AddFunction(std::move(function));
   } else if (opcode == SpvOpFunctionEnd) {
-    if (function_ == nullptr) {
-      Error(consumer_, src, loc,
-            "OpFunctionEnd without corresponding OpFunction");
-      return false;
-    }
-    if (block_ != nullptr) {
-      Error(consumer_, src, loc, "OpFunctionEnd inside basic block");
-      return false;
-    }
     function_->SetFunctionEnd(std::move(spv_inst));
-    module_->AddFunction(std::move(function_));
     function_ = nullptr;
   } else if (opcode == SpvOpLabel) {
-    if (function_ == nullptr) {
-      Error(consumer_, src, loc, "OpLabel outside function");
-      return false;
-    }
-    if (block_ != nullptr) {
-      Error(consumer_, src, loc, "OpLabel inside basic block");
-      return false;
-    }
     block_.reset(new BasicBlock(std::move(spv_inst)));
   } else if (IsTerminatorInst(opcode)) {
-    if (function_ == nullptr) {
-      Error(consumer_, src, loc, "terminator instruction outside function");
-      return false;
-    }
-    if (block_ == nullptr) {
-      Error(consumer_, src, loc, "terminator instruction outside basic block");
-      return false;
-    }
     block_->AddInstruction(std::move(spv_inst));
     function_->AddBasicBlock(std::move(block_));
     block_ = nullptr;
@@ -116,24 +92,80 @@ bool IrLoader::AddInstruction(const spv_parsed_instruction_t* inst) {
         SPIRV_UNIMPLEMENTED(consumer_,
                             "unhandled inst type outside function definition");
       }
+    } else if (block_ == nullptr) {  // Inside function but outside blocks
+      function_->AddParameter(std::move(spv_inst));
     } else {
-      if (block_ == nullptr) {  // Inside function but outside blocks
-        if (opcode != SpvOpFunctionParameter) {
-          Errorf(consumer_, src, loc,
-                 "Non-OpFunctionParameter (opcode: %d) found inside "
-                 "function but outside basic block",
-                 opcode);
-          return false;
-        }
-        function_->AddParameter(std::move(spv_inst));
-      } else {
-        block_->AddInstruction(std::move(spv_inst));
-      }
+      block_->AddInstruction(std::move(spv_inst));
     }
   }
   return true;
 }
 
+bool IrLoader::CheckLazyBodyInstruction(const spv_parsed_instruction_t* inst) {
+  ++inst_index_;
+  const auto opcode = static_cast<SpvOp>(inst->opcode);
+  if (IsDebugLineInst(opcode)) return true;
+  if (!CheckPosition(opcode, true, lazy_block_open_)) return false;
+  if (opcode == SpvOpLabel) {
+    lazy_block_open_ = true;
+  } else if (IsTerminatorInst(opcode)) {
+    lazy_block_open_ = false;
+  }
+  return true;
+}
+
+uint32_t IrLoader::TakeUniqueId() {
+  if (next_unique_id_ == 0) return module_->context()->TakeNextUniqueId();
+  return next_unique_id_++;
+}
+
+bool IrLoader::CheckPosition(SpvOp opcode, bool in_function, bool in_block) {
+  const char* src = source_.c_str();
+  spv_position_t loc = {inst_index_, 0, 0};
+
+  if (opcode == SpvOpFunction) {
+    if (in_function) {
+      Error(consumer_, src, loc, "function inside function");
+      return false;
+    }
+  } else if (opcode == SpvOpFunctionEnd) {
+    if (!in_function) {
+      Error(consumer_, src, loc,
+            "OpFunctionEnd without corresponding OpFunction");
+      return false;
+    }
+    if (in_block) {
+      Error(consumer_, src, loc, "OpFunctionEnd inside basic block");
+      return false;
+    }
+  } else if (opcode == SpvOpLabel) {
+    if (!in_function) {
+      Error(consumer_, src, loc, "OpLabel outside function");
+      return false;
+    }
+    if (in_block) {
+      Error(consumer_, src, loc, "OpLabel inside basic block");
+      return false;
+    }
+  } else if (IsTerminatorInst(opcode)) {
+    if (!in_function) {
+      Error(consumer_, src, loc, "terminator instruction outside function");
+      return false;
+    }
+    if (!in_block) {
+      Error(consumer_, src, loc, "terminator instruction outside basic block");
+      return false;
+    }
+  } else if (in_function && !in_block && opcode != SpvOpFunctionParameter) {
+    Errorf(consumer_, src, loc,
+           "Non-OpFunctionParameter (opcode: %d) found inside "
+           "function but outside basic block",
+           opcode);
+    return false;
+  }
+  return true;
+}
+
 // Resolves internal references among the module, functions, basic blocks, etc.
 // This function should be called after adding all instructions.
 void IrLoader::EndModule() {
@@ -144,17 +176,39 @@ void IrLoader::EndModule() {
     function_->AddBasicBlock(std::move(block_));
     block_ = nullptr;
   }
-  if (function_) {
-    // We're in the middle of a function, but the OpFunctionEnd is missing.
-    // Register the function anyway.  This lets us write tests with less
-    // boilerplate.
-    module_->AddFunction(std::move(function_));
-    function_ = nullptr;
-  }
+  // We might be in the middle of a function, but the OpFunctionEnd is missing.
+  // The function is registered anyway.  This lets us write tests with less
+  // boilerplate.
+  function_ = nullptr;
   for (auto& function : *module_) {
-    for (auto& bb : function) bb.SetParent(&function);
     function.SetParent(module_);
+    // The blocks of a function body loaded later get their parent then.
+    if (!function.IsBodyLoaded()) continue;
+    for (auto& bb : function) bb.SetParent(&function);
+  }
+}
+
+Function* IrLoader::DeferFunctionBody() {
+  SPIRV_ASSERT(consumer_, function_ != nullptr && block_ == nullptr);
+  Function* function = function_;
+  function_ = nullptr;
+  lazy_block_open_ = false;
+  return function;
+}
+
+void IrLoader::SetLazyFunctionBody(
+    std::shared_ptr<LazyFunctionLoader> body_loader, size_t begin,
+    size_t end) {
+  DeferFunctionBody()->SetLazyBody(std::move(body_loader), begin, end);
+}
+
+void IrLoader::EndFunctionBody() {
+  if (block_ && function_) {
+    // We're in the middle of a basic block, but the terminator is missing.
+    function_->AddBasicBlock(std::move(block_));
+    block_ = nullptr;
   }
+  function_ = nullptr;
 }
 
 }  // namespace ir
@@ -61,7 +61,44 @@ class IrLoader {
   // or a missing OpFunctionEnd.  Resolves internal bookkeeping.
   void EndModule();
 
+  // Stops adding instructions to the function whose OpFunction instruction was
+  // the last one added, so that its body can be loaded separately, and returns
+  // the function.
+  Function* DeferFunctionBody();
+
+  // Makes the instructions added next take consecutive unique ids starting at
+  // |unique_id|, which the caller has taken from the context of the module,
+  // instead of taking them from the context.
+  void SetNextUniqueId(uint32_t unique_id) { next_unique_id_ = unique_id; }
+
+  // Checks the position of |inst| in the body of the function whose
+  // OpFunction instruction was the last one added, as AddInstruction() would,
+  // but without adding it.  Returns true if no error occurs.
+  bool CheckLazyBodyInstruction(const spv_parsed_instruction_t* inst);
+  // Defers loading the body of the function whose OpFunction instruction was
+  // the last one added.  Its parameters, basic blocks and OpFunctionEnd are the
+  // words [|begin|, |end|) of the binary held by |body_loader|, and are not
+  // given to AddInstruction().
+  void SetLazyFunctionBody(std::shared_ptr<LazyFunctionLoader> body_loader,
+                           size_t begin, size_t end);
+
+  // Makes the following instructions given to AddInstruction() the body of
+  // the given |function| of the module, up to its OpFunctionEnd.
+  void BeginFunctionBody(Function* function) { function_ = function; }
+  // Finalizes the body started by BeginFunctionBody().  Like EndModule(), this
+  // is forgiving in the case of a missing terminator instruction on a basic
+  // block, or a missing OpFunctionEnd.
+  void EndFunctionBody();
+
  private:
+  // Returns the unique id for the next instruction.
+  uint32_t TakeUniqueId();
+
+  // Returns true if an instruction with |opcode| can appear inside a function
+  // or not, as given by |in_function|, and inside a basic block or not, as
+  // given by |in_block|.  Otherwise reports an error and returns false.
+  bool CheckPosition(SpvOp opcode, bool in_function, bool in_block);
+
   // Consumer for communicating messages to outside.
   const MessageConsumer& consumer_;
   // The module to be built.
@@ -70,12 +107,16 @@ class IrLoader {
   std::string source_;
   // The last used instruction index.
   uint32_t inst_index_;
-  // The current Function under construction.
-  std::unique_ptr<Function> function_;
+  // The current Function under construction.  It is owned by the module.
+  Function* function_;
   // The current BasicBlock under construction.
   std::unique_ptr<BasicBlock> block_;
   // Line related debug instructions accumulated thus far.
   std::vector<Instruction> dbg_line_info_;
+  // Whether CheckLazyBodyInstruction() is inside a basic block.
+  bool lazy_block_open_;
+  // The unique id for the next instruction, or 0 to take it from the context.
+  uint32_t next_unique_id_;
 };
 
 }  // namespace ir
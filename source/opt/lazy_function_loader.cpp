@@ -0,0 +1,154 @@
+// Copyright (c) 2018 Google LLC.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lazy_function_loader.h"
+
+#include <algorithm>
+
+#include "ir_context.h"
+#include "ir_loader.h"
+#include "log.h"
+#include "spirv_endian.h"
+#include "table.h"
+#include "util/parallel.h"
+
+namespace spvtools {
+namespace ir {
+
+LazyFunctionLoader::LazyFunctionLoader(spv_target_env env,
+                                       MessageConsumer consumer,
+                                       const uint32_t* binary, size_t size)
+    : consumer_(std::move(consumer)),
+      words_(binary, binary + size),
+      context_(spvContextCreate(env)),
+      iterator_(nullptr) {
+  // The bodies which are not loaded are written out verbatim, so they must
+  // have the host endianness.
+  if (!words_.empty() && words_[0] != SpvMagicNumber) {
+    const spv_endianness_t other_endian = spvIsHostEndian(SPV_ENDIANNESS_BIG)
+                                              ? SPV_ENDIANNESS_LITTLE
+                                              : SPV_ENDIANNESS_BIG;
+    if (spvFixWord(words_[0], other_endian) == SpvMagicNumber) {
+      std::transform(words_.begin(), words_.end(), words_.begin(),
+                     [other_endian](uint32_t word) {
+                       return spvFixWord(word, other_endian);
+                     });
+    }
+  }
+  libspirv::SetContextMessageConsumer(context_, consumer_);
+  iterator_ = spvBinaryIteratorCreate(context_);
+}
+
+LazyFunctionLoader::~LazyFunctionLoader() {
+  spvBinaryIteratorDestroy(iterator_);
+  spvContextDestroy(context_);
+}
+
+bool LazyFunctionLoader::LoadModule(Module* module) {
+  return LoadModule(module, nullptr);
+}
+
+bool LazyFunctionLoader::LoadModuleInParallel(Module* module,
+                                              uint32_t num_threads) {
+  std::vector<Body> bodies;
+  if (!LoadModule(module, &bodies)) return false;
+
+  // Each thread parses with its own copy of the parser state, which has the
+  // types and extended instruction imports of the whole module.
+  std::vector<spv_binary_iterator> iterators(
+      std::max<uint32_t>(num_threads, 1), nullptr);
+  spvutils::ParallelFor(
+      bodies.size(), num_threads,
+      [this, &bodies, &iterators](size_t i, uint32_t worker) {
+        if (!iterators[worker])
+          iterators[worker] = spvBinaryIteratorCreateCopy(context_, iterator_);
+        LoadBody(iterators[worker], bodies[i]);
+      });
+  for (spv_binary_iterator iterator : iterators)
+    spvBinaryIteratorDestroy(iterator);
+  return true;
+}
+
+bool LazyFunctionLoader::LoadModule(Module* module, std::vector<Body>* bodies) {
+  IrLoader loader(consumer_, module);
+
+  spv_parsed_header_t header;
+  if (spvBinaryIteratorBegin(iterator_, words_.data(), words_.size(), &header,
+                             nullptr) != SPV_SUCCESS) {
+    return false;
+  }
+  loader.SetModuleHeader(header.magic, header.version, header.generator,
+                         header.id_bound, header.reserved);
+
+  const spv_parsed_instruction_t* inst = nullptr;
+  spv_result_t status;
+  while ((status = spvBinaryIteratorNext(iterator_, &inst)) == SPV_SUCCESS) {
+    if (!loader.AddInstruction(inst)) return false;
+    if (inst->opcode != SpvOpFunction) continue;
+
+    // Parse the body to check it, up to and including the OpFunctionEnd, and
+    // only record where it is.
+    const size_t begin = size_t(inst->words - words_.data()) + inst->num_words;
+    size_t end = begin;
+    uint32_t num_insts = 0;
+    while (end < words_.size() &&
+           (status = spvBinaryIteratorNext(iterator_, &inst)) == SPV_SUCCESS) {
+      if (!loader.CheckLazyBodyInstruction(inst)) return false;
+      end += inst->num_words;
+      ++num_insts;
+      if (inst->opcode == SpvOpFunctionEnd) break;
+    }
+    if (status != SPV_SUCCESS) return false;
+    if (bodies) {
+      // Every instruction of the body takes a unique id, in order.
+      bodies->push_back({loader.DeferFunctionBody(), begin, end,
+                         module->context()->TakeUniqueIds(num_insts)});
+    } else {
+      loader.SetLazyFunctionBody(shared_from_this(), begin, end);
+    }
+  }
+  loader.EndModule();
+
+  return status == SPV_END_OF_STREAM;
+}
+
+void LazyFunctionLoader::LoadBody(Function* function, size_t begin,
+                                  size_t end) {
+  LoadBody(iterator_, {function, begin, end, 0});
+}
+
+void LazyFunctionLoader::LoadBody(spv_binary_iterator iterator,
+                                  const Body& body) {
+  IrLoader loader(consumer_, body.function->context()->module());
+  loader.BeginFunctionBody(body.function);
+  loader.SetNextUniqueId(body.first_unique_id);
+  if (body.begin < body.end &&
+      spvBinaryIteratorSeek(iterator, body.begin) == SPV_SUCCESS) {
+    const spv_parsed_instruction_t* inst = nullptr;
+    for (size_t index = body.begin; index < body.end;
+         index += inst->num_words) {
+      // The body was parsed successfully when the module was loaded.
+      if (spvBinaryIteratorNext(iterator, &inst) != SPV_SUCCESS ||
+          !loader.AddInstruction(inst)) {
+        SPIRV_ASSERT(consumer_, false, "failed to load a function body");
+        break;
+      }
+    }
+  }
+  loader.EndFunctionBody();
+  for (auto& bb : *body.function) bb.SetParent(body.function);
+}
+
+}  // namespace ir
+}  // namespace spvtools
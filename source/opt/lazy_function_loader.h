@@ -0,0 +1,97 @@
+// Copyright (c) 2018 Google LLC.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef LIBSPIRV_OPT_LAZY_FUNCTION_LOADER_H_
+#define LIBSPIRV_OPT_LAZY_FUNCTION_LOADER_H_
+
+#include <memory>
+#include <vector>
+
+#include "function.h"
+#include "module.h"
+#include "spirv-tools/libspirv.hpp"
+
+namespace spvtools {
+namespace ir {
+
+// Loads a module from a SPIR-V binary, leaving the bodies of its functions to
+// be loaded when they are first accessed.  An instance holds a copy of the
+// binary and the parser state needed to load the bodies.  It is shared by the
+// functions whose body is not loaded yet, and goes away with the last of them.
+class LazyFunctionLoader
+    : public std::enable_shared_from_this<LazyFunctionLoader> {
+ public:
+  // Copies the |size| words of |binary|, converted to the host endianness, to
+  // decode them according to the given target |env|.  Errors are sent to
+  // |consumer|.
+  LazyFunctionLoader(spv_target_env env, MessageConsumer consumer,
+                     const uint32_t* binary, size_t size);
+  ~LazyFunctionLoader();
+
+  LazyFunctionLoader(const LazyFunctionLoader&) = delete;
+  LazyFunctionLoader& operator=(const LazyFunctionLoader&) = delete;
+
+  // Loads the module-level instructions and the OpFunction instructions of the
+  // binary into |module|.  The syntax of the function bodies is checked, but
+  // only their position is recorded.  Returns true on success.
+  bool LoadModule(Module* module);
+
+  // Loads the whole binary into |module|, checking it as LoadModule() does,
+  // and then loads the function bodies using up to |num_threads| threads.  The
+  // result, including the unique ids of the instructions, is the same as with
+  // IrLoader.  Returns true on success.
+  bool LoadModuleInParallel(Module* module, uint32_t num_threads);
+
+  // Loads the parameters, basic blocks and OpFunctionEnd of |function| from
+  // the words [|begin|, |end|) of the binary.
+  void LoadBody(Function* function, size_t begin, size_t end);
+
+  // Returns the words of the binary.
+  const uint32_t* words() const { return words_.data(); }
+
+ private:
+  // The position of a function body in the binary.
+  struct Body {
+    Function* function;
+    size_t begin;
+    size_t end;
+    // The unique id of the first instruction of the body, or 0 to take the
+    // unique ids from the context when the body is loaded.
+    uint32_t first_unique_id;
+  };
+
+  // Loads the module-level instructions and the OpFunction instructions of the
+  // binary into |module|, and checks the function bodies.  If |bodies| is
+  // null, the bodies are left to be loaded on first access.  Otherwise they
+  // are appended to |bodies|, with the unique ids they would get from
+  // IrLoader.  Returns true on success.
+  bool LoadModule(Module* module, std::vector<Body>* bodies);
+
+  // Loads |body| with |iterator|.
+  void LoadBody(spv_binary_iterator iterator, const Body& body);
+
+  // Consumer for communicating messages to outside.
+  MessageConsumer consumer_;
+  // The binary, in the host endianness.
+  std::vector<uint32_t> words_;
+  spv_context context_;
+  // The parser, which keeps the types and extended instruction imports of the
+  // module to parse the bodies as in the first pass.
+  spv_binary_iterator iterator_;
+};
+
+}  // namespace ir
+}  // namespace spvtools
+
+#endif  // LIBSPIRV_OPT_LAZY_FUNCTION_LOADER_H_
@@ -0,0 +1,269 @@
+// Copyright (c) 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "load_store_elim_pass.h"
+
+#include <unordered_set>
+#include <vector>
+
+namespace spvtools {
+namespace opt {
+
+namespace {
+const uint32_t kStoreValInIdx = 1;
+const uint32_t kVariableInitializerInIdx = 1;
+
+// The number of non-aliasing stores a load looks through to find the def it
+// reads from.
+const uint32_t kMaxClobberWalk = 64;
+
+// Returns true if |a| and |b| refer to the same memory.
+bool SameLocation(const MemorySSA& memory_ssa, const MemoryLocation& a,
+                  const MemoryLocation& b) {
+  return memory_ssa.Covers(a, b) && memory_ssa.Covers(b, a);
+}
+}  // namespace
+
+Pass::Status LoadStoreElimPass::Process(ir::IRContext* c) {
+  InitializeProcessing(c);
+
+  bool modified = false;
+  for (auto& func : *get_module()) {
+    if (IsFunctionSettled(&func)) continue;
+    if (RecordFunctionResult(&func, ProcessFunction(&func))) modified = true;
+  }
+  return modified ? Status::SuccessWithChange : Status::SuccessWithoutChange;
+}
+
+bool LoadStoreElimPass::ProcessFunction(ir::Function* func) {
+  if (func->begin() == func->end()) return false;
+
+  MemorySSA* memory_ssa = context()->GetMemorySSAAnalysis()->Get(func);
+  DominatorAnalysis* dominators = context()->GetDominatorAnalysis(func);
+
+  // Every decision is made on the memory SSA form before anything changes.
+  // |replacements| maps each redundant load to the value it is replaced by,
+  // which may be another redundant load.
+  std::unordered_map<uint32_t, uint32_t> replacements;
+  std::vector<ir::Instruction*> dead_stores;
+
+  // The loads that are kept, by the def or phi they read from.  Blocks are
+  // laid out after their dominators, so a load is visited after the loads
+  // that dominate it.
+  std::unordered_map<MemoryAccess*, std::vector<ir::Instruction*>>
+      available_loads;
+  for (ir::BasicBlock& bb : *func) {
+    for (ir::Instruction& inst : bb) {
+      MemoryAccess* access = memory_ssa->GetAccess(&inst);
+      if (access == nullptr) continue;
+
+      if (inst.opcode() == SpvOpStore && access->IsDef() &&
+          !memory_ssa->IsVolatile(&inst)) {
+        const MemoryLocation& location = memory_ssa->GetLocation(&inst);
+        if (!IsOptimizableStore(*memory_ssa, location)) continue;
+        if ((memory_ssa->IsLocalToFunction(location.root) &&
+             IsDeadLocalStore(memory_ssa, access)) ||
+            IsOverwrittenInBlock(memory_ssa, access)) {
+          dead_stores.push_back(&inst);
+        }
+        continue;
+      }
+
+      if (inst.opcode() != SpvOpLoad || !access->IsUse()) continue;
+      const MemoryLocation& location = memory_ssa->GetLocation(&inst);
+      if (!IsOptimizableLoad(*memory_ssa, location)) continue;
+
+      MemoryAccess* clobber = FindClobber(memory_ssa, access, location);
+      const uint32_t stored_value =
+          GetStoredValue(memory_ssa, clobber, location, inst.type_id());
+      if (stored_value != 0) {
+        replacements[inst.result_id()] = stored_value;
+        continue;
+      }
+
+      std::vector<ir::Instruction*>& loads = available_loads[clobber];
+      bool redundant = false;
+      for (ir::Instruction* load : loads) {
+        if (load->type_id() == inst.type_id() &&
+            SameLocation(*memory_ssa, memory_ssa->GetLocation(load),
+                         location) &&
+            dominators->Dominates(load, &inst)) {
+          replacements[inst.result_id()] = load->result_id();
+          redundant = true;
+          break;
+        }
+      }
+      if (!redundant) loads.push_back(&inst);
+    }
+  }
+
+  if (replacements.empty() && dead_stores.empty()) return false;
+
+  auto find_value = [&replacements](uint32_t id) {
+    auto it = replacements.find(id);
+    while (it != replacements.end()) {
+      id = it->second;
+      it = replacements.find(id);
+    }
+    return id;
+  };
+  std::vector<std::pair<uint32_t, uint32_t>> load_values;
+  for (const auto& replacement : replacements) {
+    load_values.emplace_back(replacement.first, find_value(replacement.first));
+  }
+
+  // The memory SSA form is invalidated by the first kill, so it is not used
+  // past this point.
+  for (const auto& load_value : load_values) {
+    context()->ReplaceAllUsesWith(load_value.first, load_value.second);
+  }
+  for (const auto& load_value : load_values) {
+    context()->KillInst(get_def_use_mgr()->GetDef(load_value.first));
+  }
+  for (ir::Instruction* store : dead_stores) context()->KillInst(store);
+  return true;
+}
+
+bool LoadStoreElimPass::IsOptimizableLoad(
+    const MemorySSA& memory_ssa, const MemoryLocation& location) const {
+  switch (location.storage_class) {
+    case SpvStorageClassFunction:
+    case SpvStorageClassPrivate:
+    case SpvStorageClassWorkgroup:
+      return true;
+    default:
+      return location.root != 0 && memory_ssa.IsReadOnly(location.root);
+  }
+}
+
+bool LoadStoreElimPass::IsOptimizableStore(
+    const MemorySSA&, const MemoryLocation& location) const {
+  if (location.root == 0) return false;
+  switch (location.storage_class) {
+    case SpvStorageClassFunction:
+    case SpvStorageClassPrivate:
+    case SpvStorageClassWorkgroup:
+      return true;
+    default:
+      return false;
+  }
+}
+
+MemoryAccess* LoadStoreElimPass::FindClobber(
+    MemorySSA* memory_ssa, MemoryAccess* load,
+    const MemoryLocation& location) const {
+  MemoryAccess* clobber = load->defining_access();
+  for (uint32_t i = 0; i < kMaxClobberWalk; ++i) {
+    // The defining access of a def follows the class of that def, so only the
+    // stores of the same class can be looked through.
+    if (!clobber->IsDef() || clobber->alias_class() != load->alias_class())
+      break;
+    ir::Instruction* store = clobber->instruction();
+    if (store->opcode() != SpvOpStore || memory_ssa->IsVolatile(store) ||
+        memory_ssa->MayAlias(memory_ssa->GetLocation(store), location)) {
+      break;
+    }
+    clobber = clobber->defining_access();
+  }
+  return clobber;
+}
+
+uint32_t LoadStoreElimPass::GetStoredValue(MemorySSA* memory_ssa,
+                                           MemoryAccess* clobber,
+                                           const MemoryLocation& location,
+                                           uint32_t type_id) const {
+  if (!clobber->IsDef()) return 0;
+  ir::Instruction* inst = clobber->instruction();
+  uint32_t value = 0;
+  if (inst->opcode() == SpvOpStore) {
+    if (memory_ssa->IsVolatile(inst) ||
+        !SameLocation(*memory_ssa, memory_ssa->GetLocation(inst), location)) {
+      return 0;
+    }
+    value = inst->GetSingleWordInOperand(kStoreValInIdx);
+  } else if (inst->opcode() == SpvOpVariable) {
+    if (!SameLocation(*memory_ssa, memory_ssa->GetLocation(inst->result_id()),
+                      location)) {
+      return 0;
+    }
+    value = inst->GetSingleWordInOperand(kVariableInitializerInIdx);
+  } else {
+    return 0;
+  }
+  return get_def_use_mgr()->GetDef(value)->type_id() == type_id ? value : 0;
+}
+
+bool LoadStoreElimPass::IsDeadLocalStore(MemorySSA* memory_ssa,
+                                         MemoryAccess* store) const {
+  const MemoryLocation& location =
+      memory_ssa->GetLocation(store->instruction());
+
+  // Only loads and stores access a variable local to the function.  Follow the
+  // value of the store until it is overwritten, and look for loads reading it.
+  std::vector<MemoryAccess*> worklist(store->users().begin(),
+                                      store->users().end());
+  std::unordered_set<MemoryAccess*> visited(worklist.begin(), worklist.end());
+  while (!worklist.empty()) {
+    MemoryAccess* access = worklist.back();
+    worklist.pop_back();
+
+    if (!access->IsPhi()) {
+      ir::Instruction* inst = access->instruction();
+      if (inst->opcode() == SpvOpLoad) {
+        if (access->IsDef() ||
+            memory_ssa->MayAlias(memory_ssa->GetLocation(inst), location)) {
+          return false;
+        }
+        continue;
+      }
+      if (inst->opcode() != SpvOpStore) return false;
+      if (memory_ssa->Covers(memory_ssa->GetLocation(inst), location)) {
+        continue;
+      }
+    }
+    for (MemoryAccess* user : access->users()) {
+      if (visited.insert(user).second) worklist.push_back(user);
+    }
+  }
+  return true;
+}
+
+bool LoadStoreElimPass::IsOverwrittenInBlock(MemorySSA* memory_ssa,
+                                             MemoryAccess* store) const {
+  const MemoryLocation& location =
+      memory_ssa->GetLocation(store->instruction());
+  for (ir::Instruction* inst = store->instruction()->NextNode();
+       inst != nullptr; inst = inst->NextNode()) {
+    MemoryAccess* access = memory_ssa->GetAccess(inst);
+    if (access == nullptr) continue;
+
+    if (inst->opcode() == SpvOpLoad && access->IsUse()) {
+      if (memory_ssa->MayAlias(memory_ssa->GetLocation(inst), location)) {
+        return false;
+      }
+      continue;
+    }
+    if (inst->opcode() != SpvOpStore || memory_ssa->IsVolatile(inst)) {
+      // Anything else may read the location.
+      return false;
+    }
+    if (memory_ssa->Covers(memory_ssa->GetLocation(inst), location)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace opt
+}  // namespace spvtools
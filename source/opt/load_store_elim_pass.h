@@ -0,0 +1,83 @@
+// Copyright (c) 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef LIBSPIRV_OPT_LOAD_STORE_ELIM_PASS_H_
+#define LIBSPIRV_OPT_LOAD_STORE_ELIM_PASS_H_
+
+#include <unordered_map>
+
+#include "ir_context.h"
+#include "memory_ssa.h"
+#include "pass.h"
+
+namespace spvtools {
+namespace opt {
+
+// See optimizer.hpp for documentation.
+class LoadStoreElimPass : public Pass {
+ public:
+  const char* name() const override {
+    return "eliminate-redundant-loads-stores";
+  }
+  Status Process(ir::IRContext* c) override;
+  bool RecordsFunctionChanges() const override { return true; }
+
+  ir::IRContext::Analysis GetPreservedAnalyses() override {
+    return ir::IRContext::kAnalysisDefUse | ir::IRContext::kAnalysisCFG |
+           ir::IRContext::kAnalysisInstrToBlockMapping |
+           ir::IRContext::kAnalysisLoopAnalysis |
+           ir::IRContext::kAnalysisDecorations |
+           ir::IRContext::kAnalysisCombinators |
+           ir::IRContext::kAnalysisDominatorAnalysis |
+           ir::IRContext::kAnalysisNameMap;
+  }
+
+ private:
+  // Removes the redundant loads and dead stores of |func|.  Returns true if
+  // |func| is modified.
+  bool ProcessFunction(ir::Function* func);
+
+  // Returns true if loads from |location| may be removed.
+  bool IsOptimizableLoad(const MemorySSA& memory_ssa,
+                         const MemoryLocation& location) const;
+
+  // Returns true if stores to |location| may be removed.
+  bool IsOptimizableStore(const MemorySSA& memory_ssa,
+                          const MemoryLocation& location) const;
+
+  // Returns the def or phi that the value loaded by |load|, from |location|,
+  // comes from.  Skips the stores that do not alias |location|.
+  MemoryAccess* FindClobber(MemorySSA* memory_ssa, MemoryAccess* load,
+                            const MemoryLocation& location) const;
+
+  // Returns the id of the value that the def |clobber| writes to
+  // |location|, if it writes all of it with a value of type |type_id|.
+  // Returns 0 otherwise.
+  uint32_t GetStoredValue(MemorySSA* memory_ssa, MemoryAccess* clobber,
+                          const MemoryLocation& location,
+                          uint32_t type_id) const;
+
+  // Returns true if the value written by the store |store| to the variable
+  // local to the function can never be read.
+  bool IsDeadLocalStore(MemorySSA* memory_ssa, MemoryAccess* store) const;
+
+  // Returns true if the value written by the store |store| is overwritten
+  // later in the same block before anything may read it.
+  bool IsOverwrittenInBlock(MemorySSA* memory_ssa, MemoryAccess* store) const;
+};
+
+}  // namespace opt
+}  // namespace spvtools
+
+#endif  // LIBSPIRV_OPT_LOAD_STORE_ELIM_PASS_H_
@@ -38,6 +38,7 @@ class LocalAccessChainConvertPass : public MemPass {
   LocalAccessChainConvertPass();
   const char* name() const override { return "convert-local-access-chains"; }
   Status Process(ir::IRContext* c) override;
+  bool RecordsFunctionChanges() const override { return true; }
 
   ir::IRContext::Analysis GetPreservedAnalyses() override {
     return ir::IRContext::kAnalysisDefUse;
@@ -38,6 +38,7 @@ class LocalSingleBlockLoadStoreElimPass : public MemPass {
   LocalSingleBlockLoadStoreElimPass();
   const char* name() const override { return "eliminate-local-single-block"; }
   Status Process(ir::IRContext* c) override;
+  bool RecordsFunctionChanges() const override { return true; }
 
   ir::IRContext::Analysis GetPreservedAnalyses() override {
     return ir::IRContext::kAnalysisDefUse;
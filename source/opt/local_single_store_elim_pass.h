@@ -40,6 +40,7 @@ class LocalSingleStoreElimPass : public Pass {
   LocalSingleStoreElimPass();
   const char* name() const override { return "eliminate-local-single-store"; }
   Status Process(ir::IRContext* irContext) override;
+  bool RecordsFunctionChanges() const override { return true; }
 
   ir::IRContext::Analysis GetPreservedAnalyses() override {
     return ir::IRContext::kAnalysisDefUse;
@@ -43,6 +43,7 @@ class LocalMultiStoreElimPass : public MemPass {
   LocalMultiStoreElimPass();
   const char* name() const override { return "eliminate-local-multi-store"; }
   Status Process(ir::IRContext* c) override;
+  bool RecordsFunctionChanges() const override { return true; }
 
   ir::IRContext::Analysis GetPreservedAnalyses() override {
     return ir::IRContext::kAnalysisDefUse |
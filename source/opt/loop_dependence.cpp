@@ -343,6 +343,61 @@ bool LoopDependenceAnalysis::GetDependence(const ir::Instruction* source,
   return false;
 }
 
+DistanceEntry::Directions LoopDependenceAnalysis::GetDependenceDirections(
+    const ir::Instruction* source, const ir::Instruction* destination) {
+  assert(loops_.size() == 1 &&
+         "The analysis must be created for a single loop.");
+
+  auto is_access_chain = [](const ir::Instruction* pointer) {
+    return pointer->opcode() == SpvOpAccessChain ||
+           pointer->opcode() == SpvOpInBoundsAccessChain;
+  };
+
+  ir::Instruction* source_pointer = GetOperandDefinition(source, 0);
+  ir::Instruction* destination_pointer = GetOperandDefinition(destination, 0);
+  ir::Instruction* source_base =
+      is_access_chain(source_pointer)
+          ? GetOperandDefinition(source_pointer, 0)
+          : source_pointer;
+  ir::Instruction* destination_base =
+      is_access_chain(destination_pointer)
+          ? GetOperandDefinition(destination_pointer, 0)
+          : destination_pointer;
+
+  if (source_base != destination_base) {
+    // Distinct variables never alias, but pointers obtained in any other way
+    // (e.g. function parameters) might point to the same variable.
+    if (source_base->opcode() == SpvOpVariable &&
+        destination_base->opcode() == SpvOpVariable) {
+      PrintDebug("Proved independence through different variables.");
+      return DistanceEntry::Directions::NONE;
+    }
+    return DistanceEntry::Directions::ALL;
+  }
+
+  // Without a pair of subscripts for each dimension, assume every access
+  // overlaps.
+  if (!is_access_chain(source_pointer) ||
+      !is_access_chain(destination_pointer) ||
+      source_pointer->NumInOperands() != destination_pointer->NumInOperands()) {
+    return DistanceEntry::Directions::ALL;
+  }
+
+  DistanceVector distance_vector(loops_.size());
+  if (GetDependence(source, destination, &distance_vector)) {
+    return DistanceEntry::Directions::NONE;
+  }
+
+  // A subscript which does not depend on the loop means the same location is
+  // accessed by every iteration.
+  const DistanceEntry& entry = distance_vector.GetEntry(0);
+  if (entry.dependence_information ==
+      DistanceEntry::DependenceInformation::IRRELEVANT) {
+    return DistanceEntry::Directions::ALL;
+  }
+  return entry.direction;
+}
+
 bool LoopDependenceAnalysis::ZIVTest(
     const std::pair<SENode*, SENode*>& subscript_pair) {
   auto source = std::get<0>(subscript_pair);
@@ -312,6 +312,16 @@ class LoopDependenceAnalysis {
                      const ir::Instruction* destination,
                      DistanceVector* distance_vector);
 
+  // Returns the possible directions of the dependence between |source| and
+  // |destination|, which are OpLoad or OpStore instructions, with respect to
+  // the single loop the analysis was created with. Returns NONE if the
+  // accesses are independent and ALL if nothing could be proven.
+  // Unlike GetDependence, the pointers are not required to be access chains:
+  // accesses to distinct variables are independent, and any other access which
+  // cannot be compared subscript by subscript is assumed to alias.
+  DistanceEntry::Directions GetDependenceDirections(
+      const ir::Instruction* source, const ir::Instruction* destination);
+
   // Returns true if |subscript_pair| represents a Zero Index Variable pair
   // (ZIV)
   bool IsZIV(const std::pair<SENode*, SENode*>& subscript_pair);
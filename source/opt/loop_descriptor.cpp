@@ -863,27 +863,37 @@ void LoopDescriptor::PostModificationCleanup() {
   for (ir::Loop* loop : loops_) {
     if (loop->IsMarkedForRemoval()) {
       loops_to_remove_.push_back(loop);
-      if (loop->HasParent()) {
-        loop->GetParent()->RemoveChildLoop(loop);
-      }
     }
   }
 
+  // The blocks and nested loops of a removed loop go to its parent.
   for (ir::Loop* loop : loops_to_remove_) {
-    loops_.erase(std::find(loops_.begin(), loops_.end(), loop));
+    RemoveLoop(loop);
   }
 
   for (auto& pair : loops_to_add_) {
     ir::Loop* parent = pair.first;
     ir::Loop* loop = pair.second;
 
+    loop->SetParent(nullptr);
     if (parent) {
-      loop->SetParent(nullptr);
       parent->AddNestedLoop(loop);
 
       for (uint32_t block_id : loop->GetBlocks()) {
         parent->AddBasicBlock(block_id);
       }
+    } else {
+      SetAsTopLoop(loop);
+    }
+
+    // The new loop is the inner most loop of its blocks, unless they are in
+    // one of its nested loops.
+    for (uint32_t block_id : loop->GetBlocks()) {
+      ir::Loop* inner_loop = FindLoopForBasicBlock(block_id);
+      while (inner_loop && inner_loop != loop) {
+        inner_loop = inner_loop->GetParent();
+      }
+      if (!inner_loop) SetBasicBlockToLoop(block_id, loop);
     }
 
     loops_.emplace_back(loop);
@@ -892,6 +902,22 @@ void LoopDescriptor::PostModificationCleanup() {
   loops_to_add_.clear();
 }
 
+void LoopDescriptor::AddBasicBlock(uint32_t bb_id, ir::Loop* loop) {
+  if (loop) {
+    loop->AddBasicBlock(bb_id);
+    SetBasicBlockToLoop(bb_id, loop);
+  } else {
+    ForgetBasicBlock(bb_id);
+  }
+}
+
+void LoopDescriptor::MoveBasicBlock(uint32_t bb_id, ir::Loop* loop) {
+  if (ir::Loop* current_loop = FindLoopForBasicBlock(bb_id)) {
+    current_loop->RemoveBasicBlock(bb_id);
+  }
+  AddBasicBlock(bb_id, loop);
+}
+
 void LoopDescriptor::ClearLoops() {
   for (Loop* loop : loops_) {
     delete loop;
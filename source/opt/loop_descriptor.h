@@ -250,6 +250,16 @@ class Loop {
     return loop_header_->GetLoopMergeInst()->GetSingleWordOperand(2) == 1;
   }
 
+  // Returns true if the DontUnroll bit of the loop control of the OpLoopMerge
+  // is set.
+  inline bool HasDontUnrollLoopControl() const {
+    assert(loop_header_);
+    if (!loop_header_->GetLoopMergeInst()) return false;
+
+    return (loop_header_->GetLoopMergeInst()->GetSingleWordOperand(2) &
+            SpvLoopControlDontUnrollMask) != 0;
+  }
+
   // Finds the conditional block with a branch to the merge and continue blocks
   // within the loop body.
   ir::BasicBlock* FindConditionBlock() const;
@@ -482,7 +492,8 @@ class LoopDescriptor {
   }
 
   // Should be called to preserve the LoopAnalysis after loops have been marked
-  // for addition with AddLoop or MarkLoopForRemoval.
+  // for addition with AddLoop or MarkLoopForRemoval. The loops marked for
+  // removal are deleted, as with RemoveLoop.
   void PostModificationCleanup();
 
   // Removes the basic block id |bb_id| from the block to loop mapping.
@@ -490,6 +501,17 @@ class LoopDescriptor {
     basic_block_to_loop_.erase(bb_id);
   }
 
+  // Adds the new basic block id |bb_id| to |loop| and its parents, and makes
+  // |loop| the inner most loop containing it. If |loop| is null, the block is
+  // not in any loop.
+  void AddBasicBlock(uint32_t bb_id, ir::Loop* loop);
+
+  // Moves the basic block id |bb_id| out of the loops containing it and into
+  // |loop| and its parents. If |loop| is null, the block leaves all loops. It
+  // is the user responsibility to make sure the block is not the header, merge
+  // or continue block of a loop it leaves.
+  void MoveBasicBlock(uint32_t bb_id, ir::Loop* loop);
+
   // Adds the loop |new_loop| and all its nested loops to the descriptor set.
   // The object takes ownership of all the loops.
   ir::Loop* AddLoopNest(std::unique_ptr<ir::Loop> new_loop);
@@ -0,0 +1,384 @@
+// Copyright (c) 2018 Google LLC.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "opt/loop_fission.h"
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "log.h"
+#include "opt/cfg.h"
+#include "opt/loop_dependence.h"
+#include "opt/loop_utils.h"
+
+namespace spvtools {
+namespace opt {
+
+LoopFission::LoopFission(ir::IRContext* context, ir::Loop* loop)
+    : context_(context), loop_(loop) {}
+
+bool LoopFission::CanSplit() {
+  if (loop_->HasNestedLoops() || !loop_->GetPreHeaderBlock() ||
+      !loop_->GetLatchBlock() || !loop_->GetMergeBlock()) {
+    return false;
+  }
+
+  // Both loops exit to the same place, so there must be a single way out.
+  std::unordered_set<uint32_t> exit_blocks;
+  loop_->GetExitBlocks(&exit_blocks);
+  if (exit_blocks.size() != 1 ||
+      context_->cfg()->preds(loop_->GetMergeBlock()->id()).size() != 1) {
+    return false;
+  }
+
+  if (!loop_->IsSafeToClone() ||
+      !LoopUtils(context_, loop_).HasOnlyStoreSideEffects()) {
+    return false;
+  }
+
+  Partition();
+  return stores_.size() >= 2;
+}
+
+void LoopFission::Partition() {
+  analysis::DefUseManager* def_use_mgr = context_->get_def_use_mgr();
+
+  ordered_blocks_.clear();
+  position_.clear();
+  stores_.clear();
+  control_.clear();
+  store_range_.clear();
+
+  loop_->ComputeLoopStructuredOrder(&ordered_blocks_);
+
+  // Returns false if |user| is an instruction of the function outside |loop_|.
+  auto is_not_outside_use = [this](ir::Instruction* user) {
+    ir::BasicBlock* bb = context_->get_instr_block(user);
+    return !bb || loop_->IsInsideLoop(bb);
+  };
+  // Returns false if |user| is an instruction of |loop_|.
+  auto is_not_inside_use = [this](ir::Instruction* user) {
+    ir::BasicBlock* bb = context_->get_instr_block(user);
+    return !bb || !loop_->IsInsideLoop(bb);
+  };
+
+  std::vector<ir::Instruction*> work_list;
+  for (ir::BasicBlock* bb : ordered_blocks_) {
+    for (ir::Instruction& inst : *bb) {
+      const size_t position = position_.size();
+      position_[&inst] = position;
+
+      if (inst.opcode() == SpvOpStore) {
+        stores_.push_back(&inst);
+        continue;
+      }
+
+      // The roots of the loop control: the control flow, the iterating values
+      // and the values which do not end in a store of the loop.
+      bool is_root = &inst == &*bb->tail() ||
+                     inst.opcode() == SpvOpLoopMerge ||
+                     inst.opcode() == SpvOpSelectionMerge ||
+                     (bb == loop_->GetHeaderBlock() &&
+                      inst.opcode() == SpvOpPhi);
+      if (!is_root && inst.HasResultId()) {
+        is_root = !def_use_mgr->WhileEachUser(&inst, is_not_outside_use) ||
+                  def_use_mgr->WhileEachUser(&inst, is_not_inside_use);
+      }
+      if (is_root && control_.insert(&inst).second) work_list.push_back(&inst);
+    }
+  }
+
+  // Calls |f| on each instruction of |loop_| defining an input of |inst|.
+  auto for_each_input = [this, def_use_mgr](
+                            ir::Instruction* inst,
+                            const std::function<void(ir::Instruction*)>& f) {
+    inst->ForEachInId([this, def_use_mgr, &f](const uint32_t* id) {
+      ir::Instruction* def = def_use_mgr->GetDef(*id);
+      if (!def || def->opcode() == SpvOpLabel) return;
+      ir::BasicBlock* def_bb = context_->get_instr_block(def);
+      if (def_bb && loop_->IsInsideLoop(def_bb)) f(def);
+    });
+  };
+
+  while (!work_list.empty()) {
+    ir::Instruction* inst = work_list.back();
+    work_list.pop_back();
+    for_each_input(inst, [this, &work_list](ir::Instruction* def) {
+      if (control_.insert(def).second) work_list.push_back(def);
+    });
+  }
+
+  // Record for each instruction the range of stores it contributes to.
+  for (size_t i = 0; i < stores_.size(); ++i) {
+    std::unordered_set<ir::Instruction*> visited;
+    work_list.push_back(stores_[i]);
+    while (!work_list.empty()) {
+      ir::Instruction* inst = work_list.back();
+      work_list.pop_back();
+      if (!visited.insert(inst).second) continue;
+
+      auto range = store_range_.insert({inst, {i, i}});
+      if (!range.second) range.first->second.second = i;
+
+      for_each_input(inst, [&work_list](ir::Instruction* def) {
+        work_list.push_back(def);
+      });
+    }
+  }
+}
+
+LoopFission::Placement LoopFission::GetPlacement(ir::Instruction* inst,
+                                                 size_t split) const {
+  if (control_.count(inst)) return Placement::kBoth;
+  auto range = store_range_.find(inst);
+  if (range == store_range_.end()) return Placement::kBoth;
+  if (range->second.second < split) return Placement::kFirst;
+  if (range->second.first >= split) return Placement::kSecond;
+  return Placement::kBoth;
+}
+
+bool LoopFission::IsLegal(size_t split) {
+  assert(split > 0 && split < stores_.size() && "Invalid split point.");
+
+  std::vector<ir::Instruction*> accesses;
+  for (ir::BasicBlock* bb : ordered_blocks_) {
+    for (ir::Instruction& inst : *bb) {
+      if (inst.opcode() == SpvOpLoad || inst.opcode() == SpvOpStore) {
+        accesses.push_back(&inst);
+      }
+    }
+  }
+
+  LoopDependenceAnalysis analysis(context_, {loop_});
+  for (ir::Instruction* first : accesses) {
+    if (GetPlacement(first, split) == Placement::kSecond) continue;
+    for (ir::Instruction* second : accesses) {
+      if (first == second ||
+          GetPlacement(second, split) == Placement::kFirst) {
+        continue;
+      }
+      if (first->opcode() == SpvOpLoad && second->opcode() == SpvOpLoad) {
+        continue;
+      }
+
+      // After the split, every iteration of |first| happens before every
+      // iteration of |second|. This is wrong if |second| accessed the memory
+      // first in the original loop, in an earlier iteration or earlier in the
+      // same iteration.
+      DistanceEntry::Directions directions =
+          analysis.GetDependenceDirections(first, second);
+      if (directions & DistanceEntry::Directions::LT) return false;
+      if ((directions & DistanceEntry::Directions::EQ) &&
+          position_.at(second) < position_.at(first)) {
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+void LoopFission::SimulateSplit(
+    const RegisterLiveness* liveness, size_t split,
+    RegisterLiveness::RegionRegisterLiveness* first,
+    RegisterLiveness::RegionRegisterLiveness* second) {
+  std::unordered_set<ir::Instruction*> moved;
+  std::unordered_set<ir::Instruction*> copied;
+  for (ir::BasicBlock* bb : ordered_blocks_) {
+    for (ir::Instruction& inst : *bb) {
+      switch (GetPlacement(&inst, split)) {
+        case Placement::kFirst:
+          moved.insert(&inst);
+          break;
+        case Placement::kBoth:
+          copied.insert(&inst);
+          break;
+        case Placement::kSecond:
+          break;
+      }
+    }
+  }
+  liveness->SimulateFission(*loop_, moved, copied, first, second);
+}
+
+void LoopFission::Split(size_t split) {
+  ir::CFG& cfg = *context_->cfg();
+  analysis::DefUseManager* def_use_mgr = context_->get_def_use_mgr();
+  LoopUtils loop_utils(context_, loop_);
+  ir::Function* function = loop_utils.GetFunction();
+
+  ir::BasicBlock* pre_header = loop_->GetPreHeaderBlock();
+  ir::BasicBlock* header = loop_->GetHeaderBlock();
+  ir::BasicBlock* merge = loop_->GetMergeBlock();
+
+  LoopUtils::LoopCloningResult clone_results;
+  ir::Loop* cloned_loop = loop_utils.CloneLoop(&clone_results, ordered_blocks_);
+  loop_utils.GetLoopDescriptor()->AddLoopNest(
+      std::unique_ptr<ir::Loop>(cloned_loop));
+
+  // The first loop only keeps what the first stores need, the second loop what
+  // the other stores need. The blocks are cloned in order, so the instructions
+  // can be matched by walking both loops together.
+  std::vector<ir::Instruction*> to_kill;
+  for (size_t i = 0; i < ordered_blocks_.size(); ++i) {
+    ir::BasicBlock::iterator cloned_inst = clone_results.cloned_bb_[i]->begin();
+    for (ir::Instruction& inst : *ordered_blocks_[i]) {
+      switch (GetPlacement(&inst, split)) {
+        case Placement::kFirst:
+          to_kill.push_back(&inst);
+          break;
+        case Placement::kSecond:
+          to_kill.push_back(&*cloned_inst);
+          break;
+        case Placement::kBoth:
+          break;
+      }
+      ++cloned_inst;
+    }
+  }
+
+  // Add the cloned blocks to the function, before |loop_|.
+  ir::Function::iterator it = function->FindBlock(pre_header->id());
+  assert(it != function->end() && "Pre-header not found in the function.");
+  function->AddBasicBlocks(clone_results.cloned_bb_.begin(),
+                           clone_results.cloned_bb_.end(), ++it);
+
+  ir::BasicBlock* cloned_header = cloned_loop->GetHeaderBlock();
+  pre_header->ForEachSuccessorLabel(
+      [cloned_header](uint32_t* succ) { *succ = cloned_header->id(); });
+  def_use_mgr->AnalyzeInstUse(&*pre_header->tail());
+  cfg.RemoveEdge(pre_header->id(), header->id());
+  cloned_loop->SetPreHeaderBlock(pre_header);
+  loop_->SetPreHeaderBlock(nullptr);
+
+  // The cloned loop exits to the header of |loop_|.
+  uint32_t cloned_loop_exit = 0;
+  for (uint32_t pred_id : cfg.preds(merge->id())) {
+    if (loop_->IsInsideLoop(pred_id)) continue;
+    ir::BasicBlock* bb = cfg.block(pred_id);
+    assert(cloned_loop_exit == 0 && "The loop has multiple exits.");
+    cloned_loop_exit = bb->id();
+    bb->ForEachSuccessorLabel([merge, header](uint32_t* succ) {
+      if (*succ == merge->id()) *succ = header->id();
+    });
+    def_use_mgr->AnalyzeInstUse(&*bb->tail());
+  }
+  cfg.RemoveNonExistingEdges(merge->id());
+  cfg.AddEdge(cloned_loop_exit, header->id());
+
+  // Both loops start from the same initial values, only the incoming block of
+  // |loop_| changes.
+  header->ForEachPhiInst([cloned_loop_exit, def_use_mgr,
+                          this](ir::Instruction* phi) {
+    for (uint32_t i = 1; i < phi->NumInOperands(); i += 2) {
+      if (!loop_->IsInsideLoop(phi->GetSingleWordInOperand(i))) {
+        phi->SetInOperand(i, {cloned_loop_exit});
+        def_use_mgr->AnalyzeInstUse(phi);
+        return;
+      }
+    }
+  });
+
+  cloned_loop->SetMergeBlock(loop_->GetOrCreatePreHeaderBlock());
+
+  for (ir::Instruction* inst : to_kill) {
+    context_->KillInst(inst);
+  }
+
+  context_->InvalidateAnalysesExceptFor(
+      ir::IRContext::kAnalysisDefUse |
+      ir::IRContext::kAnalysisInstrToBlockMapping);
+}
+
+Pass::Status LoopFissionPass::Process(ir::IRContext* c) {
+  InitializeProcessing(c);
+
+  bool modified = false;
+  ir::Module* module = c->module();
+
+  // Process each function in the module
+  for (ir::Function& f : *module) {
+    // Splitting a loop invalidates the loop descriptor, so start over after
+    // each split. Both resulting loops have fewer stores, so this terminates.
+    while (SplitOneLoop(&f)) {
+      modified = true;
+    }
+  }
+
+  return modified ? Status::SuccessWithChange : Status::SuccessWithoutChange;
+}
+
+bool LoopFissionPass::SplitOneLoop(ir::Function* f) {
+  ir::LoopDescriptor& loop_descriptor = *context()->GetLoopDescriptor(f);
+  const RegisterLiveness* liveness = context()->GetLivenessAnalysis()->Get(f);
+
+  for (ir::Loop& loop : loop_descriptor) {
+    RegisterLiveness::RegionRegisterLiveness pressure;
+    liveness->ComputeLoopRegisterPressure(loop, &pressure);
+    if (pressure.used_registers_ <= register_threshold_) continue;
+
+    LoopFission fission(context(), &loop);
+    if (!fission.CanSplit()) continue;
+
+    // Pick the legal split point giving the lowest peak register pressure.
+    size_t best_split = 0;
+    size_t best_registers = pressure.used_registers_;
+    RegisterLiveness::RegionRegisterLiveness best_first;
+    RegisterLiveness::RegionRegisterLiveness best_second;
+    for (size_t split = 1; split < fission.NumberOfStores(); ++split) {
+      if (!fission.IsLegal(split)) continue;
+      RegisterLiveness::RegionRegisterLiveness first;
+      RegisterLiveness::RegionRegisterLiveness second;
+      fission.SimulateSplit(liveness, split, &first, &second);
+      size_t registers =
+          std::max(first.used_registers_, second.used_registers_);
+      if (registers < best_registers) {
+        best_split = split;
+        best_registers = registers;
+        best_first = first;
+        best_second = second;
+      }
+    }
+
+    const uint32_t header_id = loop.GetHeaderBlock()->id();
+    if (best_split == 0) {
+      Logf(consumer(), SPV_MSG_INFO, name(), {0, 0, 0},
+           "loop %%%u not split: %zu registers needed, no legal split "
+           "reduces it",
+           header_id, pressure.used_registers_);
+      continue;
+    }
+
+    Logf(consumer(), SPV_MSG_INFO, name(), {0, 0, 0},
+         "split loop %%%u: register pressure %zu before, %zu and %zu after",
+         header_id, pressure.used_registers_, best_first.used_registers_,
+         best_second.used_registers_);
+    if (stats_) {
+      stats_->split_loops_.push_back(
+          {header_id, pressure.used_registers_, best_first.used_registers_,
+           best_second.used_registers_});
+    }
+
+    fission.Split(best_split);
+    return true;
+  }
+
+  return false;
+}
+
+}  // namespace opt
+}  // namespace spvtools
@@ -0,0 +1,151 @@
+// Copyright (c) 2018 Google LLC.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SOURCE_OPT_LOOP_FISSION_H_
+#define SOURCE_OPT_LOOP_FISSION_H_
+
+#include <cstdint>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "opt/ir_context.h"
+#include "opt/loop_descriptor.h"
+#include "opt/pass.h"
+#include "opt/register_pressure.h"
+
+namespace spvtools {
+namespace opt {
+
+// Utility class to split a loop into two loops iterating over the same range.
+// The stores of the loop are partitioned in program order: the first loop
+// executes the stores before a given split point and the second loop the
+// others. Each loop only keeps the instructions needed by its stores and by
+// the loop control:
+//
+//   for (int i = 0; i < N; ++i) {
+//     A[i] = B[i];
+//     C[i] = D[i];
+//   }
+//
+// Becomes:
+//
+//   for (int i = 0; i < N; ++i) A[i] = B[i];
+//   for (int i = 0; i < N; ++i) C[i] = D[i];
+class LoopFission {
+ public:
+  LoopFission(ir::IRContext* context, ir::Loop* loop);
+
+  // Returns true if |loop_| can be split:
+  //   - it is an innermost loop with a pre-header and a continue block;
+  //   - its only exit is its merge block, which is only reached from the loop;
+  //   - it can be cloned and stores are its only side effects;
+  //   - it has at least two stores.
+  bool CanSplit();
+
+  // Returns the number of stores of |loop_|. Valid after CanSplit returned
+  // true.
+  size_t NumberOfStores() const { return stores_.size(); }
+
+  // Returns true if executing all the iterations of the stores before the
+  // store |split| (in program order) before all the iterations of the other
+  // stores preserves the semantics of the program.
+  bool IsLegal(size_t split);
+
+  // Estimates the register pressure of the two loops resulting from a split at
+  // |split| using |liveness|, and stores them in |first| and |second|.
+  void SimulateSplit(const RegisterLiveness* liveness, size_t split,
+                     RegisterLiveness::RegionRegisterLiveness* first,
+                     RegisterLiveness::RegionRegisterLiveness* second);
+
+  // Splits |loop_| before the store |split|. The new loop executing the first
+  // stores is inserted before |loop_|. Only the def-use and instruction to
+  // block analyses are preserved.
+  void Split(size_t split);
+
+ private:
+  // Where an instruction of |loop_| is needed for a given split.
+  enum class Placement { kFirst, kSecond, kBoth };
+
+  // Computes |control_|, |stores_| and |store_range_|.
+  void Partition();
+
+  // Returns where the instruction |inst| is needed when the loop is split at
+  // |split|.
+  Placement GetPlacement(ir::Instruction* inst, size_t split) const;
+
+  ir::IRContext* context_;
+  ir::Loop* loop_;
+
+  // The blocks of |loop_| in structured order.
+  std::vector<ir::BasicBlock*> ordered_blocks_;
+  // The position of each instruction of |loop_| in program order.
+  std::unordered_map<const ir::Instruction*, size_t> position_;
+  // The stores of |loop_| in program order.
+  std::vector<ir::Instruction*> stores_;
+  // The instructions needed to iterate |loop_| and to compute the values used
+  // after the loop.
+  std::unordered_set<ir::Instruction*> control_;
+  // The lowest and highest indices in |stores_| of the stores using each
+  // instruction, directly or indirectly.
+  std::unordered_map<ir::Instruction*, std::pair<size_t, size_t>> store_range_;
+};
+
+// Implements a loop fission pass.
+// The pass splits innermost loops whose estimated register pressure exceeds a
+// given threshold, choosing the legal split point which minimizes the register
+// pressure of the resulting loops.
+class LoopFissionPass : public Pass {
+ public:
+  // Holds some statistics about the split loops.
+  struct LoopFissionStats {
+    struct SplitLoop {
+      // Id of the header of the loop before the split.
+      uint32_t header_id_;
+      // Estimated register pressure of the loop before the split and of the
+      // two resulting loops.
+      size_t registers_before_;
+      size_t registers_first_;
+      size_t registers_second_;
+    };
+    std::vector<SplitLoop> split_loops_;
+  };
+
+  // Creates a pass which splits the loops estimated to use more than
+  // |register_threshold| registers.
+  explicit LoopFissionPass(size_t register_threshold,
+                           LoopFissionStats* stats = nullptr)
+      : register_threshold_(register_threshold), stats_(stats) {}
+
+  const char* name() const override { return "loop-fission"; }
+
+  // Processes the given |module|. Returns Status::Failure if errors occur when
+  // processing. Returns the corresponding Status::Success if processing is
+  // succesful to indicate whether changes have been made to the modue.
+  Pass::Status Process(ir::IRContext* c) override;
+
+ private:
+  // Splits the first loop of |f| which needs and benefits from it. Returns true
+  // if a loop was split.
+  bool SplitOneLoop(ir::Function* f);
+
+  size_t register_threshold_;
+  LoopFissionStats* stats_;
+};
+
+}  // namespace opt
+}  // namespace spvtools
+
+#endif  // SOURCE_OPT_LOOP_FISSION_H_
@@ -0,0 +1,434 @@
+// Copyright (c) 2018 Google LLC.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "opt/loop_fusion.h"
+
+#include <memory>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "log.h"
+#include "opt/cfg.h"
+#include "opt/loop_dependence.h"
+#include "opt/loop_utils.h"
+#include "opt/register_pressure.h"
+
+namespace spvtools {
+namespace opt {
+
+namespace {
+
+// Returns true if every user of |inst| inside a function is |user|. Debug and
+// annotation instructions are ignored.
+bool IsOnlyUsedBy(ir::IRContext* context, ir::Instruction* inst,
+                  const ir::Instruction* user) {
+  return context->get_def_use_mgr()->WhileEachUser(
+      inst, [context, user](ir::Instruction* use) {
+        return use == user || context->get_instr_block(use) == nullptr;
+      });
+}
+
+// Returns the successor of the condition block |condition_block| which is not
+// |merge|.
+uint32_t GetBodyEntry(const ir::BasicBlock* condition_block,
+                      const ir::BasicBlock* merge) {
+  const ir::Instruction& branch = *condition_block->ctail();
+  return branch.GetSingleWordInOperand(1) == merge->id()
+             ? branch.GetSingleWordInOperand(2)
+             : branch.GetSingleWordInOperand(1);
+}
+
+// Replaces the branch target |from| by |to| in the terminator and selection
+// merge of |bb|.
+void ReplaceTarget(ir::IRContext* context, ir::BasicBlock* bb, uint32_t from,
+                   uint32_t to) {
+  analysis::DefUseManager* def_use_mgr = context->get_def_use_mgr();
+
+  bool changed = false;
+  bb->ForEachSuccessorLabel([from, to, &changed](uint32_t* succ) {
+    if (*succ == from) {
+      *succ = to;
+      changed = true;
+    }
+  });
+  if (changed) def_use_mgr->AnalyzeInstUse(&*bb->tail());
+
+  ir::Instruction* merge = bb->GetMergeInst();
+  if (merge && merge->opcode() == SpvOpSelectionMerge &&
+      merge->GetSingleWordInOperand(0) == from) {
+    merge->SetInOperand(0, {to});
+    def_use_mgr->AnalyzeInstUse(merge);
+  }
+}
+
+}  // namespace
+
+bool LoopFusion::GetLoopControl(ir::Loop* loop, LoopControl* control,
+                                ir::Instruction** induction,
+                                size_t* iterations, int64_t* init,
+                                int64_t* step) {
+  if (loop->HasNestedLoops()) return false;
+
+  ir::CFG& cfg = *context_->cfg();
+  ir::BasicBlock* header = loop->GetHeaderBlock();
+  ir::BasicBlock* latch = loop->GetLatchBlock();
+  ir::BasicBlock* merge = loop->GetMergeBlock();
+  if (!latch || !merge || !loop->GetPreHeaderBlock()) return false;
+  if (latch == header || latch->ctail()->opcode() != SpvOpBranch) return false;
+
+  ir::BasicBlock* condition_block = loop->FindConditionBlock();
+  if (!condition_block || condition_block == latch) return false;
+
+  // The condition is checked at the beginning of each iteration.
+  if (condition_block != header) {
+    const ir::Instruction& branch = *header->ctail();
+    if (branch.opcode() != SpvOpBranch ||
+        branch.GetSingleWordInOperand(0) != condition_block->id()) {
+      return false;
+    }
+  }
+
+  // The condition block is the only way out of the loop.
+  std::unordered_set<uint32_t> exit_blocks;
+  loop->GetExitBlocks(&exit_blocks);
+  if (exit_blocks.size() != 1 || cfg.preds(merge->id()).size() != 1) {
+    return false;
+  }
+
+  *induction = loop->FindConditionVariable(condition_block);
+  if (!*induction) return false;
+  if (!loop->FindNumberOfIterations(*induction, &*condition_block->ctail(),
+                                    iterations, step, init)) {
+    return false;
+  }
+
+  control->condition_block_ = condition_block;
+  control->condition_ = context_->get_def_use_mgr()->GetDef(
+      condition_block->ctail()->GetSingleWordInOperand(0));
+  control->step_ = loop->GetInductionStepOperation(*induction);
+  if (!control->step_ ||
+      context_->get_instr_block(control->condition_) != condition_block ||
+      context_->get_instr_block(control->step_) != latch) {
+    return false;
+  }
+  if (!IsOnlyUsedBy(context_, control->condition_,
+                    &*condition_block->ctail()) ||
+      !IsOnlyUsedBy(context_, control->step_, *induction)) {
+    return false;
+  }
+
+  // Everything else happens in the body of the loop.
+  for (ir::BasicBlock* bb : {header, condition_block, latch}) {
+    for (ir::Instruction& inst : *bb) {
+      if (bb == header &&
+          (inst.opcode() == SpvOpPhi || inst.opcode() == SpvOpLoopMerge)) {
+        continue;
+      }
+      if (&inst == &*bb->tail() || &inst == control->condition_ ||
+          &inst == control->step_) {
+        continue;
+      }
+      return false;
+    }
+  }
+
+  return true;
+}
+
+bool LoopFusion::AreCompatible() {
+  if (loop_0_ == loop_1_ || loop_0_->GetParent() != loop_1_->GetParent()) {
+    return false;
+  }
+
+  size_t iterations_0 = 0;
+  size_t iterations_1 = 0;
+  int64_t init_0 = 0;
+  int64_t init_1 = 0;
+  int64_t step_0 = 0;
+  int64_t step_1 = 0;
+  if (!GetLoopControl(loop_0_, &control_0_, &induction_0_, &iterations_0,
+                      &init_0, &step_0) ||
+      !GetLoopControl(loop_1_, &control_1_, &induction_1_, &iterations_1,
+                      &init_1, &step_1)) {
+    return false;
+  }
+
+  if (iterations_0 != iterations_1 || init_0 != init_1 || step_0 != step_1 ||
+      induction_0_->type_id() != induction_1_->type_id()) {
+    return false;
+  }
+
+  // |loop_1_| is entered as soon as |loop_0_| exits.
+  ir::BasicBlock* merge_0 = loop_0_->GetMergeBlock();
+  if (loop_1_->GetPreHeaderBlock() != merge_0 ||
+      merge_0->begin() != merge_0->tail()) {
+    return false;
+  }
+
+  // The body of |loop_1_| will be entered from the body of |loop_0_|, so its
+  // first block must not depend on coming from the condition block.
+  uint32_t body_1 = GetBodyEntry(control_1_.condition_block_,
+                                 loop_1_->GetMergeBlock());
+  if (body_1 != loop_1_->GetLatchBlock()->id()) {
+    ir::BasicBlock* body_1_bb = context_->cfg()->block(body_1);
+    if (context_->cfg()->preds(body_1).size() != 1 ||
+        body_1_bb->begin()->opcode() == SpvOpPhi) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+std::vector<ir::Instruction*> LoopFusion::GetMemoryAccesses(
+    const ir::Loop* loop) const {
+  std::vector<ir::Instruction*> accesses;
+  for (uint32_t bb_id : loop->GetBlocks()) {
+    for (ir::Instruction& inst : *context_->cfg()->block(bb_id)) {
+      if (inst.opcode() == SpvOpLoad || inst.opcode() == SpvOpStore) {
+        accesses.push_back(&inst);
+      }
+    }
+  }
+  return accesses;
+}
+
+bool LoopFusion::IsLegal() {
+  assert(induction_0_ && induction_1_ &&
+         "The loops must be checked with AreCompatible first.");
+
+  if (!LoopUtils(context_, loop_0_).HasOnlyStoreSideEffects() ||
+      !LoopUtils(context_, loop_1_).HasOnlyStoreSideEffects()) {
+    return false;
+  }
+
+  // Once fused, the values computed by an iteration of |loop_0_| are no longer
+  // the final ones when the body of |loop_1_| runs.
+  analysis::DefUseManager* def_use_mgr = context_->get_def_use_mgr();
+  for (uint32_t bb_id : loop_1_->GetBlocks()) {
+    for (ir::Instruction& inst : *context_->cfg()->block(bb_id)) {
+      bool uses_loop_0 = !inst.WhileEachInId([def_use_mgr, this](
+                                                 const uint32_t* id) {
+        ir::Instruction* def = def_use_mgr->GetDef(*id);
+        if (!def || def->opcode() == SpvOpLabel) return true;
+        ir::BasicBlock* def_bb = context_->get_instr_block(def);
+        return !def_bb || !loop_0_->IsInsideLoop(def_bb);
+      });
+      if (uses_loop_0) return false;
+    }
+  }
+
+  // The iteration spaces are identical, so the subscripts of both loops can be
+  // compared as if they were in the same loop.
+  LoopDependenceAnalysis analysis(context_, {loop_0_});
+  analysis.GetScalarEvolution()->AddLoopsToPretendAreTheSame(
+      {loop_0_, loop_1_});
+
+  std::vector<ir::Instruction*> accesses_0 = GetMemoryAccesses(loop_0_);
+  std::vector<ir::Instruction*> accesses_1 = GetMemoryAccesses(loop_1_);
+  for (ir::Instruction* access_0 : accesses_0) {
+    for (ir::Instruction* access_1 : accesses_1) {
+      if (access_0->opcode() == SpvOpLoad && access_1->opcode() == SpvOpLoad) {
+        continue;
+      }
+      // The access of |loop_1_| must not happen in an earlier iteration than
+      // the one of |loop_0_|.
+      if (analysis.GetDependenceDirections(access_0, access_1) &
+          DistanceEntry::Directions::LT) {
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+void LoopFusion::RemoveBlock(uint32_t bb_id) {
+  ir::Function* function = loop_0_->GetHeaderBlock()->GetParent();
+  ir::Function::iterator it = function->FindBlock(bb_id);
+  assert(it != function->end() && "Block not found in the function.");
+  it->KillAllInsts(true);
+  it.Erase();
+}
+
+void LoopFusion::Fuse() {
+  assert(induction_0_ && induction_1_ &&
+         "The loops must be checked with AreCompatible first.");
+
+  analysis::DefUseManager* def_use_mgr = context_->get_def_use_mgr();
+  ir::CFG& cfg = *context_->cfg();
+  ir::Function* function = loop_0_->GetHeaderBlock()->GetParent();
+
+  ir::BasicBlock* header_0 = loop_0_->GetHeaderBlock();
+  ir::BasicBlock* latch_0 = loop_0_->GetLatchBlock();
+  ir::BasicBlock* merge_0 = loop_0_->GetMergeBlock();
+  ir::BasicBlock* pre_header_0 = loop_0_->GetPreHeaderBlock();
+  ir::BasicBlock* header_1 = loop_1_->GetHeaderBlock();
+  ir::BasicBlock* latch_1 = loop_1_->GetLatchBlock();
+  ir::BasicBlock* merge_1 = loop_1_->GetMergeBlock();
+  const uint32_t latch_0_id = latch_0->id();
+  const uint32_t latch_1_id = latch_1->id();
+  const uint32_t condition_0_id = control_0_.condition_block_->id();
+  const uint32_t condition_1_id = control_1_.condition_block_->id();
+
+  uint32_t body_1 = GetBodyEntry(control_1_.condition_block_, merge_1);
+  if (body_1 == latch_1_id) body_1 = latch_0_id;
+
+  // Chain the bodies: the body of |loop_0_| continues with the body of
+  // |loop_1_|, which continues with the continue block of |loop_0_|.
+  for (uint32_t bb_id : loop_0_->GetBlocks()) {
+    if (bb_id == latch_0_id) continue;
+    ReplaceTarget(context_, cfg.block(bb_id), latch_0_id, body_1);
+  }
+  for (uint32_t bb_id : loop_1_->GetBlocks()) {
+    ReplaceTarget(context_, cfg.block(bb_id), latch_1_id, latch_0_id);
+  }
+
+  // The fused loop exits to the merge block of |loop_1_|.
+  ReplaceTarget(context_, control_0_.condition_block_, merge_0->id(),
+                merge_1->id());
+  ir::Instruction* loop_merge = header_0->GetLoopMergeInst();
+  loop_merge->SetInOperand(0, {merge_1->id()});
+  def_use_mgr->AnalyzeInstUse(loop_merge);
+
+  // Move the iterating values of |loop_1_|, except its induction variable, to
+  // the header of |loop_0_|.
+  std::vector<ir::Instruction*> phis;
+  header_1->ForEachPhiInst([&phis, this](ir::Instruction* phi) {
+    if (phi != induction_1_) phis.push_back(phi);
+  });
+  for (ir::Instruction* phi : phis) {
+    for (uint32_t i = 1; i < phi->NumInOperands(); i += 2) {
+      uint32_t pred = phi->GetSingleWordInOperand(i);
+      if (pred == merge_0->id()) {
+        phi->SetInOperand(i, {pre_header_0->id()});
+      } else if (pred == latch_1_id) {
+        phi->SetInOperand(i, {latch_0_id});
+      }
+    }
+    phi->RemoveFromList();
+    std::unique_ptr<ir::Instruction> phi_owner(phi);
+    header_0->begin()->InsertBefore(std::move(phi_owner));
+    context_->set_instr_block(phi, header_0);
+    def_use_mgr->AnalyzeInstUse(phi);
+  }
+
+  // The exit values of |loop_1_| now flow from the condition block of
+  // |loop_0_|.
+  merge_1->ForEachPhiInst(
+      [condition_0_id, condition_1_id, def_use_mgr](ir::Instruction* phi) {
+        for (uint32_t i = 1; i < phi->NumInOperands(); i += 2) {
+          if (phi->GetSingleWordInOperand(i) == condition_1_id) {
+            phi->SetInOperand(i, {condition_0_id});
+          }
+        }
+        def_use_mgr->AnalyzeInstUse(phi);
+      });
+
+  context_->ReplaceAllUsesWith(induction_1_->result_id(),
+                               induction_0_->result_id());
+
+  // The continue block of |loop_0_| takes the place of the one of |loop_1_|,
+  // after the body of |loop_1_|.
+  ir::Function::iterator latch_0_it = function->FindBlock(latch_0_id);
+  std::unique_ptr<ir::BasicBlock> latch_0_owner = std::move(*latch_0_it.Get());
+  latch_0_it.Erase();
+
+  ir::Function::iterator latch_1_it = function->FindBlock(latch_1_id);
+  latch_1_it->KillAllInsts(true);
+  latch_1_it = latch_1_it.Erase();
+  function->AddBasicBlock(std::move(latch_0_owner), latch_1_it);
+
+  // Remove the control of |loop_1_| and the block between the loops.
+  RemoveBlock(merge_0->id());
+  RemoveBlock(header_1->id());
+  if (condition_1_id != header_1->id()) RemoveBlock(condition_1_id);
+
+  context_->InvalidateAnalysesExceptFor(
+      ir::IRContext::kAnalysisDefUse |
+      ir::IRContext::kAnalysisInstrToBlockMapping);
+}
+
+Pass::Status LoopFusionPass::Process(ir::IRContext* c) {
+  InitializeProcessing(c);
+
+  bool modified = false;
+  ir::Module* module = c->module();
+
+  // Process each function in the module
+  for (ir::Function& f : *module) {
+    // Fusing two loops invalidates the loop descriptor, so start over after
+    // each fusion. The fused loop may be fused again with the next one.
+    while (FuseOnePair(&f)) {
+      modified = true;
+    }
+  }
+
+  return modified ? Status::SuccessWithChange : Status::SuccessWithoutChange;
+}
+
+bool LoopFusionPass::FuseOnePair(ir::Function* f) {
+  ir::LoopDescriptor& loop_descriptor = *context()->GetLoopDescriptor(f);
+  const RegisterLiveness* liveness = context()->GetLivenessAnalysis()->Get(f);
+
+  for (ir::Loop& loop_0 : loop_descriptor) {
+    ir::BasicBlock* merge = loop_0.GetMergeBlock();
+    if (!merge || merge->tail()->opcode() != SpvOpBranch) continue;
+
+    uint32_t next_header = merge->tail()->GetSingleWordInOperand(0);
+    ir::Loop* loop_1 = loop_descriptor[next_header];
+    if (!loop_1 || loop_1->GetHeaderBlock()->id() != next_header) continue;
+
+    LoopFusion fusion(context(), &loop_0, loop_1);
+    if (!fusion.AreCompatible() || !fusion.IsLegal()) continue;
+
+    RegisterLiveness::RegionRegisterLiveness pressure_0;
+    RegisterLiveness::RegionRegisterLiveness pressure_1;
+    RegisterLiveness::RegionRegisterLiveness pressure_fused;
+    liveness->ComputeLoopRegisterPressure(loop_0, &pressure_0);
+    liveness->ComputeLoopRegisterPressure(*loop_1, &pressure_1);
+    liveness->SimulateFusion(loop_0, *loop_1, &pressure_fused);
+
+    const uint32_t header_0 = loop_0.GetHeaderBlock()->id();
+    const uint32_t header_1 = loop_1->GetHeaderBlock()->id();
+    if (pressure_fused.used_registers_ > max_registers_per_loop_) {
+      Logf(consumer(), SPV_MSG_INFO, name(), {0, 0, 0},
+           "loops %%%u and %%%u not fused: %zu registers needed, at most %zu "
+           "allowed",
+           header_0, header_1, pressure_fused.used_registers_,
+           max_registers_per_loop_);
+      continue;
+    }
+
+    Logf(consumer(), SPV_MSG_INFO, name(), {0, 0, 0},
+         "fused loops %%%u and %%%u: register pressure %zu and %zu before, "
+         "%zu after",
+         header_0, header_1, pressure_0.used_registers_,
+         pressure_1.used_registers_, pressure_fused.used_registers_);
+    if (stats_) {
+      stats_->fused_loops_.push_back(
+          {header_0, header_1, pressure_0.used_registers_,
+           pressure_1.used_registers_, pressure_fused.used_registers_});
+    }
+
+    fusion.Fuse();
+    return true;
+  }
+
+  return false;
+}
+
+}  // namespace opt
+}  // namespace spvtools
@@ -0,0 +1,157 @@
+// Copyright (c) 2018 Google LLC.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SOURCE_OPT_LOOP_FUSION_H_
+#define SOURCE_OPT_LOOP_FUSION_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "opt/ir_context.h"
+#include "opt/loop_descriptor.h"
+#include "opt/pass.h"
+
+namespace spvtools {
+namespace opt {
+
+// Utility class to fuse two adjacent loops iterating over the same range into
+// a single loop. The body of the second loop is executed right after the body
+// of the first one, in the same iteration:
+//
+//   for (int i = 0; i < N; ++i) A[i] = B[i];
+//   for (int i = 0; i < N; ++i) C[i] = A[i];
+//
+// Becomes:
+//
+//   for (int i = 0; i < N; ++i) {
+//     A[i] = B[i];
+//     C[i] = A[i];
+//   }
+//
+// The header, condition and continue blocks of the second loop are removed and
+// its induction variable is replaced by the one of the first loop.
+class LoopFusion {
+ public:
+  LoopFusion(ir::IRContext* context, ir::Loop* loop_0, ir::Loop* loop_1)
+      : context_(context),
+        loop_0_(loop_0),
+        loop_1_(loop_1),
+        induction_0_(nullptr),
+        induction_1_(nullptr) {}
+
+  // Returns true if |loop_0_| and |loop_1_| have the form handled by Fuse:
+  //   - they are innermost loops with the same parent;
+  //   - |loop_1_| immediately follows |loop_0_|: the merge block of |loop_0_|
+  //     is the pre-header of |loop_1_| and only branches to it;
+  //   - their condition block is their only exit, and their header, condition
+  //     and continue blocks hold nothing but the loop control (induction
+  //     variable, exit condition and step);
+  //   - their induction variables have the same initial value, step and trip
+  //     count.
+  bool AreCompatible();
+
+  // Returns true if fusing the compatible loops |loop_0_| and |loop_1_|
+  // preserves the semantics of the program:
+  //   - stores are the only side effects of the loops;
+  //   - |loop_1_| does not use a value computed in |loop_0_|;
+  //   - no memory location accessed by an iteration of |loop_0_| is accessed
+  //     by an earlier iteration of |loop_1_|, unless both accesses are loads.
+  bool IsLegal();
+
+  // Fuses |loop_1_| into |loop_0_|. The loops must be compatible and the
+  // fusion legal. Only the def-use and instruction to block analyses are
+  // preserved.
+  void Fuse();
+
+ private:
+  // The parts of a loop which control its iterations.
+  struct LoopControl {
+    ir::BasicBlock* condition_block_;
+    ir::Instruction* condition_;
+    ir::Instruction* step_;
+  };
+
+  // Returns true if |loop| has the form described in AreCompatible. The loop
+  // control and the induction variable of |loop| are stored in |control| and
+  // |induction|, and the trip count, initial value and step of the induction
+  // are stored in |iterations|, |init| and |step|.
+  bool GetLoopControl(ir::Loop* loop, LoopControl* control,
+                      ir::Instruction** induction, size_t* iterations,
+                      int64_t* init, int64_t* step);
+
+  // Returns the OpLoad and OpStore instructions of |loop|.
+  std::vector<ir::Instruction*> GetMemoryAccesses(const ir::Loop* loop) const;
+
+  // Kills all the instructions of the block |bb_id| and removes it from its
+  // function.
+  void RemoveBlock(uint32_t bb_id);
+
+  ir::IRContext* context_;
+  ir::Loop* loop_0_;
+  ir::Loop* loop_1_;
+
+  // The loop control and induction variables of |loop_0_| and |loop_1_|. Set
+  // by AreCompatible.
+  LoopControl control_0_;
+  LoopControl control_1_;
+  ir::Instruction* induction_0_;
+  ir::Instruction* induction_1_;
+};
+
+// Implements a loop fusion pass.
+// The pass fuses pairs of adjacent loops when the LoopFusion utility deems the
+// fusion legal, and when the estimated register pressure of the fused loop
+// does not exceed a given number of registers.
+class LoopFusionPass : public Pass {
+ public:
+  // Holds some statistics about the fused loops.
+  struct LoopFusionStats {
+    struct FusedLoops {
+      // Ids of the headers of the loops before the fusion.
+      uint32_t header_0_;
+      uint32_t header_1_;
+      // Estimated register pressure of each loop and of the fused loop.
+      size_t registers_0_;
+      size_t registers_1_;
+      size_t registers_fused_;
+    };
+    std::vector<FusedLoops> fused_loops_;
+  };
+
+  // Creates a pass which fuses loops as long as the fused loop is estimated to
+  // use at most |max_registers_per_loop| registers.
+  explicit LoopFusionPass(size_t max_registers_per_loop,
+                          LoopFusionStats* stats = nullptr)
+      : max_registers_per_loop_(max_registers_per_loop), stats_(stats) {}
+
+  const char* name() const override { return "loop-fusion"; }
+
+  // Processes the given |module|. Returns Status::Failure if errors occur when
+  // processing. Returns the corresponding Status::Success if processing is
+  // succesful to indicate whether changes have been made to the modue.
+  Pass::Status Process(ir::IRContext* c) override;
+
+ private:
+  // Fuses the first pair of loops of |f| for which the fusion is legal and
+  // profitable. Returns true if two loops were fused.
+  bool FuseOnePair(ir::Function* f);
+
+  size_t max_registers_per_loop_;
+  LoopFusionStats* stats_;
+};
+
+}  // namespace opt
+}  // namespace spvtools
+
+#endif  // SOURCE_OPT_LOOP_FUSION_H_
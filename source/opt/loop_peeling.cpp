@@ -772,6 +772,11 @@ std::pair<bool, ir::Loop*> LoopPeelingPass::ProcessLoop(
     }
   }
 
+  // The loops may be peeled again, so the results of the scalar evolution
+  // must reflect the new code.
+  scev_analysis->InvalidateLoop(peeler.GetOriginalLoop());
+  scev_analysis->InvalidateLoop(peeler.GetClonedLoop());
+
   return {true, extra_opportunity};
 }
 
@@ -13,9 +13,11 @@
 // limitations under the License.
 
 #include "opt/loop_unroller.h"
+#include <algorithm>
 #include <map>
 #include <memory>
 #include <utility>
+#include "log.h"
 #include "opt/ir_builder.h"
 #include "opt/loop_utils.h"
 
@@ -162,6 +164,7 @@ class LoopUnrollerUtilsImpl {
   LoopUnrollerUtilsImpl(ir::IRContext* c, ir::Function* function)
       : context_(c),
         function_(*function),
+        dom_tree_(nullptr),
         loop_condition_block_(nullptr),
         loop_induction_variable_(nullptr),
         number_of_loop_iterations_(0),
@@ -264,9 +267,19 @@ class LoopUnrollerUtilsImpl {
   void ComputeLoopOrderedBlocks(ir::Loop* loop);
 
   // Adds the blocks_to_add_ to both the |loop| and to the parent of |loop| if
-  // the parent exists.
+  // the parent exists, and makes |loop| their inner most loop.
   void AddBlocksToLoop(ir::Loop* loop) const;
 
+  // Adds the copies of the |loop| body in blocks_to_add_ to the dominator tree.
+  // Each copy is dominated like the original body, except for its header which
+  // is immediately dominated by the latch block of the previous copy. The DF
+  // numbering of the tree is left to the caller.
+  void AddBlocksToDominatorTree(ir::Loop* loop) const;
+
+  // Drops the post-dominator tree of the function, which is not kept up to
+  // date, and makes the dominator tree ready for queries.
+  void FinalizeDominatorTree() const;
+
   // After the partially unroll step the phi instructions in the header block
   // will be in an illegal format. This function makes the phis legal by making
   // the edge from the latch block come from the new latch block and the value
@@ -280,6 +293,9 @@ class LoopUnrollerUtilsImpl {
   // A reference the function the loop is within.
   ir::Function& function_;
 
+  // The dominator tree of the function, updated as the loop is unrolled.
+  DominatorTree* dom_tree_;
+
   // A list of basic blocks to be added to the loop at the end of an unroll
   // step.
   BasicBlockListTy blocks_to_add_;
@@ -332,6 +348,8 @@ static uint32_t GetPhiIndexFromLabel(const ir::BasicBlock* block,
 }
 
 void LoopUnrollerUtilsImpl::Init(ir::Loop* loop) {
+  // Get the tree while it still matches the function.
+  dom_tree_ = &context_->GetDominatorAnalysis(&function_)->GetDomTree();
   loop_condition_block_ = loop->FindConditionBlock();
 
   // When we reinit the second loop during PartiallyUnrollResidualFactor we need
@@ -540,7 +558,8 @@ void LoopUnrollerUtilsImpl::RemoveDeadInstructions() {
 
 void LoopUnrollerUtilsImpl::ReplaceInductionUseWithFinalValue(ir::Loop* loop) {
   context_->InvalidateAnalysesExceptFor(
-      ir::IRContext::Analysis::kAnalysisLoopAnalysis);
+      ir::IRContext::Analysis::kAnalysisLoopAnalysis |
+      ir::IRContext::Analysis::kAnalysisDominatorAnalysis);
   std::vector<ir::Instruction*> inductions;
   loop->GetInductionVariables(inductions);
 
@@ -573,15 +592,23 @@ void LoopUnrollerUtilsImpl::FullyUnroll(ir::Loop* loop) {
     AddBlocksToLoop(loop->GetParent());
   }
 
+  // The merge block is now only reached from the last latch block.
+  AddBlocksToDominatorTree(loop);
+  dom_tree_->SetImmediateDominator(loop->GetMergeBlock(),
+                                   state_.previous_continue_block_);
+  FinalizeDominatorTree();
+
   // Add the blocks to the function.
   AddBlocksToFunction(loop->GetMergeBlock());
 
   ReplaceInductionUseWithFinalValue(loop);
 
   RemoveDeadInstructions();
-  // Invalidate all analyses.
+  // Invalidate all analyses, except for the loop and dominator analyses which
+  // are up to date.
   context_->InvalidateAnalysesExceptFor(
-      ir::IRContext::Analysis::kAnalysisLoopAnalysis);
+      ir::IRContext::Analysis::kAnalysisLoopAnalysis |
+      ir::IRContext::Analysis::kAnalysisDominatorAnalysis);
 }
 
 // Copy a given basic block, give it a new result_id, and store the new block
@@ -859,13 +886,42 @@ void LoopUnrollerUtilsImpl::ComputeLoopOrderedBlocks(ir::Loop* loop) {
 
 // Adds the blocks_to_add_ to both the loop and to the parent.
 void LoopUnrollerUtilsImpl::AddBlocksToLoop(ir::Loop* loop) const {
-  // Add the blocks to this loop.
+  ir::LoopDescriptor* loop_descriptor = context_->GetLoopDescriptor(&function_);
   for (auto& block_itr : blocks_to_add_) {
-    loop->AddBasicBlock(block_itr.get());
+    loop_descriptor->AddBasicBlock(block_itr->id(), loop);
+  }
+}
+
+void LoopUnrollerUtilsImpl::AddBlocksToDominatorTree(ir::Loop* loop) const {
+  const size_t body_size = loop_blocks_inorder_.size();
+  std::unordered_map<uint32_t, size_t> position;
+  for (size_t i = 0; i < body_size; ++i) {
+    position[loop_blocks_inorder_[i]->id()] = i;
+  }
+  const size_t latch_position = position[loop->GetLatchBlock()->id()];
+
+  // The blocks are in dominator order, so each immediate dominator is already
+  // in the tree.
+  for (size_t i = 0; i < blocks_to_add_.size(); ++i) {
+    const size_t copy_start = i - i % body_size;
+    const ir::BasicBlock* original = loop_blocks_inorder_[i % body_size];
+    ir::BasicBlock* idom = nullptr;
+    if (original == loop->GetHeaderBlock()) {
+      idom = copy_start == 0
+                 ? loop->GetLatchBlock()
+                 : blocks_to_add_[copy_start - body_size + latch_position]
+                       .get();
+    } else {
+      uint32_t original_idom = dom_tree_->ImmediateDominator(original)->id();
+      idom = blocks_to_add_[copy_start + position[original_idom]].get();
+    }
+    dom_tree_->AddNode(blocks_to_add_[i].get(), idom);
   }
+}
 
-  // Add the blocks to the parent as well.
-  if (loop->GetParent()) AddBlocksToLoop(loop->GetParent());
+void LoopUnrollerUtilsImpl::FinalizeDominatorTree() const {
+  context_->RemovePostDominatorAnalysis(&function_);
+  dom_tree_->ResetDFNumbering();
 }
 
 void LoopUnrollerUtilsImpl::LinkLastPhisToStart(ir::Loop* loop) const {
@@ -893,6 +949,8 @@ void LoopUnrollerUtilsImpl::PartiallyUnroll(ir::Loop* loop, size_t factor) {
   Unroll(loop, factor);
   LinkLastPhisToStart(loop);
   AddBlocksToLoop(loop);
+  AddBlocksToDominatorTree(loop);
+  FinalizeDominatorTree();
   AddBlocksToFunction(loop->GetMergeBlock());
   RemoveDeadInstructions();
 }
@@ -1029,8 +1087,28 @@ void LoopUtils::Finalize() {
  *
  */
 
+namespace {
+
+// The largest loop, in instructions, the cost model fully unrolls unless it
+// has the Unroll loop control.
+const size_t kMaxFullyUnrolledSize = 256;
+
+// The largest partial unrolling factor the cost model picks.
+const size_t kMaxPartialFactor = 8;
+
+// The largest body, in instructions, the cost model creates by partially
+// unrolling a loop.
+const size_t kMaxPartiallyUnrolledSize = 128;
+
+// The largest register pressure the cost model lets an unrolled loop reach.
+const size_t kMaxRegisters = 64;
+
+}  // namespace
+
 Pass::Status LoopUnroller::Process(ir::IRContext* c) {
   context_ = c;
+  if (use_cost_model_) return ProcessWithCostModel();
+
   bool changed = false;
   for (ir::Function& f : *c->module()) {
     ir::LoopDescriptor* LD = context_->GetLoopDescriptor(&f);
@@ -1053,5 +1131,104 @@ Pass::Status LoopUnroller::Process(ir::IRContext* c) {
   return changed ? Status::SuccessWithChange : Status::SuccessWithoutChange;
 }
 
+Pass::Status LoopUnroller::ProcessWithCostModel() {
+  bool changed = false;
+  for (ir::Function& f : *context_->module()) {
+    ir::LoopDescriptor* LD = context_->GetLoopDescriptor(&f);
+    for (ir::Loop& loop : *LD) {
+      if (loop.HasDontUnrollLoopControl()) continue;
+      LoopUtils loop_utils{context_, &loop};
+      if (!loop_utils.CanPerformUnroll()) continue;
+
+      // CanPerformUnroll checked that the number of iterations is known.
+      const ir::BasicBlock* condition = loop.FindConditionBlock();
+      const ir::Instruction* induction = loop.FindConditionVariable(condition);
+      size_t trip_count = 0;
+      loop.FindNumberOfIterations(induction, &*condition->ctail(),
+                                  &trip_count);
+      if (trip_count == 0) continue;
+
+      size_t body_size = 0;
+      for (const ir::BasicBlock& bb : f) {
+        if (!loop.IsInsideLoop(&bb)) continue;
+        bb.ForEachInst([&body_size](const ir::Instruction*) { ++body_size; });
+      }
+
+      // The liveness is invalidated after each unroll, so that the blocks
+      // added by an unrolled loop are seen by the next loops.
+      RegisterLiveness::RegionRegisterLiveness pressure;
+      context_->GetLivenessAnalysis()->Get(&f)->ComputeLoopRegisterPressure(
+          loop, &pressure);
+
+      const size_t factor =
+          ChooseUnrollFactor(loop, trip_count, body_size, pressure);
+      const bool fully_unroll = factor == trip_count;
+      const uint32_t header = loop.GetHeaderBlock()->id();
+      if (factor == 1) {
+        Logf(consumer(), SPV_MSG_INFO, name(), {0, 0, 0},
+             "loop %%%u not unrolled: %zu iterations of %zu instructions, "
+             "%zu registers",
+             header, trip_count, body_size, pressure.used_registers_);
+      } else {
+        Logf(consumer(), SPV_MSG_INFO, name(), {0, 0, 0},
+             "loop %%%u %s by %zu: %zu iterations of %zu instructions, "
+             "%zu registers",
+             header, fully_unroll ? "fully unrolled" : "unrolled", factor,
+             trip_count, body_size, pressure.used_registers_);
+      }
+      if (stats_) {
+        stats_->loops_.push_back({header, trip_count, body_size,
+                                  pressure.used_registers_, factor,
+                                  fully_unroll});
+      }
+      if (factor == 1) continue;
+
+      size_budget_ -= (factor - 1) * body_size;
+      if (fully_unroll) {
+        loop_utils.FullyUnroll();
+      } else {
+        loop_utils.PartiallyUnroll(factor);
+      }
+      // PartiallyUnroll does not invalidate the liveness itself.
+      context_->InvalidateAnalyses(ir::IRContext::kAnalysisRegisterPressure);
+      changed = true;
+    }
+    LD->PostModificationCleanup();
+  }
+
+  return changed ? Status::SuccessWithChange : Status::SuccessWithoutChange;
+}
+
+size_t LoopUnroller::ChooseUnrollFactor(
+    const ir::Loop& loop, size_t trip_count, size_t body_size,
+    const RegisterLiveness::RegionRegisterLiveness& pressure) const {
+  // The values live into the loop are shared by the copies of the body, but
+  // each extra copy keeps its own values live alongside the others.
+  const size_t used = pressure.used_registers_;
+  const size_t per_copy =
+      used > pressure.live_in_.size() ? used - pressure.live_in_.size() : 0;
+  auto fits = [this, body_size, used, per_copy](size_t factor) {
+    return factor - 1 <= size_budget_ / body_size &&
+           used + (factor - 1) * per_copy <= kMaxRegisters;
+  };
+
+  if ((trip_count <= kMaxFullyUnrolledSize / body_size ||
+       loop.HasUnrollLoopControl()) &&
+      fits(trip_count)) {
+    return trip_count;
+  }
+
+  // Only factors dividing the number of iterations are used, so that no
+  // residual loop is needed.
+  for (size_t factor = std::min(kMaxPartialFactor, trip_count - 1);
+       factor > 1; --factor) {
+    if (trip_count % factor == 0 &&
+        factor <= kMaxPartiallyUnrolledSize / body_size && fits(factor)) {
+      return factor;
+    }
+  }
+  return 1;
+}
+
 }  // namespace opt
 }  // namespace spvtools
@@ -14,25 +14,93 @@
 
 #ifndef SOURCE_OPT_LOOP_UNROLLER_H_
 #define SOURCE_OPT_LOOP_UNROLLER_H_
+#include <vector>
+
 #include "opt/pass.h"
+#include "opt/register_pressure.h"
 
 namespace spvtools {
 namespace opt {
 
 class LoopUnroller : public Pass {
  public:
-  LoopUnroller() : Pass(), fully_unroll_(true), unroll_factor_(0) {}
+  // Holds the decision taken for each loop by the cost model.
+  struct LoopUnrollStats {
+    struct LoopDecision {
+      // Id of the header of the loop.
+      uint32_t header_;
+      // Number of iterations of the loop.  It is never 0: loops that cannot
+      // be unrolled, or whose number of iterations is unknown, are not
+      // recorded.
+      size_t trip_count_;
+      // Number of instructions of the loop.
+      size_t body_size_;
+      // Estimated register pressure of the loop before unrolling.
+      size_t registers_;
+      // Number of copies of the body in the unrolled loop: the trip count if
+      // the loop is fully unrolled, and 1 if it is not unrolled.
+      size_t factor_;
+      bool fully_unrolled_;
+    };
+    std::vector<LoopDecision> loops_;
+  };
+
+  LoopUnroller()
+      : Pass(),
+        fully_unroll_(true),
+        unroll_factor_(0),
+        use_cost_model_(false),
+        size_budget_(0),
+        stats_(nullptr) {}
   LoopUnroller(bool fully_unroll, int unroll_factor)
-      : Pass(), fully_unroll_(fully_unroll), unroll_factor_(unroll_factor) {}
+      : Pass(),
+        fully_unroll_(fully_unroll),
+        unroll_factor_(unroll_factor),
+        use_cost_model_(false),
+        size_budget_(0),
+        stats_(nullptr) {}
+
+  // Creates a pass that chooses to fully unroll, partially unroll or keep
+  // each loop from its trip count, size and register pressure, whatever its
+  // loop control, unless it is DontUnroll.  Unrolling may grow the module by
+  // at most |size_budget| instructions.  If |stats| is not null, it receives
+  // the decision taken for each loop.
+  LoopUnroller(size_t size_budget, LoopUnrollStats* stats)
+      : Pass(),
+        fully_unroll_(false),
+        unroll_factor_(0),
+        use_cost_model_(true),
+        size_budget_(size_budget),
+        stats_(stats) {}
 
   const char* name() const override { return "Loop unroller"; }
 
   Status Process(ir::IRContext* context) override;
 
  private:
+  // Unrolls the loops of the module as chosen by the cost model.
+  Status ProcessWithCostModel();
+
+  // Returns the number of copies of the body of |loop| to make: |trip_count|
+  // to fully unroll it, a divisor of |trip_count| to partially unroll it, or
+  // 1 to keep it.  |body_size| is the number of instructions of |loop| and
+  // |pressure| its register pressure.
+  size_t ChooseUnrollFactor(
+      const ir::Loop& loop, size_t trip_count, size_t body_size,
+      const RegisterLiveness::RegionRegisterLiveness& pressure) const;
+
   ir::IRContext* context_;
   bool fully_unroll_;
   int unroll_factor_;
+
+  // True if the loops to unroll and the factors are chosen by the cost model
+  // rather than by the loop controls and |fully_unroll_|.
+  bool use_cost_model_;
+
+  // The number of instructions unrolling may still add to the module.
+  size_t size_budget_;
+
+  LoopUnrollStats* stats_;
 };
 
 }  // namespace opt
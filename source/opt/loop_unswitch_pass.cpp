@@ -173,22 +173,10 @@ class LoopUnswitch {
       }
       cfg.RemoveNonExistingEdges(if_merge_block->id());
       // Update loop descriptor.
-      if (ir::Loop* ploop = loop_->GetParent()) {
-        ploop->AddBasicBlock(loop_merge_block);
-        loop_desc_.SetBasicBlockToLoop(loop_merge_block->id(), ploop);
-      }
+      loop_desc_.AddBasicBlock(loop_merge_block->id(), loop_->GetParent());
 
       // Update the dominator tree.
-      DominatorTreeNode* loop_merge_dtn =
-          dom_tree->GetOrInsertNode(loop_merge_block);
-      DominatorTreeNode* if_merge_block_dtn =
-          dom_tree->GetOrInsertNode(if_merge_block);
-      loop_merge_dtn->parent_ = if_merge_block_dtn->parent_;
-      loop_merge_dtn->children_.push_back(if_merge_block_dtn);
-      loop_merge_dtn->parent_->children_.push_back(loop_merge_dtn);
-      if_merge_block_dtn->parent_->children_.erase(std::find(
-          if_merge_block_dtn->parent_->children_.begin(),
-          if_merge_block_dtn->parent_->children_.end(), if_merge_block_dtn));
+      dom_tree->InsertBlockBefore(if_merge_block, loop_merge_block);
 
       loop_->SetMergeBlock(loop_merge_block);
     }
@@ -211,10 +199,7 @@ class LoopUnswitch {
     if_block->tail()->SetInOperand(0, {loop_pre_header->id()});
 
     // Update loop descriptor.
-    if (ir::Loop* ploop = loop_desc_[if_block]) {
-      ploop->AddBasicBlock(loop_pre_header);
-      loop_desc_.SetBasicBlockToLoop(loop_pre_header->id(), ploop);
-    }
+    loop_desc_.AddBasicBlock(loop_pre_header->id(), loop_desc_[if_block]);
 
     // Update the CFG.
     cfg.RegisterBlock(loop_pre_header);
@@ -233,20 +218,11 @@ class LoopUnswitch {
     loop_->SetPreHeaderBlock(loop_pre_header);
 
     // Update the dominator tree.
-    DominatorTreeNode* loop_pre_header_dtn =
-        dom_tree->GetOrInsertNode(loop_pre_header);
-    DominatorTreeNode* if_block_dtn = dom_tree->GetTreeNode(if_block);
-    loop_pre_header_dtn->parent_ = if_block_dtn;
     assert(
-        if_block_dtn->children_.size() == 1 &&
+        dom_tree->GetTreeNode(if_block)->children_.size() == 1 &&
         "A loop preheader should only have the header block as a child in the "
         "dominator tree");
-    loop_pre_header_dtn->children_.push_back(if_block_dtn->children_[0]);
-    if_block_dtn->children_.clear();
-    if_block_dtn->children_.push_back(loop_pre_header_dtn);
-
-    // Make domination queries valid.
-    dom_tree->ResetDFNumbering();
+    dom_tree->SplitBlock(if_block, loop_pre_header);
 
     // Compute an ordered list of basic block to clone: loop blocks + pre-header
     // + merge block.
@@ -596,6 +596,34 @@ void LoopUtils::PopulateLoopDesc(
   }
 }
 
+bool LoopUtils::HasOnlyStoreSideEffects() const {
+  ir::CFG& cfg = *context_->cfg();
+  for (uint32_t bb_id : loop_->GetBlocks()) {
+    for (const ir::Instruction& inst : *cfg.block(bb_id)) {
+      switch (inst.opcode()) {
+        case SpvOpStore:
+        case SpvOpBranch:
+        case SpvOpBranchConditional:
+        case SpvOpSwitch:
+        case SpvOpLoopMerge:
+        case SpvOpSelectionMerge:
+        case SpvOpNop:
+        case SpvOpLine:
+        case SpvOpNoLine:
+          break;
+        case SpvOpFunctionCall:
+          return false;
+        default:
+          // Any other instruction without a result (barriers, image writes,
+          // returns, ...) has a side effect.
+          if (!inst.HasResultId() || inst.IsAtomicOp()) return false;
+          break;
+      }
+    }
+  }
+  return true;
+}
+
 // Class to gather some metrics about a region of interest.
 void CodeMetrics::Analyze(const ir::Loop& loop) {
   ir::CFG& cfg = *loop.GetContext()->cfg();
@@ -141,6 +141,11 @@ class LoopUtils {
   // called, otherwise the analysis should be invalidated.
   void Finalize();
 
+  // Returns true if stores are the only instructions of |loop_| with side
+  // effects: the loop contains no function calls, atomics, barriers or image
+  // writes, and does not return from the function.
+  bool HasOnlyStoreSideEffects() const;
+
   // Returns the context associate to |loop_|.
   ir::IRContext* GetContext() { return context_; }
   // Returns the loop descriptor owning |loop_|.
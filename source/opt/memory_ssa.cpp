@@ -0,0 +1,593 @@
+// Copyright (c) 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "memory_ssa.h"
+
+#include <algorithm>
+
+#include "cfg.h"
+#include "ir_context.h"
+
+namespace spvtools {
+namespace opt {
+
+constexpr uint32_t MemorySSA::kAllClasses;
+
+namespace {
+const uint32_t kLoadPtrInIdx = 0;
+const uint32_t kLoadMemoryAccessInIdx = 1;
+const uint32_t kStorePtrInIdx = 0;
+const uint32_t kStoreMemoryAccessInIdx = 2;
+const uint32_t kAccessChainPtrInIdx = 0;
+const uint32_t kCopyObjectOperandInIdx = 0;
+const uint32_t kPointerTypeStorageClassInIdx = 0;
+const uint32_t kPointerTypePointeeInIdx = 1;
+const uint32_t kMemberDecorateMemberInIdx = 1;
+const uint32_t kMemberDecorateDecorationInIdx = 2;
+const uint32_t kVariableStorageClassInIdx = 0;
+const uint32_t kArrayElementTypeInIdx = 0;
+
+// Returns true if |storage_class| holds buffers other invocations may write.
+bool IsBuffer(SpvStorageClass storage_class) {
+  return storage_class == SpvStorageClassUniform ||
+         storage_class == SpvStorageClassStorageBuffer;
+}
+}  // namespace
+
+bool IsReadOnlyVariable(ir::IRContext* context, const ir::Instruction* var) {
+  opt::analysis::DecorationManager* decoration_mgr =
+      context->get_decoration_mgr();
+  auto has_decoration = [decoration_mgr](uint32_t id,
+                                         SpvDecoration decoration) {
+    return !decoration_mgr->WhileEachDecoration(
+        id, decoration, [](const ir::Instruction&) { return false; });
+  };
+
+  switch (var->GetSingleWordInOperand(kVariableStorageClassInIdx)) {
+    case SpvStorageClassUniformConstant:
+    case SpvStorageClassInput:
+    case SpvStorageClassPushConstant:
+      return true;
+    case SpvStorageClassUniform:
+    case SpvStorageClassStorageBuffer: {
+      // Other invocations may write a coherent or volatile buffer while this
+      // one runs, even if it cannot.
+      if (has_decoration(var->result_id(), SpvDecorationCoherent) ||
+          has_decoration(var->result_id(), SpvDecorationVolatile)) {
+        return false;
+      }
+      opt::analysis::DefUseManager* def_use_mgr = context->get_def_use_mgr();
+      ir::Instruction* type = def_use_mgr->GetDef(
+          def_use_mgr->GetDef(var->type_id())
+              ->GetSingleWordInOperand(kPointerTypePointeeInIdx));
+      while (type->opcode() == SpvOpTypeArray ||
+             type->opcode() == SpvOpTypeRuntimeArray) {
+        type = def_use_mgr->GetDef(
+            type->GetSingleWordInOperand(kArrayElementTypeInIdx));
+      }
+      std::unordered_set<uint32_t> non_writable_members;
+      for (const ir::Instruction* decoration :
+           decoration_mgr->GetDecorationsFor(type->result_id(), false)) {
+        if (decoration->opcode() != SpvOpMemberDecorate) continue;
+        switch (decoration->GetSingleWordInOperand(
+            kMemberDecorateDecorationInIdx)) {
+          case SpvDecorationCoherent:
+          case SpvDecorationVolatile:
+            return false;
+          case SpvDecorationNonWritable:
+            non_writable_members.insert(
+                decoration->GetSingleWordInOperand(kMemberDecorateMemberInIdx));
+            break;
+          default:
+            break;
+        }
+      }
+      if (has_decoration(var->result_id(), SpvDecorationNonWritable)) {
+        return true;
+      }
+      // Uniform blocks are read-only, unlike buffer blocks.
+      if (var->GetSingleWordInOperand(kVariableStorageClassInIdx) ==
+              SpvStorageClassUniform &&
+          has_decoration(type->result_id(), SpvDecorationBlock)) {
+        return true;
+      }
+      // A buffer declared readonly has all its members NonWritable.
+      return type->opcode() == SpvOpTypeStruct &&
+             non_writable_members.size() == type->NumInOperands();
+    }
+    default:
+      return has_decoration(var->result_id(), SpvDecorationNonWritable);
+  }
+}
+
+MemorySSA::MemorySSA(ir::IRContext* context, ir::Function* f)
+    : context_(context), function_(f) {
+  if (function_->begin() == function_->end()) return;
+
+  ir::CFG* cfg = context_->cfg();
+  std::vector<ir::BasicBlock*> order;
+  cfg->ForEachBlockInReversePostOrder(
+      &*function_->begin(),
+      [&order](ir::BasicBlock* bb) { order.push_back(bb); });
+  for (ir::BasicBlock* bb : order) preds_[bb->id()];
+  for (ir::BasicBlock* bb : order) {
+    std::vector<uint32_t>& preds = preds_[bb->id()];
+    for (uint32_t pred_id : cfg->preds(bb->id())) {
+      if (preds_.count(pred_id) &&
+          std::find(preds.begin(), preds.end(), pred_id) == preds.end()) {
+        preds.push_back(pred_id);
+      }
+    }
+  }
+
+  // All the classes must be known before the defs that write every class of
+  // a storage class are renamed.
+  for (ir::BasicBlock* bb : order) {
+    for (ir::Instruction& inst : *bb) CreateAccess(&inst, bb);
+  }
+
+  // Blocks are renamed in reverse post-order, so the only predecessors of a
+  // block that are not processed before it are the sources of back-edges.
+  sealed_blocks_.insert(function_->begin()->id());
+  for (ir::BasicBlock* bb : order) {
+    RenameBlock(bb);
+    processed_blocks_.insert(bb->id());
+    bb->ForEachSuccessorLabel([this](const uint32_t succ_id) {
+      if (sealed_blocks_.count(succ_id) || !preds_.count(succ_id)) return;
+      for (uint32_t pred_id : preds_.at(succ_id)) {
+        if (!processed_blocks_.count(pred_id)) return;
+      }
+      SealBlock(succ_id);
+    });
+  }
+  RemoveTrivialPhis();
+
+  current_access_.clear();
+  processed_blocks_.clear();
+  sealed_blocks_.clear();
+  incomplete_phis_.clear();
+}
+
+const std::vector<MemoryAccess*>& MemorySSA::GetPhis(
+    const ir::BasicBlock* block) const {
+  static const std::vector<MemoryAccess*> no_phis;
+  auto it = phis_.find(block);
+  return it == phis_.end() ? no_phis : it->second;
+}
+
+const MemoryLocation& MemorySSA::GetLocation(uint32_t pointer_id) {
+  auto it = locations_.find(pointer_id);
+  if (it != locations_.end()) return it->second;
+
+  ir::Instruction* pointer = context_->get_def_use_mgr()->GetDef(pointer_id);
+  MemoryLocation location;
+  switch (pointer->opcode()) {
+    case SpvOpVariable:
+      location.root = pointer_id;
+      break;
+    case SpvOpAccessChain:
+    case SpvOpInBoundsAccessChain:
+      location =
+          GetLocation(pointer->GetSingleWordInOperand(kAccessChainPtrInIdx));
+      if (location.root != 0) {
+        for (uint32_t i = kAccessChainPtrInIdx + 1;
+             i < pointer->NumInOperands(); ++i) {
+          location.indices.push_back(pointer->GetSingleWordInOperand(i));
+        }
+      }
+      break;
+    case SpvOpCopyObject:
+      location =
+          GetLocation(pointer->GetSingleWordInOperand(kCopyObjectOperandInIdx));
+      break;
+    default:
+      break;
+  }
+  location.storage_class = GetStorageClass(pointer_id);
+  return locations_[pointer_id] = location;
+}
+
+const MemoryLocation& MemorySSA::GetLocation(const ir::Instruction* inst) {
+  assert((inst->opcode() == SpvOpLoad || inst->opcode() == SpvOpStore) &&
+         "Expecting a load or a store.");
+  static_assert(kLoadPtrInIdx == kStorePtrInIdx, "Different pointer operands");
+  return GetLocation(inst->GetSingleWordInOperand(kLoadPtrInIdx));
+}
+
+std::vector<uint32_t> MemorySSA::GetWrittenClasses(
+    const MemoryAccess* access) const {
+  assert(access->IsDef() && "Only defs write memory.");
+  std::vector<uint32_t> written;
+  const bool all = access->alias_class() == kAllClasses;
+  const AliasClass* target = all ? nullptr : &classes_[access->alias_class()];
+  if (target && target->root != 0) {
+    if (IsReadOnly(target->root)) return written;
+    written.push_back(access->alias_class());
+    if (!IsLocalToFunction(target->root)) {
+      written.push_back(unknown_classes_.at(target->storage_class));
+    }
+    return written;
+  }
+
+  for (uint32_t i = 0; i < classes_.size(); ++i) {
+    const AliasClass& alias_class = classes_[i];
+    if (target && alias_class.storage_class != target->storage_class) continue;
+    if (alias_class.root != 0 && IsLocalToFunction(alias_class.root)) continue;
+    // The writes of other invocations to a buffer may become visible at a
+    // barrier or a call, even if this invocation cannot write it.
+    if (alias_class.root != 0 && IsReadOnly(alias_class.root) &&
+        !(all && IsBuffer(alias_class.storage_class))) {
+      continue;
+    }
+    written.push_back(i);
+  }
+  return written;
+}
+
+bool MemorySSA::MayAlias(const MemoryLocation& a,
+                         const MemoryLocation& b) const {
+  if (a.storage_class != b.storage_class &&
+      a.storage_class != SpvStorageClassGeneric &&
+      b.storage_class != SpvStorageClassGeneric) {
+    return false;
+  }
+  if (a.root == 0 || b.root == 0) {
+    const uint32_t known_root = a.root != 0 ? a.root : b.root;
+    return known_root == 0 || !IsLocalToFunction(known_root);
+  }
+  if (a.root != b.root) return false;
+
+  const size_t common = std::min(a.indices.size(), b.indices.size());
+  for (size_t i = 0; i < common; ++i) {
+    if (DifferentIndex(a.indices[i], b.indices[i])) return false;
+  }
+  return true;
+}
+
+bool MemorySSA::Covers(const MemoryLocation& a,
+                       const MemoryLocation& b) const {
+  if (a.root == 0 || a.root != b.root) return false;
+  if (a.indices.size() > b.indices.size()) return false;
+  for (size_t i = 0; i < a.indices.size(); ++i) {
+    if (!SameIndex(a.indices[i], b.indices[i])) return false;
+  }
+  return true;
+}
+
+bool MemorySSA::IsVolatile(const ir::Instruction* inst) const {
+  const uint32_t mask_index = inst->opcode() == SpvOpLoad
+                                  ? kLoadMemoryAccessInIdx
+                                  : kStoreMemoryAccessInIdx;
+  return inst->NumInOperands() > mask_index &&
+         (inst->GetSingleWordInOperand(mask_index) &
+          SpvMemoryAccessVolatileMask) != 0;
+}
+
+void MemorySSA::AnalyzeVariable(uint32_t var_id,
+                                SpvStorageClass storage_class) {
+  if (storage_class == SpvStorageClassFunction) {
+    if (HasOnlyDirectUses(var_id)) local_variables_.insert(var_id);
+    return;
+  }
+  if (IsReadOnlyVariable(context_,
+                         context_->get_def_use_mgr()->GetDef(var_id))) {
+    read_only_variables_.insert(var_id);
+  }
+}
+
+bool MemorySSA::HasOnlyDirectUses(uint32_t pointer_id) const {
+  return context_->get_def_use_mgr()->WhileEachUser(
+      pointer_id, [this, pointer_id](ir::Instruction* user) {
+        switch (user->opcode()) {
+          case SpvOpLoad:
+            return true;
+          case SpvOpStore:
+            // Storing the pointer itself lets it escape.
+            return user->GetSingleWordInOperand(kStorePtrInIdx) == pointer_id &&
+                   user->GetSingleWordInOperand(kStorePtrInIdx + 1) !=
+                       pointer_id;
+          case SpvOpAccessChain:
+          case SpvOpInBoundsAccessChain:
+            return user->GetSingleWordInOperand(kAccessChainPtrInIdx) ==
+                       pointer_id &&
+                   HasOnlyDirectUses(user->result_id());
+          case SpvOpName:
+            return true;
+          default:
+            return user->IsDecoration();
+        }
+      });
+}
+
+SpvStorageClass MemorySSA::GetStorageClass(uint32_t pointer_id) const {
+  opt::analysis::DefUseManager* def_use_mgr = context_->get_def_use_mgr();
+  ir::Instruction* pointer = def_use_mgr->GetDef(pointer_id);
+  if (pointer->opcode() == SpvOpVariable) {
+    return static_cast<SpvStorageClass>(
+        pointer->GetSingleWordInOperand(kVariableStorageClassInIdx));
+  }
+  return static_cast<SpvStorageClass>(
+      def_use_mgr->GetDef(pointer->type_id())
+          ->GetSingleWordInOperand(kPointerTypeStorageClassInIdx));
+}
+
+uint32_t MemorySSA::GetClass(const MemoryLocation& location) {
+  if (location.root == 0) return GetUnknownClass(location.storage_class);
+
+  auto it = variable_classes_.find(location.root);
+  if (it != variable_classes_.end()) return it->second;
+
+  AnalyzeVariable(location.root, location.storage_class);
+  const uint32_t alias_class = static_cast<uint32_t>(classes_.size());
+  classes_.push_back({location.storage_class, location.root});
+  variable_classes_[location.root] = alias_class;
+
+  // Stores to the variable also write the unknown class.
+  if (!IsLocalToFunction(location.root)) {
+    GetUnknownClass(location.storage_class);
+  }
+  return alias_class;
+}
+
+uint32_t MemorySSA::GetUnknownClass(SpvStorageClass storage_class) {
+  auto it = unknown_classes_.find(storage_class);
+  if (it != unknown_classes_.end()) return it->second;
+
+  const uint32_t alias_class = static_cast<uint32_t>(classes_.size());
+  classes_.push_back({storage_class, 0});
+  unknown_classes_[storage_class] = alias_class;
+  return alias_class;
+}
+
+void MemorySSA::CreateAccess(ir::Instruction* inst, ir::BasicBlock* block) {
+  switch (inst->opcode()) {
+    case SpvOpLoad: {
+      const uint32_t alias_class = GetClass(GetLocation(inst));
+      NewAccess(IsVolatile(inst) ? MemoryAccess::Kind::kDef
+                                 : MemoryAccess::Kind::kUse,
+                alias_class, inst, block);
+      return;
+    }
+    case SpvOpStore:
+    case SpvOpCopyMemory:
+    case SpvOpCopyMemorySized:
+      // The target is the first operand of each of them.
+      NewAccess(MemoryAccess::Kind::kDef,
+                GetClass(GetLocation(inst->GetSingleWordInOperand(0))), inst,
+                block);
+      return;
+    case SpvOpVariable:
+      // A variable with an initializer is written on entry to the function.
+      if (inst->NumInOperands() > 1) {
+        NewAccess(MemoryAccess::Kind::kDef,
+                  GetClass(GetLocation(inst->result_id())), inst, block);
+      }
+      return;
+    case SpvOpFunctionCall:
+    case SpvOpControlBarrier:
+    case SpvOpMemoryBarrier:
+    case SpvOpEmitVertex:
+    case SpvOpEndPrimitive:
+    case SpvOpEmitStreamVertex:
+    case SpvOpEndStreamPrimitive:
+      NewAccess(MemoryAccess::Kind::kDef, kAllClasses, inst, block);
+      return;
+    case SpvOpAccessChain:
+    case SpvOpInBoundsAccessChain:
+    case SpvOpPtrAccessChain:
+    case SpvOpInBoundsPtrAccessChain:
+    case SpvOpCopyObject:
+    case SpvOpPhi:
+    case SpvOpSelect:
+    case SpvOpArrayLength:
+    case SpvOpImageTexelPointer:
+      // These compute pointers without accessing memory.
+      return;
+    default:
+      break;
+  }
+
+  // Any other instruction with pointer operands is assumed to read and write
+  // the memory they point to.
+  opt::analysis::DefUseManager* def_use_mgr = context_->get_def_use_mgr();
+  bool has_pointer = false;
+  uint32_t alias_class = 0;
+  inst->ForEachInId([&](const uint32_t* id) {
+    ir::Instruction* operand = def_use_mgr->GetDef(*id);
+    if (operand == nullptr || operand->type_id() == 0) return;
+    ir::Instruction* type = def_use_mgr->GetDef(operand->type_id());
+    if (type == nullptr || type->opcode() != SpvOpTypePointer) return;
+
+    const uint32_t operand_class = GetClass(GetLocation(*id));
+    if (has_pointer && operand_class != alias_class) {
+      alias_class = kAllClasses;
+    } else if (!has_pointer) {
+      alias_class = operand_class;
+    }
+    has_pointer = true;
+  });
+  if (!has_pointer) return;
+
+  const bool reads_only = alias_class != kAllClasses &&
+                          classes_[alias_class].root != 0 &&
+                          IsReadOnly(classes_[alias_class].root);
+  NewAccess(reads_only ? MemoryAccess::Kind::kUse : MemoryAccess::Kind::kDef,
+            alias_class, inst, block);
+}
+
+MemoryAccess* MemorySSA::NewAccess(MemoryAccess::Kind kind,
+                                   uint32_t alias_class, ir::Instruction* inst,
+                                   ir::BasicBlock* block) {
+  accesses_.emplace_back(new MemoryAccess(kind, alias_class, inst, block));
+  MemoryAccess* access = accesses_.back().get();
+  if (inst != nullptr) inst_to_access_[inst] = access;
+  if (kind == MemoryAccess::Kind::kPhi) phis_[block].push_back(access);
+  return access;
+}
+
+void MemorySSA::RenameBlock(ir::BasicBlock* block) {
+  const uint32_t block_id = block->id();
+  for (ir::Instruction& inst : *block) {
+    MemoryAccess* access = GetAccess(&inst);
+    if (access == nullptr) continue;
+    if (access->alias_class_ != kAllClasses) {
+      access->defining_access_ = ReadClass(access->alias_class_, block_id);
+    }
+    if (access->IsDef()) {
+      for (uint32_t alias_class : GetWrittenClasses(access)) {
+        WriteClass(alias_class, block_id, access);
+      }
+    }
+  }
+}
+
+MemoryAccess* MemorySSA::ReadClass(uint32_t alias_class, uint32_t block_id) {
+  auto& block_accesses = current_access_[block_id];
+  auto it = block_accesses.find(alias_class);
+  if (it != block_accesses.end()) return it->second;
+  return ReadClassRecursive(alias_class, block_id);
+}
+
+MemoryAccess* MemorySSA::GetLiveOnEntry(uint32_t alias_class) {
+  MemoryAccess*& access = live_on_entry_[alias_class];
+  if (access == nullptr) {
+    access = NewAccess(MemoryAccess::Kind::kLiveOnEntry, alias_class, nullptr,
+                       nullptr);
+  }
+  return access;
+}
+
+MemoryAccess* MemorySSA::ReadClassRecursive(uint32_t alias_class,
+                                            uint32_t block_id) {
+  const std::vector<uint32_t>& preds = preds_.at(block_id);
+  MemoryAccess* access = nullptr;
+  if (!sealed_blocks_.count(block_id)) {
+    // Not all the predecessors are known yet.  The phi is completed once they
+    // are.
+    access = NewAccess(MemoryAccess::Kind::kPhi, alias_class, nullptr,
+                       context_->cfg()->block(block_id));
+    incomplete_phis_[block_id].push_back(access);
+  } else if (preds.empty()) {
+    access = GetLiveOnEntry(alias_class);
+  } else if (preds.size() == 1) {
+    access = ReadClass(alias_class, preds[0]);
+  } else {
+    // The phi is recorded first to break cycles through loops.
+    access = NewAccess(MemoryAccess::Kind::kPhi, alias_class, nullptr,
+                       context_->cfg()->block(block_id));
+    WriteClass(alias_class, block_id, access);
+    AddPhiOperands(access);
+  }
+  WriteClass(alias_class, block_id, access);
+  return access;
+}
+
+void MemorySSA::AddPhiOperands(MemoryAccess* phi) {
+  for (uint32_t pred_id : preds_.at(phi->block_->id())) {
+    phi->incoming_.emplace_back(pred_id, ReadClass(phi->alias_class_, pred_id));
+  }
+}
+
+void MemorySSA::SealBlock(uint32_t block_id) {
+  for (MemoryAccess* phi : incomplete_phis_[block_id]) AddPhiOperands(phi);
+  incomplete_phis_.erase(block_id);
+  sealed_blocks_.insert(block_id);
+}
+
+void MemorySSA::RemoveTrivialPhis() {
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (auto& block_phis : phis_) {
+      for (MemoryAccess* phi : block_phis.second) {
+        if (replacements_.count(phi)) continue;
+        MemoryAccess* same = nullptr;
+        bool trivial = true;
+        for (auto& incoming : phi->incoming_) {
+          MemoryAccess* value = Resolve(incoming.second);
+          if (value == phi || value == same) continue;
+          if (same != nullptr) {
+            trivial = false;
+            break;
+          }
+          same = value;
+        }
+        if (trivial && same != nullptr) {
+          replacements_[phi] = same;
+          changed = true;
+        }
+      }
+    }
+  }
+
+  for (auto& block_phis : phis_) {
+    auto& phis = block_phis.second;
+    phis.erase(std::remove_if(phis.begin(), phis.end(),
+                              [this](MemoryAccess* phi) {
+                                return replacements_.count(phi) != 0;
+                              }),
+               phis.end());
+  }
+
+  for (auto& access : accesses_) {
+    if (replacements_.count(access.get())) continue;
+    if (access->defining_access_ != nullptr) {
+      access->defining_access_ = Resolve(access->defining_access_);
+      access->defining_access_->users_.push_back(access.get());
+    }
+    for (auto& incoming : access->incoming_) {
+      incoming.second = Resolve(incoming.second);
+      auto& users = incoming.second->users_;
+      if (std::find(users.begin(), users.end(), access.get()) == users.end()) {
+        users.push_back(access.get());
+      }
+    }
+  }
+  replacements_.clear();
+}
+
+MemoryAccess* MemorySSA::Resolve(MemoryAccess* access) {
+  auto it = replacements_.find(access);
+  while (it != replacements_.end()) {
+    access = it->second;
+    it = replacements_.find(access);
+  }
+  return access;
+}
+
+bool MemorySSA::SameIndex(uint32_t a, uint32_t b) const {
+  if (a == b) return true;
+  opt::analysis::DefUseManager* def_use_mgr = context_->get_def_use_mgr();
+  const ir::Instruction* a_inst = def_use_mgr->GetDef(a);
+  const ir::Instruction* b_inst = def_use_mgr->GetDef(b);
+  return a_inst->opcode() == SpvOpConstant &&
+         b_inst->opcode() == SpvOpConstant &&
+         a_inst->GetInOperand(0).words == b_inst->GetInOperand(0).words;
+}
+
+bool MemorySSA::DifferentIndex(uint32_t a, uint32_t b) const {
+  if (a == b) return false;
+  opt::analysis::DefUseManager* def_use_mgr = context_->get_def_use_mgr();
+  const ir::Instruction* a_inst = def_use_mgr->GetDef(a);
+  const ir::Instruction* b_inst = def_use_mgr->GetDef(b);
+  if (a_inst->opcode() != SpvOpConstant || b_inst->opcode() != SpvOpConstant) {
+    return false;
+  }
+  const auto& a_words = a_inst->GetInOperand(0).words;
+  const auto& b_words = b_inst->GetInOperand(0).words;
+  return a_words.size() == b_words.size() && a_words != b_words;
+}
+
+}  // namespace opt
+}  // namespace spvtools
@@ -0,0 +1,324 @@
+// Copyright (c) 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef LIBSPIRV_OPT_MEMORY_SSA_H_
+#define LIBSPIRV_OPT_MEMORY_SSA_H_
+
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "function.h"
+
+namespace spvtools {
+namespace ir {
+class IRContext;
+}  // namespace ir
+
+namespace opt {
+
+// The memory a pointer points to, as far as access chains tell.
+struct MemoryLocation {
+  // The storage class of the pointer.
+  SpvStorageClass storage_class = SpvStorageClassMax;
+
+  // The result id of the variable the pointer points into, or 0 if it is not
+  // known.
+  uint32_t root = 0;
+
+  // The ids of the indices of the access chains from |root| to the pointer.
+  // Empty if |root| is 0.
+  std::vector<uint32_t> indices;
+};
+
+// Returns true if the memory of the variable |var| is never written while the
+// invocation runs: it is in the uniform constant, input or push constant
+// storage class, it is a uniform block, or it or all the members of its block
+// are decorated NonWritable.  A buffer decorated Coherent or Volatile, or with
+// such a member, is not read-only.
+bool IsReadOnlyVariable(ir::IRContext* context, const ir::Instruction* var);
+
+// A node of the memory SSA form of a function.
+//
+// Memory is split into alias classes.  Each variable the function accesses
+// gets its own class, and each storage class gets one more class for the
+// pointers whose variable is not known.  Every class is in SSA form on its
+// own: a def is an instruction that may write to the class, a use is an
+// instruction that only reads from it, and a phi merges the defs of a class
+// reaching a block from its predecessors.  The defs and uses of a class are
+// linked to the def or phi they follow, their defining access.
+class MemoryAccess {
+ public:
+  enum class Kind {
+    kLiveOnEntry,  // The value of a class when the function is entered.
+    kDef,
+    kUse,
+    kPhi
+  };
+
+  MemoryAccess(Kind kind, uint32_t alias_class, ir::Instruction* inst,
+               ir::BasicBlock* block)
+      : kind_(kind),
+        alias_class_(alias_class),
+        inst_(inst),
+        block_(block),
+        defining_access_(nullptr) {}
+
+  Kind kind() const { return kind_; }
+  bool IsDef() const { return kind_ == Kind::kDef; }
+  bool IsUse() const { return kind_ == Kind::kUse; }
+  bool IsPhi() const { return kind_ == Kind::kPhi; }
+  bool IsLiveOnEntry() const { return kind_ == Kind::kLiveOnEntry; }
+
+  // The alias class this access reads or writes, or MemorySSA::kAllClasses
+  // for a def that may write any class.  A def may write other classes as
+  // well; see MemorySSA::GetWrittenClasses().
+  uint32_t alias_class() const { return alias_class_; }
+
+  // The instruction of a def or use, null otherwise.
+  ir::Instruction* instruction() const { return inst_; }
+
+  // The block of a def, use or phi, null otherwise.
+  ir::BasicBlock* block() const { return block_; }
+
+  // The def, phi or live-on-entry access this def or use follows in its alias
+  // class.  Null for phis and live-on-entry accesses.
+  MemoryAccess* defining_access() const { return defining_access_; }
+
+  // The access reaching a phi from each of the predecessors of its block, as
+  // pairs of predecessor id and access.
+  const std::vector<std::pair<uint32_t, MemoryAccess*>>& incoming() const {
+    return incoming_;
+  }
+
+  // The accesses that have this access as defining access or incoming access.
+  const std::vector<MemoryAccess*>& users() const { return users_; }
+
+ private:
+  friend class MemorySSA;
+
+  Kind kind_;
+  uint32_t alias_class_;
+  ir::Instruction* inst_;
+  ir::BasicBlock* block_;
+  MemoryAccess* defining_access_;
+  std::vector<std::pair<uint32_t, MemoryAccess*>> incoming_;
+  std::vector<MemoryAccess*> users_;
+};
+
+// The memory SSA form of a function.
+//
+// Loads are uses.  Stores, atomics, OpCopyMemory, volatile loads, function
+// calls, barriers and any other instruction taking a pointer operand are
+// defs.  A store writes its own class and, if the variable may be reached
+// through another pointer, the unknown class of its storage class.  A def
+// through an unknown pointer writes every class of its storage class.  Calls,
+// barriers, and instructions whose effect is not modeled write every class
+// which is not private to the function.  Variables of read-only storage are
+// never written, except for read-only buffers: another invocation may write
+// them through a different variable, so calls and barriers write them.
+class MemorySSA {
+ public:
+  // The alias class of the defs that may write every class.
+  static constexpr uint32_t kAllClasses = UINT32_MAX;
+
+  MemorySSA(ir::IRContext* context, ir::Function* f);
+
+  MemorySSA(const MemorySSA&) = delete;
+  MemorySSA& operator=(const MemorySSA&) = delete;
+
+  // Returns the def or use of |inst|, or null if |inst| does not access
+  // memory.
+  MemoryAccess* GetAccess(const ir::Instruction* inst) const {
+    auto it = inst_to_access_.find(inst);
+    return it == inst_to_access_.end() ? nullptr : it->second;
+  }
+
+  // Returns the phis at the start of |block|.
+  const std::vector<MemoryAccess*>& GetPhis(const ir::BasicBlock* block) const;
+
+  // Returns the location |pointer_id| points to.
+  const MemoryLocation& GetLocation(uint32_t pointer_id);
+
+  // Returns the location read by the load |inst|, or written by the store
+  // |inst|.
+  const MemoryLocation& GetLocation(const ir::Instruction* inst);
+
+  // Returns the classes the def |access| may write.
+  std::vector<uint32_t> GetWrittenClasses(const MemoryAccess* access) const;
+
+  // Returns true if the pointers to |a| and |b| may point to overlapping
+  // memory.
+  bool MayAlias(const MemoryLocation& a, const MemoryLocation& b) const;
+
+  // Returns true if all of the memory |b| refers to is part of the memory
+  // |a| refers to.
+  bool Covers(const MemoryLocation& a, const MemoryLocation& b) const;
+
+  // Returns true if the variable |var_id| is in the function storage class
+  // and all of its uses are loads, stores, and access chains that are only
+  // used by loads, stores and access chains.  Such a variable can only be
+  // accessed through pointers of the function, and only by this function.
+  bool IsLocalToFunction(uint32_t var_id) const {
+    return local_variables_.count(var_id) != 0;
+  }
+
+  // Returns true if the variable |var_id| is never written.
+  bool IsReadOnly(uint32_t var_id) const {
+    return read_only_variables_.count(var_id) != 0;
+  }
+
+  // Returns true if the load or store |inst| is volatile.
+  bool IsVolatile(const ir::Instruction* inst) const;
+
+ private:
+  // Information about one alias class.
+  struct AliasClass {
+    SpvStorageClass storage_class;
+    uint32_t root;  // The variable of the class, or 0 for the unknown class.
+  };
+
+  // Records whether the variable |var_id| of |storage_class| is local to the
+  // function or read-only.
+  void AnalyzeVariable(uint32_t var_id, SpvStorageClass storage_class);
+
+  // Returns true if every use of the pointer |pointer_id| is a load or store
+  // through it, or an access chain whose result also satisfies this.
+  bool HasOnlyDirectUses(uint32_t pointer_id) const;
+
+  // Returns the storage class of the pointer |pointer_id|.
+  SpvStorageClass GetStorageClass(uint32_t pointer_id) const;
+
+  // Returns the alias class of |location|, creating it if needed.
+  uint32_t GetClass(const MemoryLocation& location);
+
+  // Returns the unknown class of |storage_class|, creating it if needed.
+  uint32_t GetUnknownClass(SpvStorageClass storage_class);
+
+  // Creates the def or use of |inst| in |block|, if it accesses memory.
+  void CreateAccess(ir::Instruction* inst, ir::BasicBlock* block);
+
+  // Creates an access of |kind| for |inst| and |alias_class|.
+  MemoryAccess* NewAccess(MemoryAccess::Kind kind, uint32_t alias_class,
+                          ir::Instruction* inst, ir::BasicBlock* block);
+
+  // Links the accesses of |block| to their defining accesses.
+  void RenameBlock(ir::BasicBlock* block);
+
+  // Records |access| as the current access of |alias_class| in |block|.
+  void WriteClass(uint32_t alias_class, uint32_t block_id,
+                  MemoryAccess* access) {
+    current_access_[block_id][alias_class] = access;
+  }
+
+  // Returns the access of |alias_class| reaching the end of |block_id|,
+  // creating phis as needed.
+  MemoryAccess* ReadClass(uint32_t alias_class, uint32_t block_id);
+
+  // Returns the live-on-entry access of |alias_class|.
+  MemoryAccess* GetLiveOnEntry(uint32_t alias_class);
+
+  // Returns the access of |alias_class| reaching the start of |block_id|.
+  MemoryAccess* ReadClassRecursive(uint32_t alias_class, uint32_t block_id);
+
+  // Fills the incoming accesses of |phi|.
+  void AddPhiOperands(MemoryAccess* phi);
+
+  // Marks |block_id| as having all its predecessors processed, and completes
+  // its pending phis.
+  void SealBlock(uint32_t block_id);
+
+  // Replaces the phis whose incoming accesses are all the same access, or the
+  // phi itself, by that access, and fills the users of every access.
+  void RemoveTrivialPhis();
+
+  // Returns the access |access| stands for once trivial phis are removed.
+  MemoryAccess* Resolve(MemoryAccess* access);
+
+  // Returns true if the ids |a| and |b| are known to be the same index.
+  bool SameIndex(uint32_t a, uint32_t b) const;
+
+  // Returns true if the ids |a| and |b| are known to be different indices.
+  bool DifferentIndex(uint32_t a, uint32_t b) const;
+
+  ir::IRContext* context_;
+  ir::Function* function_;
+
+  // All the accesses, which this object owns.
+  std::vector<std::unique_ptr<MemoryAccess>> accesses_;
+
+  // The def or use of each instruction that accesses memory.
+  std::unordered_map<const ir::Instruction*, MemoryAccess*> inst_to_access_;
+
+  // The phis of each block.
+  std::unordered_map<const ir::BasicBlock*, std::vector<MemoryAccess*>> phis_;
+
+  // The location of each pointer analyzed so far.
+  std::unordered_map<uint32_t, MemoryLocation> locations_;
+
+  // The alias classes, and the class of each variable and each unknown
+  // pointer storage class.
+  std::vector<AliasClass> classes_;
+  std::unordered_map<uint32_t, uint32_t> variable_classes_;
+  std::unordered_map<uint32_t, uint32_t> unknown_classes_;
+
+  // The live-on-entry access of each class.
+  std::unordered_map<uint32_t, MemoryAccess*> live_on_entry_;
+
+  // Variables local to the function, and variables that are never written.
+  std::unordered_set<uint32_t> local_variables_;
+  std::unordered_set<uint32_t> read_only_variables_;
+
+  // The reachable predecessors of each reachable block, without duplicates.
+  std::unordered_map<uint32_t, std::vector<uint32_t>> preds_;
+
+  // State of the SSA construction.  For each block, the access of each class
+  // at the end of the part of the block processed so far.
+  std::unordered_map<uint32_t, std::unordered_map<uint32_t, MemoryAccess*>>
+      current_access_;
+  std::unordered_set<uint32_t> processed_blocks_;
+  std::unordered_set<uint32_t> sealed_blocks_;
+  std::unordered_map<uint32_t, std::vector<MemoryAccess*>> incomplete_phis_;
+
+  // For each trivial phi, the access that replaces it.
+  std::unordered_map<MemoryAccess*, MemoryAccess*> replacements_;
+};
+
+// The memory SSA forms of the functions of a module, built on demand.
+class MemorySSAAnalysis {
+ public:
+  explicit MemorySSAAnalysis(ir::IRContext* context) : context_(context) {}
+
+  // Returns the memory SSA form of |f|, building it first if needed.
+  MemorySSA* Get(ir::Function* f) {
+    auto it = cache_.find(f);
+    if (it == cache_.end()) {
+      std::unique_ptr<MemorySSA> memory_ssa(new MemorySSA(context_, f));
+      it = cache_.emplace(f, std::move(memory_ssa)).first;
+    }
+    return it->second.get();
+  }
+
+ private:
+  ir::IRContext* context_;
+  std::unordered_map<const ir::Function*, std::unique_ptr<MemorySSA>> cache_;
+};
+
+}  // namespace opt
+}  // namespace spvtools
+
+#endif  // LIBSPIRV_OPT_MEMORY_SSA_H_
@@ -15,11 +15,14 @@
 #include "module.h"
 
 #include <algorithm>
+#include <cassert>
 #include <cstring>
+#include <numeric>
 #include <ostream>
 
 #include "operand.h"
 #include "reflect.h"
+#include "util/parallel.h"
 
 namespace spvtools {
 namespace ir {
@@ -70,7 +73,7 @@ void Module::AddGlobalValue(SpvOp opcode, uint32_t result_id,
   AddGlobalValue(std::move(newGlobal));
 }
 
-void Module::ForEachInst(const std::function<void(Instruction*)>& f,
+void Module::ForEachInst(spvutils::FunctionRef<void(Instruction*)> f,
                          bool run_on_debug_line_insts) {
 #define DELEGATE(list) list.ForEachInst(f, run_on_debug_line_insts)
   DELEGATE(capabilities_);
@@ -88,8 +91,18 @@ void Module::ForEachInst(const std::function<void(Instruction*)>& f,
 #undef DELEGATE
 }
 
-void Module::ForEachInst(const std::function<void(const Instruction*)>& f,
+void Module::ForEachInst(spvutils::FunctionRef<void(const Instruction*)> f,
                          bool run_on_debug_line_insts) const {
+  ForEachModuleInst(f, run_on_debug_line_insts);
+  for (auto& i : functions_) {
+    static_cast<const Function*>(i.get())->ForEachInst(f,
+                                                       run_on_debug_line_insts);
+  }
+}
+
+void Module::ForEachModuleInst(
+    spvutils::FunctionRef<void(const Instruction*)> f,
+    bool run_on_debug_line_insts) const {
 #define DELEGATE(i) i.ForEachInst(f, run_on_debug_line_insts)
   for (auto& i : capabilities_) DELEGATE(i);
   for (auto& i : extensions_) DELEGATE(i);
@@ -104,10 +117,6 @@ void Module::ForEachInst(const std::function<void(const Instruction*)>& f,
   for (auto& i : debugs3_) DELEGATE(i);
   for (auto& i : annotations_) DELEGATE(i);
   for (auto& i : types_values_) DELEGATE(i);
-  for (auto& i : functions_) {
-    static_cast<const Function*>(i.get())->ForEachInst(f,
-                                                       run_on_debug_line_insts);
-  }
 #undef DELEGATE
 }
 
@@ -122,7 +131,58 @@ void Module::ToBinary(std::vector<uint32_t>* binary, bool skip_nop) const {
   auto write_inst = [binary, skip_nop](const Instruction* i) {
     if (!(skip_nop && i->IsNop())) i->ToBinaryWithoutAttachedDebugInsts(binary);
   };
-  ForEachInst(write_inst, true);
+  ForEachModuleInst(write_inst, true);
+  // Function bodies which are not loaded are written as they were read.
+  for (auto& f : functions_) {
+    const Function* function = f.get();
+    if (function->IsBodyLoaded()) {
+      function->ForEachInst(write_inst, true);
+    } else {
+      function->DefInst().ForEachInst(write_inst, true);
+      function->LazyBodyToBinary(binary, skip_nop);
+    }
+  }
+}
+
+void Module::ToBinary(std::vector<uint32_t>* binary, bool skip_nop,
+                      uint32_t num_threads) const {
+  if (num_threads <= 1 || functions_.size() <= 1) {
+    ToBinary(binary, skip_nop);
+    return;
+  }
+
+  binary->push_back(header_.magic_number);
+  binary->push_back(header_.version);
+  binary->push_back(header_.generator);
+  binary->push_back(header_.bound);
+  binary->push_back(header_.reserved);
+  ForEachModuleInst(
+      [binary, skip_nop](const Instruction* i) {
+        if (!(skip_nop && i->IsNop()))
+          i->ToBinaryWithoutAttachedDebugInsts(binary);
+      },
+      true);
+
+  // Each function is written at an offset computed from the sizes of the
+  // functions before it, so that the functions can be written concurrently
+  // into a buffer allocated once.
+  std::vector<size_t> offsets(functions_.size() + 1);
+  spvutils::ParallelFor(functions_.size(), num_threads,
+                        [this, &offsets, skip_nop](size_t i, uint32_t) {
+                          offsets[i + 1] = functions_[i]->BinarySize(skip_nop);
+                        });
+  offsets[0] = binary->size();
+  std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+  binary->resize(offsets.back());
+
+  uint32_t* words = binary->data();
+  spvutils::ParallelFor(
+      functions_.size(), num_threads,
+      [this, &offsets, words, skip_nop](size_t i, uint32_t) {
+        uint32_t* end = functions_[i]->ToBinary(words + offsets[i], skip_nop);
+        assert(end == words + offsets[i + 1]);
+        (void)end;
+      });
 }
 
 uint32_t Module::ComputeIdBound() const {
@@ -23,6 +23,7 @@
 #include "function.h"
 #include "instruction.h"
 #include "iterator.h"
+#include "util/function_ref.h"
 
 namespace spvtools {
 namespace ir {
@@ -53,6 +54,9 @@ class Module {
   // Sets the header to the given |header|.
   void SetHeader(const ModuleHeader& header) { header_ = header; }
 
+  // Returns the header.
+  const ModuleHeader& header() const { return header_; }
+
   // Sets the Id bound.
   void SetIdBound(uint32_t bound) { header_.bound = bound; }
 
@@ -226,14 +230,18 @@ class Module {
 
   // Invokes function |f| on all instructions in this module, and optionally on
   // the debug line instructions that precede them.
-  void ForEachInst(const std::function<void(Instruction*)>& f,
+  void ForEachInst(spvutils::FunctionRef<void(Instruction*)> f,
                    bool run_on_debug_line_insts = false);
-  void ForEachInst(const std::function<void(const Instruction*)>& f,
+  void ForEachInst(spvutils::FunctionRef<void(const Instruction*)> f,
                    bool run_on_debug_line_insts = false) const;
 
   // Pushes the binary segments for this instruction into the back of *|binary|.
   // If |skip_nop| is true and this is a OpNop, do nothing.
   void ToBinary(std::vector<uint32_t>* binary, bool skip_nop) const;
+  // Like the above, but writes the functions using up to |num_threads|
+  // threads.  The result is the same as with a single thread.
+  void ToBinary(std::vector<uint32_t>* binary, bool skip_nop,
+                uint32_t num_threads) const;
 
   // Returns 1 more than the maximum Id value mentioned in the module.
   uint32_t ComputeIdBound() const;
@@ -252,6 +260,12 @@ class Module {
   IRContext* context() const { return context_; }
 
  private:
+  // Invokes function |f| on all instructions in this module outside of
+  // functions, and optionally on the debug line instructions that precede
+  // them.
+  void ForEachModuleInst(spvutils::FunctionRef<void(const Instruction*)> f,
+                         bool run_on_debug_line_insts) const;
+
   ModuleHeader header_;  // Module header
 
   // The following fields respect the "Logical Layout of a Module" in
@@ -0,0 +1,63 @@
+// Copyright (c) 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "module_cost.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "loop_descriptor.h"
+#include "register_pressure.h"
+
+namespace spvtools {
+namespace opt {
+
+constexpr double ModuleCost::kLoopIterationEstimate;
+constexpr double ModuleCost::kRegisterWeight;
+
+ModuleCost ComputeModuleCost(ir::IRContext* context) {
+  ModuleCost cost;
+  context->module()->ForEachInst(
+      [&cost](const ir::Instruction*) { ++cost.instruction_count; });
+
+  for (ir::Function& func : *context->module()) {
+    if (func.begin() == func.end()) continue;
+
+    ir::LoopDescriptor* loop_descriptor = context->GetLoopDescriptor(&func);
+    const RegisterLiveness* liveness =
+        context->GetLivenessAnalysis()->Get(&func);
+    for (ir::BasicBlock& bb : func) {
+      const ir::Loop* loop = (*loop_descriptor)[&bb];
+      const double weight =
+          loop ? std::pow(ModuleCost::kLoopIterationEstimate,
+                          static_cast<double>(loop->GetDepth()))
+               : 1.0;
+      size_t block_size = 0;
+      bb.ForEachInst([&block_size](const ir::Instruction*) { ++block_size; });
+      cost.loop_weighted_instruction_count +=
+          weight * static_cast<double>(block_size);
+
+      // Unreachable blocks have no liveness information.
+      if (const RegisterLiveness::RegionRegisterLiveness* block_liveness =
+              liveness->Get(&bb)) {
+        cost.max_register_pressure = std::max(cost.max_register_pressure,
+                                              block_liveness->used_registers_);
+      }
+    }
+  }
+  return cost;
+}
+
+}  // namespace opt
+}  // namespace spvtools
@@ -0,0 +1,60 @@
+// Copyright (c) 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef LIBSPIRV_OPT_MODULE_COST_H_
+#define LIBSPIRV_OPT_MODULE_COST_H_
+
+#include <cstddef>
+
+#include "ir_context.h"
+
+namespace spvtools {
+namespace opt {
+
+// Static estimate of how expensive a module is to run, used to compare the
+// results of different pass pipelines on the same module.
+struct ModuleCost {
+  // The number of instructions in the module.
+  size_t instruction_count = 0;
+
+  // The largest number of registers live at the same time in any basic block
+  // of any function, as computed by RegisterLiveness.
+  size_t max_register_pressure = 0;
+
+  // The number of instructions in function bodies, where each instruction
+  // counts kLoopIterationEstimate times for each loop that contains it.
+  double loop_weighted_instruction_count = 0;
+
+  // The number of times a loop is assumed to iterate.
+  static constexpr double kLoopIterationEstimate = 4;
+
+  // The cost of one more live register, in instructions.
+  static constexpr double kRegisterWeight = 4;
+
+  // Returns a single score combining the estimates above.  Lower is better.
+  double Score() const {
+    return static_cast<double>(instruction_count) +
+           loop_weighted_instruction_count +
+           kRegisterWeight * static_cast<double>(max_register_pressure);
+  }
+};
+
+// Returns the cost of the module in |context|.  This builds the CFG,
+// dominator, loop and liveness analyses of every function.
+ModuleCost ComputeModuleCost(ir::IRContext* context);
+
+}  // namespace opt
+}  // namespace spvtools
+
+#endif  // LIBSPIRV_OPT_MODULE_COST_H_
@@ -14,11 +14,15 @@
 
 #include "spirv-tools/optimizer.hpp"
 
+#include <mutex>
+
 #include "build_module.h"
 #include "make_unique.h"
+#include "module_cost.h"
 #include "pass_manager.h"
 #include "passes.h"
 #include "simplification_pass.h"
+#include "util/parallel.h"
 
 namespace spvtools {
 
@@ -42,10 +46,12 @@ Optimizer::PassToken& Optimizer::PassToken::operator=(PassToken&& that) {
 Optimizer::PassToken::~PassToken() {}
 
 struct Optimizer::Impl {
-  explicit Impl(spv_target_env env) : target_env(env), pass_manager() {}
+  explicit Impl(spv_target_env env)
+      : target_env(env), pass_manager(), num_threads(1) {}
 
   const spv_target_env target_env;  // Target environment.
   opt::PassManager pass_manager;    // Internal implementation pass manager.
+  uint32_t num_threads;  // Threads to build and write the module with.
 };
 
 Optimizer::Optimizer(spv_target_env env) : impl_(new Impl(env)) {}
@@ -161,9 +167,46 @@ Optimizer& Optimizer::RegisterPerformancePasses() {
       .RegisterPass(CreateRedundancyEliminationPass())
       .RegisterPass(CreateDeadBranchElimPass())
       .RegisterPass(CreateBlockMergePass())
-      .RegisterPass(CreateInsertExtractElimPass());
-  // Currently exposing driver bugs resulting in crashes (#946)
-  // .RegisterPass(CreateCommonUniformElimPass())
+      .RegisterPass(CreateInsertExtractElimPass())
+      .RegisterPass(CreateUniformLoadElimPass());
+}
+
+// The change-driven recipe follows RegisterPerformancePasses(), but runs the
+// passes that clean up after each other as fixpoint groups.  With change
+// tracking, the repeated iterations only process the functions that changed.
+Optimizer& Optimizer::RegisterChangeDrivenPerformancePasses() {
+  // Bounds the work done by a group that keeps reporting changes.
+  const uint32_t kMaxFixpointIterations = 4;
+
+  impl_->pass_manager.SetChangeTracking(true);
+  return RegisterPass(CreateRemoveDuplicatesPass())
+      .RegisterPass(CreateMergeReturnPass())
+      .RegisterPass(CreateInlineExhaustivePass())
+      .RegisterPass(CreateFixpointPass({CreateAggressiveDCEPass,
+                                        CreateLocalSingleBlockLoadStoreElimPass,
+                                        CreateLocalSingleStoreElimPass},
+                                       kMaxFixpointIterations))
+      .RegisterPass(CreateScalarReplacementPass())
+      .RegisterPass(CreateLocalAccessChainConvertPass())
+      .RegisterPass(CreateFixpointPass(
+          {CreateLocalSingleBlockLoadStoreElimPass,
+           CreateLocalSingleStoreElimPass, CreateLocalMultiStoreElimPass,
+           CreateCCPPass, CreateAggressiveDCEPass},
+          kMaxFixpointIterations))
+      .RegisterPass(CreateRedundancyEliminationPass())
+      .RegisterPass(CreateInsertExtractElimPass())
+      .RegisterPass(CreateVectorDCEPass())
+      .RegisterPass(CreateDeadInsertElimPass())
+      .RegisterPass(CreateDeadBranchElimPass())
+      .RegisterPass(CreateSimplificationPass())
+      .RegisterPass(CreateIfConversionPass())
+      .RegisterPass(CreateCopyPropagateArraysPass())
+      .RegisterPass(CreateFixpointPass(
+          {CreateAggressiveDCEPass, CreateBlockMergePass,
+           CreateRedundancyEliminationPass, CreateDeadBranchElimPass},
+          kMaxFixpointIterations))
+      .RegisterPass(CreateInsertExtractElimPass())
+      .RegisterPass(CreateUniformLoadElimPass());
 }
 
 Optimizer& Optimizer::RegisterSizePasses() {
@@ -190,8 +233,7 @@ Optimizer& Optimizer::RegisterSizePasses() {
       .RegisterPass(CreateDeadInsertElimPass())
       .RegisterPass(CreateRedundancyEliminationPass())
       .RegisterPass(CreateCFGCleanupPass())
-      // Currently exposing driver bugs resulting in crashes (#946)
-      // .RegisterPass(CreateCommonUniformElimPass())
+      .RegisterPass(CreateUniformLoadElimPass())
       .RegisterPass(CreateAggressiveDCEPass());
 }
 
@@ -199,8 +241,9 @@ bool Optimizer::Run(const uint32_t* original_binary,
                     const size_t original_binary_size,
                     std::vector<uint32_t>* optimized_binary) const {
   std::unique_ptr<ir::IRContext> context =
-      BuildModule(impl_->target_env, impl_->pass_manager.consumer(),
-                  original_binary, original_binary_size);
+      BuildModuleInParallel(impl_->target_env, impl_->pass_manager.consumer(),
+                            original_binary, original_binary_size,
+                            impl_->num_threads);
   if (context == nullptr) return false;
 
   auto status = impl_->pass_manager.Run(context.get());
@@ -209,12 +252,129 @@ bool Optimizer::Run(const uint32_t* original_binary,
        (optimized_binary->data() != original_binary ||
         optimized_binary->size() != original_binary_size))) {
     optimized_binary->clear();
-    context->module()->ToBinary(optimized_binary, /* skip_nop = */ true);
+    context->module()->ToBinary(optimized_binary, /* skip_nop = */ true,
+                                impl_->num_threads);
   }
 
   return status != opt::Pass::Status::Failure;
 }
 
+bool Optimizer::RunVariants(
+    const uint32_t* original_binary, const size_t original_binary_size,
+    const std::vector<std::unordered_map<uint32_t, std::string>>& variants,
+    const std::function<void(Optimizer*)>& register_variant_passes,
+    std::vector<std::vector<uint32_t>>* optimized_binaries) const {
+  std::vector<uint32_t> common_binary;
+  if (!Run(original_binary, original_binary_size, &common_binary)) {
+    return false;
+  }
+
+  // The variants fork this context, whose function bodies are only loaded
+  // by the variants that access them.
+  std::unique_ptr<ir::IRContext> common_context =
+      BuildModule(impl_->target_env, impl_->pass_manager.consumer(),
+                  common_binary.data(), common_binary.size(),
+                  /* lazy_function_bodies = */ true);
+  if (common_context == nullptr) return false;
+
+  optimized_binaries->clear();
+  optimized_binaries->resize(variants.size());
+  for (size_t i = 0; i < variants.size(); ++i) {
+    Optimizer variant_optimizer(impl_->target_env);
+    variant_optimizer.SetMessageConsumer(impl_->pass_manager.consumer());
+    variant_optimizer.RegisterPass(
+        CreateSetSpecConstantDefaultValuePass(variants[i]));
+    register_variant_passes(&variant_optimizer);
+
+    std::unique_ptr<ir::IRContext> context = common_context->Fork();
+    auto status = variant_optimizer.impl_->pass_manager.Run(context.get());
+    if (status == opt::Pass::Status::Failure) return false;
+    context->module()->ToBinary(&(*optimized_binaries)[i],
+                                /* skip_nop = */ true, impl_->num_threads);
+  }
+  return true;
+}
+
+bool Optimizer::RunAutotuned(const uint32_t* original_binary,
+                             const size_t original_binary_size,
+                             const std::vector<Recipe>& recipes,
+                             const CostFunction& cost_function,
+                             std::vector<uint32_t>* optimized_binary,
+                             std::string* winning_recipe,
+                             std::vector<RecipeReport>* report) const {
+  std::unique_ptr<ir::IRContext> common_context =
+      BuildModuleInParallel(impl_->target_env, impl_->pass_manager.consumer(),
+                            original_binary, original_binary_size,
+                            impl_->num_threads);
+  if (common_context == nullptr) return false;
+  if (impl_->pass_manager.Run(common_context.get()) ==
+      opt::Pass::Status::Failure) {
+    return false;
+  }
+
+  // The recipes run on different threads, so their messages are passed on
+  // one at a time.
+  std::mutex consumer_mutex;
+  const MessageConsumer& consumer = impl_->pass_manager.consumer();
+  MessageConsumer serialized_consumer =
+      [&consumer_mutex, &consumer](
+          spv_message_level_t level, const char* source,
+          const spv_position_t& position, const char* message) {
+        std::lock_guard<std::mutex> lock(consumer_mutex);
+        if (consumer) consumer(level, source, position, message);
+      };
+
+  // The registration callbacks are not required to be thread-safe, so all
+  // the optimizers are set up before any recipe runs.
+  std::vector<std::unique_ptr<Optimizer>> recipe_optimizers;
+  for (const Recipe& recipe : recipes) {
+    recipe_optimizers.emplace_back(new Optimizer(impl_->target_env));
+    recipe_optimizers.back()->SetMessageConsumer(serialized_consumer);
+    recipe.register_passes(recipe_optimizers.back().get());
+  }
+
+  std::vector<RecipeReport> results(recipes.size());
+  std::vector<std::vector<uint32_t>> binaries(recipes.size());
+  spvutils::ParallelFor(
+      recipes.size(), impl_->num_threads, [&](size_t i, uint32_t) {
+        RecipeReport& result = results[i];
+        result.name = recipes[i].name;
+        result.succeeded = false;
+        result.cost = 0;
+        result.binary_size = 0;
+
+        // All the function bodies of |common_context| are loaded, so forking
+        // only reads it and may happen concurrently.
+        std::unique_ptr<ir::IRContext> context = common_context->Fork();
+        context->SetMessageConsumer(serialized_consumer);
+        if (recipe_optimizers[i]->impl_->pass_manager.Run(context.get()) ==
+            opt::Pass::Status::Failure) {
+          return;
+        }
+        context->module()->ToBinary(&binaries[i], /* skip_nop = */ true);
+        result.succeeded = true;
+        result.binary_size = binaries[i].size();
+        const std::vector<uint32_t>& binary = binaries[i];
+        result.cost = cost_function
+                          ? cost_function(binary.data(), binary.size())
+                          : opt::ComputeModuleCost(context.get()).Score();
+      });
+
+  size_t best = recipes.size();
+  for (size_t i = 0; i < recipes.size(); ++i) {
+    if (!results[i].succeeded) continue;
+    if (best == recipes.size() || results[i].cost < results[best].cost) {
+      best = i;
+    }
+  }
+
+  if (report) *report = std::move(results);
+  if (best == recipes.size()) return false;
+  *optimized_binary = std::move(binaries[best]);
+  if (winning_recipe) *winning_recipe = recipes[best].name;
+  return true;
+}
+
 Optimizer& Optimizer::SetPrintAll(std::ostream* out) {
   impl_->pass_manager.SetPrintAll(out);
   return *this;
@@ -225,6 +385,16 @@ Optimizer& Optimizer::SetTimeReport(std::ostream* out) {
   return *this;
 }
 
+Optimizer& Optimizer::SetChangeTracking(bool track_changes) {
+  impl_->pass_manager.SetChangeTracking(track_changes);
+  return *this;
+}
+
+Optimizer& Optimizer::SetNumThreads(uint32_t num_threads) {
+  impl_->num_threads = num_threads;
+  return *this;
+}
+
 Optimizer::PassToken CreateNullPass() {
   return MakeUnique<Optimizer::PassToken::Impl>(MakeUnique<opt::NullPass>());
 }
@@ -306,6 +476,11 @@ Optimizer::PassToken CreateInlineOpaquePass() {
       MakeUnique<opt::InlineOpaquePass>());
 }
 
+Optimizer::PassToken CreateInlineBudgetedPass(size_t budget) {
+  return MakeUnique<Optimizer::PassToken::Impl>(
+      MakeUnique<opt::InlineBudgetedPass>(budget));
+}
+
 Optimizer::PassToken CreateLocalAccessChainConvertPass() {
   return MakeUnique<Optimizer::PassToken::Impl>(
       MakeUnique<opt::LocalAccessChainConvertPass>());
@@ -351,6 +526,11 @@ Optimizer::PassToken CreateCommonUniformElimPass() {
       MakeUnique<opt::CommonUniformElimPass>());
 }
 
+Optimizer::PassToken CreateUniformLoadElimPass() {
+  return MakeUnique<Optimizer::PassToken::Impl>(
+      MakeUnique<opt::UniformLoadElimPass>());
+}
+
 Optimizer::PassToken CreateCompactIdsPass() {
   return MakeUnique<Optimizer::PassToken::Impl>(
       MakeUnique<opt::CompactIdsPass>());
@@ -383,6 +563,21 @@ Optimizer::PassToken CreateLoopInvariantCodeMotionPass() {
   return MakeUnique<Optimizer::PassToken::Impl>(MakeUnique<opt::LICMPass>());
 }
 
+Optimizer::PassToken CreateLoopFissionPass(size_t register_threshold) {
+  return MakeUnique<Optimizer::PassToken::Impl>(
+      MakeUnique<opt::LoopFissionPass>(register_threshold));
+}
+
+Optimizer::PassToken CreateLoopFusionPass(size_t max_registers_per_loop) {
+  return MakeUnique<Optimizer::PassToken::Impl>(
+      MakeUnique<opt::LoopFusionPass>(max_registers_per_loop));
+}
+
+Optimizer::PassToken CreateCodeSinkingPass(size_t register_threshold) {
+  return MakeUnique<Optimizer::PassToken::Impl>(
+      MakeUnique<opt::CodeSinkingPass>(register_threshold));
+}
+
 Optimizer::PassToken CreateLoopPeelingPass() {
   return MakeUnique<Optimizer::PassToken::Impl>(
       MakeUnique<opt::LoopPeelingPass>());
@@ -432,6 +627,11 @@ Optimizer::PassToken CreateReplaceInvalidOpcodePass() {
       MakeUnique<opt::ReplaceInvalidOpcodePass>());
 }
 
+Optimizer::PassToken CreateDedupFunctionsPass() {
+  return MakeUnique<Optimizer::PassToken::Impl>(
+      MakeUnique<opt::DedupFunctionsPass>());
+}
+
 Optimizer::PassToken CreateSimplificationPass() {
   return MakeUnique<Optimizer::PassToken::Impl>(
       MakeUnique<opt::SimplificationPass>());
@@ -442,6 +642,11 @@ Optimizer::PassToken CreateLoopUnrollPass(bool fully_unroll, int factor) {
       MakeUnique<opt::LoopUnroller>(fully_unroll, factor));
 }
 
+Optimizer::PassToken CreateHeuristicLoopUnrollPass(size_t size_budget) {
+  return MakeUnique<Optimizer::PassToken::Impl>(
+      MakeUnique<opt::LoopUnroller>(size_budget, nullptr));
+}
+
 Optimizer::PassToken CreateSSARewritePass() {
   return MakeUnique<Optimizer::PassToken::Impl>(
       MakeUnique<opt::SSARewritePass>());
@@ -456,4 +661,21 @@ Optimizer::PassToken CreateVectorDCEPass() {
   return MakeUnique<Optimizer::PassToken::Impl>(MakeUnique<opt::VectorDCE>());
 }
 
+Optimizer::PassToken CreateLoadStoreElimPass() {
+  return MakeUnique<Optimizer::PassToken::Impl>(
+      MakeUnique<opt::LoadStoreElimPass>());
+}
+
+Optimizer::PassToken CreateFixpointPass(
+    std::vector<std::function<Optimizer::PassToken()>> pass_creators,
+    uint32_t max_iterations) {
+  std::vector<opt::FixpointPass::PassCreator> creators;
+  for (auto& create_pass : pass_creators) {
+    creators.push_back(
+        [create_pass]() { return std::move(create_pass().impl_->pass); });
+  }
+  return MakeUnique<Optimizer::PassToken::Impl>(
+      MakeUnique<opt::FixpointPass>(std::move(creators), max_iterations));
+}
+
 }  // namespace spvtools
@@ -108,14 +108,43 @@ Pass::Status Pass::Run(ir::IRContext* ctx) {
   }
   already_run_ = true;
 
+  ChangeTracker* tracker = ctx->change_tracker();
+  if (tracker) tracker->BeginPass(name());
+
   Pass::Status status = Process(ctx);
   if (status == Status::SuccessWithChange) {
     ctx->InvalidateAnalysesExceptFor(GetPreservedAnalyses());
+    // Changes that were not recorded may affect any function.
+    if (tracker && !RecordsFunctionChanges()) tracker->MarkModuleChanged();
   }
   assert(ctx->IsConsistent());
   return status;
 }
 
+bool Pass::IsFunctionSettled(const ir::Function* func) const {
+  ChangeTracker* tracker = context()->change_tracker();
+  return tracker && tracker->IsSettled(func);
+}
+
+bool Pass::RecordFunctionResult(const ir::Function* func, bool modified) {
+  ChangeTracker* tracker = context()->change_tracker();
+  if (tracker) {
+    if (modified) {
+      tracker->MarkChanged(func);
+    } else {
+      tracker->MarkUnchanged(func);
+    }
+  }
+  return modified;
+}
+
+Pass::ProcessFunction Pass::SkipSettledFunctions(ProcessFunction pfn) {
+  return [this, pfn](ir::Function* fp) {
+    if (IsFunctionSettled(fp)) return false;
+    return RecordFunctionResult(fp, pfn(fp));
+  };
+}
+
 uint32_t Pass::GetPointeeTypeId(const ir::Instruction* ptrInst) const {
   const uint32_t ptrTypeId = ptrInst->type_id();
   const ir::Instruction* ptrTypeInst = get_def_use_mgr()->GetDef(ptrTypeId);
@@ -132,6 +132,12 @@ class Pass {
     return ir::IRContext::kAnalysisNone;
   }
 
+  // Returns true if the pass records every function it changes with
+  // RecordFunctionResult(), and its other changes cannot affect how passes
+  // process functions.  When change tracking is enabled, a change made by a
+  // pass that does not unsettles all functions for all passes.
+  virtual bool RecordsFunctionChanges() const { return false; }
+
   // Return type id for |ptrInst|'s pointee
   uint32_t GetPointeeTypeId(const ir::Instruction* ptrInst) const;
 
@@ -148,6 +154,19 @@ class Pass {
   // Return the next available SSA id and increment it.
   uint32_t TakeNextId() { return context_->TakeNextId(); }
 
+  // Returns true if change tracking is enabled and this pass already processed
+  // |func| without changing it, and nothing changed since.  Processing |func|
+  // again would have no effect, so it can be skipped.
+  bool IsFunctionSettled(const ir::Function* func) const;
+
+  // Records whether this pass |modified| |func| if change tracking is enabled.
+  // Returns |modified|.
+  bool RecordFunctionResult(const ir::Function* func, bool modified);
+
+  // Returns a function that applies |pfn| to the functions that are not
+  // settled and records the result.
+  ProcessFunction SkipSettledFunctions(ProcessFunction pfn);
+
  private:
   MessageConsumer consumer_;  // Message consumer.
 
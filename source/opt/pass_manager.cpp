@@ -42,6 +42,8 @@ Pass::Status PassManager::Run(ir::IRContext* context) {
     }
   };
 
+  if (track_changes_) context->EnableChangeTracking();
+
   SPIRV_TIMER_DESCRIPTION(time_report_stream_, /* measure_mem_usage = */ true);
   for (auto& pass : passes_) {
     print_disassembly("; IR before pass ", pass.get());
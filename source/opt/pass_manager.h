@@ -42,7 +42,8 @@ class PassManager {
   PassManager()
       : consumer_(nullptr),
         print_all_stream_(nullptr),
-        time_report_stream_(nullptr) {}
+        time_report_stream_(nullptr),
+        track_changes_(false) {}
 
   // Sets the message consumer to the given |consumer|.
   void SetMessageConsumer(MessageConsumer c) { consumer_ = std::move(c); }
@@ -88,6 +89,13 @@ class PassManager {
     return *this;
   }
 
+  // Sets the option to record which functions the passes change, so that
+  // passes can skip the functions they have already processed without effect.
+  PassManager& SetChangeTracking(bool track_changes) {
+    track_changes_ = track_changes;
+    return *this;
+  }
+
  private:
   // Consumer for messages.
   MessageConsumer consumer_;
@@ -99,6 +107,8 @@ class PassManager {
   // The output stream to write the resource utilization of each pass. If this
   // is null, no output is generated.
   std::ostream* time_report_stream_;
+  // Whether change tracking is enabled in the context passes run on.
+  bool track_changes_;
 };
 
 inline void PassManager::AddPass(std::unique_ptr<Pass> pass) {
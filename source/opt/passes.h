@@ -21,27 +21,34 @@
 #include "block_merge_pass.h"
 #include "ccp_pass.h"
 #include "cfg_cleanup_pass.h"
+#include "code_sinking_pass.h"
 #include "common_uniform_elim_pass.h"
 #include "compact_ids_pass.h"
 #include "copy_prop_arrays.h"
 #include "dead_branch_elim_pass.h"
 #include "dead_insert_elim_pass.h"
 #include "dead_variable_elimination.h"
+#include "dedup_functions_pass.h"
 #include "eliminate_dead_constant_pass.h"
 #include "eliminate_dead_functions_pass.h"
+#include "fixpoint_pass.h"
 #include "flatten_decoration_pass.h"
 #include "fold_spec_constant_op_and_composite_pass.h"
 #include "freeze_spec_constant_value_pass.h"
 #include "if_conversion.h"
+#include "inline_budgeted_pass.h"
 #include "inline_exhaustive_pass.h"
 #include "inline_opaque_pass.h"
 #include "insert_extract_elim.h"
 #include "licm_pass.h"
+#include "load_store_elim_pass.h"
 #include "local_access_chain_convert_pass.h"
 #include "local_redundancy_elimination.h"
 #include "local_single_block_elim_pass.h"
 #include "local_single_store_elim_pass.h"
 #include "local_ssa_elim_pass.h"
+#include "loop_fission.h"
+#include "loop_fusion.h"
 #include "loop_peeling.h"
 #include "loop_unroller.h"
 #include "loop_unswitch_pass.h"
@@ -57,6 +64,7 @@
 #include "strength_reduction_pass.h"
 #include "strip_debug_info_pass.h"
 #include "strip_reflect_info_pass.h"
+#include "uniform_load_elim_pass.h"
 #include "unify_const_pass.h"
 #include "vector_dce.h"
 #include "workaround1209.h"
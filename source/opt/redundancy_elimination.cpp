@@ -26,6 +26,8 @@ Pass::Status RedundancyEliminationPass::Process(ir::IRContext* c) {
   ValueNumberTable vnTable(context());
 
   for (auto& func : *get_module()) {
+    if (IsFunctionSettled(&func)) continue;
+
     // Build the dominator tree for this function. It is how the code is
     // traversed.
     opt::DominatorTree& dom_tree =
@@ -36,7 +38,9 @@ Pass::Status RedundancyEliminationPass::Process(ir::IRContext* c) {
     // different decorations.
     std::map<uint32_t, uint32_t> value_to_ids;
 
-    if (EliminateRedundanciesFrom(dom_tree.GetRoot(), vnTable, value_to_ids)) {
+    bool func_modified =
+        EliminateRedundanciesFrom(dom_tree.GetRoot(), vnTable, value_to_ids);
+    if (RecordFunctionResult(&func, func_modified)) {
       modified = true;
     }
   }
@@ -31,6 +31,7 @@ class RedundancyEliminationPass : public LocalRedundancyEliminationPass {
  public:
   const char* name() const override { return "redundancy-elimination"; }
   Status Process(ir::IRContext*) override;
+  bool RecordsFunctionChanges() const override { return true; }
 
  protected:
   // Removes for all total redundancies in the function starting at |bb|.
@@ -15,6 +15,7 @@
 #include "opt/scalar_analysis.h"
 
 #include <algorithm>
+#include <cstddef>
 #include <functional>
 #include <string>
 #include <utility>
@@ -51,8 +52,36 @@ uint32_t SENode::NumberOfNodes = 0;
 ScalarEvolutionAnalysis::ScalarEvolutionAnalysis(ir::IRContext* context)
     : context_(context) {
   // Create and cached the CantComputeNode.
-  cached_cant_compute_ =
-      GetCachedOrAdd(std::unique_ptr<SECantCompute>(new SECantCompute(this)));
+  cached_cant_compute_ = GetCachedOrAdd(NewNode<SECantCompute>());
+}
+
+ScalarEvolutionAnalysis::~ScalarEvolutionAnalysis() {
+  for (auto itr = nodes_.rbegin(); itr != nodes_.rend(); ++itr) {
+    (*itr)->~SENode();
+  }
+}
+
+void* ScalarEvolutionAnalysis::AllocateNode(size_t size) {
+  // Keep every node aligned like the blocks.
+  const size_t alignment = alignof(std::max_align_t);
+  size = (size + alignment - 1) / alignment * alignment;
+  assert(size <= kNodeBlockSize);
+
+  if (last_block_used_ + size > kNodeBlockSize) {
+    node_blocks_.emplace_back(new char[kNodeBlockSize]);
+    last_block_used_ = 0;
+  }
+  void* memory = node_blocks_.back().get() + last_block_used_;
+  last_block_used_ += size;
+  return memory;
+}
+
+void ScalarEvolutionAnalysis::ReleaseLastNode() {
+  SENode* node = nodes_.back();
+  nodes_.pop_back();
+  // The last node is at the end of the last block.
+  last_block_used_ = reinterpret_cast<char*>(node) - node_blocks_.back().get();
+  node->~SENode();
 }
 
 SENode* ScalarEvolutionAnalysis::CreateNegation(SENode* operand) {
@@ -62,14 +91,18 @@ SENode* ScalarEvolutionAnalysis::CreateNegation(SENode* operand) {
   if (operand->GetType() == SENode::Constant) {
     return CreateConstant(-operand->AsSEConstantNode()->FoldToSingleValue());
   }
-  std::unique_ptr<SENode> negation_node{new SENegative(this)};
+  SENode* negation_node = NewNode<SENegative>();
   negation_node->AddChild(operand);
-  return GetCachedOrAdd(std::move(negation_node));
+  return GetCachedOrAdd(negation_node);
 }
 
 SENode* ScalarEvolutionAnalysis::CreateConstant(int64_t integer) {
-  return GetCachedOrAdd(
-      std::unique_ptr<SENode>(new SEConstantNode(this, integer)));
+  SENode*& node = constant_nodes_[integer];
+  if (!node) {
+    node = NewNode<SEConstantNode>(integer);
+    node->is_cached_ = true;
+  }
+  return node;
 }
 
 SENode* ScalarEvolutionAnalysis::CreateRecurrentExpression(
@@ -80,11 +113,17 @@ SENode* ScalarEvolutionAnalysis::CreateRecurrentExpression(
   if (offset->IsCantCompute() || coefficient->IsCantCompute())
     return CreateCantComputeNode();
 
-  std::unique_ptr<SERecurrentNode> phi_node{new SERecurrentNode(this, loop)};
+  // The recurrent expression may be attributed to another loop with the same
+  // iteration space, see AddLoopsToPretendAreTheSame.
+  const ir::Loop* node_loop = loop;
+  auto pretend_it = pretend_equal_.find(loop);
+  if (pretend_it != pretend_equal_.end()) node_loop = pretend_it->second;
+
+  SERecurrentNode* phi_node = NewNode<SERecurrentNode>(node_loop);
   phi_node->AddOffset(offset);
   phi_node->AddCoefficient(coefficient);
 
-  return GetCachedOrAdd(std::move(phi_node));
+  return GetCachedOrAdd(phi_node);
 }
 
 SENode* ScalarEvolutionAnalysis::AnalyzeMultiplyOp(
@@ -113,12 +152,12 @@ SENode* ScalarEvolutionAnalysis::CreateMultiplyNode(SENode* operand_1,
                           operand_2->AsSEConstantNode()->FoldToSingleValue());
   }
 
-  std::unique_ptr<SENode> multiply_node{new SEMultiplyNode(this)};
+  SENode* multiply_node = NewNode<SEMultiplyNode>();
 
   multiply_node->AddChild(operand_1);
   multiply_node->AddChild(operand_2);
 
-  return GetCachedOrAdd(std::move(multiply_node));
+  return GetCachedOrAdd(multiply_node);
 }
 
 SENode* ScalarEvolutionAnalysis::CreateSubtraction(SENode* operand_1,
@@ -146,23 +185,32 @@ SENode* ScalarEvolutionAnalysis::CreateAddNode(SENode* operand_1,
   if (operand_1->IsCantCompute() || operand_2->IsCantCompute())
     return CreateCantComputeNode();
 
-  std::unique_ptr<SENode> add_node{new SEAddNode(this)};
+  SENode* add_node = NewNode<SEAddNode>();
 
   add_node->AddChild(operand_1);
   add_node->AddChild(operand_2);
 
-  return GetCachedOrAdd(std::move(add_node));
+  return GetCachedOrAdd(add_node);
 }
 
 SENode* ScalarEvolutionAnalysis::AnalyzeInstruction(
     const ir::Instruction* inst) {
-  auto itr = recurrent_node_map_.find(inst);
-  if (itr != recurrent_node_map_.end()) return itr->second;
+  // Any instruction may depend on one which was modified or deleted since the
+  // results were memoized.
+  if (analyzed_epoch_ != context_->modification_epoch()) {
+    analyzed_instructions_.clear();
+    analyzed_epoch_ = context_->modification_epoch();
+  }
+
+  auto itr = analyzed_instructions_.find(inst);
+  if (itr != analyzed_instructions_.end()) return itr->second;
 
   SENode* output = nullptr;
   switch (inst->opcode()) {
     case SpvOp::SpvOpPhi: {
+      ++phis_in_progress_;
       output = AnalyzePhiInstruction(inst);
+      --phis_in_progress_;
       break;
     }
     case SpvOp::SpvOpConstant:
@@ -185,6 +233,10 @@ SENode* ScalarEvolutionAnalysis::AnalyzeInstruction(
     }
   }
 
+  // While a phi is analyzed, |output| may refer to its incomplete recurrent
+  // expression, which AnalyzePhiInstruction may replace by an equal one from
+  // the cache. The phis themselves are recorded by AnalyzePhiInstruction.
+  if (!phis_in_progress_) analyzed_instructions_[inst] = output;
   return output;
 }
 
@@ -268,15 +320,15 @@ SENode* ScalarEvolutionAnalysis::AnalyzePhiInstruction(
   // out.
   if (!loop || !loop->GetLatchBlock() || !loop->GetPreHeaderBlock() ||
       loop->GetHeaderBlock() != basic_block)
-    return recurrent_node_map_[phi] = CreateCantComputeNode();
+    return analyzed_instructions_[phi] = CreateCantComputeNode();
 
-  std::unique_ptr<SERecurrentNode> phi_node{new SERecurrentNode(this, loop)};
+  SERecurrentNode* phi_node = NewNode<SERecurrentNode>(loop);
 
   // We add the node to this map to allow it to be returned before the node is
   // fully built. This is needed as the subsequent call to AnalyzeInstruction
   // could lead back to this |phi| instruction so we return the pointer
   // immediately in AnalyzeInstruction to break the recursion.
-  recurrent_node_map_[phi] = phi_node.get();
+  analyzed_instructions_[phi] = phi_node;
 
   // Traverse the operands of the instruction an create new nodes for each one.
   for (uint32_t i = 0; i < phi->NumInOperands(); i += 2) {
@@ -288,7 +340,7 @@ SENode* ScalarEvolutionAnalysis::AnalyzePhiInstruction(
 
     // If any operand is CantCompute then the whole graph is CantCompute.
     if (value_node->IsCantCompute())
-      return recurrent_node_map_[phi] = CreateCantComputeNode();
+      return analyzed_instructions_[phi] = CreateCantComputeNode();
 
     // If the value is coming from the preheader block then the value is the
     // initial value of the phi.
@@ -297,7 +349,7 @@ SENode* ScalarEvolutionAnalysis::AnalyzePhiInstruction(
     } else if (incoming_label_id == loop->GetLatchBlock()->id()) {
       // Assumed to be in the form of step + phi.
       if (value_node->GetType() != SENode::Add)
-        return recurrent_node_map_[phi] = CreateCantComputeNode();
+        return analyzed_instructions_[phi] = CreateCantComputeNode();
 
       SENode* step_node = nullptr;
       SENode* phi_operand = nullptr;
@@ -318,14 +370,14 @@ SENode* ScalarEvolutionAnalysis::AnalyzePhiInstruction(
 
       // If it is not in the form step + phi exit out.
       if (!(step_node && phi_operand))
-        return recurrent_node_map_[phi] = CreateCantComputeNode();
+        return analyzed_instructions_[phi] = CreateCantComputeNode();
 
       // If the phi operand is not the same phi node exit out.
-      if (phi_operand != phi_node.get())
-        return recurrent_node_map_[phi] = CreateCantComputeNode();
+      if (phi_operand != phi_node)
+        return analyzed_instructions_[phi] = CreateCantComputeNode();
 
       if (!IsLoopInvariant(loop, step_node))
-        return recurrent_node_map_[phi] = CreateCantComputeNode();
+        return analyzed_instructions_[phi] = CreateCantComputeNode();
 
       phi_node->AddCoefficient(step_node);
     }
@@ -333,14 +385,25 @@ SENode* ScalarEvolutionAnalysis::AnalyzePhiInstruction(
 
   // Once the node is fully built we update the map with the version from the
   // cache (if it has already been added to the cache).
-  return recurrent_node_map_[phi] = GetCachedOrAdd(std::move(phi_node));
+  return analyzed_instructions_[phi] = GetCachedOrAdd(phi_node);
+}
+
+void ScalarEvolutionAnalysis::AddLoopsToPretendAreTheSame(
+    const std::vector<const ir::Loop*>& loops) {
+  if (loops.empty()) return;
+  for (const ir::Loop* loop : loops) {
+    pretend_equal_[loop] = loops.front();
+  }
 }
 
 SENode* ScalarEvolutionAnalysis::CreateValueUnknownNode(
     const ir::Instruction* inst) {
-  std::unique_ptr<SEValueUnknown> load_node{
-      new SEValueUnknown(this, inst->result_id())};
-  return GetCachedOrAdd(std::move(load_node));
+  SENode*& node = value_unknown_nodes_[inst->result_id()];
+  if (!node) {
+    node = NewNode<SEValueUnknown>(inst->result_id());
+    node->is_cached_ = true;
+  }
+  return node;
 }
 
 SENode* ScalarEvolutionAnalysis::CreateCantComputeNode() {
@@ -348,16 +411,35 @@ SENode* ScalarEvolutionAnalysis::CreateCantComputeNode() {
 }
 
 // Add the created node into the cache of nodes. If it already exists return it.
-SENode* ScalarEvolutionAnalysis::GetCachedOrAdd(
-    std::unique_ptr<SENode> prospective_node) {
+SENode* ScalarEvolutionAnalysis::GetCachedOrAdd(SENode* prospective_node) {
+  if (prospective_node->is_cached_) return prospective_node;
+
   auto itr = node_cache_.find(prospective_node);
   if (itr != node_cache_.end()) {
-    return (*itr).get();
+    // Most candidates are built just before they are looked up, so their
+    // memory can be reused right away.
+    if (prospective_node == nodes_.back()) ReleaseLastNode();
+    return *itr;
   }
 
-  SENode* raw_ptr_to_node = prospective_node.get();
-  node_cache_.insert(std::move(prospective_node));
-  return raw_ptr_to_node;
+  prospective_node->is_cached_ = true;
+  node_cache_.insert(prospective_node);
+  return prospective_node;
+}
+
+void ScalarEvolutionAnalysis::InvalidateLoop(const ir::Loop* loop) {
+  for (auto itr = analyzed_instructions_.begin();
+       itr != analyzed_instructions_.end();) {
+    ir::Instruction* inst = const_cast<ir::Instruction*>(itr->first);
+    const SENode* node = itr->second;
+    // A node which can't be computed may have failed because of |loop|.
+    if (node->IsCantCompute() || loop->IsInsideLoop(inst) ||
+        !IsLoopInvariant(loop, node)) {
+      itr = analyzed_instructions_.erase(itr);
+    } else {
+      ++itr;
+    }
+  }
 }
 
 bool ScalarEvolutionAnalysis::IsLoopInvariant(const ir::Loop* loop,
@@ -408,12 +490,12 @@ SENode* ScalarEvolutionAnalysis::UpdateChildNode(SENode* parent,
     }
   }
 
-  std::unique_ptr<SENode> add_node{new SEAddNode(this)};
+  SENode* add_node = NewNode<SEAddNode>();
   for (SENode* child : new_children) {
     add_node->AddChild(child);
   }
 
-  return SimplifyExpression(GetCachedOrAdd(std::move(add_node)));
+  return SimplifyExpression(GetCachedOrAdd(add_node));
 }
 
 // Rebuild the |node| eliminating, if it exists, the recurrent term which
@@ -442,12 +524,12 @@ SENode* ScalarEvolutionAnalysis::BuildGraphWithoutRecurrentTerm(
     }
   }
 
-  std::unique_ptr<SENode> add_node{new SEAddNode(this)};
+  SENode* add_node = NewNode<SEAddNode>();
   for (SENode* child : new_children) {
     add_node->AddChild(child);
   }
 
-  return SimplifyExpression(GetCachedOrAdd(std::move(add_node)));
+  return SimplifyExpression(GetCachedOrAdd(add_node));
 }
 
 // Return the recurrent term belonging to |loop| if it appears in the graph
@@ -19,7 +19,10 @@
 #include <cstdint>
 #include <map>
 #include <memory>
+#include <new>
+#include <unordered_map>
 #include <unordered_set>
+#include <utility>
 #include <vector>
 
 #include "opt/basic_block.h"
@@ -40,9 +43,17 @@ namespace opt {
 // two induction variables i=0,i++ and j=0,j++) become the same node. After
 // creating a DAG with AnalyzeInstruction it can the be simplified into a more
 // usable form with SimplifyExpression.
+//
+// The nodes are allocated in blocks owned by the analysis, and live as long as
+// it. The results of AnalyzeInstruction and SimplifyExpression are memoized, so
+// that the analyses querying the same expressions over and over do not
+// rebuild them.
 class ScalarEvolutionAnalysis {
  public:
   explicit ScalarEvolutionAnalysis(ir::IRContext* context);
+  ScalarEvolutionAnalysis(const ScalarEvolutionAnalysis&) = delete;
+  ScalarEvolutionAnalysis& operator=(const ScalarEvolutionAnalysis&) = delete;
+  ~ScalarEvolutionAnalysis();
 
   // Create a unary negative node on |operand|.
   SENode* CreateNegation(SENode* operand);
@@ -73,7 +84,9 @@ class ScalarEvolutionAnalysis {
   SENode* CreateRecurrentExpression(const ir::Loop* loop, SENode* offset,
                                     SENode* coefficient);
 
-  // Construct the DAG by traversing use def chain of |inst|.
+  // Construct the DAG by traversing use def chain of |inst|. The result is
+  // memoized: it is only computed again for |inst| after InvalidateLoop
+  // discards it, or once the context reports a modification of the IR.
   SENode* AnalyzeInstruction(const ir::Instruction* inst);
 
   // Simplify the |node| by grouping like terms or if contains a recurrent
@@ -86,11 +99,28 @@ class ScalarEvolutionAnalysis {
   //
   // X+X*2+Y-Y+34-17 would be transformed into 3*X + 17, where X and Y are
   // ValueUnknown nodes (such as a load instruction).
+  //
+  // The result is memoized if |node| is in the cache.
   SENode* SimplifyExpression(SENode* node);
 
-  // Add |prospective_node| into the cache and return a raw pointer to it. If
-  // |prospective_node| is already in the cache just return the raw pointer.
-  SENode* GetCachedOrAdd(std::unique_ptr<SENode> prospective_node);
+  // Allocates a new node of type |NodeType|, constructed from this analysis
+  // and |args|. The analysis owns the node. It is not in the cache until it is
+  // passed to GetCachedOrAdd.
+  template <typename NodeType, typename... Args>
+  NodeType* NewNode(Args&&... args);
+
+  // Return the node of the cache equal to |prospective_node|, which must come
+  // from NewNode, adding |prospective_node| to the cache if there is none. If
+  // there is one and |prospective_node| is the last node allocated, its memory
+  // is reused for the next node, so it must not be used anymore.
+  SENode* GetCachedOrAdd(SENode* prospective_node);
+
+  // Discards the memoized results of AnalyzeInstruction which may depend on
+  // |loop|: those of the instructions in |loop|, and those referring to its
+  // recurrent expressions or to the loops nested in it. Must be called once
+  // |loop| is transformed, before analyzing instructions again. The nodes
+  // themselves remain valid.
+  void InvalidateLoop(const ir::Loop* loop);
 
   // Checks that the graph starting from |node| is invariant to the |loop|.
   bool IsLoopInvariant(const ir::Loop* loop, const SENode* node) const;
@@ -120,6 +150,14 @@ class ScalarEvolutionAnalysis {
 
   SENode* UpdateChildNode(SENode* parent, SENode* child, SENode* new_child);
 
+  // Makes the analysis build the recurrent expressions of the induction
+  // variables of every loop in |loops| as if they belonged to the first loop of
+  // |loops|. This allows comparing the subscripts of two loops which iterate
+  // over the same space as if they were in the same loop, e.g. to check if
+  // fusing them is legal. Must be called before any instruction of those loops
+  // is analyzed.
+  void AddLoopsToPretendAreTheSame(const std::vector<const ir::Loop*>& loops);
+
  private:
   SENode* AnalyzeConstant(const ir::Instruction* inst);
 
@@ -132,34 +170,77 @@ class ScalarEvolutionAnalysis {
 
   SENode* AnalyzePhiInstruction(const ir::Instruction* phi);
 
+  // Return memory for a node of |size| bytes at the end of the last block,
+  // allocating a new block if needed.
+  void* AllocateNode(size_t size);
+
+  // Destroys the last node allocated, whose memory is reused for the next one.
+  void ReleaseLastNode();
+
   ir::IRContext* context_;
 
-  // A map of instructions to SENodes. This is used to track recurrent
-  // expressions as they are added when analyzing instructions. Recurrent
-  // expressions come from phi nodes which by nature can include recursion so we
-  // check if nodes have already been built when analyzing instructions.
-  std::map<const ir::Instruction*, SENode*> recurrent_node_map_;
+  // A map of instructions to SENodes, memoizing AnalyzeInstruction. It is also
+  // used to track recurrent expressions as they are added when analyzing
+  // instructions. Recurrent expressions come from phi nodes which by nature can
+  // include recursion so we check if nodes have already been built when
+  // analyzing instructions.
+  std::unordered_map<const ir::Instruction*, SENode*> analyzed_instructions_;
+
+  // The modification epoch of the context when |analyzed_instructions_| was
+  // last valid.
+  uint32_t analyzed_epoch_ = 0;
+
+  // The number of phis being analyzed. The nodes built meanwhile may refer to
+  // the incomplete recurrent expression of a phi, so they are not memoized.
+  uint32_t phis_in_progress_ = 0;
+
+  // Memoizes SimplifyExpression for the nodes in the cache.
+  std::unordered_map<const SENode*, SENode*> simplified_nodes_;
+
+  // The constant and value unknown nodes, by value and by result id. Those
+  // leaves are looked up there before they are allocated.
+  std::unordered_map<int64_t, SENode*> constant_nodes_;
+  std::unordered_map<uint32_t, SENode*> value_unknown_nodes_;
+
+  // Maps a loop to the loop its recurrent expressions are attributed to. See
+  // AddLoopsToPretendAreTheSame.
+  std::map<const ir::Loop*, const ir::Loop*> pretend_equal_;
 
   // On creation we create and cache the CantCompute node so we not need to
   // perform a needless create step.
   SENode* cached_cant_compute_;
 
-  // Helper functor to allow two unique_ptr to nodes to be compare. Only
-  // needed
-  // for the unordered_set implementation.
+  // Helper functor to allow two pointers to nodes to be compare. Only
+  // needed for the unordered_set implementation.
   struct NodePointersEquality {
-    bool operator()(const std::unique_ptr<SENode>& lhs,
-                    const std::unique_ptr<SENode>& rhs) const {
+    bool operator()(const SENode* lhs, const SENode* rhs) const {
       return *lhs == *rhs;
     }
   };
 
-  // Cache of nodes. All pointers to the nodes are references to the memory
-  // managed by they set.
-  std::unordered_set<std::unique_ptr<SENode>, SENodeHash, NodePointersEquality>
-      node_cache_;
+  // Cache of nodes, other than the constants and value unknowns.
+  std::unordered_set<SENode*, SENodeHash, NodePointersEquality> node_cache_;
+
+  // The size of the blocks in which the nodes are allocated.
+  static const size_t kNodeBlockSize = 16 * 1024;
+
+  // The blocks in which the nodes are allocated, and the number of bytes used
+  // in the last one.
+  std::vector<std::unique_ptr<char[]>> node_blocks_;
+  size_t last_block_used_ = kNodeBlockSize;
+
+  // All the nodes allocated, in order, to destroy them with the analysis.
+  std::vector<SENode*> nodes_;
 };
 
+template <typename NodeType, typename... Args>
+NodeType* ScalarEvolutionAnalysis::NewNode(Args&&... args) {
+  NodeType* node = new (AllocateNode(sizeof(NodeType)))
+      NodeType(this, std::forward<Args>(args)...);
+  nodes_.push_back(node);
+  return node;
+}
+
 // Wrapping class to manipulate SENode pointer using + - * / operators.
 class SExpression {
  public:
@@ -190,11 +190,20 @@ class SENode {
     return parent_analysis_;
   }
 
+  // Return true if this node is in the cache of its analysis. Such nodes must
+  // not be modified anymore.
+  bool IsCached() const { return is_cached_; }
+
  protected:
+  friend class ScalarEvolutionAnalysis;
+
   ChildContainerType children_;
 
   opt::ScalarEvolutionAnalysis* parent_analysis_;
 
+  // Whether the node is in the cache of |parent_analysis_|.
+  bool is_cached_ = false;
+
   // The unique id of this node, assigned on creation by incrementing the static
   // node count.
   uint32_t unique_id_;
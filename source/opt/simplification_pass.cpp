@@ -28,7 +28,8 @@ Pass::Status SimplificationPass::Process(ir::IRContext* c) {
   bool modified = false;
 
   for (ir::Function& function : *get_module()) {
-    modified |= SimplifyFunction(&function);
+    if (IsFunctionSettled(&function)) continue;
+    modified |= RecordFunctionResult(&function, SimplifyFunction(&function));
   }
   return (modified ? Status::SuccessWithChange : Status::SuccessWithoutChange);
 }
@@ -27,6 +27,7 @@ class SimplificationPass : public Pass {
  public:
   const char* name() const override { return "simplify-instructions"; }
   Status Process(ir::IRContext*) override;
+  bool RecordsFunctionChanges() const override { return true; }
   virtual ir::IRContext::Analysis GetPreservedAnalyses() override {
     return ir::IRContext::kAnalysisDefUse |
            ir::IRContext::kAnalysisInstrToBlockMapping |
@@ -0,0 +1,332 @@
+// Copyright (c) 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "uniform_load_elim_pass.h"
+
+#include <map>
+
+#include "ir_builder.h"
+#include "memory_ssa.h"
+
+namespace spvtools {
+namespace opt {
+
+namespace {
+const uint32_t kLoadPtrInIdx = 0;
+const uint32_t kLoadMemoryAccessInIdx = 1;
+const uint32_t kAccessChainPtrInIdx = 0;
+const uint32_t kVariableStorageClassInIdx = 0;
+const uint32_t kPointerTypePointeeInIdx = 1;
+const uint32_t kConstantValueInIdx = 0;
+const uint32_t kElementTypeInIdx = 0;
+const uint32_t kArrayLengthInIdx = 1;
+const uint32_t kComponentCountInIdx = 1;
+}  // namespace
+
+Pass::Status UniformLoadElimPass::Process(ir::IRContext* c) {
+  InitializeProcessing(c);
+
+  // Moving loads relies on structured control flow and logical addressing.
+  if (!context()->get_feature_mgr()->HasCapability(SpvCapabilityShader) ||
+      context()->get_feature_mgr()->HasCapability(SpvCapabilityAddresses)) {
+    return Status::SuccessWithoutChange;
+  }
+
+  bool modified = false;
+  for (auto& func : *get_module()) {
+    if (IsFunctionSettled(&func)) continue;
+    if (RecordFunctionResult(&func, ProcessFunction(&func))) modified = true;
+  }
+  return modified ? Status::SuccessWithChange : Status::SuccessWithoutChange;
+}
+
+bool UniformLoadElimPass::ProcessFunction(ir::Function* func) {
+  if (func->begin() == func->end()) return false;
+
+  DominatorAnalysis* dominators = context()->GetDominatorAnalysis(func);
+
+  // With barriers, loads of buffers are only commoned within a block, between
+  // two barriers.
+  bool has_barrier = false;
+  func->ForEachInst([this, &has_barrier](ir::Instruction* inst) {
+    if (IsBarrier(*inst)) has_barrier = true;
+  });
+
+  // The loads that are kept, for each key.  Blocks are laid out after their
+  // dominators, so a load is visited after the loads that dominate it.
+  std::map<std::vector<uint32_t>, std::vector<ir::Instruction*>> kept_loads;
+  std::vector<ir::Instruction*> dead_loads;
+  for (ir::BasicBlock& bb : *func) {
+    for (ir::Instruction& inst : bb) {
+      if (IsBarrier(inst)) {
+        for (auto it = kept_loads.begin(); it != kept_loads.end();) {
+          ir::Instruction* var = get_def_use_mgr()->GetDef(it->first[0]);
+          switch (var->GetSingleWordInOperand(kVariableStorageClassInIdx)) {
+            case SpvStorageClassUniform:
+            case SpvStorageClassStorageBuffer:
+              it = kept_loads.erase(it);
+              break;
+            default:
+              ++it;
+              break;
+          }
+        }
+        continue;
+      }
+      if (inst.opcode() != SpvOpLoad) continue;
+      ReadOnlyLoad info;
+      if (!GetReadOnlyLoad(&inst, &info)) continue;
+      if (info.buffer && has_barrier) info.block_local = true;
+
+      std::vector<ir::Instruction*>& loads = kept_loads[info.key];
+      ir::Instruction* replacement = nullptr;
+      for (ir::Instruction*& kept : loads) {
+        if (info.block_local) {
+          if (context()->get_instr_block(kept) == &bb) replacement = kept;
+        } else if (dominators->Dominates(kept, &inst)) {
+          replacement = kept;
+        } else if (ir::Instruction* hoisted =
+                       HoistToCommonDominator(func, kept, &inst, info)) {
+          context()->ReplaceAllUsesWith(kept->result_id(),
+                                        hoisted->result_id());
+          dead_loads.push_back(kept);
+          kept = hoisted;
+          replacement = hoisted;
+        }
+        if (replacement != nullptr) break;
+      }
+
+      if (replacement == nullptr) {
+        loads.push_back(&inst);
+        continue;
+      }
+      context()->ReplaceAllUsesWith(inst.result_id(),
+                                    replacement->result_id());
+      dead_loads.push_back(&inst);
+    }
+  }
+
+  for (ir::Instruction* load : dead_loads) KillLoadAndPointer(load);
+  return !dead_loads.empty();
+}
+
+bool UniformLoadElimPass::GetReadOnlyLoad(ir::Instruction* load,
+                                          ReadOnlyLoad* info) {
+  if (load->NumInOperands() > kLoadMemoryAccessInIdx &&
+      (load->GetSingleWordInOperand(kLoadMemoryAccessInIdx) &
+       SpvMemoryAccessVolatileMask) != 0) {
+    return false;
+  }
+
+  // Decorations such as RelaxedPrecision or NonUniformEXT would have to match
+  // between the loads that are commoned, so decorated loads and access
+  // chains are left alone.
+  analysis::DecorationManager* decoration_mgr = get_decoration_mgr();
+  if (!decoration_mgr->GetDecorationsFor(load->result_id(), false).empty()) {
+    return false;
+  }
+
+  // The indices of the access chains, from the last one.
+  std::vector<uint32_t> indices;
+  ir::Instruction* pointer =
+      get_def_use_mgr()->GetDef(load->GetSingleWordInOperand(kLoadPtrInIdx));
+  while (pointer->opcode() == SpvOpAccessChain ||
+         pointer->opcode() == SpvOpInBoundsAccessChain) {
+    if (!decoration_mgr->GetDecorationsFor(pointer->result_id(), false)
+             .empty()) {
+      return false;
+    }
+    for (uint32_t i = pointer->NumInOperands() - 1; i > kAccessChainPtrInIdx;
+         --i) {
+      indices.push_back(pointer->GetSingleWordInOperand(i));
+    }
+    pointer = get_def_use_mgr()->GetDef(
+        pointer->GetSingleWordInOperand(kAccessChainPtrInIdx));
+  }
+  if (pointer->opcode() != SpvOpVariable) return false;
+
+  switch (pointer->GetSingleWordInOperand(kVariableStorageClassInIdx)) {
+    case SpvStorageClassUniform:
+    case SpvStorageClassStorageBuffer:
+      info->buffer = true;
+      break;
+    case SpvStorageClassUniformConstant:
+    case SpvStorageClassPushConstant:
+      info->buffer = false;
+      break;
+    default:
+      return false;
+  }
+  if (!IsReadOnlyVariable(context(), pointer)) return false;
+
+  analysis::ConstantManager* const_mgr = context()->get_constant_mgr();
+  ir::Instruction* type = get_def_use_mgr()->GetDef(
+      get_def_use_mgr()
+          ->GetDef(pointer->type_id())
+          ->GetSingleWordInOperand(kPointerTypePointeeInIdx));
+  info->key.assign(1, pointer->result_id());
+  info->can_speculate = true;
+  for (auto it = indices.rbegin(); it != indices.rend(); ++it) {
+    uint32_t index_id = *it;
+    const analysis::Constant* index = const_mgr->FindDeclaredConstant(*it);
+    if (index == nullptr) {
+      info->can_speculate = false;
+    } else if (uint32_t declared_id = const_mgr->FindDeclaredConstant(index)) {
+      index_id = declared_id;
+    }
+    info->key.push_back(index_id);
+
+    uint32_t element_type_id = 0;
+    switch (type->opcode()) {
+      case SpvOpTypeStruct: {
+        ir::Instruction* member = get_def_use_mgr()->GetDef(*it);
+        if (member->opcode() != SpvOpConstant) return false;
+        element_type_id = type->GetSingleWordInOperand(
+            member->GetSingleWordInOperand(kConstantValueInIdx));
+        break;
+      }
+      case SpvOpTypeRuntimeArray:
+        info->can_speculate = false;
+        element_type_id = type->GetSingleWordInOperand(kElementTypeInIdx);
+        break;
+      default:
+        if (index == nullptr || !IsIndexInBounds(type, index)) {
+          info->can_speculate = false;
+        }
+        element_type_id = type->GetSingleWordInOperand(kElementTypeInIdx);
+        break;
+    }
+    type = get_def_use_mgr()->GetDef(element_type_id);
+  }
+
+  switch (type->opcode()) {
+    case SpvOpTypeImage:
+    case SpvOpTypeSampler:
+    case SpvOpTypeSampledImage:
+      info->block_local = true;
+      break;
+    default:
+      info->block_local = false;
+      break;
+  }
+  return true;
+}
+
+bool UniformLoadElimPass::IsBarrier(const ir::Instruction& inst) const {
+  switch (inst.opcode()) {
+    case SpvOpControlBarrier:
+    case SpvOpMemoryBarrier:
+    case SpvOpFunctionCall:
+      return true;
+    default:
+      return inst.IsAtomicOp();
+  }
+}
+
+bool UniformLoadElimPass::IsIndexInBounds(const ir::Instruction* type,
+                                          const analysis::Constant* index) {
+  uint64_t size = 0;
+  switch (type->opcode()) {
+    case SpvOpTypeArray: {
+      const analysis::Constant* length =
+          context()->get_constant_mgr()->FindDeclaredConstant(
+              type->GetSingleWordInOperand(kArrayLengthInIdx));
+      if (length == nullptr || length->AsIntConstant() == nullptr) {
+        return false;
+      }
+      size = length->AsIntConstant()->words().size() == 1
+                 ? length->AsIntConstant()->GetU32BitValue()
+                 : length->AsIntConstant()->GetU64BitValue();
+      break;
+    }
+    case SpvOpTypeVector:
+    case SpvOpTypeMatrix:
+      size = type->GetSingleWordInOperand(kComponentCountInIdx);
+      break;
+    default:
+      return false;
+  }
+
+  if (index->AsNullConstant() != nullptr) return size > 0;
+  const analysis::IntConstant* int_index = index->AsIntConstant();
+  if (int_index == nullptr) return false;
+  const bool is_signed = index->type()->AsInteger()->IsSigned();
+  if (int_index->words().size() == 1) {
+    if (is_signed && int_index->GetS32BitValue() < 0) return false;
+    return int_index->GetU32BitValue() < size;
+  }
+  if (is_signed && int_index->GetS64BitValue() < 0) return false;
+  return int_index->GetU64BitValue() < size;
+}
+
+ir::Instruction* UniformLoadElimPass::HoistToCommonDominator(
+    ir::Function* func, ir::Instruction* kept, ir::Instruction* load,
+    const ReadOnlyLoad& info) {
+  if (!info.can_speculate) return nullptr;
+
+  ir::BasicBlock* kept_block = context()->get_instr_block(kept);
+  ir::BasicBlock* load_block = context()->get_instr_block(load);
+  ir::BasicBlock* target =
+      context()->GetDominatorAnalysis(func)->CommonDominator(kept_block,
+                                                             load_block);
+  if (target == nullptr) return nullptr;
+
+  // The load is never moved out of a loop.  A header outside of the loop
+  // runs the load on every path, including those that never enter the loop.
+  ir::LoopDescriptor* loops = context()->GetLoopDescriptor(func);
+  ir::Loop* loop = (*loops)[target];
+  if ((*loops)[kept_block] != loop || (*loops)[load_block] != loop) {
+    return nullptr;
+  }
+
+  // The new load goes before the merge instruction of a header, so that the
+  // merge instruction stays next to the branch.
+  ir::Instruction* insert_before = target->GetMergeInst();
+  if (insert_before == nullptr) insert_before = &*target->tail();
+  InstructionBuilder builder(context(), insert_before,
+                             ir::IRContext::kAnalysisDefUse |
+                                 ir::IRContext::kAnalysisInstrToBlockMapping);
+  uint32_t pointer_id = info.key[0];
+  if (info.key.size() > 1) {
+    const uint32_t pointer_type_id =
+        get_def_use_mgr()
+            ->GetDef(kept->GetSingleWordInOperand(kLoadPtrInIdx))
+            ->type_id();
+    pointer_id = builder
+                     .AddAccessChain(pointer_type_id, info.key[0],
+                                     std::vector<uint32_t>(info.key.begin() + 1,
+                                                           info.key.end()))
+                     ->result_id();
+  }
+  std::unique_ptr<ir::Instruction> new_load(kept->Clone(context()));
+  new_load->SetResultId(TakeNextId());
+  new_load->SetInOperand(kLoadPtrInIdx, {pointer_id});
+  return builder.AddInstruction(std::move(new_load));
+}
+
+void UniformLoadElimPass::KillLoadAndPointer(ir::Instruction* load) {
+  uint32_t pointer_id = load->GetSingleWordInOperand(kLoadPtrInIdx);
+  context()->KillInst(load);
+  ir::Instruction* pointer = get_def_use_mgr()->GetDef(pointer_id);
+  while ((pointer->opcode() == SpvOpAccessChain ||
+          pointer->opcode() == SpvOpInBoundsAccessChain) &&
+         get_def_use_mgr()->NumUsers(pointer) == 0) {
+    pointer_id = pointer->GetSingleWordInOperand(kAccessChainPtrInIdx);
+    context()->KillInst(pointer);
+    pointer = get_def_use_mgr()->GetDef(pointer_id);
+  }
+}
+
+}  // namespace opt
+}  // namespace spvtools
@@ -0,0 +1,106 @@
+// Copyright (c) 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef LIBSPIRV_OPT_UNIFORM_LOAD_ELIM_PASS_H_
+#define LIBSPIRV_OPT_UNIFORM_LOAD_ELIM_PASS_H_
+
+#include <vector>
+
+#include "ir_context.h"
+#include "pass.h"
+
+namespace spvtools {
+namespace opt {
+
+// See optimizer.hpp for documentation.
+class UniformLoadElimPass : public Pass {
+ public:
+  const char* name() const override { return "eliminate-uniform-loads"; }
+  Status Process(ir::IRContext* c) override;
+  bool RecordsFunctionChanges() const override { return true; }
+
+  ir::IRContext::Analysis GetPreservedAnalyses() override {
+    return ir::IRContext::kAnalysisDefUse | ir::IRContext::kAnalysisCFG |
+           ir::IRContext::kAnalysisInstrToBlockMapping |
+           ir::IRContext::kAnalysisLoopAnalysis |
+           ir::IRContext::kAnalysisDecorations |
+           ir::IRContext::kAnalysisCombinators |
+           ir::IRContext::kAnalysisDominatorAnalysis |
+           ir::IRContext::kAnalysisNameMap;
+  }
+
+ private:
+  // What a load of read-only memory reads.
+  struct ReadOnlyLoad {
+    // The variable and the indices of the access chains leading from it to
+    // the pointer of the load.  Constant indices are replaced by the first
+    // declared constant of the same value, so equal keys read the same
+    // memory.
+    std::vector<uint32_t> key;
+
+    // True if the load may be moved to a block where it is not executed
+    // today: all the indices are constants within the bounds of the arrays,
+    // vectors and matrices they index, and none of them indexes a runtime
+    // array, so the load cannot read outside of the variable.
+    bool can_speculate = false;
+
+    // True if the load may only be replaced by a load in the same block: it
+    // is of an image or sampler, or it reads a buffer in a function with
+    // barriers.
+    bool block_local = false;
+
+    // True if the load reads Uniform or StorageBuffer memory.  Other
+    // invocations may write it through an aliased binding, and a barrier may
+    // make their writes visible.
+    bool buffer = false;
+  };
+
+  // Removes the redundant loads of read-only memory from |func|.  Returns
+  // true if |func| is modified.
+  bool ProcessFunction(ir::Function* func);
+
+  // Returns true if |inst| may make writes of other invocations to buffers
+  // visible: it is a barrier, an atomic, or a call to a function which may
+  // contain one.  Loads of buffers are not commoned across such instructions.
+  bool IsBarrier(const ir::Instruction& inst) const;
+
+  // Returns true if |index| is a constant within the bounds of the array,
+  // vector or matrix |type|.
+  bool IsIndexInBounds(const ir::Instruction* type,
+                       const analysis::Constant* index);
+
+  // Returns true and fills |info| if |load| is a non-volatile load of
+  // read-only uniform, push constant or storage buffer memory that can be
+  // commoned.
+  bool GetReadOnlyLoad(ir::Instruction* load, ReadOnlyLoad* info);
+
+  // Returns the load that replaces the loads |kept| and |load| of |info|,
+  // neither of which dominates the other, placed in the nearest block that
+  // dominates both.  Returns null if the load cannot be moved there: the
+  // load may not be speculated, or the block is in a different loop than
+  // either load.
+  ir::Instruction* HoistToCommonDominator(ir::Function* func,
+                                          ir::Instruction* kept,
+                                          ir::Instruction* load,
+                                          const ReadOnlyLoad& info);
+
+  // Kills |load| and the access chains computing its pointer that have no
+  // other use.
+  void KillLoadAndPointer(ir::Instruction* load);
+};
+
+}  // namespace opt
+}  // namespace spvtools
+
+#endif  // LIBSPIRV_OPT_UNIFORM_LOAD_ELIM_PASS_H_
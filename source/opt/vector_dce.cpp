@@ -27,7 +27,8 @@ Pass::Status VectorDCE::Process(ir::IRContext* ctx) {
 
   bool modified = false;
   for (ir::Function& function : *get_module()) {
-    modified |= VectorDCEFunction(&function);
+    if (IsFunctionSettled(&function)) continue;
+    modified |= RecordFunctionResult(&function, VectorDCEFunction(&function));
   }
   return (modified ? Status::SuccessWithChange : Status::SuccessWithoutChange);
 }
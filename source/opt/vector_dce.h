@@ -39,6 +39,7 @@ class VectorDCE : public MemPass {
  public:
   const char* name() const override { return "vector-dce"; }
   Status Process(ir::IRContext*) override;
+  bool RecordsFunctionChanges() const override { return true; }
 
   VectorDCE() : all_components_live_(kMaxVectorSize) {
     for (uint32_t i = 0; i < kMaxVectorSize; i++) {
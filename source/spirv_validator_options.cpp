@@ -86,3 +86,8 @@ void spvValidatorOptionsSetRelaxLogicalPointer(spv_validator_options options,
                                                bool val) {
   options->relax_logcial_pointer = val;
 }
+
+void spvValidatorOptionsSetNumThreads(spv_validator_options options,
+                                      uint32_t num_threads) {
+  options->num_threads = num_threads ? num_threads : 1;
+}
@@ -15,6 +15,8 @@
 #ifndef LIBSPIRV_SPIRV_VALIDATOR_OPTIONS_H_
 #define LIBSPIRV_SPIRV_VALIDATOR_OPTIONS_H_
 
+#include <iosfwd>
+
 #include "spirv-tools/libspirv.h"
 
 // Return true if the command line option for the validator limit is valid (Also
@@ -40,11 +42,17 @@ struct spv_validator_options_t {
   spv_validator_options_t()
       : universal_limits_(),
         relax_struct_store(false),
-        relax_logcial_pointer(false) {}
+        relax_logcial_pointer(false),
+        num_threads(1),
+        time_report_stream(nullptr) {}
 
   validator_universal_limits_t universal_limits_;
   bool relax_struct_store;
   bool relax_logcial_pointer;
+  uint32_t num_threads;
+  // The stream to which the resource usage of the validation stages is
+  // reported, or nullptr if it is not reported.
+  std::ostream* time_report_stream;
 };
 
 #endif  // LIBSPIRV_SPIRV_VALIDATOR_OPTIONS_H_
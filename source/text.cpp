@@ -563,6 +563,8 @@ spv_result_t spvTextEncodeOpcode(const libspirv::AssemblyGrammar& grammar,
     expectedOperands.push_back(
         opcodeEntry->operandTypes[opcodeEntry->numTypes - i - 1]);
 
+  // Reused for all the operands, so that long words are not allocated again.
+  std::string operandValue;
   while (!expectedOperands.empty()) {
     const spv_operand_type_t type = expectedOperands.back();
     expectedOperands.pop_back();
@@ -606,7 +608,6 @@ spv_result_t spvTextEncodeOpcode(const libspirv::AssemblyGrammar& grammar,
         }
       }
 
-      std::string operandValue;
       error = context->getWord(&operandValue, &nextPosition);
       if (error) return context->diagnostic(error) << "Internal Error";
 
@@ -649,6 +650,19 @@ spv_result_t spvTextEncodeOpcode(const libspirv::AssemblyGrammar& grammar,
 
 enum { kAssemblerVersion = 0 };
 
+// Typical number of characters of assembly text per encoded word, used to
+// size the binary before assembling.
+const size_t kTextBytesPerWord = 8;
+
+// Clears |inst| so it can hold the next instruction, keeping the storage of
+// its words.
+void ResetInstruction(spv_instruction_t* inst) {
+  inst->opcode = SpvOpNop;
+  inst->extInstType = SPV_EXT_INST_TYPE_NONE;
+  inst->resultTypeId = 0;
+  inst->words.clear();
+}
+
 // Populates a binary stream's |header|. The target environment is specified via
 // |env| and Id bound is via |bound|.
 spv_result_t SetHeader(spv_target_env env, const uint32_t bound,
@@ -682,8 +696,9 @@ spv_result_t GetNumericIds(const libspirv::AssemblyGrammar& grammar,
   // Skip past whitespace and comments.
   context.advance();
 
+  spv_instruction_t inst = {};
   while (context.hasText()) {
-    spv_instruction_t inst;
+    ResetInstruction(&inst);
 
     if (spvTextEncodeOpcode(grammar, &context, &inst)) {
       return SPV_ERROR_INVALID_TEXT;
@@ -724,45 +739,43 @@ spv_result_t spvTextToBinaryInternal(const libspirv::AssemblyGrammar& grammar,
   }
   if (!pBinary) return SPV_ERROR_INVALID_POINTER;
 
-  std::vector<spv_instruction_t> instructions;
+  // Each instruction is encoded into |inst|, whose storage is reused, then
+  // appended to |data|. |data| starts with room for the header and grows
+  // geometrically, and is handed over to the binary as is.
+  size_t capacity = SPV_INDEX_INSTRUCTION + text->length / kTextBytesPerWord;
+  std::unique_ptr<uint32_t[]> data(new uint32_t[capacity]);
+  size_t totalSize = SPV_INDEX_INSTRUCTION;
+  spv_instruction_t inst = {};
 
   // Skip past whitespace and comments.
   context.advance();
 
   while (context.hasText()) {
-    instructions.push_back({});
-    spv_instruction_t& inst = instructions.back();
+    ResetInstruction(&inst);
 
     if (spvTextEncodeOpcode(grammar, &context, &inst)) {
       return SPV_ERROR_INVALID_TEXT;
     }
 
-    if (context.advance()) break;
-  }
-
-  size_t totalSize = SPV_INDEX_INSTRUCTION;
-  for (auto& inst : instructions) {
+    if (totalSize + inst.words.size() > capacity) {
+      capacity = std::max(2 * capacity, totalSize + inst.words.size());
+      std::unique_ptr<uint32_t[]> grown(new uint32_t[capacity]);
+      memcpy(grown.get(), data.get(), sizeof(uint32_t) * totalSize);
+      data = std::move(grown);
+    }
+    memcpy(data.get() + totalSize, inst.words.data(),
+           sizeof(uint32_t) * inst.words.size());
     totalSize += inst.words.size();
-  }
 
-  uint32_t* data = new uint32_t[totalSize];
-  if (!data) return SPV_ERROR_OUT_OF_MEMORY;
-  uint64_t currentIndex = SPV_INDEX_INSTRUCTION;
-  for (auto& inst : instructions) {
-    memcpy(data + currentIndex, inst.words.data(),
-           sizeof(uint32_t) * inst.words.size());
-    currentIndex += inst.words.size();
+    if (context.advance()) break;
   }
 
-  if (auto error = SetHeader(grammar.target_env(), context.getBound(), data))
+  if (auto error =
+          SetHeader(grammar.target_env(), context.getBound(), data.get()))
     return error;
 
   spv_binary binary = new spv_binary_t();
-  if (!binary) {
-    delete[] data;
-    return SPV_ERROR_OUT_OF_MEMORY;
-  }
-  binary->code = data;
+  binary->code = data.release();
   binary->wordCount = totalSize;
 
   *pBinary = binary;
@@ -34,76 +34,96 @@ namespace {
 // Advances |text| to the start of the next line and writes the new position to
 // |position|.
 spv_result_t advanceLine(spv_text text, spv_position position) {
+  if (position->index >= text->length) return SPV_END_OF_STREAM;
+  const char* begin = text->str + position->index;
+  const size_t remaining = text->length - position->index;
+
+  // Comments can be long, let memchr scan them.
+  const char* newline =
+      static_cast<const char*>(memchr(begin, '\n', remaining));
+  const size_t line_length = newline ? size_t(newline - begin) : remaining;
+  if (const char* null_terminator =
+          static_cast<const char*>(memchr(begin, '\0', line_length))) {
+    const size_t skipped = size_t(null_terminator - begin);
+    position->column += skipped;
+    position->index += skipped;
+    return SPV_END_OF_STREAM;
+  }
+  if (!newline) {
+    position->column += remaining;
+    position->index += remaining;
+    return SPV_END_OF_STREAM;
+  }
+
+  position->column = 0;
+  position->line++;
+  position->index += line_length + 1;
+  return SPV_SUCCESS;
+}
+
+// Returns the number of consecutive spaces at |begin|, looking at no more than
+// |length| characters. Indentation makes long runs of spaces common, so they
+// are checked eight at a time.
+size_t countSpaces(const char* begin, size_t length) {
+  const uint64_t kEightSpaces = 0x2020202020202020ull;
+  size_t count = 0;
+  while (count + sizeof(uint64_t) <= length) {
+    uint64_t chunk;
+    memcpy(&chunk, begin + count, sizeof(chunk));
+    if (chunk != kEightSpaces) break;
+    count += sizeof(uint64_t);
+  }
+  while (count < length && begin[count] == ' ') ++count;
+  return count;
+}
+
+// Advances |text| to first non white space character and writes the new
+// position to |position|.
+// If a null terminator is found during the text advance, SPV_END_OF_STREAM is
+// returned, SPV_SUCCESS otherwise. No error checking is performed on the
+// parameters, its the users responsibility to ensure these are non null.
+spv_result_t advance(spv_text text, spv_position position) {
+  // NOTE: Consume white space, otherwise don't advance.
   while (true) {
     if (position->index >= text->length) return SPV_END_OF_STREAM;
     switch (text->str[position->index]) {
       case '\0':
         return SPV_END_OF_STREAM;
+      case ';':
+        if (spv_result_t error = advanceLine(text, position)) return error;
+        break;
+      case ' ': {
+        const size_t spaces = countSpaces(text->str + position->index,
+                                          text->length - position->index);
+        position->column += spaces;
+        position->index += spaces;
+      } break;
+      case '\t':
+      case '\r':
+        position->column++;
+        position->index++;
+        break;
       case '\n':
         position->column = 0;
         position->line++;
         position->index++;
-        return SPV_SUCCESS;
-      default:
-        position->column++;
-        position->index++;
         break;
+      default:
+        return SPV_SUCCESS;
     }
   }
 }
 
-// Advances |text| to first non white space character and writes the new
-// position to |position|.
-// If a null terminator is found during the text advance, SPV_END_OF_STREAM is
-// returned, SPV_SUCCESS otherwise. No error checking is performed on the
-// parameters, its the users responsibility to ensure these are non null.
-spv_result_t advance(spv_text text, spv_position position) {
-  // NOTE: Consume white space, otherwise don't advance.
-  if (position->index >= text->length) return SPV_END_OF_STREAM;
-  switch (text->str[position->index]) {
-    case '\0':
-      return SPV_END_OF_STREAM;
-    case ';':
-      if (spv_result_t error = advanceLine(text, position)) return error;
-      return advance(text, position);
-    case ' ':
-    case '\t':
-    case '\r':
-      position->column++;
-      position->index++;
-      return advance(text, position);
-    case '\n':
-      position->column = 0;
-      position->line++;
-      position->index++;
-      return advance(text, position);
-    default:
-      break;
-  }
-  return SPV_SUCCESS;
-}
-
-// Fetches the next word from the given text stream starting from the given
-// *position. On success, writes the decoded word into *word and updates
-// *position to the location past the returned word.
+// Moves *position past the word starting at it, without copying the word.
 //
 // A word ends at the next comment or whitespace.  However, double-quoted
 // strings remain intact, and a backslash always escapes the next character.
-spv_result_t getWord(spv_text text, spv_position position, std::string* word) {
-  if (!text->str || !text->length) return SPV_ERROR_INVALID_TEXT;
-  if (!position) return SPV_ERROR_INVALID_POINTER;
-
-  const size_t start_index = position->index;
-
+void skipWord(spv_text text, spv_position position) {
   bool quoting = false;
   bool escaping = false;
 
   // NOTE: Assumes first character is not white space!
-  while (true) {
-    if (position->index >= text->length) {
-      word->assign(text->str + start_index, text->str + position->index);
-      return SPV_SUCCESS;
-    }
+  while (position->index < text->length) {
     const char ch = text->str[position->index];
     if (ch == '\\')
       escaping = !escaping;
@@ -119,10 +139,8 @@ spv_result_t getWord(spv_text text, spv_position position, std::string* word) {
         case '\r':
           if (escaping || quoting) break;
         // Fall through.
-        case '\0': {  // NOTE: End of word found!
-          word->assign(text->str + start_index, text->str + position->index);
-          return SPV_SUCCESS;
-        }
+        case '\0':  // NOTE: End of word found!
+          return;
         default:
           break;
       }
@@ -134,6 +152,21 @@ spv_result_t getWord(spv_text text, spv_position position, std::string* word) {
   }
 }
 
+// Fetches the next word from the given text stream starting from the given
+// *position. On success, writes the decoded word into *word and updates
+// *position to the location past the returned word.
+//
+// See skipWord for what makes a word.
+spv_result_t getWord(spv_text text, spv_position position, std::string* word) {
+  if (!text->str || !text->length) return SPV_ERROR_INVALID_TEXT;
+  if (!position) return SPV_ERROR_INVALID_POINTER;
+
+  const size_t start_index = position->index;
+  skipWord(text, position);
+  word->assign(text->str + start_index, text->str + position->index);
+  return SPV_SUCCESS;
+}
+
 // Returns true if the characters in the text as position represent
 // the start of an Opcode.
 bool startsWithOp(spv_text text, spv_position position) {
@@ -203,14 +236,19 @@ bool AssemblyContext::isStartOfNewInst() {
   if (::advance(text_, &pos)) return false;
   if (::startsWithOp(text_, &pos)) return true;
 
-  std::string word;
+  // This is called for every operand, so the words are checked in place
+  // rather than copied out.
   pos = current_position_;
-  if (::getWord(text_, &pos, &word)) return false;
-  if ('%' != word.front()) return false;
+  if (pos.index >= text_->length || '%' != text_->str[pos.index]) return false;
+  ::skipWord(text_, &pos);
 
   if (::advance(text_, &pos)) return false;
-  if (::getWord(text_, &pos, &word)) return false;
-  if ("=" != word) return false;
+  const size_t equal_sign_index = pos.index;
+  ::skipWord(text_, &pos);
+  if (pos.index != equal_sign_index + 1 ||
+      '=' != text_->str[equal_sign_index]) {
+    return false;
+  }
 
   if (::advance(text_, &pos)) return false;
   if (::startsWithOp(text_, &pos)) return true;
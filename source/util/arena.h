@@ -0,0 +1,84 @@
+// Copyright (c) 2018 Google LLC.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef LIBSPIRV_UTIL_ARENA_H_
+#define LIBSPIRV_UTIL_ARENA_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace spvutils {
+
+// Allocates arrays of a trivially copyable type T out of large chunks, all
+// released together when the arena is destroyed.  This replaces one heap
+// allocation per array with one per chunk for many small arrays which live as
+// long as each other.  The arrays never move.
+template <typename T>
+class Arena {
+  static_assert(std::is_trivially_copyable<T>::value,
+                "Arena elements are copied without constructors");
+
+ public:
+  // Creates an arena whose chunks have room for |chunk_size| elements.
+  explicit Arena(size_t chunk_size = 4096)
+      : chunk_size_(chunk_size), next_(nullptr), available_(0), size_(0) {}
+
+  Arena(const Arena&) = delete;
+  Arena& operator=(const Arena&) = delete;
+
+  // Returns uninitialized storage for |count| contiguous elements.
+  T* Allocate(size_t count) {
+    size_ += count;
+    if (count > available_) {
+      if (count > chunk_size_ / 4) {
+        // A large array gets its own chunk, so that the rest of the current
+        // chunk is not wasted.
+        chunks_.emplace_back(new T[count]);
+        return chunks_.back().get();
+      }
+      chunks_.emplace_back(new T[chunk_size_]);
+      next_ = chunks_.back().get();
+      available_ = chunk_size_;
+    }
+    T* result = next_;
+    next_ += count;
+    available_ -= count;
+    return result;
+  }
+
+  // Returns a copy of the |count| elements at |data|.
+  T* Copy(const T* data, size_t count) {
+    T* result = Allocate(count);
+    std::copy(data, data + count, result);
+    return result;
+  }
+
+  // Returns the number of elements allocated so far.
+  size_t size() const { return size_; }
+
+ private:
+  const size_t chunk_size_;
+  std::vector<std::unique_ptr<T[]>> chunks_;
+  // The free part of the last chunk.
+  T* next_;
+  size_t available_;
+  size_t size_;
+};
+
+}  // namespace spvutils
+
+#endif  // LIBSPIRV_UTIL_ARENA_H_
@@ -0,0 +1,59 @@
+// Copyright (c) 2018 Google LLC.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef LIBSPIRV_UTIL_ARRAY_VIEW_H_
+#define LIBSPIRV_UTIL_ARRAY_VIEW_H_
+
+#include <cassert>
+#include <cstddef>
+
+namespace spvutils {
+
+// A read-only view of |size| contiguous elements of type T owned by someone
+// else, with the part of the interface of a const std::vector used to read it.
+template <typename T>
+class ArrayView {
+ public:
+  using value_type = T;
+  using size_type = size_t;
+  using const_iterator = const T*;
+  using iterator = const_iterator;
+
+  ArrayView() : data_(nullptr), size_(0) {}
+  ArrayView(const T* data, size_t size) : data_(data), size_(size) {}
+
+  const T* data() const { return data_; }
+  size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+
+  const T& operator[](size_t index) const {
+    assert(index < size_);
+    return data_[index];
+  }
+  const T& front() const { return (*this)[0]; }
+  const T& back() const { return (*this)[size_ - 1]; }
+
+  const_iterator begin() const { return data_; }
+  const_iterator end() const { return data_ + size_; }
+  const_iterator cbegin() const { return begin(); }
+  const_iterator cend() const { return end(); }
+
+ private:
+  const T* data_;
+  size_t size_;
+};
+
+}  // namespace spvutils
+
+#endif  // LIBSPIRV_UTIL_ARRAY_VIEW_H_
@@ -371,13 +371,33 @@ bool BitReaderInterface::ReadFixedWidth(uint64_t* val, uint64_t max_val) {
 }
 
 BitReaderWord64::BitReaderWord64(std::vector<uint64_t>&& buffer)
-    : buffer_(std::move(buffer)), pos_(0) {}
+    : buffer_(std::move(buffer)),
+      bytes_(nullptr),
+      num_bytes_(0),
+      num_words_(buffer_.size()),
+      pos_(0) {}
 
 BitReaderWord64::BitReaderWord64(const std::vector<uint8_t>& buffer)
-    : buffer_(ToBuffer64(buffer)), pos_(0) {}
+    : BitReaderWord64(ToBuffer64(buffer)) {}
 
 BitReaderWord64::BitReaderWord64(const void* buffer, size_t num_bytes)
-    : buffer_(ToBuffer64(buffer, num_bytes)), pos_(0) {}
+    : BitReaderWord64(ToBuffer64(buffer, num_bytes)) {}
+
+BitReaderWord64::BitReaderWord64(InPlace, const void* buffer,
+                                 size_t num_bytes)
+    : bytes_(static_cast<const uint8_t*>(buffer)),
+      num_bytes_(num_bytes),
+      num_words_((num_bytes + 7) / 8),
+      pos_(0) {}
+
+uint64_t BitReaderWord64::GetWord(size_t index) const {
+  if (!bytes_) return buffer_[index];
+  // The same bytes as ToBuffer64 would give, without the alignment.
+  uint64_t word = 0;
+  const size_t offset = index * 8;
+  memcpy(&word, bytes_ + offset, std::min<size_t>(8, num_bytes_ - offset));
+  return word;
+}
 
 size_t BitReaderWord64::ReadBits(uint64_t* bits, size_t num_bits) {
   assert(num_bits <= 64);
@@ -395,13 +415,13 @@ size_t BitReaderWord64::ReadBits(uint64_t* bits, size_t num_bits) {
 
   // Read all bits from the current word (it might be too much, but
   // excessive bits will be removed later).
-  *bits = buffer_[index] >> offset;
+  *bits = GetWord(index) >> offset;
 
   const size_t num_read_from_first_word = std::min(64 - offset, num_bits);
   pos_ += num_read_from_first_word;
 
-  if (pos_ >= buffer_.size() * 64) {
-    // Reached end of buffer_.
+  if (pos_ >= num_words_ * 64) {
+    // Reached end of the buffer.
     EmitSequence(*bits, num_read_from_first_word);
     return num_read_from_first_word;
   }
@@ -409,7 +429,7 @@ size_t BitReaderWord64::ReadBits(uint64_t* bits, size_t num_bits) {
   if (offset + num_bits > 64) {
     // Requested |num_bits| overflows to next word.
     // Write all bits from the beginning of next word to *bits after offset.
-    *bits |= buffer_[index + 1] << (64 - offset);
+    *bits |= GetWord(index + 1) << (64 - offset);
     pos_ += offset + num_bits - 64;
   }
 
@@ -419,18 +439,18 @@ size_t BitReaderWord64::ReadBits(uint64_t* bits, size_t num_bits) {
   return num_bits;
 }
 
-bool BitReaderWord64::ReachedEnd() const { return pos_ >= buffer_.size() * 64; }
+bool BitReaderWord64::ReachedEnd() const { return pos_ >= num_words_ * 64; }
 
 bool BitReaderWord64::OnlyZeroesLeft() const {
   if (ReachedEnd()) return true;
 
   const size_t index = pos_ / 64;
-  if (index < buffer_.size() - 1) return false;
+  if (index < num_words_ - 1) return false;
 
-  assert(index == buffer_.size() - 1);
+  assert(index == num_words_ - 1);
 
   const size_t offset = pos_ % 64;
-  const uint64_t remaining_bits = buffer_[index] >> offset;
+  const uint64_t remaining_bits = GetWord(index) >> offset;
   return !remaining_bits;
 }
 
@@ -401,7 +401,7 @@ class BitReaderInterface {
 
 // This class is an implementation of BitReaderInterface which accepts both
 // uint8_t and uint64_t buffers as input. uint64_t buffers are consumed and
-// owned. uint8_t buffers are copied.
+// owned. uint8_t buffers are copied, unless they are read in place.
 class BitReaderWord64 : public BitReaderInterface {
  public:
   // Consumes and owns the buffer.
@@ -413,6 +413,13 @@ class BitReaderWord64 : public BitReaderInterface {
   explicit BitReaderWord64(const std::vector<uint8_t>& buffer);
   BitReaderWord64(const void* buffer, size_t num_bytes);
 
+  // Selects the constructor reading a buffer in place.
+  struct InPlace {};
+
+  // Reads the |num_bytes| bytes at |buffer|, which are neither copied nor
+  // owned, and must outlive the reader. They need not be aligned.
+  BitReaderWord64(InPlace, const void* buffer, size_t num_bytes);
+
   size_t ReadBits(uint64_t* bits, size_t num_bits) override;
 
   size_t GetNumReadBits() const override { return pos_; }
@@ -434,7 +441,16 @@ class BitReaderWord64 : public BitReaderInterface {
   }
 
  private:
+  // Returns the word at |index|, which must be less than |num_words_|.
+  uint64_t GetWord(size_t index) const;
+
+  // The words read, if the reader owns them.
   const std::vector<uint64_t> buffer_;
+  // The bytes read, if the reader does not own them, or null.
+  const uint8_t* bytes_;
+  size_t num_bytes_;
+  // The number of words read, the last one possibly padded with zeroes.
+  size_t num_words_;
   size_t pos_;
 
   // If not null, the reader will use the callback to emit the read bit
@@ -0,0 +1,187 @@
+// Copyright (c) 2018 Google LLC.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "util/dominators.h"
+
+#include <algorithm>
+#include <cassert>
+#include <numeric>
+
+namespace spvutils {
+
+namespace {
+
+// Builds the adjacency lists of a graph of |num_nodes| nodes in compressed
+// form: the neighbours of node n are |targets|[|offsets|[n], |offsets|[n+1]),
+// in the order of |edges|.  If |forward| is false, the edges are reversed.
+void BuildAdjacency(uint32_t num_nodes,
+                    const std::vector<std::pair<uint32_t, uint32_t>>& edges,
+                    bool forward, std::vector<uint32_t>* offsets,
+                    std::vector<uint32_t>* targets) {
+  offsets->assign(num_nodes + 1, 0);
+  for (const auto& edge : edges) {
+    const uint32_t from = forward ? edge.first : edge.second;
+    assert(from < num_nodes && "Edge starts outside of the graph");
+    ++(*offsets)[from + 1];
+  }
+  std::partial_sum(offsets->begin(), offsets->end(), offsets->begin());
+
+  targets->resize(edges.size());
+  std::vector<uint32_t> next(offsets->begin(), offsets->end() - 1);
+  for (const auto& edge : edges) {
+    const uint32_t from = forward ? edge.first : edge.second;
+    const uint32_t to = forward ? edge.second : edge.first;
+    assert(to < num_nodes && "Edge ends outside of the graph");
+    (*targets)[next[from]++] = to;
+  }
+}
+
+}  // anonymous namespace
+
+const uint32_t Dominators::kNone;
+
+Dominators::Dominators(uint32_t num_nodes,
+                       const std::vector<std::pair<uint32_t, uint32_t>>& edges,
+                       uint32_t root, bool reverse)
+    : root_(root),
+      idom_(num_nodes, kNone),
+      tree_pre_(num_nodes, 0),
+      tree_post_(num_nodes, 0) {
+  assert(root < num_nodes && "The root is not in the graph");
+  std::vector<uint32_t> succ_offsets;
+  std::vector<uint32_t> succ_targets;
+  std::vector<uint32_t> pred_offsets;
+  std::vector<uint32_t> pred_targets;
+  BuildAdjacency(num_nodes, edges, !reverse, &succ_offsets, &succ_targets);
+  BuildAdjacency(num_nodes, edges, reverse, &pred_offsets, &pred_targets);
+
+  std::vector<uint32_t> dfs_number(num_nodes, kNone);
+  std::vector<uint32_t> parent;
+  DepthFirstSearch(succ_offsets, succ_targets, &dfs_number, &parent);
+  SemiNCA(pred_offsets, pred_targets, dfs_number, parent);
+  NumberTree();
+}
+
+void Dominators::DepthFirstSearch(const std::vector<uint32_t>& offsets,
+                                  const std::vector<uint32_t>& targets,
+                                  std::vector<uint32_t>* dfs_number,
+                                  std::vector<uint32_t>* parent) {
+  // The nodes of the current path, each with the position of the next
+  // successor to visit.
+  std::vector<std::pair<uint32_t, uint32_t>> stack;
+  auto visit = [this, &offsets, &stack, dfs_number, parent](uint32_t node,
+                                                            uint32_t from) {
+    (*dfs_number)[node] = static_cast<uint32_t>(preorder_.size());
+    parent->push_back(from);
+    preorder_.push_back(node);
+    stack.emplace_back(node, offsets[node]);
+  };
+
+  visit(root_, kNone);
+  while (!stack.empty()) {
+    const uint32_t node = stack.back().first;
+    uint32_t& next = stack.back().second;
+    if (next == offsets[node + 1]) {
+      postorder_.push_back(node);
+      stack.pop_back();
+      continue;
+    }
+    const uint32_t succ = targets[next++];
+    if ((*dfs_number)[succ] == kNone) visit(succ, (*dfs_number)[node]);
+  }
+}
+
+void Dominators::SemiNCA(const std::vector<uint32_t>& pred_offsets,
+                         const std::vector<uint32_t>& pred_targets,
+                         const std::vector<uint32_t>& dfs_number,
+                         const std::vector<uint32_t>& parent) {
+  // Everything below is indexed by depth first preorder number.
+  const uint32_t count = static_cast<uint32_t>(preorder_.size());
+  std::vector<uint32_t> semi(count);
+  std::vector<uint32_t> label(count);
+  std::iota(semi.begin(), semi.end(), 0);
+  std::iota(label.begin(), label.end(), 0);
+
+  // The nodes numbered above i form a forest linked by |ancestor|, which
+  // starts as the spanning tree and is shortened by path compression.
+  std::vector<uint32_t> ancestor(parent);
+  std::vector<uint32_t> path;
+  for (uint32_t i = count - 1; i > 0; --i) {
+    const uint32_t node = preorder_[i];
+    for (uint32_t k = pred_offsets[node]; k < pred_offsets[node + 1]; ++k) {
+      const uint32_t j = dfs_number[pred_targets[k]];
+      if (j == kNone) continue;
+      uint32_t candidate = j;
+      if (j > i) {
+        // Find the node of minimal semi-dominator on the path from j to the
+        // root of its tree in the forest, compressing the path on the way.
+        path.clear();
+        for (uint32_t v = j; ancestor[v] > i; v = ancestor[v]) {
+          path.push_back(v);
+        }
+        for (auto v = path.rbegin(); v != path.rend(); ++v) {
+          const uint32_t a = ancestor[*v];
+          if (semi[label[a]] < semi[label[*v]]) label[*v] = label[a];
+          ancestor[*v] = ancestor[a];
+        }
+        candidate = semi[label[j]];
+      }
+      semi[i] = std::min(semi[i], candidate);
+    }
+  }
+
+  // The immediate dominator of a node is the nearest common ancestor, in the
+  // dominator tree, of its parent and of its semi-dominator.
+  std::vector<uint32_t> idom(count, 0);
+  for (uint32_t i = 1; i < count; ++i) {
+    uint32_t dominator = parent[i];
+    while (dominator > semi[i]) dominator = idom[dominator];
+    idom[i] = dominator;
+    idom_[preorder_[i]] = preorder_[dominator];
+  }
+}
+
+void Dominators::NumberTree() {
+  const uint32_t count = num_nodes();
+  child_offsets_.assign(count + 1, 0);
+  for (uint32_t node = 0; node < count; ++node) {
+    if (idom_[node] != kNone) ++child_offsets_[idom_[node] + 1];
+  }
+  std::partial_sum(child_offsets_.begin(), child_offsets_.end(),
+                   child_offsets_.begin());
+  children_.resize(child_offsets_.back());
+  std::vector<uint32_t> next(child_offsets_.begin(), child_offsets_.end() - 1);
+  for (uint32_t node = 0; node < count; ++node) {
+    if (idom_[node] != kNone) children_[next[idom_[node]]++] = node;
+  }
+
+  uint32_t number = 0;
+  std::vector<std::pair<uint32_t, uint32_t>> stack;
+  tree_pre_[root_] = ++number;
+  stack.emplace_back(root_, child_offsets_[root_]);
+  while (!stack.empty()) {
+    const uint32_t node = stack.back().first;
+    uint32_t& next_child = stack.back().second;
+    if (next_child == child_offsets_[node + 1]) {
+      tree_post_[node] = ++number;
+      stack.pop_back();
+      continue;
+    }
+    const uint32_t child = children_[next_child++];
+    tree_pre_[child] = ++number;
+    stack.emplace_back(child, child_offsets_[child]);
+  }
+}
+
+}  // namespace spvutils
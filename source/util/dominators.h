@@ -0,0 +1,118 @@
+// Copyright (c) 2018 Google LLC.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef LIBSPIRV_UTIL_DOMINATORS_H_
+#define LIBSPIRV_UTIL_DOMINATORS_H_
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "util/array_view.h"
+
+namespace spvutils {
+
+// The dominator tree of a graph whose nodes are numbered densely from 0, as
+// seen from a root node.  It is computed with the Semi-NCA algorithm of
+// Georgiadis, "Linear-Time Algorithms for Dominators and Related Problems",
+// 2005, which runs in near-linear time and, unlike the iterative algorithm of
+// Cooper, Harvey and Kennedy, does not degrade on deep graphs such as the
+// control flow of fully unrolled loops.
+//
+// Following the edges backwards from an exit node gives the post-dominator
+// tree.  The nodes which cannot be reached from the root are not in the tree.
+class Dominators {
+ public:
+  // The index standing for no node.
+  static const uint32_t kNone = ~0u;
+
+  // Computes the dominator tree of the graph of |num_nodes| nodes whose edges
+  // are the pairs (from, to) of |edges|, from the |root| node.  If |reverse|
+  // is true, the edges are followed from their end to their start.  The
+  // successors of a node are visited in the order of |edges|.
+  Dominators(uint32_t num_nodes,
+             const std::vector<std::pair<uint32_t, uint32_t>>& edges,
+             uint32_t root, bool reverse = false);
+
+  // Returns the number of nodes of the graph.
+  uint32_t num_nodes() const { return static_cast<uint32_t>(idom_.size()); }
+
+  // Returns the root of the tree.
+  uint32_t root() const { return root_; }
+
+  // Returns true if |node| can be reached from the root.
+  bool reachable(uint32_t node) const { return tree_post_[node] != 0; }
+
+  // Returns the immediate dominator of |node|, or kNone if it is the root or
+  // is not reachable.
+  uint32_t immediate_dominator(uint32_t node) const { return idom_[node]; }
+
+  // Returns the children of |node| in the dominator tree, in increasing order.
+  spvutils::ArrayView<uint32_t> children(uint32_t node) const {
+    return {children_.data() + child_offsets_[node],
+            child_offsets_[node + 1] - child_offsets_[node]};
+  }
+
+  // Returns true if |a| dominates |b|.  Every reachable node dominates itself,
+  // and unreachable nodes neither dominate nor are dominated.
+  bool Dominates(uint32_t a, uint32_t b) const {
+    return reachable(a) && reachable(b) && tree_pre_[a] <= tree_pre_[b] &&
+           tree_post_[a] >= tree_post_[b];
+  }
+
+  // Returns the reachable nodes in depth first preorder and postorder of the
+  // graph.
+  const std::vector<uint32_t>& preorder() const { return preorder_; }
+  const std::vector<uint32_t>& postorder() const { return postorder_; }
+
+  // Returns the numbers of |node| in a depth first preorder and postorder
+  // traversal of the dominator tree, which visits the children in increasing
+  // order.  The numbers start at 1, and are 0 for an unreachable node.
+  uint32_t tree_preorder_number(uint32_t node) const {
+    return tree_pre_[node];
+  }
+  uint32_t tree_postorder_number(uint32_t node) const {
+    return tree_post_[node];
+  }
+
+ private:
+  // Finds the preorder and postorder of the graph, and the parent of each node
+  // in the depth first spanning tree, by preorder numbers.
+  void DepthFirstSearch(const std::vector<uint32_t>& offsets,
+                        const std::vector<uint32_t>& targets,
+                        std::vector<uint32_t>* dfs_number,
+                        std::vector<uint32_t>* parent);
+
+  // Computes the immediate dominators from the depth first spanning tree.
+  void SemiNCA(const std::vector<uint32_t>& pred_offsets,
+               const std::vector<uint32_t>& pred_targets,
+               const std::vector<uint32_t>& dfs_number,
+               const std::vector<uint32_t>& parent);
+
+  // Builds the children lists and numbers the nodes of the dominator tree.
+  void NumberTree();
+
+  uint32_t root_;
+  std::vector<uint32_t> idom_;
+  std::vector<uint32_t> preorder_;
+  std::vector<uint32_t> postorder_;
+  std::vector<uint32_t> child_offsets_;
+  std::vector<uint32_t> children_;
+  std::vector<uint32_t> tree_pre_;
+  std::vector<uint32_t> tree_post_;
+};
+
+}  // namespace spvutils
+
+#endif  // LIBSPIRV_UTIL_DOMINATORS_H_
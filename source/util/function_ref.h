@@ -0,0 +1,72 @@
+// Copyright (c) 2018 Google LLC.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef LIBSPIRV_UTIL_FUNCTION_REF_H_
+#define LIBSPIRV_UTIL_FUNCTION_REF_H_
+
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace spvutils {
+
+template <typename Signature>
+class FunctionRef;
+
+// A non-owning reference to a callable object with the signature
+// R(Args...).  Unlike std::function, it never copies the callable nor
+// allocates memory, and a call costs a single indirect call.  It suits the
+// parameters of the visitors which call back on every instruction or id:
+// any lambda, function object or std::function converts to it implicitly.
+//
+// It must not outlive the object it refers to, so it should only be used as
+// a function parameter, and not be stored.
+template <typename R, typename... Args>
+class FunctionRef<R(Args...)> {
+ public:
+  // Refers to |f|, which must be callable with Args and return something
+  // convertible to R.  Like std::function, it does not take part in overload
+  // resolution otherwise.
+  template <typename F,
+            typename Result =
+                decltype(std::declval<F&>()(std::declval<Args>()...)),
+            typename = typename std::enable_if<
+                !std::is_same<typename std::decay<F>::type,
+                              FunctionRef>::value &&
+                (std::is_void<R>::value ||
+                 std::is_convertible<Result, R>::value)>::type>
+  FunctionRef(F&& f)
+      : callable_(const_cast<void*>(
+            static_cast<const void*>(std::addressof(f)))),
+        invoke_(&Invoke<typename std::remove_reference<F>::type>) {}
+
+  R operator()(Args... args) const {
+    return invoke_(callable_, std::forward<Args>(args)...);
+  }
+
+ private:
+  template <typename F>
+  static R Invoke(void* callable, Args... args) {
+    return static_cast<R>(
+        (*static_cast<F*>(callable))(std::forward<Args>(args)...));
+  }
+
+  // The callable object, and the function calling it.
+  void* callable_;
+  R (*invoke_)(void*, Args...);
+};
+
+}  // namespace spvutils
+
+#endif  // LIBSPIRV_UTIL_FUNCTION_REF_H_
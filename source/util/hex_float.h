@@ -22,9 +22,12 @@
 #include <iomanip>
 #include <limits>
 #include <sstream>
+#include <string>
 #include <vector>
 
 #include "bitutils.h"
+#include "string_utils.h"
+#include "text_reader.h"
 
 #ifndef __GNUC__
 #define GCC_VERSION 0
@@ -204,6 +207,15 @@ std::istream& operator>>(std::istream& is, FloatProxy<T>& value) {
   return is;
 }
 
+// Reads a FloatProxy value as a normal float from a TextReader.
+template <typename T>
+TextReader& operator>>(TextReader& is, FloatProxy<T>& value) {
+  T float_val;
+  is >> float_val;
+  value = FloatProxy<T>(float_val);
+  return is;
+}
+
 // This is an example traits. It is not meant to be used in practice, but will
 // be the default for any non-specialized type.
 template <typename T>
@@ -733,9 +745,10 @@ inline uint8_t get_nibble_from_character(int character) {
   return 0;
 }
 
-// Outputs the given HexFloat to the stream.
+// Appends the hex-float representation of |value| to |str|, for example
+// "-0x1.8p+1".
 template <typename T, typename Traits>
-std::ostream& operator<<(std::ostream& os, const HexFloat<T, Traits>& value) {
+void AppendHexFloat(const HexFloat<T, Traits>& value, std::string* str) {
   using HF = HexFloat<T, Traits>;
   using uint_type = typename HF::uint_type;
   using int_type = typename HF::int_type;
@@ -788,29 +801,35 @@ std::ostream& operator<<(std::ostream& os, const HexFloat<T, Traits>& value) {
     --fraction_nibbles;
   }
 
-  const auto saved_flags = os.flags();
-  const auto saved_fill = os.fill();
-
-  os << sign << "0x" << (is_zero ? '0' : '1');
+  str->append(sign);
+  str->append("0x");
+  str->push_back(is_zero ? '0' : '1');
   if (fraction_nibbles) {
     // Make sure to keep the leading 0s in place, since this is the fractional
     // part.
-    os << "." << std::setw(static_cast<int>(fraction_nibbles))
-       << std::setfill('0') << std::hex << fraction;
+    str->push_back('.');
+    for (uint_type nibble = fraction_nibbles; nibble > 0; --nibble) {
+      str->push_back(
+          "0123456789abcdef"[(fraction >> (4 * (nibble - 1))) & 0xF]);
+    }
   }
-  os << "p" << std::dec << (int_exponent >= 0 ? "+" : "") << int_exponent;
-
-  os.flags(saved_flags);
-  os.fill(saved_fill);
+  str->append(int_exponent >= 0 ? "p+" : "p");
+  AppendInteger(int_exponent, str);
+}
 
-  return os;
+// Outputs the given HexFloat to the stream.
+template <typename T, typename Traits>
+std::ostream& operator<<(std::ostream& os, const HexFloat<T, Traits>& value) {
+  std::string str;
+  AppendHexFloat(value, &str);
+  return os << str;
 }
 
 // Returns true if negate_value is true and the next character on the
 // input stream is a plus or minus sign.  In that case we also set the fail bit
 // on the stream and set the value to the zero value for its type.
-template <typename T, typename Traits>
-inline bool RejectParseDueToLeadingSign(std::istream& is, bool negate_value,
+template <typename Stream, typename T, typename Traits>
+inline bool RejectParseDueToLeadingSign(Stream& is, bool negate_value,
                                         HexFloat<T, Traits>& value) {
   if (negate_value) {
     auto next_char = is.peek();
@@ -835,9 +854,9 @@ inline bool RejectParseDueToLeadingSign(std::istream& is, bool negate_value,
 // TODO(dneto): Promise C++11 standard behavior in how the value is set in
 // the error case, but only after all target platforms implement it correctly.
 // In particular, the Microsoft C++ runtime appears to be out of spec.
-template <typename T, typename Traits>
-inline std::istream& ParseNormalFloat(std::istream& is, bool negate_value,
-                                      HexFloat<T, Traits>& value) {
+template <typename Stream, typename T, typename Traits>
+inline Stream& ParseNormalFloat(Stream& is, bool negate_value,
+                                HexFloat<T, Traits>& value) {
   if (RejectParseDueToLeadingSign(is, negate_value, value)) {
     return is;
   }
@@ -861,7 +880,7 @@ inline std::istream& ParseNormalFloat(std::istream& is, bool negate_value,
   return is;
 }
 
-// Specialization of ParseNormalFloat for FloatProxy<Float16> values.
+// Overload of ParseNormalFloat for FloatProxy<Float16> values.
 // This will parse the float as it were a 32-bit floating point number,
 // and then round it down to fit into a Float16 value.
 // The number is rounded towards zero.
@@ -873,10 +892,9 @@ inline std::istream& ParseNormalFloat(std::istream& is, bool negate_value,
 // TODO(dneto): Promise C++11 standard behavior in how the value is set in
 // the error case, but only after all target platforms implement it correctly.
 // In particular, the Microsoft C++ runtime appears to be out of spec.
-template <>
-inline std::istream&
-ParseNormalFloat<FloatProxy<Float16>, HexFloatTraits<FloatProxy<Float16>>>(
-    std::istream& is, bool negate_value,
+template <typename Stream>
+inline Stream& ParseNormalFloat(
+    Stream& is, bool negate_value,
     HexFloat<FloatProxy<Float16>, HexFloatTraits<FloatProxy<Float16>>>& value) {
   // First parse as a 32-bit float.
   HexFloat<FloatProxy<float>> float_val(0.0f);
@@ -914,8 +932,9 @@ ParseNormalFloat<FloatProxy<Float16>, HexFloatTraits<FloatProxy<Float16>>>(
 //
 //    0x1p+129 (+inf)
 //    -0x1p+129 (-inf)
-template <typename T, typename Traits>
-std::istream& operator>>(std::istream& is, HexFloat<T, Traits>& value) {
+// |Stream| is either a std::istream or a TextReader.
+template <typename Stream, typename T, typename Traits>
+Stream& ParseHexFloat(Stream& is, HexFloat<T, Traits>& value) {
   using HF = HexFloat<T, Traits>;
   using uint_type = typename HF::uint_type;
   using int_type = typename HF::int_type;
@@ -1115,33 +1134,48 @@ std::istream& operator>>(std::istream& is, HexFloat<T, Traits>& value) {
   return is;
 }
 
-// Writes a FloatProxy value to a stream.
+// Reads a HexFloat from the given stream. See ParseHexFloat.
+template <typename T, typename Traits>
+std::istream& operator>>(std::istream& is, HexFloat<T, Traits>& value) {
+  return ParseHexFloat(is, value);
+}
+
+// Reads a HexFloat from the given TextReader. See ParseHexFloat.
+template <typename T, typename Traits>
+TextReader& operator>>(TextReader& is, HexFloat<T, Traits>& value) {
+  return ParseHexFloat(is, value);
+}
+
+// Appends a FloatProxy value to |str|.
 // Zero and normal numbers are printed in the usual notation, but with
 // enough digits to fully reproduce the value.  Other values (subnormal,
 // NaN, and infinity) are printed as a hex float.
 template <typename T>
-std::ostream& operator<<(std::ostream& os, const FloatProxy<T>& value) {
+void AppendFloat(const FloatProxy<T>& value, std::string* str) {
   auto float_val = value.getAsFloat();
   switch (std::fpclassify(float_val)) {
     case FP_ZERO:
-    case FP_NORMAL: {
-      auto saved_precision = os.precision();
-      os.precision(std::numeric_limits<T>::max_digits10);
-      os << float_val;
-      os.precision(saved_precision);
-    } break;
+    case FP_NORMAL:
+      AppendFloat(static_cast<double>(float_val),
+                  std::numeric_limits<T>::max_digits10, str);
+      break;
     default:
-      os << HexFloat<FloatProxy<T>>(value);
+      AppendHexFloat(HexFloat<FloatProxy<T>>(value), str);
       break;
   }
-  return os;
 }
 
-template <>
-inline std::ostream& operator<<<Float16>(std::ostream& os,
-                                         const FloatProxy<Float16>& value) {
-  os << HexFloat<FloatProxy<Float16>>(value);
-  return os;
+// FloatProxy<Float16> values are always printed as a hex float.
+inline void AppendFloat(const FloatProxy<Float16>& value, std::string* str) {
+  AppendHexFloat(HexFloat<FloatProxy<Float16>>(value), str);
+}
+
+// Writes a FloatProxy value to a stream. See AppendFloat.
+template <typename T>
+std::ostream& operator<<(std::ostream& os, const FloatProxy<T>& value) {
+  std::string str;
+  AppendFloat(value, &str);
+  return os << str;
 }
 }  // namespace spvutils
 
@@ -0,0 +1,52 @@
+// Copyright (c) 2018 Google LLC.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef LIBSPIRV_UTIL_PARALLEL_H_
+#define LIBSPIRV_UTIL_PARALLEL_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+namespace spvutils {
+
+// Calls |job|(index, worker) on each index in [0, |count|), using the calling
+// thread and up to |num_threads| - 1 additional threads.  The |worker| argument
+// is less than |num_threads| and identifies the thread making the call, so that
+// jobs can keep per-thread state.  The indices are handed out in increasing
+// order, but the calls may run in any order and concurrently.  Returns when all
+// the calls have returned.
+template <typename Job>
+void ParallelFor(size_t count, uint32_t num_threads, const Job& job) {
+  std::atomic<size_t> next_index(0);
+  auto worker = [&next_index, count, &job](uint32_t worker_index) {
+    for (size_t i = next_index++; i < count; i = next_index++)
+      job(i, worker_index);
+  };
+
+  const size_t num_workers =
+      std::min<size_t>(std::max<uint32_t>(num_threads, 1), count);
+  std::vector<std::thread> threads;
+  for (size_t i = 1; i < num_workers; ++i)
+    threads.emplace_back(worker, static_cast<uint32_t>(i));
+  worker(0);
+  for (std::thread& thread : threads) thread.join();
+}
+
+}  // namespace spvutils
+
+#endif  // LIBSPIRV_UTIL_PARALLEL_H_
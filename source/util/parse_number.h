@@ -21,6 +21,7 @@
 
 #include "spirv-tools/libspirv.h"
 #include "util/hex_float.h"
+#include "util/text_reader.h"
 
 namespace spvutils {
 
@@ -172,18 +173,17 @@ bool ParseNumber(const char* text, T* value_pointer) {
                 "Single-byte types are not supported in this parse method");
 
   if (!text) return false;
-  std::istringstream text_stream(text);
-  // Allow both decimal and hex input for integers.
+  // Allows both decimal and hex input for integers.
   // It also allows octal input, but we don't care about that case.
-  text_stream >> std::setbase(0);
-  text_stream >> *value_pointer;
+  TextReader text_reader(text);
+  text_reader >> *value_pointer;
 
   // We should have read something.
-  bool ok = (text[0] != 0) && !text_stream.bad();
+  bool ok = (text[0] != 0) && !text_reader.bad();
   // It should have been all the text.
-  ok = ok && text_stream.eof();
+  ok = ok && text_reader.eof();
   // It should have been in range.
-  ok = ok && !text_stream.fail();
+  ok = ok && !text_reader.fail();
 
   // Work around a bug in the GNU C++11 library. It will happily parse
   // "-1" for uint16_t as 65535.
@@ -13,13 +13,46 @@
 // limitations under the License.
 
 #include <algorithm>
+#include <clocale>
 #include <cstdint>
+#include <cstdio>
+#include <cstring>
 #include <type_traits>
 
 #include "util/string_utils.h"
 
 namespace spvutils {
 
+void AppendFloat(double val, int precision, std::string* str) {
+  // Output streams use the "%.*g" format. Only unusually large precisions do
+  // not fit in the small buffer.
+  char small_buffer[64];
+  const int length =
+      std::snprintf(small_buffer, sizeof(small_buffer), "%.*g", precision, val);
+  if (length < 0) return;
+  std::string large_buffer;
+  const char* first = small_buffer;
+  if (static_cast<size_t>(length) >= sizeof(small_buffer)) {
+    large_buffer.resize(static_cast<size_t>(length) + 1);
+    std::snprintf(&large_buffer[0], large_buffer.size(), "%.*g", precision,
+                  val);
+    first = large_buffer.data();
+  }
+  const char* last = first + length;
+
+  // The C library uses the decimal point of the current C locale, while
+  // output streams use '.' in the classic locale.
+  const char* decimal_point = std::localeconv()->decimal_point;
+  const char* point =
+      std::search(first, last, decimal_point,
+                  decimal_point + std::strlen(decimal_point));
+  str->append(first, point);
+  if (point != last) {
+    str->push_back('.');
+    str->append(point + std::strlen(decimal_point), last);
+  }
+}
+
 std::string CardinalToOrdinal(size_t cardinal) {
   const size_t mod10 = cardinal % 10;
   const size_t mod100 = cardinal % 100;
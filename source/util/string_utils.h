@@ -15,21 +15,61 @@
 #ifndef LIBSPIRV_UTIL_STRING_UTILS_H_
 #define LIBSPIRV_UTIL_STRING_UTILS_H_
 
-#include <sstream>
 #include <string>
+#include <type_traits>
 
 #include "util/string_utils.h"
 
 namespace spvutils {
 
-// Converts arithmetic value |val| to its default string representation.
+// Appends the decimal representation of integer |val| to |str|.
 template <class T>
-std::string ToString(T val) {
-  static_assert(std::is_arithmetic<T>::value,
-                "spvutils::ToString is restricted to only arithmetic values");
-  std::stringstream os;
-  os << val;
-  return os.str();
+void AppendInteger(T val, std::string* str) {
+  static_assert(std::is_integral<T>::value,
+                "spvutils::AppendInteger is restricted to integral values");
+  // Promoting |val| also handles bool, which has no unsigned counterpart.
+  const auto promoted = +val;
+  const bool negative = promoted < 0;
+  using unsigned_type = typename std::make_unsigned<decltype(+val)>::type;
+  unsigned_type magnitude = static_cast<unsigned_type>(promoted);
+  if (negative) magnitude = static_cast<unsigned_type>(-magnitude);
+  // Enough for the digits of a 64-bit integer.
+  char digits[20];
+  char* first = digits + sizeof(digits);
+  do {
+    *--first = static_cast<char>('0' + magnitude % 10);
+    magnitude = static_cast<unsigned_type>(magnitude / 10);
+  } while (magnitude);
+  if (negative) str->push_back('-');
+  str->append(first, digits + sizeof(digits));
+}
+
+// Appends |val| to |str| as an output stream would write it in the default
+// floating-point notation with the given |precision|, independently of the
+// current locale.
+void AppendFloat(double val, int precision, std::string* str);
+
+// Converts arithmetic value |val| to its default string representation, as
+// written by an output stream.
+template <class T>
+typename std::enable_if<std::is_integral<T>::value, std::string>::type
+ToString(T val) {
+  std::string str;
+  // Character types are written as characters.
+  if (std::is_same<T, char>::value || std::is_same<T, signed char>::value ||
+      std::is_same<T, unsigned char>::value) {
+    str.push_back(static_cast<char>(val));
+  } else {
+    AppendInteger(val, &str);
+  }
+  return str;
+}
+template <class T>
+typename std::enable_if<std::is_floating_point<T>::value, std::string>::type
+ToString(T val) {
+  std::string str;
+  AppendFloat(static_cast<double>(val), 6, &str);
+  return str;
 }
 
 // Converts cardinal number to ordinal number string.
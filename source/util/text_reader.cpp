@@ -0,0 +1,181 @@
+// Copyright (c) 2018 Google LLC.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "util/text_reader.h"
+
+#include <clocale>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+namespace spvutils {
+
+namespace {
+
+// Returns true if |c| is a whitespace character in the classic locale.
+bool IsSpace(char c) {
+  return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+// Converts the null-terminated |text| with the C library.
+void StringToFloat(const char* text, char** end, float* value) {
+  *value = std::strtof(text, end);
+}
+void StringToFloat(const char* text, char** end, double* value) {
+  *value = std::strtod(text, end);
+}
+
+}  // namespace
+
+int TextReader::peek() {
+  if (!good()) {
+    state_ |= std::ios_base::failbit;
+    return EOF;
+  }
+  if (*next_ == '\0') {
+    state_ |= std::ios_base::eofbit;
+    return EOF;
+  }
+  return static_cast<unsigned char>(*next_);
+}
+
+int TextReader::get() {
+  if (!good()) {
+    state_ |= std::ios_base::failbit;
+    return EOF;
+  }
+  if (*next_ == '\0') {
+    state_ |= std::ios_base::eofbit | std::ios_base::failbit;
+    return EOF;
+  }
+  return static_cast<unsigned char>(*next_++);
+}
+
+TextReader& TextReader::unget() {
+  state_ &= ~std::ios_base::eofbit;
+  if (!good()) {
+    state_ |= std::ios_base::failbit;
+  } else if (next_ == begin_) {
+    state_ |= std::ios_base::badbit;
+  } else {
+    --next_;
+  }
+  return *this;
+}
+
+TextReader& TextReader::operator>>(float& value) {
+  if (Sentry()) ExtractFloat(ScanFloat(), &value);
+  return *this;
+}
+
+TextReader& TextReader::operator>>(double& value) {
+  if (Sentry()) ExtractFloat(ScanFloat(), &value);
+  return *this;
+}
+
+bool TextReader::Sentry() {
+  if (!good()) {
+    state_ |= std::ios_base::failbit;
+    return false;
+  }
+  while (IsSpace(*next_)) ++next_;
+  if (*next_ == '\0') {
+    state_ |= std::ios_base::eofbit | std::ios_base::failbit;
+    return false;
+  }
+  return true;
+}
+
+size_t TextReader::ScanFloat() const {
+  const char* end = next_;
+  if (*end == '+' || *end == '-') ++end;
+
+  bool found_mantissa = false;
+  bool found_dec = false;
+  bool found_sci = false;
+  for (;; ++end) {
+    const char c = *end;
+    if (c >= '0' && c <= '9') {
+      found_mantissa = true;
+    } else if (c == '.' && !found_dec && !found_sci) {
+      found_dec = true;
+    } else if ((c == 'e' || c == 'E') && found_mantissa && !found_sci) {
+      found_sci = true;
+      // The exponent sign is optional.
+      if (end[1] == '+' || end[1] == '-') ++end;
+    } else {
+      break;
+    }
+  }
+  return static_cast<size_t>(end - next_);
+}
+
+template <typename T>
+void TextReader::ExtractFloat(size_t length, T* value) {
+  // The C library parses using the decimal point of the current C locale,
+  // while the text always uses '.'.
+  const char* decimal_point = std::localeconv()->decimal_point;
+  const size_t decimal_point_length = std::strlen(decimal_point);
+
+  char small_buffer[64];
+  std::string large_buffer;
+  char* number = small_buffer;
+  if (length * decimal_point_length >= sizeof(small_buffer)) {
+    large_buffer.resize(length * decimal_point_length + 1);
+    number = &large_buffer[0];
+  }
+  char* out = number;
+  for (const char* in = next_; in != next_ + length; ++in) {
+    if (*in == '.') {
+      std::memcpy(out, decimal_point, decimal_point_length);
+      out += decimal_point_length;
+    } else {
+      *out++ = *in;
+    }
+  }
+  *out = '\0';
+
+  char* end = nullptr;
+  T result;
+  StringToFloat(number, &end, &result);
+  if (end == number || *end != '\0') {
+    result = T(0);
+    state_ |= std::ios_base::failbit;
+  } else if (result == std::numeric_limits<T>::infinity()) {
+    result = std::numeric_limits<T>::max();
+    state_ |= std::ios_base::failbit;
+  } else if (result == -std::numeric_limits<T>::infinity()) {
+    result = -std::numeric_limits<T>::max();
+    state_ |= std::ios_base::failbit;
+  }
+  *value = result;
+
+  next_ += length;
+  if (*next_ == '\0') state_ |= std::ios_base::eofbit;
+}
+
+int TextReader::DigitValue(char c, int base) {
+  int digit = -1;
+  if (c >= '0' && c <= '9') {
+    digit = c - '0';
+  } else if (c >= 'a' && c <= 'f') {
+    digit = c - 'a' + 10;
+  } else if (c >= 'A' && c <= 'F') {
+    digit = c - 'A' + 10;
+  }
+  return digit < base ? digit : -1;
+}
+
+}  // namespace spvutils
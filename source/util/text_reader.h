@@ -0,0 +1,159 @@
+// Copyright (c) 2018 Google LLC.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef LIBSPIRV_UTIL_TEXT_READER_H_
+#define LIBSPIRV_UTIL_TEXT_READER_H_
+
+#include <cstdint>
+#include <cstddef>
+#include <ios>
+#include <limits>
+#include <type_traits>
+
+namespace spvutils {
+
+// Reads numbers from a null-terminated string. It provides the part of the
+// std::istream interface used by the number parsers, with the same state
+// semantics as a std::istringstream in the classic locale, but without the
+// cost of constructing a stream and going through its locale facets.
+//
+// Integers are read as with std::setbase(0): a "0x" or "0X" prefix selects
+// hexadecimal, a leading "0" selects octal, and decimal is used otherwise.
+// Floating point numbers are read as by std::num_get, and are converted with
+// the C library independently of the current C locale.
+class TextReader {
+ public:
+  explicit TextReader(const char* text) : begin_(text), next_(text) {}
+
+  // Stream state, as for std::istream.
+  std::ios_base::iostate rdstate() const { return state_; }
+  void setstate(std::ios_base::iostate state) { state_ |= state; }
+  bool good() const { return state_ == std::ios_base::goodbit; }
+  bool eof() const { return (state_ & std::ios_base::eofbit) != 0; }
+  bool fail() const {
+    return (state_ & (std::ios_base::failbit | std::ios_base::badbit)) != 0;
+  }
+  bool bad() const { return (state_ & std::ios_base::badbit) != 0; }
+  std::ios_base::fmtflags flags() const { return std::ios_base::skipws; }
+
+  // Unformatted input, as for std::istream.
+  int peek();
+  int get();
+  TextReader& unget();
+
+  // Formatted input, as for std::istream.
+  template <typename T>
+  typename std::enable_if<std::is_integral<T>::value, TextReader&>::type
+  operator>>(T& value) {
+    if (Sentry()) ExtractInteger(&value);
+    return *this;
+  }
+  TextReader& operator>>(float& value);
+  TextReader& operator>>(double& value);
+
+ private:
+  // Prepares formatted input: skips leading whitespace and sets the fail bit
+  // if there is nothing left to read. Returns true if input can proceed.
+  bool Sentry();
+
+  // Reads an integer as std::num_get does, with a base determined by its
+  // prefix.
+  template <typename T>
+  void ExtractInteger(T* value);
+
+  // Returns the length of the longest prefix of the remaining text which
+  // std::num_get accepts as a floating point number.
+  size_t ScanFloat() const;
+
+  // Reads a floating point number of |length| characters, as std::num_get
+  // does.
+  template <typename T>
+  void ExtractFloat(size_t length, T* value);
+
+  // Returns the digit value of |c| in |base|, or -1 if it is not a digit.
+  static int DigitValue(char c, int base);
+
+  // The start of the text.
+  const char* begin_;
+  // The next character to read.
+  const char* next_;
+  std::ios_base::iostate state_ = std::ios_base::goodbit;
+};
+
+template <typename T>
+void TextReader::ExtractInteger(T* value) {
+  using unsigned_type = typename std::make_unsigned<T>::type;
+
+  bool negative = false;
+  if (*next_ == '-' || *next_ == '+') {
+    negative = *next_ == '-';
+    ++next_;
+  }
+
+  // A single leading zero selects octal, or hexadecimal if it is followed by
+  // an 'x'. A prefix without digits is only valid if it is a zero.
+  int base = 10;
+  bool found_zero = false;
+  if (*next_ == '0') {
+    base = 8;
+    found_zero = true;
+    ++next_;
+    if (*next_ == 'x' || *next_ == 'X') {
+      base = 16;
+      found_zero = false;
+      ++next_;
+    }
+  }
+
+  // The magnitude of the smallest value of a signed type is one more than
+  // the magnitude of its largest value.
+  const unsigned_type max =
+      (negative && std::is_signed<T>::value)
+          ? static_cast<unsigned_type>(-static_cast<unsigned_type>(
+                std::numeric_limits<T>::min()))
+          : static_cast<unsigned_type>(std::numeric_limits<T>::max());
+  const unsigned_type max_before_multiply =
+      static_cast<unsigned_type>(max / base);
+  unsigned_type result = 0;
+  bool overflow = false;
+  bool found_digits = false;
+  for (int digit; (digit = DigitValue(*next_, base)) >= 0; ++next_) {
+    found_digits = true;
+    if (result > max_before_multiply) {
+      overflow = true;
+      continue;
+    }
+    result = static_cast<unsigned_type>(result * base);
+    overflow |= result > static_cast<unsigned_type>(max - digit);
+    result = static_cast<unsigned_type>(result + digit);
+  }
+
+  if (*next_ == '\0') state_ |= std::ios_base::eofbit;
+  if (!found_digits && !found_zero) {
+    *value = 0;
+    state_ |= std::ios_base::failbit;
+  } else if (overflow) {
+    *value = (negative && std::is_signed<T>::value)
+                 ? std::numeric_limits<T>::min()
+                 : std::numeric_limits<T>::max();
+    state_ |= std::ios_base::failbit;
+  } else {
+    *value = static_cast<T>(
+        negative ? static_cast<unsigned_type>(-result) : result);
+  }
+}
+
+}  // namespace spvutils
+
+#endif  // LIBSPIRV_UTIL_TEXT_READER_H_
@@ -47,6 +47,22 @@ const BasicBlock* BasicBlock::immediate_post_dominator() const {
   return immediate_post_dominator_;
 }
 
+void BasicBlock::SetDominatorTreePosition(const BasicBlock* root,
+                                          uint32_t preorder,
+                                          uint32_t postorder) {
+  dominator_position_.root = root;
+  dominator_position_.preorder = preorder;
+  dominator_position_.postorder = postorder;
+}
+
+void BasicBlock::SetPostDominatorTreePosition(const BasicBlock* root,
+                                              uint32_t preorder,
+                                              uint32_t postorder) {
+  post_dominator_position_.root = root;
+  post_dominator_position_.preorder = preorder;
+  post_dominator_position_.postorder = postorder;
+}
+
 BasicBlock* BasicBlock::immediate_dominator() { return immediate_dominator_; }
 BasicBlock* BasicBlock::immediate_post_dominator() {
   return immediate_post_dominator_;
@@ -66,12 +82,18 @@ void BasicBlock::RegisterBranchInstruction(SpvOp branch_instruction) {
 }
 
 bool BasicBlock::dominates(const BasicBlock& other) const {
+  if (dominator_position_.root && other.dominator_position_.root)
+    return (this == &other) ||
+           dominator_position_.Contains(other.dominator_position_);
   return (this == &other) ||
          !(other.dom_end() ==
            std::find(other.dom_begin(), other.dom_end(), this));
 }
 
 bool BasicBlock::postdominates(const BasicBlock& other) const {
+  if (post_dominator_position_.root && other.post_dominator_position_.root)
+    return (this == &other) ||
+           post_dominator_position_.Contains(other.post_dominator_position_);
   return (this == &other) ||
          !(other.pdom_end() ==
            std::find(other.pdom_begin(), other.pdom_end(), this));
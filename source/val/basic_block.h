@@ -104,6 +104,21 @@ class BasicBlock {
   /// Returns the immedate post dominator of this basic block
   const BasicBlock* immediate_post_dominator() const;
 
+  /// Sets the position of this basic block in the dominator tree rooted at
+  /// @p root, as numbered by a depth first traversal of the tree.  This lets
+  /// dominates() answer without walking the tree.
+  ///
+  /// @param[in] root      The root of the dominator tree
+  /// @param[in] preorder  The preorder number of this block, from 1
+  /// @param[in] postorder The postorder number of this block, from 1
+  void SetDominatorTreePosition(const BasicBlock* root, uint32_t preorder,
+                                uint32_t postorder);
+
+  /// Sets the position of this basic block in the post dominator tree, as
+  /// SetDominatorTreePosition does for postdominates().
+  void SetPostDominatorTreePosition(const BasicBlock* root, uint32_t preorder,
+                                    uint32_t postorder);
+
   /// Ends the block without a successor
   void RegisterBranchInstruction(SpvOp branch_instruction);
 
@@ -189,6 +204,20 @@ class BasicBlock {
   DominatorIterator pdom_end();
 
  private:
+  /// The position of a block in a (post) dominator tree.
+  struct TreePosition {
+    /// Returns true if this position is an ancestor of @p other, or is
+    /// @p other.  Returns false if either position is unknown.
+    bool Contains(const TreePosition& other) const {
+      return root && root == other.root && preorder <= other.preorder &&
+             postorder >= other.postorder;
+    }
+
+    const BasicBlock* root = nullptr;
+    uint32_t preorder = 0;
+    uint32_t postorder = 0;
+  };
+
   /// Id of the BasicBlock
   const uint32_t id_;
 
@@ -198,6 +227,12 @@ class BasicBlock {
   /// Pointer to the immediate dominator of the BasicBlock
   BasicBlock* immediate_post_dominator_;
 
+  /// The position of the BasicBlock in the dominator tree, if known
+  TreePosition dominator_position_;
+
+  /// The position of the BasicBlock in the post dominator tree, if known
+  TreePosition post_dominator_position_;
+
   /// The set of predecessors of the BasicBlock
   std::vector<BasicBlock*> predecessors_;
 
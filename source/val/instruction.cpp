@@ -14,10 +14,6 @@
 
 #include "val/instruction.h"
 
-#include <utility>
-
-using std::make_pair;
-
 namespace libspirv {
 #define OPERATOR(OP)                                                 \
   bool operator OP(const Instruction& lhs, const Instruction& rhs) { \
@@ -34,16 +30,11 @@ OPERATOR(==)
 Instruction::Instruction(const spv_parsed_instruction_t* inst,
                          Function* defining_function,
                          BasicBlock* defining_block)
-    : words_(inst->words, inst->words + inst->num_words),
-      operands_(inst->operands, inst->operands + inst->num_operands),
-      inst_({words_.data(), inst->num_words, inst->opcode, inst->ext_inst_type,
-             inst->type_id, inst->result_id, operands_.data(),
-             inst->num_operands}),
+    : inst_(*inst),
       function_(defining_function),
       block_(defining_block),
-      uses_() {}
+      uses_(nullptr),
+      num_uses_(0),
+      max_uses_(0) {}
 
-void Instruction::RegisterUse(const Instruction* inst, uint32_t index) {
-  uses_.push_back(make_pair(inst, index));
-}
 }  // namespace libspirv
@@ -23,6 +23,7 @@
 
 #include "spirv-tools/libspirv.h"
 #include "table.h"
+#include "util/array_view.h"
 
 namespace libspirv {
 
@@ -30,15 +31,31 @@ class BasicBlock;
 class Function;
 
 /// Wraps the spv_parsed_instruction struct along with use and definition of the
-/// instruction's result id
+/// instruction's result id.  The words and operands of the instruction are not
+/// copied, and must outlive it.
 class Instruction {
  public:
+  /// A use of the result id: the instruction in which it is referenced, and the
+  /// index of the word in that instruction where it appears.
+  using Use = std::pair<const Instruction*, uint32_t>;
+
   explicit Instruction(const spv_parsed_instruction_t* inst,
                        Function* defining_function = nullptr,
                        BasicBlock* defining_block = nullptr);
 
+  /// Sets the storage of the uses of the Instruction, which must have room for
+  /// \p count uses, all of which are then registered with RegisterUse()
+  void SetUseStorage(Use* storage, uint32_t count) {
+    uses_ = storage;
+    num_uses_ = 0;
+    max_uses_ = count;
+  }
+
   /// Registers the use of the Instruction in instruction \p inst at \p index
-  void RegisterUse(const Instruction* inst, uint32_t index);
+  void RegisterUse(const Instruction* inst, uint32_t index) {
+    assert(num_uses_ < max_uses_);
+    uses_[num_uses_++] = Use(inst, index);
+  }
 
   uint32_t id() const { return inst_.result_id; }
   uint32_t type_id() const { return inst_.type_id; }
@@ -52,23 +69,29 @@ class Instruction {
   /// was defined outside of a BasicBlock
   const BasicBlock* block() const { return block_; }
 
-  /// Returns a vector of pairs of all references to this instruction's result
-  /// id. The first element is the instruction in which this result id was
-  /// referenced and the second is the index of the word in that instruction
-  /// where this result id appeared
-  const std::vector<std::pair<const Instruction*, uint32_t>>& uses() const {
-    return uses_;
+  /// Returns all references to this instruction's result id, in the order
+  /// they appear in the module.  The first element of each is the instruction
+  /// in which this result id was referenced and the second is the index of the
+  /// word in that instruction where this result id appeared
+  spvutils::ArrayView<Use> uses() const {
+    return spvutils::ArrayView<Use>(uses_, num_uses_);
   }
 
   /// The word used to define the Instruction
-  uint32_t word(size_t index) const { return words_[index]; }
+  uint32_t word(size_t index) const {
+    assert(index < inst_.num_words);
+    return inst_.words[index];
+  }
 
   /// The words used to define the Instruction
-  const std::vector<uint32_t>& words() const { return words_; }
+  spvutils::ArrayView<uint32_t> words() const {
+    return spvutils::ArrayView<uint32_t>(inst_.words, inst_.num_words);
+  }
 
   /// The operands of the Instruction
-  const std::vector<spv_parsed_operand_t>& operands() const {
-    return operands_;
+  spvutils::ArrayView<spv_parsed_operand_t> operands() const {
+    return spvutils::ArrayView<spv_parsed_operand_t>(inst_.operands,
+                                                     inst_.num_operands);
   }
 
   /// Provides direct access to the stored C instruction object.
@@ -77,15 +100,13 @@ class Instruction {
   // Casts the words belonging to the operand under |index| to |T| and returns.
   template <typename T>
   T GetOperandAs(size_t index) const {
-    const spv_parsed_operand_t& operand = operands_.at(index);
+    const spv_parsed_operand_t& operand = operands()[index];
     assert(operand.num_words * 4 >= sizeof(T));
     assert(operand.offset + operand.num_words <= inst_.num_words);
-    return *reinterpret_cast<const T*>(&words_[operand.offset]);
+    return *reinterpret_cast<const T*>(&inst_.words[operand.offset]);
   }
 
  private:
-  const std::vector<uint32_t> words_;
-  const std::vector<spv_parsed_operand_t> operands_;
   spv_parsed_instruction_t inst_;
 
   /// The function in which this instruction was declared
@@ -94,11 +115,11 @@ class Instruction {
   /// The basic block in which this instruction was declared
   BasicBlock* block_;
 
-  /// This is a vector of pairs of all references to this instruction's result
-  /// id. The first element is the instruction in which this result id was
-  /// referenced and the second is the index of the word in the referencing
-  /// instruction where this instruction appeared
-  std::vector<std::pair<const Instruction*, uint32_t>> uses_;
+  /// All references to this instruction's result id, stored in an array
+  /// shared by all the instructions of the module
+  Use* uses_;
+  uint32_t num_uses_;
+  uint32_t max_uses_;
 };
 
 #define OPERATOR(OP)                                                \
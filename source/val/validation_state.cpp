@@ -14,10 +14,15 @@
 
 #include "val/validation_state.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <stack>
 
 #include "opcode.h"
+#include "operand.h"
+#include "spirv_validator_options.h"
+#include "util/parallel.h"
 #include "val/basic_block.h"
 #include "val/construct.h"
 #include "val/function.h"
@@ -136,6 +141,18 @@ bool IsInstructionInLayoutSection(ModuleLayoutSection layout, SpvOp op) {
   return out;
 }
 
+// The consumer of the diagnostics of the check run by the calling thread
+// within CheckInParallel(), or nullptr outside of it.
+thread_local const spvtools::MessageConsumer* t_consumer = nullptr;
+
+// A diagnostic held back by CheckInParallel().
+struct HeldMessage {
+  spv_message_level_t level;
+  string source;
+  spv_position_t position;
+  string message;
+};
+
 }  // anonymous namespace
 
 ValidationState_t::ValidationState_t(const spv_const_context ctx,
@@ -150,6 +167,8 @@ ValidationState_t::ValidationState_t(const spv_const_context ctx,
       module_capabilities_(),
       module_extensions_(),
       ordered_instructions_(),
+      words_(nullptr),
+      num_words_(0),
       all_definitions_(),
       global_vars_(),
       local_vars_(),
@@ -229,6 +248,10 @@ Instruction* ValidationState_t::FindDef(uint32_t id) {
   return it->second;
 }
 
+std::ostream* ValidationState_t::time_report_stream() const {
+  return options_->time_report_stream;
+}
+
 // Increments the instruction count. Used for diagnostic
 int ValidationState_t::increment_instruction_count() {
   return instruction_counter_++;
@@ -252,10 +275,61 @@ bool ValidationState_t::IsOpcodeInCurrentLayoutSection(SpvOp op) {
 
 DiagnosticStream ValidationState_t::diag(spv_result_t error_code) const {
   return libspirv::DiagnosticStream(
-      {0, 0, static_cast<size_t>(instruction_counter_)}, context_->consumer,
+      {0, 0, static_cast<size_t>(instruction_counter_)}, consumer(),
       error_code);
 }
 
+const spvtools::MessageConsumer& ValidationState_t::consumer() const {
+  return t_consumer ? *t_consumer : context_->consumer;
+}
+
+spv_result_t ValidationState_t::CheckInParallel(
+    size_t count, const std::function<spv_result_t(size_t)>& check) const {
+  if (options_->num_threads <= 1 || count <= 1) {
+    for (size_t i = 0; i < count; ++i) {
+      if (auto error = check(i)) return error;
+    }
+    return SPV_SUCCESS;
+  }
+
+  vector<spv_result_t> results(count, SPV_SUCCESS);
+  vector<vector<HeldMessage>> messages(count);
+  // The smallest index whose check failed so far.  The checks of the larger
+  // indices can be skipped, since their outcome would be dropped.
+  std::atomic<size_t> first_failure(count);
+  spvutils::ParallelFor(count, options_->num_threads, [&](size_t i, uint32_t) {
+    if (i > first_failure) return;
+    vector<HeldMessage>& held = messages[i];
+    const spvtools::MessageConsumer hold =
+        [&held](spv_message_level_t level, const char* source,
+                const spv_position_t& position, const char* message) {
+          held.push_back({level, source ? source : "", position,
+                          message ? message : ""});
+        };
+    const spvtools::MessageConsumer* outer = t_consumer;
+    t_consumer = &hold;
+    results[i] = check(i);
+    t_consumer = outer;
+    if (results[i] != SPV_SUCCESS) {
+      size_t failure = first_failure;
+      while (i < failure && !first_failure.compare_exchange_weak(failure, i)) {
+      }
+    }
+  });
+
+  const size_t last = std::min(first_failure.load(), count - 1);
+  const spvtools::MessageConsumer& send = consumer();
+  if (send) {
+    for (size_t i = 0; i <= last; ++i) {
+      for (const HeldMessage& held : messages[i]) {
+        send(held.level, held.source.c_str(), held.position,
+             held.message.c_str());
+      }
+    }
+  }
+  return first_failure < count ? results[first_failure] : SPV_SUCCESS;
+}
+
 deque<Function>& ValidationState_t::functions() { return module_functions_; }
 
 Function& ValidationState_t::current_function() {
@@ -401,13 +475,26 @@ spv_result_t ValidationState_t::RegisterFunctionEnd() {
   return SPV_SUCCESS;
 }
 
+void ValidationState_t::setBinary(const uint32_t* words, size_t num_words) {
+  words_ = words;
+  num_words_ = num_words;
+}
+
 void ValidationState_t::RegisterInstruction(
     const spv_parsed_instruction_t& inst) {
+  // The instruction refers to the words of the module when it can, and to
+  // copies in the arenas otherwise.
+  spv_parsed_instruction_t stored_inst = inst;
+  if (!words_ || inst.words < words_ ||
+      inst.words + inst.num_words > words_ + num_words_)
+    stored_inst.words = word_arena_.Copy(inst.words, inst.num_words);
+  stored_inst.operands = operand_arena_.Copy(inst.operands, inst.num_operands);
+
   if (in_function_body()) {
-    ordered_instructions_.emplace_back(&inst, &current_function(),
+    ordered_instructions_.emplace_back(&stored_inst, &current_function(),
                                        current_function().current_block());
   } else {
-    ordered_instructions_.emplace_back(&inst, nullptr, nullptr);
+    ordered_instructions_.emplace_back(&stored_inst, nullptr, nullptr);
   }
   uint32_t id = ordered_instructions_.back().id();
   if (id) {
@@ -429,6 +516,38 @@ void ValidationState_t::RegisterInstruction(
   }
 }
 
+void ValidationState_t::RegisterUses() {
+  struct IdUse {
+    Instruction* def;
+    const Instruction* user;
+    uint32_t index;
+  };
+  std::vector<IdUse> id_uses;
+  std::unordered_map<Instruction*, uint32_t> num_uses;
+  for (const auto& inst : ordered_instructions_) {
+    for (const auto& operand : inst.operands()) {
+      const spv_operand_type_t type = operand.type;
+      if (spvIsIdType(type) && type != SPV_OPERAND_TYPE_RESULT_ID) {
+        if (Instruction* def = FindDef(inst.word(operand.offset))) {
+          id_uses.push_back({def, &inst, operand.offset});
+          ++num_uses[def];
+        }
+      }
+    }
+  }
+
+  // The uses of all the ids are stored in one array, in which the uses of each
+  // id are contiguous and in module order.
+  uses_.resize(id_uses.size());
+  Instruction::Use* storage = uses_.data();
+  for (const auto& def_num_uses : num_uses) {
+    def_num_uses.first->SetUseStorage(storage, def_num_uses.second);
+    storage += def_num_uses.second;
+  }
+  for (const IdUse& id_use : id_uses)
+    id_use.def->RegisterUse(id_use.user, id_use.index);
+}
+
 std::vector<uint32_t> ValidationState_t::getSampledImageConsumers(
     uint32_t sampled_image_id) const {
   std::vector<uint32_t> result;
@@ -15,7 +15,9 @@
 #ifndef LIBSPIRV_VAL_VALIDATIONSTATE_H_
 #define LIBSPIRV_VAL_VALIDATIONSTATE_H_
 
+#include <chrono>
 #include <deque>
+#include <functional>
 #include <set>
 #include <string>
 #include <tuple>
@@ -30,6 +32,7 @@
 #include "latest_version_spirv_header.h"
 #include "spirv-tools/libspirv.h"
 #include "spirv_definition.h"
+#include "util/arena.h"
 #include "val/function.h"
 #include "val/instruction.h"
 
@@ -126,6 +129,20 @@ class ValidationState_t {
   /// Increments the instruction count. Used for diagnostic
   int increment_instruction_count();
 
+  /// Returns the number of instructions processed so far.
+  int instruction_count() const { return instruction_counter_; }
+
+  /// Returns the stream to which the resource usage of the validation is
+  /// reported, or nullptr if it is not reported.
+  std::ostream* time_report_stream() const;
+
+  /// Returns the wall time spent by each of the checks done on every
+  /// instruction, indexed by their order.  It is empty unless the resource
+  /// usage of the validation is reported.
+  std::vector<std::chrono::steady_clock::duration>& instruction_pass_times() {
+    return instruction_pass_times_;
+  }
+
   /// Returns the current layout section which is being processed
   ModuleLayoutSection current_layout_section() const;
 
@@ -137,6 +154,21 @@ class ValidationState_t {
 
   libspirv::DiagnosticStream diag(spv_result_t error_code) const;
 
+  /// Returns the consumer of the diagnostics emitted by the calling thread.
+  /// It is the consumer of the context, except within CheckInParallel().
+  const spvtools::MessageConsumer& consumer() const;
+
+  /// Calls |check| with each index in [0, |count|), using the number of
+  /// threads of the validator options, and returns the result of the first
+  /// call in index order which fails.  The diagnostics emitted by the calls
+  /// are held back and sent to the consumer in index order, up to those of
+  /// that call, so that the outcome is the same as for calling |check| in
+  /// order and stopping at the first failure.  |check| must only modify state
+  /// which no other index uses, and must emit its diagnostics through diag()
+  /// or consumer().
+  spv_result_t CheckInParallel(
+      size_t count, const std::function<spv_result_t(size_t)>& check) const;
+
   /// Returns the function states
   std::deque<Function>& functions();
 
@@ -273,9 +305,18 @@ class ValidationState_t {
 
   const AssemblyGrammar& grammar() const { return grammar_; }
 
+  /// Sets the words of the module being validated, which must outlive the
+  /// validation state.  The registered instructions refer to the words of the
+  /// module instead of copying them.
+  void setBinary(const uint32_t* words, size_t num_words);
+
   /// Registers the instruction
   void RegisterInstruction(const spv_parsed_instruction_t& inst);
 
+  /// Registers the uses of the ids of all the instructions registered so far,
+  /// which must include their definitions.
+  void RegisterUses();
+
   /// Registers the decoration for the given <id>
   void RegisterDecorationForId(uint32_t id, const Decoration& dec) {
     id_decorations_[id].push_back(dec);
@@ -474,6 +515,9 @@ class ValidationState_t {
   /// Tracks the number of instructions evaluated by the validator
   int instruction_counter_;
 
+  /// The time spent by each per-instruction check, when it is reported.
+  std::vector<std::chrono::steady_clock::duration> instruction_pass_times_;
+
   /// IDs which have been forward declared but have not been defined
   std::unordered_set<uint32_t> unresolved_forward_ids_;
 
@@ -506,6 +550,18 @@ class ValidationState_t {
   /// valid until the end of lifetime of the validation state.
   std::deque<Instruction> ordered_instructions_;
 
+  /// The words of the module set by setBinary().
+  const uint32_t* words_;
+  size_t num_words_;
+
+  /// Copies of the words of the instructions which are not in the words of
+  /// the module, and of the operands of all the instructions.
+  spvutils::Arena<uint32_t> word_arena_;
+  spvutils::Arena<spv_parsed_operand_t> operand_arena_;
+
+  /// The uses of the ids of the module, grouped by id.  See RegisterUses().
+  std::vector<Instruction::Use> uses_;
+
   /// Instructions that can be referenced by Ids
   std::unordered_map<uint32_t, Instruction*> all_definitions_;
 
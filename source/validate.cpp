@@ -18,7 +18,9 @@
 #include <cstdio>
 
 #include <algorithm>
+#include <chrono>
 #include <functional>
+#include <iomanip>
 #include <iterator>
 #include <memory>
 #include <sstream>
@@ -37,6 +39,7 @@
 #include "spirv_endian.h"
 #include "spirv_target_env.h"
 #include "spirv_validator_options.h"
+#include "util/timer.h"
 #include "val/construct.h"
 #include "val/function.h"
 #include "val/validation_state.h"
@@ -58,13 +61,45 @@ using libspirv::LiteralsPass;
 using libspirv::ModuleLayoutPass;
 using libspirv::ValidationState_t;
 
-spv_result_t spvValidateIDs(const spv_instruction_t* pInsts,
+spv_result_t spvValidateIDs(const spv_validated_instruction_t* pInsts,
                             const uint64_t count,
                             const ValidationState_t& state,
                             spv_position position) {
   position->index = SPV_INDEX_INSTRUCTION;
-  if (auto error = spvValidateInstructionIDs(pInsts, count, state, position))
+
+  // The instructions before the first function are validated first, since the
+  // checks of the function bodies rely on them.  The function bodies are then
+  // validated independently of each other.
+  vector<uint64_t> function_starts;
+  vector<size_t> function_word_indices;
+  size_t word_index = position->index;
+  for (uint64_t i = 0; i < count; ++i) {
+    if (pInsts[i].opcode == SpvOpFunction) {
+      function_starts.push_back(i);
+      function_word_indices.push_back(word_index);
+    }
+    word_index += pInsts[i].words.size();
+  }
+  const uint64_t module_count =
+      function_starts.empty() ? count : function_starts.front();
+  if (auto error =
+          spvValidateInstructionIDs(pInsts, module_count, state, position))
+    return error;
+
+  function_starts.push_back(count);
+  if (auto error = state.CheckInParallel(
+          function_word_indices.size(),
+          [pInsts, &state, &function_starts, &function_word_indices](size_t i) {
+            spv_position_t function_position = {0, 0,
+                                                function_word_indices[i]};
+            return spvValidateInstructionIDs(
+                pInsts + function_starts[i],
+                function_starts[i + 1] - function_starts[i], state,
+                &function_position);
+          }))
     return error;
+
+  position->index = word_index;
   return SPV_SUCCESS;
 }
 
@@ -151,6 +186,72 @@ spv_result_t ProcessExtensions(void* user_data,
   return SPV_REQUESTED_TERMINATION;
 }
 
+// A check done on every instruction as it is parsed.
+struct InstructionPass {
+  const char* name;
+  spv_result_t (*check)(ValidationState_t& _,
+                        const spv_parsed_instruction_t* inst);
+};
+
+// The checks done on every instruction, in the order in which they are done.
+const InstructionPass kInstructionPasses[] = {
+    {"CapabilityPass", libspirv::CapabilityPass},
+    {"DataRulesPass", libspirv::DataRulesPass},
+    {"IdPass", libspirv::IdPass},
+    {"ModuleLayoutPass", libspirv::ModuleLayoutPass},
+    {"CfgPass", libspirv::CfgPass},
+    {"InstructionPass", libspirv::InstructionPass},
+    {"TypeUniquePass", libspirv::TypeUniquePass},
+    {"ArithmeticsPass", libspirv::ArithmeticsPass},
+    {"CompositesPass", libspirv::CompositesPass},
+    {"ConversionPass", libspirv::ConversionPass},
+    {"DerivativesPass", libspirv::DerivativesPass},
+    {"LogicalsPass", libspirv::LogicalsPass},
+    {"BitwisePass", libspirv::BitwisePass},
+    {"ExtInstPass", libspirv::ExtInstPass},
+    {"ImagePass", libspirv::ImagePass},
+    {"AtomicsPass", libspirv::AtomicsPass},
+    {"BarriersPass", libspirv::BarriersPass},
+    {"PrimitivesPass", libspirv::PrimitivesPass},
+    {"LiteralsPass", libspirv::LiteralsPass},
+    {"NonUniformPass", libspirv::NonUniformPass},
+};
+const size_t kNumInstructionPasses =
+    sizeof(kInstructionPasses) / sizeof(kInstructionPasses[0]);
+
+// Prints the wall time spent by each check done on every instruction to |out|,
+// with the sizes of the module which the validation time depends on.
+void ReportInstructionPassTimes(std::ostream* out,
+                                ValidationState_t& vstate) {
+  if (!out) return;
+  size_t num_blocks = 0;
+  for (const auto& function : vstate.functions())
+    num_blocks += function.ordered_blocks().size();
+  *out << "Instructions: " << vstate.instruction_count()
+       << ", functions: " << vstate.functions().size()
+       << ", blocks: " << num_blocks
+       << ", ids: " << vstate.all_definitions().size() << std::endl;
+
+  // The stream belongs to the caller, so its format is restored afterwards.
+  const std::ios::fmtflags flags = out->flags();
+  const std::streamsize precision = out->precision(2);
+  const auto& times = vstate.instruction_pass_times();
+  *out << std::setw(30) << "Instruction check" << std::setw(12) << "WALL time"
+       << std::setw(16) << "ns/instruction" << std::endl;
+  for (size_t i = 0; i < times.size(); ++i) {
+    const double seconds =
+        std::chrono::duration<double>(times[i]).count();
+    *out << std::fixed << std::setw(30) << kInstructionPasses[i].name
+         << std::setw(12) << seconds << std::setw(16)
+         << (vstate.instruction_count()
+                 ? seconds * 1e9 / vstate.instruction_count()
+                 : 0.0)
+         << std::endl;
+  }
+  out->flags(flags);
+  out->precision(precision);
+}
+
 spv_result_t ProcessInstruction(void* user_data,
                                 const spv_parsed_instruction_t* inst) {
   ValidationState_t& _ = *(reinterpret_cast<ValidationState_t*>(user_data));
@@ -170,26 +271,18 @@ spv_result_t ProcessInstruction(void* user_data,
   }
 
   DebugInstructionPass(_, inst);
-  if (auto error = CapabilityPass(_, inst)) return error;
-  if (auto error = DataRulesPass(_, inst)) return error;
-  if (auto error = IdPass(_, inst)) return error;
-  if (auto error = ModuleLayoutPass(_, inst)) return error;
-  if (auto error = CfgPass(_, inst)) return error;
-  if (auto error = InstructionPass(_, inst)) return error;
-  if (auto error = TypeUniquePass(_, inst)) return error;
-  if (auto error = ArithmeticsPass(_, inst)) return error;
-  if (auto error = CompositesPass(_, inst)) return error;
-  if (auto error = ConversionPass(_, inst)) return error;
-  if (auto error = DerivativesPass(_, inst)) return error;
-  if (auto error = LogicalsPass(_, inst)) return error;
-  if (auto error = BitwisePass(_, inst)) return error;
-  if (auto error = ExtInstPass(_, inst)) return error;
-  if (auto error = ImagePass(_, inst)) return error;
-  if (auto error = AtomicsPass(_, inst)) return error;
-  if (auto error = BarriersPass(_, inst)) return error;
-  if (auto error = PrimitivesPass(_, inst)) return error;
-  if (auto error = LiteralsPass(_, inst)) return error;
-  if (auto error = NonUniformPass(_, inst)) return error;
+  auto& times = _.instruction_pass_times();
+  for (size_t i = 0; i < kNumInstructionPasses; ++i) {
+    spv_result_t error;
+    if (times.empty()) {
+      error = kInstructionPasses[i].check(_, inst);
+    } else {
+      const auto start = std::chrono::steady_clock::now();
+      error = kInstructionPasses[i].check(_, inst);
+      times[i] += std::chrono::steady_clock::now() - start;
+    }
+    if (error) return error;
+  }
 
   return SPV_SUCCESS;
 }
@@ -236,7 +329,7 @@ UNUSED(void PrintDotGraph(ValidationState_t& _, libspirv::Function func)) {
   }
 }
 
-spv_result_t ValidateBinaryUsingContextAndValidationState(
+spv_result_t ValidateBinaryUsingValidationState(
     const spv_context_t& context, const uint32_t* words, const size_t num_words,
     spv_diagnostic* pDiagnostic, ValidationState_t* vstate) {
   auto binary = std::unique_ptr<spv_const_binary_t>(
@@ -269,15 +362,23 @@ spv_result_t ValidateBinaryUsingContextAndValidationState(
 
   // Look for OpExtension instructions and register extensions.
   // Diagnostics if any will be produced in the next pass (ProcessInstruction).
-  spvBinaryParse(&context, vstate, words, num_words,
-                 /* parsed_header = */ nullptr, ProcessExtensions,
-                 /* diagnostic = */ nullptr);
+  {
+    SPIRV_TIMER_SCOPED(vstate->time_report_stream(), "ProcessExtensions", true);
+    spvBinaryParse(&context, vstate, words, num_words,
+                   /* parsed_header = */ nullptr, ProcessExtensions,
+                   /* diagnostic = */ nullptr);
+  }
 
   // NOTE: Parse the module and perform inline validation checks. These
   // checks do not require the the knowledge of the whole module.
-  if (auto error = spvBinaryParse(&context, vstate, words, num_words, setHeader,
-                                  ProcessInstruction, pDiagnostic))
-    return error;
+  vstate->setBinary(words, num_words);
+  {
+    SPIRV_TIMER_SCOPED(vstate->time_report_stream(), "ProcessInstruction",
+                       true);
+    if (auto error = spvBinaryParse(&context, vstate, words, num_words,
+                                    setHeader, ProcessInstruction, pDiagnostic))
+      return error;
+  }
 
   if (vstate->in_function_body())
     return vstate->diag(SPV_ERROR_INVALID_LAYOUT)
@@ -303,14 +404,31 @@ spv_result_t ValidateBinaryUsingContextAndValidationState(
 
   // Validate the preconditions involving adjacent instructions. e.g. SpvOpPhi
   // must only be preceeded by SpvOpLabel, SpvOpPhi, or SpvOpLine.
-  if (auto error = ValidateAdjacency(*vstate)) return error;
+  {
+    SPIRV_TIMER_SCOPED(vstate->time_report_stream(), "ValidateAdjacency", true);
+    if (auto error = ValidateAdjacency(*vstate)) return error;
+  }
 
   // CFG checks are performed after the binary has been parsed
   // and the CFGPass has collected information about the control flow
-  if (auto error = PerformCfgChecks(*vstate)) return error;
-  if (auto error = UpdateIdUse(*vstate)) return error;
-  if (auto error = CheckIdDefinitionDominateUse(*vstate)) return error;
-  if (auto error = ValidateDecorations(*vstate)) return error;
+  {
+    SPIRV_TIMER_SCOPED(vstate->time_report_stream(), "PerformCfgChecks", true);
+    if (auto error = PerformCfgChecks(*vstate)) return error;
+  }
+  {
+    SPIRV_TIMER_SCOPED(vstate->time_report_stream(), "UpdateIdUse", true);
+    if (auto error = UpdateIdUse(*vstate)) return error;
+  }
+  {
+    SPIRV_TIMER_SCOPED(vstate->time_report_stream(),
+                       "CheckIdDefinitionDominateUse", true);
+    if (auto error = CheckIdDefinitionDominateUse(*vstate)) return error;
+  }
+  {
+    SPIRV_TIMER_SCOPED(vstate->time_report_stream(), "ValidateDecorations",
+                       true);
+    if (auto error = ValidateDecorations(*vstate)) return error;
+  }
 
   // Entry point validation. Based on 2.16.1 (Universal Validation Rules) of the
   // SPIRV spec:
@@ -333,32 +451,43 @@ spv_result_t ValidateBinaryUsingContextAndValidationState(
     }
   }
 
-  // NOTE: Copy each instruction for easier processing
-  std::vector<spv_instruction_t> instructions;
-  // Expect average instruction length to be a bit over 2 words.
-  instructions.reserve(binary->wordCount / 2);
-  uint64_t index = SPV_INDEX_INSTRUCTION;
-  while (index < binary->wordCount) {
-    uint16_t wordCount;
-    uint16_t opcode;
-    spvOpcodeSplit(spvFixWord(binary->code[index], endian), &wordCount,
-                   &opcode);
-    spv_instruction_t inst;
-    spvInstructionCopy(&binary->code[index], static_cast<SpvOp>(opcode),
-                       wordCount, endian, &inst);
-    instructions.emplace_back(std::move(inst));
-    index += wordCount;
-  }
+  // NOTE: The instructions refer to the words kept by the validation state,
+  // which are in the host endianness.
+  std::vector<spv_validated_instruction_t> instructions;
+  instructions.reserve(vstate->ordered_instructions().size());
+  for (const auto& inst : vstate->ordered_instructions())
+    instructions.push_back({inst.opcode(), inst.words()});
 
   position.index = SPV_INDEX_INSTRUCTION;
-  if (auto error = spvValidateIDs(instructions.data(), instructions.size(),
-                                  *vstate, &position))
-    return error;
+  {
+    SPIRV_TIMER_SCOPED(vstate->time_report_stream(), "spvValidateIDs", true);
+    if (auto error = spvValidateIDs(instructions.data(), instructions.size(),
+                                    *vstate, &position))
+      return error;
+  }
 
-  if (auto error = ValidateBuiltIns(*vstate)) return error;
+  {
+    SPIRV_TIMER_SCOPED(vstate->time_report_stream(), "ValidateBuiltIns", true);
+    if (auto error = ValidateBuiltIns(*vstate)) return error;
+  }
 
   return SPV_SUCCESS;
 }
+
+spv_result_t ValidateBinaryUsingContextAndValidationState(
+    const spv_context_t& context, const uint32_t* words, const size_t num_words,
+    spv_diagnostic* pDiagnostic, ValidationState_t* vstate) {
+  std::ostream* time_report = vstate->time_report_stream();
+  if (time_report) {
+    vstate->instruction_pass_times().assign(
+        kNumInstructionPasses, std::chrono::steady_clock::duration::zero());
+  }
+  SPIRV_TIMER_DESCRIPTION(time_report, /* measure_mem_usage = */ true);
+  const spv_result_t result = ValidateBinaryUsingValidationState(
+      context, words, num_words, pDiagnostic, vstate);
+  ReportInstructionPassTimes(time_report, *vstate);
+  return result;
+}
 }  // anonymous namespace
 
 spv_result_t spvValidate(const spv_const_context context,
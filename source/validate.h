@@ -23,6 +23,7 @@
 #include "message.h"
 #include "spirv-tools/libspirv.h"
 #include "table.h"
+#include "util/array_view.h"
 
 namespace libspirv {
 
@@ -185,6 +186,13 @@ spv_result_t PrimitivesPass(ValidationState_t& _,
 
 }  // namespace libspirv
 
+/// An instruction of the stream given to spvValidateInstructionIDs.  Its words
+/// are owned by the validation state.
+struct spv_validated_instruction_t {
+  SpvOp opcode;
+  spvutils::ArrayView<uint32_t> words;
+};
+
 /// @brief Validate the ID usage of the instruction stream
 ///
 /// @param[in] pInsts stream of instructions
@@ -193,10 +201,9 @@ spv_result_t PrimitivesPass(ValidationState_t& _,
 /// @param[in,out] position current position in the stream
 ///
 /// @return result code
-spv_result_t spvValidateInstructionIDs(const spv_instruction_t* pInsts,
-                                       const uint64_t instCount,
-                                       const libspirv::ValidationState_t& state,
-                                       spv_position position);
+spv_result_t spvValidateInstructionIDs(
+    const spv_validated_instruction_t* pInsts, const uint64_t instCount,
+    const libspirv::ValidationState_t& state, spv_position position);
 
 /// @brief Validate the ID's within a SPIR-V binary
 ///
@@ -207,7 +214,7 @@ spv_result_t spvValidateInstructionIDs(const spv_instruction_t* pInsts,
 /// @param[in] consumer message consumer callback
 ///
 /// @return result code
-spv_result_t spvValidateIDs(const spv_instruction_t* pInstructions,
+spv_result_t spvValidateIDs(const spv_validated_instruction_t* pInstructions,
                             const uint64_t count, const uint32_t bound,
                             spv_position position,
                             const spvtools::MessageConsumer& consumer);
@@ -216,7 +223,8 @@ namespace spvtools {
 // Performs validation for the SPIRV-V module binary.
 // The main difference between this API and spvValidateBinary is that the
 // "Validation State" is not destroyed upon function return; it lives on and is
-// pointed to by the vstate unique_ptr.
+// pointed to by the vstate unique_ptr.  It refers to the |words|, which must
+// outlive it.
 spv_result_t ValidateBinaryAndKeepValidationState(
     const spv_const_context context, spv_const_validator_options options,
     const uint32_t* words, const size_t num_words, spv_diagnostic* pDiagnostic,
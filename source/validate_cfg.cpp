@@ -28,6 +28,7 @@
 #include <vector>
 
 #include "spirv_validator_options.h"
+#include "util/dominators.h"
 #include "val/basic_block.h"
 #include "val/construct.h"
 #include "val/function.h"
@@ -256,109 +257,145 @@ spv_result_t StructuredControlFlowChecks(
   return SPV_SUCCESS;
 }
 
-spv_result_t PerformCfgChecks(ValidationState_t& _) {
-  for (auto& function : _.functions()) {
-    // Check all referenced blocks are defined within a function
-    if (function.undefined_block_count() != 0) {
-      string undef_blocks("{");
-      bool first = true;
-      for (auto undefined_block : function.undefined_blocks()) {
-        undef_blocks += _.getIdName(undefined_block);
-        if (!first) {
-          undef_blocks += " ";
-        }
-        first = false;
-      }
-      return _.diag(SPV_ERROR_INVALID_CFG)
-             << "Block(s) " << undef_blocks << "}"
-             << " are referenced but not defined in function "
-             << _.getIdName(function.id());
+// Sets the immediate dominator and immediate post dominator of each block of
+// |function|, and its position in the dominator and post dominator trees.
+// The dominator tree is rooted at the first block, and the post dominator tree
+// at the pseudo exit block of the augmented CFG.
+void SetDominators(Function& function) {
+  // Number the blocks densely: the pseudo entry block first, then the blocks
+  // of the function in order, then the pseudo exit block.
+  vector<BasicBlock*> blocks;
+  blocks.reserve(function.ordered_blocks().size() + 2);
+  blocks.push_back(function.pseudo_entry_block());
+  blocks.insert(blocks.end(), function.ordered_blocks().begin(),
+                function.ordered_blocks().end());
+  blocks.push_back(function.pseudo_exit_block());
+  unordered_map<cbb_ptr, uint32_t> index;
+  for (uint32_t i = 0; i < blocks.size(); ++i) index[blocks[i]] = i;
+
+  vector<pair<uint32_t, uint32_t>> edges;
+  const auto successors = function.AugmentedCFGSuccessorsFunction();
+  for (uint32_t i = 0; i < blocks.size(); ++i) {
+    for (const BasicBlock* successor : *successors(blocks[i])) {
+      edges.emplace_back(i, index[successor]);
     }
+  }
 
-    // Set each block's immediate dominator and immediate postdominator,
-    // and find all back-edges.
-    //
-    // We want to analyze all the blocks in the function, even in degenerate
-    // control flow cases including unreachable blocks.  So use the augmented
-    // CFG to ensure we cover all the blocks.
-    vector<const BasicBlock*> postorder;
-    vector<const BasicBlock*> postdom_postorder;
-    vector<pair<uint32_t, uint32_t>> back_edges;
-    auto ignore_block = [](cbb_ptr) {};
-    auto ignore_edge = [](cbb_ptr, cbb_ptr) {};
-    if (!function.ordered_blocks().empty()) {
-      /// calculate dominators
-      spvtools::CFA<libspirv::BasicBlock>::DepthFirstTraversal(
-          function.first_block(), function.AugmentedCFGSuccessorsFunction(),
-          ignore_block, [&](cbb_ptr b) { postorder.push_back(b); },
-          ignore_edge);
-      auto edges = spvtools::CFA<libspirv::BasicBlock>::CalculateDominators(
-          postorder, function.AugmentedCFGPredecessorsFunction());
-      for (auto edge : edges) {
-        edge.first->SetImmediateDominator(edge.second);
-      }
+  const uint32_t num_blocks = static_cast<uint32_t>(blocks.size());
+  const spvutils::Dominators dominators(num_blocks, edges, 1);
+  const spvutils::Dominators post_dominators(num_blocks, edges,
+                                             num_blocks - 1, true);
+  for (uint32_t i = 0; i < num_blocks; ++i) {
+    BasicBlock* block = blocks[i];
+    // The root of a tree is its own immediate dominator.
+    if (dominators.reachable(i)) {
+      const uint32_t idom = dominators.immediate_dominator(i);
+      block->SetImmediateDominator(
+          blocks[idom == spvutils::Dominators::kNone ? i : idom]);
+      block->SetDominatorTreePosition(blocks[dominators.root()],
+                                      dominators.tree_preorder_number(i),
+                                      dominators.tree_postorder_number(i));
+    }
+    if (post_dominators.reachable(i)) {
+      const uint32_t ipdom = post_dominators.immediate_dominator(i);
+      block->SetImmediatePostDominator(
+          blocks[ipdom == spvutils::Dominators::kNone ? i : ipdom]);
+      block->SetPostDominatorTreePosition(
+          blocks[post_dominators.root()],
+          post_dominators.tree_preorder_number(i),
+          post_dominators.tree_postorder_number(i));
+    }
+  }
+}
 
-      /// calculate post dominators
-      spvtools::CFA<libspirv::BasicBlock>::DepthFirstTraversal(
-          function.pseudo_exit_block(),
-          function.AugmentedCFGPredecessorsFunction(), ignore_block,
-          [&](cbb_ptr b) { postdom_postorder.push_back(b); }, ignore_edge);
-      auto postdom_edges =
-          spvtools::CFA<libspirv::BasicBlock>::CalculateDominators(
-              postdom_postorder, function.AugmentedCFGSuccessorsFunction());
-      for (auto edge : postdom_edges) {
-        edge.first->SetImmediatePostDominator(edge.second);
+// Performs the CFG checks of |function|, which only modify its own state.
+spv_result_t PerformFunctionCfgChecks(ValidationState_t& _,
+                                      Function& function) {
+  // Check all referenced blocks are defined within a function
+  if (function.undefined_block_count() != 0) {
+    string undef_blocks("{");
+    bool first = true;
+    for (auto undefined_block : function.undefined_blocks()) {
+      undef_blocks += _.getIdName(undefined_block);
+      if (!first) {
+        undef_blocks += " ";
       }
-      /// calculate back edges.
-      spvtools::CFA<libspirv::BasicBlock>::DepthFirstTraversal(
-          function.pseudo_entry_block(),
-          function
-              .AugmentedCFGSuccessorsFunctionIncludingHeaderToContinueEdge(),
-          ignore_block, ignore_block, [&](cbb_ptr from, cbb_ptr to) {
-            back_edges.emplace_back(from->id(), to->id());
-          });
+      first = false;
     }
-    UpdateContinueConstructExitBlocks(function, back_edges);
-
-    auto& blocks = function.ordered_blocks();
-    if (!blocks.empty()) {
-      // Check if the order of blocks in the binary appear before the blocks
-      // they dominate
-      for (auto block = begin(blocks) + 1; block != end(blocks); ++block) {
-        if (auto idom = (*block)->immediate_dominator()) {
-          if (idom != function.pseudo_entry_block() &&
-              block == std::find(begin(blocks), block, idom)) {
-            return _.diag(SPV_ERROR_INVALID_CFG)
-                   << "Block " << _.getIdName((*block)->id())
-                   << " appears in the binary before its dominator "
-                   << _.getIdName(idom->id());
-          }
+    return _.diag(SPV_ERROR_INVALID_CFG)
+           << "Block(s) " << undef_blocks << "}"
+           << " are referenced but not defined in function "
+           << _.getIdName(function.id());
+  }
+
+  // Set each block's immediate dominator and immediate postdominator,
+  // and find all back-edges.
+  //
+  // We want to analyze all the blocks in the function, even in degenerate
+  // control flow cases including unreachable blocks.  So use the augmented
+  // CFG to ensure we cover all the blocks.
+  vector<pair<uint32_t, uint32_t>> back_edges;
+  auto ignore_block = [](cbb_ptr) {};
+  if (!function.ordered_blocks().empty()) {
+    SetDominators(function);
+
+    /// calculate back edges.
+    spvtools::CFA<libspirv::BasicBlock>::DepthFirstTraversal(
+        function.pseudo_entry_block(),
+        function
+            .AugmentedCFGSuccessorsFunctionIncludingHeaderToContinueEdge(),
+        ignore_block, ignore_block, [&](cbb_ptr from, cbb_ptr to) {
+          back_edges.emplace_back(from->id(), to->id());
+        });
+  }
+  UpdateContinueConstructExitBlocks(function, back_edges);
+
+  auto& blocks = function.ordered_blocks();
+  if (!blocks.empty()) {
+    // Check if the order of blocks in the binary appear before the blocks
+    // they dominate
+    unordered_set<cbb_ptr> preceding_blocks = {blocks.front()};
+    for (auto block = begin(blocks) + 1; block != end(blocks); ++block) {
+      if (auto idom = (*block)->immediate_dominator()) {
+        if (idom != function.pseudo_entry_block() &&
+            preceding_blocks.count(idom) == 0) {
+          return _.diag(SPV_ERROR_INVALID_CFG)
+                 << "Block " << _.getIdName((*block)->id())
+                 << " appears in the binary before its dominator "
+                 << _.getIdName(idom->id());
         }
       }
-      // If we have structed control flow, check that no block has a control
-      // flow nesting depth larger than the limit.
-      if (_.HasCapability(SpvCapabilityShader)) {
-        const int control_flow_nesting_depth_limit =
-            _.options()->universal_limits_.max_control_flow_nesting_depth;
-        for (auto block = begin(blocks); block != end(blocks); ++block) {
-          if (function.GetBlockDepth(*block) >
-              control_flow_nesting_depth_limit) {
-            return _.diag(SPV_ERROR_INVALID_CFG)
-                   << "Maximum Control Flow nesting depth exceeded.";
-          }
+      preceding_blocks.insert(*block);
+    }
+    // If we have structed control flow, check that no block has a control
+    // flow nesting depth larger than the limit.
+    if (_.HasCapability(SpvCapabilityShader)) {
+      const int control_flow_nesting_depth_limit =
+          _.options()->universal_limits_.max_control_flow_nesting_depth;
+      for (auto block = begin(blocks); block != end(blocks); ++block) {
+        if (function.GetBlockDepth(*block) > control_flow_nesting_depth_limit) {
+          return _.diag(SPV_ERROR_INVALID_CFG)
+                 << "Maximum Control Flow nesting depth exceeded.";
         }
       }
     }
+  }
 
-    /// Structured control flow checks are only required for shader capabilities
-    if (_.HasCapability(SpvCapabilityShader)) {
-      if (auto error = StructuredControlFlowChecks(_, function, back_edges))
-        return error;
-    }
+  /// Structured control flow checks are only required for shader capabilities
+  if (_.HasCapability(SpvCapabilityShader)) {
+    if (auto error = StructuredControlFlowChecks(_, function, back_edges))
+      return error;
   }
   return SPV_SUCCESS;
 }
 
+spv_result_t PerformCfgChecks(ValidationState_t& _) {
+  auto& functions = _.functions();
+  return _.CheckInParallel(functions.size(), [&_, &functions](size_t i) {
+    return PerformFunctionCfgChecks(_, functions[i]);
+  });
+}
+
 spv_result_t CfgPass(ValidationState_t& _,
                      const spv_parsed_instruction_t* inst) {
   SpvOp opcode = static_cast<SpvOp>(inst->opcode);
@@ -48,7 +48,7 @@ namespace {
 
 class idUsage {
  public:
-  idUsage(spv_const_context context, const spv_instruction_t* pInsts,
+  idUsage(spv_const_context context, const spv_validated_instruction_t* pInsts,
           const uint64_t instCountArg, const SpvMemoryModel memoryModelArg,
           const SpvAddressingModel addressingModelArg,
           const ValidationState_t& module, const vector<uint32_t>& entry_points,
@@ -66,17 +66,17 @@ class idUsage {
         module_(module),
         entry_points_(entry_points) {}
 
-  bool isValid(const spv_instruction_t* inst);
+  bool isValid(const spv_validated_instruction_t* inst);
 
   template <SpvOp>
-  bool isValid(const spv_instruction_t* inst, const spv_opcode_desc);
+  bool isValid(const spv_validated_instruction_t* inst, const spv_opcode_desc);
 
  private:
   const spv_target_env targetEnv;
   const spv_opcode_table opcodeTable;
   const spv_operand_table operandTable;
   const spv_ext_inst_table extInstTable;
-  const spv_instruction_t* const firstInst;
+  const spv_validated_instruction_t* const firstInst;
   const uint64_t instCount;
   const SpvMemoryModel memoryModel;
   const SpvAddressingModel addressingModel;
@@ -114,7 +114,7 @@ class idUsage {
 
 #if 0
 template <>
-bool idUsage::isValid<SpvOpUndef>(const spv_instruction_t *inst,
+bool idUsage::isValid<SpvOpUndef>(const spv_validated_instruction_t *inst,
                                   const spv_opcode_desc) {
   assert(0 && "Unimplemented!");
   return false;
@@ -122,7 +122,7 @@ bool idUsage::isValid<SpvOpUndef>(const spv_instruction_t *inst,
 #endif  // 0
 
 template <>
-bool idUsage::isValid<SpvOpMemberName>(const spv_instruction_t* inst,
+bool idUsage::isValid<SpvOpMemberName>(const spv_validated_instruction_t* inst,
                                        const spv_opcode_desc) {
   auto typeIndex = 1;
   auto type = module_.FindDef(inst->words[typeIndex]);
@@ -145,7 +145,7 @@ bool idUsage::isValid<SpvOpMemberName>(const spv_instruction_t* inst,
 }
 
 template <>
-bool idUsage::isValid<SpvOpLine>(const spv_instruction_t* inst,
+bool idUsage::isValid<SpvOpLine>(const spv_validated_instruction_t* inst,
                                  const spv_opcode_desc) {
   auto fileIndex = 1;
   auto file = module_.FindDef(inst->words[fileIndex]);
@@ -158,7 +158,7 @@ bool idUsage::isValid<SpvOpLine>(const spv_instruction_t* inst,
 }
 
 template <>
-bool idUsage::isValid<SpvOpDecorate>(const spv_instruction_t* inst,
+bool idUsage::isValid<SpvOpDecorate>(const spv_validated_instruction_t* inst,
                                      const spv_opcode_desc) {
   auto decorationIndex = 2;
   auto decoration = inst->words[decorationIndex];
@@ -177,8 +177,8 @@ bool idUsage::isValid<SpvOpDecorate>(const spv_instruction_t* inst,
 }
 
 template <>
-bool idUsage::isValid<SpvOpMemberDecorate>(const spv_instruction_t* inst,
-                                           const spv_opcode_desc) {
+bool idUsage::isValid<SpvOpMemberDecorate>(
+    const spv_validated_instruction_t* inst, const spv_opcode_desc) {
   auto structTypeIndex = 1;
   auto structType = module_.FindDef(inst->words[structTypeIndex]);
   if (!structType || SpvOpTypeStruct != structType->opcode()) {
@@ -203,8 +203,8 @@ bool idUsage::isValid<SpvOpMemberDecorate>(const spv_instruction_t* inst,
 }
 
 template <>
-bool idUsage::isValid<SpvOpDecorationGroup>(const spv_instruction_t* inst,
-                                            const spv_opcode_desc) {
+bool idUsage::isValid<SpvOpDecorationGroup>(
+    const spv_validated_instruction_t* inst, const spv_opcode_desc) {
   auto decorationGroupIndex = 1;
   auto decorationGroup = module_.FindDef(inst->words[decorationGroupIndex]);
 
@@ -223,8 +223,8 @@ bool idUsage::isValid<SpvOpDecorationGroup>(const spv_instruction_t* inst,
 }
 
 template <>
-bool idUsage::isValid<SpvOpGroupDecorate>(const spv_instruction_t* inst,
-                                          const spv_opcode_desc) {
+bool idUsage::isValid<SpvOpGroupDecorate>(
+    const spv_validated_instruction_t* inst, const spv_opcode_desc) {
   auto decorationGroupIndex = 1;
   auto decorationGroup = module_.FindDef(inst->words[decorationGroupIndex]);
   if (!decorationGroup || SpvOpDecorationGroup != decorationGroup->opcode()) {
@@ -237,8 +237,8 @@ bool idUsage::isValid<SpvOpGroupDecorate>(const spv_instruction_t* inst,
 }
 
 template <>
-bool idUsage::isValid<SpvOpGroupMemberDecorate>(const spv_instruction_t* inst,
-                                                const spv_opcode_desc) {
+bool idUsage::isValid<SpvOpGroupMemberDecorate>(
+    const spv_validated_instruction_t* inst, const spv_opcode_desc) {
   auto decorationGroupIndex = 1;
   auto decorationGroup = module_.FindDef(inst->words[decorationGroupIndex]);
   if (!decorationGroup || SpvOpDecorationGroup != decorationGroup->opcode()) {
@@ -274,12 +274,12 @@ bool idUsage::isValid<SpvOpGroupMemberDecorate>(const spv_instruction_t* inst,
 
 #if 0
 template <>
-bool idUsage::isValid<SpvOpExtInst>(const spv_instruction_t *inst,
+bool idUsage::isValid<SpvOpExtInst>(const spv_validated_instruction_t *inst,
                                     const spv_opcode_desc opcodeEntry) {}
 #endif  // 0
 
 template <>
-bool idUsage::isValid<SpvOpEntryPoint>(const spv_instruction_t* inst,
+bool idUsage::isValid<SpvOpEntryPoint>(const spv_validated_instruction_t* inst,
                                        const spv_opcode_desc) {
   auto entryPointIndex = 2;
   auto entryPoint = module_.FindDef(inst->words[entryPointIndex]);
@@ -314,8 +314,8 @@ bool idUsage::isValid<SpvOpEntryPoint>(const spv_instruction_t* inst,
 }
 
 template <>
-bool idUsage::isValid<SpvOpExecutionMode>(const spv_instruction_t* inst,
-                                          const spv_opcode_desc) {
+bool idUsage::isValid<SpvOpExecutionMode>(
+    const spv_validated_instruction_t* inst, const spv_opcode_desc) {
   auto entryPointIndex = 1;
   auto entryPointID = inst->words[entryPointIndex];
   auto found =
@@ -331,7 +331,7 @@ bool idUsage::isValid<SpvOpExecutionMode>(const spv_instruction_t* inst,
 }
 
 template <>
-bool idUsage::isValid<SpvOpTypeVector>(const spv_instruction_t* inst,
+bool idUsage::isValid<SpvOpTypeVector>(const spv_validated_instruction_t* inst,
                                        const spv_opcode_desc) {
   auto componentIndex = 2;
   auto componentType = module_.FindDef(inst->words[componentIndex]);
@@ -345,7 +345,7 @@ bool idUsage::isValid<SpvOpTypeVector>(const spv_instruction_t* inst,
 }
 
 template <>
-bool idUsage::isValid<SpvOpTypeMatrix>(const spv_instruction_t* inst,
+bool idUsage::isValid<SpvOpTypeMatrix>(const spv_validated_instruction_t* inst,
                                        const spv_opcode_desc) {
   auto columnTypeIndex = 2;
   auto columnType = module_.FindDef(inst->words[columnTypeIndex]);
@@ -359,7 +359,7 @@ bool idUsage::isValid<SpvOpTypeMatrix>(const spv_instruction_t* inst,
 }
 
 template <>
-bool idUsage::isValid<SpvOpTypeSampler>(const spv_instruction_t*,
+bool idUsage::isValid<SpvOpTypeSampler>(const spv_validated_instruction_t*,
                                         const spv_opcode_desc) {
   // OpTypeSampler takes no arguments in Rev31 and beyond.
   return true;
@@ -369,8 +369,8 @@ bool idUsage::isValid<SpvOpTypeSampler>(const spv_instruction_t*,
 // constant-defining instruction (either OpConstant or
 // OpSpecConstant). typeWords are the words of the constant's-type-defining
 // OpTypeInt.
-bool aboveZero(const vector<uint32_t>& constWords,
-               const vector<uint32_t>& typeWords) {
+bool aboveZero(spvutils::ArrayView<uint32_t> constWords,
+               spvutils::ArrayView<uint32_t> typeWords) {
   const uint32_t width = typeWords[2];
   const bool is_signed = typeWords[3] > 0;
   const uint32_t loWord = constWords[3];
@@ -386,7 +386,7 @@ bool aboveZero(const vector<uint32_t>& constWords,
 }
 
 template <>
-bool idUsage::isValid<SpvOpTypeArray>(const spv_instruction_t* inst,
+bool idUsage::isValid<SpvOpTypeArray>(const spv_validated_instruction_t* inst,
                                       const spv_opcode_desc) {
   auto elementTypeIndex = 2;
   auto elementType = module_.FindDef(inst->words[elementTypeIndex]);
@@ -435,8 +435,8 @@ bool idUsage::isValid<SpvOpTypeArray>(const spv_instruction_t* inst,
 }
 
 template <>
-bool idUsage::isValid<SpvOpTypeRuntimeArray>(const spv_instruction_t* inst,
-                                             const spv_opcode_desc) {
+bool idUsage::isValid<SpvOpTypeRuntimeArray>(
+    const spv_validated_instruction_t* inst, const spv_opcode_desc) {
   auto elementTypeIndex = 2;
   auto elementType = module_.FindDef(inst->words[elementTypeIndex]);
   if (!elementType || !spvOpcodeGeneratesType(elementType->opcode())) {
@@ -449,7 +449,7 @@ bool idUsage::isValid<SpvOpTypeRuntimeArray>(const spv_instruction_t* inst,
 }
 
 template <>
-bool idUsage::isValid<SpvOpTypeStruct>(const spv_instruction_t* inst,
+bool idUsage::isValid<SpvOpTypeStruct>(const spv_validated_instruction_t* inst,
                                        const spv_opcode_desc) {
   ValidationState_t& vstate = const_cast<ValidationState_t&>(module_);
   const uint32_t struct_id = inst->words[1];
@@ -520,7 +520,7 @@ bool idUsage::isValid<SpvOpTypeStruct>(const spv_instruction_t* inst,
 }
 
 template <>
-bool idUsage::isValid<SpvOpTypePointer>(const spv_instruction_t* inst,
+bool idUsage::isValid<SpvOpTypePointer>(const spv_validated_instruction_t* inst,
                                         const spv_opcode_desc) {
   auto typeIndex = 3;
   auto type = module_.FindDef(inst->words[typeIndex]);
@@ -533,8 +533,8 @@ bool idUsage::isValid<SpvOpTypePointer>(const spv_instruction_t* inst,
 }
 
 template <>
-bool idUsage::isValid<SpvOpTypeFunction>(const spv_instruction_t* inst,
-                                         const spv_opcode_desc) {
+bool idUsage::isValid<SpvOpTypeFunction>(
+    const spv_validated_instruction_t* inst, const spv_opcode_desc) {
   auto returnTypeIndex = 2;
   auto returnType = module_.FindDef(inst->words[returnTypeIndex]);
   if (!returnType || !spvOpcodeGeneratesType(returnType->opcode())) {
@@ -566,15 +566,15 @@ bool idUsage::isValid<SpvOpTypeFunction>(const spv_instruction_t* inst,
 }
 
 template <>
-bool idUsage::isValid<SpvOpTypePipe>(const spv_instruction_t*,
+bool idUsage::isValid<SpvOpTypePipe>(const spv_validated_instruction_t*,
                                      const spv_opcode_desc) {
   // OpTypePipe has no ID arguments.
   return true;
 }
 
 template <>
-bool idUsage::isValid<SpvOpConstantTrue>(const spv_instruction_t* inst,
-                                         const spv_opcode_desc) {
+bool idUsage::isValid<SpvOpConstantTrue>(
+    const spv_validated_instruction_t* inst, const spv_opcode_desc) {
   auto resultTypeIndex = 1;
   auto resultType = module_.FindDef(inst->words[resultTypeIndex]);
   if (!resultType || SpvOpTypeBool != resultType->opcode()) {
@@ -587,8 +587,8 @@ bool idUsage::isValid<SpvOpConstantTrue>(const spv_instruction_t* inst,
 }
 
 template <>
-bool idUsage::isValid<SpvOpConstantFalse>(const spv_instruction_t* inst,
-                                          const spv_opcode_desc) {
+bool idUsage::isValid<SpvOpConstantFalse>(
+    const spv_validated_instruction_t* inst, const spv_opcode_desc) {
   auto resultTypeIndex = 1;
   auto resultType = module_.FindDef(inst->words[resultTypeIndex]);
   if (!resultType || SpvOpTypeBool != resultType->opcode()) {
@@ -601,8 +601,8 @@ bool idUsage::isValid<SpvOpConstantFalse>(const spv_instruction_t* inst,
 }
 
 template <>
-bool idUsage::isValid<SpvOpConstantComposite>(const spv_instruction_t* inst,
-                                              const spv_opcode_desc) {
+bool idUsage::isValid<SpvOpConstantComposite>(
+    const spv_validated_instruction_t* inst, const spv_opcode_desc) {
   auto resultTypeIndex = 1;
   auto resultType = module_.FindDef(inst->words[resultTypeIndex]);
   if (!resultType || !spvOpcodeIsComposite(resultType->opcode())) {
@@ -782,8 +782,8 @@ bool idUsage::isValid<SpvOpConstantComposite>(const spv_instruction_t* inst,
 }
 
 template <>
-bool idUsage::isValid<SpvOpConstantSampler>(const spv_instruction_t* inst,
-                                            const spv_opcode_desc) {
+bool idUsage::isValid<SpvOpConstantSampler>(
+    const spv_validated_instruction_t* inst, const spv_opcode_desc) {
   auto resultTypeIndex = 1;
   auto resultType = module_.FindDef(inst->words[resultTypeIndex]);
   if (!resultType || SpvOpTypeSampler != resultType->opcode()) {
@@ -798,7 +798,7 @@ bool idUsage::isValid<SpvOpConstantSampler>(const spv_instruction_t* inst,
 // True if instruction defines a type that can have a null value, as defined by
 // the SPIR-V spec.  Tracks composite-type components through module to check
 // nullability transitively.
-bool IsTypeNullable(const vector<uint32_t>& instruction,
+bool IsTypeNullable(spvutils::ArrayView<uint32_t> instruction,
                     const ValidationState_t& module) {
   uint16_t opcode;
   uint16_t word_count;
@@ -833,8 +833,8 @@ bool IsTypeNullable(const vector<uint32_t>& instruction,
 }
 
 template <>
-bool idUsage::isValid<SpvOpConstantNull>(const spv_instruction_t* inst,
-                                         const spv_opcode_desc) {
+bool idUsage::isValid<SpvOpConstantNull>(
+    const spv_validated_instruction_t* inst, const spv_opcode_desc) {
   auto resultTypeIndex = 1;
   auto resultType = module_.FindDef(inst->words[resultTypeIndex]);
   if (!resultType || !IsTypeNullable(resultType->words(), module_)) {
@@ -847,8 +847,8 @@ bool idUsage::isValid<SpvOpConstantNull>(const spv_instruction_t* inst,
 }
 
 template <>
-bool idUsage::isValid<SpvOpSpecConstantTrue>(const spv_instruction_t* inst,
-                                             const spv_opcode_desc) {
+bool idUsage::isValid<SpvOpSpecConstantTrue>(
+    const spv_validated_instruction_t* inst, const spv_opcode_desc) {
   auto resultTypeIndex = 1;
   auto resultType = module_.FindDef(inst->words[resultTypeIndex]);
   if (!resultType || SpvOpTypeBool != resultType->opcode()) {
@@ -861,8 +861,8 @@ bool idUsage::isValid<SpvOpSpecConstantTrue>(const spv_instruction_t* inst,
 }
 
 template <>
-bool idUsage::isValid<SpvOpSpecConstantFalse>(const spv_instruction_t* inst,
-                                              const spv_opcode_desc) {
+bool idUsage::isValid<SpvOpSpecConstantFalse>(
+    const spv_validated_instruction_t* inst, const spv_opcode_desc) {
   auto resultTypeIndex = 1;
   auto resultType = module_.FindDef(inst->words[resultTypeIndex]);
   if (!resultType || SpvOpTypeBool != resultType->opcode()) {
@@ -875,8 +875,8 @@ bool idUsage::isValid<SpvOpSpecConstantFalse>(const spv_instruction_t* inst,
 }
 
 template <>
-bool idUsage::isValid<SpvOpSampledImage>(const spv_instruction_t* inst,
-                                         const spv_opcode_desc) {
+bool idUsage::isValid<SpvOpSampledImage>(
+    const spv_validated_instruction_t* inst, const spv_opcode_desc) {
   auto resultTypeIndex = 2;
   auto resultID = inst->words[resultTypeIndex];
   auto sampledImageInstr = module_.FindDef(resultID);
@@ -923,8 +923,8 @@ bool idUsage::isValid<SpvOpSampledImage>(const spv_instruction_t* inst,
 }
 
 template <>
-bool idUsage::isValid<SpvOpSpecConstantComposite>(const spv_instruction_t* inst,
-                                                  const spv_opcode_desc) {
+bool idUsage::isValid<SpvOpSpecConstantComposite>(
+    const spv_validated_instruction_t* inst, const spv_opcode_desc) {
   // The result type must be a composite type.
   auto resultTypeIndex = 1;
   auto resultType = module_.FindDef(inst->words[resultTypeIndex]);
@@ -1116,11 +1116,12 @@ bool idUsage::isValid<SpvOpSpecConstantComposite>(const spv_instruction_t* inst,
 
 #if 0
 template <>
-bool idUsage::isValid<SpvOpSpecConstantOp>(const spv_instruction_t *inst) {}
+bool idUsage::isValid<SpvOpSpecConstantOp>(
+    const spv_validated_instruction_t *inst) {}
 #endif
 
 template <>
-bool idUsage::isValid<SpvOpVariable>(const spv_instruction_t* inst,
+bool idUsage::isValid<SpvOpVariable>(const spv_validated_instruction_t* inst,
                                      const spv_opcode_desc) {
   auto resultTypeIndex = 1;
   auto resultType = module_.FindDef(inst->words[resultTypeIndex]);
@@ -1150,7 +1151,7 @@ bool idUsage::isValid<SpvOpVariable>(const spv_instruction_t* inst,
 }
 
 template <>
-bool idUsage::isValid<SpvOpLoad>(const spv_instruction_t* inst,
+bool idUsage::isValid<SpvOpLoad>(const spv_validated_instruction_t* inst,
                                  const spv_opcode_desc) {
   auto resultTypeIndex = 1;
   auto resultType = module_.FindDef(inst->words[resultTypeIndex]);
@@ -1193,7 +1194,7 @@ bool idUsage::isValid<SpvOpLoad>(const spv_instruction_t* inst,
 }
 
 template <>
-bool idUsage::isValid<SpvOpStore>(const spv_instruction_t* inst,
+bool idUsage::isValid<SpvOpStore>(const spv_validated_instruction_t* inst,
                                   const spv_opcode_desc) {
   const bool uses_variable_pointer =
       module_.features().variable_pointers ||
@@ -1286,7 +1287,7 @@ bool idUsage::isValid<SpvOpStore>(const spv_instruction_t* inst,
 }
 
 template <>
-bool idUsage::isValid<SpvOpCopyMemory>(const spv_instruction_t* inst,
+bool idUsage::isValid<SpvOpCopyMemory>(const spv_validated_instruction_t* inst,
                                        const spv_opcode_desc) {
   auto targetIndex = 1;
   auto target = module_.FindDef(inst->words[targetIndex]);
@@ -1313,8 +1314,8 @@ bool idUsage::isValid<SpvOpCopyMemory>(const spv_instruction_t* inst,
 }
 
 template <>
-bool idUsage::isValid<SpvOpCopyMemorySized>(const spv_instruction_t* inst,
-                                            const spv_opcode_desc) {
+bool idUsage::isValid<SpvOpCopyMemorySized>(
+    const spv_validated_instruction_t* inst, const spv_opcode_desc) {
   auto targetIndex = 1;
   auto target = module_.FindDef(inst->words[targetIndex]);
   if (!target) return false;
@@ -1374,7 +1375,7 @@ bool idUsage::isValid<SpvOpCopyMemorySized>(const spv_instruction_t* inst,
 }
 
 template <>
-bool idUsage::isValid<SpvOpAccessChain>(const spv_instruction_t* inst,
+bool idUsage::isValid<SpvOpAccessChain>(const spv_validated_instruction_t* inst,
                                         const spv_opcode_desc) {
   std::string instr_name =
       "Op" + std::string(spvOpcodeString(static_cast<SpvOp>(inst->opcode)));
@@ -1521,13 +1522,15 @@ bool idUsage::isValid<SpvOpAccessChain>(const spv_instruction_t* inst,
 
 template <>
 bool idUsage::isValid<SpvOpInBoundsAccessChain>(
-    const spv_instruction_t* inst, const spv_opcode_desc opcodeEntry) {
+    const spv_validated_instruction_t* inst,
+    const spv_opcode_desc opcodeEntry) {
   return isValid<SpvOpAccessChain>(inst, opcodeEntry);
 }
 
 template <>
-bool idUsage::isValid<SpvOpPtrAccessChain>(const spv_instruction_t* inst,
-                                           const spv_opcode_desc opcodeEntry) {
+bool idUsage::isValid<SpvOpPtrAccessChain>(
+    const spv_validated_instruction_t* inst,
+    const spv_opcode_desc opcodeEntry) {
   // OpPtrAccessChain's validation rules are similar to OpAccessChain, with one
   // difference: word 4 must be id of an integer (Element <id>).
   // The grammar guarantees that there are at least 5 words in the instruction
@@ -1535,38 +1538,43 @@ bool idUsage::isValid<SpvOpPtrAccessChain>(const spv_instruction_t* inst,
   int elem_index = 4;
   // We can remove the Element <id> from the instruction words, and simply call
   // the validation code of OpAccessChain.
-  spv_instruction_t new_inst = *inst;
-  new_inst.words.erase(new_inst.words.begin() + elem_index);
+  std::vector<uint32_t> words(inst->words.begin(), inst->words.end());
+  words.erase(words.begin() + elem_index);
+  const spv_validated_instruction_t new_inst = {
+      inst->opcode, spvutils::ArrayView<uint32_t>(words.data(), words.size())};
   return isValid<SpvOpAccessChain>(&new_inst, opcodeEntry);
 }
 
 template <>
 bool idUsage::isValid<SpvOpInBoundsPtrAccessChain>(
-    const spv_instruction_t* inst, const spv_opcode_desc opcodeEntry) {
+    const spv_validated_instruction_t* inst,
+    const spv_opcode_desc opcodeEntry) {
   // Has the same validation rules as OpPtrAccessChain
   return isValid<SpvOpPtrAccessChain>(inst, opcodeEntry);
 }
 
 #if 0
 template <>
-bool idUsage::isValid<SpvOpArrayLength>(const spv_instruction_t *inst,
+bool idUsage::isValid<SpvOpArrayLength>(const spv_validated_instruction_t *inst,
                                         const spv_opcode_desc opcodeEntry) {}
 #endif
 
 #if 0
 template <>
-bool idUsage::isValid<SpvOpImagePointer>(const spv_instruction_t *inst,
-                                         const spv_opcode_desc opcodeEntry) {}
+bool idUsage::isValid<SpvOpImagePointer>(
+    const spv_validated_instruction_t *inst,
+    const spv_opcode_desc opcodeEntry) {}
 #endif
 
 #if 0
 template <>
 bool idUsage::isValid<SpvOpGenericPtrMemSemantics>(
-    const spv_instruction_t *inst, const spv_opcode_desc opcodeEntry) {}
+    const spv_validated_instruction_t *inst,
+    const spv_opcode_desc opcodeEntry) {}
 #endif
 
 template <>
-bool idUsage::isValid<SpvOpFunction>(const spv_instruction_t* inst,
+bool idUsage::isValid<SpvOpFunction>(const spv_validated_instruction_t* inst,
                                      const spv_opcode_desc) {
   const auto* thisInst = module_.FindDef(inst->words[2u]);
   if (!thisInst) return false;
@@ -1615,8 +1623,8 @@ bool idUsage::isValid<SpvOpFunction>(const spv_instruction_t* inst,
 }
 
 template <>
-bool idUsage::isValid<SpvOpFunctionParameter>(const spv_instruction_t* inst,
-                                              const spv_opcode_desc) {
+bool idUsage::isValid<SpvOpFunctionParameter>(
+    const spv_validated_instruction_t* inst, const spv_opcode_desc) {
   auto resultTypeIndex = 1;
   auto resultType = module_.FindDef(inst->words[resultTypeIndex]);
   if (!resultType) return false;
@@ -1651,8 +1659,8 @@ bool idUsage::isValid<SpvOpFunctionParameter>(const spv_instruction_t* inst,
 }
 
 template <>
-bool idUsage::isValid<SpvOpFunctionCall>(const spv_instruction_t* inst,
-                                         const spv_opcode_desc) {
+bool idUsage::isValid<SpvOpFunctionCall>(
+    const spv_validated_instruction_t* inst, const spv_opcode_desc) {
   auto resultTypeIndex = 1;
   auto resultType = module_.FindDef(inst->words[resultTypeIndex]);
   if (!resultType) return false;
@@ -1702,8 +1710,8 @@ bool idUsage::isValid<SpvOpFunctionCall>(const spv_instruction_t* inst,
 }
 
 template <>
-bool idUsage::isValid<SpvOpVectorShuffle>(const spv_instruction_t* inst,
-                                          const spv_opcode_desc) {
+bool idUsage::isValid<SpvOpVectorShuffle>(
+    const spv_validated_instruction_t* inst, const spv_opcode_desc) {
   auto instr_name = [&inst]() {
     std::string name =
         "Op" + std::string(spvOpcodeString(static_cast<SpvOp>(inst->opcode)));
@@ -1785,7 +1793,7 @@ bool idUsage::isValid<SpvOpVectorShuffle>(const spv_instruction_t* inst,
 }
 
 template <>
-bool idUsage::isValid<SpvOpPhi>(const spv_instruction_t* inst,
+bool idUsage::isValid<SpvOpPhi>(const spv_validated_instruction_t* inst,
                                 const spv_opcode_desc /*opcodeEntry*/) {
   auto thisInst = module_.FindDef(inst->words[2]);
   SpvOp typeOp = module_.GetIdOpcode(thisInst->type_id());
@@ -1857,19 +1865,20 @@ bool idUsage::isValid<SpvOpPhi>(const spv_instruction_t* inst,
 
 #if 0
 template <>
-bool idUsage::isValid<OpLoopMerge>(const spv_instruction_t *inst,
+bool idUsage::isValid<OpLoopMerge>(const spv_validated_instruction_t *inst,
                                    const spv_opcode_desc opcodeEntry) {}
 #endif
 
 #if 0
 template <>
 bool idUsage::isValid<OpSelectionMerge>(
-    const spv_instruction_t *inst, const spv_opcode_desc opcodeEntry) {}
+    const spv_validated_instruction_t *inst,
+    const spv_opcode_desc opcodeEntry) {}
 #endif
 
 template <>
-bool idUsage::isValid<SpvOpBranchConditional>(const spv_instruction_t* inst,
-                                              const spv_opcode_desc) {
+bool idUsage::isValid<SpvOpBranchConditional>(
+    const spv_validated_instruction_t* inst, const spv_opcode_desc) {
   const size_t numOperands = inst->words.size() - 1;
   const size_t condOperandIndex = 1;
   const size_t targetTrueIndex = 2;
@@ -1915,12 +1924,12 @@ bool idUsage::isValid<SpvOpBranchConditional>(const spv_instruction_t* inst,
 
 #if 0
 template <>
-bool idUsage::isValid<OpSwitch>(const spv_instruction_t *inst,
+bool idUsage::isValid<OpSwitch>(const spv_validated_instruction_t *inst,
                                 const spv_opcode_desc opcodeEntry) {}
 #endif
 
 template <>
-bool idUsage::isValid<SpvOpReturnValue>(const spv_instruction_t* inst,
+bool idUsage::isValid<SpvOpReturnValue>(const spv_validated_instruction_t* inst,
                                         const spv_opcode_desc) {
   auto valueIndex = 1;
   auto value = module_.FindDef(inst->words[valueIndex]);
@@ -1950,7 +1959,7 @@ bool idUsage::isValid<SpvOpReturnValue>(const spv_instruction_t* inst,
   }
 
   // NOTE: Find OpFunction
-  const spv_instruction_t* function = inst - 1;
+  const spv_validated_instruction_t* function = inst - 1;
   while (firstInst != function) {
     if (SpvOpFunction == function->opcode) break;
     function--;
@@ -1970,219 +1979,229 @@ bool idUsage::isValid<SpvOpReturnValue>(const spv_instruction_t* inst,
 
 #if 0
 template <>
-bool idUsage::isValid<OpLifetimeStart>(const spv_instruction_t *inst,
+bool idUsage::isValid<OpLifetimeStart>(const spv_validated_instruction_t *inst,
                                        const spv_opcode_desc opcodeEntry) {
 }
 #endif
 
 #if 0
 template <>
-bool idUsage::isValid<OpLifetimeStop>(const spv_instruction_t *inst,
+bool idUsage::isValid<OpLifetimeStop>(const spv_validated_instruction_t *inst,
                                       const spv_opcode_desc opcodeEntry) {}
 #endif
 
 #if 0
 template <>
-bool idUsage::isValid<OpAtomicInit>(const spv_instruction_t *inst,
+bool idUsage::isValid<OpAtomicInit>(const spv_validated_instruction_t *inst,
                                     const spv_opcode_desc opcodeEntry) {}
 #endif
 
 #if 0
 template <>
-bool idUsage::isValid<OpAtomicLoad>(const spv_instruction_t *inst,
+bool idUsage::isValid<OpAtomicLoad>(const spv_validated_instruction_t *inst,
                                     const spv_opcode_desc opcodeEntry) {}
 #endif
 
 #if 0
 template <>
-bool idUsage::isValid<OpAtomicStore>(const spv_instruction_t *inst,
+bool idUsage::isValid<OpAtomicStore>(const spv_validated_instruction_t *inst,
                                      const spv_opcode_desc opcodeEntry) {}
 #endif
 
 #if 0
 template <>
 bool idUsage::isValid<OpAtomicExchange>(
-    const spv_instruction_t *inst, const spv_opcode_desc opcodeEntry) {}
+    const spv_validated_instruction_t *inst,
+    const spv_opcode_desc opcodeEntry) {}
 #endif
 
 #if 0
 template <>
 bool idUsage::isValid<OpAtomicCompareExchange>(
-    const spv_instruction_t *inst, const spv_opcode_desc opcodeEntry) {}
+    const spv_validated_instruction_t *inst,
+    const spv_opcode_desc opcodeEntry) {}
 #endif
 
 #if 0
 template <>
 bool idUsage::isValid<OpAtomicCompareExchangeWeak>(
-    const spv_instruction_t *inst, const spv_opcode_desc opcodeEntry) {}
+    const spv_validated_instruction_t *inst,
+    const spv_opcode_desc opcodeEntry) {}
 #endif
 
 #if 0
 template <>
 bool idUsage::isValid<OpAtomicIIncrement>(
-    const spv_instruction_t *inst, const spv_opcode_desc opcodeEntry) {}
+    const spv_validated_instruction_t *inst,
+    const spv_opcode_desc opcodeEntry) {}
 #endif
 
 #if 0
 template <>
 bool idUsage::isValid<OpAtomicIDecrement>(
-    const spv_instruction_t *inst, const spv_opcode_desc opcodeEntry) {}
+    const spv_validated_instruction_t *inst,
+    const spv_opcode_desc opcodeEntry) {}
 #endif
 
 #if 0
 template <>
-bool idUsage::isValid<OpAtomicIAdd>(const spv_instruction_t *inst,
+bool idUsage::isValid<OpAtomicIAdd>(const spv_validated_instruction_t *inst,
                                     const spv_opcode_desc opcodeEntry) {}
 #endif
 
 #if 0
 template <>
-bool idUsage::isValid<OpAtomicISub>(const spv_instruction_t *inst,
+bool idUsage::isValid<OpAtomicISub>(const spv_validated_instruction_t *inst,
                                     const spv_opcode_desc opcodeEntry) {}
 #endif
 
 #if 0
 template <>
-bool idUsage::isValid<OpAtomicUMin>(const spv_instruction_t *inst,
+bool idUsage::isValid<OpAtomicUMin>(const spv_validated_instruction_t *inst,
                                     const spv_opcode_desc opcodeEntry) {}
 #endif
 
 #if 0
 template <>
-bool idUsage::isValid<OpAtomicUMax>(const spv_instruction_t *inst,
+bool idUsage::isValid<OpAtomicUMax>(const spv_validated_instruction_t *inst,
                                     const spv_opcode_desc opcodeEntry) {}
 #endif
 
 #if 0
 template <>
-bool idUsage::isValid<OpAtomicAnd>(const spv_instruction_t *inst,
+bool idUsage::isValid<OpAtomicAnd>(const spv_validated_instruction_t *inst,
                                    const spv_opcode_desc opcodeEntry) {}
 #endif
 
 #if 0
 template <>
-bool idUsage::isValid<OpAtomicOr>(const spv_instruction_t *inst,
+bool idUsage::isValid<OpAtomicOr>(const spv_validated_instruction_t *inst,
                                   const spv_opcode_desc opcodeEntry) {}
 #endif
 
 #if 0
 template <>
-bool idUsage::isValid<OpAtomicXor>(const spv_instruction_t *inst,
+bool idUsage::isValid<OpAtomicXor>(const spv_validated_instruction_t *inst,
                                    const spv_opcode_desc opcodeEntry) {}
 #endif
 
 #if 0
 template <>
-bool idUsage::isValid<OpAtomicIMin>(const spv_instruction_t *inst,
+bool idUsage::isValid<OpAtomicIMin>(const spv_validated_instruction_t *inst,
                                     const spv_opcode_desc opcodeEntry) {}
 #endif
 
 #if 0
 template <>
-bool idUsage::isValid<OpAtomicIMax>(const spv_instruction_t *inst,
+bool idUsage::isValid<OpAtomicIMax>(const spv_validated_instruction_t *inst,
                                     const spv_opcode_desc opcodeEntry) {}
 #endif
 
 #if 0
 template <>
 bool idUsage::isValid<OpEmitStreamVertex>(
-    const spv_instruction_t *inst, const spv_opcode_desc opcodeEntry) {}
+    const spv_validated_instruction_t *inst,
+    const spv_opcode_desc opcodeEntry) {}
 #endif
 
 #if 0
 template <>
 bool idUsage::isValid<OpEndStreamPrimitive>(
-    const spv_instruction_t *inst, const spv_opcode_desc opcodeEntry) {}
+    const spv_validated_instruction_t *inst,
+    const spv_opcode_desc opcodeEntry) {}
 #endif
 
 #if 0
 template <>
 bool idUsage::isValid<OpGroupAsyncCopy>(
-    const spv_instruction_t *inst, const spv_opcode_desc opcodeEntry) {}
+    const spv_validated_instruction_t *inst,
+    const spv_opcode_desc opcodeEntry) {}
 #endif
 
 #if 0
 template <>
 bool idUsage::isValid<OpGroupWaitEvents>(
-    const spv_instruction_t *inst, const spv_opcode_desc opcodeEntry) {}
+    const spv_validated_instruction_t *inst,
+    const spv_opcode_desc opcodeEntry) {}
 #endif
 
 #if 0
 template <>
-bool idUsage::isValid<OpGroupAll>(const spv_instruction_t *inst,
+bool idUsage::isValid<OpGroupAll>(const spv_validated_instruction_t *inst,
                                   const spv_opcode_desc opcodeEntry) {}
 #endif
 
 #if 0
 template <>
-bool idUsage::isValid<OpGroupAny>(const spv_instruction_t *inst,
+bool idUsage::isValid<OpGroupAny>(const spv_validated_instruction_t *inst,
                                   const spv_opcode_desc opcodeEntry) {}
 #endif
 
 #if 0
 template <>
 bool idUsage::isValid<OpGroupBroadcast>(
-    const spv_instruction_t *inst, const spv_opcode_desc opcodeEntry) {}
+    const spv_validated_instruction_t *inst,
+    const spv_opcode_desc opcodeEntry) {}
 #endif
 
 #if 0
 template <>
-bool idUsage::isValid<OpGroupIAdd>(const spv_instruction_t *inst,
+bool idUsage::isValid<OpGroupIAdd>(const spv_validated_instruction_t *inst,
                                    const spv_opcode_desc opcodeEntry) {}
 #endif
 
 #if 0
 template <>
-bool idUsage::isValid<OpGroupFAdd>(const spv_instruction_t *inst,
+bool idUsage::isValid<OpGroupFAdd>(const spv_validated_instruction_t *inst,
                                    const spv_opcode_desc opcodeEntry) {}
 #endif
 
 #if 0
 template <>
-bool idUsage::isValid<OpGroupFMin>(const spv_instruction_t *inst,
+bool idUsage::isValid<OpGroupFMin>(const spv_validated_instruction_t *inst,
                                    const spv_opcode_desc opcodeEntry) {}
 #endif
 
 #if 0
 template <>
-bool idUsage::isValid<OpGroupUMin>(const spv_instruction_t *inst,
+bool idUsage::isValid<OpGroupUMin>(const spv_validated_instruction_t *inst,
                                    const spv_opcode_desc opcodeEntry) {}
 #endif
 
 #if 0
 template <>
-bool idUsage::isValid<OpGroupSMin>(const spv_instruction_t *inst,
+bool idUsage::isValid<OpGroupSMin>(const spv_validated_instruction_t *inst,
                                    const spv_opcode_desc opcodeEntry) {}
 #endif
 
 #if 0
 template <>
-bool idUsage::isValid<OpGroupFMax>(const spv_instruction_t *inst,
+bool idUsage::isValid<OpGroupFMax>(const spv_validated_instruction_t *inst,
                                    const spv_opcode_desc opcodeEntry) {}
 #endif
 
 #if 0
 template <>
-bool idUsage::isValid<OpGroupUMax>(const spv_instruction_t *inst,
+bool idUsage::isValid<OpGroupUMax>(const spv_validated_instruction_t *inst,
                                    const spv_opcode_desc opcodeEntry) {}
 #endif
 
 #if 0
 template <>
-bool idUsage::isValid<OpGroupSMax>(const spv_instruction_t *inst,
+bool idUsage::isValid<OpGroupSMax>(const spv_validated_instruction_t *inst,
                                    const spv_opcode_desc opcodeEntry) {}
 #endif
 
 #if 0
 template <>
-bool idUsage::isValid<OpEnqueueMarker>(const spv_instruction_t *inst,
+bool idUsage::isValid<OpEnqueueMarker>(const spv_validated_instruction_t *inst,
                                        const spv_opcode_desc opcodeEntry) {
 }
 #endif
 
 #if 0
 template <>
-bool idUsage::isValid<OpEnqueueKernel>(const spv_instruction_t *inst,
+bool idUsage::isValid<OpEnqueueKernel>(const spv_validated_instruction_t *inst,
                                        const spv_opcode_desc opcodeEntry) {
 }
 #endif
@@ -2190,168 +2209,189 @@ bool idUsage::isValid<OpEnqueueKernel>(const spv_instruction_t *inst,
 #if 0
 template <>
 bool idUsage::isValid<OpGetKernelNDrangeSubGroupCount>(
-    const spv_instruction_t *inst, const spv_opcode_desc opcodeEntry) {}
+    const spv_validated_instruction_t *inst,
+    const spv_opcode_desc opcodeEntry) {}
 #endif
 
 #if 0
 template <>
 bool idUsage::isValid<OpGetKernelNDrangeMaxSubGroupSize>(
-    const spv_instruction_t *inst, const spv_opcode_desc opcodeEntry) {}
+    const spv_validated_instruction_t *inst,
+    const spv_opcode_desc opcodeEntry) {}
 #endif
 
 #if 0
 template <>
 bool idUsage::isValid<OpGetKernelWorkGroupSize>(
-    const spv_instruction_t *inst, const spv_opcode_desc opcodeEntry) {}
+    const spv_validated_instruction_t *inst,
+    const spv_opcode_desc opcodeEntry) {}
 #endif
 
 #if 0
 template <>
 bool idUsage::isValid<OpGetKernelPreferredWorkGroupSizeMultiple>(
-    const spv_instruction_t *inst, const spv_opcode_desc opcodeEntry) {}
+    const spv_validated_instruction_t *inst,
+    const spv_opcode_desc opcodeEntry) {}
 #endif
 
 #if 0
 template <>
-bool idUsage::isValid<OpRetainEvent>(const spv_instruction_t *inst,
+bool idUsage::isValid<OpRetainEvent>(const spv_validated_instruction_t *inst,
                                      const spv_opcode_desc opcodeEntry) {}
 #endif
 
 #if 0
 template <>
-bool idUsage::isValid<OpReleaseEvent>(const spv_instruction_t *inst,
+bool idUsage::isValid<OpReleaseEvent>(const spv_validated_instruction_t *inst,
                                       const spv_opcode_desc opcodeEntry) {}
 #endif
 
 #if 0
 template <>
 bool idUsage::isValid<OpCreateUserEvent>(
-    const spv_instruction_t *inst, const spv_opcode_desc opcodeEntry) {}
+    const spv_validated_instruction_t *inst,
+    const spv_opcode_desc opcodeEntry) {}
 #endif
 
 #if 0
 template <>
-bool idUsage::isValid<OpIsValidEvent>(const spv_instruction_t *inst,
+bool idUsage::isValid<OpIsValidEvent>(const spv_validated_instruction_t *inst,
                                       const spv_opcode_desc opcodeEntry) {}
 #endif
 
 #if 0
 template <>
 bool idUsage::isValid<OpSetUserEventStatus>(
-    const spv_instruction_t *inst, const spv_opcode_desc opcodeEntry) {}
+    const spv_validated_instruction_t *inst,
+    const spv_opcode_desc opcodeEntry) {}
 #endif
 
 #if 0
 template <>
 bool idUsage::isValid<OpCaptureEventProfilingInfo>(
-    const spv_instruction_t *inst, const spv_opcode_desc opcodeEntry) {}
+    const spv_validated_instruction_t *inst,
+    const spv_opcode_desc opcodeEntry) {}
 #endif
 
 #if 0
 template <>
 bool idUsage::isValid<OpGetDefaultQueue>(
-    const spv_instruction_t *inst, const spv_opcode_desc opcodeEntry) {}
+    const spv_validated_instruction_t *inst,
+    const spv_opcode_desc opcodeEntry) {}
 #endif
 
 #if 0
 template <>
-bool idUsage::isValid<OpBuildNDRange>(const spv_instruction_t *inst,
+bool idUsage::isValid<OpBuildNDRange>(const spv_validated_instruction_t *inst,
                                       const spv_opcode_desc opcodeEntry) {}
 #endif
 
 #if 0
 template <>
-bool idUsage::isValid<OpReadPipe>(const spv_instruction_t *inst,
+bool idUsage::isValid<OpReadPipe>(const spv_validated_instruction_t *inst,
                                   const spv_opcode_desc opcodeEntry) {}
 #endif
 
 #if 0
 template <>
-bool idUsage::isValid<OpWritePipe>(const spv_instruction_t *inst,
+bool idUsage::isValid<OpWritePipe>(const spv_validated_instruction_t *inst,
                                    const spv_opcode_desc opcodeEntry) {}
 #endif
 
 #if 0
 template <>
 bool idUsage::isValid<OpReservedReadPipe>(
-    const spv_instruction_t *inst, const spv_opcode_desc opcodeEntry) {}
+    const spv_validated_instruction_t *inst,
+    const spv_opcode_desc opcodeEntry) {}
 #endif
 
 #if 0
 template <>
 bool idUsage::isValid<OpReservedWritePipe>(
-    const spv_instruction_t *inst, const spv_opcode_desc opcodeEntry) {}
+    const spv_validated_instruction_t *inst,
+    const spv_opcode_desc opcodeEntry) {}
 #endif
 
 #if 0
 template <>
 bool idUsage::isValid<OpReserveReadPipePackets>(
-    const spv_instruction_t *inst, const spv_opcode_desc opcodeEntry) {}
+    const spv_validated_instruction_t *inst,
+    const spv_opcode_desc opcodeEntry) {}
 #endif
 
 #if 0
 template <>
 bool idUsage::isValid<OpReserveWritePipePackets>(
-    const spv_instruction_t *inst, const spv_opcode_desc opcodeEntry) {}
+    const spv_validated_instruction_t *inst,
+    const spv_opcode_desc opcodeEntry) {}
 #endif
 
 #if 0
 template <>
 bool idUsage::isValid<OpCommitReadPipe>(
-    const spv_instruction_t *inst, const spv_opcode_desc opcodeEntry) {}
+    const spv_validated_instruction_t *inst,
+    const spv_opcode_desc opcodeEntry) {}
 #endif
 
 #if 0
 template <>
 bool idUsage::isValid<OpCommitWritePipe>(
-    const spv_instruction_t *inst, const spv_opcode_desc opcodeEntry) {}
+    const spv_validated_instruction_t *inst,
+    const spv_opcode_desc opcodeEntry) {}
 #endif
 
 #if 0
 template <>
 bool idUsage::isValid<OpIsValidReserveId>(
-    const spv_instruction_t *inst, const spv_opcode_desc opcodeEntry) {}
+    const spv_validated_instruction_t *inst,
+    const spv_opcode_desc opcodeEntry) {}
 #endif
 
 #if 0
 template <>
 bool idUsage::isValid<OpGetNumPipePackets>(
-    const spv_instruction_t *inst, const spv_opcode_desc opcodeEntry) {}
+    const spv_validated_instruction_t *inst,
+    const spv_opcode_desc opcodeEntry) {}
 #endif
 
 #if 0
 template <>
 bool idUsage::isValid<OpGetMaxPipePackets>(
-    const spv_instruction_t *inst, const spv_opcode_desc opcodeEntry) {}
+    const spv_validated_instruction_t *inst,
+    const spv_opcode_desc opcodeEntry) {}
 #endif
 
 #if 0
 template <>
 bool idUsage::isValid<OpGroupReserveReadPipePackets>(
-    const spv_instruction_t *inst, const spv_opcode_desc opcodeEntry) {}
+    const spv_validated_instruction_t *inst,
+    const spv_opcode_desc opcodeEntry) {}
 #endif
 
 #if 0
 template <>
 bool idUsage::isValid<OpGroupReserveWritePipePackets>(
-    const spv_instruction_t *inst, const spv_opcode_desc opcodeEntry) {}
+    const spv_validated_instruction_t *inst,
+    const spv_opcode_desc opcodeEntry) {}
 #endif
 
 #if 0
 template <>
 bool idUsage::isValid<OpGroupCommitReadPipe>(
-    const spv_instruction_t *inst, const spv_opcode_desc opcodeEntry) {}
+    const spv_validated_instruction_t *inst,
+    const spv_opcode_desc opcodeEntry) {}
 #endif
 
 #if 0
 template <>
 bool idUsage::isValid<OpGroupCommitWritePipe>(
-    const spv_instruction_t *inst, const spv_opcode_desc opcodeEntry) {}
+    const spv_validated_instruction_t *inst,
+    const spv_opcode_desc opcodeEntry) {}
 #endif
 
 #undef DIAG
 
-bool idUsage::isValid(const spv_instruction_t* inst) {
+bool idUsage::isValid(const spv_validated_instruction_t* inst) {
   spv_opcode_desc opcodeEntry = nullptr;
   if (spvOpcodeTableValueLookup(targetEnv, opcodeTable, inst->opcode,
                                 &opcodeEntry))
@@ -2590,19 +2630,93 @@ bool idUsage::HasConflictingMemberOffsets(
 namespace libspirv {
 
 spv_result_t UpdateIdUse(ValidationState_t& _) {
-  for (const auto& inst : _.ordered_instructions()) {
-    for (auto& operand : inst.operands()) {
-      const spv_operand_type_t& type = operand.type;
-      const uint32_t operand_id = inst.word(operand.offset);
-      if (spvIsIdType(type) && type != SPV_OPERAND_TYPE_RESULT_ID) {
-        if (auto def = _.FindDef(operand_id))
-          def->RegisterUse(&inst, operand.offset);
+  _.RegisterUses();
+  return SPV_SUCCESS;
+}
+
+namespace {
+
+// The number of definitions, or of OpPhi instructions, which
+// CheckIdDefinitionDominateUse checks as one unit of work.
+const size_t kDominanceCheckChunkSize = 256;
+
+// Checks that the uses of |definition| are dominated by it, and appends the
+// OpPhi instructions which use it to |phi_instructions|.
+spv_result_t CheckDefinitionDominatesUses(
+    const ValidationState_t& _,
+    const std::pair<const uint32_t, Instruction*>& definition,
+    vector<const Instruction*>* phi_instructions) {
+  // Check only those definitions defined in a function
+  if (const Function* func = definition.second->function()) {
+    if (const BasicBlock* block = definition.second->block()) {
+      if (!block->reachable()) return SPV_SUCCESS;
+      // If the Id is defined within a block then make sure all references to
+      // that Id appear in a blocks that are dominated by the defining block
+      for (auto& use_index_pair : definition.second->uses()) {
+        const Instruction* use = use_index_pair.first;
+        if (const BasicBlock* use_block = use->block()) {
+          if (use_block->reachable() == false) continue;
+          if (use->opcode() == SpvOpPhi) {
+            phi_instructions->push_back(use);
+          } else if (!block->dominates(*use->block())) {
+            return _.diag(SPV_ERROR_INVALID_ID)
+                   << "ID " << _.getIdName(definition.first)
+                   << " defined in block " << _.getIdName(block->id())
+                   << " does not dominate its use in block "
+                   << _.getIdName(use_block->id());
+          }
+        }
+      }
+    } else {
+      // If the Ids defined within a function but not in a block(i.e. function
+      // parameters, block ids), then make sure all references to that Id
+      // appear within the same function
+      for (auto use : definition.second->uses()) {
+        const Instruction* inst = use.first;
+        if (inst->function() && inst->function() != func) {
+          return _.diag(SPV_ERROR_INVALID_ID)
+                 << "ID " << _.getIdName(definition.first)
+                 << " used in function " << _.getIdName(inst->function()->id())
+                 << " is used outside of it's defining function "
+                 << _.getIdName(func->id());
+        }
       }
     }
   }
+  // NOTE: Ids defined outside of functions must appear before they are used
+  // This check is being performed in the IdPass function
   return SPV_SUCCESS;
 }
 
+// Checks that the parent blocks of the OpPhi instruction |phi| are dominated
+// by the blocks defining the corresponding variables.
+spv_result_t CheckPhiParentsDominated(const ValidationState_t& _,
+                                      const Instruction* phi) {
+  if (phi->block()->reachable() == false) return SPV_SUCCESS;
+  for (size_t i = 3; i < phi->operands().size(); i += 2) {
+    const Instruction* variable = _.FindDef(phi->word(i));
+    const BasicBlock* parent =
+        phi->function()->GetBlock(phi->word(i + 1)).first;
+    if (variable->block() && parent->reachable() &&
+        !variable->block()->dominates(*parent)) {
+      return _.diag(SPV_ERROR_INVALID_ID)
+             << "In OpPhi instruction " << _.getIdName(phi->id()) << ", ID "
+             << _.getIdName(variable->id())
+             << " definition does not dominate its parent "
+             << _.getIdName(parent->id());
+    }
+  }
+  return SPV_SUCCESS;
+}
+
+// Returns the number of chunks of kDominanceCheckChunkSize elements needed to
+// hold |count| elements.
+size_t NumDominanceCheckChunks(size_t count) {
+  return (count + kDominanceCheckChunkSize - 1) / kDominanceCheckChunkSize;
+}
+
+}  // namespace
+
 /// This function checks all ID definitions dominate their use in the CFG.
 ///
 /// This function will iterate over all ID definitions that are defined in the
@@ -2612,70 +2726,50 @@ spv_result_t UpdateIdUse(ValidationState_t& _) {
 /// NOTE: This function does NOT check module scoped functions which are
 /// checked during the initial binary parse in the IdPass below
 spv_result_t CheckIdDefinitionDominateUse(const ValidationState_t& _) {
-  unordered_set<const Instruction*> phi_instructions;
-  for (const auto& definition : _.all_definitions()) {
-    // Check only those definitions defined in a function
-    if (const Function* func = definition.second->function()) {
-      if (const BasicBlock* block = definition.second->block()) {
-        if (!block->reachable()) continue;
-        // If the Id is defined within a block then make sure all references to
-        // that Id appear in a blocks that are dominated by the defining block
-        for (auto& use_index_pair : definition.second->uses()) {
-          const Instruction* use = use_index_pair.first;
-          if (const BasicBlock* use_block = use->block()) {
-            if (use_block->reachable() == false) continue;
-            if (use->opcode() == SpvOpPhi) {
-              phi_instructions.insert(use);
-            } else if (!block->dominates(*use->block())) {
-              return _.diag(SPV_ERROR_INVALID_ID)
-                     << "ID " << _.getIdName(definition.first)
-                     << " defined in block " << _.getIdName(block->id())
-                     << " does not dominate its use in block "
-                     << _.getIdName(use_block->id());
+  // The definitions are checked in chunks, which may run concurrently, in
+  // the iteration order of the definitions.  The OpPhi instructions found by
+  // each chunk are then gathered in that order, so that the set, and the
+  // order in which they are checked, does not depend on the threads.
+  vector<const std::pair<const uint32_t, Instruction*>*> definitions;
+  definitions.reserve(_.all_definitions().size());
+  for (const auto& definition : _.all_definitions())
+    definitions.push_back(&definition);
+
+  vector<vector<const Instruction*>> chunk_phi_instructions(
+      NumDominanceCheckChunks(definitions.size()));
+  if (auto error = _.CheckInParallel(
+          chunk_phi_instructions.size(),
+          [&_, &definitions, &chunk_phi_instructions](size_t chunk) {
+            const size_t begin = chunk * kDominanceCheckChunkSize;
+            const size_t end = std::min(begin + kDominanceCheckChunkSize,
+                                        definitions.size());
+            for (size_t i = begin; i < end; ++i) {
+              if (auto error = CheckDefinitionDominatesUses(
+                      _, *definitions[i], &chunk_phi_instructions[chunk]))
+                return error;
             }
-          }
-        }
-      } else {
-        // If the Ids defined within a function but not in a block(i.e. function
-        // parameters, block ids), then make sure all references to that Id
-        // appear within the same function
-        for (auto use : definition.second->uses()) {
-          const Instruction* inst = use.first;
-          if (inst->function() && inst->function() != func) {
-            return _.diag(SPV_ERROR_INVALID_ID)
-                   << "ID " << _.getIdName(definition.first)
-                   << " used in function "
-                   << _.getIdName(inst->function()->id())
-                   << " is used outside of it's defining function "
-                   << _.getIdName(func->id());
-          }
-        }
-      }
-    }
-    // NOTE: Ids defined outside of functions must appear before they are used
-    // This check is being performed in the IdPass function
-  }
+            return SPV_SUCCESS;
+          }))
+    return error;
+
+  unordered_set<const Instruction*> phi_instructions;
+  for (const auto& phis : chunk_phi_instructions)
+    phi_instructions.insert(phis.begin(), phis.end());
 
   // Check all OpPhi parent blocks are dominated by the variable's defining
   // blocks
-  for (const Instruction* phi : phi_instructions) {
-    if (phi->block()->reachable() == false) continue;
-    for (size_t i = 3; i < phi->operands().size(); i += 2) {
-      const Instruction* variable = _.FindDef(phi->word(i));
-      const BasicBlock* parent =
-          phi->function()->GetBlock(phi->word(i + 1)).first;
-      if (variable->block() && parent->reachable() &&
-          !variable->block()->dominates(*parent)) {
-        return _.diag(SPV_ERROR_INVALID_ID)
-               << "In OpPhi instruction " << _.getIdName(phi->id()) << ", ID "
-               << _.getIdName(variable->id())
-               << " definition does not dominate its parent "
-               << _.getIdName(parent->id());
-      }
-    }
-  }
-
-  return SPV_SUCCESS;
+  const vector<const Instruction*> phis(phi_instructions.begin(),
+                                        phi_instructions.end());
+  return _.CheckInParallel(
+      NumDominanceCheckChunks(phis.size()), [&_, &phis](size_t chunk) {
+        const size_t begin = chunk * kDominanceCheckChunkSize;
+        const size_t end =
+            std::min(begin + kDominanceCheckChunkSize, phis.size());
+        for (size_t i = begin; i < end; ++i) {
+          if (auto error = CheckPhiParentsDominated(_, phis[i])) return error;
+        }
+        return SPV_SUCCESS;
+      });
 }
 
 // Performs SSA validation on the IDs of an instruction. The
@@ -2744,13 +2838,12 @@ spv_result_t IdPass(ValidationState_t& _,
 }
 }  // namespace libspirv
 
-spv_result_t spvValidateInstructionIDs(const spv_instruction_t* pInsts,
-                                       const uint64_t instCount,
-                                       const libspirv::ValidationState_t& state,
-                                       spv_position position) {
+spv_result_t spvValidateInstructionIDs(
+    const spv_validated_instruction_t* pInsts, const uint64_t instCount,
+    const libspirv::ValidationState_t& state, spv_position position) {
   idUsage idUsage(state.context(), pInsts, instCount, state.memory_model(),
                   state.addressing_model(), state, state.entry_points(),
-                  position, state.context()->consumer);
+                  position, state.consumer());
   for (uint64_t instIndex = 0; instIndex < instCount; ++instIndex) {
     if (!idUsage.isValid(&pInsts[instIndex])) return SPV_ERROR_INVALID_ID;
     position->index += pInsts[instIndex].words.size();
@@ -69,12 +69,18 @@ spv_result_t CapabilityError(ValidationState_t& _, int which_operand,
          << " requires one of these capabilities: " << required_capabilities;
 }
 
+// Returns the empty set of capabilities.
+const CapabilitySet& NoCapabilities() {
+  static const CapabilitySet* empty = new CapabilitySet;
+  return *empty;
+}
+
 // Returns capabilities that enable an opcode.  An empty result is interpreted
 // as no prohibition of use of the opcode.  If the result is non-empty, then
 // the opcode may only be used if at least one of the capabilities is specified
 // by the module.
-CapabilitySet EnablingCapabilitiesForOp(const ValidationState_t& state,
-                                        SpvOp opcode) {
+const CapabilitySet& EnablingCapabilitiesForOp(const ValidationState_t& state,
+                                               SpvOp opcode) {
   // Exceptions for SPV_AMD_shader_ballot
   switch (opcode) {
     // Normally these would require Group capability
@@ -87,23 +93,19 @@ CapabilitySet EnablingCapabilitiesForOp(const ValidationState_t& state,
     case SpvOpGroupUMaxNonUniformAMD:
     case SpvOpGroupSMaxNonUniformAMD:
       if (state.HasExtension(libspirv::kSPV_AMD_shader_ballot))
-        return CapabilitySet();
+        return NoCapabilities();
       break;
     default:
       break;
   }
   // Look it up in the grammar
-  spv_opcode_desc opcode_desc = {};
-  if (SPV_SUCCESS == state.grammar().lookupOpcode(opcode, &opcode_desc)) {
-    return state.grammar().filterCapsAgainstTargetEnv(
-        opcode_desc->capabilities, opcode_desc->numCapabilities);
-  }
-  return CapabilitySet();
+  return state.grammar().enablingCapabilitiesForOpcode(opcode);
 }
 
 // Returns an operand's required capabilities.
-CapabilitySet RequiredCapabilities(const ValidationState_t& state,
-                                   spv_operand_type_t type, uint32_t operand) {
+const CapabilitySet& RequiredCapabilities(const ValidationState_t& state,
+                                          spv_operand_type_t type,
+                                          uint32_t operand) {
   // Mere mention of PointSize, ClipDistance, or CullDistance in a Builtin
   // decoration does not require the associated capability.  The use of such
   // a variable value should trigger the capability requirement, but that's
@@ -114,47 +116,38 @@ CapabilitySet RequiredCapabilities(const ValidationState_t& state,
       case SpvBuiltInPointSize:
       case SpvBuiltInClipDistance:
       case SpvBuiltInCullDistance:
-        return CapabilitySet();
+        return NoCapabilities();
       default:
         break;
     }
   } else if (type == SPV_OPERAND_TYPE_FP_ROUNDING_MODE) {
     // Allow all FP rounding modes if requested
     if (state.features().free_fp_rounding_mode) {
-      return CapabilitySet();
+      return NoCapabilities();
     }
-  }
-
-  spv_operand_desc operand_desc;
-  const auto ret = state.grammar().lookupOperand(type, operand, &operand_desc);
-  if (ret == SPV_SUCCESS) {
+  } else if (type == SPV_OPERAND_TYPE_DECORATION &&
+             operand == SpvDecorationFPRoundingMode) {
     // Allow FPRoundingMode decoration if requested.
-    if (type == SPV_OPERAND_TYPE_DECORATION &&
-        operand_desc->value == SpvDecorationFPRoundingMode) {
-      if (state.features().free_fp_rounding_mode) return CapabilitySet();
-
-      // Vulkan API requires more capabilities on rounding mode.
-      if (spvIsVulkanEnv(state.context()->target_env)) {
-        CapabilitySet cap_set;
-        cap_set.Add(SpvCapabilityStorageUniformBufferBlock16);
-        cap_set.Add(SpvCapabilityStorageUniform16);
-        cap_set.Add(SpvCapabilityStoragePushConstant16);
-        cap_set.Add(SpvCapabilityStorageInputOutput16);
-        return cap_set;
-      }
+    if (state.features().free_fp_rounding_mode) return NoCapabilities();
+
+    // Vulkan API requires more capabilities on rounding mode.
+    if (spvIsVulkanEnv(state.context()->target_env)) {
+      static const CapabilitySet* vulkan_caps =
+          new CapabilitySet{SpvCapabilityStorageUniformBufferBlock16,
+                            SpvCapabilityStorageUniform16,
+                            SpvCapabilityStoragePushConstant16,
+                            SpvCapabilityStorageInputOutput16};
+      return *vulkan_caps;
     }
+  } else if (type == SPV_OPERAND_TYPE_GROUP_OPERATION) {
     // Allow certain group operations if requested.
     if (state.features().group_ops_reduce_and_scans &&
-        type == SPV_OPERAND_TYPE_GROUP_OPERATION &&
         (operand <= uint32_t(SpvGroupOperationExclusiveScan))) {
-      return CapabilitySet();
+      return NoCapabilities();
     }
-
-    return state.grammar().filterCapsAgainstTargetEnv(
-        operand_desc->capabilities, operand_desc->numCapabilities);
   }
 
-  return CapabilitySet();
+  return state.grammar().requiredCapabilitiesForOperand(type, operand);
 }
 
 // Returns operand's required extensions.
@@ -182,7 +175,7 @@ namespace libspirv {
 spv_result_t CapabilityCheck(ValidationState_t& _,
                              const spv_parsed_instruction_t* inst) {
   const SpvOp opcode = static_cast<SpvOp>(inst->opcode);
-  CapabilitySet opcode_caps = EnablingCapabilitiesForOp(_, opcode);
+  const CapabilitySet& opcode_caps = EnablingCapabilitiesForOp(_, opcode);
   if (!_.HasAnyOfCapabilities(opcode_caps)) {
     return _.diag(SPV_ERROR_INVALID_CAPABILITY)
            << "Opcode " << spvOpcodeString(opcode)
@@ -196,7 +189,7 @@ spv_result_t CapabilityCheck(ValidationState_t& _,
       // Check for required capabilities for each bit position of the mask.
       for (uint32_t mask_bit = 0x80000000; mask_bit; mask_bit >>= 1) {
         if (word & mask_bit) {
-          const auto caps = RequiredCapabilities(_, operand.type, mask_bit);
+          const auto& caps = RequiredCapabilities(_, operand.type, mask_bit);
           if (!_.HasAnyOfCapabilities(caps)) {
             return CapabilityError(_, i + 1, opcode,
                                    ToString(caps, _.grammar()));
@@ -209,7 +202,7 @@ spv_result_t CapabilityCheck(ValidationState_t& _,
       // https://github.com/KhronosGroup/SPIRV-Tools/issues/248
     } else {
       // Check the operand word as a whole.
-      const auto caps = RequiredCapabilities(_, operand.type, word);
+      const auto& caps = RequiredCapabilities(_, operand.type, word);
       if (!_.HasAnyOfCapabilities(caps)) {
         return CapabilityError(_, i + 1, opcode, ToString(caps, _.grammar()));
       }
@@ -548,6 +548,169 @@ TEST_F(BinaryParseTest, ExtendedInstruction) {
   EXPECT_EQ(nullptr, diagnostic_);
 }
 
+class BinaryIteratorTest
+    : public spvtest::TextToBinaryTestBase<::testing::Test> {
+ protected:
+  BinaryIteratorTest() : iterator_(spvBinaryIteratorCreate(context_.context)) {}
+  ~BinaryIteratorTest() {
+    spvBinaryIteratorDestroy(iterator_);
+    spvDiagnosticDestroy(diagnostic_);
+  }
+
+  // Parses |words| with the iterator, and returns the parsed instructions.
+  // Expects the parse to end with |expected_result|.
+  std::vector<ParsedInstruction> ParseAll(
+      const SpirvVector& words, spv_result_t expected_result = SPV_SUCCESS) {
+    std::vector<ParsedInstruction> instructions;
+    spvDiagnosticDestroy(diagnostic_);
+    EXPECT_EQ(SPV_SUCCESS,
+              spvBinaryIteratorBegin(iterator_, words.data(), words.size(),
+                                     &header_, &diagnostic_));
+    const spv_parsed_instruction_t* inst = nullptr;
+    spv_result_t result;
+    while ((result = spvBinaryIteratorNext(iterator_, &inst)) == SPV_SUCCESS)
+      instructions.emplace_back(*inst);
+    EXPECT_EQ(expected_result == SPV_SUCCESS ? SPV_END_OF_STREAM
+                                             : expected_result,
+              result);
+    return instructions;
+  }
+
+  ScopedContext context_;
+  spv_binary_iterator iterator_;
+  spv_parsed_header_t header_ = {};
+  spv_diagnostic diagnostic_ = nullptr;
+};
+
+TEST_F(BinaryIteratorTest, NullContextGivesNullIterator) {
+  EXPECT_EQ(nullptr, spvBinaryIteratorCreate(nullptr));
+}
+
+TEST_F(BinaryIteratorTest, EmptyModuleHasValidHeaderAndNoInstructions) {
+  const auto words = CompileSuccessfully("");
+  EXPECT_THAT(ParseAll(words), Eq(std::vector<ParsedInstruction>{}));
+  EXPECT_EQ(SpvMagicNumber, header_.magic);
+  EXPECT_EQ(0x10000u, header_.version);
+  EXPECT_EQ(SPV_GENERATOR_WORD(SPV_GENERATOR_KHRONOS_ASSEMBLER, 0),
+            header_.generator);
+  EXPECT_EQ(1u, header_.id_bound);
+  EXPECT_EQ(0u, header_.reserved);
+  EXPECT_EQ(nullptr, diagnostic_);
+}
+
+TEST_F(BinaryIteratorTest, MatchesCallbacksAcrossModules) {
+  const auto words = CompileSuccessfully(
+      "%1 = OpTypeVoid "
+      "%2 = OpTypeInt 32 1");
+  const auto other_words = CompileSuccessfully("%1 = OpTypeVoid");
+  const std::vector<ParsedInstruction> expected = {
+      MakeParsedVoidTypeInstruction(1), MakeParsedInt32TypeInstruction(2)};
+  EXPECT_THAT(ParseAll(words), Eq(expected));
+  EXPECT_EQ(3u, header_.id_bound);
+  EXPECT_THAT(ParseAll(other_words),
+              Eq(std::vector<ParsedInstruction>{
+                  MakeParsedVoidTypeInstruction(1)}));
+  EXPECT_EQ(2u, header_.id_bound);
+  EXPECT_THAT(ParseAll(words), Eq(expected));
+  EXPECT_EQ(nullptr, diagnostic_);
+}
+
+TEST_F(BinaryIteratorTest, ExtendedInstructionTypeIsTracked) {
+  const auto words = CompileSuccessfully(
+      "%extcl = OpExtInstImport \"OpenCL.std\" "
+      "%result = OpExtInst %float %extcl sqrt %x");
+  const auto instructions = ParseAll(words);
+  ASSERT_EQ(2u, instructions.size());
+  EXPECT_EQ(SPV_EXT_INST_TYPE_OPENCL_STD, instructions[1].ext_inst_type);
+  EXPECT_EQ(3u, instructions[1].result_id);
+}
+
+TEST_F(BinaryIteratorTest, StopEarlyThenBeginAnotherModule) {
+  const auto words = CompileSuccessfully(
+      "%1 = OpTypeVoid "
+      "%2 = OpTypeInt 32 1");
+  ASSERT_EQ(SPV_SUCCESS,
+            spvBinaryIteratorBegin(iterator_, words.data(), words.size(),
+                                   &header_, nullptr));
+  const spv_parsed_instruction_t* inst = nullptr;
+  ASSERT_EQ(SPV_SUCCESS, spvBinaryIteratorNext(iterator_, &inst));
+  EXPECT_EQ(MakeParsedVoidTypeInstruction(1), ParsedInstruction(*inst));
+  EXPECT_THAT(ParseAll(words),
+              Eq(std::vector<ParsedInstruction>{
+                  MakeParsedVoidTypeInstruction(1),
+                  MakeParsedInt32TypeInstruction(2)}));
+}
+
+TEST_F(BinaryIteratorTest, SkipFunctionSkipsToFollowingInstruction) {
+  const auto words = CompileSuccessfully(
+      "%1 = OpTypeVoid "
+      "%2 = OpTypeFunction %1 "
+      "%3 = OpFunction %1 None %2 "
+      "%4 = OpLabel "
+      "OpReturn "
+      "OpFunctionEnd "
+      "%5 = OpTypeInt 32 1");
+  ASSERT_EQ(SPV_SUCCESS,
+            spvBinaryIteratorBegin(iterator_, words.data(), words.size(),
+                                   &header_, &diagnostic_));
+  const spv_parsed_instruction_t* inst = nullptr;
+  std::vector<SpvOp> opcodes;
+  spv_result_t result;
+  while ((result = spvBinaryIteratorNext(iterator_, &inst)) == SPV_SUCCESS) {
+    opcodes.push_back(static_cast<SpvOp>(inst->opcode));
+    if (inst->opcode == SpvOpFunction) {
+      EXPECT_EQ(SPV_SUCCESS, spvBinaryIteratorSkipFunction(iterator_));
+    }
+  }
+  EXPECT_EQ(SPV_END_OF_STREAM, result);
+  EXPECT_THAT(opcodes, Eq(std::vector<SpvOp>{SpvOpTypeVoid, SpvOpTypeFunction,
+                                             SpvOpFunction, SpvOpTypeInt}));
+  EXPECT_EQ(nullptr, diagnostic_);
+}
+
+TEST_F(BinaryIteratorTest, SkipFunctionWithoutFunctionEndIsAnError) {
+  const auto words = CompileSuccessfully(
+      "%1 = OpTypeVoid "
+      "%2 = OpTypeFunction %1 "
+      "%3 = OpFunction %1 None %2 "
+      "%4 = OpLabel "
+      "OpReturn");
+  ASSERT_EQ(SPV_SUCCESS,
+            spvBinaryIteratorBegin(iterator_, words.data(), words.size(),
+                                   &header_, &diagnostic_));
+  EXPECT_EQ(SPV_ERROR_INVALID_BINARY,
+            spvBinaryIteratorSkipFunction(iterator_));
+  ASSERT_NE(nullptr, diagnostic_);
+  EXPECT_STREQ(
+      "End of input reached while skipping a function: missing "
+      "OpFunctionEnd.",
+      diagnostic_->error);
+  const spv_parsed_instruction_t* inst = nullptr;
+  EXPECT_EQ(SPV_END_OF_STREAM, spvBinaryIteratorNext(iterator_, &inst));
+}
+
+TEST_F(BinaryIteratorTest, InvalidInstructionEndsTheModule) {
+  auto words = CompileSuccessfully("%1 = OpTypeVoid");
+  words.push_back(0xffffffff);  // Certainly invalid instruction header.
+  EXPECT_THAT(ParseAll(words, SPV_ERROR_INVALID_BINARY),
+              Eq(std::vector<ParsedInstruction>{
+                  MakeParsedVoidTypeInstruction(1)}));
+  ASSERT_NE(nullptr, diagnostic_);
+  EXPECT_STREQ("Invalid opcode: 65535", diagnostic_->error);
+  const spv_parsed_instruction_t* inst = nullptr;
+  EXPECT_EQ(SPV_END_OF_STREAM, spvBinaryIteratorNext(iterator_, &inst));
+}
+
+TEST_F(BinaryIteratorTest, InvalidHeaderIsAnError) {
+  const uint32_t words[] = {0xdeadbeef};
+  EXPECT_EQ(SPV_ERROR_INVALID_BINARY,
+            spvBinaryIteratorBegin(iterator_, words, 1, &header_,
+                                   &diagnostic_));
+  ASSERT_NE(nullptr, diagnostic_);
+  const spv_parsed_instruction_t* inst = nullptr;
+  EXPECT_EQ(SPV_END_OF_STREAM, spvBinaryIteratorNext(iterator_, &inst));
+}
+
 // A binary parser diagnostic test case where we provide the words array
 // pointer and word count explicitly.
 struct WordsAndCountDiagnosticCase {
@@ -775,6 +775,27 @@ TEST(BitReaderWord64, ReadStreamEmpty) {
   EXPECT_TRUE(reader.ReachedEnd());
 }
 
+TEST(BitReaderWord64, ReadsUnalignedBytesInPlace) {
+  // The view starts one byte into |bytes|, and ends within its second word.
+  const uint8_t bytes[] = {0xFF, 0x01, 0, 0, 0, 0, 0, 0, 0x80, 0x0F, 0xF0};
+  BitReaderWord64 reader(BitReaderWord64::InPlace(), bytes + 1, 10);
+
+  uint64_t bits = 0;
+  EXPECT_EQ(1u, reader.ReadBits(&bits, 1));
+  EXPECT_EQ(1u, bits);
+  EXPECT_EQ(62u, reader.ReadBits(&bits, 62));
+  EXPECT_EQ(0u, bits);
+  EXPECT_EQ(5u, reader.ReadBits(&bits, 5));
+  EXPECT_EQ(0x1Fu, bits);
+  EXPECT_FALSE(reader.OnlyZeroesLeft());
+  EXPECT_EQ(12u, reader.ReadBits(&bits, 12));
+  EXPECT_EQ(0xF00u, bits);
+  EXPECT_TRUE(reader.OnlyZeroesLeft());
+  EXPECT_EQ(48u, reader.ReadBits(&bits, 64));
+  EXPECT_EQ(0u, bits);
+  EXPECT_TRUE(reader.ReachedEnd());
+}
+
 TEST(BitReaderWord64, ReadBitsTwoWords) {
   std::vector<uint64_t> buffer = {0x0000000000000001, 0x0000000000FFFFFF};
 
@@ -133,6 +133,27 @@ void TestEncodeDecode(MarkvModelType model_type,
   ASSERT_FALSE(decoded_text.empty());
 
   EXPECT_EQ(expected_text, decoded_text) << encoder_comments.str();
+
+  // Trusting the input must not change the bitstream.
+  spvtools::MarkvCodecOptions trusted_options;
+  trusted_options.trusted_input = true;
+
+  std::vector<uint8_t> trusted_markv;
+  ASSERT_EQ(SPV_SUCCESS,
+            spvtools::SpirvToMarkv(
+                ctx.context, binary_to_encode, trusted_options, *model,
+                DiagnosticsMessageHandler, spvtools::MarkvLogConsumer(),
+                spvtools::MarkvDebugConsumer(), &trusted_markv));
+  EXPECT_EQ(markv, trusted_markv);
+
+  std::vector<uint32_t> trusted_decoded_binary;
+  ASSERT_EQ(SPV_SUCCESS,
+            spvtools::MarkvToSpirv(ctx.context, markv, trusted_options, *model,
+                                   DiagnosticsMessageHandler,
+                                   spvtools::MarkvLogConsumer(),
+                                   spvtools::MarkvDebugConsumer(),
+                                   &trusted_decoded_binary));
+  EXPECT_EQ(expected_binary, trusted_decoded_binary);
 }
 
 void TestEncodeDecodeShaderMainBody(MarkvModelType model_type,
@@ -818,6 +839,93 @@ OpFunctionEnd
 )");
 }
 
+TEST_P(MarkvTest, Container) {
+  const std::vector<std::string> texts = {
+      R"(
+OpCapability Shader
+OpCapability Linkage
+OpMemoryModel Logical GLSL450
+%u32 = OpTypeInt 32 0
+%100 = OpConstant %u32 0
+%200 = OpConstant %u32 1
+)",
+      R"(
+OpCapability Shader
+OpCapability Linkage
+OpMemoryModel Logical GLSL450
+%f32 = OpTypeFloat 32
+%100 = OpConstant %f32 0.5
+%void = OpTypeVoid
+%func = OpTypeFunction %void
+%main = OpFunction %void None %func
+%entry = OpLabel
+OpReturn
+OpFunctionEnd
+)"};
+
+  ScopedContext ctx(SPV_ENV_UNIVERSAL_1_2);
+  std::unique_ptr<spvtools::MarkvModel> model =
+      spvtools::CreateMarkvModel(GetParam());
+  spvtools::MarkvCodecOptions options;
+
+  std::vector<std::vector<uint32_t>> expected_binaries(texts.size());
+  std::vector<std::vector<uint32_t>> binaries_to_encode(texts.size());
+  for (size_t i = 0; i < texts.size(); ++i) {
+    Compile(texts[i], &expected_binaries[i]);
+    Compile(texts[i], &binaries_to_encode[i],
+            SPV_TEXT_TO_BINARY_OPTION_PRESERVE_NUMERIC_IDS);
+  }
+
+  std::vector<uint8_t> container;
+  ASSERT_EQ(SPV_SUCCESS, spvtools::SpirvToMarkvContainer(
+                             ctx.context, binaries_to_encode, options, *model,
+                             DiagnosticsMessageHandler, &container));
+
+  std::vector<spvtools::MarkvContainerEntry> entries;
+  ASSERT_EQ(SPV_SUCCESS, spvtools::ReadMarkvContainerIndex(
+                             container.data(), container.size(),
+                             DiagnosticsMessageHandler, &entries));
+  ASSERT_EQ(texts.size(), entries.size());
+
+  // Decode the entries out of order, concurrently.
+  const std::vector<uint32_t> entry_indices = {1, 0};
+  std::vector<std::vector<uint32_t>> storage(entry_indices.size());
+  std::vector<spvtools::MarkvSpirvBuffer> buffers(entry_indices.size());
+  for (size_t i = 0; i < entry_indices.size(); ++i) {
+    storage[i].resize(entries[entry_indices[i]].spirv_num_words);
+    buffers[i].words = storage[i].data();
+    buffers[i].capacity = storage[i].size();
+  }
+
+  const auto model_provider =
+      [&model](uint32_t model_id) -> const spvtools::MarkvModel* {
+    return model_id == (model->model_type() << 16 | model->model_version())
+               ? model.get()
+               : nullptr;
+  };
+
+  ASSERT_EQ(SPV_SUCCESS,
+            spvtools::MarkvContainerToSpirv(
+                ctx.context, container.data(), container.size(),
+                entry_indices, options, model_provider,
+                DiagnosticsMessageHandler, 2, &buffers));
+  for (size_t i = 0; i < entry_indices.size(); ++i) {
+    EXPECT_EQ(expected_binaries[entry_indices[i]],
+              std::vector<uint32_t>(buffers[i].words,
+                                    buffers[i].words + buffers[i].num_words));
+  }
+
+  // A corrupted entry fails its checksum, other entries still decode.
+  container[entries[1].offset + entries[1].size - 1] ^= 0xFF;
+  EXPECT_NE(SPV_SUCCESS,
+            spvtools::MarkvContainerToSpirv(
+                ctx.context, container.data(), container.size(),
+                entry_indices, options, model_provider,
+                DiagnosticsMessageHandler, 2, &buffers));
+  EXPECT_EQ(SPV_ERROR_INVALID_BINARY, buffers[0].result);
+  EXPECT_EQ(SPV_SUCCESS, buffers[1].result);
+}
+
 INSTANTIATE_TEST_CASE_P(AllMarkvModels, MarkvTest,
                         ::testing::ValuesIn(std::vector<MarkvModelType>{
                             spvtools::kMarkvModelShaderLite,
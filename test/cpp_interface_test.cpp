@@ -279,6 +279,39 @@ void CheckOptimization(const char* original, const char* optimized,
   EXPECT_EQ(optimized, optimized_text);
 }
 
+TEST(CppInterface, BinaryIteratorVisitsInstructions) {
+  SpirvTools t(SPV_ENV_UNIVERSAL_1_1);
+  std::vector<uint32_t> binary;
+  EXPECT_TRUE(t.Assemble("%1 = OpTypeVoid\n%2 = OpTypeBool\n", &binary));
+
+  Context context(SPV_ENV_UNIVERSAL_1_1);
+  BinaryIterator it(context);
+  ASSERT_EQ(SPV_SUCCESS, it.Begin(binary.data(), binary.size()));
+  EXPECT_EQ(3u, it.header().id_bound);
+  std::vector<uint32_t> result_ids;
+  while (const spv_parsed_instruction_t* inst = it.Next())
+    result_ids.push_back(inst->result_id);
+  EXPECT_EQ(SPV_END_OF_STREAM, it.status());
+  EXPECT_THAT(result_ids, ContainerEq(std::vector<uint32_t>{1, 2}));
+}
+
+TEST(CppInterface, BinaryIteratorReportsErrors) {
+  Context context(SPV_ENV_UNIVERSAL_1_1);
+  std::string error;
+  context.SetMessageConsumer([&error](spv_message_level_t, const char*,
+                                      const spv_position_t&,
+                                      const char* message) {
+    error = message;
+  });
+  BinaryIterator it(context);
+  const std::vector<uint32_t> binary = {SpvMagicNumber, SpvVersion, 0, 1, 0,
+                                        0xffffffff};
+  ASSERT_EQ(SPV_SUCCESS, it.Begin(binary.data(), binary.size()));
+  EXPECT_EQ(nullptr, it.Next());
+  EXPECT_EQ(SPV_ERROR_INVALID_BINARY, it.status());
+  EXPECT_THAT(error, HasSubstr("Invalid opcode"));
+}
+
 TEST(CppInterface, OptimizeEmptyModule) {
   SpirvTools t(SPV_ENV_UNIVERSAL_1_1);
   std::vector<uint32_t> binary;
@@ -177,6 +177,55 @@ TEST(EnumSet, DefaultIsEmpty) {
   }
 }
 
+TEST(EnumSet, ValuesFarApart) {
+  // Values in the ranges the grammar reserves for vendors.
+  EnumSet<uint32_t> set{4423, 5009, 5568, 4437, 5569};
+  EXPECT_TRUE(set.Contains(4423));
+  EXPECT_TRUE(set.Contains(4437));
+  EXPECT_TRUE(set.Contains(5009));
+  EXPECT_TRUE(set.Contains(5568));
+  EXPECT_TRUE(set.Contains(5569));
+  EXPECT_FALSE(set.Contains(4424));
+  EXPECT_FALSE(set.Contains(5570));
+  EXPECT_FALSE(set.Contains(5568 - 64));
+  EXPECT_FALSE(set.Contains(0));
+  EXPECT_TRUE(set.HasAnyOf(EnumSet<uint32_t>{1, 5569}));
+  EXPECT_FALSE(set.HasAnyOf(EnumSet<uint32_t>{1, 5570}));
+}
+
+TEST(EnumSet, ManyBucketsKeepsAllValues) {
+  // More buckets than are stored inline, added in decreasing order.
+  std::vector<uint32_t> expected;
+  EnumSet<uint32_t> set;
+  for (uint32_t value = 64 * 40 + 3; value > 64; value -= 65) {
+    set.Add(value);
+    expected.insert(expected.begin(), value);
+  }
+  for (uint32_t value : expected) {
+    EXPECT_TRUE(set.Contains(value));
+    EXPECT_FALSE(set.Contains(value + 1));
+    EXPECT_TRUE(set.HasAnyOf(EnumSet<uint32_t>(value)));
+  }
+  std::vector<uint32_t> visited;
+  set.ForEach([&visited](uint32_t value) { visited.push_back(value); });
+  EXPECT_THAT(visited, Eq(expected));
+}
+
+TEST(EnumSet, EqualityIgnoresInsertionOrder) {
+  EnumSet<uint32_t> forward;
+  EnumSet<uint32_t> backward;
+  for (uint32_t i = 0; i < 20; ++i) {
+    forward.Add(i * 100);
+    backward.Add((19 - i) * 100);
+  }
+  EXPECT_TRUE(forward == backward);
+  EXPECT_FALSE(forward != backward);
+  backward.Add(1);
+  EXPECT_FALSE(forward == backward);
+  EXPECT_TRUE(EnumSet<uint32_t>{} == EnumSet<uint32_t>{});
+  EXPECT_FALSE(EnumSet<uint32_t>{1} == EnumSet<uint32_t>{65});
+}
+
 TEST(CapabilitySet, ConstructSingleMemberMatrix) {
   CapabilitySet s(SpvCapabilityMatrix);
   EXPECT_TRUE(s.Contains(SpvCapabilityMatrix));
@@ -15,6 +15,8 @@
 #include <cfloat>
 #include <cmath>
 #include <cstdio>
+#include <iomanip>
+#include <limits>
 #include <sstream>
 #include <string>
 #include <tuple>
@@ -1325,5 +1327,77 @@ TEST(FloatProxy, Lowest) {
               Eq(std::numeric_limits<double>::lowest()));
 }
 
+// Reading from a TextReader must match reading from a std::istringstream,
+// including the stream state.
+template <typename T>
+void ExpectTextReaderMatchesStream(const std::string& input) {
+  using HF = HexFloat<FloatProxy<T>>;
+  std::istringstream stream(input);
+  HF stream_value(typename HF::uint_type{0});
+  stream >> stream_value;
+
+  spvutils::TextReader reader(input.c_str());
+  HF reader_value(typename HF::uint_type{0});
+  reader >> reader_value;
+
+  EXPECT_THAT(reader.rdstate(), Eq(stream.rdstate())) << input;
+  if (!stream.fail()) {
+    EXPECT_THAT(reader_value.value().data(), Eq(stream_value.value().data()))
+        << input;
+  }
+}
+
+TEST(TextReader, MatchesStream) {
+  for (const char* input :
+       {"", " ", "-", "+", "0", "-0", "0.0", "-0.0", "1", "+1", "- 1",
+        " 1.5", "1.5 ", "2.5e3", "2.5E-3", "1e", "1e+", ".5", ".", "1.",
+        "1e38", "-1e40", "1e400", "1e-400", "1.5.2", "abc", "0x", "0x1",
+        "0x1p", "0x1p+3", "-0x1.8p-2", "0X1p3", "0x1.p0", "0x.8p1",
+        "0x0.0001p-10", "0x1p+128", "0x1.1p+128", "-0x1p+129", "0x1p-149",
+        "0x1p-150", "0x1p-1074", "0x1.fffffep+127", "0x1p1 ", "0x1p1x",
+        "65504", "65520", "0x1.ffcp+15"}) {
+    ExpectTextReaderMatchesStream<float>(input);
+    ExpectTextReaderMatchesStream<double>(input);
+    ExpectTextReaderMatchesStream<Float16>(input);
+  }
+}
+
+TEST(AppendFloat, MatchesStream) {
+  for (float value : {0.0f, -0.0f, 1.0f, -1.5f, 0.1f, 3.14159265f, 1e-38f,
+                      1e-45f, 1e38f, std::numeric_limits<float>::infinity(),
+                      std::numeric_limits<float>::quiet_NaN()}) {
+    std::string str;
+    spvutils::AppendFloat(FloatProxy<float>(value), &str);
+    std::ostringstream stream;
+    stream.precision(std::numeric_limits<float>::max_digits10);
+    if (std::isnormal(value) || value == 0.0f) {
+      stream << value;
+    } else {
+      stream << EncodeViaHexFloat(FloatProxy<float>(value));
+    }
+    EXPECT_THAT(str, Eq(stream.str()));
+  }
+  for (double value : {0.0, -0.0, 1.0, -1.5, 0.1, 1e-320, 1e300}) {
+    std::string str;
+    spvutils::AppendFloat(FloatProxy<double>(value), &str);
+    std::ostringstream stream;
+    stream.precision(std::numeric_limits<double>::max_digits10);
+    if (std::isnormal(value) || value == 0.0) {
+      stream << value;
+    } else {
+      stream << EncodeViaHexFloat(FloatProxy<double>(value));
+    }
+    EXPECT_THAT(str, Eq(stream.str()));
+  }
+}
+
+TEST(AppendFloat, KeepsStreamState) {
+  std::ostringstream stream;
+  stream << std::hex << std::setfill('0') << FloatProxy<float>(1.5f) << " "
+         << FloatProxy<Float16>(uint16_t{0x3c00}) << " " << std::setw(4)
+         << 10;
+  EXPECT_THAT(stream.str(), Eq("1.5 0x1p+0 000a"));
+}
+
 // TODO(awoloszyn): Add fp16 tests and HexFloatTraits.
 }  // anonymous namespace
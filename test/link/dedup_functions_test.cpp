@@ -0,0 +1,109 @@
+// Copyright (c) 2018 Google LLC.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "gmock/gmock.h"
+#include "linker_fixture.h"
+
+namespace {
+
+using ::testing::HasSubstr;
+using ::testing::Not;
+using DedupFunctions = spvtest::LinkerTest;
+
+// Both modules define the same helper %5, and export a function calling it.
+const std::string body1 = R"(
+OpCapability Linkage
+OpDecorate %1 LinkageAttributes "f1" Export
+%2 = OpTypeInt 32 0
+%3 = OpTypeFunction %2 %2
+%4 = OpConstant %2 1
+%5 = OpFunction %2 None %3
+%6 = OpFunctionParameter %2
+%7 = OpLabel
+%8 = OpIAdd %2 %6 %4
+OpReturnValue %8
+OpFunctionEnd
+%1 = OpFunction %2 None %3
+%9 = OpFunctionParameter %2
+%10 = OpLabel
+%11 = OpFunctionCall %2 %5 %9
+OpReturnValue %11
+OpFunctionEnd
+)";
+const std::string body2 = R"(
+OpCapability Linkage
+OpDecorate %1 LinkageAttributes "f2" Export
+%2 = OpTypeInt 32 0
+%3 = OpTypeFunction %2 %2
+%4 = OpConstant %2 1
+%5 = OpFunction %2 None %3
+%6 = OpFunctionParameter %2
+%7 = OpLabel
+%8 = OpIAdd %2 %6 %4
+OpReturnValue %8
+OpFunctionEnd
+%1 = OpFunction %2 None %3
+%9 = OpFunctionParameter %2
+%10 = OpLabel
+%11 = OpFunctionCall %2 %5 %9
+%12 = OpFunctionCall %2 %5 %11
+OpReturnValue %12
+OpFunctionEnd
+)";
+
+// Returns the number of functions defined in |text|.
+size_t CountFunctions(const std::string& text) {
+  size_t count = 0;
+  for (size_t pos = text.find("OpFunctionEnd"); pos != std::string::npos;
+       pos = text.find("OpFunctionEnd", pos + 1)) {
+    ++count;
+  }
+  return count;
+}
+
+TEST_F(DedupFunctions, Default) {
+  spvtest::Binary linked_binary;
+  spvtools::LinkerOptions linker_options;
+  linker_options.SetCreateLibrary(true);
+  ASSERT_EQ(SPV_SUCCESS,
+            AssembleAndLink({body1, body2}, &linked_binary, linker_options))
+      << GetErrorMessage();
+
+  std::string res_body;
+  ASSERT_EQ(SPV_SUCCESS, Disassemble(linked_binary, &res_body))
+      << GetErrorMessage();
+  EXPECT_EQ(4u, CountFunctions(res_body));
+  EXPECT_THAT(GetErrorMessage(), Not(HasSubstr("duplicate functions")));
+}
+
+TEST_F(DedupFunctions, Enabled) {
+  spvtest::Binary linked_binary;
+  spvtools::LinkerOptions linker_options;
+  linker_options.SetCreateLibrary(true);
+  linker_options.SetDedupFunctions(true);
+  ASSERT_EQ(SPV_SUCCESS,
+            AssembleAndLink({body1, body2}, &linked_binary, linker_options))
+      << GetErrorMessage();
+
+  std::string res_body;
+  ASSERT_EQ(SPV_SUCCESS, Disassemble(linked_binary, &res_body))
+      << GetErrorMessage();
+  EXPECT_EQ(3u, CountFunctions(res_body));
+  EXPECT_THAT(res_body, HasSubstr("LinkageAttributes \"f1\" Export"));
+  EXPECT_THAT(res_body, HasSubstr("LinkageAttributes \"f2\" Export"));
+  EXPECT_THAT(GetErrorMessage(),
+              HasSubstr("Removed 1 duplicate functions, saving 72 bytes."));
+}
+
+}  // anonymous namespace
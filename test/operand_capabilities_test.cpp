@@ -61,6 +61,20 @@ TEST_P(EnumCapabilityTest, Sample) {
       << " capability value " << get<1>(GetParam()).value;
 }
 
+TEST_P(EnumCapabilityTest, PrecomputedTable) {
+  const auto env = get<0>(GetParam());
+  const auto context = spvContextCreate(env);
+  const libspirv::AssemblyGrammar grammar(context);
+
+  const auto& cap_set = grammar.requiredCapabilitiesForOperand(
+      get<1>(GetParam()).type, get<1>(GetParam()).value);
+
+  EXPECT_THAT(ElementsIn(cap_set),
+              Eq(ElementsIn(get<1>(GetParam()).expected_capabilities)))
+      << " capability value " << get<1>(GetParam()).value;
+  spvContextDestroy(context);
+}
+
 #define CASE0(TYPE, VALUE)                            \
   {                                                   \
     SPV_OPERAND_TYPE_##TYPE, uint32_t(Spv##VALUE), {} \
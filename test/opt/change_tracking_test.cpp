@@ -0,0 +1,412 @@
+// Copyright (c) 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include "spirv-tools/libspirv.hpp"
+#include "spirv-tools/optimizer.hpp"
+
+#include "opt/aggressive_dead_code_elim_pass.h"
+#include "opt/build_module.h"
+#include "opt/change_tracker.h"
+#include "opt/fixpoint_pass.h"
+#include "opt/ir_context.h"
+#include "opt/make_unique.h"
+#include "opt/pass_manager.h"
+
+namespace {
+
+using namespace spvtools;
+
+// The entry point %1 calls %2.
+const std::string text = R"(
+OpCapability Shader
+OpMemoryModel Logical GLSL450
+OpEntryPoint Fragment %1 "main"
+%void = OpTypeVoid
+%functy = OpTypeFunction %void
+%1 = OpFunction %void None %functy
+%3 = OpLabel
+%4 = OpFunctionCall %void %2
+OpReturn
+OpFunctionEnd
+%2 = OpFunction %void None %functy
+%5 = OpLabel
+OpReturn
+OpFunctionEnd
+)";
+
+std::unique_ptr<ir::IRContext> Build() {
+  return BuildModule(SPV_ENV_UNIVERSAL_1_2, nullptr, text,
+                     SPV_TEXT_TO_BINARY_OPTION_PRESERVE_NUMERIC_IDS);
+}
+
+// A pass that counts how often it processes each function, and never changes
+// anything.
+class CountingPass : public opt::Pass {
+ public:
+  explicit CountingPass(std::map<uint32_t, int>* counts) : counts_(counts) {}
+
+  const char* name() const override { return "counting"; }
+  bool RecordsFunctionChanges() const override { return true; }
+  Status Process(ir::IRContext* c) override {
+    InitializeProcessing(c);
+    ProcessFunction pfn = SkipSettledFunctions([this](ir::Function* fp) {
+      ++(*counts_)[fp->result_id()];
+      return false;
+    });
+    ProcessEntryPointCallTree(pfn, get_module());
+    return Status::SuccessWithoutChange;
+  }
+
+ private:
+  std::map<uint32_t, int>* counts_;
+};
+
+// A pass that claims to change the function |id|, and records it if
+// |record| is true.
+class TouchFunctionPass : public opt::Pass {
+ public:
+  TouchFunctionPass(uint32_t id, bool record) : id_(id), record_(record) {}
+
+  const char* name() const override { return "touch"; }
+  bool RecordsFunctionChanges() const override { return record_; }
+  Status Process(ir::IRContext* c) override {
+    InitializeProcessing(c);
+    for (auto& func : *get_module()) {
+      if (func.result_id() == id_) RecordFunctionResult(&func, true);
+    }
+    return Status::SuccessWithChange;
+  }
+
+ private:
+  uint32_t id_;
+  bool record_;
+};
+
+// A pass that changes the module until |remaining| reaches 0, and counts how
+// often it ran in |runs|.
+class CountdownPass : public opt::Pass {
+ public:
+  CountdownPass(int* remaining, int* runs)
+      : remaining_(remaining), runs_(runs) {}
+
+  const char* name() const override { return "countdown"; }
+  Status Process(ir::IRContext*) override {
+    ++*runs_;
+    if (*remaining_ == 0) return Status::SuccessWithoutChange;
+    --*remaining_;
+    return Status::SuccessWithChange;
+  }
+
+ private:
+  int* remaining_;
+  int* runs_;
+};
+
+TEST(ChangeTracker, SettledUntilChanged) {
+  std::unique_ptr<ir::IRContext> context = Build();
+  const ir::Function* f = &*context->module()->begin();
+  opt::ChangeTracker tracker;
+
+  tracker.BeginPass("a");
+  EXPECT_FALSE(tracker.IsSettled(f));
+  tracker.MarkUnchanged(f);
+  EXPECT_TRUE(tracker.IsSettled(f));
+
+  tracker.BeginPass("b");
+  EXPECT_FALSE(tracker.IsSettled(f));
+  tracker.MarkChanged(f);
+
+  tracker.BeginPass("a");
+  EXPECT_FALSE(tracker.IsSettled(f));
+}
+
+TEST(ChangeTracker, ChangeInPassIsNotUndone) {
+  std::unique_ptr<ir::IRContext> context = Build();
+  const ir::Function* f = &*context->module()->begin();
+  opt::ChangeTracker tracker;
+
+  tracker.BeginPass("a");
+  tracker.MarkChanged(f);
+  tracker.MarkUnchanged(f);
+  EXPECT_FALSE(tracker.IsSettled(f));
+}
+
+TEST(ChangeTracker, ModuleChangeUnsettlesAll) {
+  std::unique_ptr<ir::IRContext> context = Build();
+  const ir::Function* f = &*context->module()->begin();
+  opt::ChangeTracker tracker;
+
+  tracker.BeginPass("a");
+  tracker.MarkUnchanged(f);
+  tracker.MarkModuleChanged();
+  EXPECT_FALSE(tracker.IsSettled(f));
+}
+
+TEST(ChangeTracking, SkipsSettledFunctions) {
+  std::unique_ptr<ir::IRContext> context = Build();
+  std::map<uint32_t, int> counts;
+  opt::PassManager manager;
+  manager.SetChangeTracking(true);
+
+  manager.AddPass<CountingPass>(&counts);
+  manager.AddPass<CountingPass>(&counts);
+  manager.Run(context.get());
+  EXPECT_EQ(1, counts[1]);
+  EXPECT_EQ(1, counts[2]);
+
+  manager.AddPass<TouchFunctionPass>(2, true);
+  manager.AddPass<CountingPass>(&counts);
+  manager.Run(context.get());
+  EXPECT_EQ(1, counts[1]);
+  EXPECT_EQ(2, counts[2]);
+
+  manager.AddPass<TouchFunctionPass>(2, false);
+  manager.AddPass<CountingPass>(&counts);
+  manager.Run(context.get());
+  EXPECT_EQ(2, counts[1]);
+  EXPECT_EQ(3, counts[2]);
+}
+
+TEST(ChangeTracking, DisabledByDefault) {
+  std::unique_ptr<ir::IRContext> context = Build();
+  std::map<uint32_t, int> counts;
+  opt::PassManager manager;
+
+  manager.AddPass<CountingPass>(&counts);
+  manager.AddPass<CountingPass>(&counts);
+  manager.Run(context.get());
+  EXPECT_EQ(2, counts[1]);
+  EXPECT_EQ(2, counts[2]);
+  EXPECT_EQ(nullptr, context->change_tracker());
+}
+
+// A fragment shader using module-scope variables, types and constants, with
+// no dead code.
+const std::string kShaderWithGlobals = R"(
+OpCapability Shader
+OpMemoryModel Logical GLSL450
+OpEntryPoint Fragment %main "main" %in %out
+OpExecutionMode %main OriginUpperLeft
+OpDecorate %in Location 0
+OpDecorate %out Location 0
+%void = OpTypeVoid
+%functy = OpTypeFunction %void
+%float = OpTypeFloat 32
+%float_2 = OpConstant %float 2
+%_ptr_Input_float = OpTypePointer Input %float
+%_ptr_Output_float = OpTypePointer Output %float
+%_ptr_Private_float = OpTypePointer Private %float
+%in = OpVariable %_ptr_Input_float Input
+%out = OpVariable %_ptr_Output_float Output
+%p = OpVariable %_ptr_Private_float Private
+%main = OpFunction %void None %functy
+%entry = OpLabel
+%x = OpLoad %float %in
+OpStore %p %x
+%y = OpLoad %float %p
+%z = OpFMul %float %y %float_2
+OpStore %out %z
+OpReturn
+OpFunctionEnd
+)";
+
+TEST(ChangeTracking, SettledFunctionsKeepTheirGlobalsLive) {
+  std::unique_ptr<ir::IRContext> context =
+      BuildModule(SPV_ENV_UNIVERSAL_1_2, nullptr, kShaderWithGlobals);
+  ASSERT_NE(nullptr, context);
+  const ir::Function* main = &*context->module()->begin();
+  std::vector<uint32_t> original;
+  context->module()->ToBinary(&original, /* skip_nop = */ true);
+
+  opt::PassManager manager;
+  manager.SetChangeTracking(true);
+  manager.AddPass<opt::AggressiveDCEPass>();
+  EXPECT_EQ(opt::Pass::Status::SuccessWithoutChange,
+            manager.Run(context.get()));
+  EXPECT_TRUE(context->change_tracker()->IsSettled(main));
+
+  // The second run skips |main|, but must still find the variables, types
+  // and constants it uses live.
+  manager.AddPass<opt::AggressiveDCEPass>();
+  EXPECT_EQ(opt::Pass::Status::SuccessWithoutChange,
+            manager.Run(context.get()));
+  std::vector<uint32_t> binary;
+  context->module()->ToBinary(&binary, /* skip_nop = */ true);
+  EXPECT_EQ(original, binary);
+}
+
+// A fragment shader as generated by glslang from:
+//
+// #version 450
+// layout(location = 0) in vec4 BaseColor;
+// layout(location = 0) out vec4 OutColor;
+// layout(binding = 0) uniform U { float threshold; };
+// float scale(float x) { return x * 2.0; }
+// void main() {
+//   vec4 c = BaseColor;
+//   float f = scale(c.x);
+//   if (f > threshold) f = 1.0;
+//   OutColor = c * f;
+// }
+const std::string kShader = R"(
+OpCapability Shader
+%1 = OpExtInstImport "GLSL.std.450"
+OpMemoryModel Logical GLSL450
+OpEntryPoint Fragment %main "main" %BaseColor %OutColor
+OpExecutionMode %main OriginUpperLeft
+OpSource GLSL 450
+OpName %main "main"
+OpName %scale_f1_ "scale(f1;"
+OpName %x "x"
+OpName %c "c"
+OpName %BaseColor "BaseColor"
+OpName %f "f"
+OpName %param "param"
+OpName %U "U"
+OpMemberName %U 0 "threshold"
+OpName %_ ""
+OpName %OutColor "OutColor"
+OpDecorate %BaseColor Location 0
+OpMemberDecorate %U 0 Offset 0
+OpDecorate %U Block
+OpDecorate %_ DescriptorSet 0
+OpDecorate %_ Binding 0
+OpDecorate %OutColor Location 0
+%void = OpTypeVoid
+%3 = OpTypeFunction %void
+%float = OpTypeFloat 32
+%_ptr_Function_float = OpTypePointer Function %float
+%8 = OpTypeFunction %float %_ptr_Function_float
+%float_2 = OpConstant %float 2
+%v4float = OpTypeVector %float 4
+%_ptr_Function_v4float = OpTypePointer Function %v4float
+%_ptr_Input_v4float = OpTypePointer Input %v4float
+%BaseColor = OpVariable %_ptr_Input_v4float Input
+%uint = OpTypeInt 32 0
+%uint_0 = OpConstant %uint 0
+%U = OpTypeStruct %float
+%_ptr_Uniform_U = OpTypePointer Uniform %U
+%_ = OpVariable %_ptr_Uniform_U Uniform
+%int = OpTypeInt 32 1
+%int_0 = OpConstant %int 0
+%_ptr_Uniform_float = OpTypePointer Uniform %float
+%bool = OpTypeBool
+%float_1 = OpConstant %float 1
+%_ptr_Output_v4float = OpTypePointer Output %v4float
+%OutColor = OpVariable %_ptr_Output_v4float Output
+%main = OpFunction %void None %3
+%5 = OpLabel
+%c = OpVariable %_ptr_Function_v4float Function
+%f = OpVariable %_ptr_Function_float Function
+%param = OpVariable %_ptr_Function_float Function
+%20 = OpLoad %v4float %BaseColor
+OpStore %c %20
+%21 = OpAccessChain %_ptr_Function_float %c %uint_0
+%22 = OpLoad %float %21
+OpStore %param %22
+%23 = OpFunctionCall %float %scale_f1_ %param
+OpStore %f %23
+%24 = OpLoad %float %f
+%25 = OpAccessChain %_ptr_Uniform_float %_ %int_0
+%26 = OpLoad %float %25
+%27 = OpFOrdGreaterThan %bool %24 %26
+OpSelectionMerge %29 None
+OpBranchConditional %27 %28 %29
+%28 = OpLabel
+OpStore %f %float_1
+OpBranch %29
+%29 = OpLabel
+%30 = OpLoad %v4float %c
+%31 = OpLoad %float %f
+%32 = OpVectorTimesScalar %v4float %30 %31
+OpStore %OutColor %32
+OpReturn
+OpFunctionEnd
+%scale_f1_ = OpFunction %float None %8
+%x = OpFunctionParameter %_ptr_Function_float
+%11 = OpLabel
+%33 = OpLoad %float %x
+%34 = OpFMul %float %33 %float_2
+OpReturnValue %34
+OpFunctionEnd
+)";
+
+// Runs the recipe |variant| of |optimizer| on |kShader|, and returns the
+// disassembly of the result with compacted ids.
+std::string OptimizeShader(void (*variant)(Optimizer*)) {
+  const spv_target_env env = SPV_ENV_UNIVERSAL_1_2;
+  SpirvTools tools(env);
+  std::vector<uint32_t> binary;
+  EXPECT_TRUE(tools.Assemble(kShader, &binary));
+
+  Optimizer optimizer(env);
+  variant(&optimizer);
+  optimizer.RegisterPass(CreateCompactIdsPass());
+  EXPECT_TRUE(optimizer.Run(binary.data(), binary.size(), &binary));
+
+  std::string disassembly;
+  EXPECT_TRUE(tools.Disassemble(binary, &disassembly));
+  return disassembly;
+}
+
+TEST(ChangeTracking, ChangeDrivenRecipeMatchesPerformanceRecipe) {
+  const std::string performance = OptimizeShader(
+      [](Optimizer* optimizer) { optimizer->RegisterPerformancePasses(); });
+  const std::string change_driven =
+      OptimizeShader([](Optimizer* optimizer) {
+        optimizer->RegisterChangeDrivenPerformancePasses();
+      });
+  EXPECT_EQ(std::string::npos, performance.find("OpFunctionCall"));
+  EXPECT_EQ(performance, change_driven);
+}
+
+TEST(FixpointPass, StopsWhenUnchanged) {
+  std::unique_ptr<ir::IRContext> context = Build();
+  int remaining = 3;
+  int runs = 0;
+  opt::FixpointPass pass(
+      {[&remaining, &runs]() {
+        return MakeUnique<CountdownPass>(&remaining, &runs);
+      }},
+      10);
+
+  EXPECT_EQ(opt::Pass::Status::SuccessWithChange, pass.Run(context.get()));
+  EXPECT_EQ(0, remaining);
+  EXPECT_EQ(4, runs);
+}
+
+TEST(FixpointPass, StopsAtMaxIterations) {
+  std::unique_ptr<ir::IRContext> context = Build();
+  int remaining = 100;
+  int runs = 0;
+  opt::FixpointPass pass(
+      {[&remaining, &runs]() {
+        return MakeUnique<CountdownPass>(&remaining, &runs);
+      }},
+      5);
+
+  EXPECT_EQ(opt::Pass::Status::SuccessWithChange, pass.Run(context.get()));
+  EXPECT_EQ(95, remaining);
+  EXPECT_EQ(5, runs);
+}
+
+}  // anonymous namespace
@@ -0,0 +1,212 @@
+// Copyright (c) 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "pass_fixture.h"
+#include "pass_utils.h"
+
+namespace {
+
+using namespace spvtools;
+
+using CodeSinkingTest = PassTest<::testing::Test>;
+
+const std::string kPredefs =
+    R"(OpCapability Shader
+OpMemoryModel Logical GLSL450
+OpEntryPoint Fragment %main "main" %in %out
+OpExecutionMode %main OriginUpperLeft
+OpName %main "main"
+OpName %U "U"
+OpName %u "u"
+OpName %in "in"
+OpName %out "out"
+OpMemberDecorate %U 0 Offset 0
+OpMemberDecorate %U 1 Offset 16
+OpDecorate %U Block
+OpDecorate %u DescriptorSet 0
+OpDecorate %u Binding 0
+OpDecorate %in Location 0
+OpDecorate %out Location 0
+%void = OpTypeVoid
+%7 = OpTypeFunction %void
+%bool = OpTypeBool
+%int = OpTypeInt 32 1
+%int_0 = OpConstant %int 0
+%int_1 = OpConstant %int 1
+%int_4 = OpConstant %int 4
+%float = OpTypeFloat 32
+%float_1 = OpConstant %float 1
+%v4float = OpTypeVector %float 4
+%U = OpTypeStruct %float %v4float
+%_ptr_Uniform_U = OpTypePointer Uniform %U
+%_ptr_Uniform_float = OpTypePointer Uniform %float
+%_ptr_Input_v4float = OpTypePointer Input %v4float
+%_ptr_Output_float = OpTypePointer Output %float
+%u = OpVariable %_ptr_Uniform_U Uniform
+%in = OpVariable %_ptr_Input_v4float Input
+%out = OpVariable %_ptr_Output_float Output
+)";
+
+// |x| is used by the branch of the entry block, but |y| and |z| are only used
+// in the "then" arm of the selection.
+const std::string kSelection =
+    R"(%main = OpFunction %void None %7
+%20 = OpLabel
+%21 = OpLoad %v4float %in
+%22 = OpCompositeExtract %float %21 0
+%23 = OpFMul %float %22 %22
+%24 = OpFAdd %float %23 %float_1
+%25 = OpFOrdLessThan %bool %22 %float_1
+OpSelectionMerge %26 None
+OpBranchConditional %25 %27 %26
+%27 = OpLabel
+OpStore %out %24
+OpBranch %26
+%26 = OpLabel
+OpReturn
+OpFunctionEnd
+)";
+
+TEST_F(CodeSinkingTest, SinkIntoBranch) {
+  const std::string after =
+      R"(%main = OpFunction %void None %7
+%20 = OpLabel
+%21 = OpLoad %v4float %in
+%22 = OpCompositeExtract %float %21 0
+%25 = OpFOrdLessThan %bool %22 %float_1
+OpSelectionMerge %26 None
+OpBranchConditional %25 %27 %26
+%27 = OpLabel
+%23 = OpFMul %float %22 %22
+%24 = OpFAdd %float %23 %float_1
+OpStore %out %24
+OpBranch %26
+%26 = OpLabel
+OpReturn
+OpFunctionEnd
+)";
+
+  SinglePassRunAndCheck<opt::CodeSinkingPass>(
+      kPredefs + kSelection, kPredefs + after, true, true, 0);
+}
+
+TEST_F(CodeSinkingTest, DoNotSinkIntoLoop) {
+  // %23 is only used in the loop, but would be computed at each iteration.
+  const std::string text =
+      R"(%main = OpFunction %void None %7
+%20 = OpLabel
+%21 = OpLoad %v4float %in
+%22 = OpCompositeExtract %float %21 0
+%23 = OpFMul %float %22 %22
+OpBranch %24
+%24 = OpLabel
+%25 = OpPhi %int %int_0 %20 %26 %27
+%28 = OpSLessThan %bool %25 %int_4
+OpLoopMerge %29 %27 None
+OpBranchConditional %28 %30 %29
+%30 = OpLabel
+OpStore %out %23
+OpBranch %27
+%27 = OpLabel
+%26 = OpIAdd %int %25 %int_1
+OpBranch %24
+%29 = OpLabel
+OpReturn
+OpFunctionEnd
+)";
+
+  SinglePassRunAndCheck<opt::CodeSinkingPass>(kPredefs + text,
+                                              kPredefs + text, true, true, 0);
+}
+
+TEST_F(CodeSinkingTest, RematerializeAccessChain) {
+  // The access chain is used in both arms, so it cannot be sunk.  Its
+  // operands are a global variable and a constant, so it is copied to both
+  // arms instead.
+  const std::string before =
+      R"(%main = OpFunction %void None %7
+%20 = OpLabel
+%21 = OpLoad %v4float %in
+%22 = OpCompositeExtract %float %21 0
+%23 = OpAccessChain %_ptr_Uniform_float %u %int_0
+%24 = OpFOrdLessThan %bool %22 %float_1
+OpSelectionMerge %25 None
+OpBranchConditional %24 %26 %27
+%26 = OpLabel
+%28 = OpLoad %float %23
+OpStore %out %28
+OpBranch %25
+%27 = OpLabel
+%29 = OpLoad %float %23
+%30 = OpFNegate %float %29
+OpStore %out %30
+OpBranch %25
+%25 = OpLabel
+OpReturn
+OpFunctionEnd
+)";
+  const std::string after =
+      R"(%main = OpFunction %void None %7
+%20 = OpLabel
+%21 = OpLoad %v4float %in
+%22 = OpCompositeExtract %float %21 0
+%24 = OpFOrdLessThan %bool %22 %float_1
+OpSelectionMerge %25 None
+OpBranchConditional %24 %26 %27
+%26 = OpLabel
+%31 = OpAccessChain %_ptr_Uniform_float %u %int_0
+%28 = OpLoad %float %31
+OpStore %out %28
+OpBranch %25
+%27 = OpLabel
+%32 = OpAccessChain %_ptr_Uniform_float %u %int_0
+%29 = OpLoad %float %32
+%30 = OpFNegate %float %29
+OpStore %out %30
+OpBranch %25
+%25 = OpLabel
+OpReturn
+OpFunctionEnd
+)";
+
+  SinglePassRunAndCheck<opt::CodeSinkingPass>(
+      kPredefs + before, kPredefs + after, true, true, 0);
+}
+
+TEST_F(CodeSinkingTest, ReportPressure) {
+  opt::CodeSinkingPass::CodeSinkingStats stats;
+  auto result = SinglePassRunAndDisassemble<opt::CodeSinkingPass>(
+      kPredefs + kSelection, /* skip_nop = */ true,
+      /* do_validation = */ true, 0, &stats);
+  EXPECT_EQ(opt::Pass::Status::SuccessWithChange, std::get<1>(result));
+  ASSERT_EQ(1u, stats.functions_.size());
+  EXPECT_EQ(2u, stats.functions_[0].sunk_);
+  EXPECT_EQ(0u, stats.functions_[0].rematerialized_);
+  EXPECT_LE(stats.functions_[0].registers_after_,
+            stats.functions_[0].registers_before_);
+}
+
+TEST_F(CodeSinkingTest, BelowThreshold) {
+  opt::CodeSinkingPass::CodeSinkingStats stats;
+  auto result = SinglePassRunAndDisassemble<opt::CodeSinkingPass>(
+      kPredefs + kSelection, /* skip_nop = */ true,
+      /* do_validation = */ true, 100, &stats);
+  EXPECT_EQ(opt::Pass::Status::SuccessWithoutChange, std::get<1>(result));
+  ASSERT_EQ(1u, stats.functions_.size());
+  EXPECT_EQ(0u, stats.functions_[0].sunk_);
+  EXPECT_EQ(stats.functions_[0].registers_before_,
+            stats.functions_[0].registers_after_);
+}
+
+}  // anonymous namespace
@@ -0,0 +1,156 @@
+// Copyright (c) 2018 Google LLC.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <string>
+
+#include <gmock/gmock.h>
+
+#include "pass_fixture.h"
+
+namespace {
+
+using namespace spvtools;
+using ::testing::HasSubstr;
+using ::testing::Not;
+
+using DedupFunctionsTest = PassTest<::testing::Test>;
+
+// Two copies of the same helper, as after linking two modules. Each copy uses
+// its own constant, as the linker does not merge them. |annotations| and
+// |wrappers| are inserted in the annotation section and after the helpers.
+std::string GetShader(const std::string& annotations,
+                      const std::string& wrappers = "") {
+  return R"(
+               OpCapability Shader
+               OpCapability Linkage
+               OpMemoryModel Logical GLSL450
+               OpEntryPoint Fragment %main "main"
+               OpName %main "main"
+               OpName %add1 "add1"
+               OpName %add1_copy "add1_copy"
+               OpName %x "x"
+               OpName %y "y"
+)" + annotations + R"(
+       %void = OpTypeVoid
+        %int = OpTypeInt 32 1
+      %int_1 = OpConstant %int 1
+ %int_1_copy = OpConstant %int 1
+     %voidfn = OpTypeFunction %void
+      %intfn = OpTypeFunction %int %int
+       %main = OpFunction %void None %voidfn
+      %entry = OpLabel
+          %x = OpFunctionCall %int %add1 %int_1
+          %y = OpFunctionCall %int %add1_copy %x
+               OpReturn
+               OpFunctionEnd
+       %add1 = OpFunction %int None %intfn
+          %a = OpFunctionParameter %int
+    %a_entry = OpLabel
+      %a_sum = OpIAdd %int %a %int_1
+               OpReturnValue %a_sum
+               OpFunctionEnd
+  %add1_copy = OpFunction %int None %intfn
+          %b = OpFunctionParameter %int
+    %b_entry = OpLabel
+      %b_sum = OpIAdd %int %b %int_1_copy
+               OpReturnValue %b_sum
+               OpFunctionEnd
+)" + wrappers;
+}
+
+TEST_F(DedupFunctionsTest, ReplaceIdenticalFunction) {
+  opt::DedupFunctionsPass::DedupStats stats;
+  auto result = SinglePassRunAndDisassemble<opt::DedupFunctionsPass>(
+      GetShader(""), /* skip_nop = */ true, /* do_validation = */ false,
+      &stats);
+  EXPECT_EQ(opt::Pass::Status::SuccessWithChange, std::get<1>(result));
+  EXPECT_EQ(1u, stats.removed_functions_);
+  // OpFunction, OpFunctionParameter, OpLabel, OpIAdd, OpReturnValue and
+  // OpFunctionEnd.
+  EXPECT_EQ(4u * (5 + 3 + 2 + 5 + 2 + 1), stats.removed_bytes_);
+
+  const std::string& text = std::get<0>(result);
+  EXPECT_THAT(text, Not(HasSubstr("add1_copy")));
+  EXPECT_THAT(text, HasSubstr("%y = OpFunctionCall %int %add1 %x"));
+}
+
+TEST_F(DedupFunctionsTest, KeepFunctionsWithDifferentDecorations) {
+  auto result = SinglePassRunAndDisassemble<opt::DedupFunctionsPass>(
+      GetShader("OpDecorate %b_sum NoContraction"), /* skip_nop = */ true,
+      /* do_validation = */ false);
+  EXPECT_EQ(opt::Pass::Status::SuccessWithoutChange, std::get<1>(result));
+}
+
+TEST_F(DedupFunctionsTest, KeepExportedFunction) {
+  auto result = SinglePassRunAndDisassemble<opt::DedupFunctionsPass>(
+      GetShader(R"(OpDecorate %add1_copy LinkageAttributes "add1" Export)"),
+      /* skip_nop = */ true, /* do_validation = */ false);
+  EXPECT_EQ(opt::Pass::Status::SuccessWithoutChange, std::get<1>(result));
+}
+
+TEST_F(DedupFunctionsTest, ReplaceCallersOfIdenticalFunctions) {
+  // The wrappers only become identical once the helpers are merged.
+  const std::string wrappers = R"(
+      %wrap1 = OpFunction %int None %intfn
+          %c = OpFunctionParameter %int
+    %c_entry = OpLabel
+     %c_call = OpFunctionCall %int %add1 %c
+               OpReturnValue %c_call
+               OpFunctionEnd
+      %wrap2 = OpFunction %int None %intfn
+          %d = OpFunctionParameter %int
+    %d_entry = OpLabel
+     %d_call = OpFunctionCall %int %add1_copy %d
+               OpReturnValue %d_call
+               OpFunctionEnd
+)";
+  opt::DedupFunctionsPass::DedupStats stats;
+  auto result = SinglePassRunAndDisassemble<opt::DedupFunctionsPass>(
+      GetShader("", wrappers), /* skip_nop = */ true,
+      /* do_validation = */ false, &stats);
+  EXPECT_EQ(opt::Pass::Status::SuccessWithChange, std::get<1>(result));
+  EXPECT_EQ(2u, stats.removed_functions_);
+}
+
+TEST_F(DedupFunctionsTest, KeepHelperIdenticalToEntryPoint) {
+  // An entry point cannot be the target of an OpFunctionCall.
+  const std::string shader = R"(
+               OpCapability Shader
+               OpMemoryModel Logical GLSL450
+               OpEntryPoint Fragment %main "main"
+               OpName %main "main"
+               OpName %helper "helper"
+       %void = OpTypeVoid
+     %voidfn = OpTypeFunction %void
+       %main = OpFunction %void None %voidfn
+      %entry = OpLabel
+               OpReturn
+               OpFunctionEnd
+     %helper = OpFunction %void None %voidfn
+    %h_entry = OpLabel
+               OpReturn
+               OpFunctionEnd
+     %caller = OpFunction %void None %voidfn
+    %c_entry = OpLabel
+     %c_call = OpFunctionCall %void %helper
+               OpReturn
+               OpFunctionEnd
+)";
+  auto result = SinglePassRunAndDisassemble<opt::DedupFunctionsPass>(
+      shader, /* skip_nop = */ true, /* do_validation = */ false);
+  EXPECT_EQ(opt::Pass::Status::SuccessWithoutChange, std::get<1>(result));
+  EXPECT_THAT(std::get<0>(result), HasSubstr("OpFunctionCall %void %helper"));
+}
+
+}  // namespace
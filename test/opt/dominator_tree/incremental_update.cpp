@@ -0,0 +1,232 @@
+// Copyright (c) 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <memory>
+#include <string>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include "opt/build_module.h"
+#include "opt/ir_builder.h"
+#include "opt/ir_context.h"
+
+namespace {
+
+using namespace spvtools;
+using IncrementalDominatorTest = ::testing::Test;
+
+// A diamond from %2 to %5, and two blocks which cannot be reached.
+const std::string diamond = R"(
+OpCapability Shader
+OpMemoryModel Logical GLSL450
+OpEntryPoint Fragment %func "func"
+%void = OpTypeVoid
+%bool = OpTypeBool
+%true = OpConstantTrue %bool
+%functy = OpTypeFunction %void
+%func = OpFunction %void None %functy
+%1 = OpLabel
+OpBranchConditional %true %2 %2
+%2 = OpLabel
+OpBranchConditional %true %3 %4
+%3 = OpLabel
+OpBranch %5
+%4 = OpLabel
+OpBranchConditional %true %5 %5
+%5 = OpLabel
+OpBranch %6
+%6 = OpLabel
+OpReturn
+%7 = OpLabel
+OpBranch %8
+%8 = OpLabel
+OpBranch %6
+OpFunctionEnd
+)";
+
+// A loop with header %2 and latch %3.
+const std::string loop = R"(
+OpCapability Shader
+OpMemoryModel Logical GLSL450
+OpEntryPoint Fragment %func "func"
+%void = OpTypeVoid
+%bool = OpTypeBool
+%true = OpConstantTrue %bool
+%functy = OpTypeFunction %void
+%func = OpFunction %void None %functy
+%1 = OpLabel
+OpBranch %2
+%2 = OpLabel
+OpBranchConditional %true %3 %4
+%3 = OpLabel
+OpBranchConditional %true %2 %4
+%4 = OpLabel
+OpReturn
+OpFunctionEnd
+)";
+
+std::unique_ptr<ir::IRContext> Build(const std::string& text) {
+  return BuildModule(SPV_ENV_UNIVERSAL_1_2, nullptr, text,
+                     SPV_TEXT_TO_BINARY_OPTION_PRESERVE_NUMERIC_IDS);
+}
+
+ir::BasicBlock* GetBlock(uint32_t id, std::unique_ptr<ir::IRContext>& context) {
+  return context->get_instr_block(context->get_def_use_mgr()->GetDef(id));
+}
+
+// Checks that |tree| is the same as a tree built from scratch for |f|.
+void ExpectSameAsRebuilt(const opt::DominatorTree& tree,
+                         const ir::Function* f) {
+  opt::DominatorTree rebuilt(tree.IsPostDominator());
+  rebuilt.InitializeTree(f);
+  for (const ir::BasicBlock& a : *f) {
+    EXPECT_EQ(rebuilt.ReachableFromRoots(&a), tree.ReachableFromRoots(&a))
+        << a.id();
+    EXPECT_EQ(rebuilt.ImmediateDominator(&a), tree.ImmediateDominator(&a))
+        << a.id();
+    if (rebuilt.ReachableFromRoots(&a)) {
+      EXPECT_EQ(rebuilt.GetTreeNode(a.id())->depth_,
+                tree.GetTreeNode(a.id())->depth_)
+          << a.id();
+    }
+    for (const ir::BasicBlock& b : *f) {
+      EXPECT_EQ(rebuilt.Dominates(&a, &b), tree.Dominates(&a, &b))
+          << a.id() << " " << b.id();
+    }
+  }
+}
+
+// Adds a block branching to |target| after |position|.
+ir::BasicBlock* AddBlock(std::unique_ptr<ir::IRContext>& context,
+                         ir::BasicBlock* position, uint32_t target) {
+  std::unique_ptr<ir::BasicBlock> bb(new ir::BasicBlock(
+      MakeUnique<ir::Instruction>(context.get(), SpvOpLabel, 0,
+                                  context->TakeNextId(),
+                                  std::initializer_list<ir::Operand>{})));
+  ir::BasicBlock* new_bb =
+      position->GetParent()->InsertBasicBlockAfter(std::move(bb), position);
+  opt::InstructionBuilder(context.get(), new_bb).AddBranch(target);
+  return new_bb;
+}
+
+TEST(IncrementalDominatorTest, InsertEdgeToReachableBlock) {
+  std::unique_ptr<ir::IRContext> context = Build(diamond);
+  ir::Function* f = &*context->module()->begin();
+  opt::DominatorTree& tree = context->GetDominatorAnalysis(f)->GetDomTree();
+
+  GetBlock(1, context)->tail()->SetInOperand(2, {5});
+  tree.InsertEdge(GetBlock(1, context), GetBlock(5, context));
+
+  EXPECT_EQ(GetBlock(1, context), tree.ImmediateDominator(5));
+  EXPECT_EQ(GetBlock(5, context), tree.ImmediateDominator(6));
+  ExpectSameAsRebuilt(tree, f);
+}
+
+TEST(IncrementalDominatorTest, InsertEdgeToUnreachableBlock) {
+  std::unique_ptr<ir::IRContext> context = Build(diamond);
+  ir::Function* f = &*context->module()->begin();
+  opt::DominatorTree& tree = context->GetDominatorAnalysis(f)->GetDomTree();
+
+  GetBlock(4, context)->tail()->SetInOperand(2, {7});
+  tree.InsertEdge(GetBlock(4, context), GetBlock(7, context));
+
+  EXPECT_EQ(GetBlock(4, context), tree.ImmediateDominator(7));
+  EXPECT_EQ(GetBlock(7, context), tree.ImmediateDominator(8));
+  EXPECT_EQ(GetBlock(2, context), tree.ImmediateDominator(6));
+  ExpectSameAsRebuilt(tree, f);
+}
+
+TEST(IncrementalDominatorTest, InsertEdgeInPostDominatorTree) {
+  std::unique_ptr<ir::IRContext> context = Build(diamond);
+  ir::Function* f = &*context->module()->begin();
+  opt::DominatorTree& tree =
+      context->GetPostDominatorAnalysis(f)->GetDomTree();
+
+  GetBlock(1, context)->tail()->SetInOperand(2, {6});
+  tree.InsertEdge(GetBlock(1, context), GetBlock(6, context));
+
+  EXPECT_EQ(GetBlock(6, context), tree.ImmediateDominator(1));
+  ExpectSameAsRebuilt(tree, f);
+}
+
+TEST(IncrementalDominatorTest, DeleteBackEdge) {
+  std::unique_ptr<ir::IRContext> context = Build(loop);
+  ir::Function* f = &*context->module()->begin();
+  opt::DominatorTree& tree = context->GetDominatorAnalysis(f)->GetDomTree();
+
+  GetBlock(3, context)->tail()->SetInOperand(1, {4});
+  tree.DeleteEdge(GetBlock(3, context), GetBlock(2, context));
+
+  EXPECT_EQ(GetBlock(2, context), tree.ImmediateDominator(4));
+  ExpectSameAsRebuilt(tree, f);
+}
+
+TEST(IncrementalDominatorTest, DeleteLastEdgeToBlock) {
+  std::unique_ptr<ir::IRContext> context = Build(diamond);
+  ir::Function* f = &*context->module()->begin();
+  opt::DominatorTree& tree = context->GetDominatorAnalysis(f)->GetDomTree();
+
+  GetBlock(2, context)->tail()->SetInOperand(2, {3});
+  tree.DeleteEdge(GetBlock(2, context), GetBlock(4, context));
+
+  EXPECT_FALSE(tree.ReachableFromRoots(GetBlock(4, context)));
+  EXPECT_EQ(GetBlock(3, context), tree.ImmediateDominator(5));
+  ExpectSameAsRebuilt(tree, f);
+}
+
+TEST(IncrementalDominatorTest, SplitBlock) {
+  std::unique_ptr<ir::IRContext> context = Build(diamond);
+  ir::Function* f = &*context->module()->begin();
+  opt::DominatorTree& tree = context->GetDominatorAnalysis(f)->GetDomTree();
+  opt::DominatorTree& post_tree =
+      context->GetPostDominatorAnalysis(f)->GetDomTree();
+
+  ir::BasicBlock* bb = GetBlock(2, context);
+  std::unique_ptr<ir::BasicBlock> split(
+      bb->SplitBasicBlock(context.get(), context->TakeNextId(), bb->tail()));
+  ir::BasicBlock* new_bb = f->InsertBasicBlockAfter(std::move(split), bb);
+  opt::InstructionBuilder(context.get(), bb).AddBranch(new_bb->id());
+  tree.SplitBlock(bb, new_bb);
+  post_tree.SplitBlock(bb, new_bb);
+
+  EXPECT_EQ(bb, tree.ImmediateDominator(new_bb));
+  EXPECT_EQ(new_bb, tree.ImmediateDominator(5));
+  EXPECT_EQ(new_bb, post_tree.ImmediateDominator(bb));
+  ExpectSameAsRebuilt(tree, f);
+  ExpectSameAsRebuilt(post_tree, f);
+}
+
+TEST(IncrementalDominatorTest, InsertBlockBefore) {
+  std::unique_ptr<ir::IRContext> context = Build(diamond);
+  ir::Function* f = &*context->module()->begin();
+  opt::DominatorTree& tree = context->GetDominatorAnalysis(f)->GetDomTree();
+  opt::DominatorTree& post_tree =
+      context->GetPostDominatorAnalysis(f)->GetDomTree();
+
+  ir::BasicBlock* new_bb = AddBlock(context, GetBlock(4, context), 5);
+  GetBlock(3, context)->tail()->SetInOperand(0, {new_bb->id()});
+  GetBlock(4, context)->tail()->SetInOperand(1, {new_bb->id()});
+  GetBlock(4, context)->tail()->SetInOperand(2, {new_bb->id()});
+  tree.InsertBlockBefore(GetBlock(5, context), new_bb);
+  post_tree.InsertBlockBefore(GetBlock(5, context), new_bb);
+
+  EXPECT_EQ(GetBlock(2, context), tree.ImmediateDominator(new_bb));
+  EXPECT_EQ(new_bb, tree.ImmediateDominator(5));
+  EXPECT_EQ(new_bb, post_tree.ImmediateDominator(3));
+  ExpectSameAsRebuilt(tree, f);
+  ExpectSameAsRebuilt(post_tree, f);
+}
+
+}  // anonymous namespace
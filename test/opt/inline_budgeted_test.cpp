@@ -0,0 +1,208 @@
+// Copyright (c) 2018 Google LLC.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "pass_fixture.h"
+#include "pass_utils.h"
+
+namespace {
+
+using namespace spvtools;
+
+using InlineBudgetedTest = PassTest<::testing::Test>;
+
+// A fragment shader calling |%big| (7 instructions) twice and |%tiny| (3
+// instructions) once.
+const std::string kShader = R"(
+               OpCapability Shader
+          %1 = OpExtInstImport "GLSL.std.450"
+               OpMemoryModel Logical GLSL450
+               OpEntryPoint Fragment %main "main" %out
+               OpExecutionMode %main OriginUpperLeft
+               OpDecorate %out Location 0
+       %void = OpTypeVoid
+     %voidfn = OpTypeFunction %void
+      %float = OpTypeFloat 32
+    %floatfn = OpTypeFunction %float %float
+%_ptr_Output_float = OpTypePointer Output %float
+        %out = OpVariable %_ptr_Output_float Output
+    %float_1 = OpConstant %float 1
+       %main = OpFunction %void None %voidfn
+      %entry = OpLabel
+         %c1 = OpFunctionCall %float %big %float_1
+         %c2 = OpFunctionCall %float %big %c1
+         %c3 = OpFunctionCall %float %tiny %c2
+               OpStore %out %c3
+               OpReturn
+               OpFunctionEnd
+        %big = OpFunction %float None %floatfn
+          %x = OpFunctionParameter %float
+  %big_entry = OpLabel
+          %a = OpFAdd %float %x %float_1
+          %b = OpFMul %float %a %a
+          %c = OpFSub %float %b %x
+          %d = OpFMul %float %c %c
+          %e = OpFAdd %float %d %float_1
+               OpReturnValue %e
+               OpFunctionEnd
+       %tiny = OpFunction %float None %floatfn
+          %y = OpFunctionParameter %float
+ %tiny_entry = OpLabel
+          %f = OpFAdd %float %y %float_1
+               OpReturnValue %f
+               OpFunctionEnd
+)";
+
+#ifdef SPIRV_EFFCEE
+TEST_F(InlineBudgetedTest, ZeroBudgetKeepsAllCalls) {
+  const std::string checks = R"(
+; CHECK: %main = OpFunction
+; CHECK: OpFunctionCall %float %big %float_1
+; CHECK: OpFunctionCall %float %big
+; CHECK: OpFunctionCall %float %tiny
+; CHECK: OpStore %out
+; CHECK: %big = OpFunction
+; CHECK: %tiny = OpFunction
+)";
+  SinglePassRunAndMatch<opt::InlineBudgetedPass>(checks + kShader, true, 0);
+}
+
+TEST_F(InlineBudgetedTest, BudgetCoversTwoCalls) {
+  const std::string checks = R"(
+; CHECK: %main = OpFunction
+; CHECK-NOT: OpFunctionCall %float %big %float_1
+; CHECK: OpFunctionCall %float %big
+; CHECK-NOT: OpFunctionCall
+; CHECK: OpStore %out
+; CHECK: %big = OpFunction
+; CHECK-NOT: %tiny = OpFunction
+)";
+  SinglePassRunAndMatch<opt::InlineBudgetedPass>(checks + kShader, true, 10);
+}
+
+TEST_F(InlineBudgetedTest, BudgetCoversAllCalls) {
+  const std::string checks = R"(
+; CHECK: %main = OpFunction
+; CHECK-NOT: OpFunctionCall
+; CHECK: OpStore %out
+; CHECK-NOT: = OpFunction
+)";
+  SinglePassRunAndMatch<opt::InlineBudgetedPass>(checks + kShader, true, 17);
+}
+#endif
+
+// A fragment shader calling |%big| (8 instructions) once.
+const std::string kSingleCallShader = R"(
+               OpCapability Shader
+               OpMemoryModel Logical GLSL450
+               OpEntryPoint Fragment %main "main"
+               OpExecutionMode %main OriginUpperLeft
+       %void = OpTypeVoid
+     %voidfn = OpTypeFunction %void
+      %float = OpTypeFloat 32
+%_ptr_Private_float = OpTypePointer Private %float
+          %p = OpVariable %_ptr_Private_float Private
+    %float_1 = OpConstant %float 1
+       %main = OpFunction %void None %voidfn
+      %entry = OpLabel
+         %c1 = OpFunctionCall %void %big
+               OpReturn
+               OpFunctionEnd
+        %big = OpFunction %void None %voidfn
+  %big_entry = OpLabel
+          %a = OpFAdd %float %float_1 %float_1
+          %b = OpFMul %float %a %a
+          %c = OpFSub %float %b %a
+          %d = OpFMul %float %c %c
+          %e = OpFAdd %float %d %float_1
+               OpStore %p %e
+               OpReturn
+               OpFunctionEnd
+)";
+
+TEST_F(InlineBudgetedTest, SingleCallSiteIsCharged) {
+  opt::InlineBudgetedPass::InlineStats stats;
+  auto result = SinglePassRunAndDisassemble<opt::InlineBudgetedPass>(
+      kSingleCallShader, /* skip_nop = */ true, /* do_validation = */ false,
+      7, &stats);
+  EXPECT_EQ(opt::Pass::Status::SuccessWithoutChange, std::get<1>(result));
+  EXPECT_EQ(0u, stats.inlined_calls_);
+  EXPECT_EQ(1u, stats.kept_calls_);
+}
+
+TEST_F(InlineBudgetedTest, InlinedFunctionIsRemoved) {
+  opt::InlineBudgetedPass::InlineStats stats;
+  auto result = SinglePassRunAndDisassemble<opt::InlineBudgetedPass>(
+      kSingleCallShader, /* skip_nop = */ true, /* do_validation = */ false,
+      8, &stats);
+  EXPECT_EQ(opt::Pass::Status::SuccessWithChange, std::get<1>(result));
+  EXPECT_EQ(1u, stats.inlined_calls_);
+  EXPECT_EQ(1u, stats.removed_functions_);
+  EXPECT_GT(stats.module_size_before_, stats.module_size_after_);
+  EXPECT_EQ(std::string::npos, std::get<0>(result).find("OpFunctionCall"));
+}
+
+TEST_F(InlineBudgetedTest, CalleeOfUncalledFunctionIsKept) {
+  // %orphan is neither an entry point nor exported, and is not called.
+  const std::string orphan = R"(
+     %orphan = OpFunction %void None %voidfn
+%orphan_entry = OpLabel
+         %c2 = OpFunctionCall %void %big
+               OpReturn
+               OpFunctionEnd
+)";
+  opt::InlineBudgetedPass::InlineStats stats;
+  auto result = SinglePassRunAndDisassemble<opt::InlineBudgetedPass>(
+      kSingleCallShader + orphan, /* skip_nop = */ true,
+      /* do_validation = */ false, 8, &stats);
+  EXPECT_EQ(opt::Pass::Status::SuccessWithChange, std::get<1>(result));
+  EXPECT_EQ(1u, stats.inlined_calls_);
+  EXPECT_EQ(0u, stats.removed_functions_);
+  const std::string& module = std::get<0>(result);
+  EXPECT_NE(std::string::npos, module.find("%big = OpFunction"));
+  EXPECT_NE(std::string::npos, module.find("OpFunctionCall %void %big"));
+}
+
+TEST_F(InlineBudgetedTest, DeadInstructionsAreNotCharged) {
+  // %z is not used, so only 8 instructions of %big are cloned.
+  std::string text = kSingleCallShader;
+  const std::string store = "OpStore %p %e\n";
+  text.replace(text.find(store), store.size(),
+               store + "          %z = OpFMul %float %e %e\n");
+
+  opt::InlineBudgetedPass::InlineStats stats;
+  auto result = SinglePassRunAndDisassemble<opt::InlineBudgetedPass>(
+      text, /* skip_nop = */ true, /* do_validation = */ false, 8, &stats);
+  EXPECT_EQ(opt::Pass::Status::SuccessWithChange, std::get<1>(result));
+  EXPECT_EQ(1u, stats.removed_instructions_);
+  EXPECT_EQ(1u, stats.inlined_calls_);
+  const std::string& module = std::get<0>(result);
+  size_t multiplies = 0;
+  for (size_t pos = module.find("OpFMul"); pos != std::string::npos;
+       pos = module.find("OpFMul", pos + 1)) {
+    ++multiplies;
+  }
+  EXPECT_EQ(2u, multiplies);
+}
+
+TEST_F(InlineBudgetedTest, ReportsKeptCalls) {
+  opt::InlineBudgetedPass::InlineStats stats;
+  auto result = SinglePassRunAndDisassemble<opt::InlineBudgetedPass>(
+      kShader, /* skip_nop = */ true, /* do_validation = */ false, 3, &stats);
+  EXPECT_EQ(opt::Pass::Status::SuccessWithChange, std::get<1>(result));
+  // Only the call to %tiny fits.
+  EXPECT_EQ(1u, stats.inlined_calls_);
+  EXPECT_EQ(2u, stats.kept_calls_);
+}
+
+}  // anonymous namespace
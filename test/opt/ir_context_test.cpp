@@ -16,6 +16,7 @@
 #include <gtest/gtest.h>
 #include <algorithm>
 
+#include "opt/build_module.h"
 #include "opt/ir_context.h"
 #include "opt/pass.h"
 #include "pass_fixture.h"
@@ -212,4 +213,48 @@ TEST_F(IRContextTest, TakeNextUniqueIdIncrementing) {
     EXPECT_EQ(i, localContext.TakeNextUniqueId());
 }
 
+TEST_F(IRContextTest, ForkSharesBodiesUntilLoaded) {
+  const std::string text = R"(OpCapability Shader
+OpMemoryModel Logical GLSL450
+OpEntryPoint Fragment %1 "main"
+OpName %1 "main"
+%void = OpTypeVoid
+%3 = OpTypeFunction %void
+%1 = OpFunction %void None %3
+%4 = OpLabel
+OpReturn
+OpFunctionEnd
+)";
+  SpirvTools t(SPV_ENV_UNIVERSAL_1_2);
+  std::vector<uint32_t> binary;
+  ASSERT_TRUE(t.Assemble(text, &binary));
+
+  std::unique_ptr<IRContext> context =
+      BuildModule(SPV_ENV_UNIVERSAL_1_2, nullptr, binary.data(), binary.size(),
+                  /* lazy_function_bodies = */ true);
+  ASSERT_NE(nullptr, context);
+  std::unique_ptr<IRContext> fork = context->Fork();
+  ir::Function* original_func = &*context->module()->begin();
+  ir::Function* fork_func = &*fork->module()->begin();
+  EXPECT_FALSE(original_func->IsBodyLoaded());
+  EXPECT_FALSE(fork_func->IsBodyLoaded());
+
+  std::vector<uint32_t> fork_binary;
+  fork->module()->ToBinary(&fork_binary, /* skip_nop = */ false);
+  EXPECT_EQ(binary, fork_binary);
+
+  // Changing the fork loads its own body, and leaves the original alone.
+  fork_func->begin()->tail()->ToNop();
+  EXPECT_TRUE(fork_func->IsBodyLoaded());
+  EXPECT_FALSE(original_func->IsBodyLoaded());
+  EXPECT_EQ(fork.get(), fork->get_def_use_mgr()->GetDef(1)->context());
+
+  std::vector<uint32_t> original_binary;
+  context->module()->ToBinary(&original_binary, /* skip_nop = */ false);
+  EXPECT_EQ(binary, original_binary);
+  fork_binary.clear();
+  fork->module()->ToBinary(&fork_binary, /* skip_nop = */ true);
+  EXPECT_EQ(binary.size() - 1, fork_binary.size());
+}
+
 }  // anonymous namespace
@@ -37,6 +37,28 @@ void DoRoundTripCheck(const std::string& text) {
   std::string disassembled_text;
   EXPECT_TRUE(t.Disassemble(binary, &disassembled_text));
   EXPECT_EQ(text, disassembled_text);
+
+  // Loading the function bodies lazily gives the same result, whether they
+  // are loaded or not.
+  context = BuildModule(SPV_ENV_UNIVERSAL_1_1, nullptr, binary.data(),
+                        binary.size(), /* lazy_function_bodies = */ true);
+  ASSERT_NE(nullptr, context);
+  std::vector<uint32_t> lazy_binary;
+  context->module()->ToBinary(&lazy_binary, /* skip_nop = */ false);
+  EXPECT_EQ(binary, lazy_binary);
+
+  for (auto& function : *context->module()) function.begin();
+  lazy_binary.clear();
+  context->module()->ToBinary(&lazy_binary, /* skip_nop = */ false);
+  EXPECT_EQ(binary, lazy_binary);
+
+  // So does building and writing the module with several threads.
+  context = BuildModuleInParallel(SPV_ENV_UNIVERSAL_1_1, nullptr,
+                                  binary.data(), binary.size(), 4);
+  ASSERT_NE(nullptr, context);
+  std::vector<uint32_t> parallel_binary;
+  context->module()->ToBinary(&parallel_binary, /* skip_nop = */ false, 4);
+  EXPECT_EQ(binary, parallel_binary);
 }
 
 TEST(IrBuilder, RoundTrip) {
@@ -326,7 +348,17 @@ void DoErrorMessageCheck(const std::string& assembly,
 
   SpirvTools t(SPV_ENV_UNIVERSAL_1_1);
   std::unique_ptr<ir::IRContext> context =
-      BuildModule(SPV_ENV_UNIVERSAL_1_1, std::move(consumer), assembly);
+      BuildModule(SPV_ENV_UNIVERSAL_1_1, consumer, assembly);
+  EXPECT_EQ(nullptr, context);
+
+  // The function bodies are checked even if they are loaded lazily.
+  std::vector<uint32_t> binary;
+  ASSERT_TRUE(t.Assemble(assembly, &binary));
+  context = BuildModule(SPV_ENV_UNIVERSAL_1_1, consumer, binary.data(),
+                        binary.size(), /* lazy_function_bodies = */ true);
+  EXPECT_EQ(nullptr, context);
+  context = BuildModuleInParallel(SPV_ENV_UNIVERSAL_1_1, consumer,
+                                  binary.data(), binary.size(), 4);
   EXPECT_EQ(nullptr, context);
 }
 
@@ -444,6 +476,121 @@ TEST(IrBuilder, UniqueIds) {
   context->module()->ForEachInst([&ids](const ir::Instruction* inst) {
     EXPECT_TRUE(ids.insert(inst->unique_id()).second);
   });
+
+  // Building the function bodies in parallel gives the same unique ids.
+  std::vector<uint32_t> serial_ids;
+  context->module()->ForEachInst(
+      [&serial_ids](const ir::Instruction* inst) {
+        serial_ids.push_back(inst->unique_id());
+      },
+      true);
+  std::vector<uint32_t> binary;
+  context->module()->ToBinary(&binary, /* skip_nop = */ false);
+  context = BuildModuleInParallel(SPV_ENV_UNIVERSAL_1_1, nullptr,
+                                  binary.data(), binary.size(), 4);
+  ASSERT_NE(nullptr, context);
+  std::vector<uint32_t> parallel_ids;
+  context->module()->ForEachInst(
+      [&parallel_ids](const ir::Instruction* inst) {
+        parallel_ids.push_back(inst->unique_id());
+      },
+      true);
+  EXPECT_EQ(serial_ids, parallel_ids);
+}
+
+TEST(IrBuilder, LazyFunctionBodiesAreLoadedOnFirstAccess) {
+  const std::string text =
+      // clang-format off
+               "OpCapability Shader\n"
+               "OpMemoryModel Logical GLSL450\n"
+       "%void = OpTypeVoid\n"
+          "%3 = OpTypeFunction %void\n"
+        "%int = OpTypeInt 32 1\n"
+      "%int_1 = OpConstant %int 1\n"
+          "%4 = OpFunction %void None %3\n"
+          "%5 = OpLabel\n"
+               "OpSelectionMerge %6 None\n"
+               "OpSwitch %int_1 %6 1 %6\n"
+          "%6 = OpLabel\n"
+               "OpReturn\n"
+               "OpFunctionEnd\n"
+          "%7 = OpFunction %void None %3\n"
+          "%8 = OpLabel\n"
+               "OpReturn\n"
+               "OpFunctionEnd\n";
+  // clang-format on
+  SpirvTools t(SPV_ENV_UNIVERSAL_1_1);
+  std::vector<uint32_t> binary;
+  ASSERT_TRUE(t.Assemble(text, &binary));
+
+  std::unique_ptr<ir::IRContext> context =
+      BuildModule(SPV_ENV_UNIVERSAL_1_1, nullptr, binary.data(), binary.size(),
+                  /* lazy_function_bodies = */ true);
+  ASSERT_NE(nullptr, context);
+  ir::Module* module = context->module();
+
+  auto first = module->begin();
+  auto second = ++module->begin();
+  EXPECT_EQ(4u, first->result_id());
+  EXPECT_EQ(7u, second->result_id());
+  EXPECT_FALSE(first->IsBodyLoaded());
+  EXPECT_FALSE(second->IsBodyLoaded());
+
+  // Loading the first body leaves the second one alone.  The OpSwitch literal
+  // is decoded with the width of its selector type.
+  EXPECT_EQ(2, std::distance(first->begin(), first->end()));
+  EXPECT_TRUE(first->IsBodyLoaded());
+  EXPECT_FALSE(second->IsBodyLoaded());
+  const ir::Instruction* branch = first->entry()->terminator();
+  ASSERT_EQ(SpvOpSwitch, branch->opcode());
+  EXPECT_EQ(4u, branch->NumInOperands());
+  EXPECT_EQ(&*first, first->entry()->GetParent());
+
+  // A change in a loaded body is written out, next to the unchanged bytes of
+  // the body which is not loaded.
+  first->entry()->ForEachInst([](ir::Instruction* inst) {
+    if (inst->opcode() == SpvOpSelectionMerge) inst->ToNop();
+  });
+  std::vector<uint32_t> optimized;
+  module->ToBinary(&optimized, /* skip_nop = */ true);
+  EXPECT_FALSE(second->IsBodyLoaded());
+
+  std::string disassembled_text;
+  EXPECT_TRUE(t.Disassemble(optimized, &disassembled_text));
+  std::string expected_text = text;
+  expected_text.erase(expected_text.find("OpSelectionMerge"),
+                      std::string("OpSelectionMerge %6 None\n").size());
+  EXPECT_EQ(expected_text, disassembled_text);
+}
+
+TEST(IrBuilder, LazyFunctionBodiesWithOtherEndianness) {
+  const std::string text =
+      // clang-format off
+               "OpCapability Shader\n"
+               "OpMemoryModel Logical GLSL450\n"
+       "%void = OpTypeVoid\n"
+          "%2 = OpTypeFunction %void\n"
+          "%3 = OpFunction %void None %2\n"
+          "%4 = OpLabel\n"
+               "OpReturn\n"
+               "OpFunctionEnd\n";
+  // clang-format on
+  SpirvTools t(SPV_ENV_UNIVERSAL_1_1);
+  std::vector<uint32_t> binary;
+  ASSERT_TRUE(t.Assemble(text, &binary));
+  std::vector<uint32_t> swapped(binary);
+  for (uint32_t& word : swapped) {
+    word = (word >> 24) | ((word >> 8) & 0xff00) | ((word << 8) & 0xff0000) |
+           (word << 24);
+  }
+
+  std::unique_ptr<ir::IRContext> context =
+      BuildModule(SPV_ENV_UNIVERSAL_1_1, nullptr, swapped.data(),
+                  swapped.size(), /* lazy_function_bodies = */ true);
+  ASSERT_NE(nullptr, context);
+  std::vector<uint32_t> lazy_binary;
+  context->module()->ToBinary(&lazy_binary, /* skip_nop = */ false);
+  EXPECT_EQ(binary, lazy_binary);
 }
 
 }  // anonymous namespace
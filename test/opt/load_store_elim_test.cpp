@@ -0,0 +1,238 @@
+// Copyright (c) 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "pass_fixture.h"
+#include "pass_utils.h"
+
+namespace {
+
+using namespace spvtools;
+
+using LoadStoreElimTest = PassTest<::testing::Test>;
+
+const std::string kPredefs =
+    R"(OpCapability Shader
+OpMemoryModel Logical GLSL450
+OpEntryPoint GLCompute %main "main"
+OpExecutionMode %main LocalSize 1 1 1
+OpName %main "main"
+OpName %u "u"
+OpName %p "p"
+OpName %w "w"
+OpName %S "S"
+OpDecorate %S Block
+OpMemberDecorate %S 0 Offset 0
+%void = OpTypeVoid
+%7 = OpTypeFunction %void
+%uint = OpTypeInt 32 0
+%uint_0 = OpConstant %uint 0
+%uint_2 = OpConstant %uint 2
+%uint_264 = OpConstant %uint 264
+%float = OpTypeFloat 32
+%float_1 = OpConstant %float 1
+%float_2 = OpConstant %float 2
+%S = OpTypeStruct %float
+%_ptr_Uniform_S = OpTypePointer Uniform %S
+%_ptr_Uniform_float = OpTypePointer Uniform %float
+%_ptr_Function_float = OpTypePointer Function %float
+%_ptr_Private_float = OpTypePointer Private %float
+%_ptr_Workgroup_float = OpTypePointer Workgroup %float
+%u = OpVariable %_ptr_Uniform_S Uniform
+%p = OpVariable %_ptr_Private_float Private
+%w = OpVariable %_ptr_Workgroup_float Workgroup
+)";
+
+TEST_F(LoadStoreElimTest, ForwardStoreToLoad) {
+  const std::string before =
+      R"(%main = OpFunction %void None %7
+%20 = OpLabel
+OpStore %p %float_1
+%21 = OpLoad %float %p
+%22 = OpFAdd %float %21 %21
+OpStore %w %22
+OpReturn
+OpFunctionEnd
+)";
+  const std::string after =
+      R"(%main = OpFunction %void None %7
+%20 = OpLabel
+OpStore %p %float_1
+%22 = OpFAdd %float %float_1 %float_1
+OpStore %w %22
+OpReturn
+OpFunctionEnd
+)";
+
+  SinglePassRunAndCheck<opt::LoadStoreElimPass>(kPredefs + before,
+                                                kPredefs + after, true, true);
+}
+
+TEST_F(LoadStoreElimTest, ReuseUniformLoad) {
+  const std::string before =
+      R"(%main = OpFunction %void None %7
+%20 = OpLabel
+%21 = OpAccessChain %_ptr_Uniform_float %u %uint_0
+%22 = OpLoad %float %21
+OpStore %w %22
+%23 = OpAccessChain %_ptr_Uniform_float %u %uint_0
+%24 = OpLoad %float %23
+%25 = OpFAdd %float %22 %24
+OpStore %w %25
+OpReturn
+OpFunctionEnd
+)";
+  const std::string after =
+      R"(%main = OpFunction %void None %7
+%20 = OpLabel
+%21 = OpAccessChain %_ptr_Uniform_float %u %uint_0
+%22 = OpLoad %float %21
+%23 = OpAccessChain %_ptr_Uniform_float %u %uint_0
+%25 = OpFAdd %float %22 %22
+OpStore %w %25
+OpReturn
+OpFunctionEnd
+)";
+
+  SinglePassRunAndCheck<opt::LoadStoreElimPass>(kPredefs + before,
+                                                kPredefs + after, true, true);
+}
+
+TEST_F(LoadStoreElimTest, KeepUniformLoadAfterBarrier) {
+  const std::string text =
+      R"(%main = OpFunction %void None %7
+%20 = OpLabel
+%21 = OpAccessChain %_ptr_Uniform_float %u %uint_0
+%22 = OpLoad %float %21
+OpStore %w %22
+OpControlBarrier %uint_2 %uint_2 %uint_264
+%23 = OpAccessChain %_ptr_Uniform_float %u %uint_0
+%24 = OpLoad %float %23
+OpStore %w %24
+OpReturn
+OpFunctionEnd
+)";
+
+  SinglePassRunAndCheck<opt::LoadStoreElimPass>(kPredefs + text,
+                                                kPredefs + text, true, true);
+}
+
+TEST_F(LoadStoreElimTest, KeepCoherentBufferLoad) {
+  std::string predefs = kPredefs;
+  const std::string block = "OpDecorate %S Block\n";
+  predefs.replace(predefs.find(block), block.size(),
+                  block + "OpDecorate %u Coherent\n");
+  const std::string text =
+      R"(%main = OpFunction %void None %7
+%20 = OpLabel
+%21 = OpAccessChain %_ptr_Uniform_float %u %uint_0
+%22 = OpLoad %float %21
+OpStore %w %22
+%23 = OpAccessChain %_ptr_Uniform_float %u %uint_0
+%24 = OpLoad %float %23
+OpStore %w %24
+OpReturn
+OpFunctionEnd
+)";
+
+  SinglePassRunAndCheck<opt::LoadStoreElimPass>(predefs + text, predefs + text,
+                                                true, true);
+}
+
+TEST_F(LoadStoreElimTest, RemoveOverwrittenLocalStore) {
+  const std::string before =
+      R"(%main = OpFunction %void None %7
+%20 = OpLabel
+%21 = OpVariable %_ptr_Function_float Function
+%22 = OpVariable %_ptr_Function_float Function
+OpStore %21 %float_1
+OpStore %21 %float_2
+%23 = OpLoad %float %21
+OpStore %22 %23
+OpStore %w %23
+OpReturn
+OpFunctionEnd
+)";
+  const std::string after =
+      R"(%main = OpFunction %void None %7
+%20 = OpLabel
+%21 = OpVariable %_ptr_Function_float Function
+%22 = OpVariable %_ptr_Function_float Function
+OpStore %21 %float_2
+OpStore %w %float_2
+OpReturn
+OpFunctionEnd
+)";
+
+  SinglePassRunAndCheck<opt::LoadStoreElimPass>(kPredefs + before,
+                                                kPredefs + after, true, true);
+}
+
+TEST_F(LoadStoreElimTest, KeepStoreBeforeBarrier) {
+  const std::string text =
+      R"(%main = OpFunction %void None %7
+%20 = OpLabel
+OpStore %w %float_1
+OpControlBarrier %uint_2 %uint_2 %uint_264
+OpStore %w %float_2
+OpReturn
+OpFunctionEnd
+)";
+
+  SinglePassRunAndCheck<opt::LoadStoreElimPass>(kPredefs + text,
+                                                kPredefs + text, true, true);
+}
+
+TEST_F(LoadStoreElimTest, RemoveOverwrittenWorkgroupStore) {
+  const std::string before =
+      R"(%main = OpFunction %void None %7
+%20 = OpLabel
+OpStore %w %float_1
+OpStore %w %float_2
+OpReturn
+OpFunctionEnd
+)";
+  const std::string after =
+      R"(%main = OpFunction %void None %7
+%20 = OpLabel
+OpStore %w %float_2
+OpReturn
+OpFunctionEnd
+)";
+
+  SinglePassRunAndCheck<opt::LoadStoreElimPass>(kPredefs + before,
+                                                kPredefs + after, true, true);
+}
+
+TEST_F(LoadStoreElimTest, KeepLoadAfterCall) {
+  const std::string text =
+      R"(%main = OpFunction %void None %7
+%20 = OpLabel
+OpStore %p %float_1
+%21 = OpFunctionCall %void %22
+%23 = OpLoad %float %p
+OpStore %w %23
+OpReturn
+OpFunctionEnd
+%22 = OpFunction %void None %7
+%24 = OpLabel
+OpStore %p %float_2
+OpReturn
+OpFunctionEnd
+)";
+
+  SinglePassRunAndCheck<opt::LoadStoreElimPass>(kPredefs + text,
+                                                kPredefs + text, true, true);
+}
+
+}  // anonymous namespace
@@ -0,0 +1,156 @@
+// Copyright (c) 2018 Google LLC.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gmock/gmock.h>
+
+#include "../pass_fixture.h"
+#include "opt/loop_descriptor.h"
+#include "opt/loop_fission.h"
+
+namespace {
+
+using namespace spvtools;
+
+using FissionPassTest = PassTest<::testing::Test>;
+
+/*
+Generated from the following GLSL, with |second_store| being |%C| or |%B| and
+|store_index| being |%i| or |%i_plus|
+
+#version 330 core
+void main() {
+  float A[10];
+  float B[10];
+  float C[10];
+  float D[10];
+  for (int i = 0; i < 10; ++i) {
+    float b = B[i];
+    float d = D[i];
+    A[i] = b;
+    C[i] = d;  // or B[i + 1] = d
+  }
+}
+*/
+std::string GetShader(const std::string& second_store,
+                      const std::string& store_index) {
+  return R"(
+               OpCapability Shader
+          %1 = OpExtInstImport "GLSL.std.450"
+               OpMemoryModel Logical GLSL450
+               OpEntryPoint Fragment %main "main"
+               OpExecutionMode %main OriginUpperLeft
+               OpSource GLSL 330
+               OpName %main "main"
+       %void = OpTypeVoid
+     %voidfn = OpTypeFunction %void
+        %int = OpTypeInt 32 1
+      %int_0 = OpConstant %int 0
+      %int_1 = OpConstant %int 1
+     %int_10 = OpConstant %int 10
+       %bool = OpTypeBool
+      %float = OpTypeFloat 32
+       %uint = OpTypeInt 32 0
+    %uint_10 = OpConstant %uint 10
+      %array = OpTypeArray %float %uint_10
+%_ptr_Function_array = OpTypePointer Function %array
+%_ptr_Function_float = OpTypePointer Function %float
+       %main = OpFunction %void None %voidfn
+      %entry = OpLabel
+          %A = OpVariable %_ptr_Function_array Function
+          %B = OpVariable %_ptr_Function_array Function
+          %C = OpVariable %_ptr_Function_array Function
+          %D = OpVariable %_ptr_Function_array Function
+               OpBranch %header
+     %header = OpLabel
+          %i = OpPhi %int %int_0 %entry %i_next %latch
+        %cmp = OpSLessThan %bool %i %int_10
+               OpLoopMerge %merge %latch None
+               OpBranchConditional %cmp %body %merge
+       %body = OpLabel
+     %i_plus = OpIAdd %int %i %int_1
+      %b_ptr = OpAccessChain %_ptr_Function_float %B %i
+          %b = OpLoad %float %b_ptr
+      %d_ptr = OpAccessChain %_ptr_Function_float %D %i
+          %d = OpLoad %float %d_ptr
+      %a_ptr = OpAccessChain %_ptr_Function_float %A %i
+               OpStore %a_ptr %b
+      %c_ptr = OpAccessChain %_ptr_Function_float )" +
+         second_store + " " + store_index + R"(
+               OpStore %c_ptr %d
+               OpBranch %latch
+      %latch = OpLabel
+     %i_next = OpIAdd %int %i %int_1
+               OpBranch %header
+      %merge = OpLabel
+               OpReturn
+               OpFunctionEnd
+)";
+}
+
+#ifdef SPIRV_EFFCEE
+TEST_F(FissionPassTest, SplitIndependentStores) {
+  const std::string checks = R"(
+; CHECK: OpLoopMerge
+; CHECK: OpLoad %float
+; CHECK-NOT: OpLoad
+; CHECK: OpStore
+; CHECK-NOT: OpStore
+; CHECK: OpLoopMerge %merge %latch None
+; CHECK-NOT: %b = OpLoad
+; CHECK: %d = OpLoad %float %d_ptr
+; CHECK-NOT: OpStore %a_ptr
+; CHECK: OpStore %c_ptr %d
+; CHECK: %merge = OpLabel
+)";
+  SinglePassRunAndMatch<opt::LoopFissionPass>(checks + GetShader("%C", "%i"),
+                                              true, 0);
+}
+#endif
+
+TEST_F(FissionPassTest, SplitLoop) {
+  opt::LoopFissionPass::LoopFissionStats stats;
+  auto result = SinglePassRunAndDisassemble<opt::LoopFissionPass>(
+      GetShader("%C", "%i"), /* skip_nop = */ true,
+      /* do_validation = */ true, 0, &stats);
+  EXPECT_EQ(opt::Pass::Status::SuccessWithChange, std::get<1>(result));
+  ASSERT_EQ(1u, stats.split_loops_.size());
+  EXPECT_LT(stats.split_loops_[0].registers_first_,
+            stats.split_loops_[0].registers_before_);
+  EXPECT_LT(stats.split_loops_[0].registers_second_,
+            stats.split_loops_[0].registers_before_);
+
+  ir::Function& f = *context()->module()->begin();
+  EXPECT_EQ(2u, context()->GetLoopDescriptor(&f)->NumLoops());
+}
+
+TEST_F(FissionPassTest, DoNotSplitLoopCarriedDependence) {
+  // B[i + 1] is written by an iteration before B[i + 1] is read.
+  opt::LoopFissionPass::LoopFissionStats stats;
+  auto result = SinglePassRunAndDisassemble<opt::LoopFissionPass>(
+      GetShader("%B", "%i_plus"), /* skip_nop = */ true,
+      /* do_validation = */ false, 0, &stats);
+  EXPECT_EQ(opt::Pass::Status::SuccessWithoutChange, std::get<1>(result));
+  EXPECT_TRUE(stats.split_loops_.empty());
+}
+
+TEST_F(FissionPassTest, DoNotSplitBelowThreshold) {
+  opt::LoopFissionPass::LoopFissionStats stats;
+  auto result = SinglePassRunAndDisassemble<opt::LoopFissionPass>(
+      GetShader("%C", "%i"), /* skip_nop = */ true,
+      /* do_validation = */ false, 100, &stats);
+  EXPECT_EQ(opt::Pass::Status::SuccessWithoutChange, std::get<1>(result));
+  EXPECT_TRUE(stats.split_loops_.empty());
+}
+
+}  // namespace
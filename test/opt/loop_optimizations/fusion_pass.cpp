@@ -0,0 +1,164 @@
+// Copyright (c) 2018 Google LLC.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gmock/gmock.h>
+
+#include "../pass_fixture.h"
+#include "opt/loop_descriptor.h"
+#include "opt/loop_fusion.h"
+
+namespace {
+
+using namespace spvtools;
+
+using FusionPassTest = PassTest<::testing::Test>;
+
+/*
+Generated from the following GLSL, with |load_index| being |%i1| or |%i1_plus|
+
+#version 330 core
+void main() {
+  float A[10];
+  float B[10];
+  float C[10];
+  for (int i = 0; i < 10; ++i) {
+    A[i] = B[i];
+  }
+  for (int i = 0; i < 10; ++i) {
+    C[i] = A[i];  // or A[i + 1]
+  }
+}
+*/
+std::string GetShader(const std::string& load_index) {
+  return R"(
+               OpCapability Shader
+          %1 = OpExtInstImport "GLSL.std.450"
+               OpMemoryModel Logical GLSL450
+               OpEntryPoint Fragment %main "main"
+               OpExecutionMode %main OriginUpperLeft
+               OpSource GLSL 330
+               OpName %main "main"
+       %void = OpTypeVoid
+     %voidfn = OpTypeFunction %void
+        %int = OpTypeInt 32 1
+      %int_0 = OpConstant %int 0
+      %int_1 = OpConstant %int 1
+     %int_10 = OpConstant %int 10
+       %bool = OpTypeBool
+      %float = OpTypeFloat 32
+       %uint = OpTypeInt 32 0
+    %uint_10 = OpConstant %uint 10
+      %array = OpTypeArray %float %uint_10
+%_ptr_Function_array = OpTypePointer Function %array
+%_ptr_Function_float = OpTypePointer Function %float
+       %main = OpFunction %void None %voidfn
+      %entry = OpLabel
+          %A = OpVariable %_ptr_Function_array Function
+          %B = OpVariable %_ptr_Function_array Function
+          %C = OpVariable %_ptr_Function_array Function
+               OpBranch %header_0
+   %header_0 = OpLabel
+         %i0 = OpPhi %int %int_0 %entry %i0_next %latch_0
+      %cmp_0 = OpSLessThan %bool %i0 %int_10
+               OpLoopMerge %merge_0 %latch_0 None
+               OpBranchConditional %cmp_0 %body_0 %merge_0
+     %body_0 = OpLabel
+      %b_ptr = OpAccessChain %_ptr_Function_float %B %i0
+          %b = OpLoad %float %b_ptr
+      %a_ptr = OpAccessChain %_ptr_Function_float %A %i0
+               OpStore %a_ptr %b
+               OpBranch %latch_0
+    %latch_0 = OpLabel
+    %i0_next = OpIAdd %int %i0 %int_1
+               OpBranch %header_0
+    %merge_0 = OpLabel
+               OpBranch %header_1
+   %header_1 = OpLabel
+         %i1 = OpPhi %int %int_0 %merge_0 %i1_next %latch_1
+      %cmp_1 = OpSLessThan %bool %i1 %int_10
+               OpLoopMerge %merge_1 %latch_1 None
+               OpBranchConditional %cmp_1 %body_1 %merge_1
+     %body_1 = OpLabel
+    %i1_plus = OpIAdd %int %i1 %int_1
+     %a_ptr1 = OpAccessChain %_ptr_Function_float %A )" +
+         load_index + R"(
+          %a = OpLoad %float %a_ptr1
+      %c_ptr = OpAccessChain %_ptr_Function_float %C %i1
+               OpStore %c_ptr %a
+               OpBranch %latch_1
+    %latch_1 = OpLabel
+    %i1_next = OpIAdd %int %i1 %int_1
+               OpBranch %header_1
+    %merge_1 = OpLabel
+               OpReturn
+               OpFunctionEnd
+)";
+}
+
+#ifdef SPIRV_EFFCEE
+TEST_F(FusionPassTest, FuseIndependentLoops) {
+  const std::string checks = R"(
+; CHECK: %header_0 = OpLabel
+; CHECK-NEXT: %i0 = OpPhi %int %int_0 %entry %i0_next %latch_0
+; CHECK: OpLoopMerge %merge_1 %latch_0 None
+; CHECK-NEXT: OpBranchConditional %cmp_0 %body_0 %merge_1
+; CHECK: %body_0 = OpLabel
+; CHECK: OpStore %a_ptr %b
+; CHECK-NEXT: OpBranch %body_1
+; CHECK: %body_1 = OpLabel
+; CHECK: %a_ptr1 = OpAccessChain %_ptr_Function_float %A %i0
+; CHECK: OpStore %c_ptr %a
+; CHECK-NEXT: OpBranch %latch_0
+; CHECK: %latch_0 = OpLabel
+; CHECK-NOT: OpLoopMerge
+; CHECK: %merge_1 = OpLabel
+)";
+  SinglePassRunAndMatch<opt::LoopFusionPass>(checks + GetShader("%i1"), true,
+                                             100);
+}
+#endif
+
+TEST_F(FusionPassTest, FuseLoops) {
+  opt::LoopFusionPass::LoopFusionStats stats;
+  auto result = SinglePassRunAndDisassemble<opt::LoopFusionPass>(
+      GetShader("%i1"), /* skip_nop = */ true, /* do_validation = */ true, 100,
+      &stats);
+  EXPECT_EQ(opt::Pass::Status::SuccessWithChange, std::get<1>(result));
+  ASSERT_EQ(1u, stats.fused_loops_.size());
+  EXPECT_LE(stats.fused_loops_[0].registers_fused_, 100u);
+
+  ir::Function& f = *context()->module()->begin();
+  EXPECT_EQ(1u, context()->GetLoopDescriptor(&f)->NumLoops());
+}
+
+TEST_F(FusionPassTest, DoNotFuseLoopCarriedDependence) {
+  // The second loop reads A[i + 1] before the first loop writes it once fused.
+  opt::LoopFusionPass::LoopFusionStats stats;
+  auto result = SinglePassRunAndDisassemble<opt::LoopFusionPass>(
+      GetShader("%i1_plus"), /* skip_nop = */ true,
+      /* do_validation = */ false, 100, &stats);
+  EXPECT_EQ(opt::Pass::Status::SuccessWithoutChange, std::get<1>(result));
+  EXPECT_TRUE(stats.fused_loops_.empty());
+}
+
+TEST_F(FusionPassTest, DoNotFuseAboveRegisterLimit) {
+  opt::LoopFusionPass::LoopFusionStats stats;
+  auto result = SinglePassRunAndDisassemble<opt::LoopFusionPass>(
+      GetShader("%i1"), /* skip_nop = */ true, /* do_validation = */ false, 0,
+      &stats);
+  EXPECT_EQ(opt::Pass::Status::SuccessWithoutChange, std::get<1>(result));
+  EXPECT_TRUE(stats.fused_loops_.empty());
+}
+
+}  // namespace
@@ -0,0 +1,258 @@
+// Copyright (c) 2018 Google LLC.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <map>
+#include <string>
+#include <utility>
+
+#include <gmock/gmock.h>
+
+#include "../pass_fixture.h"
+#include "opt/loop_unroller.h"
+
+namespace {
+
+using namespace spvtools;
+
+using HeuristicUnrollTest = PassTest<::testing::Test>;
+
+/*
+Generated from the following GLSL, with |N| being |trip_count| and the loop
+control of the loop being |loop_control|
+
+#version 330 core
+void main() {
+  float x[N];
+  for (int i = 0; i < N; ++i) {
+    x[i] = 1.0f;
+  }
+}
+*/
+std::string GetShader(const std::string& trip_count,
+                      const std::string& loop_control) {
+  return R"(
+               OpCapability Shader
+          %1 = OpExtInstImport "GLSL.std.450"
+               OpMemoryModel Logical GLSL450
+               OpEntryPoint Fragment %main "main"
+               OpExecutionMode %main OriginUpperLeft
+               OpSource GLSL 330
+               OpName %main "main"
+               OpName %x "x"
+       %void = OpTypeVoid
+     %voidfn = OpTypeFunction %void
+        %int = OpTypeInt 32 1
+      %int_0 = OpConstant %int 0
+      %int_1 = OpConstant %int 1
+      %int_n = OpConstant %int )" +
+         trip_count + R"(
+       %bool = OpTypeBool
+      %float = OpTypeFloat 32
+    %float_1 = OpConstant %float 1
+       %uint = OpTypeInt 32 0
+     %uint_n = OpConstant %uint )" +
+         trip_count + R"(
+      %array = OpTypeArray %float %uint_n
+%_ptr_Function_array = OpTypePointer Function %array
+%_ptr_Function_float = OpTypePointer Function %float
+       %main = OpFunction %void None %voidfn
+      %entry = OpLabel
+          %x = OpVariable %_ptr_Function_array Function
+               OpBranch %header
+     %header = OpLabel
+          %i = OpPhi %int %int_0 %entry %i_next %latch
+               OpLoopMerge %merge %latch )" +
+         loop_control + R"(
+               OpBranch %condition
+  %condition = OpLabel
+        %cmp = OpSLessThan %bool %i %int_n
+               OpBranchConditional %cmp %body %merge
+       %body = OpLabel
+      %x_ptr = OpAccessChain %_ptr_Function_float %x %i
+               OpStore %x_ptr %float_1
+               OpBranch %latch
+      %latch = OpLabel
+     %i_next = OpIAdd %int %i %int_1
+               OpBranch %header
+      %merge = OpLabel
+               OpReturn
+               OpFunctionEnd
+)";
+}
+
+TEST_F(HeuristicUnrollTest, FullyUnrollSmallLoop) {
+  opt::LoopUnroller::LoopUnrollStats stats;
+  auto result = SinglePassRunAndDisassemble<opt::LoopUnroller>(
+      GetShader("10", "None"), /* skip_nop = */ true,
+      /* do_validation = */ true, 1000, &stats);
+  EXPECT_EQ(opt::Pass::Status::SuccessWithChange, std::get<1>(result));
+  ASSERT_EQ(1u, stats.loops_.size());
+  EXPECT_EQ(10u, stats.loops_[0].trip_count_);
+  EXPECT_EQ(10u, stats.loops_[0].factor_);
+  EXPECT_TRUE(stats.loops_[0].fully_unrolled_);
+  EXPECT_EQ(std::string::npos, std::get<0>(result).find("OpLoopMerge"));
+}
+
+TEST_F(HeuristicUnrollTest, PartiallyUnrollLargeLoop) {
+  opt::LoopUnroller::LoopUnrollStats stats;
+  auto result = SinglePassRunAndDisassemble<opt::LoopUnroller>(
+      GetShader("1000", "None"), /* skip_nop = */ true,
+      /* do_validation = */ true, 1000, &stats);
+  EXPECT_EQ(opt::Pass::Status::SuccessWithChange, std::get<1>(result));
+  ASSERT_EQ(1u, stats.loops_.size());
+  EXPECT_EQ(1000u, stats.loops_[0].trip_count_);
+  EXPECT_EQ(8u, stats.loops_[0].factor_);
+  EXPECT_FALSE(stats.loops_[0].fully_unrolled_);
+  EXPECT_NE(std::string::npos, std::get<0>(result).find("DontUnroll"));
+}
+
+TEST_F(HeuristicUnrollTest, BudgetLimitsFactor) {
+  // Fully unrolling the loop, or unrolling it by 5, would add more than the
+  // 50 instructions of the budget.
+  opt::LoopUnroller::LoopUnrollStats stats;
+  auto result = SinglePassRunAndDisassemble<opt::LoopUnroller>(
+      GetShader("10", "None"), /* skip_nop = */ true,
+      /* do_validation = */ true, 50, &stats);
+  EXPECT_EQ(opt::Pass::Status::SuccessWithChange, std::get<1>(result));
+  ASSERT_EQ(1u, stats.loops_.size());
+  EXPECT_EQ(2u, stats.loops_[0].factor_);
+  EXPECT_FALSE(stats.loops_[0].fully_unrolled_);
+}
+
+TEST_F(HeuristicUnrollTest, NoBudget) {
+  opt::LoopUnroller::LoopUnrollStats stats;
+  const std::string text = GetShader("10", "None");
+  auto result = SinglePassRunAndDisassemble<opt::LoopUnroller>(
+      text, /* skip_nop = */ true, /* do_validation = */ true, 0, &stats);
+  EXPECT_EQ(opt::Pass::Status::SuccessWithoutChange, std::get<1>(result));
+  ASSERT_EQ(1u, stats.loops_.size());
+  EXPECT_EQ(1u, stats.loops_[0].factor_);
+  EXPECT_FALSE(stats.loops_[0].fully_unrolled_);
+}
+
+TEST_F(HeuristicUnrollTest, KeepDontUnrollLoop) {
+  opt::LoopUnroller::LoopUnrollStats stats;
+  auto result = SinglePassRunAndDisassemble<opt::LoopUnroller>(
+      GetShader("10", "DontUnroll"), /* skip_nop = */ true,
+      /* do_validation = */ true, 1000, &stats);
+  EXPECT_EQ(opt::Pass::Status::SuccessWithoutChange, std::get<1>(result));
+  EXPECT_TRUE(stats.loops_.empty());
+}
+
+// Two sibling loops of 1000 iterations, with the loop controls |control1| and
+// |control2|. The last value of the first induction variable is used after the
+// second loop, so it is live across it.
+std::string GetSiblingLoopsShader(const std::string& control1,
+                                  const std::string& control2) {
+  return R"(
+               OpCapability Shader
+          %1 = OpExtInstImport "GLSL.std.450"
+               OpMemoryModel Logical GLSL450
+               OpEntryPoint Fragment %main "main"
+               OpExecutionMode %main OriginUpperLeft
+               OpSource GLSL 330
+               OpName %main "main"
+               OpName %x "x"
+               OpName %y "y"
+       %void = OpTypeVoid
+     %voidfn = OpTypeFunction %void
+        %int = OpTypeInt 32 1
+      %int_0 = OpConstant %int 0
+      %int_1 = OpConstant %int 1
+   %int_1000 = OpConstant %int 1000
+       %bool = OpTypeBool
+      %float = OpTypeFloat 32
+    %float_1 = OpConstant %float 1
+       %uint = OpTypeInt 32 0
+  %uint_1001 = OpConstant %uint 1001
+      %array = OpTypeArray %float %uint_1001
+%_ptr_Function_array = OpTypePointer Function %array
+%_ptr_Function_float = OpTypePointer Function %float
+       %main = OpFunction %void None %voidfn
+      %entry = OpLabel
+          %x = OpVariable %_ptr_Function_array Function
+          %y = OpVariable %_ptr_Function_array Function
+               OpBranch %header1
+    %header1 = OpLabel
+          %i = OpPhi %int %int_0 %entry %i_next %latch1
+               OpLoopMerge %merge1 %latch1 )" +
+         control1 + R"(
+               OpBranch %condition1
+ %condition1 = OpLabel
+       %cmp1 = OpSLessThan %bool %i %int_1000
+               OpBranchConditional %cmp1 %body1 %merge1
+      %body1 = OpLabel
+      %x_ptr = OpAccessChain %_ptr_Function_float %x %i
+               OpStore %x_ptr %float_1
+               OpBranch %latch1
+     %latch1 = OpLabel
+     %i_next = OpIAdd %int %i %int_1
+               OpBranch %header1
+     %merge1 = OpLabel
+               OpBranch %header2
+    %header2 = OpLabel
+          %j = OpPhi %int %int_0 %merge1 %j_next %latch2
+               OpLoopMerge %merge2 %latch2 )" +
+         control2 + R"(
+               OpBranch %condition2
+ %condition2 = OpLabel
+       %cmp2 = OpSLessThan %bool %j %int_1000
+               OpBranchConditional %cmp2 %body2 %merge2
+      %body2 = OpLabel
+      %y_ptr = OpAccessChain %_ptr_Function_float %y %j
+               OpStore %y_ptr %float_1
+               OpBranch %latch2
+     %latch2 = OpLabel
+     %j_next = OpIAdd %int %j %int_1
+               OpBranch %header2
+     %merge2 = OpLabel
+       %last = OpAccessChain %_ptr_Function_float %x %i
+               OpStore %last %float_1
+               OpReturn
+               OpFunctionEnd
+)";
+}
+
+TEST_F(HeuristicUnrollTest, LivenessIsRebuiltAfterPartialUnroll) {
+  // The pressure of each loop does not depend on whether the other one was
+  // unrolled first. The loops are matched by header, as they are not visited
+  // in the order of the function.
+  std::map<uint32_t, size_t> registers;
+  for (const auto& controls : {std::make_pair("None", "DontUnroll"),
+                               std::make_pair("DontUnroll", "None")}) {
+    opt::LoopUnroller::LoopUnrollStats single_stats;
+    SinglePassRunAndDisassemble<opt::LoopUnroller>(
+        GetSiblingLoopsShader(controls.first, controls.second),
+        /* skip_nop = */ true, /* do_validation = */ true, 1000,
+        &single_stats);
+    ASSERT_EQ(1u, single_stats.loops_.size());
+    registers[single_stats.loops_[0].header_] =
+        single_stats.loops_[0].registers_;
+  }
+  ASSERT_EQ(2u, registers.size());
+
+  opt::LoopUnroller::LoopUnrollStats stats;
+  auto result = SinglePassRunAndDisassemble<opt::LoopUnroller>(
+      GetSiblingLoopsShader("None", "None"), /* skip_nop = */ true,
+      /* do_validation = */ true, 1000, &stats);
+  EXPECT_EQ(opt::Pass::Status::SuccessWithChange, std::get<1>(result));
+  ASSERT_EQ(2u, stats.loops_.size());
+  for (const auto& loop : stats.loops_) {
+    EXPECT_GT(loop.factor_, 1u);
+    EXPECT_FALSE(loop.fully_unrolled_);
+    EXPECT_EQ(registers[loop.header_], loop.registers_) << loop.header_;
+  }
+}
+
+}  // namespace
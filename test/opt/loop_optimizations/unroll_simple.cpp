@@ -32,6 +32,25 @@ using ::testing::UnorderedElementsAre;
 
 using PassClassTest = PassTest<::testing::Test>;
 
+// Checks that the dominator analysis of |f| was kept valid, and matches one
+// built from scratch.
+void ExpectDominatorAnalysisUpToDate(ir::IRContext* context,
+                                     const ir::Function* f) {
+  EXPECT_TRUE(
+      context->AreAnalysesValid(ir::IRContext::kAnalysisDominatorAnalysis));
+  opt::DominatorAnalysis* analysis = context->GetDominatorAnalysis(f);
+  opt::DominatorAnalysis rebuilt;
+  rebuilt.InitializeTree(f);
+  for (const ir::BasicBlock& a : *f) {
+    EXPECT_EQ(rebuilt.ImmediateDominator(&a), analysis->ImmediateDominator(&a))
+        << a.id();
+    for (const ir::BasicBlock& b : *f) {
+      EXPECT_EQ(rebuilt.Dominates(&a, &b), analysis->Dominates(&a, &b))
+          << a.id() << " " << b.id();
+    }
+  }
+}
+
 /*
 Generated from the following GLSL
 #version 330 core
@@ -1421,12 +1440,18 @@ TEST_F(PassClassTest, UnrollNestedLoopsValidateDescriptor) {
     EXPECT_EQ(loop_descriptor.NumLoops(), 1u);
     EXPECT_EQ(outer_loop.GetBlocks().size(), 25u);
     EXPECT_EQ(outer_loop.NumImmediateChildren(), 0u);
+    for (const ir::BasicBlock& bb : *f) {
+      EXPECT_EQ(outer_loop.IsInsideLoop(&bb) ? &outer_loop : nullptr,
+                loop_descriptor[&bb]);
+    }
+    ExpectDominatorAnalysisUpToDate(context.get(), f);
     {
       opt::LoopUtils loop_utils{context.get(), &outer_loop};
       loop_utils.FullyUnroll();
       loop_utils.Finalize();
     }
     EXPECT_EQ(loop_descriptor.NumLoops(), 0u);
+    ExpectDominatorAnalysisUpToDate(context.get(), f);
   }
 
   {  // Test partially unroll
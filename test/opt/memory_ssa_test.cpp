@@ -0,0 +1,201 @@
+// Copyright (c) 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <memory>
+#include <string>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include "opt/build_module.h"
+#include "opt/ir_context.h"
+#include "opt/memory_ssa.h"
+
+namespace {
+
+using namespace spvtools;
+
+const std::string kPredefs = R"(
+OpCapability Shader
+OpMemoryModel Logical GLSL450
+OpEntryPoint Fragment %main "main"
+OpExecutionMode %main OriginUpperLeft
+%void = OpTypeVoid
+%functy = OpTypeFunction %void
+%bool = OpTypeBool
+%true = OpConstantTrue %bool
+%float = OpTypeFloat 32
+%float_1 = OpConstant %float 1
+%float_2 = OpConstant %float 2
+%_ptr_Function_float = OpTypePointer Function %float
+%_ptr_Private_float = OpTypePointer Private %float
+%p = OpVariable %_ptr_Private_float Private
+)";
+
+std::unique_ptr<ir::IRContext> Build(const std::string& text) {
+  return BuildModule(SPV_ENV_UNIVERSAL_1_2, nullptr, kPredefs + text,
+                     SPV_TEXT_TO_BINARY_OPTION_PRESERVE_NUMERIC_IDS);
+}
+
+// Returns the instruction defining |id| in |context|.
+ir::Instruction* Def(ir::IRContext* context, uint32_t id) {
+  return context->get_def_use_mgr()->GetDef(id);
+}
+
+TEST(MemorySSATest, LoadFollowsStore) {
+  const std::string text = R"(
+%main = OpFunction %void None %functy
+%10 = OpLabel
+%11 = OpVariable %_ptr_Function_float Function
+%12 = OpLoad %float %11
+OpStore %11 %float_1
+%13 = OpLoad %float %11
+OpReturn
+OpFunctionEnd
+)";
+  std::unique_ptr<ir::IRContext> context = Build(text);
+  ASSERT_NE(nullptr, context);
+  opt::MemorySSA* memory_ssa =
+      context->GetMemorySSAAnalysis()->Get(&*context->module()->begin());
+
+  opt::MemoryAccess* first_load = memory_ssa->GetAccess(Def(context.get(), 12));
+  opt::MemoryAccess* second_load =
+      memory_ssa->GetAccess(Def(context.get(), 13));
+  ASSERT_NE(nullptr, first_load);
+  ASSERT_NE(nullptr, second_load);
+  EXPECT_TRUE(first_load->IsUse());
+  EXPECT_TRUE(first_load->defining_access()->IsLiveOnEntry());
+
+  opt::MemoryAccess* store = second_load->defining_access();
+  EXPECT_TRUE(store->IsDef());
+  EXPECT_EQ(SpvOpStore, store->instruction()->opcode());
+  EXPECT_EQ(first_load->defining_access(), store->defining_access());
+  EXPECT_TRUE(memory_ssa->IsLocalToFunction(11));
+}
+
+TEST(MemorySSATest, PhiAtMerge) {
+  const std::string text = R"(
+%main = OpFunction %void None %functy
+%10 = OpLabel
+%11 = OpVariable %_ptr_Function_float Function
+OpSelectionMerge %14 None
+OpBranchConditional %true %12 %13
+%12 = OpLabel
+OpStore %11 %float_1
+OpBranch %14
+%13 = OpLabel
+OpStore %11 %float_2
+OpBranch %14
+%14 = OpLabel
+%15 = OpLoad %float %11
+OpReturn
+OpFunctionEnd
+)";
+  std::unique_ptr<ir::IRContext> context = Build(text);
+  ASSERT_NE(nullptr, context);
+  opt::MemorySSA* memory_ssa =
+      context->GetMemorySSAAnalysis()->Get(&*context->module()->begin());
+
+  opt::MemoryAccess* phi =
+      memory_ssa->GetAccess(Def(context.get(), 15))->defining_access();
+  ASSERT_TRUE(phi->IsPhi());
+  EXPECT_EQ(14u, phi->block()->id());
+  ASSERT_EQ(2u, phi->incoming().size());
+  for (const auto& incoming : phi->incoming()) {
+    EXPECT_TRUE(incoming.second->IsDef());
+    EXPECT_EQ(incoming.first, incoming.second->block()->id());
+  }
+  EXPECT_THAT(memory_ssa->GetPhis(phi->block()), ::testing::ElementsAre(phi));
+}
+
+TEST(MemorySSATest, CallClobbersPrivateButNotLocal) {
+  const std::string text = R"(
+%main = OpFunction %void None %functy
+%10 = OpLabel
+%11 = OpVariable %_ptr_Function_float Function
+OpStore %p %float_1
+OpStore %11 %float_2
+%12 = OpFunctionCall %void %callee
+%13 = OpLoad %float %p
+%14 = OpLoad %float %11
+OpReturn
+OpFunctionEnd
+%callee = OpFunction %void None %functy
+%20 = OpLabel
+OpStore %p %float_2
+OpReturn
+OpFunctionEnd
+)";
+  std::unique_ptr<ir::IRContext> context = Build(text);
+  ASSERT_NE(nullptr, context);
+  opt::MemorySSA* memory_ssa =
+      context->GetMemorySSAAnalysis()->Get(&*context->module()->begin());
+
+  opt::MemoryAccess* call = memory_ssa->GetAccess(Def(context.get(), 12));
+  ASSERT_NE(nullptr, call);
+  EXPECT_TRUE(call->IsDef());
+  EXPECT_EQ(opt::MemorySSA::kAllClasses, call->alias_class());
+
+  EXPECT_EQ(call,
+            memory_ssa->GetAccess(Def(context.get(), 13))->defining_access());
+  opt::MemoryAccess* local_store =
+      memory_ssa->GetAccess(Def(context.get(), 14))->defining_access();
+  ASSERT_TRUE(local_store->IsDef());
+  EXPECT_EQ(SpvOpStore, local_store->instruction()->opcode());
+}
+
+TEST(MemorySSATest, AccessChainLocations) {
+  const std::string text = R"(
+%main = OpFunction %void None %functy
+%10 = OpLabel
+%11 = OpVariable %_ptr_Function_arr Function
+%12 = OpAccessChain %_ptr_Function_float %11 %int_0
+%13 = OpAccessChain %_ptr_Function_float %11 %int_1
+%14 = OpAccessChain %_ptr_Function_float %11 %int_0
+%15 = OpAccessChain %_ptr_Function_float %11 %dyn
+OpReturn
+OpFunctionEnd
+)";
+  const std::string types = R"(
+%int = OpTypeInt 32 1
+%int_0 = OpConstant %int 0
+%int_1 = OpConstant %int 1
+%uint = OpTypeInt 32 0
+%uint_4 = OpConstant %uint 4
+%arr = OpTypeArray %float %uint_4
+%_ptr_Function_arr = OpTypePointer Function %arr
+%dyn = OpUndef %int
+)";
+  std::unique_ptr<ir::IRContext> context = Build(types + text);
+  ASSERT_NE(nullptr, context);
+  opt::MemorySSA* memory_ssa =
+      context->GetMemorySSAAnalysis()->Get(&*context->module()->begin());
+
+  const opt::MemoryLocation& zero = memory_ssa->GetLocation(12);
+  const opt::MemoryLocation& one = memory_ssa->GetLocation(13);
+  const opt::MemoryLocation& zero_again = memory_ssa->GetLocation(14);
+  const opt::MemoryLocation& dynamic = memory_ssa->GetLocation(15);
+  const opt::MemoryLocation& whole = memory_ssa->GetLocation(11);
+  EXPECT_EQ(11u, zero.root);
+  EXPECT_EQ(SpvStorageClassFunction, zero.storage_class);
+
+  EXPECT_FALSE(memory_ssa->MayAlias(zero, one));
+  EXPECT_TRUE(memory_ssa->MayAlias(zero, zero_again));
+  EXPECT_TRUE(memory_ssa->Covers(zero, zero_again));
+  EXPECT_TRUE(memory_ssa->MayAlias(zero, dynamic));
+  EXPECT_FALSE(memory_ssa->Covers(dynamic, zero));
+  EXPECT_TRUE(memory_ssa->Covers(whole, dynamic));
+}
+
+}  // anonymous namespace
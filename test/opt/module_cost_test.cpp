@@ -0,0 +1,63 @@
+// Copyright (c) 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <memory>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "opt/build_module.h"
+#include "opt/ir_context.h"
+#include "opt/module_cost.h"
+
+namespace {
+
+using namespace spvtools;
+
+TEST(ModuleCost, WeighsInstructionsInLoops) {
+  const std::string text = R"(
+OpCapability Shader
+OpMemoryModel Logical GLSL450
+OpEntryPoint Fragment %main "main"
+OpExecutionMode %main OriginUpperLeft
+%void = OpTypeVoid
+%fn = OpTypeFunction %void
+%bool = OpTypeBool
+%true = OpConstantTrue %bool
+%main = OpFunction %void None %fn
+%entry = OpLabel
+OpBranch %header
+%header = OpLabel
+OpLoopMerge %merge %continue None
+OpBranchConditional %true %continue %merge
+%continue = OpLabel
+OpBranch %header
+%merge = OpLabel
+OpReturn
+OpFunctionEnd
+)";
+  std::unique_ptr<ir::IRContext> context =
+      BuildModule(SPV_ENV_UNIVERSAL_1_2, nullptr, text);
+  ASSERT_NE(nullptr, context);
+
+  opt::ModuleCost cost = opt::ComputeModuleCost(context.get());
+  EXPECT_EQ(19u, cost.instruction_count);
+  // The 5 instructions of %header and %continue count once per iteration.
+  EXPECT_EQ(4 + 5 * opt::ModuleCost::kLoopIterationEstimate,
+            cost.loop_weighted_instruction_count);
+  EXPECT_EQ(0u, cost.max_register_pressure);
+  EXPECT_EQ(19 + cost.loop_weighted_instruction_count, cost.Score());
+}
+
+}  // anonymous namespace
@@ -21,11 +21,13 @@
 
 namespace {
 
+using spvtools::CreateFreezeSpecConstantValuePass;
 using spvtools::CreateNullPass;
 using spvtools::CreateStripDebugInfoPass;
 using spvtools::Optimizer;
 using spvtools::SpirvTools;
 using ::testing::Eq;
+using ::testing::HasSubstr;
 
 TEST(Optimizer, CanRunNullPassWithDistinctInputOutputVectors) {
   SpirvTools tools(SPV_ENV_UNIVERSAL_1_0);
@@ -106,4 +108,74 @@ TEST(Optimizer, CanRunTransformingPassWithAliasedVectors) {
   EXPECT_THAT(disassembly, Eq("%void = OpTypeVoid\n"));
 }
 
+TEST(Optimizer, RunVariantsSpecializesEachVariant) {
+  SpirvTools tools(SPV_ENV_UNIVERSAL_1_0);
+  std::vector<uint32_t> binary_in;
+  tools.Assemble(
+      "OpCapability Shader\n"
+      "OpMemoryModel Logical GLSL450\n"
+      "OpName %c \"c\"\n"
+      "OpDecorate %c SpecId 0\n"
+      "%int = OpTypeInt 32 1\n"
+      "%c = OpSpecConstant %int 1\n",
+      &binary_in);
+
+  Optimizer opt(SPV_ENV_UNIVERSAL_1_0);
+  opt.RegisterPass(CreateNullPass());
+  std::vector<std::vector<uint32_t>> binaries_out;
+  EXPECT_TRUE(opt.RunVariants(
+      binary_in.data(), binary_in.size(), {{{0, "2"}}, {{0, "3"}}},
+      [](Optimizer* variant_opt) {
+        variant_opt->RegisterPass(CreateFreezeSpecConstantValuePass());
+      },
+      &binaries_out));
+  ASSERT_THAT(binaries_out.size(), Eq(2u));
+
+  std::string disassembly;
+  tools.Disassemble(binaries_out[0], &disassembly);
+  EXPECT_THAT(disassembly, HasSubstr("%c = OpConstant %int 2\n"));
+  tools.Disassemble(binaries_out[1], &disassembly);
+  EXPECT_THAT(disassembly, HasSubstr("%c = OpConstant %int 3\n"));
+}
+
+TEST(Optimizer, RunAutotunedKeepsTheCheapestResult) {
+  SpirvTools tools(SPV_ENV_UNIVERSAL_1_0);
+  std::vector<uint32_t> binary_in;
+  tools.Assemble("OpName %foo \"foo\"\n%foo = OpTypeVoid", &binary_in);
+
+  Optimizer opt(SPV_ENV_UNIVERSAL_1_0);
+  opt.SetNumThreads(2);
+  std::vector<Optimizer::Recipe> recipes = {
+      {"null",
+       [](Optimizer* recipe_opt) {
+         recipe_opt->RegisterPass(CreateNullPass());
+       }},
+      {"strip",
+       [](Optimizer* recipe_opt) {
+         recipe_opt->RegisterPass(CreateStripDebugInfoPass());
+       }}};
+  std::vector<uint32_t> binary_out;
+  std::string winner;
+  std::vector<Optimizer::RecipeReport> report;
+  EXPECT_TRUE(opt.RunAutotuned(
+      binary_in.data(), binary_in.size(), recipes,
+      [](const uint32_t*, size_t binary_size) {
+        return static_cast<double>(binary_size);
+      },
+      &binary_out, &winner, &report));
+
+  EXPECT_THAT(winner, Eq("strip"));
+  ASSERT_THAT(report.size(), Eq(2u));
+  EXPECT_THAT(report[0].name, Eq("null"));
+  EXPECT_TRUE(report[0].succeeded);
+  EXPECT_THAT(report[0].cost, Eq(static_cast<double>(binary_in.size())));
+  EXPECT_THAT(report[1].name, Eq("strip"));
+  EXPECT_TRUE(report[1].succeeded);
+  EXPECT_THAT(report[1].binary_size, Eq(binary_out.size()));
+
+  std::string disassembly;
+  tools.Disassemble(binary_out, &disassembly);
+  EXPECT_THAT(disassembly, Eq("%void = OpTypeVoid\n"));
+}
+
 }  // namespace
@@ -158,6 +158,103 @@ TEST_F(ScalarAnalysisTest, BasicEvolutionTest) {
   EXPECT_EQ(simplified->GetChild(0), simplified->GetChild(1));
 }
 
+// Same shader as BasicEvolutionTest.
+TEST_F(ScalarAnalysisTest, MemoizesUntilLoopIsInvalidated) {
+  const std::string text = R"(
+               OpCapability Shader
+          %1 = OpExtInstImport "GLSL.std.450"
+               OpMemoryModel Logical GLSL450
+               OpEntryPoint Fragment %4 "main" %24
+               OpExecutionMode %4 OriginUpperLeft
+               OpSource GLSL 410
+               OpName %4 "main"
+               OpName %24 "array"
+               OpDecorate %24 Location 1
+          %2 = OpTypeVoid
+          %3 = OpTypeFunction %2
+          %6 = OpTypeInt 32 1
+          %7 = OpTypePointer Function %6
+          %9 = OpConstant %6 0
+         %16 = OpConstant %6 10
+         %17 = OpTypeBool
+         %19 = OpTypeFloat 32
+         %20 = OpTypeInt 32 0
+         %21 = OpConstant %20 10
+         %22 = OpTypeArray %19 %21
+         %23 = OpTypePointer Output %22
+         %24 = OpVariable %23 Output
+         %27 = OpConstant %6 1
+         %29 = OpTypePointer Output %19
+          %4 = OpFunction %2 None %3
+          %5 = OpLabel
+               OpBranch %10
+         %10 = OpLabel
+         %35 = OpPhi %6 %9 %5 %34 %13
+               OpLoopMerge %12 %13 None
+               OpBranch %14
+         %14 = OpLabel
+         %18 = OpSLessThan %17 %35 %16
+               OpBranchConditional %18 %11 %12
+         %11 = OpLabel
+         %28 = OpIAdd %6 %35 %27
+         %30 = OpAccessChain %29 %24 %28
+         %31 = OpLoad %19 %30
+         %32 = OpAccessChain %29 %24 %35
+               OpStore %32 %31
+               OpBranch %13
+         %13 = OpLabel
+         %34 = OpIAdd %6 %35 %27
+               OpBranch %10
+         %12 = OpLabel
+               OpReturn
+               OpFunctionEnd
+  )";
+  // clang-format on
+  std::unique_ptr<ir::IRContext> context =
+      BuildModule(SPV_ENV_UNIVERSAL_1_1, nullptr, text,
+                  SPV_TEXT_TO_BINARY_OPTION_PRESERVE_NUMERIC_IDS);
+  ir::Module* module = context->module();
+  EXPECT_NE(nullptr, module) << "Assembling failed for shader:\n"
+                             << text << std::endl;
+  const ir::Function* f = spvtest::GetFunction(module, 4);
+  ir::LoopDescriptor& ld = *context->GetLoopDescriptor(f);
+  opt::ScalarEvolutionAnalysis analysis{context.get()};
+
+  ir::Instruction* phi = context->get_def_use_mgr()->GetDef(35);
+  ir::Instruction* add = context->get_def_use_mgr()->GetDef(28);
+
+  // The analysis and the simplification of the same instruction give the same
+  // nodes.
+  opt::SENode* node = analysis.AnalyzeInstruction(add);
+  EXPECT_EQ(node, analysis.AnalyzeInstruction(add));
+  opt::SENode* simplified = analysis.SimplifyExpression(node);
+  EXPECT_EQ(simplified, analysis.SimplifyExpression(node));
+  EXPECT_EQ(simplified->GetType(), opt::SENode::RecurrentAddExpr);
+
+  // Step by 10 instead of 1.
+  context->get_def_use_mgr()->GetDef(34)->SetInOperand(1, {16});
+
+  // Only the instructions depending on the loop are analyzed again.
+  opt::SENode* constant = analysis.AnalyzeInstruction(
+      context->get_def_use_mgr()->GetDef(16));
+  const opt::SENode* old_phi_node = analysis.AnalyzeInstruction(phi);
+  analysis.InvalidateLoop(&ld.GetLoopByIndex(0));
+  EXPECT_EQ(constant, analysis.AnalyzeInstruction(
+                          context->get_def_use_mgr()->GetDef(16)));
+
+  const opt::SERecurrentNode* phi_node =
+      analysis.AnalyzeInstruction(phi)->AsSERecurrentNode();
+  ASSERT_NE(phi_node, nullptr);
+  EXPECT_NE(phi_node, old_phi_node);
+  EXPECT_EQ(phi_node->GetCoefficient(), constant);
+  EXPECT_NE(node, analysis.AnalyzeInstruction(add));
+
+  // Changes made through the context discard all the memoized results.
+  opt::SENode* add_node = analysis.AnalyzeInstruction(add);
+  context->ReplaceAllUsesWith(27, 16);
+  EXPECT_NE(add_node, analysis.AnalyzeInstruction(add));
+}
+
 /*
 Generated from the following GLSL + --eliminate-local-multi-store
 
@@ -0,0 +1,486 @@
+// Copyright (c) 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "pass_fixture.h"
+#include "pass_utils.h"
+
+namespace {
+
+using namespace spvtools;
+
+using UniformLoadElimTest = PassTest<::testing::Test>;
+
+const std::string kPredefs =
+    R"(OpCapability Shader
+OpMemoryModel Logical GLSL450
+OpEntryPoint Fragment %main "main" %out
+OpExecutionMode %main OriginUpperLeft
+OpName %main "main"
+OpName %U "U"
+OpName %u "u"
+OpName %B "B"
+OpName %b "b"
+OpName %img "img"
+OpName %simg "simg"
+OpName %t "t"
+OpName %coord "coord"
+OpName %out "out"
+OpMemberDecorate %U 0 Offset 0
+OpMemberDecorate %U 1 Offset 16
+OpDecorate %U Block
+OpDecorate %_arr_float_uint_4 ArrayStride 16
+OpDecorate %_runtimearr_float ArrayStride 4
+OpMemberDecorate %B 0 NonWritable
+OpMemberDecorate %B 0 Offset 0
+OpDecorate %B BufferBlock
+OpDecorate %u DescriptorSet 0
+OpDecorate %u Binding 0
+OpDecorate %b DescriptorSet 0
+OpDecorate %b Binding 1
+OpDecorate %t DescriptorSet 0
+OpDecorate %t Binding 2
+%void = OpTypeVoid
+%14 = OpTypeFunction %void
+%bool = OpTypeBool
+%true = OpConstantTrue %bool
+%int = OpTypeInt 32 1
+%int_0 = OpConstant %int 0
+%int_1 = OpConstant %int 1
+%int_4 = OpConstant %int 4
+%uint = OpTypeInt 32 0
+%uint_4 = OpConstant %uint 4
+%float = OpTypeFloat 32
+%v2float = OpTypeVector %float 2
+%v4float = OpTypeVector %float 4
+%coord = OpConstantNull %v2float
+%_arr_float_uint_4 = OpTypeArray %float %uint_4
+%U = OpTypeStruct %float %_arr_float_uint_4
+%_runtimearr_float = OpTypeRuntimeArray %float
+%B = OpTypeStruct %_runtimearr_float
+%img = OpTypeImage %float 2D 0 0 0 1 Unknown
+%simg = OpTypeSampledImage %img
+%_ptr_Uniform_U = OpTypePointer Uniform %U
+%_ptr_Uniform_B = OpTypePointer Uniform %B
+%_ptr_Uniform_float = OpTypePointer Uniform %float
+%_ptr_UniformConstant_simg = OpTypePointer UniformConstant %simg
+%_ptr_Output_float = OpTypePointer Output %float
+%u = OpVariable %_ptr_Uniform_U Uniform
+%b = OpVariable %_ptr_Uniform_B Uniform
+%t = OpVariable %_ptr_UniformConstant_simg UniformConstant
+%out = OpVariable %_ptr_Output_float Output
+)";
+
+TEST_F(UniformLoadElimTest, CommonAccessChainLoadsInBlock) {
+  // The second load is replaced by the first.  The access chain loads stay
+  // access chain loads, instead of becoming loads of the whole block, which
+  // some drivers failed on (#946).
+  const std::string before =
+      R"(%main = OpFunction %void None %14
+%31 = OpLabel
+%32 = OpAccessChain %_ptr_Uniform_float %u %int_0
+%33 = OpLoad %float %32
+%34 = OpAccessChain %_ptr_Uniform_float %u %int_0
+%35 = OpLoad %float %34
+%36 = OpFAdd %float %33 %35
+OpStore %out %36
+OpReturn
+OpFunctionEnd
+)";
+  const std::string after =
+      R"(%main = OpFunction %void None %14
+%31 = OpLabel
+%32 = OpAccessChain %_ptr_Uniform_float %u %int_0
+%33 = OpLoad %float %32
+%36 = OpFAdd %float %33 %33
+OpStore %out %36
+OpReturn
+OpFunctionEnd
+)";
+
+  SinglePassRunAndCheck<opt::UniformLoadElimPass>(
+      kPredefs + before, kPredefs + after, true, true);
+}
+
+TEST_F(UniformLoadElimTest, HoistLoadsOfBothArms) {
+  // The loads of both arms of the selection are replaced by one load in the
+  // header, placed before the OpSelectionMerge.
+  const std::string before =
+      R"(%main = OpFunction %void None %14
+%31 = OpLabel
+OpSelectionMerge %32 None
+OpBranchConditional %true %33 %34
+%33 = OpLabel
+%35 = OpAccessChain %_ptr_Uniform_float %u %int_0
+%36 = OpLoad %float %35
+OpStore %out %36
+OpBranch %32
+%34 = OpLabel
+%37 = OpAccessChain %_ptr_Uniform_float %u %int_0
+%38 = OpLoad %float %37
+%39 = OpFNegate %float %38
+OpStore %out %39
+OpBranch %32
+%32 = OpLabel
+OpReturn
+OpFunctionEnd
+)";
+  const std::string after =
+      R"(%main = OpFunction %void None %14
+%31 = OpLabel
+%40 = OpAccessChain %_ptr_Uniform_float %u %int_0
+%41 = OpLoad %float %40
+OpSelectionMerge %32 None
+OpBranchConditional %true %33 %34
+%33 = OpLabel
+OpStore %out %41
+OpBranch %32
+%34 = OpLabel
+%39 = OpFNegate %float %41
+OpStore %out %39
+OpBranch %32
+%32 = OpLabel
+OpReturn
+OpFunctionEnd
+)";
+
+  SinglePassRunAndCheck<opt::UniformLoadElimPass>(
+      kPredefs + before, kPredefs + after, true, true);
+}
+
+TEST_F(UniformLoadElimTest, ReuseLoadBeforeLoop) {
+  // The load in the loop is replaced by the load before the loop, which
+  // dominates it.
+  const std::string before =
+      R"(%main = OpFunction %void None %14
+%31 = OpLabel
+%32 = OpAccessChain %_ptr_Uniform_float %u %int_0
+%33 = OpLoad %float %32
+OpStore %out %33
+OpBranch %34
+%34 = OpLabel
+%35 = OpPhi %int %int_0 %31 %36 %37
+%38 = OpSLessThan %bool %35 %int_4
+OpLoopMerge %39 %37 None
+OpBranchConditional %38 %40 %39
+%40 = OpLabel
+%41 = OpAccessChain %_ptr_Uniform_float %u %int_0
+%42 = OpLoad %float %41
+OpStore %out %42
+OpBranch %37
+%37 = OpLabel
+%36 = OpIAdd %int %35 %int_1
+OpBranch %34
+%39 = OpLabel
+OpReturn
+OpFunctionEnd
+)";
+  const std::string after =
+      R"(%main = OpFunction %void None %14
+%31 = OpLabel
+%32 = OpAccessChain %_ptr_Uniform_float %u %int_0
+%33 = OpLoad %float %32
+OpStore %out %33
+OpBranch %34
+%34 = OpLabel
+%35 = OpPhi %int %int_0 %31 %36 %37
+%38 = OpSLessThan %bool %35 %int_4
+OpLoopMerge %39 %37 None
+OpBranchConditional %38 %40 %39
+%40 = OpLabel
+OpStore %out %33
+OpBranch %37
+%37 = OpLabel
+%36 = OpIAdd %int %35 %int_1
+OpBranch %34
+%39 = OpLabel
+OpReturn
+OpFunctionEnd
+)";
+
+  SinglePassRunAndCheck<opt::UniformLoadElimPass>(
+      kPredefs + before, kPredefs + after, true, true);
+}
+
+TEST_F(UniformLoadElimTest, DoNotHoistOutOfLoop) {
+  // The nearest common dominator of the loads is the loop header, which is
+  // not in the loop of the load after the loop, so nothing changes.
+  const std::string text =
+      R"(%main = OpFunction %void None %14
+%31 = OpLabel
+OpBranch %32
+%32 = OpLabel
+%33 = OpPhi %int %int_0 %31 %34 %35
+%36 = OpSLessThan %bool %33 %int_4
+OpLoopMerge %37 %35 None
+OpBranchConditional %36 %38 %37
+%38 = OpLabel
+%39 = OpAccessChain %_ptr_Uniform_float %u %int_0
+%40 = OpLoad %float %39
+OpStore %out %40
+OpBranch %35
+%35 = OpLabel
+%34 = OpIAdd %int %33 %int_1
+OpBranch %32
+%37 = OpLabel
+%41 = OpAccessChain %_ptr_Uniform_float %u %int_0
+%42 = OpLoad %float %41
+OpStore %out %42
+OpReturn
+OpFunctionEnd
+)";
+
+  SinglePassRunAndCheck<opt::UniformLoadElimPass>(
+      kPredefs + text, kPredefs + text, true, true);
+}
+
+TEST_F(UniformLoadElimTest, DynamicIndex) {
+  // Loads with the same dynamic index are commoned in a block, but are not
+  // moved to the header, where the index may be out of bounds.
+  const std::string before =
+      R"(%main = OpFunction %void None %14
+%31 = OpLabel
+%32 = OpAccessChain %_ptr_Uniform_float %u %int_0
+%33 = OpLoad %float %32
+%34 = OpConvertFToS %int %33
+OpSelectionMerge %35 None
+OpBranchConditional %true %36 %37
+%36 = OpLabel
+%38 = OpAccessChain %_ptr_Uniform_float %u %int_1 %34
+%39 = OpLoad %float %38
+%40 = OpAccessChain %_ptr_Uniform_float %u %int_1 %34
+%41 = OpLoad %float %40
+%42 = OpFAdd %float %39 %41
+OpStore %out %42
+OpBranch %35
+%37 = OpLabel
+%43 = OpAccessChain %_ptr_Uniform_float %u %int_1 %34
+%44 = OpLoad %float %43
+OpStore %out %44
+OpBranch %35
+%35 = OpLabel
+OpReturn
+OpFunctionEnd
+)";
+  const std::string after =
+      R"(%main = OpFunction %void None %14
+%31 = OpLabel
+%32 = OpAccessChain %_ptr_Uniform_float %u %int_0
+%33 = OpLoad %float %32
+%34 = OpConvertFToS %int %33
+OpSelectionMerge %35 None
+OpBranchConditional %true %36 %37
+%36 = OpLabel
+%38 = OpAccessChain %_ptr_Uniform_float %u %int_1 %34
+%39 = OpLoad %float %38
+%42 = OpFAdd %float %39 %39
+OpStore %out %42
+OpBranch %35
+%37 = OpLabel
+%43 = OpAccessChain %_ptr_Uniform_float %u %int_1 %34
+%44 = OpLoad %float %43
+OpStore %out %44
+OpBranch %35
+%35 = OpLabel
+OpReturn
+OpFunctionEnd
+)";
+
+  SinglePassRunAndCheck<opt::UniformLoadElimPass>(
+      kPredefs + before, kPredefs + after, true, true);
+}
+
+TEST_F(UniformLoadElimTest, ReadOnlyBufferRuntimeArray) {
+  // Loads of a readonly buffer are commoned, but a constant index into a
+  // runtime array may be out of bounds, so the loads are not moved to the
+  // header.
+  const std::string before =
+      R"(%main = OpFunction %void None %14
+%31 = OpLabel
+OpSelectionMerge %32 None
+OpBranchConditional %true %33 %34
+%33 = OpLabel
+%35 = OpAccessChain %_ptr_Uniform_float %b %int_0 %int_4
+%36 = OpLoad %float %35
+%37 = OpAccessChain %_ptr_Uniform_float %b %int_0 %int_4
+%38 = OpLoad %float %37
+%39 = OpFAdd %float %36 %38
+OpStore %out %39
+OpBranch %32
+%34 = OpLabel
+%40 = OpAccessChain %_ptr_Uniform_float %b %int_0 %int_4
+%41 = OpLoad %float %40
+OpStore %out %41
+OpBranch %32
+%32 = OpLabel
+OpReturn
+OpFunctionEnd
+)";
+  const std::string after =
+      R"(%main = OpFunction %void None %14
+%31 = OpLabel
+OpSelectionMerge %32 None
+OpBranchConditional %true %33 %34
+%33 = OpLabel
+%35 = OpAccessChain %_ptr_Uniform_float %b %int_0 %int_4
+%36 = OpLoad %float %35
+%39 = OpFAdd %float %36 %36
+OpStore %out %39
+OpBranch %32
+%34 = OpLabel
+%40 = OpAccessChain %_ptr_Uniform_float %b %int_0 %int_4
+%41 = OpLoad %float %40
+OpStore %out %41
+OpBranch %32
+%32 = OpLabel
+OpReturn
+OpFunctionEnd
+)";
+
+  SinglePassRunAndCheck<opt::UniformLoadElimPass>(
+      kPredefs + before, kPredefs + after, true, true);
+}
+
+TEST_F(UniformLoadElimTest, SampledImageOnlyInBlock) {
+  // Loads of a sampled image are only replaced by a load in the same block.
+  const std::string before =
+      R"(%main = OpFunction %void None %14
+%31 = OpLabel
+%32 = OpLoad %simg %t
+%33 = OpImageSampleImplicitLod %v4float %32 %coord
+%34 = OpLoad %simg %t
+%35 = OpImageSampleImplicitLod %v4float %34 %coord
+%36 = OpCompositeExtract %float %35 0
+OpStore %out %36
+OpBranch %37
+%37 = OpLabel
+%38 = OpLoad %simg %t
+%39 = OpImageSampleImplicitLod %v4float %38 %coord
+%40 = OpCompositeExtract %float %39 0
+OpStore %out %40
+OpReturn
+OpFunctionEnd
+)";
+  const std::string after =
+      R"(%main = OpFunction %void None %14
+%31 = OpLabel
+%32 = OpLoad %simg %t
+%33 = OpImageSampleImplicitLod %v4float %32 %coord
+%35 = OpImageSampleImplicitLod %v4float %32 %coord
+%36 = OpCompositeExtract %float %35 0
+OpStore %out %36
+OpBranch %37
+%37 = OpLabel
+%38 = OpLoad %simg %t
+%39 = OpImageSampleImplicitLod %v4float %38 %coord
+%40 = OpCompositeExtract %float %39 0
+OpStore %out %40
+OpReturn
+OpFunctionEnd
+)";
+
+  SinglePassRunAndCheck<opt::UniformLoadElimPass>(
+      kPredefs + before, kPredefs + after, true, true);
+}
+
+TEST_F(UniformLoadElimTest, CoherentBuffer) {
+  // Other invocations may write a coherent buffer, even a readonly one, so
+  // its loads are not commoned.
+  std::string predefs = kPredefs;
+  const std::string non_writable = "OpMemberDecorate %B 0 NonWritable\n";
+  predefs.insert(predefs.find(non_writable) + non_writable.size(),
+                 "OpMemberDecorate %B 0 Coherent\n");
+  const std::string text =
+      R"(%main = OpFunction %void None %14
+%31 = OpLabel
+%32 = OpAccessChain %_ptr_Uniform_float %b %int_0 %int_4
+%33 = OpLoad %float %32
+%34 = OpAccessChain %_ptr_Uniform_float %b %int_0 %int_4
+%35 = OpLoad %float %34
+%36 = OpFAdd %float %33 %35
+OpStore %out %36
+OpReturn
+OpFunctionEnd
+)";
+
+  SinglePassRunAndCheck<opt::UniformLoadElimPass>(
+      predefs + text, predefs + text, true, true);
+}
+
+TEST_F(UniformLoadElimTest, BufferLoadsSplitAtBarrier) {
+  // A barrier may make writes of other invocations to the buffer visible, so
+  // the load after the barrier is kept, and only replaces the later one.
+  const std::string before =
+      R"(%main = OpFunction %void None %14
+%31 = OpLabel
+%32 = OpAccessChain %_ptr_Uniform_float %b %int_0 %int_4
+%33 = OpLoad %float %32
+OpMemoryBarrier %int_1 %int_0
+%34 = OpAccessChain %_ptr_Uniform_float %b %int_0 %int_4
+%35 = OpLoad %float %34
+%36 = OpAccessChain %_ptr_Uniform_float %b %int_0 %int_4
+%37 = OpLoad %float %36
+%38 = OpFAdd %float %33 %35
+%39 = OpFAdd %float %38 %37
+OpStore %out %39
+OpReturn
+OpFunctionEnd
+)";
+  const std::string after =
+      R"(%main = OpFunction %void None %14
+%31 = OpLabel
+%32 = OpAccessChain %_ptr_Uniform_float %b %int_0 %int_4
+%33 = OpLoad %float %32
+OpMemoryBarrier %int_1 %int_0
+%34 = OpAccessChain %_ptr_Uniform_float %b %int_0 %int_4
+%35 = OpLoad %float %34
+%38 = OpFAdd %float %33 %35
+%39 = OpFAdd %float %38 %35
+OpStore %out %39
+OpReturn
+OpFunctionEnd
+)";
+
+  SinglePassRunAndCheck<opt::UniformLoadElimPass>(
+      kPredefs + before, kPredefs + after, true, true);
+}
+
+TEST_F(UniformLoadElimTest, OutOfBoundsConstantIndex) {
+  // The array of the block has 4 elements, so the loads may read outside of
+  // the block, and are not moved to the header.
+  const std::string text =
+      R"(%main = OpFunction %void None %14
+%31 = OpLabel
+OpSelectionMerge %32 None
+OpBranchConditional %true %33 %34
+%33 = OpLabel
+%35 = OpAccessChain %_ptr_Uniform_float %u %int_1 %int_4
+%36 = OpLoad %float %35
+OpStore %out %36
+OpBranch %32
+%34 = OpLabel
+%37 = OpAccessChain %_ptr_Uniform_float %u %int_1 %int_4
+%38 = OpLoad %float %37
+%39 = OpFNegate %float %38
+OpStore %out %39
+OpBranch %32
+%32 = OpLabel
+OpReturn
+OpFunctionEnd
+)";
+
+  SinglePassRunAndCheck<opt::UniformLoadElimPass>(
+      kPredefs + text, kPredefs + text, true, true);
+}
+
+}  // anonymous namespace
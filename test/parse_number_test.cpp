@@ -163,6 +163,40 @@ TEST(ParseWideUnsignedIntegers, Sample) {
   EXPECT_FALSE(ParseNumber("-1", &u64));
 }
 
+TEST(ParseIntegers, Prefixes) {
+  int32_t i32;
+  uint64_t u64;
+
+  // Octal values.
+  EXPECT_TRUE(ParseNumber("017", &i32));
+  EXPECT_EQ(15, i32);
+  EXPECT_FALSE(ParseNumber("08", &i32));
+
+  // Upper case hex values.
+  EXPECT_TRUE(ParseNumber("0XAbC", &i32));
+  EXPECT_EQ(0xabc, i32);
+  EXPECT_TRUE(ParseNumber("-0x80000000", &i32));
+  EXPECT_EQ(std::numeric_limits<int32_t>::min(), i32);
+  EXPECT_FALSE(ParseNumber("0x80000000", &i32));
+
+  // A prefix needs digits.
+  EXPECT_FALSE(ParseNumber("0x", &u64));
+  EXPECT_FALSE(ParseNumber("-", &u64));
+  EXPECT_FALSE(ParseNumber("+", &u64));
+  EXPECT_TRUE(ParseNumber("+7", &u64));
+  EXPECT_EQ(7u, u64);
+
+  // Leading whitespace is skipped, but not trailing whitespace.
+  EXPECT_TRUE(ParseNumber(" \t42", &u64));
+  EXPECT_EQ(42u, u64);
+  EXPECT_FALSE(ParseNumber("42 ", &u64));
+  EXPECT_FALSE(ParseNumber(" ", &u64));
+
+  // Overflows even when the value wraps around to a small number.
+  EXPECT_FALSE(ParseNumber("18446744073709551617", &u64));
+  EXPECT_FALSE(ParseNumber("0x10000000000000001", &u64));
+}
+
 TEST(ParseFloat, Sample) {
   float f;
 
@@ -250,6 +284,22 @@ TEST(ParseDouble, Overflow) {
   EXPECT_FALSE(ParseNumber("-1e400", &f));
 }
 
+TEST(ParseHexFloat, Sample) {
+  spvutils::HexFloat<spvutils::FloatProxy<float>> f(0.0f);
+  EXPECT_TRUE(ParseNumber("0x1.8p+1", &f));
+  EXPECT_EQ(3.0f, f.value().getAsFloat());
+  EXPECT_TRUE(ParseNumber("-0x1p-149", &f));
+  EXPECT_EQ(0x80000001u, f.value().data());
+  EXPECT_FALSE(ParseNumber("0x1.8", &f));
+  EXPECT_FALSE(ParseNumber("0x1p1 ", &f));
+
+  spvutils::HexFloat<spvutils::FloatProxy<double>> d(0.0);
+  EXPECT_TRUE(ParseNumber("0x1.0000000000001p+0", &d));
+  EXPECT_EQ(0x3ff0000000000001u, d.value().data());
+  EXPECT_TRUE(ParseNumber("1e-320", &d));
+  EXPECT_EQ(1e-320, d.value().getAsFloat());
+}
+
 TEST(ParseFloat16, Overflow) {
   // The assembler parses using HexFloat<FloatProxy<Float16>>.  Make
   // sure that succeeds for in-range values, and fails for out of
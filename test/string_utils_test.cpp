@@ -12,6 +12,9 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <cstdint>
+#include <limits>
+#include <sstream>
 #include <string>
 
 #include "gtest/gtest.h"
@@ -39,6 +42,20 @@ TEST(ToString, Uint) {
   EXPECT_EQ("1000", ToString(1000ULL));
 }
 
+TEST(ToString, NarrowInt) {
+  EXPECT_EQ("-32768", ToString(int16_t(-32768)));
+  EXPECT_EQ("65535", ToString(uint16_t(65535)));
+  EXPECT_EQ("1", ToString(true));
+  EXPECT_EQ("a", ToString('a'));
+}
+
+TEST(ToString, WideInt) {
+  EXPECT_EQ("-9223372036854775808",
+            ToString(std::numeric_limits<int64_t>::min()));
+  EXPECT_EQ("18446744073709551615",
+            ToString(std::numeric_limits<uint64_t>::max()));
+}
+
 TEST(ToString, Float) {
   EXPECT_EQ("0", ToString(0.f));
   EXPECT_EQ("1000", ToString(1000.f));
@@ -51,6 +68,23 @@ TEST(ToString, Double) {
   EXPECT_EQ("-1.5", ToString(-1.5));
 }
 
+TEST(AppendFloat, Precision) {
+  std::string str;
+  spvutils::AppendFloat(0.1, 17, &str);
+  EXPECT_EQ("0.10000000000000001", str);
+  str.clear();
+  spvutils::AppendFloat(1e-5, 6, &str);
+  EXPECT_EQ("1e-05", str);
+
+  // Does not fit in a small buffer.
+  str.clear();
+  spvutils::AppendFloat(-1e-300, 100, &str);
+  std::ostringstream stream;
+  stream.precision(100);
+  stream << -1e-300;
+  EXPECT_EQ(stream.str(), str);
+}
+
 TEST(CardinalToOrdinal, Test) {
   EXPECT_EQ("1st", CardinalToOrdinal(1));
   EXPECT_EQ("2nd", CardinalToOrdinal(2));
@@ -128,4 +128,30 @@ TEST(TextAdvance, SkipOverCRLFs) {
   EXPECT_EQ(2u, pos.line);
   EXPECT_EQ(4u, pos.index);
 }
+
+TEST(TextAdvance, SkipOverLongIndentation) {
+  // Longer than the chunks of spaces skipped at once.
+  const auto pos = PositionAfterAdvance("\n                   \t  Word");
+  EXPECT_EQ(22u, pos.column);
+  EXPECT_EQ(1u, pos.line);
+  EXPECT_EQ(23u, pos.index);
+}
+
+TEST(TextAdvance, SkipOverSpacesAtEndOfText) {
+  std::string input = "           |padding beyond the end";
+  spv_text_t text = {input.data(), 11};
+  AssemblyContext data(&text, nullptr);
+  ASSERT_EQ(SPV_END_OF_STREAM, data.advance());
+  EXPECT_EQ(11u, data.position().index);
+  EXPECT_EQ(11u, data.position().column);
+}
+
+TEST(TextAdvance, NullTerminatorInCommentLine) {
+  std::string input("; comment\0\nWord", 15);
+  spv_text_t text = {input.data(), input.size()};
+  AssemblyContext data(&text, nullptr);
+  ASSERT_EQ(SPV_END_OF_STREAM, data.advance());
+  EXPECT_EQ(9u, data.position().index);
+  EXPECT_EQ(0u, data.position().line);
+}
 }  // anonymous namespace
@@ -0,0 +1,151 @@
+// Copyright (c) 2018 Google LLC.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "gmock/gmock.h"
+
+#include "util/dominators.h"
+
+namespace {
+
+using spvutils::Dominators;
+using ::testing::ElementsAre;
+using Edges = std::vector<std::pair<uint32_t, uint32_t>>;
+
+// Returns true if |target| can be reached from |root| in the graph of
+// |num_nodes| nodes and |edges| without going through |removed|.
+bool ReachableWithout(uint32_t num_nodes, const Edges& edges, uint32_t root,
+                      uint32_t removed, uint32_t target) {
+  if (root == removed) return false;
+  std::vector<bool> seen(num_nodes, false);
+  std::vector<uint32_t> work_list = {root};
+  seen[root] = true;
+  while (!work_list.empty()) {
+    const uint32_t node = work_list.back();
+    work_list.pop_back();
+    if (node == target) return true;
+    for (const auto& edge : edges) {
+      if (edge.first == node && edge.second != removed && !seen[edge.second]) {
+        seen[edge.second] = true;
+        work_list.push_back(edge.second);
+      }
+    }
+  }
+  return false;
+}
+
+TEST(DominatorsTest, Diamond) {
+  // 0 -> 1, 2 -> 3
+  const Edges edges = {{0, 1}, {0, 2}, {1, 3}, {2, 3}};
+  const Dominators dominators(4, edges, 0);
+  EXPECT_EQ(Dominators::kNone, dominators.immediate_dominator(0));
+  EXPECT_EQ(0u, dominators.immediate_dominator(1));
+  EXPECT_EQ(0u, dominators.immediate_dominator(2));
+  EXPECT_EQ(0u, dominators.immediate_dominator(3));
+  EXPECT_THAT(dominators.children(0), ElementsAre(1u, 2u, 3u));
+  EXPECT_TRUE(dominators.Dominates(0, 3));
+  EXPECT_TRUE(dominators.Dominates(3, 3));
+  EXPECT_FALSE(dominators.Dominates(1, 3));
+  EXPECT_THAT(dominators.preorder(), ElementsAre(0u, 1u, 3u, 2u));
+  EXPECT_THAT(dominators.postorder(), ElementsAre(3u, 1u, 2u, 0u));
+}
+
+TEST(DominatorsTest, PostDominators) {
+  // 0 -> 1, 2 -> 3, where 3 is the exit.
+  const Edges edges = {{0, 1}, {0, 2}, {1, 3}, {2, 3}};
+  const Dominators post_dominators(4, edges, 3, true);
+  EXPECT_EQ(3u, post_dominators.root());
+  EXPECT_EQ(3u, post_dominators.immediate_dominator(0));
+  EXPECT_EQ(3u, post_dominators.immediate_dominator(1));
+  EXPECT_TRUE(post_dominators.Dominates(3, 0));
+  EXPECT_FALSE(post_dominators.Dominates(1, 0));
+}
+
+TEST(DominatorsTest, UnreachableNodes) {
+  const Edges edges = {{0, 1}, {2, 1}, {3, 3}};
+  const Dominators dominators(4, edges, 0);
+  EXPECT_TRUE(dominators.reachable(1));
+  EXPECT_FALSE(dominators.reachable(2));
+  EXPECT_FALSE(dominators.reachable(3));
+  EXPECT_EQ(0u, dominators.immediate_dominator(1));
+  EXPECT_EQ(Dominators::kNone, dominators.immediate_dominator(2));
+  EXPECT_FALSE(dominators.Dominates(2, 2));
+  EXPECT_FALSE(dominators.Dominates(0, 2));
+  EXPECT_EQ(0u, dominators.tree_preorder_number(3));
+}
+
+TEST(DominatorsTest, IrreducibleLoop) {
+  // Both 1 and 2 enter the cycle 1 <-> 2, so neither dominates the other.
+  const Edges edges = {{0, 1}, {0, 2}, {1, 2}, {2, 1}, {2, 3}};
+  const Dominators dominators(4, edges, 0);
+  EXPECT_EQ(0u, dominators.immediate_dominator(1));
+  EXPECT_EQ(0u, dominators.immediate_dominator(2));
+  EXPECT_EQ(2u, dominators.immediate_dominator(3));
+}
+
+TEST(DominatorsTest, MatchesDefinitionOnRandomGraphs) {
+  std::mt19937 random(42);
+  for (int graph = 0; graph < 500; ++graph) {
+    const uint32_t num_nodes = 1 + random() % 10;
+    Edges edges;
+    for (uint32_t i = random() % 25; i > 0; --i)
+      edges.emplace_back(random() % num_nodes, random() % num_nodes);
+    const uint32_t root = random() % num_nodes;
+    const Dominators dominators(num_nodes, edges, root);
+
+    for (uint32_t a = 0; a < num_nodes; ++a) {
+      const bool reachable =
+          ReachableWithout(num_nodes, edges, root, num_nodes, a);
+      ASSERT_EQ(reachable, dominators.reachable(a));
+      for (uint32_t b = 0; b < num_nodes; ++b) {
+        const bool dominates =
+            reachable &&
+            ReachableWithout(num_nodes, edges, root, num_nodes, b) &&
+            (a == b || !ReachableWithout(num_nodes, edges, root, a, b));
+        ASSERT_EQ(dominates, dominators.Dominates(a, b))
+            << "graph " << graph << ": " << a << " dominates " << b;
+      }
+    }
+  }
+}
+
+// A chain of diamonds, each closing a loop, like the control flow of a fully
+// unrolled loop.  The dominators of such deep graphs are quick to compute.
+TEST(DominatorsTest, DeepUnrolledLoop) {
+  const uint32_t kNumDiamonds = 20000;
+  const uint32_t num_nodes = 3 * kNumDiamonds + 1;
+  Edges edges;
+  for (uint32_t header = 0; header + 3 < num_nodes; header += 3) {
+    edges.emplace_back(header, header + 1);
+    edges.emplace_back(header, header + 2);
+    edges.emplace_back(header + 1, header + 3);
+    edges.emplace_back(header + 2, header + 3);
+    edges.emplace_back(header + 2, header);
+  }
+  const Dominators dominators(num_nodes, edges, 0);
+  const Dominators post_dominators(num_nodes, edges, num_nodes - 1, true);
+  for (uint32_t header = 0; header + 3 < num_nodes; header += 3) {
+    ASSERT_EQ(header, dominators.immediate_dominator(header + 1));
+    ASSERT_EQ(header, dominators.immediate_dominator(header + 3));
+    ASSERT_EQ(header + 3, post_dominators.immediate_dominator(header + 1));
+  }
+  EXPECT_TRUE(dominators.Dominates(0, num_nodes - 1));
+  EXPECT_TRUE(post_dominators.Dominates(num_nodes - 1, 0));
+  EXPECT_EQ(num_nodes, dominators.postorder().size());
+}
+
+}  // anonymous namespace
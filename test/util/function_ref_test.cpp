@@ -0,0 +1,83 @@
+// Copyright (c) 2018 Google LLC.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <functional>
+#include <string>
+
+#include "gmock/gmock.h"
+
+#include "util/function_ref.h"
+
+namespace {
+
+using spvutils::FunctionRef;
+
+int Apply(FunctionRef<int(int)> f, int value) { return f(value); }
+
+TEST(FunctionRefTest, CallsLambda) {
+  int offset = 3;
+  EXPECT_EQ(5, Apply([offset](int x) { return x + offset; }, 2));
+}
+
+TEST(FunctionRefTest, CallsStdFunction) {
+  const std::function<int(int)> twice = [](int x) { return 2 * x; };
+  EXPECT_EQ(8, Apply(twice, 4));
+}
+
+TEST(FunctionRefTest, RefersToTheCallable) {
+  int calls = 0;
+  auto count = [&calls](int) { return ++calls; };
+  FunctionRef<int(int)> ref = count;
+  ref(0);
+  ref(0);
+  EXPECT_EQ(2, calls);
+}
+
+TEST(FunctionRefTest, CopiesReferToTheSameCallable) {
+  int calls = 0;
+  auto count = [&calls](int) { return ++calls; };
+  FunctionRef<int(int)> ref = count;
+  FunctionRef<int(int)> copy = ref;
+  copy(0);
+  EXPECT_EQ(1, calls);
+}
+
+TEST(FunctionRefTest, IgnoresTheResultForVoid) {
+  std::string text;
+  auto append_and_measure = [&text](const char* s) {
+    text += s;
+    return text.size();
+  };
+  FunctionRef<void(const char*)> append = append_and_measure;
+  append("ab");
+  append("c");
+  EXPECT_EQ("abc", text);
+}
+
+// The overloads mimic visitors with a const and a non-const version, which
+// must be told apart by the parameter type of the callback.
+struct Visitor {
+  std::string Visit(FunctionRef<void(int*)>) { return "non-const"; }
+  std::string Visit(FunctionRef<void(const int*)>) const { return "const"; }
+};
+
+TEST(FunctionRefTest, SelectsOverloadLikeStdFunction) {
+  Visitor visitor;
+  const Visitor& const_visitor = visitor;
+  EXPECT_EQ("non-const", visitor.Visit([](int*) {}));
+  EXPECT_EQ("non-const", visitor.Visit([](const int*) {}));
+  EXPECT_EQ("const", const_visitor.Visit([](const int*) {}));
+}
+
+}  // anonymous namespace
@@ -14,7 +14,11 @@
 
 // Basic tests for the ValidationState_t datastructure.
 
+#include <algorithm>
+#include <functional>
+#include <sstream>
 #include <string>
+#include <vector>
 
 #include "gmock/gmock.h"
 #include "spirv_validator_options.h"
@@ -104,6 +108,34 @@ TEST_F(ValidationStateTest, CheckEntryPoints) {
             vstate_->FindDef(vstate_->entry_points()[0])->opcode());
 }
 
+// Tests that the instructions in ValidationState refer to the words of the
+// module instead of copying them.
+TEST_F(ValidationStateTest, CheckInstructionsReferToTheModule) {
+  CompileSuccessfully(string(header) + string(kVoidFVoid));
+  EXPECT_EQ(SPV_SUCCESS, ValidateAndRetrieveValidationState());
+  const uint32_t* begin = get_const_binary()->code;
+  const uint32_t* end = begin + get_const_binary()->wordCount;
+  for (const auto& inst : vstate_->ordered_instructions()) {
+    EXPECT_LE(begin, inst.words().data());
+    EXPECT_GE(end, inst.words().data() + inst.words().size());
+  }
+}
+
+// Tests that the uses of an id in ValidationState are in module order.
+TEST_F(ValidationStateTest, CheckUses) {
+  CompileSuccessfully(string(header) + string(kVoidFVoid));
+  EXPECT_EQ(SPV_SUCCESS, ValidateAndRetrieveValidationState());
+  // %void is used by %void_f and %func.
+  const auto uses = vstate_->FindDef(1)->uses();
+  ASSERT_EQ(2u, uses.size());
+  EXPECT_EQ(2u, uses[0].first->id());
+  EXPECT_EQ(2u, uses[0].second);
+  EXPECT_EQ(3u, uses[1].first->id());
+  EXPECT_EQ(1u, uses[1].second);
+  // %func is not used.
+  EXPECT_TRUE(vstate_->FindDef(3)->uses().empty());
+}
+
 TEST_F(ValidationStateTest, CheckStructMemberLimitOption) {
   spvValidatorOptionsSetUniversalLimit(
       options_, spv_validator_limit_max_struct_members, 32000u);
@@ -152,4 +184,105 @@ TEST_F(ValidationStateTest, CheckAccessChainIndexesLimitOption) {
   EXPECT_EQ(100u, options_->universal_limits_.max_access_chain_indexes);
 }
 
+TEST_F(ValidationStateTest, CheckNumThreadsOption) {
+  EXPECT_EQ(1u, options_->num_threads);
+  spvValidatorOptionsSetNumThreads(options_, 4u);
+  EXPECT_EQ(4u, options_->num_threads);
+  spvValidatorOptionsSetNumThreads(options_, 0u);
+  EXPECT_EQ(1u, options_->num_threads);
+}
+
+// Returns a module with |count| functions.  The body of the function at index
+// i is |bad_body|(suffix) if i is in |bad|, and a plain return otherwise,
+// where suffix makes the ids of the body unique.
+string ModuleWithFunctions(
+    size_t count, const std::vector<size_t>& bad,
+    const std::function<string(const string&)>& bad_body) {
+  string spirv = string(header) + R"(
+   %void = OpTypeVoid
+ %void_f = OpTypeFunction %void
+   %bool = OpTypeBool
+   %true = OpConstantTrue %bool
+    %int = OpTypeInt 32 0
+  %int_1 = OpConstant %int 1
+)";
+  for (size_t i = 0; i < count; ++i) {
+    const string suffix = "_" + std::to_string(i);
+    spirv += "%func" + suffix + " = OpFunction %void None %void_f\n";
+    if (std::find(bad.begin(), bad.end(), i) != bad.end()) {
+      spirv += bad_body(suffix);
+    } else {
+      spirv += "%entry" + suffix + " = OpLabel\nOpReturn\n";
+    }
+    spirv += "OpFunctionEnd\n";
+  }
+  return spirv;
+}
+
+// Validates |spirv| on one thread, then on several threads, and checks that
+// the results and the diagnostics are the same.  Returns the diagnostic.
+string ValidateOnOneAndSeveralThreads(ValidationStateTest* test,
+                                      const string& spirv) {
+  test->CompileSuccessfully(spirv);
+  const spv_result_t serial_result = test->ValidateInstructions();
+  const string serial_diagnostic = test->getDiagnosticString();
+  const size_t serial_index = test->getErrorPosition().index;
+  EXPECT_NE(SPV_SUCCESS, serial_result);
+
+  spvDiagnosticDestroy(test->diagnostic_);
+  test->diagnostic_ = nullptr;
+  spvValidatorOptionsSetNumThreads(test->options_, 4u);
+  EXPECT_EQ(serial_result, test->ValidateInstructions());
+  EXPECT_EQ(serial_diagnostic, test->getDiagnosticString());
+  EXPECT_EQ(serial_index, test->getErrorPosition().index);
+  return serial_diagnostic;
+}
+
+TEST_F(ValidationStateTest, ThreadedCfgChecksReportFirstFunction) {
+  const auto body = [](const string& s) {
+    return "%entry" + s + " = OpLabel\nOpBranch %b" + s + "\n%c" + s +
+           " = OpLabel\nOpReturn\n%b" + s + " = OpLabel\nOpBranch %c" + s +
+           "\n";
+  };
+  const string spirv = ModuleWithFunctions(16, {5, 9}, body);
+  EXPECT_THAT(ValidateOnOneAndSeveralThreads(this, spirv),
+              HasSubstr("appears in the binary before its dominator"));
+}
+
+TEST_F(ValidationStateTest, ThreadedDominanceChecksReportSameError) {
+  const auto body = [](const string& s) {
+    return "%entry" + s + " = OpLabel\nOpSelectionMerge %m" + s +
+           " None\nOpBranchConditional %true %a" + s + " %m" + s + "\n%a" +
+           s + " = OpLabel\n%v" + s + " = OpIAdd %int %int_1 %int_1\n" +
+           "OpBranch %m" + s + "\n%m" + s + " = OpLabel\n%w" + s +
+           " = OpIAdd %int %v" + s + " %int_1\nOpReturn\n";
+  };
+  const string spirv = ModuleWithFunctions(16, {5, 9}, body);
+  EXPECT_THAT(ValidateOnOneAndSeveralThreads(this, spirv),
+              HasSubstr("does not dominate its use"));
+}
+
+TEST_F(ValidationStateTest, ThreadedIdChecksReportFirstFunction) {
+  const auto body = [](const string& s) {
+    return "%entry" + s + " = OpLabel\n%x" + s +
+           " = OpLoad %int %int_1\nOpReturn\n";
+  };
+  const string spirv = ModuleWithFunctions(16, {5, 9}, body);
+  EXPECT_THAT(ValidateOnOneAndSeveralThreads(this, spirv),
+              HasSubstr("is not a logical pointer"));
+}
+
+TEST_F(ValidationStateTest, TimeReportListsInstructionChecks) {
+  const auto body = [](const string& s) {
+    return "%entry" + s + " = OpLabel\nOpReturn\n";
+  };
+  std::stringstream report;
+  options_->time_report_stream = &report;
+  CompileSuccessfully(ModuleWithFunctions(3, {}, body));
+  EXPECT_EQ(SPV_SUCCESS, ValidateInstructions());
+  EXPECT_THAT(report.str(), HasSubstr("functions: 3, blocks: 3"));
+  EXPECT_THAT(report.str(), HasSubstr("ImagePass"));
+  EXPECT_THAT(report.str(), HasSubstr("ExtInstPass"));
+}
+
 }  // anonymous namespace
@@ -12,7 +12,9 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <chrono>
 #include <cstdio>
+#include <cstdlib>
 #include <cstring>
 #include <vector>
 
@@ -44,6 +46,10 @@ Options:
   --target-env {vulkan1.0|vulkan1.1|spv1.0|spv1.1|spv1.2|spv1.3}
                   Use Vulkan 1.0, Vulkan 1.1, SPIR-V 1.0, SPIR-V 1.1,
                   SPIR-V 1.2, or SPIR-V 1.3
+  --benchmark <count>
+                  Assemble the input <count> more times and print the
+                  assembly throughput, in MB of text per second, to
+                  standard error.
 )",
       argv0, argv0);
 }
@@ -54,6 +60,7 @@ int main(int argc, char** argv) {
   const char* inFile = nullptr;
   const char* outFile = nullptr;
   uint32_t options = 0;
+  int benchmark_iterations = 0;
   spv_target_env target_env = kDefaultEnvironment;
   for (int argi = 1; argi < argc; ++argi) {
     if ('-' == argv[argi][0]) {
@@ -103,6 +110,15 @@ int main(int argc, char** argv) {
               fprintf(stderr, "error: Missing argument to --target-env\n");
               return 1;
             }
+          } else if (0 == strcmp(argv[argi], "--benchmark")) {
+            if (argi + 1 < argc && atoi(argv[argi + 1]) > 0) {
+              benchmark_iterations = atoi(argv[++argi]);
+            } else {
+              fprintf(stderr,
+                      "error: --benchmark expects a positive iteration "
+                      "count\n");
+              return 1;
+            }
           } else {
             fprintf(stderr, "error: Unrecognized option: %s\n\n", argv[argi]);
             print_usage(argv[0]);
@@ -136,13 +152,31 @@ int main(int argc, char** argv) {
   spv_context context = spvContextCreate(target_env);
   spv_result_t error = spvTextToBinaryWithOptions(
       context, contents.data(), contents.size(), options, &binary, &diagnostic);
-  spvContextDestroy(context);
   if (error) {
+    spvContextDestroy(context);
     spvDiagnosticPrint(diagnostic);
     spvDiagnosticDestroy(diagnostic);
     return error;
   }
 
+  if (benchmark_iterations > 0) {
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < benchmark_iterations; ++i) {
+      spv_binary timed_binary = nullptr;
+      spvTextToBinaryWithOptions(context, contents.data(), contents.size(),
+                                 options, &timed_binary, nullptr);
+      spvBinaryDestroy(timed_binary);
+    }
+    const std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+    const double megabytes =
+        double(contents.size()) * benchmark_iterations / (1024.0 * 1024.0);
+    fprintf(stderr, "%d iterations of %zu bytes: %.3f s, %.2f MB/s\n",
+            benchmark_iterations, contents.size(), elapsed.count(),
+            megabytes / elapsed.count());
+  }
+  spvContextDestroy(context);
+
   if (!WriteFile<uint32_t>(outFile, "wb", binary->code, binary->wordCount)) {
     spvBinaryDestroy(binary);
     return 1;
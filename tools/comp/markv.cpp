@@ -14,11 +14,14 @@
 
 #include <algorithm>
 #include <cassert>
+#include <chrono>
 #include <cstdio>
+#include <cstdlib>
 #include <cstring>
 #include <functional>
 #include <iostream>
 #include <memory>
+#include <string>
 #include <vector>
 
 #include "markv_model_factory.h"
@@ -37,8 +40,14 @@ enum Task {
   kEncode,
   kDecode,
   kTest,
+  kBenchmark,
+  kPack,
+  kUnpack,
 };
 
+// Number of times each codec configuration runs in the benchmark task.
+const int kBenchmarkIterations = 10;
+
 struct ScopedContext {
   ScopedContext(spv_target_env env) : context(spvContextCreate(env)) {}
   ~ScopedContext() { spvContextDestroy(context); }
@@ -49,7 +58,7 @@ void print_usage(char* argv0) {
   printf(
       R"(%s - Encodes or decodes a SPIR-V binary to or from a MARK-V binary.
 
-USAGE: %s [e|d|t] [options] [<filename>]
+USAGE: %s [e|d|t|b|p|u] [options] [<filename>...]
 
 The input binary is read from <filename>. If no file is specified,
 or if the filename is "-", then the binary is read from standard input.
@@ -66,12 +75,27 @@ Tasks:
   d               Decode MARK-V to SPIR-V.
   t               Test the codec by first encoding the given SPIR-V file to
                   MARK-V, then decoding it back to SPIR-V and comparing results.
+  b               Benchmark the codec by encoding the given SPIR-V file to
+                  MARK-V and decoding it back, with and without
+                  --trusted-input, and checking both produce the same MARK-V.
+  p               Pack the given SPIR-V files into a MARK-V container.
+  u               Unpack SPIR-V files from the given MARK-V container, each
+                  entry to <output><entry-index>.spv.
 
 Options:
   -h, --help      Print this help.
   --comments      Write codec comments to stderr.
   --version       Display MARK-V codec version.
   --validate      Validate SPIR-V while encoding or decoding.
+  --trusted-input Assume the SPIR-V is valid and only keep the type and
+                  function definitions needed by the model. Faster, produces
+                  the same MARK-V. Overrides --validate.
+  --entries=<index>[,<index>...]
+                  Entries to unpack from the container ('u' task only).
+                  Default: all entries.
+  --threads=<count>
+                  Number of entries decoded concurrently ('u' task only).
+                  Default: 1
   --model=<model-name>
                   Compression model, possible values:
                   shader_lite - fast, poor compression ratio
@@ -83,6 +107,7 @@ Options:
                   Output goes to standard output if this option is
                   not specified, or if the filename is "-".
                   Not needed for 't' task (testing).
+                  Required for 'u' task, as the prefix of the output files.
 )",
       argv0, argv0);
 }
@@ -113,6 +138,8 @@ void DiagnosticsMessageHandler(spv_message_level_t level, const char*,
 int main(int argc, char** argv) {
   const char* input_filename = nullptr;
   const char* output_filename = nullptr;
+  // All the input files, only the 'p' task accepts more than one.
+  std::vector<const char*> input_filenames;
 
   Task task = kNoTask;
 
@@ -128,6 +155,12 @@ int main(int argc, char** argv) {
     task = kDecode;
   } else if (0 == strcmp("t", task_char)) {
     task = kTest;
+  } else if (0 == strcmp("b", task_char)) {
+    task = kBenchmark;
+  } else if (0 == strcmp("p", task_char)) {
+    task = kPack;
+  } else if (0 == strcmp("u", task_char)) {
+    task = kUnpack;
   }
 
   if (task == kNoTask) {
@@ -137,6 +170,10 @@ int main(int argc, char** argv) {
 
   bool want_comments = false;
   bool validate_spirv_binary = false;
+  bool trusted_input = false;
+  std::vector<uint32_t> entry_indices;
+  bool all_entries = true;
+  uint32_t num_threads = 1;
 
   spvtools::MarkvModelType model_type = spvtools::kMarkvModelUnknown;
 
@@ -148,7 +185,8 @@ int main(int argc, char** argv) {
           return 0;
         case 'o': {
           if (!output_filename && argi + 1 < argc &&
-              (task == kEncode || task == kDecode)) {
+              (task == kEncode || task == kDecode || task == kPack ||
+               task == kUnpack)) {
             output_filename = argv[++argi];
           } else {
             print_usage(argv[0]);
@@ -166,6 +204,33 @@ int main(int argc, char** argv) {
             return 1;
           } else if (0 == strcmp(argv[argi], "--validate")) {
             validate_spirv_binary = true;
+          } else if (0 == strcmp(argv[argi], "--trusted-input")) {
+            trusted_input = true;
+          } else if (0 == strncmp(argv[argi], "--entries=", 10)) {
+            all_entries = false;
+            std::string list = argv[argi] + 10;
+            size_t begin = 0;
+            while (begin <= list.size()) {
+              const size_t end = std::min(list.find(',', begin), list.size());
+              const std::string index = list.substr(begin, end - begin);
+              if (index.empty() ||
+                  index.find_first_not_of("0123456789") != std::string::npos) {
+                fprintf(stderr, "error: Invalid entry index '%s'\n",
+                        index.c_str());
+                return 1;
+              }
+              entry_indices.push_back(
+                  static_cast<uint32_t>(std::stoul(index)));
+              begin = end + 1;
+            }
+          } else if (0 == strncmp(argv[argi], "--threads=", 10)) {
+            const int count = atoi(argv[argi] + 10);
+            if (count <= 0) {
+              fprintf(stderr, "error: Invalid number of threads '%s'\n",
+                      argv[argi] + 10);
+              return 1;
+            }
+            num_threads = static_cast<uint32_t>(count);
           } else if (0 == strcmp(argv[argi], "--model=shader_lite")) {
             if (model_type != spvtools::kMarkvModelUnknown)
               fprintf(stderr, "error: More than one model specified\n");
@@ -185,8 +250,9 @@ int main(int argc, char** argv) {
         } break;
         case '\0': {
           // Setting a filename of "-" to indicate stdin.
-          if (!input_filename) {
+          if (!input_filename || task == kPack) {
             input_filename = argv[argi];
+            input_filenames.push_back(input_filename);
           } else {
             fprintf(stderr, "error: More than one input file specified\n");
             return 1;
@@ -197,8 +263,9 @@ int main(int argc, char** argv) {
           return 1;
       }
     } else {
-      if (!input_filename) {
+      if (!input_filename || task == kPack) {
         input_filename = argv[argi];
+        input_filenames.push_back(input_filename);
       } else {
         fprintf(stderr, "error: More than one input file specified\n");
         return 1;
@@ -224,6 +291,7 @@ int main(int argc, char** argv) {
 
   spvtools::MarkvCodecOptions options;
   options.validate_spirv_binary = validate_spirv_binary;
+  options.trusted_input = trusted_input;
 
   if (task == kEncode) {
     if (!ReadFile<uint32_t>(input_filename, "rb", &spirv)) return 1;
@@ -376,6 +444,138 @@ int main(int argc, char** argv) {
     assert(std::mismatch(std::next(spirv_before.begin(), 5), spirv_before.end(),
                          std::next(spirv_after.begin(), 5)) ==
            std::make_pair(spirv_before.end(), spirv_after.end()));
+  } else if (task == kBenchmark) {
+    if (!ReadFile<uint32_t>(input_filename, "rb", &spirv)) return 1;
+    assert(!spirv.empty());
+
+    // Runs the encoder and the decoder kBenchmarkIterations times with
+    // |trusted|. Returns the elapsed seconds, or a negative value on failure.
+    const auto run = [&](bool trusted, std::vector<uint8_t>* encoded) {
+      spvtools::MarkvCodecOptions run_options = options;
+      run_options.trusted_input = trusted;
+      const auto start = std::chrono::steady_clock::now();
+      for (int i = 0; i < kBenchmarkIterations; ++i) {
+        std::vector<uint32_t> decoded;
+        if (SPV_SUCCESS != spvtools::SpirvToMarkv(
+                               ctx.context, spirv, run_options, *model,
+                               DiagnosticsMessageHandler, no_comments,
+                               spvtools::MarkvDebugConsumer(), encoded) ||
+            SPV_SUCCESS != spvtools::MarkvToSpirv(
+                               ctx.context, *encoded, run_options, *model,
+                               DiagnosticsMessageHandler, no_comments,
+                               spvtools::MarkvDebugConsumer(), &decoded)) {
+          return -1.0;
+        }
+      }
+      const std::chrono::duration<double> elapsed =
+          std::chrono::steady_clock::now() - start;
+      return elapsed.count();
+    };
+
+    std::vector<uint8_t> trusted_markv;
+    const double default_seconds = run(false, &markv);
+    const double trusted_seconds = run(true, &trusted_markv);
+    if (default_seconds < 0 || trusted_seconds < 0) {
+      std::cerr << "error: Failed to encode or decode " << input_filename
+                << std::endl;
+      return 1;
+    }
+
+    if (markv != trusted_markv) {
+      std::cerr << "error: Trusted input mode changed the MARK-V binary of "
+                << input_filename << std::endl;
+      return 1;
+    }
+
+    printf("%d encode/decode rounds of %zu words (%zu MARK-V bytes)\n",
+           kBenchmarkIterations, spirv.size(), markv.size());
+    printf("  default:       %.3f s\n", default_seconds);
+    printf("  trusted input: %.3f s\n", trusted_seconds);
+  } else if (task == kPack) {
+    std::vector<std::vector<uint32_t>> spirv_modules;
+    for (const char* filename : input_filenames) {
+      spirv_modules.emplace_back();
+      if (!ReadFile<uint32_t>(filename, "rb", &spirv_modules.back())) return 1;
+    }
+
+    if (SPV_SUCCESS != spvtools::SpirvToMarkvContainer(
+                           ctx.context, spirv_modules, options, *model,
+                           DiagnosticsMessageHandler, &markv)) {
+      std::cerr << "error: Failed to pack MARK-V container" << std::endl;
+      return 1;
+    }
+
+    if (!WriteFile<uint8_t>(output_filename, "wb", markv.data(), markv.size()))
+      return 1;
+  } else if (task == kUnpack) {
+    if (!output_filename) {
+      std::cerr << "error: Output prefix (-o) required to unpack" << std::endl;
+      return 1;
+    }
+
+    if (!ReadFile<uint8_t>(input_filename, "rb", &markv)) return 1;
+
+    std::vector<spvtools::MarkvContainerEntry> entries;
+    if (SPV_SUCCESS != spvtools::ReadMarkvContainerIndex(
+                           markv.data(), markv.size(),
+                           DiagnosticsMessageHandler, &entries)) {
+      return 1;
+    }
+
+    if (all_entries) {
+      for (uint32_t i = 0; i < entries.size(); ++i) entry_indices.push_back(i);
+    }
+
+    std::vector<std::vector<uint32_t>> storage(entry_indices.size());
+    std::vector<spvtools::MarkvSpirvBuffer> buffers(entry_indices.size());
+    for (size_t i = 0; i < entry_indices.size(); ++i) {
+      if (entry_indices[i] >= entries.size()) {
+        std::cerr << "error: " << input_filename << " has no entry "
+                  << entry_indices[i] << std::endl;
+        return 1;
+      }
+      storage[i].resize(entries[entry_indices[i]].spirv_num_words);
+      buffers[i].words = storage[i].data();
+      buffers[i].capacity = storage[i].size();
+    }
+
+    // Models are created up front, the provider is called from several
+    // threads.
+    std::vector<std::unique_ptr<spvtools::MarkvModel>> models;
+    for (spvtools::MarkvModelType type :
+         {spvtools::kMarkvModelShaderLite, spvtools::kMarkvModelShaderMid,
+          spvtools::kMarkvModelShaderMax}) {
+      models.push_back(spvtools::CreateMarkvModel(type));
+    }
+    const auto model_provider =
+        [&models](uint32_t model_id) -> const spvtools::MarkvModel* {
+      for (const auto& candidate : models) {
+        if (candidate->model_type() == model_id >> 16 &&
+            candidate->model_version() == (model_id & 0xFFFF)) {
+          return candidate.get();
+        }
+      }
+      return nullptr;
+    };
+
+    const spv_result_t result = spvtools::MarkvContainerToSpirv(
+        ctx.context, markv.data(), markv.size(), entry_indices, options,
+        model_provider, DiagnosticsMessageHandler, num_threads, &buffers);
+
+    for (size_t i = 0; i < entry_indices.size(); ++i) {
+      if (buffers[i].result != SPV_SUCCESS) continue;
+      const std::string filename = std::string(output_filename) +
+                                   std::to_string(entry_indices[i]) + ".spv";
+      if (!WriteFile<uint32_t>(filename.c_str(), "wb", buffers[i].words,
+                               buffers[i].num_words)) {
+        return 1;
+      }
+    }
+
+    if (result != SPV_SUCCESS) {
+      std::cerr << "error: Failed to unpack " << input_filename << std::endl;
+      return 1;
+    }
   }
 
   return 0;
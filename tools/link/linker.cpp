@@ -38,6 +38,7 @@ Options:
   --create-library        Link the binaries into a library, keeping all exported symbols.
   --allow-partial-linkage Allow partial linkage by accepting imported symbols to be unresolved.
   --verify-ids            Verify that IDs in the resulting modules are truly unique.
+  --dedup-functions       Replace functions which are identical up to their IDs with a single copy.
   --version               Display linker version information
   --target-env            {vulkan1.0|spv1.0|spv1.1|spv1.2|opencl2.1|opencl2.2}
                           Use Vulkan1.0/SPIR-V1.0/SPIR-V1.1/SPIR-V1.2/OpenCL-2.1/OpenCL2.2 validation rules.
@@ -74,6 +75,8 @@ int main(int argc, char** argv) {
         options.SetCreateLibrary(true);
       } else if (0 == strcmp(cur_arg, "--verify-ids")) {
         options.SetVerifyIds(true);
+      } else if (0 == strcmp(cur_arg, "--dedup-functions")) {
+        options.SetDedupFunctions(true);
       } else if (0 == strcmp(cur_arg, "--allow-partial-linkage")) {
         options.SetAllowPartialLinkage(true);
       } else if (0 == strcmp(cur_arg, "--version")) {
@@ -15,11 +15,13 @@
 #include <spirv_validator_options.h>
 #include <algorithm>
 #include <cassert>
+#include <cstdlib>
 #include <cstring>
 #include <fstream>
 #include <iostream>
 #include <memory>
 #include <sstream>
+#include <string>
 #include <vector>
 
 #include "opt/loop_peeling.h"
@@ -84,6 +86,19 @@ standard output.
 NOTE: The optimizer is a work in progress.
 
 Options (in lexicographical order):
+  --autotune
+               Try each of -O, -Os and -Ochange-driven on its own copy of the
+               module, and keep the result that the built-in cost model finds
+               cheapest.  The cost model adds up the instruction count, the
+               instruction count weighted by loop depth, and the maximum
+               register pressure.  The other flags apply once, before the
+               candidates.  The candidates run in parallel (see --threads).
+               A report comparing them is printed to standard error output.
+  --autotune-config=<file>
+               Add the sequence of transformations in <file> to the candidates
+               tried by autotuning, as with -Oconfig=<file>, and enable
+               autotuning.  Without --autotune, only the configuration files
+               are tried.  May be given several times.
   --ccp
                Apply the conditional constant propagation transform.  This will
                propagate constant values throughout the program, and simplify
@@ -94,6 +109,11 @@ Options (in lexicographical order):
                Cleanup the control flow graph. This will remove any unnecessary
                code from the CFG like unreachable code. Performed on entry
                point call tree functions and exported functions.
+  --code-sink
+               Moves instructions closer to their uses, and recomputes cheap
+               values where they are used, in the functions whose estimated
+               register pressure is above the threshold given as an additional
+               integer argument.
   --compact-ids
                Remap result ids to a compact range starting from %%1 and without
                any gaps.
@@ -107,12 +127,23 @@ Options (in lexicographical order):
                Does propagation of memory references when an array is a copy of
                another.  It will only propagate an array if the source is never
                written to, and the only store to the target is the copy.
+  --dedup-functions
+               Replaces functions that are identical up to their ids with a
+               single copy. Entry points and functions with linkage attributes
+               are kept.
   --eliminate-common-uniform
                Perform load/load elimination for duplicate uniform values.
                Converts any constant index access chain uniform loads into
                its equivalent load and extract. Some loads will be moved
                to facilitate sharing. Performed only on entry point
                call tree functions.
+  --eliminate-uniform-loads
+               Replace loads of uniform, push constant and read-only buffer
+               memory by identical loads that dominate them. Identical loads
+               in sibling blocks are merged into one load in their common
+               dominator, but never moved out of a loop. Unlike
+               --eliminate-common-uniform, access chain loads are kept as
+               such. Performed on all functions.
   --eliminate-dead-branches
                Convert conditional branches with constant condition to the
                indicated unconditional brranch. Delete all resulting dead
@@ -149,6 +180,12 @@ Options (in lexicographical order):
                only stored once. Performed on variables referenceed only with
                loads and stores. Performed only on entry point call tree
                functions.
+  --eliminate-redundant-loads-stores
+               Replace loads with the value stored or loaded before from the
+               same memory, and remove stores whose value is never read.
+               Works on function, private and workgroup storage, including
+               variables accessed through access chains with dynamic indices,
+               and on loads from read-only memory. Performed on all functions.
   --flatten-decorations
                Replace decoration groups with repeated OpDecorate and
                OpMemberDecorate instructions.
@@ -161,6 +198,15 @@ Options (in lexicographical order):
                values.
   --if-conversion
                Convert if-then-else like assignments into OpSelect.
+  --inline-entry-points-budgeted
+               Inline function calls in entry point call tree functions,
+               processing callees before their callers. Takes an additional
+               integer argument setting the maximum number of instructions
+               inlining may add to the module. Calls with opaque arguments or
+               results are always inlined, and count against the budget too.
+               Dead code is removed from callees before they are inlined, and
+               functions no longer called are removed. The resulting change
+               in module size is reported as an info message.
   --inline-entry-points-exhaustive
                Exhaustively inline all function calls in entry point call tree
                functions. Currently does not inline calls to functions with
@@ -176,12 +222,27 @@ Options (in lexicographical order):
   --local-redundancy-elimination
                Looks for instructions in the same basic block that compute the
                same value, and deletes the redundant ones.
+  --loop-fission
+               Splits loops whose estimated register pressure is above the
+               threshold given as an additional integer argument into loops
+               executing part of the stores each, when it is legal and lowers
+               the register pressure.
+  --loop-fusion
+               Fuses adjacent loops iterating over the same range when it is
+               legal. Takes an additional integer argument setting the maximum
+               estimated number of registers the fused loop may use.
   --loop-unroll
                Fully unrolls loops marked with the Unroll flag
   --loop-unroll-partial
                Partially unrolls loops marked with the Unroll flag. Takes an
                additional non-0 integer argument to set the unroll factor, or
                how many times a loop body should be duplicated
+  --loop-unroll-heuristic
+               Fully or partially unrolls loops, unless they are marked with
+               the DontUnroll flag, when their number of iterations is known
+               and the unrolled loop is small enough. Takes an additional
+               integer argument setting the maximum number of instructions
+               unrolling may add to the module.
   --loop-peeling
                Execute few first (respectively last) iterations before
                (respectively after) the loop if it can elide some branches.
@@ -227,6 +288,11 @@ Options (in lexicographical order):
 
                NOTE: The specific transformations done by -O and -Os change
                      from release to release.
+  -Ochange-driven
+               Optimize for performance like -O, with change tracking enabled
+               (see --track-changes).  Groups of cleanup passes are repeated
+               until they stop changing the module, instead of a fixed number
+               of times.
   -Oconfig=<file>
                Apply the sequence of transformations indicated in <file>.
                This file contains a sequence of strings separated by whitespace
@@ -303,6 +369,10 @@ Options (in lexicographical order):
   --strip-reflect
                Remove all reflection information.  For now, this covers
                reflection information defined by SPV_GOOGLE_hlsl_functionality1.
+  --threads
+               Takes an additional positive integer argument setting the number
+               of threads used to read the module and to write it back.  The
+               output does not depend on it.  The default is 1.
   --time-report
                Print the resource utilization of each pass (e.g., CPU time,
                RSS) to standard error output. Currently it supports only Unix
@@ -310,6 +380,10 @@ Options (in lexicographical order):
                prints CPU/WALL/USR/SYS time (and RSS if possible), but note that
                USR/SYS time are returned by getrusage() and can have a small
                error.
+  --track-changes
+               Record which functions each pass changes.  Passes that support
+               it skip the functions they have already processed without
+               effect, if the functions have not changed since.
   --vector-dce
                This pass looks for components of vectors that are unused, and
                removes them from the vector.  Note this would still leave around
@@ -365,7 +439,8 @@ bool ReadFlagsFromFile(const char* oconfig_flag,
 
 OptStatus ParseFlags(int argc, const char** argv, Optimizer* optimizer,
                      const char** in_file, const char** out_file,
-                     spv_validator_options options, bool* skip_validator);
+                     spv_validator_options options, bool* skip_validator,
+                     std::vector<std::string>* autotune_recipes);
 
 // Parses and handles the -Oconfig flag. |prog_name| contains the name of
 // the spirv-opt binary (used to build a new argv vector for the recursive
@@ -400,7 +475,7 @@ OptStatus ParseOconfigFlag(const char* prog_name, const char* opt_flag,
 
   bool skip_validator = false;
   return ParseFlags(static_cast<int>(flags.size()), new_argv, optimizer,
-                    in_file, out_file, nullptr, &skip_validator);
+                    in_file, out_file, nullptr, &skip_validator, nullptr);
 }
 
 OptStatus ParseLoopUnrollPartialArg(int argc, const char** argv, int argi,
@@ -418,6 +493,89 @@ OptStatus ParseLoopUnrollPartialArg(int argc, const char** argv, int argi,
   return {OPT_STOP, 1};
 }
 
+OptStatus ParseInlineBudgetArg(int argc, const char** argv, int argi,
+                                Optimizer* optimizer) {
+  if (argi < argc) {
+    char* end = nullptr;
+    const long budget = strtol(argv[argi], &end, 10);
+    if (end != argv[argi] && *end == '\0' && budget >= 0) {
+      optimizer->RegisterPass(
+          CreateInlineBudgetedPass(static_cast<size_t>(budget)));
+      return {OPT_CONTINUE, 0};
+    }
+  }
+  fprintf(stderr,
+          "error: --inline-entry-points-budgeted must be followed by a "
+          "non-negative integer\n");
+  return {OPT_STOP, 1};
+}
+
+OptStatus ParseLoopFissionArg(int argc, const char** argv, int argi,
+                              Optimizer* optimizer) {
+  if (argi < argc) {
+    char* end = nullptr;
+    const long threshold = strtol(argv[argi], &end, 10);
+    if (end != argv[argi] && *end == '\0' && threshold >= 0) {
+      optimizer->RegisterPass(
+          CreateLoopFissionPass(static_cast<size_t>(threshold)));
+      return {OPT_CONTINUE, 0};
+    }
+  }
+  fprintf(stderr,
+          "error: --loop-fission must be followed by a non-negative "
+          "integer\n");
+  return {OPT_STOP, 1};
+}
+
+OptStatus ParseLoopFusionArg(int argc, const char** argv, int argi,
+                             Optimizer* optimizer) {
+  if (argi < argc) {
+    char* end = nullptr;
+    const long max_registers = strtol(argv[argi], &end, 10);
+    if (end != argv[argi] && *end == '\0' && max_registers >= 0) {
+      optimizer->RegisterPass(
+          CreateLoopFusionPass(static_cast<size_t>(max_registers)));
+      return {OPT_CONTINUE, 0};
+    }
+  }
+  fprintf(stderr,
+          "error: --loop-fusion must be followed by a non-negative integer\n");
+  return {OPT_STOP, 1};
+}
+
+OptStatus ParseCodeSinkArg(int argc, const char** argv, int argi,
+                           Optimizer* optimizer) {
+  if (argi < argc) {
+    char* end = nullptr;
+    const long threshold = strtol(argv[argi], &end, 10);
+    if (end != argv[argi] && *end == '\0' && threshold >= 0) {
+      optimizer->RegisterPass(
+          CreateCodeSinkingPass(static_cast<size_t>(threshold)));
+      return {OPT_CONTINUE, 0};
+    }
+  }
+  fprintf(stderr,
+          "error: --code-sink must be followed by a non-negative integer\n");
+  return {OPT_STOP, 1};
+}
+
+OptStatus ParseLoopUnrollHeuristicArg(int argc, const char** argv, int argi,
+                                      Optimizer* optimizer) {
+  if (argi < argc) {
+    char* end = nullptr;
+    const long size_budget = strtol(argv[argi], &end, 10);
+    if (end != argv[argi] && *end == '\0' && size_budget >= 0) {
+      optimizer->RegisterPass(
+          CreateHeuristicLoopUnrollPass(static_cast<size_t>(size_budget)));
+      return {OPT_CONTINUE, 0};
+    }
+  }
+  fprintf(stderr,
+          "error: --loop-unroll-heuristic must be followed by a non-negative "
+          "integer\n");
+  return {OPT_STOP, 1};
+}
+
 OptStatus ParseLoopPeelingThresholdArg(int argc, const char** argv, int argi) {
   if (argi < argc) {
     int factor = atoi(argv[argi]);
@@ -432,17 +590,53 @@ OptStatus ParseLoopPeelingThresholdArg(int argc, const char** argv, int argi) {
   return {OPT_STOP, 1};
 }
 
+OptStatus ParseThreadsArg(int argc, const char** argv, int argi,
+                          Optimizer* optimizer) {
+  if (argi < argc) {
+    char* end = nullptr;
+    const long num_threads = strtol(argv[argi], &end, 10);
+    if (end != argv[argi] && *end == '\0' && num_threads > 0 &&
+        num_threads <= 1024) {
+      optimizer->SetNumThreads(static_cast<uint32_t>(num_threads));
+      return {OPT_CONTINUE, 0};
+    }
+  }
+  fprintf(stderr,
+          "error: --threads must be followed by an integer between 1 and "
+          "1024\n");
+  return {OPT_STOP, 1};
+}
+
+// Handles the --autotune-config=FILENAME flag |autotune_flag|.  The file is
+// checked by parsing it like -Oconfig=FILENAME, and the equivalent -Oconfig
+// flag is added to |autotune_recipes|.  |prog_name|, |in_file| and |out_file|
+// are as in ParseOconfigFlag.
+OptStatus ParseAutotuneConfigFlag(const char* prog_name,
+                                  const char* autotune_flag,
+                                  const char** in_file, const char** out_file,
+                                  std::vector<std::string>* autotune_recipes) {
+  const std::string oconfig_flag =
+      std::string("-Oconfig=") + (strchr(autotune_flag, '=') + 1);
+  Optimizer unused_optimizer(kDefaultEnvironment);
+  OptStatus status = ParseOconfigFlag(prog_name, oconfig_flag.c_str(),
+                                      &unused_optimizer, in_file, out_file);
+  if (status.action == OPT_CONTINUE) autotune_recipes->push_back(oconfig_flag);
+  return status;
+}
+
 // Parses command-line flags. |argc| contains the number of command-line flags.
 // |argv| points to an array of strings holding the flags. |optimizer| is the
 // Optimizer instance used to optimize the program.
 //
 // On return, this function stores the name of the input program in |in_file|.
-// The name of the output file in |out_file|. The return value indicates whether
-// optimization should continue and a status code indicating an error or
-// success.
+// The name of the output file in |out_file|. The flags of the candidate
+// recipes of autotuning are added to |autotune_recipes|, which is null inside
+// configuration files. The return value indicates whether optimization should
+// continue and a status code indicating an error or success.
 OptStatus ParseFlags(int argc, const char** argv, Optimizer* optimizer,
                      const char** in_file, const char** out_file,
-                     spv_validator_options options, bool* skip_validator) {
+                     spv_validator_options options, bool* skip_validator,
+                     std::vector<std::string>* autotune_recipes) {
   for (int argi = 1; argi < argc; ++argi) {
     const char* cur_arg = argv[argi];
     if ('-' == cur_arg[0]) {
@@ -491,6 +685,11 @@ OptStatus ParseFlags(int argc, const char** argv, Optimizer* optimizer,
         optimizer->RegisterPass(CreateInlineExhaustivePass());
       } else if (0 == strcmp(cur_arg, "--inline-entry-points-opaque")) {
         optimizer->RegisterPass(CreateInlineOpaquePass());
+      } else if (0 == strcmp(cur_arg, "--inline-entry-points-budgeted")) {
+        OptStatus status = ParseInlineBudgetArg(argc, argv, ++argi, optimizer);
+        if (status.action != OPT_CONTINUE) {
+          return status;
+        }
       } else if (0 == strcmp(cur_arg, "--convert-local-access-chains")) {
         optimizer->RegisterPass(CreateLocalAccessChainConvertPass());
       } else if (0 == strcmp(cur_arg, "--eliminate-dead-code-aggressive")) {
@@ -501,6 +700,8 @@ OptStatus ParseFlags(int argc, const char** argv, Optimizer* optimizer,
         optimizer->RegisterPass(CreateLocalSingleBlockLoadStoreElimPass());
       } else if (0 == strcmp(cur_arg, "--eliminate-local-single-store")) {
         optimizer->RegisterPass(CreateLocalSingleStoreElimPass());
+      } else if (0 == strcmp(cur_arg, "--eliminate-redundant-loads-stores")) {
+        optimizer->RegisterPass(CreateLoadStoreElimPass());
       } else if (0 == strcmp(cur_arg, "--merge-blocks")) {
         optimizer->RegisterPass(CreateBlockMergePass());
       } else if (0 == strcmp(cur_arg, "--merge-return")) {
@@ -513,6 +714,8 @@ OptStatus ParseFlags(int argc, const char** argv, Optimizer* optimizer,
         optimizer->RegisterPass(CreateLocalMultiStoreElimPass());
       } else if (0 == strcmp(cur_arg, "--eliminate-common-uniform")) {
         optimizer->RegisterPass(CreateCommonUniformElimPass());
+      } else if (0 == strcmp(cur_arg, "--eliminate-uniform-loads")) {
+        optimizer->RegisterPass(CreateUniformLoadElimPass());
       } else if (0 == strcmp(cur_arg, "--eliminate-dead-const")) {
         optimizer->RegisterPass(CreateEliminateDeadConstantPass());
       } else if (0 == strcmp(cur_arg, "--eliminate-dead-inserts")) {
@@ -533,6 +736,8 @@ OptStatus ParseFlags(int argc, const char** argv, Optimizer* optimizer,
         optimizer->RegisterPass(CreateFlattenDecorationPass());
       } else if (0 == strcmp(cur_arg, "--compact-ids")) {
         optimizer->RegisterPass(CreateCompactIdsPass());
+      } else if (0 == strcmp(cur_arg, "--dedup-functions")) {
+        optimizer->RegisterPass(CreateDedupFunctionsPass());
       } else if (0 == strcmp(cur_arg, "--cfg-cleanup")) {
         optimizer->RegisterPass(CreateCFGCleanupPass());
       } else if (0 == strcmp(cur_arg, "--local-redundancy-elimination")) {
@@ -567,6 +772,22 @@ OptStatus ParseFlags(int argc, const char** argv, Optimizer* optimizer,
         if (status.action != OPT_CONTINUE) {
           return status;
         }
+      } else if (0 == strcmp(cur_arg, "--loop-unroll-heuristic")) {
+        OptStatus status =
+            ParseLoopUnrollHeuristicArg(argc, argv, ++argi, optimizer);
+        if (status.action != OPT_CONTINUE) {
+          return status;
+        }
+      } else if (0 == strcmp(cur_arg, "--loop-fission")) {
+        OptStatus status = ParseLoopFissionArg(argc, argv, ++argi, optimizer);
+        if (status.action != OPT_CONTINUE) {
+          return status;
+        }
+      } else if (0 == strcmp(cur_arg, "--loop-fusion")) {
+        OptStatus status = ParseLoopFusionArg(argc, argv, ++argi, optimizer);
+        if (status.action != OPT_CONTINUE) {
+          return status;
+        }
       } else if (0 == strcmp(cur_arg, "--loop-peeling")) {
         optimizer->RegisterPass(CreateLoopPeelingPass());
       } else if (0 == strcmp(cur_arg, "--loop-peeling-threshold")) {
@@ -578,6 +799,8 @@ OptStatus ParseFlags(int argc, const char** argv, Optimizer* optimizer,
         *skip_validator = true;
       } else if (0 == strcmp(cur_arg, "-O")) {
         optimizer->RegisterPerformancePasses();
+      } else if (0 == strcmp(cur_arg, "-Ochange-driven")) {
+        optimizer->RegisterChangeDrivenPerformancePasses();
       } else if (0 == strcmp(cur_arg, "-Os")) {
         optimizer->RegisterSizePasses();
       } else if (0 == strcmp(cur_arg, "--legalize-hlsl")) {
@@ -589,12 +812,45 @@ OptStatus ParseFlags(int argc, const char** argv, Optimizer* optimizer,
         if (status.action != OPT_CONTINUE) {
           return status;
         }
+      } else if (0 == strcmp(cur_arg, "--autotune") ||
+                 0 == strncmp(cur_arg, "--autotune-config=",
+                              sizeof("--autotune-config=") - 1)) {
+        if (autotune_recipes == nullptr) {
+          fprintf(stderr,
+                  "error: Flag %s may not be used inside the configuration "
+                  "file\n",
+                  cur_arg);
+          return {OPT_STOP, 1};
+        }
+        if (0 == strcmp(cur_arg, "--autotune")) {
+          autotune_recipes->push_back("-O");
+          autotune_recipes->push_back("-Os");
+          autotune_recipes->push_back("-Ochange-driven");
+        } else {
+          OptStatus status = ParseAutotuneConfigFlag(
+              argv[0], cur_arg, in_file, out_file, autotune_recipes);
+          if (status.action != OPT_CONTINUE) {
+            return status;
+          }
+        }
       } else if (0 == strcmp(cur_arg, "--ccp")) {
         optimizer->RegisterPass(CreateCCPPass());
+      } else if (0 == strcmp(cur_arg, "--code-sink")) {
+        OptStatus status = ParseCodeSinkArg(argc, argv, ++argi, optimizer);
+        if (status.action != OPT_CONTINUE) {
+          return status;
+        }
       } else if (0 == strcmp(cur_arg, "--print-all")) {
         optimizer->SetPrintAll(&std::cerr);
       } else if (0 == strcmp(cur_arg, "--time-report")) {
         optimizer->SetTimeReport(&std::cerr);
+      } else if (0 == strcmp(cur_arg, "--track-changes")) {
+        optimizer->SetChangeTracking(true);
+      } else if (0 == strcmp(cur_arg, "--threads")) {
+        OptStatus status = ParseThreadsArg(argc, argv, ++argi, optimizer);
+        if (status.action != OPT_CONTINUE) {
+          return status;
+        }
       } else if ('\0' == cur_arg[1]) {
         // Setting a filename of "-" to indicate stdin.
         if (!*in_file) {
@@ -623,6 +879,47 @@ OptStatus ParseFlags(int argc, const char** argv, Optimizer* optimizer,
   return {OPT_CONTINUE, 0};
 }
 
+// Optimizes |binary| in place with each of the recipes in |recipe_flags|,
+// each given as a single spirv-opt flag, after the passes registered to
+// |optimizer|, and keeps the cheapest result.  Prints how the recipes compared
+// to standard error output.  |prog_name| is the name of the spirv-opt binary.
+//
+// Returns true if at least one recipe succeeded.
+bool RunAutotuned(const char* prog_name, const Optimizer& optimizer,
+                  const std::vector<std::string>& recipe_flags,
+                  std::vector<uint32_t>* binary) {
+  std::vector<Optimizer::Recipe> recipes;
+  for (const std::string& flag : recipe_flags) {
+    recipes.push_back({flag, [prog_name, flag](Optimizer* recipe_optimizer) {
+                         const char* recipe_argv[] = {prog_name, flag.c_str()};
+                         const char* in_file = nullptr;
+                         const char* out_file = nullptr;
+                         bool skip_validator = false;
+                         ParseFlags(2, recipe_argv, recipe_optimizer, &in_file,
+                                    &out_file, nullptr, &skip_validator,
+                                    nullptr);
+                       }});
+  }
+
+  std::string winner;
+  std::vector<Optimizer::RecipeReport> report;
+  bool ok = optimizer.RunAutotuned(binary->data(), binary->size(), recipes,
+                                   nullptr, binary, &winner, &report);
+
+  fprintf(stderr, "%-32s %14s %10s\n", "recipe", "cost", "words");
+  for (const Optimizer::RecipeReport& result : report) {
+    if (!result.succeeded) {
+      fprintf(stderr, "%-32s %14s %10s\n", result.name.c_str(), "failed",
+              "-");
+      continue;
+    }
+    fprintf(stderr, "%-32s %14.1f %10zu%s\n", result.name.c_str(),
+            result.cost, result.binary_size,
+            ok && result.name == winner ? "  (chosen)" : "");
+  }
+  return ok;
+}
+
 }  // namespace
 
 int main(int argc, const char** argv) {
@@ -641,8 +938,9 @@ int main(int argc, const char** argv) {
               << std::endl;
   });
 
+  std::vector<std::string> autotune_recipes;
   OptStatus status = ParseFlags(argc, argv, &optimizer, &in_file, &out_file,
-                                options, &skip_validator);
+                                options, &skip_validator, &autotune_recipes);
 
   if (status.action == OPT_STOP) {
     return status.code;
@@ -679,7 +977,9 @@ int main(int argc, const char** argv) {
 
   // By using the same vector as input and output, we save time in the case
   // that there was no change.
-  bool ok = optimizer.Run(binary.data(), binary.size(), &binary);
+  bool ok = autotune_recipes.empty()
+                ? optimizer.Run(binary.data(), binary.size(), &binary)
+                : RunAutotuned(argv[0], optimizer, autotune_recipes, &binary);
 
   if (!WriteFile<uint32_t>(out_file, "wb", binary.data(), binary.size())) {
     return 1;
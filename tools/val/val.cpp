@@ -49,6 +49,13 @@ Options:
   --relax-struct-store             Allow store from one struct type to a
                                    different type with compatible layout and
                                    members.
+  --threads                        <number of threads used to check the
+                                   functions, between 1 and 1024>
+  --time-report                    Print the resource utilization of each
+                                   validation stage (e.g., CPU time, RSS) and
+                                   the time spent by each check done on every
+                                   instruction to standard error output. The
+                                   stages are reported only on Unix systems.
   --version                        Display validator version information.
   --target-env                     {vulkan1.0|vulkan1.1|opencl2.2|spv1.0|spv1.1|spv1.2|spv1.3}
                                    Use Vulkan 1.0, Vulkan 1.1, OpenCL 2.2, SPIR-V 1.0,
@@ -122,6 +129,22 @@ int main(int argc, char** argv) {
         options.SetRelaxLogicalPointer(true);
       } else if (0 == strcmp(cur_arg, "--relax-struct-store")) {
         options.SetRelaxStructStore(true);
+      } else if (0 == strcmp(cur_arg, "--threads")) {
+        char* end = nullptr;
+        const long num_threads =
+            argi + 1 < argc ? strtol(argv[++argi], &end, 10) : 0;
+        if (end != nullptr && end != argv[argi] && *end == '\0' &&
+            num_threads > 0 && num_threads <= 1024) {
+          options.SetNumThreads(static_cast<uint32_t>(num_threads));
+        } else {
+          fprintf(stderr,
+                  "error: --threads must be followed by an integer between 1 "
+                  "and 1024\n");
+          continue_processing = false;
+          return_code = 1;
+        }
+      } else if (0 == strcmp(cur_arg, "--time-report")) {
+        options.SetTimeReport(&std::cerr);
       } else if (0 == cur_arg[1]) {
         // Setting a filename of "-" to indicate stdin.
         if (!inFile) {